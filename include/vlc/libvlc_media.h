@@ -254,6 +254,12 @@ typedef enum libvlc_media_parse_flag_t
      * when the input is asking for credentials.
      */
     libvlc_media_do_interact    = 0x08,
+    /**
+     * Only read the tags of local files with the meta readers, instead of
+     * opening the file with a demuxer, if possible. The duration and the
+     * tracks may then be unknown. This is meant for library scans.
+     */
+    libvlc_media_parse_fast     = 0x10,
 } libvlc_media_parse_flag_t;
 
 /**
@@ -574,6 +580,30 @@ LIBVLC_API void libvlc_media_set_meta( libvlc_media_t *p_md,
  */
 LIBVLC_API int libvlc_media_save_meta( libvlc_media_t *p_md );
 
+/**
+ * Save a thumbnail of the media in a file, without playing it.
+ *
+ * The media is demuxed and decoded in the calling thread, without video
+ * output. The picture is the first key frame from the given time.
+ * If you want to keep the aspect ratio, set only one of the dimensions
+ * and the other one to 0.
+ *
+ * \version LibVLC 3.0.0 and later.
+ *
+ * \param p_md the media descriptor
+ * \param i_time the time of the thumbnail (in ms)
+ * \param psz_filepath the path of a file; the image format is deduced from
+ * its extension (PNG if unknown)
+ * \param i_width the thumbnail width
+ * \param i_height the thumbnail height
+ * \return 0 on success, -1 on error
+ */
+LIBVLC_API int libvlc_media_save_thumbnail( libvlc_media_t *p_md,
+                                            libvlc_time_t i_time,
+                                            const char *psz_filepath,
+                                            unsigned int i_width,
+                                            unsigned int i_height );
+
 
 /**
  * Get current state of media descriptor object. Possible media states are
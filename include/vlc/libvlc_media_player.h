@@ -255,6 +255,33 @@ LIBVLC_API void libvlc_media_player_set_pause ( libvlc_media_player_t *mp,
  */
 LIBVLC_API void libvlc_media_player_pause ( libvlc_media_player_t *p_mi );
 
+/**
+ * Set whether the audio and video outputs are kept when the playback stops.
+ *
+ * By default, libvlc_media_player_stop() destroys the outputs, and the next
+ * playback creates them again. Kept outputs are reused by the next media,
+ * which then starts faster. They are destroyed with the media player.
+ *
+ * \param p_mi the Media Player
+ * \param b_retain true to keep the outputs, false to destroy them on stop
+ * \version LibVLC 3.0.0 or later
+ */
+LIBVLC_API void libvlc_media_player_set_output_retention( libvlc_media_player_t *p_mi,
+                                                          bool b_retain );
+
+/**
+ * Create the audio and video outputs ahead of playback.
+ *
+ * The outputs are created with the current media player settings (as set by
+ * libvlc_media_player_set_xwindow(), libvlc_video_set_callbacks(), etc.) and
+ * kept until a media uses them. This has no effect while playing.
+ *
+ * \param p_mi the Media Player
+ * \return 0 on success, -1 if an output could not be created
+ * \version LibVLC 3.0.0 or later
+ */
+LIBVLC_API int libvlc_media_player_preload( libvlc_media_player_t *p_mi );
+
 /**
  * Stop (no effect if there is no media)
  *
@@ -278,6 +305,78 @@ LIBVLC_API void libvlc_media_player_stop ( libvlc_media_player_t *p_mi );
 LIBVLC_API int libvlc_media_player_set_renderer( libvlc_media_player_t *p_mi,
                                                  const libvlc_renderer_item_t *p_item );
 
+/** The packet starts a key frame */
+#define LIBVLC_PACKET_KEYFRAME      0x1
+/** The packet follows a discontinuity in the stream */
+#define LIBVLC_PACKET_DISCONTINUITY 0x2
+/** The packet is known to be corrupted */
+#define LIBVLC_PACKET_CORRUPTED     0x4
+
+/**
+ * Encoded packet, as handed by @ref libvlc_packet_cb.
+ *
+ * The data is not copied: it stays valid until the packet is released with
+ * libvlc_packet_release().
+ */
+typedef struct libvlc_packet_t
+{
+    int                 i_id;  /**< elementary stream identifier */
+    libvlc_track_type_t type;  /**< elementary stream type */
+    uint32_t            codec; /**< elementary stream fourcc */
+
+    const uint8_t *p_data; /**< packet data */
+    size_t         i_size; /**< packet size in bytes */
+
+    int64_t  pts;    /**< presentation time, 0 if unknown */
+    int64_t  dts;    /**< decoding time, 0 if unknown */
+    int64_t  length; /**< duration in microseconds, 0 if unknown */
+    unsigned flags;  /**< combination of LIBVLC_PACKET_* flags */
+
+    /* private */
+    void   (*pf_release)(struct libvlc_packet_t *);
+} libvlc_packet_t;
+
+/**
+ * Callback prototype to receive an encoded packet.
+ *
+ * The packet is owned by the application, which must release it with
+ * libvlc_packet_release(), from any thread and at any time.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_media_player_set_packet_callback() [IN]
+ * \param packet encoded packet [IN]
+ */
+typedef void (*libvlc_packet_cb)(void *opaque, libvlc_packet_t *packet);
+
+/**
+ * Set a callback to receive the encoded packets of every elementary stream,
+ * before decoding.
+ *
+ * \note This must be called before the media is played, and replaces any
+ * stream output or renderer set on the media player.
+ *
+ * \param p_mi the media player
+ * \param cb callback to receive the packets, or NULL to unset it
+ * \param opaque private pointer for the callback (as first parameter)
+ * \param b_render true to also decode and render the media as usual, false
+ * to skip decoding entirely (the packets are then delivered as fast as
+ * they are demuxed)
+ * \return 0 on success, -1 on error.
+ * \version LibVLC 3.0.0 or later
+ */
+LIBVLC_API int libvlc_media_player_set_packet_callback( libvlc_media_player_t *p_mi,
+                                                        libvlc_packet_cb cb,
+                                                        void *opaque,
+                                                        bool b_render );
+
+/**
+ * Release a packet received from @ref libvlc_packet_cb.
+ *
+ * \param packet packet to release
+ * \version LibVLC 3.0.0 or later
+ */
+LIBVLC_API void libvlc_packet_release( libvlc_packet_t *packet );
+
 /**
  * Callback prototype to allocate and lock a picture buffer.
  *
@@ -444,6 +543,75 @@ void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
                                         libvlc_video_format_cb setup,
                                         libvlc_video_cleanup_cb cleanup );
 
+#define LIBVLC_VIDEO_FRAME_PLANES 5
+
+/**
+ * Decoded video frame, as handed by @ref libvlc_video_frame_cb.
+ *
+ * The pixel planes belong to the decoder picture pool: they are valid, and
+ * are not reused by the decoder, until the frame is released with
+ * libvlc_video_frame_release().
+ */
+typedef struct libvlc_video_frame_t
+{
+    char     chroma[5]; /**< four-characters chroma, NUL-terminated */
+    unsigned width;     /**< visible pixel width */
+    unsigned height;    /**< visible pixel height */
+
+    unsigned planes_count; /**< number of valid entries in the tables below */
+    void    *planes[LIBVLC_VIDEO_FRAME_PLANES]; /**< start of pixel planes */
+    unsigned pitches[LIBVLC_VIDEO_FRAME_PLANES]; /**< scanline pitches in bytes */
+    unsigned lines[LIBVLC_VIDEO_FRAME_PLANES]; /**< scanlines count */
+
+    int64_t  pts;       /**< presentation time, see libvlc_clock() */
+    void    *surface;   /**< hardware surface context, or NULL */
+
+    /* private */
+    void   (*pf_release)(struct libvlc_video_frame_t *);
+} libvlc_video_frame_t;
+
+/**
+ * Callback prototype to receive a decoded video frame.
+ *
+ * The frame is owned by the application, which must release it with
+ * libvlc_video_frame_release(), from any thread and at any time. Frames
+ * held by the application are not available to the decoder: holding too
+ * many of them stalls the decoding.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_video_set_frame_callback() [IN]
+ * \param frame decoded frame [IN]
+ */
+typedef void (*libvlc_video_frame_cb)(void *opaque,
+                                      libvlc_video_frame_t *frame);
+
+/**
+ * Set a callback to receive the decoded video frames, without copy.
+ *
+ * Unlike libvlc_video_set_callbacks(), the frames are not copied into
+ * application buffers: the application gets references to the decoded
+ * pictures in their original format. This is mutually exclusive with
+ * libvlc_video_set_callbacks() and the format setting functions.
+ *
+ * \param mp the media player
+ * \param frame callback to receive the frames (must not be NULL)
+ * \param opaque private pointer for the callback (as first parameter)
+ * \version LibVLC 3.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_set_frame_callback( libvlc_media_player_t *mp,
+                                      libvlc_video_frame_cb frame,
+                                      void *opaque );
+
+/**
+ * Release a frame received from @ref libvlc_video_frame_cb.
+ *
+ * \param frame frame to release
+ * \version LibVLC 3.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_frame_release( libvlc_video_frame_t *frame );
+
 /**
  * Set the NSView handler where the media player should render its video output.
  *
@@ -146,6 +146,20 @@ VLC_API block_t *block_Alloc(size_t size) VLC_USED VLC_MALLOC;
 
 block_t *block_TryRealloc(block_t *, ssize_t pre, size_t body) VLC_USED;
 
+/**
+ * Reports block pool statistics.
+ *
+ * block_Alloc() serves common block sizes from per-thread size-class pools.
+ * This function returns the process-wide count of allocations served from a
+ * pool (hits) and of allocations that required a new heap allocation
+ * (misses). Counters are updated periodically by each thread, so that they
+ * may lag behind slightly.
+ *
+ * @param hits storage for the count of pool hits [OUT]
+ * @param misses storage for the count of pool misses [OUT]
+ */
+VLC_API void block_PoolStats(uint64_t *hits, uint64_t *misses);
+
 /**
  * Reallocates a block.
  *
@@ -215,6 +229,35 @@ static inline block_t *block_Duplicate( block_t *p_block )
     return p_dup;
 }
 
+/**
+ * Makes the payload of a block shareable.
+ *
+ * Wraps a block so that block_Clone() can then reference its payload instead
+ * of copying it. The payload is released along with the last of the
+ * resulting blocks.
+ *
+ * The payload of a shared block is read-only. block_Realloc() copies it
+ * as soon as it needs to grow it, but it must not be written to in place:
+ * use block_Duplicate() to get a writeable copy.
+ *
+ * @param block block to share (taken over)
+ * @return the shared block, which is the original block itself if it was
+ * already shared (such as by block_Split()) or if memory is lacking
+ * (block_Clone() then copies).
+ */
+VLC_API block_t *block_Share(block_t *block) VLC_USED;
+
+/**
+ * Clones a block.
+ *
+ * Creates a new reference to the payload of a shared block with its own
+ * properties, and its own view of the payload. Blocks that were not
+ * made shareable with block_Share() are copied with block_Duplicate().
+ *
+ * @return the clone on success, NULL on error.
+ */
+VLC_API block_t *block_Clone(block_t *block) VLC_USED;
+
 /**
  * Wraps heap in a block.
  *
@@ -259,6 +302,23 @@ VLC_API block_t *block_mmap_Alloc(void *addr, size_t length) VLC_USED VLC_MALLOC
  */
 VLC_API block_t * block_shm_Alloc(void *addr, size_t length) VLC_USED VLC_MALLOC;
 
+/**
+ * Splits a block without copying its data.
+ *
+ * The first bytes of the block payload are returned in a new block, while
+ * the block pointed to is replaced with the remaining bytes. Both blocks
+ * share the original buffer, which is released together with the last of
+ * them. The first block keeps the timestamps and flags of the original one.
+ *
+ * If the size is not smaller than the block payload, the block is returned
+ * as is, and the pointer is set to NULL.
+ *
+ * @param pp_block pointer to the block to split [IN/OUT]
+ * @param size bytes length of the first block
+ * @return the first block, or NULL on error (the block is left unchanged)
+ */
+VLC_API block_t *block_Split(block_t **pp_block, size_t size) VLC_USED;
+
 /**
  * Maps a file handle in memory.
  *
@@ -432,6 +492,21 @@ static inline block_t *block_ChainGather( block_t *p_list )
  */
 VLC_API block_fifo_t *block_FifoNew(void) VLC_USED VLC_MALLOC;
 
+/**
+ * Creates a single-producer single-consumer FIFO queue of blocks.
+ *
+ * This is the same as block_FifoNew(), except that blocks are passed through
+ * a lock-free ring buffer. block_FifoPut() and block_FifoGet() then only
+ * take the FIFO lock if the ring overflows or if the consumer must sleep.
+ *
+ * @warning At any given time, only one thread may queue blocks, and only one
+ * (other) thread may dequeue, peek or clear blocks, including through the
+ * vlc_fifo_*() functions.
+ *
+ * @return the FIFO or NULL on memory error
+ */
+VLC_API block_fifo_t *block_FifoNewSPSC(void) VLC_USED VLC_MALLOC;
+
 /**
  * Destroys a FIFO created by block_FifoNew().
  *
@@ -127,6 +127,23 @@ static inline block_t *block_BytestreamPop( block_bytestream_t *p_bytestream )
     return p_block;
 }
 
+/**
+ * Returns the number of bytes which can still be read from the stream.
+ */
+static inline size_t block_BytestreamRemaining( const block_bytestream_t *p_bytestream )
+{
+    size_t i_remaining = 0;
+    size_t i_offset = p_bytestream->i_offset;
+
+    for( const block_t *p_block = p_bytestream->p_block;
+         p_block != NULL; p_block = p_block->p_next )
+    {
+        i_remaining += p_block->i_buffer - i_offset;
+        i_offset = 0;
+    }
+    return i_remaining;
+}
+
 static inline int block_SkipByte( block_bytestream_t *p_bytestream )
 {
     /* Most common case first */
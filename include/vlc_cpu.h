@@ -109,14 +109,26 @@ VLC_API unsigned vlc_CPU(void);
 
 # ifdef __AVX__
 #  define vlc_CPU_AVX() (1)
+#  define VLC_AVX
 # else
 #  define vlc_CPU_AVX() ((vlc_CPU() & VLC_CPU_AVX) != 0)
+#  if VLC_GCC_VERSION(4, 9) || defined(__clang__)
+#   define VLC_AVX __attribute__ ((__target__ ("avx")))
+#  else
+#   define VLC_AVX VLC_AVX_is_not_implemented_on_this_compiler
+#  endif
 # endif
 
 # ifdef __AVX2__
 #  define vlc_CPU_AVX2() (1)
+#  define VLC_AVX2
 # else
 #  define vlc_CPU_AVX2() ((vlc_CPU() & VLC_CPU_AVX2) != 0)
+#  if VLC_GCC_VERSION(4, 9) || defined(__clang__)
+#   define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
+#  else
+#   define VLC_AVX2 VLC_AVX2_is_not_implemented_on_this_compiler
+#  endif
 # endif
 
 # ifdef __3dNOW__
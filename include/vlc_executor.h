@@ -0,0 +1,100 @@
+/*****************************************************************************
+ * vlc_executor.h: thread pool
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_EXECUTOR_H
+# define VLC_EXECUTOR_H 1
+
+# include <vlc_threads.h>
+
+/**
+ * \defgroup executor Executor
+ * \ingroup thread
+ * Thread pool running short-lived tasks
+ *
+ * An executor runs the submitted tasks on a bounded set of threads. The
+ * threads are spawned on demand, and exit after being idle for a few
+ * seconds, so that idle executors do not hold any thread.
+ *
+ * The tasks run in no interrupt context: a task may set its own with
+ * vlc_interrupt_set(), which is reset once the task returns. Tasks must not
+ * wait for other tasks of the same executor, which may not be running yet.
+ *
+ * @{
+ * \file
+ * Executor interface
+ */
+
+typedef struct vlc_executor vlc_executor_t;
+
+/**
+ * Executor task.
+ *
+ * The task is owned by the submitter, which must keep it allocated until
+ * it has completed or was canceled.
+ */
+struct vlc_runnable
+{
+    void (*run)(void *userdata); /**< task entry point */
+    void *userdata; /**< task entry point parameter */
+
+    struct vlc_runnable *next; /**< private */
+};
+
+/**
+ * Creates an executor.
+ *
+ * \param max_threads maximum number of tasks running at the same time
+ * \param priority priority of the threads (see vlc_clone())
+ * \return the executor, or NULL on memory error
+ */
+VLC_API vlc_executor_t *vlc_executor_New(unsigned max_threads, int priority)
+VLC_USED;
+
+/**
+ * Destroys an executor.
+ *
+ * The tasks still waiting are not run. This waits for the running tasks.
+ */
+VLC_API void vlc_executor_Delete(vlc_executor_t *);
+
+/**
+ * Submits a task.
+ *
+ * \retval VLC_SUCCESS the task will run as soon as a thread is available
+ * \retval VLC_EGENERIC no thread could be spawned to run the task
+ */
+VLC_API int vlc_executor_Submit(vlc_executor_t *, struct vlc_runnable *);
+
+/**
+ * Cancels a task.
+ *
+ * \retval true the task was removed before it started
+ * \retval false the task is running or has completed
+ */
+VLC_API bool vlc_executor_Cancel(vlc_executor_t *, struct vlc_runnable *);
+
+/**
+ * Waits until no task is waiting or running.
+ */
+VLC_API void vlc_executor_WaitIdle(vlc_executor_t *);
+
+/** @} */
+
+#endif
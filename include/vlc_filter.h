@@ -50,6 +50,9 @@ typedef struct filter_owner_t
         struct
         {
             picture_t * (*buffer_new)( filter_t * );
+            void (*run_slices)( filter_t *,
+                                void (*)( filter_t *, void *,
+                                          unsigned, unsigned ), void * );
         } video;
         struct
         {
@@ -160,6 +163,33 @@ static inline picture_t *filter_NewPicture( filter_t *p_filter )
     return pic;
 }
 
+/**
+ * Processes a picture in horizontal bands, possibly in parallel.
+ *
+ * The callback is invoked once per band with the band index and the number
+ * of bands. Bands may be processed concurrently from different threads, so
+ * the callback must only write the rows of its own band. All bands have
+ * been processed when this function returns.
+ *
+ * If the owner of the filter does not provide threads, the callback is
+ * invoked once from the calling thread with a single band.
+ *
+ * \param p_filter filter_t object (video filter)
+ * \param cb band callback
+ * \param opaque data for the callback
+ */
+static inline void filter_RunSlices( filter_t *p_filter,
+                                     void (*cb)( filter_t *, void *opaque,
+                                                 unsigned index,
+                                                 unsigned count ),
+                                     void *opaque )
+{
+    if( p_filter->owner.video.run_slices != NULL )
+        p_filter->owner.video.run_slices( p_filter, cb, opaque );
+    else
+        cb( p_filter, opaque, 0, 1 );
+}
+
 /**
  * Flush a filter
  *
@@ -669,6 +669,14 @@ VLC_API void input_resource_Release( input_resource_t * );
  */
 VLC_API void input_resource_TerminateVout( input_resource_t * );
 
+/**
+ * Creates a video output to be recycled by the next input, unless one is
+ * already kept or in use.
+ *
+ * This moves the video output and window creation ahead of playback.
+ */
+VLC_API int input_resource_PreloadVout( input_resource_t * );
+
 /**
  * This function releases all resources (object).
  */
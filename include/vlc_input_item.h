@@ -388,7 +388,9 @@ typedef enum input_item_meta_request_option_t
     META_REQUEST_OPTION_SCOPE_LOCAL   = 0x01,
     META_REQUEST_OPTION_SCOPE_NETWORK = 0x02,
     META_REQUEST_OPTION_SCOPE_ANY     = 0x03,
-    META_REQUEST_OPTION_DO_INTERACT   = 0x04
+    META_REQUEST_OPTION_DO_INTERACT   = 0x04,
+    META_REQUEST_OPTION_FAST          = 0x08, /**< only read the tags of local
+                                                   files if possible */
 } input_item_meta_request_option_t;
 
 /* status of the vlc_InputItemPreparseEnded event */
@@ -417,8 +419,10 @@ struct input_stats_t
     /* Input */
     int64_t i_read_packets;
     int64_t i_read_bytes;
+    int64_t i_read_lost; /**< Packets lost before reaching the access */
     float f_input_bitrate;
     float f_average_input_bitrate;
+    int64_t i_input_cpu_time; /**< CPU time of the input thread (us) */
 
     /* Demux */
     int64_t i_demux_read_packets;
@@ -431,6 +435,10 @@ struct input_stats_t
     /* Decoders */
     int64_t i_decoded_audio;
     int64_t i_decoded_video;
+    int64_t i_audio_decoder_cpu_time; /**< CPU time of the audio decoder
+                                           threads (us) */
+    int64_t i_video_decoder_cpu_time; /**< CPU time of the video decoder
+                                           threads (us) */
 
     /* Vout */
     int64_t i_displayed_pictures;
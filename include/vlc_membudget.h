@@ -0,0 +1,102 @@
+/*****************************************************************************
+ * vlc_membudget.h: process-wide memory budget
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_MEMBUDGET_H
+# define VLC_MEMBUDGET_H 1
+
+/**
+ * \defgroup membudget Memory budget
+ * \ingroup misc
+ * Process-wide accounting of buffer and cache memory
+ *
+ * Subsystems holding large resizable buffers register as consumers, and
+ * account their buffers with vlc_mem_Take() and vlc_mem_Give(). The total
+ * is capped by the "mem-budget" option (unlimited by default).
+ *
+ * Once the budget is nearly exhausted, the process is under pressure: the
+ * consumers using more than their fair share of the budget are expected to
+ * shrink, so that the others can grow. Caches without an owner object can
+ * check vlc_mem_UnderPressure() to stop retaining memory.
+ *
+ * @{
+ * \file
+ * Memory budget interface
+ */
+
+typedef struct vlc_mem_consumer vlc_mem_consumer_t;
+
+/**
+ * Registers a memory consumer.
+ *
+ * \param obj object owning the buffers (for the budget and logging)
+ * \param name short description of the consumer, must remain valid
+ * \return the consumer, or NULL on memory error
+ */
+VLC_API vlc_mem_consumer_t *vlc_mem_consumer_New(vlc_object_t *obj,
+                                                 const char *name) VLC_USED;
+#define vlc_mem_consumer_New(o, n) vlc_mem_consumer_New(VLC_OBJECT(o), n)
+
+/**
+ * Unregisters a memory consumer.
+ *
+ * The consumer must have given back all the memory it took. Its peak usage
+ * is reported in the debug log.
+ */
+VLC_API void vlc_mem_consumer_Delete(vlc_mem_consumer_t *);
+
+/**
+ * Accounts memory before allocating it.
+ *
+ * \retval true the memory fits in the budget and is now accounted
+ * \retval false the budget is exhausted: the consumer should keep its
+ *               current buffers
+ */
+VLC_API bool vlc_mem_Take(vlc_mem_consumer_t *, size_t size) VLC_USED;
+
+/**
+ * Accounts memory that is needed regardless of the budget, such as the
+ * minimum working set of a consumer. This may put the process under
+ * pressure, but never fails.
+ */
+VLC_API void vlc_mem_Charge(vlc_mem_consumer_t *, size_t size);
+
+/**
+ * Gives back memory previously taken or charged, after freeing it.
+ */
+VLC_API void vlc_mem_Give(vlc_mem_consumer_t *, size_t size);
+
+/**
+ * Tells whether a consumer should shrink its buffers.
+ *
+ * This is true while the process is under pressure and the consumer uses
+ * more than its fair share of the budget.
+ */
+VLC_API bool vlc_mem_ShouldShrink(vlc_mem_consumer_t *) VLC_USED;
+
+/**
+ * Tells whether the process is under memory pressure.
+ *
+ * This is cheap enough to be checked from allocation paths.
+ */
+VLC_API bool vlc_mem_UnderPressure(void) VLC_USED;
+
+/** @} */
+
+#endif
@@ -49,6 +49,8 @@ struct vlc_gl_t
     void (*releaseCurrent)(vlc_gl_t *);
     void (*resize)(vlc_gl_t *, unsigned, unsigned);
     void (*swap)(vlc_gl_t *);
+    /* Last vertical synchronization date (mdate() clock) and period */
+    int  (*getVsync)(vlc_gl_t *, mtime_t *, mtime_t *);
 #ifdef __APPLE__
     int  (*lock)(vlc_gl_t *);
     void (*unlock)(vlc_gl_t *);
@@ -105,6 +107,18 @@ static inline void vlc_gl_Swap(vlc_gl_t *gl)
     gl->swap(gl);
 }
 
+/**
+ * Retrieves the date of the last vertical synchronization of the surface,
+ * and the refresh period.
+ *
+ * @return VLC_SUCCESS, or VLC_EGENERIC if the provider cannot tell
+ */
+static inline int vlc_gl_GetVsync(vlc_gl_t *gl, mtime_t *date, mtime_t *period)
+{
+    return (gl->getVsync != NULL) ? gl->getVsync(gl, date, period)
+                                  : VLC_EGENERIC;
+}
+
 static inline void *vlc_gl_GetProcAddress(vlc_gl_t *gl, const char *name)
 {
     return (gl->getProcAddress != NULL) ? gl->getProcAddress(gl, name) : NULL;
@@ -139,6 +139,24 @@ typedef struct
  */
 VLC_API picture_t * picture_NewFromResource( const video_format_t *, const picture_resource_t * ) VLC_USED;
 
+/**
+ * This function will create a new picture referencing a rectangle of the
+ * pixels of another picture, without copying them.
+ *
+ * The new picture holds a reference to the source picture, which is
+ * released when the new picture is destroyed. The pixels are shared, so
+ * neither picture should be written to while both are in use.
+ *
+ * \param p_src the picture to reference (must not be opaque)
+ * \param p_fmt the format of the new picture, whose size is the size of
+ * the rectangle; the chroma must match the source picture chroma
+ * \param i_x horizontal offset of the rectangle in the source planes
+ * \param i_y vertical offset of the rectangle in the source planes
+ * \return the new picture, or NULL on error or if the rectangle does not
+ * fit in the source picture
+ */
+VLC_API picture_t * picture_NewSubRect( picture_t *p_src, const video_format_t *p_fmt, unsigned i_x, unsigned i_y ) VLC_USED;
+
 /**
  * This function will increase the picture reference count.
  * It will not have any effect on picture obtained from vout
@@ -149,6 +149,9 @@ struct  sout_mux_t
     bool  b_waiting_stream;
     /* we wait 1.5 second after first stream added */
     mtime_t     i_add_stream_start;
+    /* the muxer is only run once per quantum of input DTS (0: each block) */
+    mtime_t     i_mux_quantum;
+    mtime_t     i_mux_next_dts;
 };
 
 enum sout_mux_query_e
@@ -53,6 +53,10 @@ typedef struct subpicture_region_private_t subpicture_region_private_t;
  * A subtitle region is defined by a picture (graphic) and its rendering
  * coordinates.
  * Subtitles contain a list of regions.
+ *
+ * The picture of a region must not be modified once the subpicture has been
+ * handed to the video output, which may cache it (e.g. as a texture) for as
+ * long as it holds a reference to it.
  */
 struct subpicture_region_t
 {
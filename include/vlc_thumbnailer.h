@@ -0,0 +1,66 @@
+/*****************************************************************************
+ * vlc_thumbnailer.h: headless thumbnail capture
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_THUMBNAILER_H
+# define VLC_THUMBNAILER_H 1
+
+/**
+ * \defgroup thumbnailer Thumbnailer
+ * \ingroup input
+ * Headless thumbnail capture
+ *
+ * The thumbnailer demuxes and decodes a media in the calling thread,
+ * without input thread, clock nor video output. It seeks to the key frame
+ * nearest to the requested time, decodes the first picture from there, and
+ * encodes it as an image.
+ *
+ * @{
+ * \file
+ * Thumbnailer interface
+ */
+
+/**
+ * Captures a thumbnail of a media.
+ *
+ * Only key frames are decoded, so the picture is the first key frame found
+ * from the seek point. The media is not seeked if it cannot be, and the
+ * first key frame is captured instead.
+ *
+ * \param obj parent object
+ * \param item media to capture (its options are applied)
+ * \param i_time time of the thumbnail, relative to the media start
+ * \param i_format image format (e.g. VLC_CODEC_PNG or VLC_CODEC_JPEG)
+ * \param i_width thumbnail width, 0 to keep the aspect ratio from the
+ * height, or -1 for the original width
+ * \param i_height thumbnail height, 0 to keep the aspect ratio from the
+ * width, or -1 for the original height
+ * \param pp_image storage for the encoded image [OUT]
+ * \return VLC_SUCCESS, or an error code if no picture could be captured
+ */
+VLC_API int vlc_thumbnailer_Capture( vlc_object_t *obj, input_item_t *item,
+                                     mtime_t i_time, vlc_fourcc_t i_format,
+                                     int i_width, int i_height,
+                                     block_t **pp_image );
+#define vlc_thumbnailer_Capture(a,b,c,d,e,f,g) \
+        vlc_thumbnailer_Capture(VLC_OBJECT(a),b,c,d,e,f,g)
+
+/** @} */
+
+#endif
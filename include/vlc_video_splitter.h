@@ -91,6 +91,12 @@ struct video_splitter_t
     int                     i_output;
     video_splitter_output_t *p_output;
 
+    /* Set in the open() function when the output pictures may reference
+     * the input picture (see picture_NewSubRect()) instead of being
+     * allocated with video_splitter_NewPicture(). The owner then copies
+     * them into its own buffers when it needs to. */
+    bool                    b_reference;
+
     int             (*pf_filter)( video_splitter_t *, picture_t *pp_dst[],
                                   picture_t *p_src );
     int             (*pf_mouse) ( video_splitter_t *, vlc_mouse_t *,
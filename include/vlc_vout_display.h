@@ -197,6 +197,8 @@ enum {
 
     VOUT_DISPLAY_EVENT_DISPLAY_SIZE,        /* The display size need to change : int i_width, int i_height */
 
+    VOUT_DISPLAY_EVENT_VSYNC,               /* Vertical synchronization: mtime_t date of the last refresh, mtime_t refresh period */
+
     /* */
     VOUT_DISPLAY_EVENT_CLOSE,
     VOUT_DISPLAY_EVENT_KEY,
@@ -348,6 +350,18 @@ static inline void vout_display_SendEventDisplaySize(vout_display_t *vd, int wid
 {
     vout_display_SendEvent(vd, VOUT_DISPLAY_EVENT_DISPLAY_SIZE, width, height);
 }
+/**
+ * Reports the vertical synchronization of the display, typically after
+ * vout_display_t::display, so that the core can schedule pictures on
+ * refreshes.
+ *
+ * \param date date of the last refresh (mdate() clock)
+ * \param period refresh period, or 0 if unknown
+ */
+static inline void vout_display_SendEventVsync(vout_display_t *vd, mtime_t date, mtime_t period)
+{
+    vout_display_SendEvent(vd, VOUT_DISPLAY_EVENT_VSYNC, date, period);
+}
 static inline void vout_display_SendEventPicturesInvalid(vout_display_t *vd)
 {
     vout_display_SendEvent(vd, VOUT_DISPLAY_EVENT_PICTURES_INVALID);
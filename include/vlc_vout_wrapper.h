@@ -87,6 +87,13 @@ bool vout_AreDisplayPicturesInvalid(vout_display_t *);
 
 bool vout_ManageDisplay(vout_display_t *, bool allow_reset_pictures);
 
+/**
+ * Gets the last vertical synchronization reported by the display.
+ *
+ * \return false if the display did not report any
+ */
+bool vout_GetDisplayVsync(vout_display_t *, mtime_t *date, mtime_t *period);
+
 void vout_SetDisplayFullscreen(vout_display_t *, bool is_fullscreen);
 void vout_SetDisplayFilled(vout_display_t *, bool is_filled);
 void vout_SetDisplayZoom(vout_display_t *, unsigned num, unsigned den);
@@ -37,6 +37,10 @@
 #include <vlc_input.h>
 #include <vlc_meta.h>
 #include <vlc_playlist.h> /* For the preparser */
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_image.h>
+#include <vlc_thumbnailer.h>
 #include <vlc_url.h>
 
 #include "../src/libvlc.h"
@@ -627,6 +631,50 @@ int libvlc_media_save_meta( libvlc_media_t *p_md )
     return input_item_WriteMeta( p_obj, p_md->p_input_item ) == VLC_SUCCESS;
 }
 
+/**************************************************************************
+ * Save a thumbnail without playing the media
+ **************************************************************************/
+int libvlc_media_save_thumbnail( libvlc_media_t *p_md, libvlc_time_t i_time,
+                                 const char *psz_filepath,
+                                 unsigned int i_width, unsigned int i_height )
+{
+    assert( p_md );
+    assert( psz_filepath );
+    vlc_object_t *p_obj = VLC_OBJECT(p_md->p_libvlc_instance->p_libvlc_int);
+
+    vlc_fourcc_t i_format = image_Ext2Fourcc( psz_filepath );
+    if( i_format == 0 )
+        i_format = VLC_CODEC_PNG;
+
+    block_t *p_image;
+    if( vlc_thumbnailer_Capture( p_obj, p_md->p_input_item,
+                                 to_mtime( i_time ), i_format,
+                                 i_width, i_height, &p_image ) )
+    {
+        libvlc_printerr( "Cannot capture a thumbnail" );
+        return -1;
+    }
+
+    FILE *p_file = vlc_fopen( psz_filepath, "wb" );
+    if( p_file == NULL )
+    {
+        libvlc_printerr( "Cannot create %s", psz_filepath );
+        block_Release( p_image );
+        return -1;
+    }
+
+    int i_ret = 0;
+    if( fwrite( p_image->p_buffer, p_image->i_buffer, 1, p_file ) != 1 )
+    {
+        libvlc_printerr( "Cannot write %s", psz_filepath );
+        i_ret = -1;
+    }
+    if( fclose( p_file ) )
+        i_ret = -1;
+    block_Release( p_image );
+    return i_ret;
+}
+
 /**************************************************************************
  * Getter for state information
  * Can be error, playing, buffering, NothingSpecial.
@@ -771,6 +819,8 @@ static int media_parse(libvlc_media_t *media, bool b_async,
             parse_scope |= META_REQUEST_OPTION_SCOPE_NETWORK;
         if (parse_flag & libvlc_media_do_interact)
             parse_scope |= META_REQUEST_OPTION_DO_INTERACT;
+        if (parse_flag & libvlc_media_parse_fast)
+            parse_scope |= META_REQUEST_OPTION_FAST;
         ret = libvlc_MetadataRequest(libvlc, item, parse_scope, timeout, media);
         if (ret != VLC_SUCCESS)
             return ret;
@@ -615,6 +615,7 @@ libvlc_media_player_new( libvlc_instance_t *instance )
     var_Create (mp, "vmem-data", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-setup", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-cleanup", VLC_VAR_ADDRESS);
+    var_Create (mp, "vmem-frame", VLC_VAR_ADDRESS);
     var_Create (mp, "vmem-chroma", VLC_VAR_STRING | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-width", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-height", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
@@ -709,6 +710,7 @@ libvlc_media_player_new( libvlc_instance_t *instance )
     mp->state = libvlc_NothingSpecial;
     mp->p_libvlc_instance = instance;
     mp->input.p_thread = NULL;
+    mp->input.b_retain = false;
     mp->input.p_resource = input_resource_New(VLC_OBJECT(mp));
     if (unlikely(mp->input.p_resource == NULL))
     {
@@ -1052,10 +1054,42 @@ void libvlc_media_player_stop( libvlc_media_player_t *p_mi )
         libvlc_event_send( p_mi->p_event_manager, &event );
     }
 
-    input_resource_Terminate( p_mi->input.p_resource );
+    /* The next input destroys a kept stream output it cannot use */
+    if( !p_mi->input.b_retain )
+        input_resource_Terminate( p_mi->input.p_resource );
+    unlock_input(p_mi);
+}
+
+void libvlc_media_player_set_output_retention( libvlc_media_player_t *p_mi,
+                                               bool b_retain )
+{
+    lock_input(p_mi);
+    p_mi->input.b_retain = b_retain;
     unlock_input(p_mi);
 }
 
+int libvlc_media_player_preload( libvlc_media_player_t *p_mi )
+{
+    int i_ret = 0;
+
+    lock_input(p_mi);
+    /* A playing input already holds its outputs */
+    if( p_mi->input.p_thread == NULL )
+    {
+        audio_output_t *p_aout = input_resource_GetAout( p_mi->input.p_resource );
+        if( p_aout != NULL )
+            input_resource_PutAout( p_mi->input.p_resource, p_aout );
+        else
+            i_ret = -1;
+
+        if( input_resource_PreloadVout( p_mi->input.p_resource ) )
+            i_ret = -1;
+    }
+    unlock_input(p_mi);
+
+    return i_ret;
+}
+
 int libvlc_media_player_set_renderer( libvlc_media_player_t *p_mi,
                                       const libvlc_renderer_item_t *p_litem )
 {
@@ -1070,6 +1104,35 @@ int libvlc_media_player_set_renderer( libvlc_media_player_t *p_mi,
     return 0;
 }
 
+int libvlc_media_player_set_packet_callback( libvlc_media_player_t *p_mi,
+                                             libvlc_packet_cb cb,
+                                             void *opaque, bool b_render )
+{
+    if( cb == NULL )
+    {
+        var_SetString( p_mi, "sout", "" );
+        return 0;
+    }
+
+    char *psz_sout;
+    if( asprintf( &psz_sout, b_render
+                  ? "#duplicate{dst=display,dst=smem{packet-callback=%"PRIdPTR
+                    ",packet-data=%"PRIdPTR"}}"
+                  : "#smem{packet-callback=%"PRIdPTR",packet-data=%"PRIdPTR
+                    ",no-time-sync}",
+                  (intptr_t)cb, (intptr_t)opaque ) == -1 )
+        return -1;
+
+    var_SetString( p_mi, "sout", psz_sout );
+    free( psz_sout );
+    return 0;
+}
+
+void libvlc_packet_release( libvlc_packet_t *packet )
+{
+    packet->pf_release( packet );
+}
+
 void libvlc_video_set_callbacks( libvlc_media_player_t *mp,
     void *(*lock_cb) (void *, void **),
     void (*unlock_cb) (void *, void *, void *const *),
@@ -1093,6 +1156,21 @@ void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
     var_SetAddress( mp, "vmem-cleanup", cleanup );
 }
 
+void libvlc_video_set_frame_callback( libvlc_media_player_t *mp,
+                                      libvlc_video_frame_cb frame_cb,
+                                      void *opaque )
+{
+    var_SetAddress( mp, "vmem-frame", frame_cb );
+    var_SetAddress( mp, "vmem-data", opaque );
+    var_SetString( mp, "vout", "vmem" );
+    var_SetString( mp, "window", "none" );
+}
+
+void libvlc_video_frame_release( libvlc_video_frame_t *frame )
+{
+    frame->pf_release( frame );
+}
+
 void libvlc_video_set_format( libvlc_media_player_t *mp, const char *chroma,
                               unsigned width, unsigned height, unsigned pitch )
 {
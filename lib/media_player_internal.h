@@ -47,6 +47,7 @@ struct libvlc_media_player_t
         input_thread_t   *p_thread;
         input_resource_t *p_resource;
         vlc_mutex_t       lock;
+        bool              b_retain; /* keep the outputs when stopping */
     } input;
 
     struct libvlc_instance_t * p_libvlc_instance; /* Parent instance */
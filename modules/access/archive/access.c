@@ -27,6 +27,15 @@
 #include <archive.h>
 #include <archive_entry.h>
 
+#include <assert.h>
+
+/* Decompressed data buffered ahead of the reads */
+#define READ_AHEAD_SIZE (1 << 20)
+/* Data compared with the source to detect stored entries */
+#define PROBE_SIZE 4096
+/* Number of stored entries remembered across opens */
+#define INDEX_MAX 64
+
 typedef struct callback_data_t
 {
     char *psz_uri;
@@ -45,18 +54,241 @@ struct access_sys_t
     struct archive_entry *p_entry;
     stream_t *p_stream;
     bool b_seekable; /* Is our archive type seekable ? */
+    bool b_fastseek;
+    uint64_t i_size;
+    uint64_t i_pos;
+
+    /* Stored entry, read directly from the source */
+    bool b_stored;
+    uint64_t i_offset;
+
+    /* Compressed entry, decompressed by the read-ahead thread */
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /* signaled to the read-ahead thread */
+    vlc_cond_t wait_read; /* signaled by the read-ahead thread */
+    uint8_t *p_ahead;
+    size_t i_ahead_start;
+    size_t i_ahead;
+    uint64_t i_seek_pos;
+    bool b_seek;
+    int i_seek_ret;
+    bool b_eof;
+    bool b_closing;
+};
+
+/*****************************************************************************
+ * Index of the stored entries
+ *****************************************************************************/
+/* The data of the entries stored verbatim are a range of the source,
+ * which later opens read without going through libarchive at all. */
+struct archive_index_t
+{
+    struct archive_index_t *p_next;
+    char *psz_uri;
+    char *psz_name;
+    uint64_t i_source_size;
+    uint64_t i_offset;
+    uint64_t i_size;
 };
 
+static vlc_mutex_t index_lock = VLC_STATIC_MUTEX;
+static struct archive_index_t *index_first = NULL;
+static unsigned index_count = 0;
+
+static bool IndexLookup(const char *psz_uri, const char *psz_name,
+                        uint64_t *pi_source_size, uint64_t *pi_offset,
+                        uint64_t *pi_size)
+{
+    bool b_found = false;
+
+    vlc_mutex_lock(&index_lock);
+    for (struct archive_index_t *p = index_first; p != NULL; p = p->p_next)
+    {
+        if (strcmp(p->psz_uri, psz_uri) || strcmp(p->psz_name, psz_name))
+            continue;
+
+        *pi_source_size = p->i_source_size;
+        *pi_offset = p->i_offset;
+        *pi_size = p->i_size;
+        b_found = true;
+        break;
+    }
+    vlc_mutex_unlock(&index_lock);
+    return b_found;
+}
+
+static void IndexRemove(const char *psz_uri, const char *psz_name)
+{
+    vlc_mutex_lock(&index_lock);
+    for (struct archive_index_t **pp = &index_first; *pp != NULL;
+         pp = &(*pp)->p_next)
+    {
+        struct archive_index_t *p = *pp;
+
+        if (strcmp(p->psz_uri, psz_uri) || strcmp(p->psz_name, psz_name))
+            continue;
+
+        *pp = p->p_next;
+        index_count--;
+        free(p->psz_uri);
+        free(p->psz_name);
+        free(p);
+        break;
+    }
+    vlc_mutex_unlock(&index_lock);
+}
+
+static void IndexAdd(const char *psz_uri, const char *psz_name,
+                     uint64_t i_source_size, uint64_t i_offset, uint64_t i_size)
+{
+    struct archive_index_t *p = malloc(sizeof(*p));
+    if (unlikely(p == NULL))
+        return;
+
+    p->psz_uri = strdup(psz_uri);
+    p->psz_name = strdup(psz_name);
+    if (unlikely(p->psz_uri == NULL || p->psz_name == NULL))
+    {
+        free(p->psz_uri);
+        free(p->psz_name);
+        free(p);
+        return;
+    }
+    p->i_source_size = i_source_size;
+    p->i_offset = i_offset;
+    p->i_size = i_size;
+
+    IndexRemove(psz_uri, psz_name);
+
+    vlc_mutex_lock(&index_lock);
+    p->p_next = index_first;
+    index_first = p;
+    if (++index_count > INDEX_MAX)
+    {   /* Forget the oldest entry */
+        struct archive_index_t **pp = &index_first;
+        while ((*pp)->p_next != NULL)
+            pp = &(*pp)->p_next;
+        free((*pp)->psz_uri);
+        free((*pp)->psz_name);
+        free(*pp);
+        *pp = NULL;
+        index_count--;
+    }
+    vlc_mutex_unlock(&index_lock);
+}
+
+/*****************************************************************************
+ * Read-ahead thread
+ *****************************************************************************/
+static void *ReadAheadThread(void *data)
+{
+    access_sys_t *p_sys = data;
+    uint8_t *p_chunk = malloc(ARCHIVE_READ_SIZE);
+
+    vlc_mutex_lock(&p_sys->lock);
+    if (unlikely(p_chunk == NULL))
+        p_sys->b_eof = true;
+
+    for (;;)
+    {
+        while (!p_sys->b_closing && !p_sys->b_seek
+            && (p_sys->b_eof || p_chunk == NULL
+             || p_sys->i_ahead + ARCHIVE_READ_SIZE > READ_AHEAD_SIZE))
+            vlc_cond_wait(&p_sys->wait, &p_sys->lock);
+
+        if (p_sys->b_closing)
+            break;
+
+        if (p_sys->b_seek)
+        {
+            uint64_t i_pos = p_sys->i_seek_pos;
+
+            vlc_mutex_unlock(&p_sys->lock);
+            int64_t i_ret = archive_seek_data(p_sys->p_archive, i_pos, SEEK_SET);
+            vlc_mutex_lock(&p_sys->lock);
+
+            p_sys->i_seek_ret = (i_ret < ARCHIVE_OK) ? VLC_EGENERIC
+                                                     : VLC_SUCCESS;
+            if (p_sys->i_seek_ret == VLC_SUCCESS)
+                p_sys->i_pos = i_pos;
+            p_sys->i_ahead_start = 0;
+            p_sys->i_ahead = 0;
+            p_sys->b_eof = p_chunk == NULL;
+            p_sys->b_seek = false;
+            vlc_cond_broadcast(&p_sys->wait_read);
+            continue;
+        }
+        vlc_mutex_unlock(&p_sys->lock);
+
+        ssize_t i_read = archive_read_data(p_sys->p_archive, p_chunk,
+                                           ARCHIVE_READ_SIZE);
+
+        vlc_mutex_lock(&p_sys->lock);
+        if (p_sys->b_seek)
+            continue; /* Stale data */
+
+        if (i_read <= 0)
+            p_sys->b_eof = true;
+        else
+        {
+            size_t i_end = (p_sys->i_ahead_start + p_sys->i_ahead)
+                         % READ_AHEAD_SIZE;
+            size_t i_copy = __MIN((size_t)i_read, READ_AHEAD_SIZE - i_end);
+
+            memcpy(p_sys->p_ahead + i_end, p_chunk, i_copy);
+            memcpy(p_sys->p_ahead, p_chunk + i_copy, i_read - i_copy);
+            p_sys->i_ahead += i_read;
+        }
+        vlc_cond_signal(&p_sys->wait_read);
+    }
+    vlc_mutex_unlock(&p_sys->lock);
+    free(p_chunk);
+    return NULL;
+}
+
+/* Drops buffered data, or copies it to p_data if not NULL */
+static size_t ReadAhead(access_sys_t *p_sys, uint8_t *p_data, size_t i_size)
+{
+    size_t i_done = __MIN(i_size, p_sys->i_ahead);
+    size_t i_copy = __MIN(i_done, READ_AHEAD_SIZE - p_sys->i_ahead_start);
+
+    if (p_data != NULL)
+    {
+        memcpy(p_data, p_sys->p_ahead + p_sys->i_ahead_start, i_copy);
+        memcpy(p_data + i_copy, p_sys->p_ahead, i_done - i_copy);
+    }
+    p_sys->i_ahead_start = (p_sys->i_ahead_start + i_done) % READ_AHEAD_SIZE;
+    p_sys->i_ahead -= i_done;
+    p_sys->i_pos += i_done;
+    vlc_cond_signal(&p_sys->wait);
+    return i_done;
+}
+
 static ssize_t Read(access_t *p_access, void *p_data, size_t i_size)
 {
     access_sys_t *p_sys = p_access->p_sys;
 
     ssize_t i_read = 0;
 
-    i_read = archive_read_data(p_sys->p_archive, p_data, i_size);
+    if (p_sys->b_stored)
+    {
+        if (p_sys->i_pos >= p_sys->i_size)
+            return 0;
+        if (i_size > p_sys->i_size - p_sys->i_pos)
+            i_size = p_sys->i_size - p_sys->i_pos;
+
+        i_read = vlc_stream_Read(p_sys->p_stream, p_data, i_size);
+        if (i_read > 0)
+            p_sys->i_pos += i_read;
+        return i_read;
+    }
 
-    if (i_read < 0)
-        i_read = 0;
+    vlc_mutex_lock(&p_sys->lock);
+    while (p_sys->i_ahead == 0 && !p_sys->b_eof)
+        vlc_cond_wait(&p_sys->wait_read, &p_sys->lock);
+    i_read = ReadAhead(p_sys, p_data, i_size);
+    vlc_mutex_unlock(&p_sys->lock);
 
     return i_read;
 }
@@ -65,11 +297,34 @@ static int Seek(access_t *p_access, uint64_t i_pos)
 {
     access_sys_t *p_sys = p_access->p_sys;
 
-    if (!p_sys->b_seekable)
-        return VLC_EGENERIC;
+    if (p_sys->b_stored)
+    {
+        if (vlc_stream_Seek(p_sys->p_stream, p_sys->i_offset + i_pos))
+            return VLC_EGENERIC;
+        p_sys->i_pos = i_pos;
+        return VLC_SUCCESS;
+    }
+
+    int i_ret = VLC_SUCCESS;
+
+    vlc_mutex_lock(&p_sys->lock);
+    /* Short forward seeks within the decompressed data need no seek */
+    if (i_pos >= p_sys->i_pos && i_pos - p_sys->i_pos <= p_sys->i_ahead)
+        ReadAhead(p_sys, NULL, i_pos - p_sys->i_pos);
+    else if (p_sys->b_seekable)
+    {
+        p_sys->i_seek_pos = i_pos;
+        p_sys->b_seek = true;
+        vlc_cond_signal(&p_sys->wait);
+        while (p_sys->b_seek)
+            vlc_cond_wait(&p_sys->wait_read, &p_sys->lock);
+        i_ret = p_sys->i_seek_ret;
+    }
+    else
+        i_ret = VLC_EGENERIC;
+    vlc_mutex_unlock(&p_sys->lock);
 
-    int64_t i_ret = archive_seek_data(p_sys->p_archive, i_pos, SEEK_SET);
-    return ( i_ret < ARCHIVE_OK ) ? VLC_EGENERIC : VLC_SUCCESS;
+    return i_ret;
 }
 
 static int FindVolumes(access_t *p_access, struct archive *p_archive, const char *psz_uri,
@@ -271,13 +526,8 @@ static int Control(access_t *p_access, int i_query, va_list args)
         break;
 
     case STREAM_CAN_FASTSEEK:
-        if (!p_sys->b_seekable || !p_sys->p_stream)
-        {
-            *va_arg( args, bool* ) = false;
-            break;
-        }
-        else
-            return vlc_stream_vaControl( p_sys->p_stream, i_query, args );
+        *va_arg(args, bool *) = p_sys->b_seekable && p_sys->b_fastseek;
+        break;
 
     case STREAM_SET_PAUSE_STATE:
         break;
@@ -288,7 +538,7 @@ static int Control(access_t *p_access, int i_query, va_list args)
         break;
 
     case STREAM_GET_SIZE:
-        *va_arg(args, uint64_t *) = archive_entry_size(p_sys->p_entry);
+        *va_arg(args, uint64_t *) = p_sys->i_size;
         break;
 
     case STREAM_GET_PTS_DELAY:
@@ -301,6 +551,147 @@ static int Control(access_t *p_access, int i_query, va_list args)
     return VLC_SUCCESS;
 }
 
+/* Opens a stored entry found in the index */
+static int OpenIndexed(access_t *p_access, const char *psz_uri,
+                       const char *psz_name)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    uint64_t i_source_size, i_offset, i_size, i_real_size;
+
+    if (!IndexLookup(psz_uri, psz_name, &i_source_size, &i_offset, &i_size))
+        return VLC_EGENERIC;
+
+    stream_t *p_stream = vlc_stream_NewMRL(p_access, psz_uri);
+    if (p_stream == NULL)
+        return VLC_EGENERIC;
+
+    /* The archive may have been modified since */
+    if (vlc_stream_GetSize(p_stream, &i_real_size)
+     || i_real_size != i_source_size
+     || vlc_stream_Seek(p_stream, i_offset))
+    {
+        vlc_stream_Delete(p_stream);
+        IndexRemove(psz_uri, psz_name);
+        return VLC_EGENERIC;
+    }
+
+    msg_Dbg(p_access, "reading indexed entry %s %"PRIu64, psz_name, i_size);
+    p_sys->p_stream = p_stream;
+    p_sys->b_stored = true;
+    p_sys->b_seekable = true;
+    p_sys->i_offset = i_offset;
+    p_sys->i_size = i_size;
+    vlc_stream_Control(p_stream, STREAM_CAN_FASTSEEK, &p_sys->b_fastseek);
+    return VLC_SUCCESS;
+}
+
+/* Checks whether the entry data are stored verbatim in the source, by
+ * comparing the first decompressed bytes with the source at the end of the
+ * entry header. Returns the number of decompressed bytes. */
+static ssize_t ProbeStored(access_t *p_access, int64_t i_offset,
+                           uint8_t *p_probe)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    uint64_t i_source_size;
+    bool b_candidate = p_sys->i_callback_data == 1
+        && p_sys->b_source_canseek && i_offset >= 0 && p_sys->i_size > 0
+        && archive_entry_size_is_set(p_sys->p_entry)
+        && archive_filter_code(p_sys->p_archive, 0) == ARCHIVE_FILTER_NONE
+        && !vlc_stream_GetSize(p_sys->p_stream, &i_source_size)
+        && i_source_size >= (uint64_t)i_offset + p_sys->i_size;
+
+    ssize_t i_probe = archive_read_data(p_sys->p_archive, p_probe, PROBE_SIZE);
+    if (!b_candidate || i_probe <= 0)
+        return i_probe;
+
+    /* Do not disturb the reads of libarchive: restore the position */
+    uint8_t *p_source = malloc(i_probe);
+    uint64_t i_pos = vlc_stream_Tell(p_sys->p_stream);
+
+    if (likely(p_source != NULL)
+     && vlc_stream_Seek(p_sys->p_stream, i_offset) == VLC_SUCCESS
+     && vlc_stream_Read(p_sys->p_stream, p_source, i_probe) == i_probe
+     && !memcmp(p_source, p_probe, i_probe))
+    {
+        p_sys->b_stored = true;
+        p_sys->i_offset = i_offset;
+    }
+    free(p_source);
+
+    if (!p_sys->b_stored && vlc_stream_Seek(p_sys->p_stream, i_pos))
+        return -1;
+    return i_probe;
+}
+
+static int StartStored(access_t *p_access, const char *psz_name)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    const char *psz_uri = p_sys->p_callback_data[0].psz_uri;
+    uint64_t i_source_size;
+
+    msg_Dbg(p_access, "entry %s is stored at offset %"PRIu64, psz_name,
+            p_sys->i_offset);
+
+    /* libarchive is not needed anymore: keep its source */
+    stream_t *p_stream = p_sys->p_stream;
+    p_sys->p_stream = NULL;
+    archive_read_close(p_sys->p_archive);
+    archive_read_free(p_sys->p_archive);
+    p_sys->p_archive = NULL;
+    p_sys->p_entry = NULL;
+    p_sys->p_stream = p_stream;
+
+    if (vlc_stream_Seek(p_stream, p_sys->i_offset))
+        return VLC_EGENERIC;
+
+    p_sys->b_seekable = true;
+    vlc_stream_Control(p_stream, STREAM_CAN_FASTSEEK, &p_sys->b_fastseek);
+
+    if (!vlc_stream_GetSize(p_stream, &i_source_size))
+        IndexAdd(psz_uri, psz_name, i_source_size, p_sys->i_offset,
+                 p_sys->i_size);
+    return VLC_SUCCESS;
+}
+
+static int StartReadAhead(access_t *p_access, const uint8_t *p_probe,
+                          ssize_t i_probe)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    p_sys->b_fastseek = false;
+    if (p_sys->b_seekable)
+        vlc_stream_Control(p_sys->p_stream, STREAM_CAN_FASTSEEK,
+                           &p_sys->b_fastseek);
+
+    p_sys->p_ahead = malloc(READ_AHEAD_SIZE);
+    if (unlikely(p_sys->p_ahead == NULL))
+        return VLC_ENOMEM;
+
+    static_assert(PROBE_SIZE <= READ_AHEAD_SIZE, "Probe too large");
+    if (i_probe > 0)
+        memcpy(p_sys->p_ahead, p_probe, i_probe);
+    p_sys->i_ahead_start = 0;
+    p_sys->i_ahead = (i_probe > 0) ? i_probe : 0;
+    p_sys->b_eof = i_probe < 0;
+    p_sys->b_seek = false;
+    p_sys->b_closing = false;
+
+    vlc_mutex_init(&p_sys->lock);
+    vlc_cond_init(&p_sys->wait);
+    vlc_cond_init(&p_sys->wait_read);
+
+    if (vlc_clone(&p_sys->thread, ReadAheadThread, p_sys,
+                  VLC_THREAD_PRIORITY_INPUT))
+    {
+        vlc_cond_destroy(&p_sys->wait_read);
+        vlc_cond_destroy(&p_sys->wait);
+        vlc_mutex_destroy(&p_sys->lock);
+        FREENULL(p_sys->p_ahead);
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
 int AccessOpen(vlc_object_t *p_object)
 {
     access_t *p_access = (access_t*)p_object;
@@ -322,6 +713,23 @@ int AccessOpen(vlc_object_t *p_object)
     }
 
     access_sys_t *p_sys = p_access->p_sys = calloc(1, sizeof(access_sys_t));
+    if (unlikely(p_sys == NULL))
+    {
+        free(psz_base);
+        return VLC_ENOMEM;
+    }
+
+    p_access->pf_read    = Read;
+    p_access->pf_block   = NULL; /* libarchive's zerocopy keeps owning block :/ */
+    p_access->pf_control = Control;
+    p_access->pf_seek    = Seek;
+
+    if (OpenIndexed(p_access, psz_base, psz_name) == VLC_SUCCESS)
+    {
+        free(psz_base);
+        return VLC_SUCCESS;
+    }
+
     p_sys->p_archive = archive_read_new();
     if (!p_sys->p_archive)
     {
@@ -402,14 +810,24 @@ int AccessOpen(vlc_object_t *p_object)
 
     msg_Dbg(p_access, "reading entry %s %"PRId64, archive_entry_pathname(p_sys->p_entry),
                                                   archive_entry_size(p_sys->p_entry));
+    p_sys->i_size = archive_entry_size(p_sys->p_entry);
+
+    /* offset of the entry data, if not compressed */
+    int64_t i_offset = archive_filter_bytes(p_sys->p_archive, 0);
 
     /* try to guess if it is seekable or not (does not depend on backend) */
     p_sys->b_seekable = (archive_seek_data(p_sys->p_archive, 0, SEEK_SET) >= 0);
 
-    p_access->pf_read    = Read;
-    p_access->pf_block   = NULL; /* libarchive's zerocopy keeps owning block :/ */
-    p_access->pf_control = Control;
-    p_access->pf_seek    = Seek;
+    uint8_t *p_probe = malloc(PROBE_SIZE);
+    if (unlikely(p_probe == NULL))
+        goto error;
+
+    ssize_t i_probe = ProbeStored(p_access, i_offset, p_probe);
+    int i_ret = p_sys->b_stored ? StartStored(p_access, psz_name)
+                                : StartReadAhead(p_access, p_probe, i_probe);
+    free(p_probe);
+    if (i_ret != VLC_SUCCESS)
+        goto error;
 
     return VLC_SUCCESS;
 
@@ -423,11 +841,27 @@ void AccessClose(vlc_object_t *p_object)
     access_t *p_access = (access_t*)p_object;
     access_sys_t *p_sys = p_access->p_sys;
 
+    if (p_sys->p_ahead != NULL)
+    {
+        vlc_mutex_lock(&p_sys->lock);
+        p_sys->b_closing = true;
+        vlc_cond_signal(&p_sys->wait);
+        vlc_mutex_unlock(&p_sys->lock);
+
+        vlc_join(p_sys->thread, NULL);
+        vlc_cond_destroy(&p_sys->wait_read);
+        vlc_cond_destroy(&p_sys->wait);
+        vlc_mutex_destroy(&p_sys->lock);
+        free(p_sys->p_ahead);
+    }
+
     if (p_sys->p_archive)
     {
         archive_read_close(p_sys->p_archive);
         archive_read_free(p_sys->p_archive);
     }
+    else if (p_sys->p_stream)
+        vlc_stream_Delete(p_sys->p_stream);
 
     if (p_sys->p_callback_data)
     {
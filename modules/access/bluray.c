@@ -118,6 +118,9 @@ vlc_module_end ()
 /* libbluray's overlay.h defines 2 types of overlay (bd_overlay_plane_e). */
 #define MAX_OVERLAY 2
 
+/* Keys queued for the menu event thread */
+#define MAX_KEY_EVENTS 16
+
 typedef enum OverlayStatus {
     Closed = 0,
     ToDisplay,  //Used to mark the overlay to be displayed the first time.
@@ -130,7 +133,8 @@ typedef struct bluray_overlay_t
     vlc_mutex_t         lock;
     int                 i_channel;
     OverlayStatus       status;
-    subpicture_region_t *p_regions;
+    subpicture_region_t *p_regions; /* displayed regions, protected by lock */
+    subpicture_region_t *p_back;    /* regions being drawn by libbluray */
     int                 width, height;
 
     /* pointer to last subpicture updater.
@@ -172,6 +176,18 @@ struct  demux_sys_t
 
     vlc_mutex_t         bdj_overlay_lock; /* used to lock BD-J overlay open/close while overlays are being sent to vout */
 
+    /* User input events, sent to libbluray by the menu event thread */
+    vlc_thread_t        event_thread;
+    vlc_mutex_t         event_lock;
+    vlc_cond_t          event_wait;
+    unsigned int        p_keys[MAX_KEY_EVENTS];
+    unsigned int        i_keys;
+    bool                b_mouse_moved;
+    bool                b_mouse_clicked;
+    int                 i_mouse_x, i_mouse_y;
+    bool                b_event_thread;
+    bool                b_event_closing;
+
     /* */
     vout_thread_t       *p_vout;
 
@@ -271,6 +287,7 @@ static int   bluraySetTitle(demux_t *p_demux, int i_title);
 static void  blurayOverlayProc(void *ptr, const BD_OVERLAY * const overlay);
 static void  blurayArgbOverlayProc(void *ptr, const BD_ARGB_OVERLAY * const overlay);
 
+static void *blurayEventThread(void *);
 static int   onMouseEvent(vlc_object_t *p_vout, const char *psz_var,
                           vlc_value_t old, vlc_value_t val, void *p_data);
 static int   onIntfEvent(vlc_object_t *, char const *,
@@ -669,6 +686,8 @@ static int blurayOpen(vlc_object_t *object)
     vlc_mutex_init(&p_sys->pl_info_lock);
     vlc_mutex_init(&p_sys->bdj_overlay_lock);
     vlc_mutex_init(&p_sys->read_block_lock); /* used during bd_open_stream() */
+    vlc_mutex_init(&p_sys->event_lock);
+    vlc_cond_init(&p_sys->event_wait);
 
     var_AddCallback( p_demux->p_input, "intf-event", onIntfEvent, p_demux );
 
@@ -812,6 +831,12 @@ static int blurayOpen(vlc_object_t *object)
         if (disc_info->num_bdj_titles)
             bd_register_argb_overlay_proc(p_sys->bluray, p_demux, blurayArgbOverlayProc, NULL);
 
+        /* Menus may block on their I/O: keep user input off the input
+         * and video output threads */
+        if (vlc_clone(&p_sys->event_thread, blurayEventThread, p_demux,
+                      VLC_THREAD_PRIORITY_LOW) == 0)
+            p_sys->b_event_thread = true;
+
         /* libbluray will start playback from "First-Title" title */
         if (bd_play(p_sys->bluray) == 0)
             BLURAY_ERROR(_("Failed to start bluray playback. Please try without menu support."));
@@ -870,6 +895,14 @@ static void blurayClose(vlc_object_t *object)
 
     setTitleInfo(p_sys, NULL);
 
+    if (p_sys->b_event_thread) {
+        vlc_mutex_lock(&p_sys->event_lock);
+        p_sys->b_event_closing = true;
+        vlc_cond_signal(&p_sys->event_wait);
+        vlc_mutex_unlock(&p_sys->event_lock);
+        vlc_join(p_sys->event_thread, NULL);
+    }
+
     /*
      * Close libbluray first.
      * This will close all the overlays before we release p_vout
@@ -900,6 +933,8 @@ static void blurayClose(vlc_object_t *object)
     vlc_mutex_destroy(&p_sys->pl_info_lock);
     vlc_mutex_destroy(&p_sys->bdj_overlay_lock);
     vlc_mutex_destroy(&p_sys->read_block_lock);
+    vlc_cond_destroy(&p_sys->event_wait);
+    vlc_mutex_destroy(&p_sys->event_lock);
 
     free(p_sys->psz_bd_path);
     free(p_sys);
@@ -1243,6 +1278,50 @@ static subpicture_t *bluraySubpictureCreate(bluray_overlay_t *p_ov)
 /*****************************************************************************
  * User input events:
  *****************************************************************************/
+/*
+ * libbluray runs the menu programs, and composes the overlays, from the
+ * thread sending the user input. This thread keeps that work away from the
+ * input and video output threads.
+ */
+static void *blurayEventThread(void *data)
+{
+    demux_t     *p_demux = data;
+    demux_sys_t *p_sys   = p_demux->p_sys;
+
+    vlc_mutex_lock(&p_sys->event_lock);
+    for (;;) {
+        while (!p_sys->b_event_closing && p_sys->i_keys == 0
+            && !p_sys->b_mouse_moved && !p_sys->b_mouse_clicked)
+            vlc_cond_wait(&p_sys->event_wait, &p_sys->event_lock);
+
+        if (p_sys->b_event_closing)
+            break;
+
+        unsigned int p_keys[MAX_KEY_EVENTS];
+        unsigned int i_keys = p_sys->i_keys;
+        bool b_moved = p_sys->b_mouse_moved;
+        bool b_clicked = p_sys->b_mouse_clicked;
+        int x = p_sys->i_mouse_x, y = p_sys->i_mouse_y;
+
+        memcpy(p_keys, p_sys->p_keys, i_keys * sizeof(*p_keys));
+        p_sys->i_keys = 0;
+        p_sys->b_mouse_moved = p_sys->b_mouse_clicked = false;
+        vlc_mutex_unlock(&p_sys->event_lock);
+
+        if (b_moved || b_clicked)
+            bd_mouse_select(p_sys->bluray, -1, x, y);
+        if (b_clicked)
+            bd_user_input(p_sys->bluray, -1, BD_VK_MOUSE_ACTIVATE);
+        for (unsigned int i = 0; i < i_keys; i++)
+            if (bd_user_input(p_sys->bluray, -1, p_keys[i]) < 0)
+                msg_Dbg(p_demux, "key %u not handled", p_keys[i]);
+
+        vlc_mutex_lock(&p_sys->event_lock);
+    }
+    vlc_mutex_unlock(&p_sys->event_lock);
+    return NULL;
+}
+
 static int onMouseEvent(vlc_object_t *p_vout, const char *psz_var, vlc_value_t old,
                         vlc_value_t val, void *p_data)
 {
@@ -1251,23 +1330,47 @@ static int onMouseEvent(vlc_object_t *p_vout, const char *psz_var, vlc_value_t o
     VLC_UNUSED(old);
     VLC_UNUSED(p_vout);
 
-    if (psz_var[6] == 'm')   //Mouse moved
-        bd_mouse_select(p_sys->bluray, -1, val.coords.x, val.coords.y);
-    else if (psz_var[6] == 'c') {
-        bd_mouse_select(p_sys->bluray, -1, val.coords.x, val.coords.y);
-        bd_user_input(p_sys->bluray, -1, BD_VK_MOUSE_ACTIVATE);
-    } else {
+    if (psz_var[6] != 'm' && psz_var[6] != 'c')
         vlc_assert_unreachable();
+
+    if (!p_sys->b_event_thread) {
+        bd_mouse_select(p_sys->bluray, -1, val.coords.x, val.coords.y);
+        if (psz_var[6] == 'c')
+            bd_user_input(p_sys->bluray, -1, BD_VK_MOUSE_ACTIVATE);
+        return VLC_SUCCESS;
     }
+
+    /* Only the last position matters */
+    vlc_mutex_lock(&p_sys->event_lock);
+    p_sys->i_mouse_x = val.coords.x;
+    p_sys->i_mouse_y = val.coords.y;
+    if (psz_var[6] == 'm')   //Mouse moved
+        p_sys->b_mouse_moved = true;
+    else
+        p_sys->b_mouse_clicked = true;
+    vlc_cond_signal(&p_sys->event_wait);
+    vlc_mutex_unlock(&p_sys->event_lock);
     return VLC_SUCCESS;
 }
 
 static int sendKeyEvent(demux_sys_t *p_sys, unsigned int key)
 {
-    if (bd_user_input(p_sys->bluray, -1, key) < 0)
-        return VLC_EGENERIC;
+    if (!p_sys->b_event_thread) {
+        if (bd_user_input(p_sys->bluray, -1, key) < 0)
+            return VLC_EGENERIC;
+        return VLC_SUCCESS;
+    }
 
-    return VLC_SUCCESS;
+    int i_ret = VLC_EGENERIC;
+
+    vlc_mutex_lock(&p_sys->event_lock);
+    if (p_sys->i_keys < MAX_KEY_EVENTS) {
+        p_sys->p_keys[p_sys->i_keys++] = key;
+        vlc_cond_signal(&p_sys->event_wait);
+        i_ret = VLC_SUCCESS;
+    }
+    vlc_mutex_unlock(&p_sys->event_lock);
+    return i_ret;
 }
 
 /*****************************************************************************
@@ -1292,6 +1395,7 @@ static void blurayCloseOverlay(demux_t *p_demux, int plane)
 
         vlc_mutex_destroy(&ov->lock);
         subpicture_region_ChainDelete(ov->p_regions);
+        subpicture_region_ChainDelete(ov->p_back);
         free(ov);
 
         p_sys->p_overlays[plane] = NULL;
@@ -1317,14 +1421,30 @@ static void blurayActivateOverlay(demux_t *p_demux, int plane)
     demux_sys_t *p_sys = p_demux->p_sys;
     bluray_overlay_t *ov = p_sys->p_overlays[plane];
 
+    /*
+     * Publish a copy of the drawn regions, so that the vout never waits for
+     * drawing, and libbluray never waits for the vout.
+     */
+    subpicture_region_t *p_regions = NULL, **pp_dst = &p_regions;
+    for (subpicture_region_t *p_src = ov->p_back; p_src; p_src = p_src->p_next) {
+        *pp_dst = subpicture_region_Copy(p_src);
+        if (*pp_dst == NULL)
+            break;
+        pp_dst = &(*pp_dst)->p_next;
+    }
+
+    vlc_mutex_lock(&ov->lock);
+    subpicture_region_t *p_old = ov->p_regions;
+    ov->p_regions = p_regions;
+
     /*
      * If the overlay is already displayed, mark the picture as outdated.
      * We must NOT use vout_PutSubpicture if a picture is already displayed.
      */
-    vlc_mutex_lock(&ov->lock);
     if (ov->status >= Displayed && p_sys->p_vout) {
         ov->status = Outdated;
         vlc_mutex_unlock(&ov->lock);
+        subpicture_region_ChainDelete(p_old);
         return;
     }
 
@@ -1335,6 +1455,7 @@ static void blurayActivateOverlay(demux_t *p_demux, int plane)
      */
     ov->status = ToDisplay;
     vlc_mutex_unlock(&ov->lock);
+    subpicture_region_ChainDelete(p_old);
 }
 
 static void blurayInitOverlay(demux_t *p_demux, int plane, int width, int height)
@@ -1369,13 +1490,17 @@ static void blurayClearOverlay(demux_t *p_demux, int plane)
     demux_sys_t *p_sys = p_demux->p_sys;
     bluray_overlay_t *ov = p_sys->p_overlays[plane];
 
+    subpicture_region_ChainDelete(ov->p_back);
+    ov->p_back = NULL;
+
     vlc_mutex_lock(&ov->lock);
 
-    subpicture_region_ChainDelete(ov->p_regions);
+    subpicture_region_t *p_old = ov->p_regions;
     ov->p_regions = NULL;
     ov->status = Outdated;
 
     vlc_mutex_unlock(&ov->lock);
+    subpicture_region_ChainDelete(p_old);
 }
 
 /*
@@ -1388,13 +1513,12 @@ static void blurayDrawOverlay(demux_t *p_demux, const BD_OVERLAY* const ov)
 
     /*
      * Compute a subpicture_region_t.
-     * It will be copied and sent to the vout later.
+     * It will be copied and sent to the vout when flushed.
      */
-    vlc_mutex_lock(&p_sys->p_overlays[ov->plane]->lock);
 
     /* Find a region to update */
-    subpicture_region_t **pp_reg = &p_sys->p_overlays[ov->plane]->p_regions;
-    subpicture_region_t *p_reg = p_sys->p_overlays[ov->plane]->p_regions;
+    subpicture_region_t **pp_reg = &p_sys->p_overlays[ov->plane]->p_back;
+    subpicture_region_t *p_reg = p_sys->p_overlays[ov->plane]->p_back;
     subpicture_region_t *p_last = NULL;
     while (p_reg != NULL) {
         p_last = p_reg;
@@ -1411,7 +1535,6 @@ static void blurayDrawOverlay(demux_t *p_demux, const BD_OVERLAY* const ov)
             *pp_reg = p_reg->p_next;
             subpicture_region_Delete(p_reg);
         }
-        vlc_mutex_unlock(&p_sys->p_overlays[ov->plane]->lock);
         return;
     }
 
@@ -1428,7 +1551,7 @@ static void blurayDrawOverlay(demux_t *p_demux, const BD_OVERLAY* const ov)
         if (p_last != NULL)
             p_last->p_next = p_reg;
         else /* If we don't have a last region, then our list empty */
-            p_sys->p_overlays[ov->plane]->p_regions = p_reg;
+            p_sys->p_overlays[ov->plane]->p_back = p_reg;
     }
 
     /* Now we can update the region, regardless it's an update or an insert */
@@ -1451,7 +1574,6 @@ static void blurayDrawOverlay(demux_t *p_demux, const BD_OVERLAY* const ov)
         }
     }
 
-    vlc_mutex_unlock(&p_sys->p_overlays[ov->plane]->lock);
     /*
      * /!\ The region is now stored in our internal list, but not in the subpicture /!\
      */
@@ -1508,12 +1630,12 @@ static void blurayInitArgbOverlay(demux_t *p_demux, int plane, int width, int he
 
     blurayInitOverlay(p_demux, plane, width, height);
 
-    if (!p_sys->p_overlays[plane]->p_regions) {
+    if (!p_sys->p_overlays[plane]->p_back) {
         video_format_t fmt;
         video_format_Init(&fmt, 0);
         video_format_Setup(&fmt, VLC_CODEC_RGBA, width, height, width, height, 1, 1);
 
-        p_sys->p_overlays[plane]->p_regions = subpicture_region_New(&fmt);
+        p_sys->p_overlays[plane]->p_back = subpicture_region_New(&fmt);
     }
 }
 
@@ -1521,14 +1643,10 @@ static void blurayDrawArgbOverlay(demux_t *p_demux, const BD_ARGB_OVERLAY* const
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
-    vlc_mutex_lock(&p_sys->p_overlays[ov->plane]->lock);
-
     /* Find a region to update */
-    subpicture_region_t *p_reg = p_sys->p_overlays[ov->plane]->p_regions;
-    if (!p_reg) {
-        vlc_mutex_unlock(&p_sys->p_overlays[ov->plane]->lock);
+    subpicture_region_t *p_reg = p_sys->p_overlays[ov->plane]->p_back;
+    if (!p_reg)
         return;
-    }
 
     /* Now we can update the region */
     const uint32_t *src0 = ov->argb;
@@ -1550,7 +1668,6 @@ static void blurayDrawArgbOverlay(demux_t *p_demux, const BD_ARGB_OVERLAY* const
         dst0 += p_reg->p_picture->p[0].i_pitch;
     }
 
-    vlc_mutex_unlock(&p_sys->p_overlays[ov->plane]->lock);
     /*
      * /!\ The region is now stored in our internal list, but not in the subpicture /!\
      */
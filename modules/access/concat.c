@@ -28,6 +28,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>
+#include <vlc_interrupt.h>
 
 struct access_entry
 {
@@ -46,8 +47,80 @@ struct access_sys_t
     bool can_control_pace;
     uint64_t size;
     int64_t caching;
+
+    /* Next input, opened ahead by a thread */
+    bool preopening;
+    vlc_thread_t preopen_thread;
+    vlc_interrupt_t *preopen_interrupt;
+    struct access_entry *preopen_entry;
+    access_t *preopen;
 };
 
+static void *PreopenThread(void *data)
+{
+    access_t *access = data;
+    access_sys_t *sys = access->p_sys;
+
+    vlc_interrupt_set(sys->preopen_interrupt);
+    sys->preopen = vlc_access_NewMRL(VLC_OBJECT(access),
+                                     sys->preopen_entry->mrl);
+    vlc_interrupt_set(NULL);
+    return NULL;
+}
+
+/**
+ * Starts opening the input following the current one, so that switching
+ * inputs does not wait for the connection or the probing.
+ */
+static void StartPreopen(access_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+
+    assert(!sys->preopening);
+    if (sys->next == NULL)
+        return;
+
+    sys->preopen_interrupt = vlc_interrupt_create();
+    if (unlikely(sys->preopen_interrupt == NULL))
+        return;
+
+    sys->preopen_entry = sys->next;
+    sys->preopen = NULL;
+    if (vlc_clone(&sys->preopen_thread, PreopenThread, access,
+                  VLC_THREAD_PRIORITY_LOW))
+    {
+        vlc_interrupt_destroy(sys->preopen_interrupt);
+        return;
+    }
+    sys->preopening = true;
+}
+
+/**
+ * Waits for the preopened input, or aborts it if cancel is true.
+ * \return the input if it is the next one, or NULL
+ */
+static access_t *StopPreopen(access_t *access, bool cancel)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (!sys->preopening)
+        return NULL;
+
+    if (cancel)
+        vlc_interrupt_kill(sys->preopen_interrupt);
+    vlc_join(sys->preopen_thread, NULL);
+    vlc_interrupt_destroy(sys->preopen_interrupt);
+    sys->preopening = false;
+
+    access_t *a = sys->preopen;
+    if (a != NULL && (cancel || sys->preopen_entry != sys->next))
+    {
+        vlc_stream_Delete(a);
+        a = NULL;
+    }
+    return a;
+}
+
 static access_t *GetAccess(access_t *access)
 {
     access_sys_t *sys = access->p_sys;
@@ -65,12 +138,15 @@ static access_t *GetAccess(access_t *access)
     if (sys->next == NULL)
         return NULL;
 
-    a = vlc_access_NewMRL(VLC_OBJECT(access), sys->next->mrl);
+    a = StopPreopen(access, false);
+    if (a == NULL)
+        a = vlc_access_NewMRL(VLC_OBJECT(access), sys->next->mrl);
     if (a == NULL)
         return NULL;
 
     sys->access = a;
     sys->next = sys->next->next;
+    StartPreopen(access);
     return a;
 }
 
@@ -112,6 +188,9 @@ static int Seek(access_t *access, uint64_t position)
     }
 
     sys->next = sys->first;
+    /* Keep opening the first input if it was the next one */
+    if (sys->preopen_entry != sys->first)
+        StopPreopen(access, true);
 
     for (uint64_t offset = 0;;)
     {
@@ -206,6 +285,8 @@ static int Open(vlc_object_t *obj)
     sys->can_control_pace = true;
     sys->size = 0;
     sys->caching = 0;
+    sys->preopening = false;
+    sys->preopen_entry = NULL;
 
     struct access_entry **pp = &sys->first;
 
@@ -288,6 +369,7 @@ static void Close(vlc_object_t *obj)
     access_t *access = (access_t *)obj;
     access_sys_t *sys = access->p_sys;
 
+    StopPreopen(access, true);
     if (sys->access != NULL)
         vlc_stream_Delete(sys->access);
 
@@ -32,6 +32,7 @@
 #include <vlc_atomic.h>
 
 #include <arpa/inet.h>
+#include <vector>
 
 #include <DeckLinkAPI.h>
 #include <DeckLinkAPIDispatch.cpp>
@@ -150,8 +151,136 @@ struct demux_sys_t
     int channels;
 
     bool tenbits;
+
+    IDeckLinkMemoryAllocator *allocator;
+
+    /* Frame arrival jitter, owned by the capture thread */
+    mtime_t last_arrival;
+    mtime_t jitter_start;
+    mtime_t jitter_sum;
+    mtime_t jitter_max;
+    unsigned jitter_count;
 };
 
+/* Number of released frame buffers kept for reuse */
+#define FRAME_POOL_SIZE 16
+
+/**
+ * Video frame buffer allocator. The buffers are recycled, so that captured
+ * frames can be lent downstream without the card running out of buffers.
+ */
+class DeckLinkFramePool : public IDeckLinkMemoryAllocator
+{
+public:
+    DeckLinkFramePool() : size_(0)
+    {
+        m_ref_.store(1);
+        vlc_mutex_init(&lock_);
+    }
+
+    virtual ~DeckLinkFramePool()
+    {
+        Decommit();
+        vlc_mutex_destroy(&lock_);
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, LPVOID *) { return E_NOINTERFACE; }
+
+    virtual ULONG STDMETHODCALLTYPE AddRef(void)
+    {
+        return m_ref_.fetch_add(1) + 1;
+    }
+
+    virtual ULONG STDMETHODCALLTYPE Release(void)
+    {
+        uintptr_t new_ref = m_ref_.fetch_sub(1) - 1;
+        if (new_ref == 0)
+            delete this;
+        return new_ref;
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE AllocateBuffer(uint32_t size, void **buffer)
+    {
+        vlc_mutex_lock(&lock_);
+        if (size != size_) {
+            /* The video mode changed */
+            for (size_t i = 0; i < free_.size(); i++)
+                vlc_free(free_[i]);
+            free_.clear();
+            size_ = size;
+        }
+
+        if (!free_.empty()) {
+            *buffer = free_.back();
+            free_.pop_back();
+        } else
+            *buffer = vlc_memalign(64, size);
+        vlc_mutex_unlock(&lock_);
+        return (*buffer != NULL) ? S_OK : E_OUTOFMEMORY;
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE ReleaseBuffer(void *buffer)
+    {
+        vlc_mutex_lock(&lock_);
+        if (free_.size() < FRAME_POOL_SIZE) {
+            free_.push_back(buffer);
+            buffer = NULL;
+        }
+        vlc_mutex_unlock(&lock_);
+        vlc_free(buffer);
+        return S_OK;
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE Commit(void)
+    {
+        return S_OK;
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE Decommit(void)
+    {
+        vlc_mutex_lock(&lock_);
+        for (size_t i = 0; i < free_.size(); i++)
+            vlc_free(free_[i]);
+        free_.clear();
+        vlc_mutex_unlock(&lock_);
+        return S_OK;
+    }
+
+private:
+    std::atomic_uint m_ref_;
+    vlc_mutex_t lock_;
+    std::vector<void *> free_;
+    uint32_t size_;
+};
+
+struct decklink_block_t
+{
+    block_t self;
+    IDeckLinkVideoInputFrame *frame;
+};
+
+static void ReleaseFrameBlock(block_t *block)
+{
+    decklink_block_t *b = (decklink_block_t *)block;
+
+    b->frame->Release();
+    free(b);
+}
+
+/* Lends the frame memory as a block */
+static block_t *WrapFrame(IDeckLinkVideoInputFrame *frame, void *bytes, size_t size)
+{
+    decklink_block_t *b = (decklink_block_t *)malloc(sizeof(*b));
+    if (!b)
+        return NULL;
+
+    block_Init(&b->self, bytes, size);
+    b->self.pf_release = ReleaseFrameBlock;
+    frame->AddRef();
+    b->frame = frame;
+    return &b->self;
+}
+
 static const char *GetFieldDominance(BMDFieldDominance dom, uint32_t *flags)
 {
     switch(dom)
@@ -264,10 +393,40 @@ public:
     virtual HRESULT STDMETHODCALLTYPE VideoInputFrameArrived(IDeckLinkVideoInputFrame*, IDeckLinkAudioInputPacket*);
 
 private:
+    void UpdateJitter(mtime_t frame_duration);
+
     std::atomic_uint m_ref_;
     demux_t *demux_;
 };
 
+/* Measures how regularly the frames arrive, and reports it every 10 seconds */
+void DeckLinkCaptureDelegate::UpdateJitter(mtime_t frame_duration)
+{
+    demux_sys_t *sys = demux_->p_sys;
+    mtime_t now = mdate();
+
+    if (sys->last_arrival != VLC_TS_INVALID) {
+        mtime_t jitter = llabs(now - sys->last_arrival - frame_duration);
+
+        sys->jitter_sum += jitter;
+        if (jitter > sys->jitter_max)
+            sys->jitter_max = jitter;
+        sys->jitter_count++;
+    } else
+        sys->jitter_start = now;
+    sys->last_arrival = now;
+
+    if (now - sys->jitter_start >= 10 * CLOCK_FREQ && sys->jitter_count > 0) {
+        msg_Dbg(demux_, "frame arrival jitter: %"PRId64" us average, "
+                "%"PRId64" us maximum", sys->jitter_sum / sys->jitter_count,
+                sys->jitter_max);
+        sys->jitter_start = now;
+        sys->jitter_sum = 0;
+        sys->jitter_max = 0;
+        sys->jitter_count = 0;
+    }
+}
+
 HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame* videoFrame, IDeckLinkAudioInputPacket* audioFrame)
 {
     demux_sys_t *sys = demux_->p_sys;
@@ -282,16 +441,23 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
         const int height = videoFrame->GetHeight();
         const int stride = videoFrame->GetRowBytes();
 
-        int bpp = sys->tenbits ? 4 : 2;
-        block_t *video_frame = block_Alloc(width * height * bpp);
-        if (!video_frame)
-            return S_OK;
+        BMDTimeValue stream_time, frame_duration;
+        videoFrame->GetStreamTime(&stream_time, &frame_duration, CLOCK_FREQ);
+        UpdateJitter(frame_duration);
 
         const uint32_t *frame_bytes;
         videoFrame->GetBytes((void**)&frame_bytes);
 
-        BMDTimeValue stream_time, frame_duration;
-        videoFrame->GetStreamTime(&stream_time, &frame_duration, CLOCK_FREQ);
+        /* Packed 8-bits frames need no conversion: send them as is */
+        int bpp = sys->tenbits ? 4 : 2;
+        block_t *video_frame = NULL;
+        if (!sys->tenbits && stride == width * 2)
+            video_frame = WrapFrame(videoFrame, (void *)frame_bytes, stride * height);
+        if (!video_frame)
+            video_frame = block_Alloc(width * height * bpp);
+        if (!video_frame)
+            return S_OK;
+
         video_frame->i_flags = BLOCK_FLAG_TYPE_I | sys->dominance_flags;
         video_frame->i_pts = video_frame->i_dts = VLC_TS_0 + stream_time;
 
@@ -328,7 +494,7 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
                 }
                 vanc->Release();
             }
-        } else {
+        } else if (video_frame->p_buffer != (const uint8_t *)frame_bytes) {
             for (int y = 0; y < height; ++y) {
                 const uint8_t *src = (const uint8_t *)frame_bytes + stride * y;
                 uint8_t *dst = video_frame->p_buffer + width * 2 * y;
@@ -463,6 +629,7 @@ static int Open(vlc_object_t *p_this)
         return VLC_ENOMEM;
 
     vlc_mutex_init(&sys->pts_lock);
+    sys->last_arrival = VLC_TS_INVALID;
 
     sys->tenbits = var_InheritBool(p_this, "decklink-tenbits");
 
@@ -595,6 +762,11 @@ static int Open(vlc_object_t *p_this)
         goto finish;
     }
 
+    /* Captured frames are lent downstream: recycle their buffers */
+    sys->allocator = new DeckLinkFramePool();
+    if (sys->input->SetVideoInputFrameMemoryAllocator(sys->allocator) != S_OK)
+        msg_Warn(demux, "Failed to set the frame allocator");
+
     if (sys->input->EnableVideoInput(htonl(u.id), fmt, flags) != S_OK) {
         msg_Err(demux, "Failed to enable video input");
         goto finish;
@@ -684,6 +856,10 @@ static void Close(vlc_object_t *p_this)
     if (sys->delegate)
         sys->delegate->Release();
 
+    /* The card keeps its own reference while lent frames are alive */
+    if (sys->allocator)
+        sys->allocator->Release();
+
     vlc_mutex_destroy(&sys->pts_lock);
     free(sys);
 }
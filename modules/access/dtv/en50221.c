@@ -110,11 +110,18 @@ static void ApplicationInformationOpen( cam_t *, unsigned i_session_id );
 static void ConditionalAccessOpen( cam_t *, unsigned i_session_id );
 static void DateTimeOpen( cam_t *, unsigned i_session_id );
 static void MMIOpen( cam_t *, unsigned i_session_id );
+static void *Thread( void * );
 
 #define MAX_CI_SLOTS 16
 #define MAX_SESSIONS 32
 #define MAX_PROGRAMS 24
 
+typedef struct cam_capmt_t
+{
+    struct cam_capmt_t *p_next;
+    en50221_capmt_info_t *p_info;
+} cam_capmt_t;
+
 struct cam
 {
     vlc_object_t *obj;
@@ -122,6 +129,17 @@ struct cam
     int i_ca_type;
     mtime_t i_timeout, i_next_event;
 
+    /* The CAM is only accessed from its own thread, or with io_lock held */
+    vlc_thread_t thread;
+    vlc_mutex_t io_lock;
+
+    /* Pending CA PMTs, in their submission order */
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    cam_capmt_t *p_first_capmt;
+    cam_capmt_t **pp_last_capmt;
+    bool b_dead;
+
     unsigned i_nb_slots;
     bool pb_active_slot[MAX_CI_SLOTS];
     bool pb_tc_has_data[MAX_CI_SLOTS];
@@ -2014,6 +2032,21 @@ cam_t *en50221_Init( vlc_object_t *obj, int fd )
         msg_Err( obj, "CAM interface incompatible" );
         goto error;
     }
+
+    vlc_mutex_init( &p_cam->io_lock );
+    vlc_mutex_init( &p_cam->lock );
+    vlc_cond_init( &p_cam->wait );
+    p_cam->p_first_capmt = NULL;
+    p_cam->pp_last_capmt = &p_cam->p_first_capmt;
+    p_cam->b_dead = false;
+
+    if( vlc_clone( &p_cam->thread, Thread, p_cam, VLC_THREAD_PRIORITY_LOW ) )
+    {
+        vlc_cond_destroy( &p_cam->wait );
+        vlc_mutex_destroy( &p_cam->lock );
+        vlc_mutex_destroy( &p_cam->io_lock );
+        goto error;
+    }
     return p_cam;
 
 error:
@@ -2023,21 +2056,10 @@ error:
 
 
 /*****************************************************************************
- * en50221_Poll : Poll the CAM for TPDUs
+ * Poll : Poll the CAM for TPDUs
  *****************************************************************************/
-void en50221_Poll( cam_t * p_cam )
+static void Poll( cam_t * p_cam )
 {
-    switch( p_cam->i_ca_type )
-    {
-    case CA_CI_LINK:
-        if( mdate() > p_cam->i_next_event )
-            break;
-    case CA_CI:
-        return;
-    default:
-        vlc_assert_unreachable();
-    }
-
     for ( unsigned i_slot = 0; i_slot < p_cam->i_nb_slots; i_slot++ )
     {
         uint8_t i_tag;
@@ -2173,9 +2195,9 @@ void en50221_Poll( cam_t * p_cam )
 
 
 /*****************************************************************************
- * en50221_SetCAPMT :
+ * SetCAPMT :
  *****************************************************************************/
-int en50221_SetCAPMT( cam_t * p_cam, en50221_capmt_info_t *p_info )
+static void SetCAPMT( cam_t * p_cam, en50221_capmt_info_t *p_info )
 {
     bool b_update = false;
     bool b_needs_descrambling = CAPMTNeedsDescrambling( p_info );
@@ -2237,7 +2259,75 @@ int en50221_SetCAPMT( cam_t * p_cam, en50221_capmt_info_t *p_info )
     {
         en50221_capmt_Delete( p_info );
     }
+}
+
+/*****************************************************************************
+ * Thread : Exchange with the CAM, so that TS reading never waits for it
+ *****************************************************************************/
+static void *Thread( void *data )
+{
+    cam_t *p_cam = data;
+
+    vlc_mutex_lock( &p_cam->lock );
+    for( ;; )
+    {
+        /* The CI high level interface needs no polling */
+        while( p_cam->p_first_capmt == NULL && !p_cam->b_dead )
+        {
+            if( p_cam->i_ca_type != CA_CI_LINK )
+                vlc_cond_wait( &p_cam->wait, &p_cam->lock );
+            else if( vlc_cond_timedwait( &p_cam->wait, &p_cam->lock,
+                                         p_cam->i_next_event ) )
+                break;
+        }
+        if( p_cam->b_dead )
+            break;
+
+        cam_capmt_t *p_capmt = p_cam->p_first_capmt;
+        p_cam->p_first_capmt = NULL;
+        p_cam->pp_last_capmt = &p_cam->p_first_capmt;
+        vlc_mutex_unlock( &p_cam->lock );
+
+        vlc_mutex_lock( &p_cam->io_lock );
+        while( p_capmt != NULL )
+        {
+            cam_capmt_t *p_next = p_capmt->p_next;
+
+            SetCAPMT( p_cam, p_capmt->p_info );
+            free( p_capmt );
+            p_capmt = p_next;
+        }
+
+        if( p_cam->i_ca_type == CA_CI_LINK && mdate() > p_cam->i_next_event )
+            Poll( p_cam );
+        vlc_mutex_unlock( &p_cam->io_lock );
+
+        vlc_mutex_lock( &p_cam->lock );
+    }
+    vlc_mutex_unlock( &p_cam->lock );
+    return NULL;
+}
+
+/*****************************************************************************
+ * en50221_SetCAPMT : Queue a CA PMT for the CAM thread
+ *****************************************************************************/
+int en50221_SetCAPMT( cam_t * p_cam, en50221_capmt_info_t *p_info )
+{
+    cam_capmt_t *p_capmt = malloc( sizeof( *p_capmt ) );
+    if( unlikely(p_capmt == NULL) )
+    {
+        en50221_capmt_Delete( p_info );
+        return VLC_ENOMEM;
+    }
+
+    p_capmt->p_next = NULL;
+    p_capmt->p_info = p_info;
 
+    vlc_mutex_lock( &p_cam->lock );
+    *p_cam->pp_last_capmt = p_capmt;
+    p_cam->pp_last_capmt = &p_capmt->p_next;
+    vlc_cond_signal( &p_cam->wait );
+    vlc_mutex_unlock( &p_cam->lock );
     return VLC_SUCCESS;
 }
 
@@ -2354,7 +2444,7 @@ static void en50221_SendMMIObject( cam_t * p_cam, unsigned i_slot,
     msg_Err( p_cam->obj, "SendMMIObject when no MMI session is opened !" );
 }
 
-char *en50221_Status( cam_t *p_cam, char *psz_request )
+static char *Status( cam_t *p_cam, char *psz_request )
 {
     if( psz_request != NULL && *psz_request )
     {
@@ -2599,6 +2689,14 @@ out:
     fclose( p );
     return buf;
 }
+
+char *en50221_Status( cam_t *p_cam, char *psz_request )
+{
+    vlc_mutex_lock( &p_cam->io_lock );
+    char *psz_status = Status( p_cam, psz_request );
+    vlc_mutex_unlock( &p_cam->io_lock );
+    return psz_status;
+}
 #endif
 
 
@@ -2607,6 +2705,20 @@ out:
  *****************************************************************************/
 void en50221_End( cam_t * p_cam )
 {
+    vlc_mutex_lock( &p_cam->lock );
+    p_cam->b_dead = true;
+    vlc_cond_signal( &p_cam->wait );
+    vlc_mutex_unlock( &p_cam->lock );
+    vlc_join( p_cam->thread, NULL );
+
+    for( cam_capmt_t *p_capmt = p_cam->p_first_capmt, *p_next;
+         p_capmt != NULL; p_capmt = p_next )
+    {
+        p_next = p_capmt->p_next;
+        en50221_capmt_Delete( p_capmt->p_info );
+        free( p_capmt );
+    }
+
     for( unsigned i = 0; i < MAX_PROGRAMS; i++ )
     {
         if( p_cam->pp_selected_programs[i] != NULL )
@@ -2624,6 +2736,9 @@ void en50221_End( cam_t * p_cam )
         }
     }
 
+    vlc_cond_destroy( &p_cam->wait );
+    vlc_mutex_destroy( &p_cam->lock );
+    vlc_mutex_destroy( &p_cam->io_lock );
     vlc_close( p_cam->fd );
     free( p_cam );
 }
@@ -142,23 +142,53 @@ static int dvb_parse_fec (uint32_t fec)
 }
 
 
+#define MAX_PIDS 256
+
+/** Frontend tuning properties */
+typedef struct
+{
+    bool set[DTV_MAX_COMMAND + 1];
+    uint32_t val[DTV_MAX_COMMAND + 1];
+} dvb_props_t;
+
+/**
+ * Frontend shared by the inputs of the process. The first input to open it
+ * tunes it; the other inputs can only use it on the same multiplex.
+ */
+typedef struct dvb_frontend
+{
+    struct dvb_frontend *next;
+    uint8_t adapter;
+    uint8_t device;
+    int fd;
+    unsigned refs;
+    dvb_device_t *owner; /**< input tuning the frontend (or NULL) */
+    bool tuned;
+    dvb_props_t props; /**< properties set by the owner */
+} dvb_frontend_t;
+
+static vlc_mutex_t dvb_frontends_lock = VLC_STATIC_MUTEX;
+static dvb_frontend_t *dvb_frontends = NULL;
+
 struct dvb_device
 {
     vlc_object_t *obj;
     int dir;
     int demux;
     int frontend;
-#ifndef USE_DMX
-# define MAX_PIDS 256
+    dvb_frontend_t *fe;
     struct
     {
-        int fd;
+        int fd; /**< PES filter to the DVR, or -1 */
         uint16_t pid;
     } pids[MAX_PIDS];
-#endif
     cam_t *cam;
+    uint8_t adapter;
     uint8_t device;
     bool budget;
+    bool dvr; /**< reading the DVR instead of the demultiplexer tap */
+    bool shared; /**< frontend tuned by another input */
+    dvb_props_t props; /**< properties requested while shared */
     //size_t buffer_size;
 };
 
@@ -192,6 +222,7 @@ dvb_device_t *dvb_open (vlc_object_t *obj)
     d->obj = obj;
 
     uint8_t adapter = var_InheritInteger (obj, "dvb-adapter");
+    d->adapter = adapter;
     d->device = var_InheritInteger (obj, "dvb-device");
 
     d->dir = dvb_open_adapter (adapter);
@@ -203,48 +234,55 @@ dvb_device_t *dvb_open (vlc_object_t *obj)
         return NULL;
     }
     d->frontend = -1;
+    d->fe = NULL;
     d->cam = NULL;
     d->budget = var_InheritBool (obj, "dvb-budget-mode");
+    d->dvr = false;
+    d->shared = false;
+    for (size_t i = 0; i < MAX_PIDS; i++)
+        d->pids[i].pid = d->pids[i].fd = -1;
 
-#ifndef USE_DMX
-    if (d->budget)
-#endif
+    d->demux = dvb_open_node (d, "demux", O_RDONLY);
+    if (d->demux == -1)
     {
-       d->demux = dvb_open_node (d, "demux", O_RDONLY);
-       if (d->demux == -1)
-       {
-           msg_Err (obj, "cannot access demultiplexer: %s",
-                    vlc_strerror_c(errno));
-           vlc_close (d->dir);
-           free (d);
-           return NULL;
-       }
-
-       if (ioctl (d->demux, DMX_SET_BUFFER_SIZE, 1 << 20) < 0)
-           msg_Warn (obj, "cannot expand demultiplexing buffer: %s",
-                     vlc_strerror_c(errno));
+        msg_Err (obj, "cannot access demultiplexer: %s",
+                 vlc_strerror_c(errno));
+        vlc_close (d->dir);
+        free (d);
+        return NULL;
+    }
 
-       /* We need to filter at least one PID. The tap for TS demultiplexing
-        * cannot be configured otherwise. So add the PAT. */
-        struct dmx_pes_filter_params param;
+    if (ioctl (d->demux, DMX_SET_BUFFER_SIZE, 1 << 20) < 0)
+        msg_Warn (obj, "cannot expand demultiplexing buffer: %s",
+                  vlc_strerror_c(errno));
 
-        param.pid = d->budget ? 0x2000 : 0x000;
-        param.input = DMX_IN_FRONTEND;
-        param.output = DMX_OUT_TSDEMUX_TAP;
-        param.pes_type = DMX_PES_OTHER;
-        param.flags = DMX_IMMEDIATE_START;
-        if (ioctl (d->demux, DMX_SET_PES_FILTER, &param) < 0)
-        {
-            msg_Err (obj, "cannot setup TS demultiplexer: %s",
-                     vlc_strerror_c(errno));
-            goto error;
-        }
-#ifndef USE_DMX
+    /* We need to filter at least one PID. The tap for TS demultiplexing
+     * cannot be configured otherwise. So add the PAT. */
+    struct dmx_pes_filter_params param;
+
+    param.pid = d->budget ? 0x2000 : 0x000;
+    param.input = DMX_IN_FRONTEND;
+    param.output = DMX_OUT_TSDEMUX_TAP;
+    param.pes_type = DMX_PES_OTHER;
+    param.flags = DMX_IMMEDIATE_START;
+    if (ioctl (d->demux, DMX_SET_PES_FILTER, &param) < 0)
+    {
+        msg_Err (obj, "cannot setup TS demultiplexer: %s",
+                 vlc_strerror_c(errno));
+        goto error;
     }
-    else
+
+    /* The selected PIDs are added to the tap of this input, so that other
+     * inputs can read their own PIDs from the same tuner at the same time.
+     * Without DMX_ADD_PID (Linux < 2.6.38), there is one PES filter per PID,
+     * all feeding the DVR. */
+    uint16_t pid = 0x1FFF;
+    if (!d->budget && ioctl (d->demux, DMX_ADD_PID, &pid) < 0)
     {
-        for (size_t i = 0; i < MAX_PIDS; i++)
-            d->pids[i].pid = d->pids[i].fd = -1;
+        msg_Dbg (obj, "cannot add PID to the TS demultiplexer: %s",
+                 vlc_strerror_c(errno));
+        vlc_close (d->demux);
+        d->dvr = true;
         d->demux = dvb_open_node (d, "dvr", O_RDONLY);
         if (d->demux == -1)
         {
@@ -253,8 +291,9 @@ dvb_device_t *dvb_open (vlc_object_t *obj)
             free (d);
             return NULL;
         }
-#endif
     }
+    else if (!d->budget)
+        ioctl (d->demux, DMX_REMOVE_PID, &pid);
 
     int ca = dvb_open_node (d, "ca", O_RDWR);
     if (ca != -1)
@@ -273,20 +312,17 @@ error:
     return NULL;
 }
 
+static void dvb_close_frontend (dvb_device_t *);
+
 void dvb_close (dvb_device_t *d)
 {
-#ifndef USE_DMX
-    if (!d->budget)
-    {
-        for (size_t i = 0; i < MAX_PIDS; i++)
-            if (d->pids[i].fd != -1)
-                vlc_close (d->pids[i].fd);
-    }
-#endif
+    for (size_t i = 0; i < MAX_PIDS; i++)
+        if (d->pids[i].fd != -1)
+            vlc_close (d->pids[i].fd);
     if (d->cam != NULL)
         en50221_End (d->cam);
     if (d->frontend != -1)
-        vlc_close (d->frontend);
+        dvb_close_frontend (d);
     vlc_close (d->demux);
     vlc_close (d->dir);
     free (d);
@@ -318,9 +354,6 @@ ssize_t dvb_read (dvb_device_t *d, void *buf, size_t len, int ms)
     struct pollfd ufd[2];
     int n;
 
-    if (d->cam != NULL)
-        en50221_Poll (d->cam);
-
     ufd[0].fd = d->demux;
     ufd[0].events = POLLIN;
     if (d->frontend != -1)
@@ -381,17 +414,23 @@ int dvb_add_pid (dvb_device_t *d, uint16_t pid)
 {
     if (d->budget)
         return 0;
-#ifdef USE_DMX
-    if (pid == 0 || ioctl (d->demux, DMX_ADD_PID, &pid) >= 0)
+
+    if (dvb_get_pid_state (d, pid))
         return 0;
-#else
+
     for (size_t i = 0; i < MAX_PIDS; i++)
     {
-        if (d->pids[i].pid == pid)
-            return 0;
-        if (d->pids[i].fd != -1)
+        if (d->pids[i].pid <= 0x1FFF)
             continue;
 
+        if (!d->dvr)
+        {   /* The PAT is always filtered by the tap */
+            if (pid != 0 && ioctl (d->demux, DMX_ADD_PID, &pid) < 0)
+                goto error;
+            d->pids[i].pid = pid;
+            return 0;
+        }
+
         int fd = dvb_open_node (d, "demux", O_RDONLY);
         if (fd == -1)
             goto error;
@@ -416,7 +455,6 @@ int dvb_add_pid (dvb_device_t *d, uint16_t pid)
     }
     errno = EMFILE;
 error:
-#endif
     msg_Err (d->obj, "cannot add PID 0x%04"PRIu16": %s", pid,
              vlc_strerror_c(errno));
     return -1;
@@ -426,20 +464,19 @@ void dvb_remove_pid (dvb_device_t *d, uint16_t pid)
 {
     if (d->budget)
         return;
-#ifdef USE_DMX
-    if (pid != 0)
-        ioctl (d->demux, DMX_REMOVE_PID, &pid);
-#else
+
     for (size_t i = 0; i < MAX_PIDS; i++)
     {
         if (d->pids[i].pid == pid)
         {
-            vlc_close (d->pids[i].fd);
+            if (d->pids[i].fd != -1)
+                vlc_close (d->pids[i].fd);
+            else if (pid != 0)
+                ioctl (d->demux, DMX_REMOVE_PID, &pid);
             d->pids[i].pid = d->pids[i].fd = -1;
             return;
         }
     }
-#endif
 }
 
 bool dvb_get_pid_state (const dvb_device_t *d, uint16_t pid)
@@ -459,16 +496,91 @@ static int dvb_open_frontend (dvb_device_t *d)
 {
     if (d->frontend != -1)
         return 0;
-    int fd = dvb_open_node (d, "frontend", O_RDWR);
-    if (fd == -1)
+
+    vlc_mutex_lock (&dvb_frontends_lock);
+    dvb_frontend_t *fe;
+    for (fe = dvb_frontends; fe != NULL; fe = fe->next)
+        if (fe->adapter == d->adapter && fe->device == d->device)
+            break;
+
+    if (fe == NULL)
     {
-        msg_Err (d->obj, "cannot access frontend: %s", vlc_strerror_c(errno));
-        return -1;
+        int fd = dvb_open_node (d, "frontend", O_RDWR);
+        if (fd == -1)
+        {
+            vlc_mutex_unlock (&dvb_frontends_lock);
+            msg_Err (d->obj, "cannot access frontend: %s",
+                     vlc_strerror_c(errno));
+            return -1;
+        }
+
+        fe = malloc (sizeof (*fe));
+        if (unlikely(fe == NULL))
+        {
+            vlc_mutex_unlock (&dvb_frontends_lock);
+            vlc_close (fd);
+            return -1;
+        }
+        fe->adapter = d->adapter;
+        fe->device = d->device;
+        fe->fd = fd;
+        fe->refs = 0;
+        fe->owner = d;
+        fe->tuned = false;
+        memset (fe->props.set, 0, sizeof (fe->props.set));
+        fe->next = dvb_frontends;
+        dvb_frontends = fe;
     }
+    else
+    {
+        msg_Dbg (d->obj, "frontend already used by another input");
+        memset (d->props.set, 0, sizeof (d->props.set));
+        d->shared = true;
+    }
+    fe->refs++;
+    vlc_mutex_unlock (&dvb_frontends_lock);
 
-    d->frontend = fd;
+    d->fe = fe;
+    d->frontend = fe->fd;
     return 0;
 }
+
+static void dvb_close_frontend (dvb_device_t *d)
+{
+    dvb_frontend_t *fe = d->fe;
+
+    vlc_mutex_lock (&dvb_frontends_lock);
+    if (fe->owner == d)
+        fe->owner = NULL;
+    if (--fe->refs == 0)
+    {
+        dvb_frontend_t **pp = &dvb_frontends;
+
+        while (*pp != fe)
+            pp = &(*pp)->next;
+        *pp = fe->next;
+        vlc_close (fe->fd);
+        free (fe);
+    }
+    vlc_mutex_unlock (&dvb_frontends_lock);
+}
+
+static void dvb_record_props (dvb_props_t *p, const struct dtv_property *prop,
+                              size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t cmd = prop[i].cmd;
+
+        if (cmd == DTV_CLEAR)
+            memset (p->set, 0, sizeof (p->set));
+        else if (cmd != DTV_TUNE && cmd <= DTV_MAX_COMMAND)
+        {
+            p->set[cmd] = true;
+            p->val[cmd] = prop[i].u.data;
+        }
+    }
+}
 #define dvb_find_frontend(d, sys) (dvb_open_frontend(d))
 
 /**
@@ -663,12 +775,25 @@ static int dvb_vset_props (dvb_device_t *d, size_t n, va_list ap)
         n--;
     }
 
+    if (d->shared)
+    {   /* Checked against the owner tuning by dvb_tune() */
+        dvb_record_props (&d->props, buf, props.num);
+        return 0;
+    }
+
     if (ioctl (d->frontend, FE_SET_PROPERTY, &props) < 0)
     {
         msg_Err (d->obj, "cannot set frontend tuning parameters: %s",
                  vlc_strerror_c(errno));
         return -1;
     }
+
+    vlc_mutex_lock (&dvb_frontends_lock);
+    dvb_record_props (&d->fe->props, buf, props.num);
+    for (size_t i = 0; i < props.num; i++)
+        if (buf[i].cmd == DTV_CLEAR || buf[i].cmd == DTV_TUNE)
+            d->fe->tuned = buf[i].cmd == DTV_TUNE;
+    vlc_mutex_unlock (&dvb_frontends_lock);
     return 0;
 }
 
@@ -701,7 +826,31 @@ int dvb_set_inversion (dvb_device_t *d, int v)
 
 int dvb_tune (dvb_device_t *d)
 {
-    return dvb_set_prop (d, DTV_TUNE, 0 /* dummy */);
+    if (!d->shared)
+        return dvb_set_prop (d, DTV_TUNE, 0 /* dummy */);
+
+    /* Another input tuned the frontend: only check the multiplex matches */
+    const dvb_frontend_t *fe = d->fe;
+    bool same = true;
+
+    vlc_mutex_lock (&dvb_frontends_lock);
+    if (fe->tuned)
+    {
+        for (size_t i = 0; i <= DTV_MAX_COMMAND && same; i++)
+            if (d->props.set[i])
+                same = fe->props.set[i] && fe->props.val[i] == d->props.val[i];
+    }
+    else
+        same = false;
+    vlc_mutex_unlock (&dvb_frontends_lock);
+
+    if (!same)
+    {
+        msg_Err (d->obj, "frontend is busy with another multiplex");
+        return -1;
+    }
+    msg_Dbg (d->obj, "sharing tuned frontend");
+    return 0;
 }
 
 int dvb_fill_device_caps(dvb_device_t *d, dvb_device_caps_t *caps)
@@ -763,7 +912,8 @@ int dvb_set_sec (dvb_device_t *d, uint64_t freq_Hz, char pol,
 
     /* Always try to configure high voltage, but only warn on enable failure */
     int val = var_InheritBool (d->obj, "dvb-high-voltage");
-    if (ioctl (d->frontend, FE_ENABLE_HIGH_LNB_VOLTAGE, &val) < 0 && val)
+    if (!d->shared
+     && ioctl (d->frontend, FE_ENABLE_HIGH_LNB_VOLTAGE, &val) < 0 && val)
         msg_Err (d->obj, "cannot enable high LNB voltage: %s",
                  vlc_strerror_c(errno));
 
@@ -819,8 +969,9 @@ known:
     if (dvb_set_props (d, 2, DTV_TONE, SEC_TONE_OFF, DTV_VOLTAGE, voltage))
         return -1;
 
+    /* The DiSEqC commands must not disturb the other users of the LNB */
     unsigned satno = var_InheritInteger (d->obj, "dvb-satno");
-    if (satno > 0)
+    if (satno > 0 && !d->shared)
     {
 #undef msleep /* we know what we are doing! */
 
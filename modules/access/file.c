@@ -52,6 +52,9 @@
 #   include <unistd.h>
 #endif
 #include <dirent.h>
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include "fs.h"
@@ -64,14 +67,44 @@
 #include <vlc_fs.h>
 #include <vlc_url.h>
 #include <vlc_interrupt.h>
+#if defined (HAVE_LINUX_IO_URING_H) && defined (HAVE_SYS_EVENTFD_H)
+# define HAVE_URING 1
+# include "uring.h"
+
+/* Reads kept in flight, and their size */
+# define FILE_URING_DEPTH 4
+# define FILE_URING_SIZE (256 << 10)
+#endif
 
 struct access_sys_t
 {
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_MMAP
+    uint64_t i_offset; /* current position, for memory mapped reads */
+    uint64_t i_size;
+    size_t   i_page_mask;
+#endif
+#ifdef HAVE_URING
+    struct
+    {
+        struct vlc_uring *ring;
+        block_t *blocks[FILE_URING_DEPTH]; /* in file order from head */
+        ssize_t  results[FILE_URING_DEPTH];
+        bool     done[FILE_URING_DEPTH];
+        unsigned head;
+        unsigned count;
+        uint64_t i_next; /* offset of the next read to submit */
+    } uring;
+#endif
 };
 
+#ifdef HAVE_MMAP
+/* Size of the memory mapped blocks */
+# define FILE_MMAP_WINDOW (1 << 20)
+#endif
+
 #if !defined (_WIN32) && !defined (__OS2__)
 static bool IsRemote (int fd)
 {
@@ -127,9 +160,21 @@ static bool IsRemote (const char *path)
 #ifndef HAVE_POSIX_FADVISE
 # define posix_fadvise(fd, off, len, adv)
 #endif
+#ifndef HAVE_POSIX_MADVISE
+# define posix_madvise(addr, len, adv)
+#endif
 
 static ssize_t Read (access_t *, void *, size_t);
 static int FileSeek (access_t *, uint64_t);
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (access_t *, bool *);
+static int MmapSeek (access_t *, uint64_t);
+#endif
+#ifdef HAVE_URING
+static block_t *UringBlock (access_t *, bool *);
+static int UringSeek (access_t *, uint64_t);
+static void UringDrain (access_sys_t *);
+#endif
 static int NoSeek (access_t *, uint64_t);
 static int FileControl (access_t *, int, va_list);
 
@@ -219,6 +264,9 @@ int FileOpen( vlc_object_t *p_this )
     p_access->pf_control = FileControl;
     p_access->p_sys = p_sys;
     p_sys->fd = fd;
+#ifdef HAVE_URING
+    p_sys->uring.ring = NULL;
+#endif
 
     if (S_ISREG (st.st_mode) || S_ISBLK (st.st_mode))
     {
@@ -237,6 +285,37 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        if (S_ISREG (st.st_mode) && var_InheritBool (p_access, "file-mmap"))
+        {
+            msg_Dbg (p_access, "using memory mapped reads");
+            p_access->pf_read = NULL;
+            p_access->pf_block = MmapBlock;
+            p_access->pf_seek = MmapSeek;
+            p_sys->i_offset = 0;
+            p_sys->i_size = st.st_size;
+            p_sys->i_page_mask = sysconf (_SC_PAGESIZE) - 1;
+        }
+#endif
+#ifdef HAVE_URING
+        if (p_access->pf_read != NULL
+         && var_InheritBool (p_access, "file-io-uring"))
+        {
+            p_sys->uring.ring = vlc_uring_Create (FILE_URING_DEPTH);
+            if (p_sys->uring.ring != NULL)
+            {
+                msg_Dbg (p_access, "using asynchronous reads");
+                p_access->pf_read = NULL;
+                p_access->pf_block = UringBlock;
+                p_access->pf_seek = UringSeek;
+                p_sys->uring.head = 0;
+                p_sys->uring.count = 0;
+                p_sys->uring.i_next = 0;
+            }
+            else
+                msg_Warn (p_access, "io_uring not available");
+        }
 #endif
     }
     else
@@ -259,7 +338,7 @@ void FileClose (vlc_object_t * p_this)
 {
     access_t     *p_access = (access_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_read == NULL && p_access->pf_block == NULL)
     {
         DirClose (p_this);
         return;
@@ -267,6 +346,13 @@ void FileClose (vlc_object_t * p_this)
 
     access_sys_t *p_sys = p_access->p_sys;
 
+#ifdef HAVE_URING
+    if (p_sys->uring.ring != NULL)
+    {
+        UringDrain (p_sys);
+        vlc_uring_Destroy (p_sys->uring.ring);
+    }
+#endif
     vlc_close (p_sys->fd);
     free (p_sys);
 }
@@ -297,6 +383,190 @@ static ssize_t Read (access_t *p_access, void *p_buffer, size_t i_len)
     return val;
 }
 
+#ifdef HAVE_MMAP
+/*****************************************************************************
+ * MmapBlock: hand out the file contents in memory mappings
+ *****************************************************************************/
+static block_t *MmapBlock (access_t *p_access, bool *restrict eof)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    if (p_sys->i_offset >= p_sys->i_size)
+    {   /* The file may still be growing */
+        struct stat st;
+
+        if (fstat (p_sys->fd, &st) == 0)
+            p_sys->i_size = st.st_size;
+        if (p_sys->i_offset >= p_sys->i_size)
+        {
+            *eof = true;
+            return NULL;
+        }
+    }
+
+    uint64_t i_remain = p_sys->i_size - p_sys->i_offset;
+    size_t i_len = (i_remain < FILE_MMAP_WINDOW) ? i_remain : FILE_MMAP_WINDOW;
+    size_t i_skew = p_sys->i_offset & p_sys->i_page_mask;
+
+    /* Writable, as the consumers may modify the data in place; the file is
+     * never written thanks to the private copy-on-write mapping. */
+    uint8_t *p_map = mmap (NULL, i_skew + i_len, PROT_READ|PROT_WRITE,
+                           MAP_PRIVATE, p_sys->fd, p_sys->i_offset - i_skew);
+    block_t *p_block;
+
+    if (p_map != MAP_FAILED)
+    {
+        posix_madvise (p_map, i_skew + i_len, POSIX_MADV_SEQUENTIAL);
+        posix_madvise (p_map, i_skew + i_len, POSIX_MADV_WILLNEED);
+        p_block = block_mmap_Alloc (p_map + i_skew, i_len);
+    }
+    else
+    {
+        msg_Warn (p_access, "cannot map file: %s", vlc_strerror_c(errno));
+
+        p_block = block_Alloc (i_len);
+        if (p_block != NULL)
+        {
+            ssize_t val = pread (p_sys->fd, p_block->p_buffer, i_len,
+                                 p_sys->i_offset);
+            if (val <= 0)
+            {
+                if (val < 0)
+                    msg_Err (p_access, "read error: %s",
+                             vlc_strerror_c(errno));
+                block_Release (p_block);
+                *eof = true;
+                return NULL;
+            }
+            p_block->i_buffer = val;
+        }
+    }
+
+    if (p_block == NULL)
+        return NULL;
+
+    p_sys->i_offset += p_block->i_buffer;
+    /* Start reading the next window from the storage already */
+    posix_fadvise (p_sys->fd, p_sys->i_offset, FILE_MMAP_WINDOW,
+                   POSIX_FADV_WILLNEED);
+    return p_block;
+}
+
+static int MmapSeek (access_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    sys->i_offset = i_pos;
+    return VLC_SUCCESS;
+}
+#endif
+
+#ifdef HAVE_URING
+/*****************************************************************************
+ * UringBlock: read ahead asynchronously, without a thread
+ *****************************************************************************/
+static void UringDrain (access_sys_t *p_sys)
+{
+    /* The buffers in flight belong to the kernel until completion */
+    while (p_sys->uring.count > 0)
+    {
+        unsigned i = p_sys->uring.head;
+
+        while (!p_sys->uring.done[i])
+        {
+            void *opaque;
+            ssize_t res;
+
+            if (vlc_uring_Wait (p_sys->uring.ring, &opaque, &res, false))
+                abort (); /* cannot release the buffer */
+            p_sys->uring.done[(uintptr_t)opaque] = true;
+        }
+
+        block_Release (p_sys->uring.blocks[i]);
+        p_sys->uring.head = (i + 1) % FILE_URING_DEPTH;
+        p_sys->uring.count--;
+    }
+}
+
+static block_t *UringBlock (access_t *p_access, bool *restrict eof)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    /* Keep the read-ahead window full */
+    while (p_sys->uring.count < FILE_URING_DEPTH)
+    {
+        unsigned i = (p_sys->uring.head + p_sys->uring.count)
+                     % FILE_URING_DEPTH;
+        block_t *p_block = block_Alloc (FILE_URING_SIZE);
+
+        if (unlikely(p_block == NULL))
+            break;
+        if (vlc_uring_Read (p_sys->uring.ring, p_sys->fd, p_block->p_buffer,
+                            FILE_URING_SIZE, p_sys->uring.i_next,
+                            (void *)(uintptr_t)i))
+        {
+            block_Release (p_block);
+            break;
+        }
+
+        p_sys->uring.blocks[i] = p_block;
+        p_sys->uring.done[i] = false;
+        p_sys->uring.i_next += FILE_URING_SIZE;
+        p_sys->uring.count++;
+    }
+
+    if (p_sys->uring.count == 0)
+        return NULL;
+
+    unsigned i = p_sys->uring.head;
+    while (!p_sys->uring.done[i])
+    {
+        void *opaque;
+        ssize_t res;
+
+        if (vlc_uring_Wait (p_sys->uring.ring, &opaque, &res, true))
+            return NULL; /* interrupted */
+        p_sys->uring.done[(uintptr_t)opaque] = true;
+        p_sys->uring.results[(uintptr_t)opaque] = res;
+    }
+
+    block_t *p_block = p_sys->uring.blocks[i];
+    ssize_t res = p_sys->uring.results[i];
+    uint64_t i_offset = p_sys->uring.i_next
+                      - (uint64_t)p_sys->uring.count * FILE_URING_SIZE;
+
+    p_sys->uring.head = (i + 1) % FILE_URING_DEPTH;
+    p_sys->uring.count--;
+
+    if (res < FILE_URING_SIZE)
+    {   /* End of file (or error): the reads ahead are void */
+        UringDrain (p_sys);
+        p_sys->uring.i_next = i_offset + ((res > 0) ? res : 0);
+    }
+
+    if (res <= 0)
+    {
+        if (res < 0)
+            msg_Err (p_access, "read error: %s", vlc_strerror_c(-res));
+        block_Release (p_block);
+        *eof = true;
+        return NULL;
+    }
+
+    p_block->i_buffer = res;
+    return p_block;
+}
+
+static int UringSeek (access_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    UringDrain (p_sys);
+    p_sys->uring.i_next = i_pos;
+    return VLC_SUCCESS;
+}
+#endif
+
 /*****************************************************************************
  * Seek: seek to a specific location in a file
  *****************************************************************************/
@@ -36,6 +36,17 @@ vlc_module_begin ()
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_ACCESS )
     add_obsolete_string( "file-cat" )
+#ifdef HAVE_MMAP
+    add_bool( "file-mmap", false, N_("Map files in memory"),
+              N_("Read regular files through memory mappings, without "
+                 "copying their contents. The files must not be truncated "
+                 "while they are being read."), true )
+#endif
+#if defined (HAVE_LINUX_IO_URING_H) && defined (HAVE_SYS_EVENTFD_H)
+    add_bool( "file-io-uring", false, N_("Asynchronous reads"),
+              N_("Read regular files ahead with the Linux io_uring "
+                 "interface."), true )
+#endif
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
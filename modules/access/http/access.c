@@ -255,6 +255,8 @@ static int Open(vlc_object_t *obj)
     }
     else
     {
+        vlc_http_file_set_readahead(sys->resource,
+                            var_InheritInteger(obj, "http-readahead") * 1024);
         access->pf_block = FileRead;
         access->pf_seek = FileSeek;
         access->pf_control = FileControl;
@@ -300,6 +302,11 @@ vlc_module_begin()
              N_("Keep reading a resource that keeps being updated."), true)
         change_safe()
         change_volatile()
+    add_integer_with_range("http-readahead", 256, 0, 16384,
+                           N_("Read-ahead (KiB)"),
+                           N_("Skip data rather than request again when "
+                              "seeking this close, and keep previous "
+                              "responses open to seek back to them."), true)
     add_bool("http-forward-cookies", true, N_("Cookies forwarding"),
              N_("Forward cookies across HTTP redirections."), true)
     add_string("http-referrer", NULL, N_("Referrer"),
@@ -42,6 +42,7 @@ struct vlc_chunked_stream
     struct vlc_http_stream *parent;
     struct vlc_tls *tls;
     uintmax_t chunk_length;
+    size_t read_size;
     bool eof;
     bool error;
 };
@@ -100,7 +101,7 @@ static block_t *vlc_chunked_read(struct vlc_http_stream *stream)
     /* Read chunk data */
     if (s->chunk_length > 0)
     {
-        size_t size = 1536; /* arbitrary */
+        size_t size = s->read_size;
         if (size > s->chunk_length)
             size = s->chunk_length;
 
@@ -117,6 +118,8 @@ static block_t *vlc_chunked_read(struct vlc_http_stream *stream)
 
         block->i_buffer = val;
         s->chunk_length -= val;
+        if (size == s->read_size)
+            s->read_size = vlc_http_read_size(size, val);
     }
     else
         s->eof = true;
@@ -161,6 +164,7 @@ struct vlc_http_stream *vlc_chunked_open(struct vlc_http_stream *parent,
     s->parent = parent;
     s->tls = tls;
     s->chunk_length = 0;
+    s->read_size = VLC_HTTP_READ_MIN;
     s->eof = false;
     s->error = false;
     return &s->stream;
@@ -54,6 +54,29 @@ static inline void vlc_http_conn_release(struct vlc_http_conn *conn)
     conn->cbs->release(conn);
 }
 
+#define VLC_HTTP_READ_MIN  1536 /**< Smallest read size (one packet) */
+#define VLC_HTTP_READ_MAX 65536 /**< Largest read size */
+
+/**
+ * Adjusts the size of the next read from an HTTP/1.x stream.
+ *
+ * Reads return whatever data is available, so that low-latency sources are
+ * not delayed. The read size grows while reads fill the buffer (i.e. data
+ * is backlogged) to cut the per-block overhead at high bit rates, and
+ * shrinks back when reads only return a little data.
+ *
+ * \param size size of the last read buffer
+ * \param got number of bytes actually read
+ */
+static inline size_t vlc_http_read_size(size_t size, size_t got)
+{
+    if (got >= size && size < VLC_HTTP_READ_MAX)
+        return size * 2;
+    if (got < size / 4 && size > VLC_HTTP_READ_MIN)
+        return size / 2;
+    return size;
+}
+
 /**
  * \defgroup http1 HTTP/1.x
  * @{
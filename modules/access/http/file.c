@@ -39,10 +39,23 @@
 
 #pragma GCC visibility push(default)
 
+/** Number of previous responses kept open to serve seeks back */
+#define VLC_HTTP_FILE_PARKED 2
+
+struct vlc_http_file_stream
+{
+    struct vlc_http_msg *response;
+    uintmax_t offset;
+    block_t *pending; /**< data left over from a skip */
+};
+
 struct vlc_http_file
 {
     struct vlc_http_resource resource;
     uintmax_t offset;
+    uintmax_t readahead;
+    block_t *pending;
+    struct vlc_http_file_stream parked[VLC_HTTP_FILE_PARKED];
 };
 
 static int vlc_http_file_req(const struct vlc_http_resource *res,
@@ -104,10 +117,31 @@ fail:
     return -1;
 }
 
+static void vlc_http_file_stream_clean(struct vlc_http_file_stream *st)
+{
+    if (st->pending != NULL)
+        block_Release(st->pending);
+    if (st->response != NULL)
+        vlc_http_msg_destroy(st->response);
+    st->response = NULL;
+    st->pending = NULL;
+}
+
+static void vlc_http_file_deinit(struct vlc_http_resource *res)
+{
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    if (file->pending != NULL)
+        block_Release(file->pending);
+    for (unsigned i = 0; i < VLC_HTTP_FILE_PARKED; i++)
+        vlc_http_file_stream_clean(&file->parked[i]);
+}
+
 static const struct vlc_http_resource_cbs vlc_http_file_callbacks =
 {
     vlc_http_file_req,
     vlc_http_file_resp,
+    vlc_http_file_deinit,
 };
 
 struct vlc_http_resource *vlc_http_file_create(struct vlc_http_mgr *mgr,
@@ -118,6 +152,14 @@ struct vlc_http_resource *vlc_http_file_create(struct vlc_http_mgr *mgr,
     if (unlikely(file == NULL))
         return NULL;
 
+    file->readahead = 0;
+    file->pending = NULL;
+    for (unsigned i = 0; i < VLC_HTTP_FILE_PARKED; i++)
+    {
+        file->parked[i].response = NULL;
+        file->parked[i].pending = NULL;
+    }
+
     if (vlc_http_res_init(&file->resource, &vlc_http_file_callbacks, mgr,
                           uri, ua, ref))
     {
@@ -201,7 +243,122 @@ bool vlc_http_file_can_seek(struct vlc_http_resource *res)
     return vlc_http_msg_can_seek(res->response);
 }
 
-int vlc_http_file_seek(struct vlc_http_resource *res, uintmax_t offset)
+void vlc_http_file_set_readahead(struct vlc_http_resource *res,
+                                 uintmax_t length)
+{
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    file->readahead = length;
+}
+
+/** Checks whether a response still carries payload at a known offset. */
+static bool vlc_http_file_reusable(const struct vlc_http_msg *resp)
+{
+    int status = vlc_http_msg_get_status(resp);
+    return status >= 200 && status < 300;
+}
+
+/**
+ * Moves the current response forward by discarding data.
+ *
+ * This is cheaper than a new request for short distances, all the more so
+ * with HTTP/2 which keeps receiving the stream while it is not read.
+ */
+static int vlc_http_file_skip(struct vlc_http_file *file, uintmax_t length)
+{
+    while (length > 0)
+    {
+        block_t *block = file->pending;
+
+        if (block != NULL)
+            file->pending = NULL;
+        else
+        {
+            block = vlc_http_res_read(&file->resource);
+            if (block == NULL || block == vlc_http_error)
+                return -1;
+        }
+
+        if (block->i_buffer > length)
+        {
+            block->p_buffer += length;
+            block->i_buffer -= length;
+            file->offset += length;
+            file->pending = block;
+            break;
+        }
+
+        length -= block->i_buffer;
+        file->offset += block->i_buffer;
+        block_Release(block);
+    }
+    return 0;
+}
+
+/** Swaps the current response with a parked one. */
+static void vlc_http_file_swap(struct vlc_http_file *file,
+                               struct vlc_http_file_stream *st)
+{
+    struct vlc_http_file_stream cur = {
+        file->resource.response, file->offset, file->pending };
+
+    file->resource.response = st->response;
+    file->offset = st->offset;
+    file->pending = st->pending;
+    *st = cur;
+}
+
+/** Keeps the current response open for later, dropping the oldest one. */
+static void vlc_http_file_park(struct vlc_http_file *file)
+{
+    struct vlc_http_file_stream *last = &file->parked[VLC_HTTP_FILE_PARKED - 1];
+
+    vlc_http_file_stream_clean(last);
+    memmove(file->parked + 1, file->parked,
+            (VLC_HTTP_FILE_PARKED - 1) * sizeof (file->parked[0]));
+    file->parked[0].response = file->resource.response;
+    file->parked[0].offset = file->offset;
+    file->parked[0].pending = file->pending;
+    file->resource.response = NULL;
+    file->pending = NULL;
+}
+
+/**
+ * Tries to serve a seek from the current or a parked response.
+ *
+ * @retval 1 if the seek was served
+ * @retval 0 if no response was close enough
+ * @retval -1 if the current response turned out unusable
+ */
+static int vlc_http_file_reuse(struct vlc_http_file *file, uintmax_t offset)
+{
+    struct vlc_http_resource *res = &file->resource;
+
+    if (res->response != NULL && vlc_http_file_reusable(res->response)
+     && offset >= file->offset && offset - file->offset <= file->readahead)
+        goto skip;
+
+    for (unsigned i = 0; i < VLC_HTTP_FILE_PARKED; i++)
+    {
+        struct vlc_http_file_stream *st = &file->parked[i];
+
+        if (st->response != NULL
+         && offset >= st->offset && offset - st->offset <= file->readahead)
+        {
+            vlc_http_file_swap(file, st);
+            goto skip;
+        }
+    }
+    return 0;
+
+skip:
+    if (vlc_http_file_skip(file, offset - file->offset) == 0)
+        return 1;
+    return -1; /* broken or too short: do not keep it around */
+}
+
+static int vlc_http_file_request(struct vlc_http_resource *res,
+                                 uintmax_t offset, bool park)
 {
     struct vlc_http_msg *resp = vlc_http_res_open(res, &offset);
     if (resp == NULL)
@@ -221,25 +378,59 @@ int vlc_http_file_seek(struct vlc_http_resource *res, uintmax_t offset)
             vlc_http_msg_destroy(resp);
             return -1;
         }
-        vlc_http_msg_destroy(res->response);
+
+        if (park && vlc_http_file_reusable(res->response))
+            vlc_http_file_park(file);
+        else
+            vlc_http_msg_destroy(res->response);
     }
 
+    if (file->pending != NULL)
+    {
+        block_Release(file->pending);
+        file->pending = NULL;
+    }
     res->response = resp;
     file->offset = offset;
     return 0;
 }
 
+int vlc_http_file_seek(struct vlc_http_resource *res, uintmax_t offset)
+{
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    bool park = false;
+
+    if (file->readahead > 0)
+    {
+        int val = vlc_http_file_reuse(file, offset);
+        if (val > 0)
+            return 0;
+        park = val == 0;
+    }
+    return vlc_http_file_request(res, offset, park);
+}
+
 block_t *vlc_http_file_read(struct vlc_http_resource *res)
 {
     struct vlc_http_file *file = (struct vlc_http_file *)res;
-    block_t *block = vlc_http_res_read(res);
+    block_t *block = file->pending;
+
+    if (block != NULL)
+    {
+        file->pending = NULL;
+        file->offset += block->i_buffer;
+        return block;
+    }
+
+    block = vlc_http_res_read(res);
 
     if (block == vlc_http_error)
     {   /* Automatically reconnect on error if server supports seek */
         if (res->response != NULL
          && vlc_http_msg_can_seek(res->response)
          && file->offset < vlc_http_msg_get_file_size(res->response)
-         && vlc_http_file_seek(res, file->offset) == 0)
+         && vlc_http_file_request(res, file->offset, false) == 0)
             block = vlc_http_res_read(res);
 
         if (block == vlc_http_error)
@@ -72,6 +72,19 @@ bool vlc_http_file_can_seek(struct vlc_http_resource *);
  */
 int vlc_http_file_seek(struct vlc_http_resource *, uintmax_t offset);
 
+/**
+ * Sets the read-ahead distance.
+ *
+ * Seeking forward by at most this many bytes discards data from the current
+ * response instead of sending a new request. Responses left behind by other
+ * seeks are also kept open, so that seeking back to them is served the same
+ * way. This is disabled (zero) by default.
+ *
+ * @param length read-ahead distance in bytes
+ */
+void vlc_http_file_set_readahead(struct vlc_http_resource *,
+                                 uintmax_t length);
+
 /**
  * Reads data.
  *
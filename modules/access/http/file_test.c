@@ -30,6 +30,7 @@
 #include <string.h>
 
 #include <vlc_common.h>
+#include <vlc_block.h>
 #include <vlc_http.h>
 #include "resource.h"
 #include "file.h"
@@ -43,6 +44,8 @@ static const char ua[] = PACKAGE_NAME "/" PACKAGE_VERSION " (test suite)";
 
 static const char *replies[2] = { NULL, NULL };
 static uintmax_t offset = 0;
+static size_t body = 0;
+static unsigned requests = 0;
 static bool secure = true;
 static bool etags = false;
 static int lang = -1;
@@ -259,6 +262,63 @@ int main(void)
 
     vlc_http_file_destroy(f);
 
+    /* Read-ahead */
+    replies[0] = "HTTP/1.1 206 Partial Content\r\n"
+                 "Content-Range: bytes 0-9999/10000\r\n"
+                 "ETag: W/\"foobar42\"\r\n"
+                 "\r\n";
+
+    offset = 0;
+    etags = true;
+    secure = true;
+    requests = 0;
+    f = vlc_http_file_create(NULL, url, ua, NULL);
+    assert(f != NULL);
+    vlc_http_file_set_readahead(f, 1000);
+    assert(vlc_http_file_get_size(f) == 10000);
+    assert(requests == 1);
+    body = 10000;
+
+    block_t *b = vlc_http_file_read(f);
+    assert(b != NULL && b->i_buffer == 100);
+    block_Release(b);
+
+    /* Short forward seek skips data */
+    assert(vlc_http_file_seek(f, 550) == 0);
+    assert(requests == 1);
+    assert(body == 10000 - 600);
+    b = vlc_http_file_read(f);
+    assert(b != NULL && b->i_buffer == 50);
+    block_Release(b);
+
+    /* Far seek sends a new request and keeps the previous response */
+    replies[0] = "HTTP/1.1 206 Partial Content\r\n"
+                 "Content-Range: bytes 5000-9999/10000\r\n"
+                 "ETag: W/\"foobar42\"\r\n"
+                 "\r\n";
+    assert(vlc_http_file_seek(f, offset = 5000) == 0);
+    assert(requests == 2);
+    b = vlc_http_file_read(f);
+    assert(b != NULL);
+    block_Release(b);
+
+    /* Seek back is served by the parked response */
+    assert(vlc_http_file_seek(f, 620) == 0);
+    assert(requests == 2);
+    b = vlc_http_file_read(f);
+    assert(b != NULL && b->i_buffer == 80);
+    block_Release(b);
+
+    /* Backward seek within neither */
+    replies[0] = "HTTP/1.1 206 Partial Content\r\n"
+                 "Content-Range: bytes 10-9999/10000\r\n"
+                 "ETag: W/\"foobar42\"\r\n"
+                 "\r\n";
+    assert(vlc_http_file_seek(f, offset = 10) == 0);
+    assert(requests == 3);
+    body = 0;
+    vlc_http_file_destroy(f);
+
     /* Dummy API calls */
     f = vlc_http_file_create(NULL, "ftp://localhost/foo", NULL, NULL);
     assert(f == NULL);
@@ -276,10 +336,11 @@ int main(void)
 #include "h2frame.h"
 
 struct vlc_h2_frame *
-vlc_h2_frame_headers(uint_fast32_t id, uint_fast32_t mtu, bool eos,
+vlc_h2_frame_headers(struct hpack_encoder *enc, uint_fast32_t id,
+                     uint_fast32_t mtu, bool eos,
                      unsigned count, const char *const tab[][2])
 {
-    (void) id; (void) mtu; (void) count, (void) tab;
+    (void) enc; (void) id; (void) mtu; (void) count, (void) tab;
     assert(!eos);
     return NULL;
 }
@@ -313,7 +374,16 @@ static struct vlc_http_msg *stream_read_headers(struct vlc_http_stream *s)
 static struct block_t *stream_read(struct vlc_http_stream *s)
 {
     assert(s == &stream);
-    return NULL;
+
+    if (body == 0)
+        return NULL;
+
+    size_t len = (body < 100) ? body : 100;
+    block_t *block = block_Alloc(len);
+    assert(block != NULL);
+    memset(block->p_buffer, 0, len);
+    body -= len;
+    return block;
 }
 
 static void stream_close(struct vlc_http_stream *s, bool abort)
@@ -339,6 +409,7 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
     char *end;
 
     assert(https == secure);
+    requests++;
     assert(mgr == NULL);
     assert(!strcmp(host, "www.example.com"));
     assert(port == 8443);
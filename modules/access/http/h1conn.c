@@ -112,6 +112,7 @@ struct vlc_h1_conn
     struct vlc_http_conn conn;
     struct vlc_http_stream stream;
     uintmax_t content_length;
+    size_t read_size;
     bool connection_close;
     bool active;
     bool released;
@@ -164,6 +165,7 @@ static struct vlc_http_stream *vlc_h1_stream_open(struct vlc_http_conn *c,
 
     conn->active = true;
     conn->content_length = 0;
+    conn->read_size = VLC_HTTP_READ_MIN;
     conn->connection_close = false;
     return &conn->stream;
 }
@@ -232,7 +234,7 @@ static struct vlc_http_msg *vlc_h1_stream_wait(struct vlc_http_stream *stream)
 static block_t *vlc_h1_stream_read(struct vlc_http_stream *stream)
 {
     struct vlc_h1_conn *conn = vlc_h1_stream_conn(stream);
-    size_t size = 2048;
+    size_t size = conn->read_size;
 
     assert(conn->active);
 
@@ -265,6 +267,8 @@ static block_t *vlc_h1_stream_read(struct vlc_http_stream *stream)
     block->i_buffer = val;
     if (conn->content_length != UINTMAX_MAX)
         conn->content_length -= val;
+    if (size == conn->read_size)
+        conn->read_size = vlc_http_read_size(size, val);
 
     return block;
 }
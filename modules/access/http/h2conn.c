@@ -34,6 +34,7 @@
 #include <vlc_interrupt.h>
 #include <vlc_tls.h>
 
+#include "hpack.h"
 #include "h2frame.h"
 #include "h2output.h"
 #include "conn.h"
@@ -47,11 +48,17 @@ struct vlc_h2_conn
 {
     struct vlc_http_conn conn;
     struct vlc_h2_output *out; /**< Send thread */
+    struct hpack_encoder *encoder; /**< Header compression state (or NULL) */
 
     struct vlc_h2_stream *streams; /**< List of open streams */
     uint32_t next_id; /**< Next free stream identifier */
     bool released; /**< Connection released by owner */
 
+    uint32_t recv_window; /**< Stream receive congestion window size */
+    bool bdp_probing; /**< Whether a BDP estimation PING is in flight */
+    size_t bdp_bytes; /**< Data received since the BDP estimation PING */
+    mtime_t bdp_next; /**< Earliest time of the next BDP estimation */
+
     vlc_mutex_t lock; /**< State machine lock */
     vlc_thread_t thread; /**< Receive thread */
 };
@@ -107,6 +114,34 @@ static int vlc_h2_stream_error(void *ctx, uint_fast32_t id, uint_fast32_t code)
     return vlc_h2_output_send(conn->out, vlc_h2_frame_rst_stream(id, code));
 }
 
+/** Opaque value of the PING frames used to estimate the BDP */
+#define VLC_H2_BDP_PING UINT64_C(0x564c4342445000)
+
+/**
+ * Accounts for received data.
+ *
+ * Data received over one round trip (from a PING to its acknowledgement)
+ * estimates the bandwidth-delay product of the connection.
+ */
+static void vlc_h2_bdp_account(struct vlc_h2_conn *conn, size_t len)
+{
+    if (conn->bdp_probing)
+    {
+        conn->bdp_bytes += len;
+        return;
+    }
+
+    if (conn->recv_window >= VLC_H2_MAX_WINDOW || mdate() < conn->bdp_next)
+        return;
+
+    if (vlc_h2_output_send_prio(conn->out,
+                                vlc_h2_frame_ping(VLC_H2_BDP_PING)) == 0)
+    {
+        conn->bdp_probing = true;
+        conn->bdp_bytes = len;
+    }
+}
+
 static int vlc_h2_stream_fatal(struct vlc_h2_stream *s, uint_fast32_t code)
 {
     s->recv_end = true;
@@ -161,6 +196,7 @@ static int vlc_h2_stream_data(void *ctx, struct vlc_h2_frame *f)
         return vlc_h2_stream_fatal(s, VLC_H2_FLOW_CONTROL_ERROR);
     }
     s->recv_cwnd -= len;
+    vlc_h2_bdp_account(s->conn, len);
 
     *(s->recv_tailp) = f;
     s->recv_tailp = &f->next;
@@ -287,8 +323,8 @@ static block_t *vlc_h2_stream_read(struct vlc_http_stream *stream)
     }
 
     /* Credit the receive window if missing credit exceeds 50%. */
-    uint_fast32_t credit = VLC_H2_INIT_WINDOW - s->recv_cwnd;
-    if (credit >= (VLC_H2_INIT_WINDOW / 2)
+    uint_fast32_t credit = conn->recv_window - s->recv_cwnd;
+    if (credit >= (conn->recv_window / 2)
      && !vlc_h2_output_send(conn->out,
                             vlc_h2_frame_window_update(s->id, credit)))
         s->recv_cwnd += credit;
@@ -412,7 +448,8 @@ static struct vlc_http_stream *vlc_h2_stream_open(struct vlc_http_conn *c,
     s->id = conn->next_id;
     conn->next_id += 2;
 
-    struct vlc_h2_frame *f = vlc_http_msg_h2_frame(msg, s->id, true);
+    struct vlc_h2_frame *f = vlc_http_msg_h2_frame(msg, conn->encoder,
+                                                   s->id, true);
     if (f == NULL)
         goto error;
 
@@ -441,6 +478,9 @@ static void vlc_h2_setting(void *ctx, uint_fast16_t id, uint_fast32_t value)
 
     msg_Dbg(CO(conn), "setting: %s (0x%04"PRIxFAST16"): %"PRIuFAST32,
             vlc_h2_setting_name(id), id, value);
+
+    if (id == VLC_H2_SETTING_HEADER_TABLE_SIZE && conn->encoder != NULL)
+        hpack_encode_resize(conn->encoder, value);
 }
 
 /** Reports end of HTTP/2 peer settings */
@@ -459,6 +499,31 @@ static int vlc_h2_ping(void *ctx, uint_fast64_t opaque)
     return vlc_h2_output_send_prio(conn->out, vlc_h2_frame_pong(opaque));
 }
 
+/** Reports a ping acknowledgement from HTTP/2 peer */
+static void vlc_h2_pong(void *ctx, uint_fast64_t opaque)
+{
+    struct vlc_h2_conn *conn = ctx;
+
+    if (opaque != VLC_H2_BDP_PING || !conn->bdp_probing)
+        return;
+
+    conn->bdp_probing = false;
+
+    /* If the window limited the throughput, grow it to twice the BDP so
+     * that the peer is not stalled waiting for credit. Otherwise, check
+     * again later in case the link capacity changes. */
+    if (conn->bdp_bytes >= conn->recv_window * UINT64_C(2) / 3)
+    {
+        uint64_t window = 2 * (uint64_t)conn->bdp_bytes;
+
+        conn->recv_window = __MIN(window, VLC_H2_MAX_WINDOW);
+        msg_Dbg(CO(conn), "receive window: %"PRIu32" bytes",
+                conn->recv_window);
+    }
+    else
+        conn->bdp_next = mdate() + CLOCK_FREQ;
+}
+
 /** Reports a local HTTP/2 connection failure */
 static void vlc_h2_error(void *ctx, uint_fast32_t code)
 {
@@ -515,6 +580,7 @@ static const struct vlc_h2_parser_cbs vlc_h2_parser_callbacks =
     vlc_h2_setting,
     vlc_h2_settings_done,
     vlc_h2_ping,
+    vlc_h2_pong,
     vlc_h2_error,
     vlc_h2_reset,
     vlc_h2_window_status,
@@ -672,6 +738,8 @@ static void vlc_h2_conn_destroy(struct vlc_h2_conn *conn)
     vlc_mutex_destroy(&conn->lock);
 
     vlc_h2_output_destroy(conn->out);
+    if (conn->encoder != NULL)
+        hpack_encode_destroy(conn->encoder);
     vlc_tls_Shutdown(conn->conn.tls, true);
 
     vlc_tls_Close(conn->conn.tls);
@@ -709,9 +777,14 @@ struct vlc_http_conn *vlc_h2_conn_create(struct vlc_tls *tls)
     conn->conn.cbs = &vlc_h2_conn_callbacks;
     conn->conn.tls = tls;
     conn->out = vlc_h2_output_create(tls, true);
+    /* Without encoder, headers are sent without compression state */
+    conn->encoder = hpack_encode_init(VLC_H2_DEFAULT_MAX_HEADER_TABLE);
     conn->streams = NULL;
     conn->next_id = 1; /* TODO: server side */
     conn->released = false;
+    conn->recv_window = VLC_H2_INIT_WINDOW;
+    conn->bdp_probing = false;
+    conn->bdp_next = 0;
 
     if (unlikely(conn->out == NULL))
         goto error;
@@ -728,6 +801,8 @@ struct vlc_http_conn *vlc_h2_conn_create(struct vlc_tls *tls)
     }
     return &conn->conn;
 error:
+    if (conn->encoder != NULL)
+        hpack_encode_destroy(conn->encoder);
     free(conn);
     return NULL;
 }
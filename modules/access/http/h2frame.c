@@ -150,14 +150,42 @@ enum {
     VLC_H2_CONTINUATION_END_HEADERS = 0x04,
 };
 
+/**
+ * Encodes a header block.
+ *
+ * \param enc HPACK encoder state, or NULL for stateless encoding
+ * \param buf destination buffer (large enough for vlc_h2_headers_bound())
+ * \return the header block size in bytes
+ */
+static size_t vlc_h2_headers_encode(struct hpack_encoder *enc, uint8_t *buf,
+                                    size_t size, unsigned count,
+                                    const char *const headers[][2])
+{
+    if (enc != NULL)
+        return hpack_encode_dyn(enc, buf, size, headers, count);
+    return hpack_encode(buf, size, headers, count);
+}
+
+/** Computes an upper bound for the size of a header block */
+static size_t vlc_h2_headers_bound(struct hpack_encoder *enc, unsigned count,
+                                   const char *const headers[][2])
+{
+    size_t len = hpack_encode(NULL, 0, headers, count);
+
+    if (enc != NULL)
+        len += HPACK_ENCODE_DYN_OVERHEAD;
+    return len;
+}
+
 struct vlc_h2_frame *
-vlc_h2_frame_headers(uint_fast32_t stream_id, uint_fast32_t mtu, bool eos,
+vlc_h2_frame_headers(struct hpack_encoder *enc, uint_fast32_t stream_id,
+                     uint_fast32_t mtu, bool eos,
                      unsigned count, const char *const headers[][2])
 {
     struct vlc_h2_frame *f;
     uint8_t flags = eos ? VLC_H2_HEADERS_END_STREAM : 0;
 
-    size_t len = hpack_encode(NULL, 0, headers, count);
+    size_t len = vlc_h2_headers_bound(enc, count, headers);
 
     if (likely(len <= mtu))
     {   /* Most common case: single frame - with zero copy */
@@ -167,7 +195,12 @@ vlc_h2_frame_headers(uint_fast32_t stream_id, uint_fast32_t mtu, bool eos,
         if (unlikely(f == NULL))
             return NULL;
 
-        hpack_encode(vlc_h2_frame_payload(f), len, headers, count);
+        len = vlc_h2_headers_encode(enc, vlc_h2_frame_payload(f), len,
+                                    count, headers);
+        /* Shrink the frame to the actual header block size */
+        f->data[0] = len >> 16;
+        f->data[1] = len >> 8;
+        f->data[2] = len;
         return f;
     }
 
@@ -176,7 +209,7 @@ vlc_h2_frame_headers(uint_fast32_t stream_id, uint_fast32_t mtu, bool eos,
     if (unlikely(payload == NULL))
         return NULL;
 
-    hpack_encode(payload, len, headers, count);
+    len = vlc_h2_headers_encode(enc, payload, len, count, headers);
 
     struct vlc_h2_frame **pp = &f, *n;
     const uint8_t *offset = payload;
@@ -810,15 +843,16 @@ static int vlc_h2_parse_frame_ping(struct vlc_h2_parser *p,
         return vlc_h2_parse_error(p, VLC_H2_FRAME_SIZE_ERROR);
     }
 
+    memcpy(&opaque, vlc_h2_frame_payload(f), 8);
+
     if (vlc_h2_frame_flags(f) & VLC_H2_PING_ACK)
     {
         free(f);
+        p->cbs->pong(p->opaque, opaque);
         return 0;
     }
 
-    memcpy(&opaque, vlc_h2_frame_payload(f), 8);
     free(f);
-
     return p->cbs->ping(p->opaque, opaque);
 }
 
@@ -94,6 +94,12 @@ static int vlc_h2_ping(void *ctx, uint_fast64_t opaque)
     return 0;
 }
 
+static void vlc_h2_pong(void *ctx, uint_fast64_t opaque)
+{
+    assert(ctx == CTX);
+    (void) opaque;
+}
+
 static uint_fast32_t local_error;
 static uint_fast32_t remote_error;
 
@@ -237,7 +243,8 @@ static struct vlc_h2_frame *localize(struct vlc_h2_frame *f)
 static struct vlc_h2_frame *response(bool eos)
 {
     /* Use ridiculously small MTU to test headers fragmentation */
-    return vlc_h2_frame_headers(STREAM_ID, 16, eos, resp_hdrc, resp_hdrv);
+    return vlc_h2_frame_headers(NULL, STREAM_ID, 16, eos, resp_hdrc,
+                                resp_hdrv);
 }
 
 static struct vlc_h2_frame *data(bool eos)
@@ -302,6 +309,7 @@ static const struct vlc_h2_parser_cbs vlc_h2_frame_test_callbacks =
     vlc_h2_setting,
     vlc_h2_settings_done,
     vlc_h2_ping,
+    vlc_h2_pong,
     vlc_h2_error,
     vlc_h2_reset,
     vlc_h2_window_status,
@@ -424,7 +432,7 @@ int main(void)
 
     ret = test_seq(CTX, rst_stream(),
                         vlc_h2_frame_window_update(0, 0x1000),
-                        vlc_h2_frame_headers(STREAM_ID + 2,
+                        vlc_h2_frame_headers(NULL, STREAM_ID + 2,
                                              VLC_H2_DEFAULT_MAX_FRAME, true,
                                              resp_hdrc, resp_hdrv),
                         NULL);
@@ -25,7 +25,13 @@
  * @{
  */
 
+/** Static table header names */
+extern const char hpack_names[61][28];
+/** Static table header values (the others are empty) */
+extern const char hpack_values[16][14];
+
 struct hpack_decoder;
+struct hpack_encoder;
 
 struct hpack_decoder *hpack_decode_init(size_t header_table_size);
 void hpack_decode_destroy(struct hpack_decoder *);
@@ -38,4 +44,25 @@ size_t hpack_encode_hdr_neverindex(uint8_t *restrict buf, size_t size,
 size_t hpack_encode(uint8_t *restrict buf, size_t size,
                     const char *const headers[][2], unsigned count);
 
+struct hpack_encoder *hpack_encode_init(size_t header_table_size);
+void hpack_encode_destroy(struct hpack_encoder *);
+void hpack_encode_resize(struct hpack_encoder *, size_t header_table_size);
+
+/** Maximum size of the dynamic table size updates in a header block */
+#define HPACK_ENCODE_DYN_OVERHEAD 6
+
+/**
+ * Encodes a header block using the dynamic table.
+ *
+ * Unlike hpack_encode(), this updates the encoder state, so it must be
+ * called exactly once per header block, in the order the blocks are sent.
+ * The buffer must be at least HPACK_ENCODE_DYN_OVERHEAD bytes larger than
+ * the stateless encoding of the same headers (i.e. hpack_encode()).
+ *
+ * \return the actual size of the header block in bytes
+ */
+size_t hpack_encode_dyn(struct hpack_encoder *enc, uint8_t *restrict buf,
+                        size_t size, const char *const headers[][2],
+                        unsigned count);
+
 /** @} */
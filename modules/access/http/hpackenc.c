@@ -27,21 +27,169 @@
 #endif
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 
 #include "hpack.h"
 
 /*
- * This is curently the simplest possible HPACK compressor: it does not
- * compress anything and is stateless.
+ * This HPACK compressor uses the static table, and the static Huffman code
+ * whenever it shortens a string. The stateful variant also indexes headers
+ * in the dynamic table.
  * TODO:
- *  - use static Huffman compression when useful,
- *  - use header names and values from the static HPACK table,
- *  - become stateful and let the caller specify the indexed flag,
  *  - let caller specify the never-indexed flag.
  */
 
+/** Static Huffman codes (RFC 7541 appendix B) */
+static const uint32_t hpack_huffman_codes[256] =
+{
+    0x00001ff8, 0x007fffd8, 0x0fffffe2, 0x0fffffe3, 0x0fffffe4, 0x0fffffe5,
+    0x0fffffe6, 0x0fffffe7, 0x0fffffe8, 0x00ffffea, 0x3ffffffc, 0x0fffffe9,
+    0x0fffffea, 0x3ffffffd, 0x0fffffeb, 0x0fffffec, 0x0fffffed, 0x0fffffee,
+    0x0fffffef, 0x0ffffff0, 0x0ffffff1, 0x0ffffff2, 0x3ffffffe, 0x0ffffff3,
+    0x0ffffff4, 0x0ffffff5, 0x0ffffff6, 0x0ffffff7, 0x0ffffff8, 0x0ffffff9,
+    0x0ffffffa, 0x0ffffffb, 0x00000014, 0x000003f8, 0x000003f9, 0x00000ffa,
+    0x00001ff9, 0x00000015, 0x000000f8, 0x000007fa, 0x000003fa, 0x000003fb,
+    0x000000f9, 0x000007fb, 0x000000fa, 0x00000016, 0x00000017, 0x00000018,
+    0x00000000, 0x00000001, 0x00000002, 0x00000019, 0x0000001a, 0x0000001b,
+    0x0000001c, 0x0000001d, 0x0000001e, 0x0000001f, 0x0000005c, 0x000000fb,
+    0x00007ffc, 0x00000020, 0x00000ffb, 0x000003fc, 0x00001ffa, 0x00000021,
+    0x0000005d, 0x0000005e, 0x0000005f, 0x00000060, 0x00000061, 0x00000062,
+    0x00000063, 0x00000064, 0x00000065, 0x00000066, 0x00000067, 0x00000068,
+    0x00000069, 0x0000006a, 0x0000006b, 0x0000006c, 0x0000006d, 0x0000006e,
+    0x0000006f, 0x00000070, 0x00000071, 0x00000072, 0x000000fc, 0x00000073,
+    0x000000fd, 0x00001ffb, 0x0007fff0, 0x00001ffc, 0x00003ffc, 0x00000022,
+    0x00007ffd, 0x00000003, 0x00000023, 0x00000004, 0x00000024, 0x00000005,
+    0x00000025, 0x00000026, 0x00000027, 0x00000006, 0x00000074, 0x00000075,
+    0x00000028, 0x00000029, 0x0000002a, 0x00000007, 0x0000002b, 0x00000076,
+    0x0000002c, 0x00000008, 0x00000009, 0x0000002d, 0x00000077, 0x00000078,
+    0x00000079, 0x0000007a, 0x0000007b, 0x00007ffe, 0x000007fc, 0x00003ffd,
+    0x00001ffd, 0x0ffffffc, 0x000fffe6, 0x003fffd2, 0x000fffe7, 0x000fffe8,
+    0x003fffd3, 0x003fffd4, 0x003fffd5, 0x007fffd9, 0x003fffd6, 0x007fffda,
+    0x007fffdb, 0x007fffdc, 0x007fffdd, 0x007fffde, 0x00ffffeb, 0x007fffdf,
+    0x00ffffec, 0x00ffffed, 0x003fffd7, 0x007fffe0, 0x00ffffee, 0x007fffe1,
+    0x007fffe2, 0x007fffe3, 0x007fffe4, 0x001fffdc, 0x003fffd8, 0x007fffe5,
+    0x003fffd9, 0x007fffe6, 0x007fffe7, 0x00ffffef, 0x003fffda, 0x001fffdd,
+    0x000fffe9, 0x003fffdb, 0x003fffdc, 0x007fffe8, 0x007fffe9, 0x001fffde,
+    0x007fffea, 0x003fffdd, 0x003fffde, 0x00fffff0, 0x001fffdf, 0x003fffdf,
+    0x007fffeb, 0x007fffec, 0x001fffe0, 0x001fffe1, 0x003fffe0, 0x001fffe2,
+    0x007fffed, 0x003fffe1, 0x007fffee, 0x007fffef, 0x000fffea, 0x003fffe2,
+    0x003fffe3, 0x003fffe4, 0x007ffff0, 0x003fffe5, 0x003fffe6, 0x007ffff1,
+    0x03ffffe0, 0x03ffffe1, 0x000fffeb, 0x0007fff1, 0x003fffe7, 0x007ffff2,
+    0x003fffe8, 0x01ffffec, 0x03ffffe2, 0x03ffffe3, 0x03ffffe4, 0x07ffffde,
+    0x07ffffdf, 0x03ffffe5, 0x00fffff1, 0x01ffffed, 0x0007fff2, 0x001fffe3,
+    0x03ffffe6, 0x07ffffe0, 0x07ffffe1, 0x03ffffe7, 0x07ffffe2, 0x00fffff2,
+    0x001fffe4, 0x001fffe5, 0x03ffffe8, 0x03ffffe9, 0x0ffffffd, 0x07ffffe3,
+    0x07ffffe4, 0x07ffffe5, 0x000fffec, 0x00fffff3, 0x000fffed, 0x001fffe6,
+    0x003fffe9, 0x001fffe7, 0x001fffe8, 0x007ffff3, 0x003fffea, 0x003fffeb,
+    0x01ffffee, 0x01ffffef, 0x00fffff4, 0x00fffff5, 0x03ffffea, 0x007ffff4,
+    0x03ffffeb, 0x07ffffe6, 0x03ffffec, 0x03ffffed, 0x07ffffe7, 0x07ffffe8,
+    0x07ffffe9, 0x07ffffea, 0x07ffffeb, 0x0ffffffe, 0x07ffffec, 0x07ffffed,
+    0x07ffffee, 0x07ffffef, 0x07fffff0, 0x03ffffee,
+};
+
+/** Static Huffman code lengths in bits */
+static const uint8_t hpack_huffman_lengths[256] =
+{
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+     6, 10, 10, 12, 13,  6,  8, 11, 10, 10,  8, 11,  8,  6,  6,  6,
+     5,  5,  5,  6,  6,  6,  6,  6,  6,  6,  7,  8, 15,  6, 12, 10,
+    13,  6,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,
+     7,  7,  7,  7,  7,  7,  7,  7,  8,  7,  8, 13, 19, 13, 14,  6,
+    15,  5,  6,  5,  6,  5,  6,  6,  6,  5,  7,  7,  6,  6,  6,  5,
+     6,  7,  6,  5,  5,  6,  7,  7,  7,  7,  7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+};
+
+#define HPACK_STATIC_ENTRIES (sizeof (hpack_names) / sizeof (hpack_names[0]))
+#define HPACK_STATIC_VALUES (sizeof (hpack_values) / sizeof (hpack_values[0]))
+
+struct hpack_encoder
+{
+    char **table; /**< Dynamic table entries, oldest first */
+    size_t entries;
+    size_t size;
+    size_t max_size;
+    size_t limit; /**< Table size limit set by the encoder owner */
+    size_t update_min; /**< Smallest table size since the last block */
+    bool update; /**< Whether a table size update must be signaled */
+};
+
+struct hpack_encoder *hpack_encode_init(size_t header_table_size)
+{
+    struct hpack_encoder *enc = malloc(sizeof (*enc));
+    if (enc == NULL)
+        return NULL;
+
+    enc->table = NULL;
+    enc->entries = 0;
+    enc->size = 0;
+    enc->max_size = header_table_size;
+    enc->limit = header_table_size;
+    enc->update = false;
+    return enc;
+}
+
+void hpack_encode_destroy(struct hpack_encoder *enc)
+{
+    for (size_t i = 0; i < enc->entries; i++)
+        free(enc->table[i]);
+    free(enc->table);
+    free(enc);
+}
+
+static void hpack_encode_evict(struct hpack_encoder *enc, size_t max_size)
+{
+    size_t evicted = 0;
+
+    while (enc->size > max_size)
+    {
+        assert(evicted < enc->entries);
+
+        size_t namelen = strlen(enc->table[evicted]);
+        size_t valuelen = strlen(enc->table[evicted] + namelen + 1);
+
+        enc->size -= 32 + namelen + valuelen;
+        free(enc->table[evicted]);
+        evicted++;
+    }
+
+    if (evicted > 0)
+    {
+        enc->entries -= evicted;
+        memmove(enc->table, enc->table + evicted,
+                sizeof (enc->table[0]) * enc->entries);
+    }
+}
+
+void hpack_encode_resize(struct hpack_encoder *enc, size_t header_table_size)
+{
+    size_t max_size = header_table_size;
+
+    if (max_size > enc->limit)
+        max_size = enc->limit;
+    if (max_size == enc->max_size)
+        return;
+
+    hpack_encode_evict(enc, max_size);
+
+    if (!enc->update || max_size < enc->update_min)
+        enc->update_min = max_size;
+    enc->max_size = max_size;
+    enc->update = true;
+}
+
 static size_t hpack_encode_int(uint8_t *restrict buf, size_t size,
                                uintmax_t value, unsigned n)
 {
@@ -73,82 +221,149 @@ static size_t hpack_encode_int(uint8_t *restrict buf, size_t size,
     return ret;
 }
 
-static size_t hpack_encode_str_raw(uint8_t *restrict buf, size_t size,
-                                   const char *str)
+static unsigned char hpack_lower(unsigned char c, bool lower)
+{
+    if (lower && c >= 'A' && c <= 'Z')
+        c += 'a' - 'A';
+    return c;
+}
+
+static size_t hpack_huffman_length(const char *str, size_t len, bool lower)
+{
+    size_t bits = 0;
+
+    for (size_t i = 0; i < len; i++)
+        bits += hpack_huffman_lengths[hpack_lower(str[i], lower)];
+    return (bits + 7) / 8;
+}
+
+static size_t hpack_encode_str(uint8_t *restrict buf, size_t size,
+                               const char *str, bool lower)
 {
     size_t len = strlen(str);
+    size_t hlen = hpack_huffman_length(str, len, lower);
+    bool huffman = hlen < len;
 
     if (size > 0)
-        *buf = 0;
+        *buf = huffman ? 0x80 : 0;
 
-    size_t ret = hpack_encode_int(buf, size, len, 7);
+    size_t ret = hpack_encode_int(buf, size, huffman ? hlen : len, 7);
     if (ret < size)
     {
         buf += ret;
         size -= ret;
+    }
+    else
+        size = 0;
 
-        memcpy(buf, str, (len <= size) ? len : size);
+    if (!huffman)
+    {
+        for (size_t i = 0; i < len && i < size; i++)
+            buf[i] = hpack_lower(str[i], lower);
+        return ret + len;
     }
-    ret += len;
-    return ret;
+
+    uint_fast64_t acc = 0;
+    unsigned bits = 0;
+    size_t out = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        unsigned char c = hpack_lower(str[i], lower);
+
+        acc = (acc << hpack_huffman_lengths[c]) | hpack_huffman_codes[c];
+        bits += hpack_huffman_lengths[c];
+
+        while (bits >= 8)
+        {
+            bits -= 8;
+            if (out < size)
+                buf[out] = acc >> bits;
+            out++;
+        }
+    }
+
+    if (bits > 0)
+    {   /* Pad with the most significant bits of EOS (all ones) */
+        if (out < size)
+            buf[out] = (acc << (8 - bits)) | (0xFF >> bits);
+        out++;
+    }
+
+    assert(out == hlen);
+    return ret + out;
 }
 
-static size_t hpack_encode_str_raw_lower(uint8_t *restrict buf, size_t size,
-                                         const char *str)
+/**
+ * Looks a header up in the static table.
+ * @return the index of the entry matching the name (and the value if
+ * possible), or zero if none
+ */
+static unsigned hpack_find_static(const char *name, const char *value,
+                                  bool *restrict exact)
 {
-    size_t len = strlen(str);
+    unsigned idx = 0;
 
-    if (size > 0)
-        *buf = 0;
+    *exact = false;
 
-    size_t ret = hpack_encode_int(buf, size, len, 7);
-    if (ret < size)
+    for (unsigned i = 0; i < HPACK_STATIC_ENTRIES; i++)
     {
-        buf += ret;
-        size -= ret;
+        if (strcasecmp(hpack_names[i], name))
+            continue;
 
-        for (size_t i = 0; i < len && i < size; i++)
-            if (str[i] < 'A' || str[i] > 'Z')
-                buf[i] = str[i];
-            else
-                buf[i] = str[i] - 'A' + 'a';
+        const char *v = (i < HPACK_STATIC_VALUES) ? hpack_values[i] : "";
+        if (!strcmp(v, value))
+        {
+            *exact = true;
+            return i + 1;
+        }
+        if (idx == 0)
+            idx = i + 1;
     }
-    ret += len;
-    return ret;
+    return idx;
 }
 
-size_t hpack_encode_hdr_neverindex(uint8_t *restrict buf, size_t size,
-                                   const char *name, const char *value)
+static size_t hpack_encode_hdr(uint8_t *restrict buf, size_t size,
+                               uint8_t prefix, unsigned n, unsigned idx,
+                               const char *name, const char *value)
 {
-    size_t ret = 1, val;
+    size_t ret, val;
 
     if (size > 0)
-    {
-        *(buf++) = 0x10;
-        size--;
-    }
+        *buf = prefix;
 
-    val = hpack_encode_str_raw_lower(buf, size, name);
-    if (size >= val)
+    ret = hpack_encode_int(buf, size, idx, n);
+    if (size >= ret)
     {
-        buf += val;
-        size -= val;
+        buf += ret;
+        size -= ret;
     }
     else
         size = 0;
-    ret += val;
 
-    val = hpack_encode_str_raw(buf, size, value);
-    if (size >= val)
+    if (idx == 0)
     {
-        buf += val;
-        size -= val;
+        val = hpack_encode_str(buf, size, name, true);
+        if (size >= val)
+        {
+            buf += val;
+            size -= val;
+        }
+        else
+            size = 0;
+        ret += val;
     }
-    else
-        size = 0;
-    ret += val;
 
-    return ret;
+    return ret + hpack_encode_str(buf, size, value, false);
+}
+
+size_t hpack_encode_hdr_neverindex(uint8_t *restrict buf, size_t size,
+                                   const char *name, const char *value)
+{
+    bool exact;
+    unsigned idx = hpack_find_static(name, value, &exact);
+
+    return hpack_encode_hdr(buf, size, 0x10, 4, idx, name, value);
 }
 
 size_t hpack_encode(uint8_t *restrict buf, size_t size,
@@ -175,6 +390,153 @@ size_t hpack_encode(uint8_t *restrict buf, size_t size,
     return ret;
 }
 
+/** Headers that must not be compressed (to defeat CRIME-like attacks) */
+static bool hpack_is_sensitive(const char *name)
+{
+    return !strcasecmp(name, "authorization")
+        || !strcasecmp(name, "proxy-authorization")
+        || !strcasecmp(name, "cookie");
+}
+
+/** Headers that change with (nearly) every request */
+static bool hpack_is_volatile(const char *name)
+{
+    return !strcasecmp(name, ":path") || !strcasecmp(name, "range");
+}
+
+/**
+ * Looks a header up in the dynamic table.
+ * @return the index of the entry matching the name (and the value if
+ * possible), or zero if none
+ */
+static unsigned hpack_find_dynamic(const struct hpack_encoder *enc,
+                                   const char *name, const char *value,
+                                   bool *restrict exact)
+{
+    unsigned idx = 0;
+
+    *exact = false;
+
+    for (size_t i = 0; i < enc->entries; i++)
+    {
+        const char *entry = enc->table[enc->entries - (i + 1)];
+
+        if (strcasecmp(entry, name))
+            continue;
+
+        if (!strcmp(entry + strlen(entry) + 1, value))
+        {
+            *exact = true;
+            return HPACK_STATIC_ENTRIES + i + 1;
+        }
+        if (idx == 0)
+            idx = HPACK_STATIC_ENTRIES + i + 1;
+    }
+    return idx;
+}
+
+static void hpack_encode_append(struct hpack_encoder *enc,
+                                const char *name, const char *value)
+{
+    size_t namelen = strlen(name), valuelen = strlen(value);
+    size_t entry_size = 32 + namelen + valuelen;
+
+    assert(entry_size <= enc->max_size);
+    hpack_encode_evict(enc, enc->max_size - entry_size);
+
+    char *entry = malloc(namelen + valuelen + 2);
+    char **newtab = realloc(enc->table,
+                            sizeof (enc->table[0]) * (enc->entries + 1));
+    if (newtab != NULL)
+        enc->table = newtab;
+    if (entry == NULL || newtab == NULL)
+    {   /* Keep in sync with the decoder: forget everything */
+        free(entry);
+        hpack_encode_evict(enc, 0);
+        return;
+    }
+
+    for (size_t i = 0; i < namelen; i++)
+        entry[i] = hpack_lower(name[i], true);
+    entry[namelen] = '\0';
+    memcpy(entry + namelen + 1, value, valuelen + 1);
+
+    enc->table[enc->entries++] = entry;
+    enc->size += entry_size;
+}
+
+size_t hpack_encode_dyn(struct hpack_encoder *enc, uint8_t *restrict buf,
+                        size_t size, const char *const headers[][2],
+                        unsigned count)
+{
+    size_t ret = 0, val;
+
+    if (enc->update)
+    {   /* Signal the smallest table size, then the current one */
+        if (enc->update_min < enc->max_size)
+        {
+            *buf = 0x20;
+            val = hpack_encode_int(buf, size, enc->update_min, 5);
+            assert(val <= size);
+            buf += val;
+            size -= val;
+            ret += val;
+        }
+
+        *buf = 0x20;
+        val = hpack_encode_int(buf, size, enc->max_size, 5);
+        assert(val <= size);
+        buf += val;
+        size -= val;
+        ret += val;
+        enc->update = false;
+    }
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        const char *name = headers[i][0], *value = headers[i][1];
+        bool exact;
+        unsigned idx = hpack_find_static(name, value, &exact);
+
+        if (!exact)
+        {
+            bool dyn_exact;
+            unsigned dyn_idx = hpack_find_dynamic(enc, name, value,
+                                                  &dyn_exact);
+
+            if (dyn_exact || idx == 0)
+            {
+                idx = dyn_idx;
+                exact = dyn_exact;
+            }
+        }
+
+        if (exact)
+        {   /* Indexed header field */
+            *buf = 0x80;
+            val = hpack_encode_int(buf, size, idx, 7);
+        }
+        else
+        if (hpack_is_sensitive(name))
+            val = hpack_encode_hdr(buf, size, 0x10, 4, idx, name, value);
+        else
+        if (hpack_is_volatile(name)
+         || 32 + strlen(name) + strlen(value) > enc->max_size)
+            val = hpack_encode_hdr(buf, size, 0x00, 4, idx, name, value);
+        else
+        {   /* Literal header field with incremental indexing */
+            val = hpack_encode_hdr(buf, size, 0x40, 6, idx, name, value);
+            hpack_encode_append(enc, name, value);
+        }
+
+        assert(val <= size);
+        buf += val;
+        size -= val;
+        ret += val;
+    }
+    return ret;
+}
+
 /*** Test cases ***/
 #ifdef ENC_TEST
 # include <stdarg.h>
@@ -287,10 +649,72 @@ static void test_resps(void)
                NULL);
 }
 
+static void test_dyn_block(struct hpack_encoder *enc,
+                           struct hpack_decoder *dec,
+                           const char *const headers[][2], unsigned count,
+                           size_t *restrict lengthp)
+{
+    size_t bound = hpack_encode(NULL, 0, headers, count)
+                 + HPACK_ENCODE_DYN_OVERHEAD;
+    uint8_t buf[bound];
+
+    size_t length = hpack_encode_dyn(enc, buf, bound, headers, count);
+    assert(length <= bound);
+
+    char *eheaders[16][2];
+    int ecount = hpack_decode(dec, buf, length, eheaders, 16);
+    assert((unsigned)ecount == count);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        test_lowercase(eheaders[i][0]);
+        assert(!strcasecmp(eheaders[i][0], headers[i][0]));
+        assert(!strcmp(eheaders[i][1], headers[i][1]));
+        free(eheaders[i][1]);
+        free(eheaders[i][0]);
+    }
+    *lengthp = length;
+}
+
+static void test_dyn(void)
+{
+    const char *headers[][2] = {
+        { ":method", "GET" }, { ":scheme", "https" },
+        { ":authority", "www.example.com" }, { ":path", "/seg1.ts" },
+        { "User-Agent", "VLC/3.0.0 LibVLC/3.0.0" },
+        { "Accept", "*/*" }, { "Accept-Language", "en_US" },
+        { "Cookie", "secret=1" },
+    };
+    const unsigned count = sizeof (headers) / sizeof (headers[0]);
+    size_t first, next;
+
+    struct hpack_encoder *enc = hpack_encode_init(4096);
+    struct hpack_decoder *dec = hpack_decode_init(4096);
+    assert(enc != NULL && dec != NULL);
+
+    test_dyn_block(enc, dec, headers, count, &first);
+    headers[3][1] = "/seg2.ts";
+    test_dyn_block(enc, dec, headers, count, &next);
+    printf(" dynamic table: %zu then %zu bytes\n", first, next);
+    assert(next < first);
+
+    /* Shrink the table: entries are evicted on both ends */
+    hpack_encode_resize(enc, 64);
+    test_dyn_block(enc, dec, headers, count, &next);
+    hpack_encode_resize(enc, 0);
+    hpack_encode_resize(enc, 4096);
+    test_dyn_block(enc, dec, headers, count, &next);
+    test_dyn_block(enc, dec, headers, count, &next);
+
+    hpack_decode_destroy(dec);
+    hpack_encode_destroy(enc);
+}
+
 int main(void)
 {
     test_integers();
     test_reqs();
     test_resps();
+    test_dyn();
 }
 #endif /* TEST */
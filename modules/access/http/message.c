@@ -405,6 +405,7 @@ error:
 }
 
 struct vlc_h2_frame *vlc_http_msg_h2_frame(const struct vlc_http_msg *m,
+                                           struct hpack_encoder *enc,
                                            uint_fast32_t stream_id, bool eos)
 {
     for (unsigned j = 0; j < m->count; j++)
@@ -460,7 +461,7 @@ struct vlc_h2_frame *vlc_http_msg_h2_frame(const struct vlc_http_msg *m,
         i += m->count;
     }
 
-    f = vlc_h2_frame_headers(stream_id, VLC_H2_DEFAULT_MAX_FRAME, eos,
+    f = vlc_h2_frame_headers(enc, stream_id, VLC_H2_DEFAULT_MAX_FRAME, eos,
                              i, headers);
     free(headers);
     return f;
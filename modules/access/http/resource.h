@@ -38,6 +38,8 @@ struct vlc_http_resource_cbs
                           struct vlc_http_msg *, void *);
     int (*response_validate)(const struct vlc_http_resource *,
                              const struct vlc_http_msg *, void *);
+    /** Releases type-specific data (or NULL if none) */
+    void (*destroy)(struct vlc_http_resource *);
 };
 
 struct vlc_http_resource
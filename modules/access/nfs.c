@@ -49,6 +49,12 @@
 #define AUTO_GUID_TEXT N_("Set NFS uid/guid automatically")
 #define AUTO_GUID_LONGTEXT N_("If uid/gid are not specified in " \
     "the url, this module will try to automatically set a uid/gid.")
+#define READ_SIZE_TEXT N_("Read size")
+#define READ_SIZE_LONGTEXT N_("Size in bytes of each NFS read request.")
+#define READ_WINDOW_TEXT N_("Read requests in flight")
+#define READ_WINDOW_LONGTEXT N_("Number of read requests sent ahead of " \
+    "the reading position, to hide the network latency. " \
+    "0 reads synchronously.")
 
 static int Open(vlc_object_t *);
 static void Close(vlc_object_t *);
@@ -59,11 +65,26 @@ vlc_module_begin()
     set_category(CAT_INPUT)
     set_subcategory(SUBCAT_INPUT_ACCESS)
     add_bool("nfs-auto-guid", true, AUTO_GUID_TEXT, AUTO_GUID_LONGTEXT, true)
+    add_integer_with_range("nfs-read-size", 1 << 18, 1 << 12, 1 << 24,
+                           READ_SIZE_TEXT, READ_SIZE_LONGTEXT, true)
+    add_integer_with_range("nfs-read-window", 4, 0, 64,
+                           READ_WINDOW_TEXT, READ_WINDOW_LONGTEXT, true)
     set_capability("access", 2)
     add_shortcut("nfs")
     set_callbacks(Open, Close)
 vlc_module_end()
 
+struct nfs_read_req
+{
+    access_t *      p_access;
+    uint8_t *       p_buf;
+    uint64_t        i_offset;
+    size_t          i_len; /* received bytes */
+    bool            b_pending;
+    bool            b_done;
+    bool            b_stale; /* pending, but not needed anymore */
+};
+
 struct access_sys_t
 {
     struct rpc_context *    p_mount; /* used to to get exports mount point */
@@ -79,6 +100,17 @@ struct access_sys_t
     bool                    b_error;
     bool                    b_auto_guid;
 
+    /* Read requests sent ahead of the reading position */
+    struct
+    {
+        struct nfs_read_req *   p_reqs;
+        struct nfs_read_req *   p_head;
+        unsigned                i_count;
+        size_t                  i_size;
+        uint64_t                i_pos;
+        uint64_t                i_next; /* offset of the next request */
+    } pipe;
+
     union {
         struct
         {
@@ -223,6 +255,161 @@ FileRead(access_t *p_access, void *p_buf, size_t i_len)
     return p_sys->res.read.i_len;
 }
 
+static void
+nfs_pread_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
+             void *p_private_data)
+{
+    VLC_UNUSED(p_nfs);
+    struct nfs_read_req *p_req = p_private_data;
+    access_t *p_access = p_req->p_access;
+
+    p_req->b_pending = false;
+    if (p_req->b_stale)
+    {
+        p_req->b_stale = false;
+        return;
+    }
+    if (NFS_CHECK_STATUS(p_access, i_status, p_data))
+        return;
+
+    memcpy(p_req->p_buf, p_data, i_status);
+    p_req->i_len = i_status;
+    p_req->b_done = true;
+}
+
+static bool
+nfs_pread_finished_cb(access_t *p_access)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    return p_sys->pipe.p_head->b_done;
+}
+
+static struct nfs_read_req *
+FindReadReq(access_sys_t *p_sys, uint64_t i_pos)
+{
+    for (unsigned i = 0; i < p_sys->pipe.i_count; i++)
+    {
+        struct nfs_read_req *p_req = &p_sys->pipe.p_reqs[i];
+
+        if ((p_req->b_pending && !p_req->b_stale) || p_req->b_done)
+            if (i_pos >= p_req->i_offset
+             && i_pos - p_req->i_offset < p_sys->pipe.i_size)
+                return p_req;
+    }
+    return NULL;
+}
+
+/* Drops the requests ending before i_pos, or all if b_all */
+static void
+DropReadReqs(access_sys_t *p_sys, uint64_t i_pos, bool b_all)
+{
+    for (unsigned i = 0; i < p_sys->pipe.i_count; i++)
+    {
+        struct nfs_read_req *p_req = &p_sys->pipe.p_reqs[i];
+
+        if (!b_all && p_req->i_offset + p_sys->pipe.i_size > i_pos)
+            continue;
+        if (p_req->b_pending)
+            p_req->b_stale = true;
+        p_req->b_done = false;
+    }
+}
+
+/* Sends requests for the data following the last request. The request at
+ * the reading position is sent even past the end of the file, so that
+ * growing files are read to their actual end. */
+static void
+SendReadReqs(access_t *p_access)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    for (unsigned i = 0; i < p_sys->pipe.i_count; i++)
+    {
+        struct nfs_read_req *p_req = &p_sys->pipe.p_reqs[i];
+
+        if (p_req->b_pending || p_req->b_done)
+            continue;
+        if (p_sys->pipe.i_next >= p_sys->stat.nfs_size
+         && p_sys->pipe.i_next != p_sys->pipe.i_pos)
+            break;
+
+        p_req->i_offset = p_sys->pipe.i_next;
+        p_req->i_len = 0;
+        if (nfs_pread_async(p_sys->p_nfs, p_sys->p_nfsfh, p_req->i_offset,
+                            p_sys->pipe.i_size, nfs_pread_cb, p_req) < 0)
+        {
+            msg_Err(p_access, "nfs_pread_async failed");
+            break;
+        }
+        p_req->b_pending = true;
+        p_sys->pipe.i_next += p_sys->pipe.i_size;
+    }
+}
+
+static ssize_t
+FilePipelineRead(access_t *p_access, void *p_buf, size_t i_len)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    uint64_t i_pos = p_sys->pipe.i_pos;
+
+    struct nfs_read_req *p_req = FindReadReq(p_sys, i_pos);
+    if (p_req == NULL)
+    {
+        DropReadReqs(p_sys, i_pos, true);
+        p_sys->pipe.i_next = i_pos;
+    }
+    SendReadReqs(p_access);
+
+    p_req = FindReadReq(p_sys, i_pos);
+    if (p_req == NULL)
+        return -1;
+
+    p_sys->pipe.p_head = p_req;
+    if (vlc_nfs_mainloop(p_access, nfs_pread_finished_cb) < 0)
+        return -1;
+
+    size_t i_skip = i_pos - p_req->i_offset;
+    if (p_req->i_len <= i_skip)
+    {   /* End of file: retry later in case the file grows */
+        DropReadReqs(p_sys, 0, true);
+        p_sys->pipe.i_next = i_pos;
+        return 0;
+    }
+
+    size_t i_copy = __MIN(i_len, p_req->i_len - i_skip);
+    memcpy(p_buf, p_req->p_buf + i_skip, i_copy);
+    p_sys->pipe.i_pos += i_copy;
+
+    if (i_skip + i_copy >= p_req->i_len)
+    {   /* Recycle the request */
+        p_req->b_done = false;
+        if (p_req->i_len < p_sys->pipe.i_size)
+        {   /* Short read: the next requests do not follow */
+            DropReadReqs(p_sys, 0, true);
+            p_sys->pipe.i_next = p_sys->pipe.i_pos;
+        }
+        SendReadReqs(p_access);
+    }
+    return i_copy;
+}
+
+static int
+FilePipelineSeek(access_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    /* Reads are positioned: seeking needs no request */
+    if (FindReadReq(p_sys, i_pos) != NULL)
+        DropReadReqs(p_sys, i_pos, false);
+    else
+    {
+        DropReadReqs(p_sys, i_pos, true);
+        p_sys->pipe.i_next = i_pos;
+    }
+    p_sys->pipe.i_pos = i_pos;
+    return VLC_SUCCESS;
+}
+
 static void
 nfs_seek_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
             void *p_private_data)
@@ -276,7 +463,8 @@ FileControl(access_t *p_access, int i_query, va_list args)
             break;
 
         case STREAM_CAN_FASTSEEK:
-            *va_arg(args, bool *) = false;
+            /* Pipelined reads already prefetch: avoid another buffer */
+            *va_arg(args, bool *) = p_sys->pipe.i_count > 0;
             break;
 
         case STREAM_CAN_PAUSE:
@@ -632,6 +820,36 @@ NfsInit(access_t *p_access, const char *psz_url_decoded)
     return 0;
 }
 
+static int
+PipelineInit(access_t *p_access)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    unsigned i_count = var_InheritInteger(p_access, "nfs-read-window");
+    size_t i_size = var_InheritInteger(p_access, "nfs-read-size");
+
+    if (i_count == 0)
+        return 0;
+
+    p_sys->pipe.p_reqs = calloc(i_count, sizeof (*p_sys->pipe.p_reqs));
+    if (p_sys->pipe.p_reqs == NULL)
+        return -1;
+
+    for (unsigned i = 0; i < i_count; i++)
+    {
+        struct nfs_read_req *p_req = &p_sys->pipe.p_reqs[i];
+
+        p_req->p_access = p_access;
+        p_req->p_buf = malloc(i_size);
+        if (p_req->p_buf == NULL)
+            return -1;
+        p_sys->pipe.i_count++;
+    }
+    p_sys->pipe.i_size = i_size;
+    p_sys->pipe.i_pos = 0;
+    p_sys->pipe.i_next = 0;
+    return 0;
+}
+
 static int
 Open(vlc_object_t *p_obj)
 {
@@ -704,8 +922,19 @@ Open(vlc_object_t *p_obj)
 
         if (p_sys->p_nfsfh != NULL)
         {
-            p_access->pf_read = FileRead;
-            p_access->pf_seek = FileSeek;
+            if (PipelineInit(p_access) == -1)
+                goto error;
+
+            if (p_sys->pipe.i_count > 0)
+            {
+                p_access->pf_read = FilePipelineRead;
+                p_access->pf_seek = FilePipelineSeek;
+            }
+            else
+            {
+                p_access->pf_read = FileRead;
+                p_access->pf_seek = FileSeek;
+            }
             p_access->pf_control = FileControl;
         }
         else if (p_sys->p_nfsdir != NULL)
@@ -761,6 +990,10 @@ Close(vlc_object_t *p_obj)
     access_t *p_access = (access_t *)p_obj;
     access_sys_t *p_sys = p_access->p_sys;
 
+    /* Ignore the replies to the requests still in flight */
+    if (p_sys->pipe.p_reqs != NULL)
+        DropReadReqs(p_sys, 0, true);
+
     if (p_sys->p_nfsfh != NULL)
         nfs_close(p_sys->p_nfs, p_sys->p_nfsfh);
 
@@ -781,6 +1014,13 @@ Close(vlc_object_t *p_obj)
     if (p_sys->p_nfs_url != NULL)
         nfs_destroy_url(p_sys->p_nfs_url);
 
+    if (p_sys->pipe.p_reqs != NULL)
+    {
+        for (unsigned i = 0; i < p_sys->pipe.i_count; i++)
+            free(p_sys->pipe.p_reqs[i].p_buf);
+        free(p_sys->pipe.p_reqs);
+    }
+
     vlc_UrlClean(&p_sys->encoded_url);
 
     free(p_sys->psz_url_decoded);
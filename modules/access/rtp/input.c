@@ -97,6 +97,21 @@ static int rtp_timeout (mtime_t deadline)
     return t;
 }
 
+#ifdef HAVE_RECVMMSG
+# define RTP_BATCH 32 /* datagrams received per system call */
+#else
+# define RTP_BATCH 1
+#endif
+
+static void rtp_release_blocks (void *data)
+{
+    block_t **blocks = data;
+
+    for (unsigned i = 0; i < RTP_BATCH; i++)
+        if (blocks[i] != NULL)
+            block_Release (blocks[i]);
+}
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -106,20 +121,21 @@ void *rtp_dgram_thread (void *opaque)
     demux_sys_t *sys = demux->p_sys;
     mtime_t deadline = VLC_TS_INVALID;
     int rtp_fd = sys->fd;
-    struct iovec iov =
-    {
-        .iov_len = DEFAULT_MRU,
-    };
-    struct msghdr msg =
-    {
-        .msg_iov = &iov,
-        .msg_iovlen = 1,
-    };
+    size_t mru = DEFAULT_MRU;
+    /* Blocks not filled by the previous call are kept for the next one */
+    block_t *blocks[RTP_BATCH] = { NULL };
+    struct iovec iov[RTP_BATCH];
+#ifdef HAVE_RECVMMSG
+    struct mmsghdr msgs[RTP_BATCH];
+#else
+    struct msghdr msgs[RTP_BATCH];
+#endif
 
     struct pollfd ufd[1];
     ufd[0].fd = rtp_fd;
     ufd[0].events = POLLIN;
 
+    vlc_cleanup_push (rtp_release_blocks, blocks);
     for (;;)
     {
         int n = poll (ufd, 1, rtp_timeout (deadline));
@@ -134,34 +150,82 @@ void *rtp_dgram_thread (void *opaque)
         {
             n--;
             if (unlikely(ufd[0].revents & POLLHUP))
+            {
+                vlc_restorecancel (canc);
                 break; /* RTP socket dead (DCCP only) */
+            }
 
-            block_t *block = block_Alloc (iov.iov_len);
-            if (unlikely(block == NULL))
+            unsigned count = 0;
+            for (; count < RTP_BATCH; count++)
             {
-                if (iov.iov_len == DEFAULT_MRU)
+                block_t *block = blocks[count];
+
+                if (block != NULL && block->i_buffer < mru)
+                {   /* MRU grew since this block was allocated */
+                    block_Release (block);
+                    block = blocks[count] = NULL;
+                }
+                if (block == NULL)
+                {
+                    block = blocks[count] = block_Alloc (mru);
+                    if (unlikely(block == NULL))
+                        break;
+                }
+
+                iov[count].iov_base = block->p_buffer;
+                iov[count].iov_len = mru;
+#ifdef HAVE_RECVMMSG
+                struct msghdr *msg = &msgs[count].msg_hdr;
+#else
+                struct msghdr *msg = &msgs[count];
+#endif
+                memset (msg, 0, sizeof (*msg));
+                msg->msg_iov = &iov[count];
+                msg->msg_iovlen = 1;
+#ifdef __linux__
+                msg->msg_flags = MSG_TRUNC;
+#endif
+            }
+
+            if (unlikely(count == 0))
+            {
+                if (mru == DEFAULT_MRU)
+                {
+                    vlc_restorecancel (canc);
                     break; /* we are totallly screwed */
-                iov.iov_len = DEFAULT_MRU;
+                }
+                mru = DEFAULT_MRU;
+                vlc_restorecancel (canc);
                 continue; /* retry with shrunk MRU */
             }
 
-            iov.iov_base = block->p_buffer;
-#ifdef __linux__
-            msg.msg_flags = MSG_TRUNC;
+#ifdef HAVE_RECVMMSG
+            int val = recvmmsg (rtp_fd, msgs, count, MSG_DONTWAIT, NULL);
 #else
-            msg.msg_flags = 0;
+            ssize_t len = recvmsg (rtp_fd, msgs, 0);
+            int val = (len >= 0) ? 1 : -1;
 #endif
+            if (val < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+                msg_Warn (demux, "RTP network error: %s",
+                          vlc_strerror_c(errno));
 
-            ssize_t len = recvmsg (rtp_fd, &msg, 0);
-            if (len != -1)
+            for (int i = 0; i < val; i++)
             {
+                block_t *block = blocks[i];
+#ifdef HAVE_RECVMMSG
+                const struct msghdr *msg = &msgs[i].msg_hdr;
+                size_t len = msgs[i].msg_len;
+#else
+                const struct msghdr *msg = &msgs[i];
+#endif
+                blocks[i] = NULL;
 #ifdef MSG_TRUNC
-                if (msg.msg_flags & MSG_TRUNC)
+                if (msg->msg_flags & MSG_TRUNC)
                 {
-                    msg_Err(demux, "%zd bytes packet truncated (MRU was %zu)",
-                            len, iov.iov_len);
+                    msg_Err(demux, "%zu bytes packet truncated (MRU was %zu)",
+                            (size_t)len, mru);
                     block->i_flags |= BLOCK_FLAG_CORRUPTED;
-                    iov.iov_len = len;
+                    mru = len;
                 }
                 else
 #endif
@@ -169,12 +233,14 @@ void *rtp_dgram_thread (void *opaque)
 
                 rtp_process (demux, block);
             }
-            else
-            {
-                msg_Warn (demux, "RTP network error: %s",
-                          vlc_strerror_c(errno));
-                block_Release (block);
-            }
+
+            /* Move the blocks left unused to the front */
+            if (val > 0)
+                for (int i = 0, j = val; j < RTP_BATCH; i++, j++)
+                {
+                    blocks[i] = blocks[j];
+                    blocks[j] = NULL;
+                }
         }
 
     dequeue:
@@ -182,6 +248,8 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TS_INVALID;
         vlc_restorecancel (canc);
     }
+    vlc_cleanup_pop ();
+    rtp_release_blocks (blocks);
     return NULL;
 }
 
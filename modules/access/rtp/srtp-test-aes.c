@@ -18,6 +18,7 @@
  */
 
 #include <stdio.h>
+#include <time.h>
 #include "srtp.c"
 
 static void printhex (const void *buf, size_t len)
@@ -138,13 +139,70 @@ static void test_keystream (void)
      || memcmp (buf + 0xff020 - sizeof (good_end), good_end,
                 sizeof (good_end)))
         fatal ("Key stream test failed");
+
+    /* Truncated key stream */
+    uint8_t trunc[sizeof (good_start) - 5];
+
+    memset (trunc, 0, sizeof (trunc));
+    if (gcry_cipher_open (&hd, GCRY_CIPHER_AES, GCRY_CIPHER_MODE_CTR, 0))
+        fatal ("Cipher initialization error");
+    if (gcry_cipher_setkey (hd, key, sizeof (key)))
+        fatal ("Cipher key error");
+    for (int i = 0; i < 2; i++) /* the counter must be reset every time */
+        if (rtp_crypt (hd, 0, 0, 0, salt, memset (trunc, 0, sizeof (trunc)),
+                       sizeof (trunc)))
+            fatal ("Encryption failure");
+    gcry_cipher_close (hd);
+
+    printf (" truncated:   ");
+    printhex (trunc, sizeof (trunc));
+    if (memcmp (trunc, good_start, sizeof (trunc)))
+        fatal ("Truncated key stream test failed");
     free (buf);
 }
 
+/** SRTP packet protection throughput (not a conformance test) */
+static void bench_send (void)
+{
+    static const uint8_t key[16] =
+        "\xE1\xF9\x7A\x0D\x3E\x01\x8B\xE0\xD6\x4F\xA3\x2C\x06\xDE\x41\x39";
+    static const uint8_t salt[14] =
+        "\x0E\xC6\x75\xAD\x49\x8A\xFE\xEB\xB6\x96\x0B\x3A\xAB\xE6";
+    const unsigned count = 20000;
+    uint8_t buf[1400];
+
+    puts ("SRTP send benchmark...");
+    srtp_session_t *s = srtp_create (SRTP_ENCR_AES_CM, SRTP_AUTH_HMAC_SHA1,
+                                     10, SRTP_PRF_AES_CM, 0);
+    if (s == NULL || srtp_setkey (s, key, sizeof (key), salt, sizeof (salt)))
+        fatal ("Session initialization error");
+
+    memset (buf, 0x55, sizeof (buf));
+    buf[0] = 0x80;
+
+    clock_t start = clock ();
+    for (unsigned i = 0; i < count; i++)
+    {
+        size_t len = 1310; /* not a multiple of the AES block size */
+
+        buf[2] = i >> 8;
+        buf[3] = i;
+        if (srtp_send (s, buf, &len, sizeof (buf)))
+            fatal ("Send failure");
+    }
+    double secs = (double)(clock () - start) / CLOCKS_PER_SEC;
+    srtp_destroy (s);
+
+    if (secs > 0.)
+        printf (" %u packets of 1310 bytes: %.0f packets/s, %.1f Mbit/s\n",
+                count, count / secs, count * 1310. * 8. / secs / 1e6);
+}
+
 static void srtp_test (void)
 {
     test_derivation ();
     test_keystream ();
+    bench_send ();
 }
 
 int main (void)
@@ -32,6 +32,9 @@
 # include <sys/shm.h>
 # include <xcb/shm.h>
 #endif
+#ifdef HAVE_XCB_DAMAGE
+# include <xcb/damage.h>
+#endif
 #include <vlc_common.h>
 #include <vlc_demux.h>
 #include <vlc_plugin.h>
@@ -115,7 +118,15 @@ struct demux_sys_t
     uint8_t           bpp; /**< Actual bytes per pixel *es */
     bool              shm; /**< Whether to use MIT-SHM */
     bool              follow_mouse;
+    int16_t           cur_x, cur_y; /**< Actual capture top-left coordinates */
     uint16_t          cur_w, cur_h; /**< Actual capture pixel dimensions */
+    void             *shm_addr; /**< Shared memory capture buffer */
+    size_t            shm_size; /**< Shared memory capture buffer size */
+    bool              valid; /**< Whether the buffer holds the capture region */
+#ifdef HAVE_XCB_DAMAGE
+    xcb_damage_damage_t damage; /**< Damage XID (or 0 if unsupported) */
+    uint8_t           damage_event; /**< Damage notify event code */
+#endif
     /* Timer does not use this, only input thread: */
     vlc_timer_t       timer;
 };
@@ -136,6 +147,117 @@ static bool CheckSHM (xcb_connection_t *conn)
 #endif
 }
 
+#ifdef HAVE_SYS_SHM_H
+/**
+ * (Re)allocates the shared memory capture buffer. The X server writes the
+ * captured pixels there, so that unchanged pixels need not be captured again.
+ */
+static void MapSHM (demux_t *demux, size_t size)
+{
+    demux_sys_t *sys = demux->p_sys;
+    xcb_connection_t *conn = sys->conn;
+
+    if (sys->shm_addr != NULL)
+    {
+        xcb_shm_detach (conn, sys->segment);
+        shmdt (sys->shm_addr);
+        sys->shm_addr = NULL;
+    }
+
+    int id = shmget (IPC_PRIVATE, size, IPC_CREAT | 0777);
+    if (id == -1)
+    {
+        msg_Err (demux, "shared memory allocation error: %s",
+                 vlc_strerror_c(errno));
+        return;
+    }
+
+    /* Attach the segment to X and VLC */
+    xcb_void_cookie_t ck = xcb_shm_attach_checked (conn, sys->segment, id,
+                                                   0 /* read/write */);
+    void *addr = shmat (id, NULL, 0 /* read/write */);
+    xcb_generic_error_t *err = xcb_request_check (conn, ck);
+    /* The segment is destroyed once detached from both */
+    shmctl (id, IPC_RMID, 0);
+
+    if (err != NULL)
+    {
+        free (err);
+        msg_Err (demux, "shared memory attachment to X server error");
+        if (-1 != (intptr_t)addr)
+            shmdt (addr);
+        return;
+    }
+    if (-1 == (intptr_t)addr)
+    {
+        msg_Err (demux, "shared memory attachment error: %s",
+                 vlc_strerror_c(errno));
+        xcb_shm_detach (conn, sys->segment);
+        return;
+    }
+
+    sys->shm_addr = addr;
+    sys->shm_size = size;
+}
+#endif
+
+#ifdef HAVE_XCB_DAMAGE
+/** Checks Damage extension support */
+static bool CheckDamage (xcb_connection_t *conn, uint8_t *event)
+{
+    const xcb_query_extension_reply_t *ext =
+        xcb_get_extension_data (conn, &xcb_damage_id);
+    if (ext == NULL || !ext->present)
+        return false;
+
+    xcb_damage_query_version_reply_t *r =
+        xcb_damage_query_version_reply (conn,
+            xcb_damage_query_version (conn, 1, 1), NULL);
+    free (r);
+    *event = ext->first_event + XCB_DAMAGE_NOTIFY;
+    return r != NULL;
+}
+
+/**
+ * Collects the rows of the capture region damaged since the last capture.
+ * @return false if the region was not damaged
+ */
+static bool GetDamage (demux_sys_t *sys, int x, int y, unsigned w, unsigned h,
+                       unsigned *restrict top, unsigned *restrict rows)
+{
+    xcb_generic_event_t *ev;
+    int y0 = h, y1 = 0;
+
+    while ((ev = xcb_poll_for_event (sys->conn)) != NULL)
+    {
+        if ((ev->response_type & 0x7F) == sys->damage_event)
+        {
+            const xcb_rectangle_t *a =
+                &((const xcb_damage_notify_event_t *)ev)->area;
+
+            if (a->x < x + (int)w && a->x + a->width > x)
+            {
+                if (a->y - y < y0)
+                    y0 = a->y - y;
+                if (a->y + a->height - y > y1)
+                    y1 = a->y + a->height - y;
+            }
+        }
+        free (ev);
+    }
+
+    if (y0 < 0)
+        y0 = 0;
+    if (y1 > (int)h)
+        y1 = h;
+    if (y0 >= y1)
+        return false;
+    *top = y0;
+    *rows = y1 - y0;
+    return true;
+}
+#endif
+
 /**
  * Probes and initializes.
  */
@@ -218,6 +340,18 @@ static int Open (vlc_object_t *obj)
     p_sys->pixmap = xcb_generate_id (conn);
     p_sys->segment = xcb_generate_id (conn);
     p_sys->shm = CheckSHM (conn);
+    p_sys->shm_addr = NULL;
+    p_sys->valid = false;
+#ifdef HAVE_XCB_DAMAGE
+    p_sys->damage = 0;
+    if (p_sys->shm && CheckDamage (conn, &p_sys->damage_event))
+    {
+        p_sys->damage = xcb_generate_id (conn);
+        xcb_damage_create (conn, p_sys->damage, p_sys->window,
+                           XCB_DAMAGE_REPORT_LEVEL_BOUNDING_BOX);
+        msg_Dbg (obj, "using Damage extension");
+    }
+#endif
     p_sys->w = var_InheritInteger (obj, "screen-width");
     p_sys->h = var_InheritInteger (obj, "screen-height");
     if (p_sys->w != 0 || p_sys->h != 0)
@@ -269,6 +403,10 @@ static void Close (vlc_object_t *obj)
 
     vlc_timer_destroy (p_sys->timer);
     xcb_disconnect (p_sys->conn);
+#ifdef HAVE_SYS_SHM_H
+    if (p_sys->shm_addr != NULL)
+        shmdt (p_sys->shm_addr);
+#endif
     free (p_sys);
 }
 
@@ -424,6 +562,7 @@ discard:
             sys->cur_h = h;
             sys->bpp /= 8; /* bits -> bytes */
         }
+        sys->valid = false;
     }
 
     /* Capture screen */
@@ -436,45 +575,58 @@ discard:
     if (sys->shm)
     {   /* Capture screen through shared memory */
         size_t size = w * h * sys->bpp;
-        int id = shmget (IPC_PRIVATE, size, IPC_CREAT | 0777);
-        if (id == -1) /* XXX: fallback */
+        unsigned top = 0, rows = h;
+
+        if (sys->shm_addr == NULL || sys->shm_size != size)
         {
-            msg_Err (demux, "shared memory allocation error: %s",
-                     vlc_strerror_c(errno));
+            MapSHM (demux, size);
+            sys->valid = false;
+        }
+        if (sys->shm_addr == NULL)
+        {
+            sys->shm = false;
             goto noshm;
         }
+        if (x != sys->cur_x || y != sys->cur_y)
+            sys->valid = false;
 
-        /* Attach the segment to X and capture */
-        xcb_shm_get_image_reply_t *img;
-        xcb_shm_get_image_cookie_t ck;
+# ifdef HAVE_XCB_DAMAGE
+        if (sys->damage != 0)
+        {   /* Only capture the rows that changed */
+            bool damaged = GetDamage (sys, x, y, w, h, &top, &rows);
 
-        xcb_shm_attach (conn, sys->segment, id, 0 /* read/write */);
-        ck = xcb_shm_get_image (conn, drawable, x, y, w, h, ~0,
-                                XCB_IMAGE_FORMAT_Z_PIXMAP, sys->segment, 0);
-        xcb_shm_detach (conn, sys->segment);
-        img = xcb_shm_get_image_reply (conn, ck, NULL);
-        xcb_flush (conn); /* ensure eventual detach */
+            if (!sys->valid)
+            {
+                top = 0;
+                rows = h;
+            }
+            else if (!damaged)
+            {
+                es_out_Control (demux->out, ES_OUT_SET_PCR, mdate ());
+                return;
+            }
+            xcb_damage_subtract (conn, sys->damage, XCB_NONE, XCB_NONE);
+        }
+# endif
 
+        xcb_shm_get_image_reply_t *img = xcb_shm_get_image_reply (conn,
+            xcb_shm_get_image (conn, drawable, x, y + top, w, rows, ~0,
+                               XCB_IMAGE_FORMAT_Z_PIXMAP, sys->segment,
+                               top * w * sys->bpp), NULL);
         if (img == NULL)
         {
-            shmctl (id, IPC_RMID, 0);
+            sys->valid = false;
             goto noshm;
         }
         free (img);
+        sys->cur_x = x;
+        sys->cur_y = y;
+        sys->valid = true;
 
-        /* Attach the segment to VLC */
-        void *shm = shmat (id, NULL, 0 /* read/write */);
-        shmctl (id, IPC_RMID, 0);
-        if (-1 == (intptr_t)shm)
-        {
-            msg_Err (demux, "shared memory attachment error: %s",
-                     vlc_strerror_c(errno));
-            return;
-        }
-
-        block = block_shm_Alloc (shm, size);
+        block = block_Alloc (size);
         if (unlikely(block == NULL))
-            shmdt (shm);
+            return;
+        memcpy (block->p_buffer, sys->shm_addr, size);
     }
 noshm:
 #endif
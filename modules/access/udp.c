@@ -46,6 +46,16 @@
 #ifdef HAVE_POLL
 # include <poll.h>
 #endif
+#ifdef __linux__
+# include <netinet/udp.h>
+#endif
+
+/** Count of datagrams received per system call */
+#define UDP_BATCH 32
+/** Count of coalesced buffers received per system call with UDP GRO */
+#define UDP_BATCH_GRO 4
+/** Buffer size for coalesced datagrams with UDP GRO */
+#define UDP_GRO_SIZE 65535
 
 /*****************************************************************************
  * Module descriptor
@@ -78,6 +88,17 @@ struct access_sys_t
     int fd;
     int timeout;
     size_t mtu;
+    unsigned batch; /**< Count of buffers per receive call */
+    bool gro; /**< Whether the kernel coalesces datagrams */
+
+    uint32_t drops; /**< Last kernel receive queue overflow counter value */
+    uint64_t lost; /**< Datagrams dropped since the last query */
+
+    /* Received blocks not returned yet */
+    block_t *queue;
+    block_t **pp_queue_last;
+    /* Allocated blocks not filled by the last receive call */
+    block_t *spare;
 };
 
 /*****************************************************************************
@@ -168,6 +189,29 @@ error:
     }
 
     sys->mtu = 7 * 188;
+    sys->batch = UDP_BATCH;
+    sys->gro = false;
+    sys->drops = 0;
+    sys->lost = 0;
+    sys->queue = NULL;
+    sys->pp_queue_last = &sys->queue;
+    sys->spare = NULL;
+
+#ifdef SO_RXQ_OVFL
+    /* Ask the kernel to report receive queue overflows */
+    setsockopt( sys->fd, SOL_SOCKET, SO_RXQ_OVFL, &(int){ 1 }, sizeof (int) );
+#endif
+#ifdef UDP_GRO
+    /* Let the kernel coalesce datagrams, as TS does not need boundaries */
+    if( setsockopt( sys->fd, IPPROTO_UDP, UDP_GRO, &(int){ 1 },
+                    sizeof (int) ) == 0 )
+    {
+        msg_Dbg( p_access, "using UDP generic receive offload" );
+        sys->gro = true;
+        sys->batch = UDP_BATCH_GRO;
+        sys->mtu = UDP_GRO_SIZE;
+    }
+#endif
 
     sys->timeout = var_InheritInteger( p_access, "udp-timeout");
     if( sys->timeout > 0)
@@ -185,6 +229,8 @@ static void Close( vlc_object_t *p_this )
     access_sys_t *sys = p_access->p_sys;
 
     net_Close( sys->fd );
+    block_ChainRelease( sys->queue );
+    block_ChainRelease( sys->spare );
     free( sys );
 }
 
@@ -212,12 +258,81 @@ static int Control( access_t *p_access, int i_query, va_list args )
                    * var_InheritInteger(p_access, "network-caching");
             break;
 
+        case STREAM_GET_LOST_PACKETS:
+        {
+            access_sys_t *sys = p_access->p_sys;
+
+            *va_arg( args, uint64_t * ) = sys->lost;
+            sys->lost = 0;
+            break;
+        }
+
         default:
             return VLC_EGENERIC;
     }
     return VLC_SUCCESS;
 }
 
+#ifdef SO_RXQ_OVFL
+# define UDP_CONTROL_SIZE CMSG_SPACE(sizeof (uint32_t))
+#else
+# define UDP_CONTROL_SIZE 1
+#endif
+
+typedef union
+{
+    char buf[UDP_CONTROL_SIZE];
+#ifdef SO_RXQ_OVFL
+    struct cmsghdr align;
+#endif
+} udp_control_t;
+
+/*****************************************************************************
+ * ProcessUDP: finalize a received datagram block
+ *****************************************************************************/
+static void ProcessUDP(access_t *access, block_t *pkt,
+                       const struct msghdr *msg, size_t len)
+{
+    access_sys_t *sys = access->p_sys;
+
+#ifdef MSG_TRUNC
+    if (msg->msg_flags & MSG_TRUNC)
+    {
+        msg_Err(access, "%zu bytes packet truncated (MTU was %zu)",
+                len, sys->mtu);
+        pkt->i_flags |= BLOCK_FLAG_CORRUPTED;
+        if (!sys->gro)
+            sys->mtu = len;
+    }
+    else
+#endif
+        pkt->i_buffer = len;
+
+#ifdef SO_RXQ_OVFL
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+         cmsg != NULL;
+         cmsg = CMSG_NXTHDR((struct msghdr *)msg, cmsg))
+    {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_RXQ_OVFL)
+            continue;
+
+        uint32_t drops;
+
+        memcpy(&drops, CMSG_DATA(cmsg), sizeof (drops));
+        if (drops != sys->drops)
+        {
+            msg_Dbg(access, "%"PRIu32" datagram(s) dropped by the kernel",
+                    drops - sys->drops);
+            sys->lost += drops - sys->drops;
+            sys->drops = drops;
+            pkt->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+        }
+    }
+#else
+    VLC_UNUSED(msg);
+#endif
+}
+
 /*****************************************************************************
  * BlockUDP:
  *****************************************************************************/
@@ -225,27 +340,80 @@ static block_t *BlockUDP(access_t *access, bool *restrict eof)
 {
     access_sys_t *sys = access->p_sys;
 
-    block_t *pkt = block_Alloc(sys->mtu);
-    if (unlikely(pkt == NULL))
-    {   /* OOM - dequeue and discard one packet */
-        char dummy;
-        recv(sys->fd, &dummy, 1, 0);
-        return NULL;
+    /* Return datagrams received by a previous batch first */
+    if (sys->queue != NULL)
+    {
+        block_t *pkt = sys->queue;
+
+        sys->queue = pkt->p_next;
+        if (sys->queue == NULL)
+            sys->pp_queue_last = &sys->queue;
+        pkt->p_next = NULL;
+        return pkt;
     }
 
-    struct iovec iov = {
-        .iov_base = pkt->p_buffer,
-        .iov_len = sys->mtu,
-    };
-    struct msghdr msg = {
-        .msg_iov = &iov,
-        .msg_iovlen = 1,
+    block_t *pkts[UDP_BATCH];
+    struct iovec iov[UDP_BATCH];
+    udp_control_t control[UDP_BATCH];
+#ifdef HAVE_RECVMMSG
+    struct mmsghdr msgs[UDP_BATCH];
+    unsigned count = sys->batch;
+#else
+    struct msghdr msgs[UDP_BATCH];
+    unsigned count = 1;
+#endif
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        block_t *pkt = sys->spare;
+
+        if (pkt != NULL)
+        {
+            sys->spare = pkt->p_next;
+            pkt->p_next = NULL;
+            pkt = block_Realloc(pkt, 0, sys->mtu);
+        }
+        else
+            pkt = block_Alloc(sys->mtu);
+
+        if (unlikely(pkt == NULL))
+        {
+            if (i > 0)
+            {   /* Receive fewer datagrams */
+                count = i;
+                break;
+            }
+            /* OOM - dequeue and discard one packet */
+            char dummy;
+            recv(sys->fd, &dummy, 1, 0);
+            return NULL;
+        }
+
+        pkts[i] = pkt;
+        iov[i].iov_base = pkt->p_buffer;
+        iov[i].iov_len = sys->mtu;
+
+#ifdef HAVE_RECVMMSG
+        struct msghdr *msg = &msgs[i].msg_hdr;
+#else
+        struct msghdr *msg = &msgs[i];
+#endif
+        memset(msg, 0, sizeof (*msg));
+        msg->msg_iov = &iov[i];
+        msg->msg_iovlen = 1;
+#ifdef SO_RXQ_OVFL
+        msg->msg_control = control[i].buf;
+        msg->msg_controllen = sizeof (control[i].buf);
+#else
+        VLC_UNUSED(control);
+#endif
 #ifdef __linux__
-        .msg_flags = MSG_TRUNC,
+        msg->msg_flags = MSG_TRUNC;
 #endif
-    };
+    }
 
     struct pollfd ufd[1];
+    int val;
 
     ufd[0].fd = sys->fd;
     ufd[0].events = POLLIN;
@@ -257,28 +425,46 @@ static block_t *BlockUDP(access_t *access, bool *restrict eof)
             *eof = true;
             /* fall through */
         case -1:
+            val = -1;
             goto skip;
      }
 
-    ssize_t len = recvmsg(sys->fd, &msg, 0);
-    if (len < 0)
-    {
+#ifdef HAVE_RECVMMSG
+    val = recvmmsg(sys->fd, msgs, count, MSG_DONTWAIT, NULL);
+#else
+    ssize_t len = recvmsg(sys->fd, msgs, 0);
+    val = (len >= 0) ? 1 : -1;
+#endif
 skip:
-        block_Release(pkt);
-        return NULL;
-    }
+    if (val < 0)
+        val = 0;
 
-#ifdef MSG_TRUNC
-    if (msg.msg_flags & MSG_TRUNC)
+    block_t *first = NULL;
+
+    for (unsigned i = 0; i < count; i++)
     {
-        msg_Err(access, "%zd bytes packet truncated (MTU was %zu)",
-                len, sys->mtu);
-        pkt->i_flags |= BLOCK_FLAG_CORRUPTED;
-        sys->mtu = len;
-    }
-    else
+        block_t *pkt = pkts[i];
+
+        if (i >= (unsigned)val)
+        {   /* Keep unused blocks for the next call */
+            pkt->p_next = sys->spare;
+            sys->spare = pkt;
+            continue;
+        }
+
+#ifdef HAVE_RECVMMSG
+        ProcessUDP(access, pkt, &msgs[i].msg_hdr, msgs[i].msg_len);
+#else
+        ProcessUDP(access, pkt, &msgs[i], len);
 #endif
-        pkt->i_buffer = len;
+        if (first == NULL)
+            first = pkt;
+        else
+        {
+            *sys->pp_queue_last = pkt;
+            sys->pp_queue_last = &pkt->p_next;
+        }
+    }
 
-    return pkt;
+    return first;
 }
@@ -0,0 +1,262 @@
+/*****************************************************************************
+ * uring.c: minimal Linux io_uring wrapper
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#if defined (HAVE_LINUX_IO_URING_H) && defined (HAVE_SYS_EVENTFD_H)
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_fs.h>
+#include <vlc_interrupt.h>
+#include "uring.h"
+
+struct vlc_uring
+{
+    int fd;
+    int efd; /**< Signaled by the kernel on completion */
+
+    struct
+    {
+        atomic_uint *head;
+        atomic_uint *tail;
+        unsigned mask;
+        unsigned entries;
+        unsigned *array;
+        struct io_uring_sqe *sqes;
+    } sq;
+
+    struct
+    {
+        atomic_uint *head;
+        atomic_uint *tail;
+        unsigned mask;
+        struct io_uring_cqe *cqes;
+    } cq;
+
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+};
+
+static int uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter(int fd, unsigned submit)
+{
+    return syscall(__NR_io_uring_enter, fd, submit, 0, 0, NULL, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, void *arg, unsigned n)
+{
+    return syscall(__NR_io_uring_register, fd, opcode, arg, n);
+}
+
+static bool uring_CanRead(int fd)
+{
+    const unsigned n = IORING_OP_READ + 1;
+    struct io_uring_probe *probe = calloc(1, sizeof (*probe)
+                                     + n * sizeof (struct io_uring_probe_op));
+    if (unlikely(probe == NULL))
+        return false;
+
+    bool ok = uring_register(fd, IORING_REGISTER_PROBE, probe, n) == 0
+           && probe->last_op >= IORING_OP_READ
+           && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    return ok;
+}
+
+struct vlc_uring *vlc_uring_Create(unsigned entries)
+{
+    struct vlc_uring *ring = calloc(1, sizeof (*ring));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof (p));
+
+    ring->sq_ring = ring->cq_ring = ring->sq.sqes = MAP_FAILED;
+    ring->efd = -1;
+    ring->fd = uring_setup(entries, &p);
+    if (ring->fd == -1)
+        goto error;
+    if (!uring_CanRead(ring->fd))
+        goto error;
+
+    ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof (unsigned);
+    ring->cq_ring_size = p.cq_off.cqes
+                       + p.cq_entries * sizeof (struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cq_ring_size > ring->sq_ring_size)
+            ring->sq_ring_size = ring->cq_ring_size;
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ|PROT_WRITE,
+                         MAP_SHARED|MAP_POPULATE, ring->fd,
+                         IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED)
+        goto error;
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        ring->cq_ring = ring->sq_ring;
+    else
+    {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ|PROT_WRITE,
+                             MAP_SHARED|MAP_POPULATE, ring->fd,
+                             IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED)
+            goto error;
+    }
+
+    ring->sqes_size = p.sq_entries * sizeof (struct io_uring_sqe);
+    ring->sq.sqes = mmap(NULL, ring->sqes_size, PROT_READ|PROT_WRITE,
+                         MAP_SHARED|MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sq.sqes == MAP_FAILED)
+        goto error;
+
+    uint8_t *sq = ring->sq_ring, *cq = ring->cq_ring;
+
+    ring->sq.head = (atomic_uint *)(sq + p.sq_off.head);
+    ring->sq.tail = (atomic_uint *)(sq + p.sq_off.tail);
+    ring->sq.mask = *(unsigned *)(sq + p.sq_off.ring_mask);
+    ring->sq.entries = *(unsigned *)(sq + p.sq_off.ring_entries);
+    ring->sq.array = (unsigned *)(sq + p.sq_off.array);
+    ring->cq.head = (atomic_uint *)(cq + p.cq_off.head);
+    ring->cq.tail = (atomic_uint *)(cq + p.cq_off.tail);
+    ring->cq.mask = *(unsigned *)(cq + p.cq_off.ring_mask);
+    ring->cq.cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    ring->efd = eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK);
+    if (ring->efd == -1
+     || uring_register(ring->fd, IORING_REGISTER_EVENTFD, &ring->efd, 1))
+        goto error;
+    return ring;
+
+error:
+    vlc_uring_Destroy(ring);
+    return NULL;
+}
+
+void vlc_uring_Destroy(struct vlc_uring *ring)
+{
+    if (ring->sq.sqes != MAP_FAILED)
+        munmap(ring->sq.sqes, ring->sqes_size);
+    if (ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring)
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    if (ring->sq_ring != MAP_FAILED)
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    if (ring->efd != -1)
+        vlc_close(ring->efd);
+    if (ring->fd != -1)
+        vlc_close(ring->fd);
+    free(ring);
+}
+
+int vlc_uring_Read(struct vlc_uring *ring, int fd, void *buf, size_t len,
+                   uint64_t offset, void *opaque)
+{
+    unsigned tail = atomic_load_explicit(ring->sq.tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(ring->sq.head, memory_order_acquire);
+
+    if (tail - head >= ring->sq.entries)
+        return -1;
+
+    unsigned idx = tail & ring->sq.mask;
+    struct io_uring_sqe *sqe = &ring->sq.sqes[idx];
+
+    memset(sqe, 0, sizeof (*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = offset;
+    sqe->user_data = (uintptr_t)opaque;
+    ring->sq.array[idx] = idx;
+
+    /* Publish the entry to the kernel */
+    atomic_store_explicit(ring->sq.tail, tail + 1, memory_order_release);
+
+    int val;
+    do
+        val = uring_enter(ring->fd, 1);
+    while (val == -1 && errno == EINTR);
+
+    if (val != 1)
+    {   /* Take the entry back */
+        atomic_store_explicit(ring->sq.tail, tail, memory_order_relaxed);
+        return -1;
+    }
+    return 0;
+}
+
+int vlc_uring_Wait(struct vlc_uring *ring, void **opaque, ssize_t *res,
+                   bool interruptible)
+{
+    for (;;)
+    {
+        unsigned head = atomic_load_explicit(ring->cq.head,
+                                             memory_order_relaxed);
+        unsigned tail = atomic_load_explicit(ring->cq.tail,
+                                             memory_order_acquire);
+        if (head != tail)
+        {
+            const struct io_uring_cqe *cqe = &ring->cq.cqes[head & ring->cq.mask];
+
+            *opaque = (void *)(uintptr_t)cqe->user_data;
+            *res = cqe->res;
+            atomic_store_explicit(ring->cq.head, head + 1,
+                                  memory_order_release);
+            return 0;
+        }
+
+        struct pollfd ufd = { .fd = ring->efd, .events = POLLIN };
+        int val = interruptible ? vlc_poll_i11e(&ufd, 1, -1)
+                                : poll(&ufd, 1, -1);
+        if (val < 0)
+        {
+            if (interruptible || errno != EINTR)
+                return -1;
+            continue;
+        }
+
+        uint64_t count;
+        if (read(ring->efd, &count, sizeof (count)) < 0)
+            continue; /* not signaled yet (EAGAIN) */
+    }
+}
+#endif
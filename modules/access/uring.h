@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * uring.h: minimal Linux io_uring wrapper
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * A ring is meant to be used by a single thread. Completions are waited for
+ * through an event file descriptor, so that waiting can be interrupted with
+ * vlc_interrupt_kill().
+ */
+struct vlc_uring;
+
+/**
+ * Creates a ring.
+ *
+ * \param entries maximum number of requests in flight
+ * \return the ring, or NULL if io_uring or its read operation is not
+ * supported by the running kernel
+ */
+struct vlc_uring *vlc_uring_Create(unsigned entries);
+
+/**
+ * Destroys a ring.
+ *
+ * All the requests must have completed.
+ */
+void vlc_uring_Destroy(struct vlc_uring *);
+
+/**
+ * Submits a positioned read.
+ *
+ * The buffer must remain valid until the request completes.
+ *
+ * \param opaque value reported back on completion
+ * \return 0 on success, -1 on error (ring full or submission failure)
+ */
+int vlc_uring_Read(struct vlc_uring *, int fd, void *buf, size_t len,
+                   uint64_t offset, void *opaque);
+
+/**
+ * Waits for the completion of a request.
+ *
+ * \param opaque value given when submitting the request [OUT]
+ * \param res number of bytes read, or negated error code [OUT]
+ * \param interruptible whether the wait can be interrupted
+ * \return 0 on success, -1 if interrupted
+ */
+int vlc_uring_Wait(struct vlc_uring *, void **opaque, ssize_t *res,
+                   bool interruptible);
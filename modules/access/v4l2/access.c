@@ -46,7 +46,7 @@ struct access_sys_t
         uint32_t bufc;
         uint32_t blocksize;
     };
-    struct buffer_t *bufv;
+    vlc_v4l2_buffers_t *bufv;
     vlc_v4l2_ctrl_t *controls;
 };
 
@@ -190,10 +190,11 @@ void AccessClose( vlc_object_t *obj )
     access_t *access = (access_t *)obj;
     access_sys_t *sys = access->p_sys;
 
-    if (sys->bufv != NULL)
-        StopMmap (sys->fd, sys->bufv, sys->bufc);
     ControlsDeinit( obj, sys->controls );
-    v4l2_close (sys->fd);
+    if (sys->bufv != NULL)
+        CloseMmap (sys->bufv);
+    else
+        v4l2_close (sys->fd);
     free( sys );
 }
 
@@ -217,7 +218,7 @@ static block_t *MMapBlock (access_t *access, bool *restrict eof)
     if (AccessPoll (access))
         return NULL;
 
-    block_t *block = GrabVideo (VLC_OBJECT(access), sys->fd, sys->bufv);
+    block_t *block = GrabVideo (VLC_OBJECT(access), sys->bufv);
     if( block != NULL )
     {
         block->i_pts = block->i_dts = mdate();
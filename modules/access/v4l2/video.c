@@ -579,11 +579,87 @@ mtime_t GetBufferPTS (const struct v4l2_buffer *buf)
     return pts;
 }
 
+struct vlc_v4l2_buffers
+{
+    vlc_mutex_t lock;
+    int fd;
+    bool streaming;
+    bool close; /**< close the device along with the buffers */
+    uint32_t queued; /**< number of buffers owned by the driver */
+    unsigned refs; /**< owner reference plus number of lent buffers */
+    uint32_t count;
+    struct buffer_t bufv[];
+};
+
+typedef struct
+{
+    block_t self;
+    vlc_v4l2_buffers_t *pool;
+    struct v4l2_buffer buf;
+} v4l2_block_t;
+
+/* Keep enough buffers queued for the driver not to drop frames */
+#define MIN_QUEUED_BUFFERS 2
+
+static void UnmapBuffers (vlc_v4l2_buffers_t *pool)
+{
+    for (uint32_t i = 0; i < pool->count; i++)
+        v4l2_munmap (pool->bufv[i].start, pool->bufv[i].length);
+    if (pool->close)
+        v4l2_close (pool->fd);
+    vlc_mutex_destroy (&pool->lock);
+    free (pool);
+}
+
+/** Releases a reference to the buffers. The lock must be held. */
+static void ReleaseBuffers (vlc_v4l2_buffers_t *pool)
+{
+    bool last = --pool->refs == 0;
+
+    vlc_mutex_unlock (&pool->lock);
+    if (last)
+        UnmapBuffers (pool);
+}
+
+static void ReleaseBlock (block_t *block)
+{
+    v4l2_block_t *vb = (v4l2_block_t *)block;
+    vlc_v4l2_buffers_t *pool = vb->pool;
+
+    /* Give the buffer back to the driver, unless streaming was stopped */
+    vlc_mutex_lock (&pool->lock);
+    if (pool->streaming && v4l2_ioctl (pool->fd, VIDIOC_QBUF, &vb->buf) == 0)
+        pool->queued++;
+    ReleaseBuffers (pool);
+    free (vb);
+}
+
+/** Wraps a dequeued buffer in a block, without copying it. */
+static block_t *LendBuffer (vlc_v4l2_buffers_t *pool,
+                            const struct v4l2_buffer *buf)
+{
+    v4l2_block_t *vb = malloc (sizeof (*vb));
+    if (unlikely(vb == NULL))
+        return NULL;
+
+    const struct buffer_t *b = &pool->bufv[buf->index];
+
+    block_Init (&vb->self, b->start, b->length);
+    vb->self.i_buffer = buf->bytesused;
+    vb->self.pf_release = ReleaseBlock;
+    vb->pool = pool;
+    vb->buf = *buf;
+
+    vlc_mutex_lock (&pool->lock);
+    pool->refs++;
+    vlc_mutex_unlock (&pool->lock);
+    return &vb->self;
+}
+
 /*****************************************************************************
  * GrabVideo: Grab a video frame
  *****************************************************************************/
-block_t *GrabVideo (vlc_object_t *demux, int fd,
-                    const struct buffer_t *restrict bufv)
+block_t *GrabVideo (vlc_object_t *demux, vlc_v4l2_buffers_t *pool)
 {
     struct v4l2_buffer buf = {
         .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
@@ -591,7 +667,7 @@ block_t *GrabVideo (vlc_object_t *demux, int fd,
     };
 
     /* Wait for next frame */
-    if (v4l2_ioctl (fd, VIDIOC_DQBUF, &buf) < 0)
+    if (v4l2_ioctl (pool->fd, VIDIOC_DQBUF, &buf) < 0)
     {
         switch (errno)
         {
@@ -606,20 +682,41 @@ block_t *GrabVideo (vlc_object_t *demux, int fd,
         }
     }
 
-    /* Copy frame */
-    block_t *block = block_Alloc (buf.bytesused);
-    if (unlikely(block == NULL))
-        return NULL;
-    block->i_pts = block->i_dts = GetBufferPTS (&buf);
-    memcpy (block->p_buffer, bufv[buf.index].start, buf.bytesused);
+    vlc_mutex_lock (&pool->lock);
+    pool->queued--;
+    bool lend = pool->queued >= MIN_QUEUED_BUFFERS;
+    vlc_mutex_unlock (&pool->lock);
 
-    /* Unlock */
-    if (v4l2_ioctl (fd, VIDIOC_QBUF, &buf) < 0)
+    block_t *block = NULL;
+    if (lend)
+        block = LendBuffer (pool, &buf);
+
+    if (block == NULL)
     {
-        msg_Err (demux, "queue error: %s", vlc_strerror_c(errno));
-        block_Release (block);
-        return NULL;
+        /* Copy frame, as too few buffers are left to the driver */
+        block = block_Alloc (buf.bytesused);
+        if (likely(block != NULL))
+            memcpy (block->p_buffer, pool->bufv[buf.index].start,
+                    buf.bytesused);
+
+        /* Unlock */
+        if (v4l2_ioctl (pool->fd, VIDIOC_QBUF, &buf) < 0)
+        {
+            msg_Err (demux, "queue error: %s", vlc_strerror_c(errno));
+            if (block != NULL)
+                block_Release (block);
+            return NULL;
+        }
+
+        vlc_mutex_lock (&pool->lock);
+        pool->queued++;
+        vlc_mutex_unlock (&pool->lock);
+
+        if (unlikely(block == NULL))
+            return NULL;
     }
+
+    block->i_pts = block->i_dts = GetBufferPTS (&buf);
     return block;
 }
 
@@ -651,9 +748,10 @@ int StartUserPtr (vlc_object_t *obj, int fd)
 /**
  * Allocates memory-mapped buffers, queues them and start streaming.
  * @param n requested buffers count [IN], allocated buffers count [OUT]
- * @return array of allocated buffers (use free()), or NULL on error.
+ * @return the buffers (use CloseMmap() or StopMmap()), or NULL on error.
  */
-struct buffer_t *StartMmap (vlc_object_t *obj, int fd, uint32_t *restrict n)
+vlc_v4l2_buffers_t *StartMmap (vlc_object_t *obj, int fd,
+                               uint32_t *restrict n)
 {
     struct v4l2_requestbuffers req = {
         .count = *n,
@@ -673,10 +771,20 @@ struct buffer_t *StartMmap (vlc_object_t *obj, int fd, uint32_t *restrict n)
         return NULL;
     }
 
-    struct buffer_t *bufv = malloc (req.count * sizeof (*bufv));
-    if (unlikely(bufv == NULL))
+    vlc_v4l2_buffers_t *pool = malloc (sizeof (*pool)
+                                       + req.count * sizeof (pool->bufv[0]));
+    if (unlikely(pool == NULL))
         return NULL;
 
+    vlc_mutex_init (&pool->lock);
+    pool->fd = fd;
+    pool->streaming = true;
+    pool->close = false;
+    pool->queued = 0;
+    pool->refs = 1;
+    pool->count = 0;
+
+    struct buffer_t *bufv = pool->bufv;
     uint32_t bufc = 0;
     while (bufc < req.count)
     {
@@ -702,7 +810,7 @@ struct buffer_t *StartMmap (vlc_object_t *obj, int fd, uint32_t *restrict n)
             goto error;
         }
         bufv[bufc].length = buf.length;
-        bufc++;
+        pool->count = ++bufc;
 
         /* Some drivers refuse to queue buffers before they are mapped. Bug? */
         if (v4l2_ioctl (fd, VIDIOC_QBUF, &buf) < 0)
@@ -711,6 +819,7 @@ struct buffer_t *StartMmap (vlc_object_t *obj, int fd, uint32_t *restrict n)
                      vlc_strerror_c(errno));
             goto error;
         }
+        pool->queued++;
     }
 
     enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -720,19 +829,33 @@ struct buffer_t *StartMmap (vlc_object_t *obj, int fd, uint32_t *restrict n)
         goto error;
     }
     *n = bufc;
-    return bufv;
+    return pool;
 error:
-    StopMmap (fd, bufv, bufc);
+    StopMmap (pool);
     return NULL;
 }
 
-void StopMmap (int fd, struct buffer_t *bufv, uint32_t bufc)
+static void Stop (vlc_v4l2_buffers_t *pool, bool close)
 {
     enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
+    vlc_mutex_lock (&pool->lock);
     /* STREAMOFF implicitly dequeues all buffers */
-    v4l2_ioctl (fd, VIDIOC_STREAMOFF, &type);
-    for (uint32_t i = 0; i < bufc; i++)
-        v4l2_munmap (bufv[i].start, bufv[i].length);
-    free (bufv);
+    v4l2_ioctl (pool->fd, VIDIOC_STREAMOFF, &type);
+    pool->streaming = false;
+    pool->close = close;
+    ReleaseBuffers (pool);
+}
+
+void StopMmap (vlc_v4l2_buffers_t *pool)
+{
+    assert (pool->refs == 1);
+    Stop (pool, false);
+}
+
+void CloseMmap (vlc_v4l2_buffers_t *pool)
+{
+    /* The lent buffers remain mapped until their blocks are released. So
+     * does the device, as libv4l2 may unmap its own buffers when closed. */
+    Stop (pool, true);
 }
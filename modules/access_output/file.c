@@ -37,6 +37,9 @@
 #include <errno.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#ifndef _WIN32
+#   include <sys/uio.h>
+#endif
 #ifdef __OS2__
 #   include <io.h>      /* setmode() */
 #endif
@@ -73,59 +76,40 @@ static ssize_t Read( sout_access_out_t *p_access, block_t *p_buffer )
     return val;
 }
 
+/** Maximum count of blocks written with a single system call */
+#define FILE_IOV_MAX 64
+
 /*****************************************************************************
- * Write: standard write on a file descriptor.
+ * WriteChain: vectored write of a chain of blocks
  *****************************************************************************/
-static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
-{
-    size_t i_write = 0;
-
-    while( p_buffer )
-    {
-        ssize_t val = write ((intptr_t)p_access->p_sys,
-                             p_buffer->p_buffer, p_buffer->i_buffer);
-        if (val <= 0)
-        {
-            if (errno == EINTR)
-                continue;
-            block_ChainRelease (p_buffer);
-            msg_Err( p_access, "cannot write: %s", vlc_strerror_c(errno) );
-            return -1;
-        }
-
-        if ((size_t)val >= p_buffer->i_buffer)
-        {
-            block_t *p_next = p_buffer->p_next;
-            block_Release (p_buffer);
-            p_buffer = p_next;
-        }
-        else
-        {
-            p_buffer->p_buffer += val;
-            p_buffer->i_buffer -= val;
-        }
-        i_write += val;
-    }
-    return i_write;
-}
-
-static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
+static ssize_t WriteChain(sout_access_out_t *access, block_t *block,
+                          ssize_t (*writev_cb)(int, const struct iovec *, int))
 {
     int fd = (intptr_t)access->p_sys;
     ssize_t total = 0;
 
     while (block != NULL)
     {
-        if (block->i_buffer == 0)
+        struct iovec iov[FILE_IOV_MAX];
+        int count = 0;
+
+        for (block_t *b = block; b != NULL && count < FILE_IOV_MAX;
+             b = b->p_next)
         {
-            block_t *next = block->p_next;
-            block_Release(block);
-            block = next;
-            continue;
+            if (b->i_buffer == 0)
+                continue;
+            iov[count].iov_base = b->p_buffer;
+            iov[count].iov_len = b->i_buffer;
+            count++;
+        }
+
+        if (count == 0)
+        {   /* Only empty blocks left */
+            block_ChainRelease(block);
+            break;
         }
 
-        /* TODO: vectorized I/O with writev() */
-        ssize_t val = vlc_write(fd, block->p_buffer, block->i_buffer);
+        ssize_t val = writev_cb(fd, iov, count);
         if (val < 0)
         {
             if (errno == EINTR)
@@ -133,54 +117,63 @@ static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
 
             block_ChainRelease(block);
             msg_Err(access, "cannot write: %s", vlc_strerror_c(errno));
-            total = -1;
-            break;
+            return -1;
         }
 
         total += val;
 
-        assert((size_t)val <= block->i_buffer);
-        block->p_buffer += val;
-        block->i_buffer -= val;
+        /* Release fully written blocks, and skip the partial one */
+        while (block != NULL && (size_t)val >= block->i_buffer)
+        {
+            block_t *next = block->p_next;
+
+            val -= block->i_buffer;
+            block_Release(block);
+            block = next;
+        }
+
+        if (block != NULL)
+        {
+            assert((size_t)val < block->i_buffer);
+            block->p_buffer += val;
+            block->i_buffer -= val;
+        }
     }
 
     return total;
 }
 
-#ifdef S_ISSOCK
-static ssize_t Send(sout_access_out_t *access, block_t *block)
+/*****************************************************************************
+ * Write: standard write on a file descriptor.
+ *****************************************************************************/
+static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 {
-    int fd = (intptr_t)access->p_sys;
-    size_t total = 0;
+#ifndef _WIN32
+    return WriteChain(p_access, p_buffer, writev);
+#else
+    return WriteChain(p_access, p_buffer, vlc_writev);
+#endif
+}
 
-    while (block != NULL)
-    {
-        if (block->i_buffer == 0)
-        {
-            block_t *next = block->p_next;
-            block_Release(block);
-            block = next;
-            continue;
-        }
+static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
+{
+    return WriteChain(access, block, vlc_writev);
+}
 
-        /* TODO: vectorized I/O with sendmsg() */
-        ssize_t val = send(fd, block->p_buffer, block->i_buffer, MSG_NOSIGNAL);
-        if (val <= 0)
-        {   /* FIXME: errno is meaningless if val is zero */
-            if (errno == EINTR)
-                continue;
-            block_ChainRelease(block);
-            msg_Err(access, "cannot write: %s", vlc_strerror_c(errno));
-            return -1;
-        }
+#ifdef S_ISSOCK
+static ssize_t SendV(int fd, const struct iovec *iov, int count)
+{
+    struct msghdr hdr = {
+        .msg_iov = (struct iovec *)iov,
+        .msg_iovlen = count,
+    };
 
-        total += val;
+    return sendmsg(fd, &hdr, MSG_NOSIGNAL);
+}
 
-        assert((size_t)val <= block->i_buffer);
-        block->p_buffer += val;
-        block->i_buffer -= val;
-    }
-    return total;
+static ssize_t Send(sout_access_out_t *access, block_t *block)
+{
+    return WriteChain(access, block, SendV);
 }
 #endif
 
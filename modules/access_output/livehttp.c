@@ -43,6 +43,8 @@
 #include <vlc_fs.h>
 #include <vlc_strings.h>
 #include <vlc_charset.h>
+#include <vlc_httpd.h>
+#include <vlc_memstream.h>
 
 #include <gcrypt.h>
 #include <vlc_gcrypt.h>
@@ -102,6 +104,21 @@ static void Close( vlc_object_t * );
 #define RANDOMIV_TEXT N_("Use randomized IV for encryption")
 #define RANDOMIV_LONGTEXT N_("Generate IV instead using segment-number as IV")
 
+#define INITSEG_TEXT N_("Initialization segment")
+#define INITSEG_LONGTEXT N_("Path of the initialization segment of fragmented "\
+                            "MP4 streams (mux=mp4stream). By default, the " \
+                            "segment path with its #'s replaced by \"init\".")
+
+#define INITSEGURL_TEXT N_("Initialization segment URL")
+#define INITSEGURL_LONGTEXT N_("URL of the initialization segment to put in " \
+                               "the index file. By default, the index URL " \
+                               "with its #'s replaced by \"init\".")
+
+#define HTTPD_TEXT N_("Serve from memory")
+#define HTTPD_LONGTEXT N_("Keep the segments and the index in memory, and " \
+                          "serve them with the built-in HTTP server instead " \
+                          "of writing files. Paths are then HTTP paths.")
+
 #define INTITIAL_SEG_TEXT N_("Number of first segment")
 #define INITIAL_SEG_LONGTEXT N_("The number of the first segment generated")
 
@@ -125,6 +142,8 @@ vlc_module_begin ()
               NOCACHE_TEXT, NOCACHE_LONGTEXT, true )
     add_bool( SOUT_CFG_PREFIX "generate-iv", false,
               RANDOMIV_TEXT, RANDOMIV_LONGTEXT, true )
+    add_bool( SOUT_CFG_PREFIX "httpd", false,
+              HTTPD_TEXT, HTTPD_LONGTEXT, true )
     add_string( SOUT_CFG_PREFIX "index", NULL,
                 INDEX_TEXT, INDEX_LONGTEXT, false )
     add_string( SOUT_CFG_PREFIX "index-url", NULL,
@@ -135,6 +154,10 @@ vlc_module_begin ()
                 KEYFILE_TEXT, KEYFILE_LONGTEXT, true )
     add_loadfile( SOUT_CFG_PREFIX "key-loadfile", NULL,
                 KEYLOADFILE_TEXT, KEYLOADFILE_LONGTEXT, true )
+    add_string( SOUT_CFG_PREFIX "init-segment", NULL,
+                INITSEG_TEXT, INITSEG_LONGTEXT, true )
+    add_string( SOUT_CFG_PREFIX "init-segment-url", NULL,
+                INITSEGURL_TEXT, INITSEGURL_LONGTEXT, true )
     set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -156,6 +179,9 @@ static const char *const ppsz_sout_options[] = {
     "key-loadfile",
     "generate-iv",
     "initial-segment-number",
+    "init-segment",
+    "init-segment-url",
+    "httpd",
     NULL
 };
 
@@ -172,6 +198,8 @@ typedef struct output_segment
     float f_seglength;
     uint32_t i_segment_number;
     uint8_t aes_ivs[16];
+    block_t *p_data; /* contents, when served from memory */
+    httpd_file_t *p_file;
 } output_segment_t;
 
 struct sout_access_out_sys_t
@@ -180,6 +208,8 @@ struct sout_access_out_sys_t
     char *psz_indexPath;
     char *psz_indexUrl;
     char *psz_keyfile;
+    char *psz_initPath;
+    char *psz_initUrl;
     mtime_t i_keyfile_modification;
     mtime_t i_opendts;
     mtime_t i_dts_offset;
@@ -200,14 +230,31 @@ struct sout_access_out_sys_t
     bool b_caching;
     bool b_generate_iv;
     bool b_segment_has_data;
+    bool b_fmp4; /* fragmented MP4 (CMAF) rather than MPEG-TS */
     uint8_t aes_ivs[16];
     gcry_cipher_hd_t aes_ctx;
     char *key_uri;
     uint8_t stuffing_bytes[16];
     ssize_t stuffing_size;
     vlc_array_t *segments_t;
+
+    /* Serving from memory */
+    httpd_host_t *p_host;
+    output_segment_t *p_memseg; /* segment being written */
+    block_t **pp_memseg_end;
+    block_t *p_init;
+    httpd_file_t *p_init_file;
+    vlc_mutex_t index_lock;
+    block_t *p_index;
+    httpd_file_t *p_index_file;
 };
 
+/* Tells whether a segment is being written */
+static inline bool segmentIsOpen( const sout_access_out_sys_t *p_sys )
+{
+    return p_sys->i_handle >= 0 || p_sys->p_memseg != NULL;
+}
+
 static int LoadCryptFile( sout_access_out_t *p_access);
 static int CryptSetup( sout_access_out_t *p_access, char *keyfile );
 static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer );
@@ -251,6 +298,10 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_caching = var_GetBool( p_access, SOUT_CFG_PREFIX "caching") ;
     p_sys->b_generate_iv = var_GetBool( p_access, SOUT_CFG_PREFIX "generate-iv") ;
     p_sys->b_segment_has_data = false;
+    bool b_httpd = var_GetBool( p_access, SOUT_CFG_PREFIX "httpd" );
+    /* Memory is only bounded by dropping old segments */
+    if( b_httpd )
+        p_sys->b_delsegs = true;
 
     p_sys->segments_t = vlc_array_new();
 
@@ -271,18 +322,22 @@ static int Open( vlc_object_t *p_this )
             return VLC_ENOMEM;
         }
         p_sys->psz_indexPath = psz_tmp;
-        if( p_sys->i_initial_segment != 1 )
+        if( p_sys->i_initial_segment != 1 && !b_httpd )
             vlc_unlink( p_sys->psz_indexPath );
     }
 
     p_sys->psz_indexUrl = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "index-url" );
     p_sys->psz_keyfile  = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "key-loadfile" );
+    p_sys->psz_initPath = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "init-segment" );
+    p_sys->psz_initUrl  = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "init-segment-url" );
     p_sys->key_uri      = var_GetNonEmptyString( p_access, SOUT_CFG_PREFIX "key-uri" );
 
     p_access->p_sys = p_sys;
 
     if( p_sys->psz_keyfile && ( LoadCryptFile( p_access ) < 0 ) )
     {
+        free( p_sys->psz_initUrl );
+        free( p_sys->psz_initPath );
         free( p_sys->psz_indexUrl );
         free( p_sys->psz_indexPath );
         free( p_sys );
@@ -291,6 +346,8 @@ static int Open( vlc_object_t *p_this )
     }
     else if( !p_sys->psz_keyfile && ( CryptSetup( p_access, NULL ) < 0 ) )
     {
+        free( p_sys->psz_initUrl );
+        free( p_sys->psz_initPath );
         free( p_sys->psz_indexUrl );
         free( p_sys->psz_indexPath );
         free( p_sys );
@@ -302,6 +359,32 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_segment = p_sys->i_initial_segment-1;
     p_sys->psz_cursegPath = NULL;
 
+    vlc_mutex_init( &p_sys->index_lock );
+    if( b_httpd )
+    {
+        p_sys->p_host = vlc_http_HostNew( VLC_OBJECT(p_access) );
+        if( !p_sys->p_host )
+        {
+            msg_Err( p_access, "cannot start HTTP server" );
+            vlc_mutex_destroy( &p_sys->index_lock );
+            if( p_sys->key_uri )
+            {
+                gcry_cipher_close( p_sys->aes_ctx );
+                free( p_sys->key_uri );
+            }
+            vlc_array_destroy( p_sys->segments_t );
+            free( p_sys->psz_initUrl );
+            free( p_sys->psz_initPath );
+            free( p_sys->psz_indexUrl );
+            free( p_sys->psz_indexPath );
+            free( p_sys );
+            return VLC_EGENERIC;
+        }
+        if( p_sys->i_numsegs == 0 )
+            msg_Warn( p_access, "no segment window set, memory will grow "
+                      "until the end of the stream" );
+    }
+
     p_access->pf_write = Write;
     p_access->pf_seek  = Seek;
     p_access->pf_control = Control;
@@ -506,8 +589,155 @@ static char *formatSegmentPath( char *psz_path, uint32_t i_seg )
     return psz_result;
 }
 
+/*****************************************************************************
+ * formatInitPath: create initialization segment path name from segment path
+ *****************************************************************************/
+static char *formatInitPath( const char *psz_path )
+{
+    char *psz_result;
+    size_t i_prefix = strcspn( psz_path, SEG_NUMBER_PLACEHOLDER );
+
+    if ( !psz_path[i_prefix] )
+    {
+        if ( asprintf( &psz_result, "%s.init", psz_path ) < 0 )
+            return NULL;
+        return psz_result;
+    }
+
+    size_t i_cnt = strspn( psz_path + i_prefix, SEG_NUMBER_PLACEHOLDER );
+    if ( asprintf( &psz_result, "%.*sinit%s", (int)i_prefix, psz_path,
+                   psz_path + i_prefix + i_cnt ) < 0 )
+        return NULL;
+    return psz_result;
+}
+
+/*****************************************************************************
+ * SegmentCallback: serve a segment kept in memory
+ *****************************************************************************/
+static int SegmentCallback( httpd_file_sys_t *p_args, httpd_file_t *f,
+                            uint8_t *p_request, uint8_t **pp_data, int *pi_data )
+{
+    VLC_UNUSED(f); VLC_UNUSED(p_request);
+    /* The segment contents never change once published, and the file is
+     * deleted (with the HTTP host lock held) before they are released */
+    const block_t *p_block = (const block_t *)p_args;
+
+    *pp_data = malloc( p_block->i_buffer );
+    if( unlikely( !*pp_data ) )
+    {
+        *pi_data = 0;
+        return VLC_ENOMEM;
+    }
+    memcpy( *pp_data, p_block->p_buffer, p_block->i_buffer );
+    *pi_data = p_block->i_buffer;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * IndexCallback: serve the latest index kept in memory
+ *****************************************************************************/
+static int IndexCallback( httpd_file_sys_t *p_args, httpd_file_t *f,
+                          uint8_t *p_request, uint8_t **pp_data, int *pi_data )
+{
+    VLC_UNUSED(f); VLC_UNUSED(p_request);
+    sout_access_out_sys_t *p_sys = (sout_access_out_sys_t *)p_args;
+    int i_ret = VLC_SUCCESS;
+
+    vlc_mutex_lock( &p_sys->index_lock );
+    *pi_data = p_sys->p_index->i_buffer;
+    *pp_data = malloc( *pi_data );
+    if( likely( *pp_data ) )
+        memcpy( *pp_data, p_sys->p_index->p_buffer, *pi_data );
+    else
+    {
+        *pi_data = 0;
+        i_ret = VLC_ENOMEM;
+    }
+    vlc_mutex_unlock( &p_sys->index_lock );
+    return i_ret;
+}
+
+/*****************************************************************************
+ * publishBlock: serve a block from memory
+ *****************************************************************************/
+static httpd_file_t *publishBlock( sout_access_out_t *p_access,
+                                   const char *psz_url, block_t *p_block )
+{
+    httpd_file_t *p_file = httpd_FileNew( p_access->p_sys->p_host, psz_url,
+                                          NULL, NULL, NULL, SegmentCallback,
+                                          (httpd_file_sys_t *)p_block );
+    if( !p_file )
+        msg_Err( p_access, "cannot serve `%s'", psz_url );
+    return p_file;
+}
+
+/*****************************************************************************
+ * writeInitSegment: write the initialization segment of fragmented MP4
+ *****************************************************************************/
+static int writeInitSegment( sout_access_out_t *p_access, block_t *p_buffer )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if ( !p_sys->psz_initPath )
+        p_sys->psz_initPath = formatInitPath( p_access->psz_path );
+    if ( !p_sys->psz_initUrl )
+        p_sys->psz_initUrl = formatInitPath( p_sys->psz_indexUrl ?
+                                             p_sys->psz_indexUrl :
+                                             p_access->psz_path );
+    if ( unlikely( !p_sys->psz_initPath || !p_sys->psz_initUrl ) )
+    {
+        block_Release( p_buffer );
+        return -1;
+    }
+
+    if ( p_sys->p_host )
+    {
+        ssize_t i_size = p_buffer->i_buffer;
+
+        p_sys->p_init = p_buffer;
+        p_sys->p_init_file = publishBlock( p_access, p_sys->psz_initPath,
+                                           p_buffer );
+        return p_sys->p_init_file ? i_size : -1;
+    }
+
+    int fd = vlc_open( p_sys->psz_initPath, O_WRONLY | O_CREAT | O_LARGEFILE |
+                       O_TRUNC, 0666 );
+    if ( fd == -1 )
+    {
+        msg_Err( p_access, "cannot open `%s' (%s)", p_sys->psz_initPath,
+                 vlc_strerror_c(errno) );
+        block_Release( p_buffer );
+        return -1;
+    }
+
+    ssize_t i_write = 0;
+    while ( (size_t)i_write < p_buffer->i_buffer )
+    {
+        ssize_t val = vlc_write( fd, p_buffer->p_buffer + i_write,
+                                 p_buffer->i_buffer - i_write );
+        if ( val == -1 )
+        {
+            if ( errno == EINTR )
+                continue;
+            msg_Err( p_access, "cannot write `%s' (%s)", p_sys->psz_initPath,
+                     vlc_strerror_c(errno) );
+            break;
+        }
+        i_write += val;
+    }
+    vlc_close( fd );
+    block_Release( p_buffer );
+
+    msg_Dbg( p_access, "LiveHttpInitSegmentComplete: %s", p_sys->psz_initPath );
+    return i_write;
+}
+
 static void destroySegment( output_segment_t *segment )
 {
+    if( segment->p_file )
+        httpd_FileDelete( segment->p_file );
+    if( segment->p_data )
+        block_ChainRelease( segment->p_data );
     free( segment->psz_filename );
     free( segment->psz_duration );
     free( segment->psz_uri );
@@ -557,6 +787,69 @@ static bool isFirstItemRemovable( sout_access_out_sys_t *p_sys, uint32_t i_first
     return duration >= (first->f_seglength + (float)(p_sys->i_numsegs * p_sys->i_seglen));
 }
 
+/************************************************************************
+ * writeIndex: atomically replace the index file
+ ************************************************************************/
+static void writeIndex( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys,
+                        const char *psz_index, size_t i_index )
+{
+    char *psz_idxTmp;
+    if ( asprintf( &psz_idxTmp, "%s.tmp", p_sys->psz_indexPath ) < 0)
+        return;
+
+    FILE *fp = vlc_fopen( psz_idxTmp, "wt");
+    if ( !fp )
+    {
+        msg_Err( p_access, "cannot open index file `%s'", psz_idxTmp );
+        free( psz_idxTmp );
+        return;
+    }
+
+    bool b_ok = fwrite( psz_index, 1, i_index, fp ) == i_index;
+    if ( fclose( fp ) )
+        b_ok = false;
+
+    if ( !b_ok || vlc_rename ( psz_idxTmp, p_sys->psz_indexPath ) < 0 )
+    {
+        vlc_unlink( psz_idxTmp );
+        msg_Err( p_access, "Error moving LiveHttp index file" );
+    }
+    else
+        msg_Dbg( p_access, "LiveHttpIndexComplete: %s" , p_sys->psz_indexPath );
+
+    free( psz_idxTmp );
+}
+
+/************************************************************************
+ * publishIndex: replace the index served from memory
+ ************************************************************************/
+static void publishIndex( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys,
+                          const char *psz_index, size_t i_index )
+{
+    block_t *p_index = block_Alloc( i_index );
+    if ( unlikely( !p_index ) )
+        return;
+    memcpy( p_index->p_buffer, psz_index, i_index );
+
+    vlc_mutex_lock( &p_sys->index_lock );
+    block_t *p_old = p_sys->p_index;
+    p_sys->p_index = p_index;
+    vlc_mutex_unlock( &p_sys->index_lock );
+
+    if ( p_old )
+        block_Release( p_old );
+    else
+    {
+        p_sys->p_index_file = httpd_FileNew( p_sys->p_host, p_sys->psz_indexPath,
+                                             "application/vnd.apple.mpegurl",
+                                             NULL, NULL, IndexCallback,
+                                             (httpd_file_sys_t *)p_sys );
+        if ( !p_sys->p_index_file )
+            msg_Err( p_access, "cannot serve `%s'", p_sys->psz_indexPath );
+    }
+    msg_Dbg( p_access, "LiveHttpIndexComplete: %s" , p_sys->psz_indexPath );
+}
+
 /************************************************************************
  * updateIndexAndDel: If necessary, update index file & delete old segments
  ************************************************************************/
@@ -581,33 +874,23 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
     // First update index
     if ( p_sys->psz_indexPath )
     {
-        int val;
-        FILE *fp;
-        char *psz_idxTmp;
-        if ( asprintf( &psz_idxTmp, "%s.tmp", p_sys->psz_indexPath ) < 0)
-            return -1;
+        struct vlc_memstream ms;
 
-        fp = vlc_fopen( psz_idxTmp, "wt");
-        if ( !fp )
-        {
-            msg_Err( p_access, "cannot open index file `%s'", psz_idxTmp );
-            free( psz_idxTmp );
+        if ( vlc_memstream_open( &ms ) )
             return -1;
-        }
 
-        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%zu\n#EXT-X-VERSION:3\n#EXT-X-ALLOW-CACHE:%s"
+        vlc_memstream_printf( &ms, "#EXTM3U\n#EXT-X-TARGETDURATION:%zu\n#EXT-X-VERSION:%d\n#EXT-X-ALLOW-CACHE:%s"
                           "%s\n#EXT-X-MEDIA-SEQUENCE:%"PRIu32"\n%s", p_sys->i_seglen,
+                          p_sys->b_fmp4 ? 7 : 3,
                           p_sys->b_caching ? "YES" : "NO",
                           p_sys->i_numsegs > 0 ? "" : b_isend ? "\n#EXT-X-PLAYLIST-TYPE:VOD" : "\n#EXT-X-PLAYLIST-TYPE:EVENT",
                           i_firstseg, ((p_sys->i_initial_segment > 1) && (p_sys->i_initial_segment == i_firstseg)) ? "#EXT-X-DISCONTINUITY\n" : ""
-                          ) < 0 )
-        {
-            free( psz_idxTmp );
-            fclose( fp );
-            return -1;
-        }
-        char *psz_current_uri=NULL;
+                          );
+        /* fMP4 media segments need the initialization segment */
+        if ( p_sys->b_fmp4 )
+            vlc_memstream_printf( &ms, "#EXT-X-MAP:URI=\"%s\"\n", p_sys->psz_initUrl );
 
+        const char *psz_current_uri = NULL;
 
         for ( uint32_t i = i_firstseg; i <= p_sys->i_segment; i++ )
         {
@@ -619,9 +902,7 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
                 ( !psz_current_uri ||  strcmp( psz_current_uri, segment->psz_key_uri ) )
               )
             {
-                int ret = 0;
-                free( psz_current_uri );
-                psz_current_uri = strdup( segment->psz_key_uri );
+                psz_current_uri = segment->psz_key_uri;
                 if( p_sys->b_generate_iv )
                 {
                     unsigned long long iv_hi = segment->aes_ivs[0];
@@ -633,55 +914,28 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
                         iv_lo <<= 8;
                         iv_lo |= segment->aes_ivs[8+i] & 0xff;
                     }
-                    ret = fprintf( fp, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\",IV=0X%16.16llx%16.16llx\n",
-                                   segment->psz_key_uri, iv_hi, iv_lo );
+                    vlc_memstream_printf( &ms, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\",IV=0X%16.16llx%16.16llx\n",
+                                          segment->psz_key_uri, iv_hi, iv_lo );
 
                 } else {
-                    ret = fprintf( fp, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\"\n", segment->psz_key_uri );
-                }
-                if( ret < 0 )
-                {
-                    free( psz_current_uri );
-                    free( psz_idxTmp );
-                    fclose( fp );
-                    return -1;
+                    vlc_memstream_printf( &ms, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\"\n", segment->psz_key_uri );
                 }
             }
 
-            val = fprintf( fp, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
-            if ( val < 0 )
-            {
-                free( psz_current_uri );
-                free( psz_idxTmp );
-                fclose( fp );
-                return -1;
-            }
+            vlc_memstream_printf( &ms, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
         }
-        free( psz_current_uri );
 
         if ( b_isend )
-        {
-            if ( fputs ( STR_ENDLIST, fp ) < 0)
-            {
-                free( psz_idxTmp );
-                fclose( fp ) ;
-                return -1;
-            }
-
-        }
-        fclose( fp );
+            vlc_memstream_puts( &ms, STR_ENDLIST );
 
-        val = vlc_rename ( psz_idxTmp, p_sys->psz_indexPath);
+        if ( vlc_memstream_close( &ms ) )
+            return -1;
 
-        if ( val < 0 )
-        {
-            vlc_unlink( psz_idxTmp );
-            msg_Err( p_access, "Error moving LiveHttp index file" );
-        }
+        if ( p_sys->p_host )
+            publishIndex( p_access, p_sys, ms.ptr, ms.length );
         else
-            msg_Dbg( p_access, "LiveHttpIndexComplete: %s" , p_sys->psz_indexPath );
-
-        free( psz_idxTmp );
+            writeIndex( p_access, p_sys, ms.ptr, ms.length );
+        free( ms.ptr );
     }
 
     // Then take care of deletion
@@ -694,7 +948,7 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
          msg_Dbg( p_access, "Removing segment number %d", segment->i_segment_number );
          vlc_array_remove( p_sys->segments_t, 0 );
 
-         if ( segment->psz_filename )
+         if ( segment->psz_filename && !p_sys->p_host )
          {
              vlc_unlink( segment->psz_filename );
          }
@@ -707,12 +961,29 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
     return 0;
 }
 
+/*****************************************************************************
+ * segmentWrite: write to the current segment
+ *****************************************************************************/
+static ssize_t segmentWrite( sout_access_out_sys_t *p_sys, const void *p_data,
+                             size_t i_data )
+{
+    if ( !p_sys->p_memseg )
+        return vlc_write( p_sys->i_handle, p_data, i_data );
+
+    block_t *p_block = block_Alloc( i_data );
+    if ( unlikely( !p_block ) )
+        return -1;
+    memcpy( p_block->p_buffer, p_data, i_data );
+    block_ChainLastAppend( &p_sys->pp_memseg_end, p_block );
+    return i_data;
+}
+
 /*****************************************************************************
  * closeCurrentSegment: Close the segment file
  *****************************************************************************/
 static void closeCurrentSegment( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys, bool b_isend )
 {
-    if ( p_sys->i_handle >= 0 )
+    if ( segmentIsOpen( p_sys ) )
     {
         output_segment_t *segment = vlc_array_item_at_index( p_sys->segments_t, vlc_array_count( p_sys->segments_t ) - 1 );
 
@@ -726,7 +997,7 @@ static void closeCurrentSegment( sout_access_out_t *p_access, sout_access_out_sy
                msg_Err( p_access, "Couldn't encrypt 16 bytes: %s", gpg_strerror(err) );
             } else {
 
-            int ret = vlc_write( p_sys->i_handle, p_sys->stuffing_bytes, 16 );
+            int ret = segmentWrite( p_sys, p_sys->stuffing_bytes, 16 );
             if( ret != 16 )
                 msg_Err( p_access, "Couldn't write 16 bytes" );
             }
@@ -734,8 +1005,19 @@ static void closeCurrentSegment( sout_access_out_t *p_access, sout_access_out_sy
         }
 
 
-        vlc_close( p_sys->i_handle );
-        p_sys->i_handle = -1;
+        if ( p_sys->p_memseg )
+        {
+            segment->p_data = block_ChainGather( segment->p_data );
+            if ( segment->p_data )
+                segment->p_file = publishBlock( p_access, segment->psz_filename,
+                                                segment->p_data );
+            p_sys->p_memseg = NULL;
+        }
+        else
+        {
+            vlc_close( p_sys->i_handle );
+            p_sys->i_handle = -1;
+        }
 
         if( ! ( us_asprintf( &segment->psz_duration, "%.2f", p_sys->f_seglen ) ) )
         {
@@ -810,7 +1092,8 @@ static void Close( vlc_object_t * p_this )
     {
         output_segment_t *segment = vlc_array_item_at_index( p_sys->segments_t, 0 );
         vlc_array_remove( p_sys->segments_t, 0 );
-        if( p_sys->b_delsegs && p_sys->i_numsegs && segment->psz_filename )
+        if( p_sys->b_delsegs && p_sys->i_numsegs && segment->psz_filename &&
+            !p_sys->p_host )
         {
             msg_Dbg( p_access, "Removing segment number %d name %s", segment->i_segment_number, segment->psz_filename );
             vlc_unlink( segment->psz_filename );
@@ -820,6 +1103,22 @@ static void Close( vlc_object_t * p_this )
     }
     vlc_array_destroy( p_sys->segments_t );
 
+    if( p_sys->p_host )
+    {
+        if( p_sys->p_index_file )
+            httpd_FileDelete( p_sys->p_index_file );
+        if( p_sys->p_index )
+            block_Release( p_sys->p_index );
+        if( p_sys->p_init_file )
+            httpd_FileDelete( p_sys->p_init_file );
+        if( p_sys->p_init )
+            block_Release( p_sys->p_init );
+        httpd_HostDelete( p_sys->p_host );
+    }
+    vlc_mutex_destroy( &p_sys->index_lock );
+
+    free( p_sys->psz_initUrl );
+    free( p_sys->psz_initPath );
     free( p_sys->psz_indexUrl );
     free( p_sys->psz_indexPath );
     free( p_sys );
@@ -873,8 +1172,11 @@ static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t
         return -1;
     }
 
-    fd = vlc_open( segment->psz_filename, O_WRONLY | O_CREAT | O_LARGEFILE |
-                     O_TRUNC, 0666 );
+    if ( p_sys->p_host )
+        fd = 0;
+    else
+        fd = vlc_open( segment->psz_filename, O_WRONLY | O_CREAT | O_LARGEFILE |
+                       O_TRUNC, 0666 );
     if ( fd == -1 )
     {
         msg_Err( p_access, "cannot open `%s' (%s)", segment->psz_filename,
@@ -900,7 +1202,13 @@ static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t
     msg_Dbg( p_access, "Successfully opened livehttp file: %s (%"PRIu32")" , segment->psz_filename, i_newseg );
 
     p_sys->psz_cursegPath = strdup(segment->psz_filename);
-    p_sys->i_handle = fd;
+    if ( p_sys->p_host )
+    {
+        p_sys->p_memseg = segment;
+        p_sys->pp_memseg_end = &segment->p_data;
+    }
+    else
+        p_sys->i_handle = fd;
     p_sys->i_segment = i_newseg;
     p_sys->b_segment_has_data = false;
     return fd;
@@ -913,7 +1221,7 @@ static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer )
     sout_access_out_sys_t *p_sys = p_access->p_sys;
     ssize_t writevalue = 0;
 
-    if( p_sys->i_handle > 0 && p_sys->b_segment_has_data &&
+    if( segmentIsOpen( p_sys ) && p_sys->b_segment_has_data &&
        (( p_buffer->i_length + p_buffer->i_dts - p_sys->i_opendts ) >= p_sys->i_seglenm ) )
     {
         writevalue = writeSegment( p_access );
@@ -926,7 +1234,7 @@ static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer )
         return writevalue;
     }
 
-    if ( unlikely( p_sys->i_handle < 0 ) )
+    if ( unlikely( !segmentIsOpen( p_sys ) ) )
     {
         p_sys->i_opendts = p_buffer->i_dts;
 
@@ -993,7 +1301,9 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
 
         }
 
-        ssize_t val = vlc_write( p_sys->i_handle, output->p_buffer, output->i_buffer );
+        /* In memory, the block itself is kept (below) rather than copied */
+        ssize_t val = p_sys->p_memseg ? (ssize_t)output->i_buffer
+                    : vlc_write( p_sys->i_handle, output->p_buffer, output->i_buffer );
         if ( val == -1 )
         {
            if ( errno == EINTR )
@@ -1008,7 +1318,13 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
         if ( (size_t)val >= output->i_buffer )
         {
            block_t *p_next = output->p_next;
-           block_Release (output);
+           if ( p_sys->p_memseg )
+           {
+               output->p_next = NULL;
+               block_ChainLastAppend( &p_sys->pp_memseg_end, output );
+           }
+           else
+               block_Release (output);
            output = p_next;
            crypted=false;
         }
@@ -1031,10 +1347,41 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     sout_access_out_sys_t *p_sys = p_access->p_sys;
     while( p_buffer )
     {
+        /* The fragmented MP4 muxer starts with the initialization segment
+         * (ftyp and moov), which goes to its own file. Its media segments
+         * can then be split at every fragment (moof) */
+        if( p_buffer->i_flags & BLOCK_FLAG_HEADER && !p_sys->b_fmp4 &&
+            vlc_array_count( p_sys->segments_t ) == 0 && !p_sys->ongoing_segment &&
+            p_buffer->i_buffer >= 8 && !memcmp( &p_buffer->p_buffer[4], "ftyp", 4 ) )
+        {
+            block_t *p_temp = p_buffer->p_next;
+            p_buffer->p_next = NULL;
+
+            p_sys->b_fmp4 = true;
+            ssize_t ret = writeInitSegment( p_access, p_buffer );
+            if( ret < 0 )
+            {
+                block_ChainRelease( p_temp );
+                return ret;
+            }
+            i_write += ret;
+            p_buffer = p_temp;
+            continue;
+        }
+
+        /* The fragment header has no timestamps: give it those of its
+         * first sample, so that the segment starts from there */
+        if( p_sys->b_fmp4 && p_sys->ongoing_segment &&
+            p_sys->ongoing_segment->i_dts <= VLC_TS_INVALID )
+            p_sys->ongoing_segment->i_dts = p_buffer->i_dts;
+
+        const uint32_t i_split_flag = p_sys->b_fmp4 ? BLOCK_FLAG_TYPE_I
+                                                    : BLOCK_FLAG_HEADER;
+
         /* Check if current block is already past segment-length
             and we want to write gathered blocks into segment
             and update playlist */
-        if( p_sys->ongoing_segment && ( p_sys->b_splitanywhere  || ( p_buffer->i_flags & BLOCK_FLAG_HEADER ) ) )
+        if( p_sys->ongoing_segment && ( p_sys->b_splitanywhere  || ( p_buffer->i_flags & i_split_flag ) ) )
         {
             msg_Dbg( p_access, "Moving ongoing segment to full segments-queue" );
             block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
@@ -45,11 +45,21 @@
 #   include <ws2tcpip.h>
 #else
 #   include <sys/socket.h>
+#   include <sys/uio.h>
+#endif
+#ifdef __linux__
+#   include <linux/net_tstamp.h>
 #endif
 
 #include <vlc_network.h>
 
-#define MAX_EMPTY_BLOCKS 200
+/** Maximum count of payload blocks gathered in a single datagram */
+#define UDP_IOV_MAX 16
+/** Maximum count of datagrams submitted with a single system call */
+#define UDP_BATCH_MAX 32
+/** How long before their departure time datagrams are given to the kernel
+ *  in departure time mode */
+#define UDP_TXTIME_LOOKAHEAD (CLOCK_FREQ / 100)
 
 /*****************************************************************************
  * Module descriptor
@@ -71,6 +81,13 @@ static void Close( vlc_object_t * );
                           "helps reducing the scheduling load on " \
                           "heavily-loaded systems." )
 
+#define TXTIME_TEXT N_("Kernel pacing")
+#define TXTIME_LONGTEXT N_("Tag each packet with its departure time, and " \
+                           "let the kernel (fq or etf queueing discipline) " \
+                           "send it at the right time, instead of sleeping " \
+                           "before each packet. Packets are submitted by " \
+                           "batches. This requires Linux 4.19 or later.")
+
 vlc_module_begin ()
     set_description( N_("UDP stream output") )
     set_shortname( "UDP" )
@@ -79,6 +96,8 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000, CACHING_TEXT, CACHING_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "group", 1, GROUP_TEXT, GROUP_LONGTEXT,
                                  true )
+    add_bool( SOUT_CFG_PREFIX "txtime", false, TXTIME_TEXT, TXTIME_LONGTEXT,
+              true )
 
     set_capability( "sout access", 0 )
     add_shortcut( "udp" )
@@ -92,6 +111,7 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "caching",
     "group",
+    "txtime",
     NULL
 };
 
@@ -108,18 +128,32 @@ static int  Seek    ( sout_access_out_t *, off_t  );
 static int Control( sout_access_out_t *, int, va_list );
 
 static void* ThreadWrite( void * );
-static block_t *NewUDPPacket( sout_access_out_t *, mtime_t );
+
+/**
+ * UDP datagram pending transmission.
+ *
+ * The datagram payload is a chain of the blocks written by the muxer, so that
+ * it can be sent with scatter-gather I/O without copying. Only blocks larger
+ * than the MTU are copied, as they need to be split.
+ */
+typedef struct
+{
+    block_t   self; /**< Date, flags and total length of the datagram */
+    block_t  *p_payload;
+    block_t **pp_last;
+    unsigned  i_count; /**< Count of blocks in the payload chain */
+} sout_udp_datagram_t;
 
 struct sout_access_out_sys_t
 {
     mtime_t       i_caching;
     int           i_handle;
     bool          b_mtu_warning;
+    bool          b_txtime; /**< Departure times set with SO_TXTIME */
     size_t        i_mtu;
 
     block_fifo_t *p_fifo;
-    block_fifo_t *p_empty_blocks;
-    block_t      *p_buffer;
+    sout_udp_datagram_t *p_buffer;
 
     vlc_thread_t  thread;
 };
@@ -210,8 +244,23 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_handle = i_handle;
     p_sys->i_mtu = var_CreateGetInteger( p_this, "mtu" );
     p_sys->b_mtu_warning = false;
-    p_sys->p_fifo = block_FifoNew();
-    p_sys->p_empty_blocks = block_FifoNew();
+    p_sys->b_txtime = false;
+    if( var_GetBool( p_access, SOUT_CFG_PREFIX "txtime" ) )
+    {
+#ifdef SO_TXTIME
+        /* mdate() uses the monotonic clock, supported by the fq qdisc */
+        struct sock_txtime cfg = { .clockid = CLOCK_MONOTONIC, .flags = 0 };
+
+        if( setsockopt( i_handle, SOL_SOCKET, SO_TXTIME, &cfg,
+                        sizeof( cfg ) ) == 0 )
+            p_sys->b_txtime = true;
+        else
+#endif
+            msg_Warn( p_access, "kernel pacing not supported, "
+                      "falling back to user-space pacing" );
+    }
+    /* The FIFO has exactly one producer and one consumer thread */
+    p_sys->p_fifo = block_FifoNewSPSC();
     p_sys->p_buffer = NULL;
 
     if( vlc_clone( &p_sys->thread, ThreadWrite, p_access,
@@ -219,7 +268,6 @@ static int Open( vlc_object_t *p_this )
     {
         msg_Err( p_access, "cannot spawn sout access thread" );
         block_FifoRelease( p_sys->p_fifo );
-        block_FifoRelease( p_sys->p_empty_blocks );
         net_Close (i_handle);
         free (p_sys);
         return VLC_EGENERIC;
@@ -243,9 +291,8 @@ static void Close( vlc_object_t * p_this )
     vlc_cancel( p_sys->thread );
     vlc_join( p_sys->thread, NULL );
     block_FifoRelease( p_sys->p_fifo );
-    block_FifoRelease( p_sys->p_empty_blocks );
 
-    if( p_sys->p_buffer ) block_Release( p_sys->p_buffer );
+    if( p_sys->p_buffer ) block_Release( &p_sys->p_buffer->self );
 
     net_Close( p_sys->i_handle );
     free( p_sys );
@@ -267,6 +314,77 @@ static int Control( sout_access_out_t *p_access, int i_query, va_list args )
     return VLC_SUCCESS;
 }
 
+/*****************************************************************************
+ * Datagrams
+ *****************************************************************************/
+static void DatagramRelease( block_t *p_block )
+{
+    sout_udp_datagram_t *p_dgram = (sout_udp_datagram_t *)p_block;
+
+    block_ChainRelease( p_dgram->p_payload );
+    free( p_dgram );
+}
+
+static sout_udp_datagram_t *DatagramNew( mtime_t i_dts )
+{
+    sout_udp_datagram_t *p_dgram = malloc( sizeof( *p_dgram ) );
+    if( unlikely(p_dgram == NULL) )
+        return NULL;
+
+    block_Init( &p_dgram->self, NULL, 0 );
+    p_dgram->self.pf_release = DatagramRelease;
+    p_dgram->self.i_dts = i_dts;
+    p_dgram->p_payload = NULL;
+    p_dgram->pp_last = &p_dgram->p_payload;
+    p_dgram->i_count = 0;
+    return p_dgram;
+}
+
+static void DatagramAppend( sout_udp_datagram_t *p_dgram, block_t *p_block )
+{
+    if( p_dgram->i_count >= UDP_IOV_MAX )
+    {   /* Too many small blocks: coalesce them */
+        block_t *p_gather = block_ChainGather( p_dgram->p_payload );
+        if( p_gather != NULL )
+        {
+            p_dgram->p_payload = p_gather;
+            p_dgram->pp_last = &p_gather->p_next;
+            p_dgram->i_count = 1;
+        }
+        else
+        {
+            block_ChainRelease( p_dgram->p_payload );
+            p_dgram->p_payload = NULL;
+            p_dgram->pp_last = &p_dgram->p_payload;
+            p_dgram->i_count = 0;
+            p_dgram->self.i_buffer = 0;
+        }
+    }
+
+    p_block->p_next = NULL;
+    *p_dgram->pp_last = p_block;
+    p_dgram->pp_last = &p_block->p_next;
+    p_dgram->i_count++;
+    p_dgram->self.i_buffer += p_block->i_buffer;
+
+    if ( p_block->i_flags & BLOCK_FLAG_CLOCK )
+        p_dgram->self.i_flags |= BLOCK_FLAG_CLOCK;
+}
+
+static void DatagramQueue( sout_access_out_t *p_access, mtime_t now )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    sout_udp_datagram_t *p_dgram = p_sys->p_buffer;
+
+    if( p_dgram->self.i_dts + p_sys->i_caching < now )
+    {
+        msg_Dbg( p_access, "late packet for UDP input (%"PRId64 ")",
+                 now - p_dgram->self.i_dts - p_sys->i_caching );
+    }
+    block_FifoPut( p_sys->p_fifo, &p_dgram->self );
+    p_sys->p_buffer = NULL;
+}
+
 /*****************************************************************************
  * Write: standard write on a file descriptor.
  *****************************************************************************/
@@ -277,8 +395,7 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 
     while( p_buffer )
     {
-        block_t *p_next;
-        int i_packets = 0;
+        block_t *p_next = p_buffer->p_next;
         mtime_t now = mdate();
 
         if( !p_sys->b_mtu_warning && p_buffer->i_buffer > p_sys->i_mtu )
@@ -290,60 +407,74 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 
         /* Check if there is enough space in the buffer */
         if( p_sys->p_buffer &&
-            p_sys->p_buffer->i_buffer + p_buffer->i_buffer > p_sys->i_mtu )
-        {
-            if( p_sys->p_buffer->i_dts + p_sys->i_caching < now )
+            p_sys->p_buffer->self.i_buffer + p_buffer->i_buffer > p_sys->i_mtu )
+            DatagramQueue( p_access, now );
+
+        i_len += p_buffer->i_buffer;
+
+        if( p_buffer->i_buffer <= p_sys->i_mtu )
+        {   /* Fast path: gather the whole block without copying */
+            if( p_buffer->i_buffer == 0 )
+            {
+                block_Release( p_buffer );
+                p_buffer = p_next;
+                continue;
+            }
+
+            if( !p_sys->p_buffer )
             {
-                msg_Dbg( p_access, "late packet for UDP input (%"PRId64 ")",
-                         now - p_sys->p_buffer->i_dts
-                          - p_sys->i_caching );
+                p_sys->p_buffer = DatagramNew( p_buffer->i_dts );
+                if( !p_sys->p_buffer )
+                {
+                    block_ChainRelease( p_buffer );
+                    break;
+                }
             }
-            block_FifoPut( p_sys->p_fifo, p_sys->p_buffer );
-            p_sys->p_buffer = NULL;
+
+            if ( (p_buffer->i_flags & BLOCK_FLAG_CLOCK)
+              && (p_sys->p_buffer->self.i_flags & BLOCK_FLAG_CLOCK) )
+                msg_Warn( p_access, "putting two PCRs at once" );
+
+            DatagramAppend( p_sys->p_buffer, p_buffer );
+            if( p_sys->p_buffer->self.i_buffer == p_sys->i_mtu )
+                DatagramQueue( p_access, now ); /* Flush */
+
+            p_buffer = p_next;
+            continue;
         }
 
-        i_len += p_buffer->i_buffer;
+        /* Slow path: split the block over several datagrams */
         while( p_buffer->i_buffer )
         {
-            size_t i_payload_size = p_sys->i_mtu;
-            size_t i_write = __MIN( p_buffer->i_buffer, i_payload_size );
+            size_t i_write = __MIN( p_buffer->i_buffer, p_sys->i_mtu );
+            block_t *p_part = block_Alloc( i_write );
 
-            i_packets++;
+            if( unlikely(p_part == NULL) )
+                break;
 
             if( !p_sys->p_buffer )
             {
-                p_sys->p_buffer = NewUDPPacket( p_access, p_buffer->i_dts );
-                if( !p_sys->p_buffer ) break;
+                p_sys->p_buffer = DatagramNew( p_buffer->i_dts );
+                if( !p_sys->p_buffer )
+                {
+                    block_Release( p_part );
+                    break;
+                }
             }
 
-            memcpy( p_sys->p_buffer->p_buffer + p_sys->p_buffer->i_buffer,
-                    p_buffer->p_buffer, i_write );
-
-            p_sys->p_buffer->i_buffer += i_write;
+            memcpy( p_part->p_buffer, p_buffer->p_buffer, i_write );
+            p_part->i_flags = p_buffer->i_flags & BLOCK_FLAG_CLOCK;
             p_buffer->p_buffer += i_write;
             p_buffer->i_buffer -= i_write;
-            if ( p_buffer->i_flags & BLOCK_FLAG_CLOCK )
-            {
-                if ( p_sys->p_buffer->i_flags & BLOCK_FLAG_CLOCK )
-                    msg_Warn( p_access, "putting two PCRs at once" );
-                p_sys->p_buffer->i_flags |= BLOCK_FLAG_CLOCK;
-            }
 
-            if( p_sys->p_buffer->i_buffer == p_sys->i_mtu || i_packets > 1 )
-            {
-                /* Flush */
-                if( p_sys->p_buffer->i_dts + p_sys->i_caching < now )
-                {
-                    msg_Dbg( p_access, "late packet for udp input (%"PRId64 ")",
-                             mdate() - p_sys->p_buffer->i_dts
-                              - p_sys->i_caching );
-                }
-                block_FifoPut( p_sys->p_fifo, p_sys->p_buffer );
-                p_sys->p_buffer = NULL;
-            }
+            if ( (p_part->i_flags & BLOCK_FLAG_CLOCK)
+              && (p_sys->p_buffer->self.i_flags & BLOCK_FLAG_CLOCK) )
+                msg_Warn( p_access, "putting two PCRs at once" );
+
+            DatagramAppend( p_sys->p_buffer, p_part );
+            DatagramQueue( p_access, mdate() ); /* Flush */
         }
 
-        p_next = p_buffer->p_next;
         block_Release( p_buffer );
         p_buffer = p_next;
     }
@@ -362,34 +493,93 @@ static int Seek( sout_access_out_t *p_access, off_t i_pos )
 }
 
 /*****************************************************************************
- * NewUDPPacket: allocate a new UDP packet of size p_sys->i_mtu
+ * SendDatagrams: send a batch of datagrams with as few system calls as possible
  *****************************************************************************/
-static block_t *NewUDPPacket( sout_access_out_t *p_access, mtime_t i_dts)
+static void SendDatagrams( sout_access_out_t *p_access, block_t **pp_pk,
+                           unsigned i_count )
 {
     sout_access_out_sys_t *p_sys = p_access->p_sys;
-    block_t *p_buffer;
-
-    while ( block_FifoCount( p_sys->p_empty_blocks ) > MAX_EMPTY_BLOCKS )
+    struct iovec iov[UDP_BATCH_MAX][UDP_IOV_MAX];
+#ifdef SO_TXTIME
+    union
     {
-        p_buffer = block_FifoGet( p_sys->p_empty_blocks );
-        block_Release( p_buffer );
-    }
+        char buf[CMSG_SPACE(sizeof (uint64_t))];
+        struct cmsghdr align;
+    } control[UDP_BATCH_MAX];
+    const mtime_t now = mdate();
+#endif
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+#else
+    struct msghdr msgs[UDP_BATCH_MAX];
+#endif
 
-    if( block_FifoCount( p_sys->p_empty_blocks ) == 0 )
+    assert( i_count <= UDP_BATCH_MAX );
+
+    for( unsigned i = 0; i < i_count; i++ )
     {
-        p_buffer = block_Alloc( p_sys->i_mtu );
+        sout_udp_datagram_t *p_dgram = (sout_udp_datagram_t *)pp_pk[i];
+        unsigned j = 0;
+
+        for( block_t *p = p_dgram->p_payload; p != NULL; p = p->p_next )
+        {
+            iov[i][j].iov_base = p->p_buffer;
+            iov[i][j].iov_len = p->i_buffer;
+            j++;
+        }
+
+#ifdef HAVE_SENDMMSG
+        struct msghdr *hdr = &msgs[i].msg_hdr;
+#else
+        struct msghdr *hdr = &msgs[i];
+#endif
+        memset( hdr, 0, sizeof( *hdr ) );
+        hdr->msg_iov = iov[i];
+        hdr->msg_iovlen = j;
+
+#ifdef SO_TXTIME
+        if( p_sys->b_txtime )
+        {   /* Departure time in nanoseconds */
+            mtime_t i_date = __MAX( p_sys->i_caching + p_dgram->self.i_dts,
+                                    now );
+            uint64_t txtime = (uint64_t)i_date * (1000000000 / CLOCK_FREQ);
+
+            hdr->msg_control = control[i].buf;
+            hdr->msg_controllen = sizeof( control[i].buf );
+
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR( hdr );
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_TXTIME;
+            cmsg->cmsg_len = CMSG_LEN( sizeof( txtime ) );
+            memcpy( CMSG_DATA( cmsg ), &txtime, sizeof( txtime ) );
+        }
+#endif
     }
-    else
+
+    for( unsigned i = 0; i < i_count; )
     {
-        p_buffer = block_FifoGet(p_sys->p_empty_blocks );
-        p_buffer->i_flags = 0;
-        p_buffer = block_Realloc( p_buffer, 0, p_sys->i_mtu );
+#ifdef HAVE_SENDMMSG
+        int val = sendmmsg( p_sys->i_handle, msgs + i, i_count - i, 0 );
+#else
+        int val = sendmsg( p_sys->i_handle, msgs + i, 0 ) >= 0 ? 1 : -1;
+#endif
+        if( val <= 0 )
+        {
+            if( errno == EINTR )
+                continue;
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+            val = 1; /* Skip the failed datagram */
+        }
+        i += val;
     }
+}
 
-    p_buffer->i_dts = i_dts;
-    p_buffer->i_buffer = 0;
+static void ReleaseDatagrams( void *data )
+{
+    block_t **pp_pk = data;
 
-    return p_buffer;
+    for( unsigned i = 0; i < UDP_BATCH_MAX && pp_pk[i] != NULL; i++ )
+        block_Release( pp_pk[i] );
 }
 
 /*****************************************************************************
@@ -407,42 +597,73 @@ static void* ThreadWrite( void *data )
 
     for (;;)
     {
-        block_t *p_pk = block_FifoGet( p_sys->p_fifo );
-        mtime_t       i_date, i_sent;
+        block_t *pp_pk[UDP_BATCH_MAX] = { NULL };
+        unsigned i_count = 0;
+        bool b_wait = false;
+        mtime_t i_date = 0, i_first = 0, i_sent;
+
+        vlc_cleanup_push( ReleaseDatagrams, pp_pk );
 
-        i_date = p_sys->i_caching + p_pk->i_dts;
-        if( i_date_last > 0 )
+        /* Gather the datagrams that can be sent together: those already
+         * queued, up to the end of the current group or the next PCR. */
+        do
         {
-            if( i_date - i_date_last > 2000000 )
+            block_t *p_pk = block_FifoGet( p_sys->p_fifo );
+
+            i_date = p_sys->i_caching + p_pk->i_dts;
+            if( i_date_last > 0 )
             {
-                if( !i_dropped_packets )
-                    msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
-                             i_date - i_date_last );
+                if( i_date - i_date_last > 2000000 )
+                {
+                    if( !i_dropped_packets )
+                        msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
+                                 i_date - i_date_last );
+
+                    block_Release( p_pk );
 
-                block_FifoPut( p_sys->p_empty_blocks, p_pk );
+                    i_date_last = i_date;
+                    i_dropped_packets++;
+                    continue;
+                }
+                else if( i_date - i_date_last < -1000 )
+                {
+                    if( !i_dropped_packets )
+                        msg_Dbg( p_access, "mmh, packets in the past (%"PRId64")",
+                                 i_date_last - i_date );
+                }
+            }
 
-                i_date_last = i_date;
-                i_dropped_packets++;
+            if( i_count == 0 )
+                i_first = i_date;
+            pp_pk[i_count++] = p_pk;
+            i_date_last = i_date;
+
+            if( p_sys->b_txtime )
+            {   /* The kernel paces datagrams: batch those due soon */
+                b_wait = block_FifoCount( p_sys->p_fifo ) == 0
+                      || p_sys->i_caching
+                         + block_FifoShow( p_sys->p_fifo )->i_dts
+                         > i_first + UDP_TXTIME_LOOKAHEAD;
                 continue;
             }
-            else if( i_date - i_date_last < -1000 )
+
+            i_to_send--;
+            if( !i_to_send || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
             {
-                if( !i_dropped_packets )
-                    msg_Dbg( p_access, "mmh, packets in the past (%"PRId64")",
-                             i_date_last - i_date );
+                b_wait = true;
+                i_to_send = i_group;
             }
         }
+        while( i_count == 0 || (!b_wait && i_count < UDP_BATCH_MAX
+                             && block_FifoCount( p_sys->p_fifo ) > 0) );
 
-        block_cleanup_push( p_pk );
-        i_to_send--;
-        if( !i_to_send || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
-        {
+        if( p_sys->b_txtime )
+            mwait( i_first - UDP_TXTIME_LOOKAHEAD );
+        else if( b_wait )
             mwait( i_date );
-            i_to_send = i_group;
-        }
-        if ( send( p_sys->i_handle, p_pk->p_buffer, p_pk->i_buffer, 0 ) == -1 )
-            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+        SendDatagrams( p_access, pp_pk, i_count );
         vlc_cleanup_pop();
+        ReleaseDatagrams( pp_pk );
 
         if( i_dropped_packets )
         {
@@ -458,10 +679,6 @@ static void* ThreadWrite( void *data )
                      i_sent - i_date );
         }
 #endif
-
-        block_FifoPut( p_sys->p_empty_blocks, p_pk );
-
-        i_date_last = i_date;
     }
     return NULL;
 }
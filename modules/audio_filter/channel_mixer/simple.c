@@ -33,22 +33,52 @@
 #include <vlc_aout.h>
 #include <vlc_filter.h>
 #include <vlc_block.h>
+#include <vlc_cpu.h>
+
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+# include <emmintrin.h>
+# define MIX_HAVE_SSE2
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+# define MIX_HAVE_AVX2
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define MIX_HAVE_NEON
+#endif
 
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
 static int  OpenFilter( vlc_object_t * );
+static void CloseFilter( vlc_object_t * );
 
 vlc_module_begin ()
     set_description( N_("Audio filter for simple channel mixing") )
     set_category( CAT_AUDIO )
     set_subcategory( SUBCAT_AUDIO_MISC )
     set_capability( "audio converter", 10 )
-    set_callbacks( OpenFilter, NULL );
+    set_callbacks( OpenFilter, CloseFilter );
 vlc_module_end ()
 
 static block_t *Filter( filter_t *, block_t * );
 
+/* Number of output coefficients per input channel in the mixing matrix */
+#define MIX_LANES 8
+
+typedef void (*do_work_t)( filter_t *, block_t *, block_t * );
+
+struct filter_sys_t
+{
+    do_work_t pf_do_work;
+    void (*pf_mix)( const filter_sys_t *, const float *, float *, unsigned );
+    unsigned i_in;
+    unsigned i_out;
+    /* Output coefficients of each input channel */
+    float matrix[AOUT_CHAN_MAX][MIX_LANES];
+};
+
 static void DoWork_7_x_to_2_0( filter_t * p_filter,  block_t * p_in_buf, block_t * p_out_buf ) {
     float *p_dest = (float *)p_out_buf->p_buffer;
     const float *p_src = (const float *)p_in_buf->p_buffer;
@@ -258,12 +288,166 @@ static void DoWork_6_1_to_5_x( filter_t * p_filter,  block_t * p_in_buf, block_t
     }
 }
 
+/*****************************************************************************
+ * Matrix mixing:
+ *****************************************************************************
+ * All the conversions above are linear, so they are equivalent to a matrix.
+ * The SIMD kernels accumulate each input sample times the column of output
+ * coefficients of its channel, and store all the lanes: the extra lanes are
+ * overwritten by the next frame, and Filter() pads the output buffer.
+ *****************************************************************************/
+static void MatrixInit( filter_t *p_filter, filter_sys_t *p_sys,
+                        do_work_t c_work )
+{
+    float in[AOUT_CHAN_MAX], out[AOUT_CHAN_MAX];
+    block_t in_buf, out_buf;
+
+    /* Retrieve the coefficients from the C code, so that both agree */
+    memset( p_sys->matrix, 0, sizeof (p_sys->matrix) );
+    for( unsigned i = 0; i < p_sys->i_in; i++ )
+    {
+        memset( in, 0, sizeof (in) );
+        in[i] = 1.f;
+        block_Init( &in_buf, in, sizeof (in) );
+        block_Init( &out_buf, out, sizeof (out) );
+        in_buf.i_nb_samples = 1;
+        c_work( p_filter, &in_buf, &out_buf );
+
+        for( unsigned o = 0; o < p_sys->i_out; o++ )
+            p_sys->matrix[i][o] = out[o];
+    }
+}
+
+#ifdef MIX_HAVE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static void MixSSE2( const filter_sys_t *p_sys, const float *p_src,
+                     float *p_dest, unsigned i_nb_samples )
+{
+    const unsigned i_in = p_sys->i_in, i_out = p_sys->i_out;
+
+    if( i_out <= 4 )
+    {
+        while( i_nb_samples-- )
+        {
+            __m128 acc = _mm_setzero_ps();
+
+            for( unsigned i = 0; i < i_in; i++ )
+                acc = _mm_add_ps( acc,
+                                  _mm_mul_ps( _mm_set1_ps( p_src[i] ),
+                                              _mm_loadu_ps( p_sys->matrix[i] ) ) );
+            _mm_storeu_ps( p_dest, acc );
+            p_src += i_in;
+            p_dest += i_out;
+        }
+        return;
+    }
+
+    while( i_nb_samples-- )
+    {
+        __m128 lo = _mm_setzero_ps(), hi = _mm_setzero_ps();
+
+        for( unsigned i = 0; i < i_in; i++ )
+        {
+            __m128 x = _mm_set1_ps( p_src[i] );
+
+            lo = _mm_add_ps( lo, _mm_mul_ps( x,
+                                     _mm_loadu_ps( p_sys->matrix[i] ) ) );
+            hi = _mm_add_ps( hi, _mm_mul_ps( x,
+                                     _mm_loadu_ps( p_sys->matrix[i] + 4 ) ) );
+        }
+        _mm_storeu_ps( p_dest, lo );
+        _mm_storeu_ps( p_dest + 4, hi );
+        p_src += i_in;
+        p_dest += i_out;
+    }
+}
+#endif
+
+#ifdef MIX_HAVE_AVX2
+VLC_AVX2
+static void MixAVX2( const filter_sys_t *p_sys, const float *p_src,
+                     float *p_dest, unsigned i_nb_samples )
+{
+    const unsigned i_in = p_sys->i_in, i_out = p_sys->i_out;
+
+    while( i_nb_samples-- )
+    {
+        __m256 acc = _mm256_setzero_ps();
+
+        for( unsigned i = 0; i < i_in; i++ )
+            acc = _mm256_add_ps( acc,
+                        _mm256_mul_ps( _mm256_broadcast_ss( &p_src[i] ),
+                                       _mm256_loadu_ps( p_sys->matrix[i] ) ) );
+        _mm256_storeu_ps( p_dest, acc );
+        p_src += i_in;
+        p_dest += i_out;
+    }
+}
+#endif
+
+#ifdef MIX_HAVE_NEON
+static void MixNEON( const filter_sys_t *p_sys, const float *p_src,
+                     float *p_dest, unsigned i_nb_samples )
+{
+    const unsigned i_in = p_sys->i_in, i_out = p_sys->i_out;
+
+    while( i_nb_samples-- )
+    {
+        float32x4_t lo = vdupq_n_f32( 0.f ), hi = vdupq_n_f32( 0.f );
+
+        for( unsigned i = 0; i < i_in; i++ )
+        {
+            lo = vmlaq_n_f32( lo, vld1q_f32( p_sys->matrix[i] ), p_src[i] );
+            hi = vmlaq_n_f32( hi, vld1q_f32( p_sys->matrix[i] + 4 ),
+                              p_src[i] );
+        }
+        vst1q_f32( p_dest, lo );
+        if( i_out > 4 )
+            vst1q_f32( p_dest + 4, hi );
+        p_src += i_in;
+        p_dest += i_out;
+    }
+}
+#endif
+
+static void DoWork_matrix( filter_t *p_filter, block_t *p_in_buf,
+                           block_t *p_out_buf )
+{
+    const filter_sys_t *p_sys = p_filter->p_sys;
+
+    p_sys->pf_mix( p_sys, (const float *)p_in_buf->p_buffer,
+                   (float *)p_out_buf->p_buffer, p_in_buf->i_nb_samples );
+}
+
+static void DoWork_2_x_to_5_x( filter_t * p_filter,  block_t * p_in_buf, block_t * p_out_buf ) {
+    const bool b_lfe_in = p_filter->fmt_in.audio.i_physical_channels & AOUT_CHAN_LFE;
+    const bool b_lfe_out = p_filter->fmt_out.audio.i_physical_channels & AOUT_CHAN_LFE;
+    float *p_dest = (float *)p_out_buf->p_buffer;
+    const float *p_src = (const float *)p_in_buf->p_buffer;
+    for( int i = p_in_buf->i_nb_samples; i--; )
+    {
+        *p_dest++ = p_src[0];
+        *p_dest++ = p_src[1];
+        *p_dest++ = 0.f;
+        *p_dest++ = 0.f;
+        *p_dest++ = 0.f;
+
+        p_src += 2;
+
+        if( b_lfe_out )
+            *p_dest++ = b_lfe_in ? *p_src : 0.f;
+        if( b_lfe_in ) p_src++;
+    }
+}
+
 #if defined (CAN_COMPILE_ARM)
 #include "simple_neon.h"
 #define GET_WORK(in, out) GET_WORK_##in##_to_##out##_neon()
 #else
 #define GET_WORK(in, out) DoWork_##in##_to_##out
 #endif
+#define SET_WORK(in, out) \
+    (c_work = DoWork_##in##_to_##out, do_work = GET_WORK(in, out))
 
 /*****************************************************************************
  * OpenFilter:
@@ -271,7 +455,7 @@ static void DoWork_6_1_to_5_x( filter_t * p_filter,  block_t * p_in_buf, block_t
 static int OpenFilter( vlc_object_t *p_this )
 {
     filter_t *p_filter = (filter_t *)p_this;
-    void (*do_work)(filter_t *, block_t *, block_t *) = NULL;
+    do_work_t do_work = NULL, c_work = NULL;
 
     if( p_filter->fmt_in.audio.i_format != VLC_CODEC_FL32 ||
         p_filter->fmt_in.audio.i_format != p_filter->fmt_out.audio.i_format ||
@@ -297,6 +481,10 @@ static int OpenFilter( vlc_object_t *p_this )
     const bool b_input_5_x = input == AOUT_CHANS_5_0
                           || input == AOUT_CHANS_5_0_MIDDLE;
     const bool b_input_3_x = input == AOUT_CHANS_3_0;
+    /* Leave reversed stereo and dual mono to the trivial mixer */
+    const bool b_input_2_x = input == AOUT_CHANS_2_0
+        && !(p_filter->fmt_in.audio.i_original_channels
+             & (AOUT_CHAN_REVERSESTEREO | AOUT_CHAN_DUALMONO));
 
     /*
      * TODO: We don't support any 8.1 input
@@ -306,59 +494,99 @@ static int OpenFilter( vlc_object_t *p_this )
     if( output == AOUT_CHAN_CENTER )
     {
         if( b_input_7_x )
-            do_work = GET_WORK(7_x,1_0);
+            SET_WORK(7_x,1_0);
         else if( b_input_5_x )
-            do_work = GET_WORK(5_x,1_0);
+            SET_WORK(5_x,1_0);
         else if( b_input_4_center_rear )
-            do_work = GET_WORK(4_0,1_0);
+            SET_WORK(4_0,1_0);
         else if( b_input_3_x )
-            do_work = GET_WORK(3_x,1_0);
+            SET_WORK(3_x,1_0);
         else
-            do_work = GET_WORK(2_x,1_0);
+            SET_WORK(2_x,1_0);
     }
     else if( output == AOUT_CHANS_2_0 )
     {
         if( b_input_7_x )
-            do_work = GET_WORK(7_x,2_0);
+            SET_WORK(7_x,2_0);
         else if( b_input_6_1 )
-            do_work = GET_WORK(6_1,2_0);
+            SET_WORK(6_1,2_0);
         else if( b_input_5_x )
-            do_work = GET_WORK(5_x,2_0);
+            SET_WORK(5_x,2_0);
         else if( b_input_4_center_rear )
-            do_work = GET_WORK(4_0,2_0);
+            SET_WORK(4_0,2_0);
         else if( b_input_3_x )
-            do_work = GET_WORK(3_x,2_0);
+            SET_WORK(3_x,2_0);
     }
     else if( output == AOUT_CHANS_4_0 )
     {
         if( b_input_7_x )
-            do_work = GET_WORK(7_x,4_0);
+            SET_WORK(7_x,4_0);
         else if( b_input_5_x )
-            do_work = GET_WORK(5_x,4_0);
+            SET_WORK(5_x,4_0);
     }
     else if( (output & ~AOUT_CHAN_LFE) == AOUT_CHANS_5_0 ||
              (output & ~AOUT_CHAN_LFE) == AOUT_CHANS_5_0_MIDDLE )
     {
         if( b_input_7_x )
-            do_work = GET_WORK(7_x,5_x);
+            SET_WORK(7_x,5_x);
         else if( b_input_6_1 )
-            do_work = GET_WORK(6_1,5_x);
+            SET_WORK(6_1,5_x);
+        else if( b_input_2_x )
+            SET_WORK(2_x,5_x);
     }
 
     if( do_work == NULL )
         return VLC_EGENERIC;
 
+    filter_sys_t *p_sys = malloc( sizeof (*p_sys) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+
+    p_sys->pf_do_work = do_work;
+    p_sys->pf_mix = NULL;
+    p_sys->i_in = aout_FormatNbChannels( &p_filter->fmt_in.audio );
+    p_sys->i_out = aout_FormatNbChannels( &p_filter->fmt_out.audio );
+    p_filter->p_sys = p_sys;
+
+    if( p_sys->i_in <= AOUT_CHAN_MAX && p_sys->i_out <= MIX_LANES )
+    {
+#ifdef MIX_HAVE_AVX2
+        if( p_sys->i_out > 4 && vlc_CPU_AVX2() )
+            p_sys->pf_mix = MixAVX2;
+#endif
+#ifdef MIX_HAVE_SSE2
+        if( p_sys->pf_mix == NULL && vlc_CPU_SSE2() )
+            p_sys->pf_mix = MixSSE2;
+#endif
+#ifdef MIX_HAVE_NEON
+        if( p_sys->pf_mix == NULL && vlc_CPU_ARM64_NEON() )
+            p_sys->pf_mix = MixNEON;
+#endif
+    }
+
+    if( p_sys->pf_mix != NULL )
+    {
+        MatrixInit( p_filter, p_sys, c_work );
+        p_sys->pf_do_work = DoWork_matrix;
+    }
+
     p_filter->pf_audio_filter = Filter;
-    p_filter->p_sys = (void *)do_work;
     return VLC_SUCCESS;
 }
 
+static void CloseFilter( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t *)p_this;
+
+    free( p_filter->p_sys );
+}
+
 /*****************************************************************************
  * Filter:
  *****************************************************************************/
 static block_t *Filter( filter_t *p_filter, block_t *p_block )
 {
-    void (*work)(filter_t *, block_t *, block_t *) = (void *)p_filter->p_sys;
+    do_work_t work = p_filter->p_sys->pf_do_work;
 
     if( !p_block || !p_block->i_nb_samples )
     {
@@ -371,7 +599,8 @@ static block_t *Filter( filter_t *p_filter, block_t *p_block )
       p_filter->fmt_out.audio.i_bitspersample *
         p_filter->fmt_out.audio.i_channels / 8;
 
-    block_t *p_out = block_Alloc( i_out_size );
+    /* The matrix kernels store MIX_LANES samples past the last frame */
+    block_t *p_out = block_Alloc( i_out_size + MIX_LANES * sizeof (float) );
     if( !p_out )
     {
         msg_Warn( p_filter, "can't get output buffer" );
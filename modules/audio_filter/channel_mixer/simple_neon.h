@@ -70,3 +70,4 @@ C_WRAPPER(2_x,1_0)
 C_WRAPPER(6_1,2_0)
 C_WRAPPER(7_x,5_x)
 C_WRAPPER(6_1,5_x)
+C_WRAPPER(2_x,5_x)
@@ -39,6 +39,20 @@
 #include <vlc_aout.h>
 #include <vlc_block.h>
 #include <vlc_filter.h>
+#include <vlc_cpu.h>
+
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+# include <emmintrin.h>
+# define FORMAT_HAVE_SSE2
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+# define FORMAT_HAVE_AVX2
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define FORMAT_HAVE_NEON
+#endif
 
 /*****************************************************************************
  * Module descriptor
@@ -82,74 +96,81 @@ static int Open(vlc_object_t *object)
     return VLC_SUCCESS;
 }
 
+/**
+ * Enlarges a block for a conversion to factor times larger samples.
+ * The buffer is reused in place if it has enough room, which is the common
+ * case for pooled blocks, and reallocated otherwise. Either way, the source
+ * samples remain at the start of the buffer, so the conversion must proceed
+ * backward, from the last sample.
+ */
+static block_t *Widen(block_t *b, size_t factor)
+{
+    return block_Realloc(b, 0, b->i_buffer * factor);
+}
 
 /*** from U8 ***/
-static block_t *U8toS16(filter_t *filter, block_t *bsrc)
+static block_t *U8toS16(filter_t *filter, block_t *b)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
-    if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
-    int16_t *dst = (int16_t *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((*src++) << 8) - 0x8000;
-out:
-    block_Release(bsrc);
+    size_t n = b->i_buffer;
+
+    b = Widen(b, 2);
+    if (unlikely(b == NULL))
+        return NULL;
+
+    uint8_t *src = (uint8_t *)b->p_buffer + n;
+    int16_t *dst = (int16_t *)b->p_buffer + n;
+    while (n--)
+        *--dst = ((*--src) << 8) - 0x8000;
     VLC_UNUSED(filter);
-    return bdst;
+    return b;
 }
 
-static block_t *U8toFl32(filter_t *filter, block_t *bsrc)
+static block_t *U8toFl32(filter_t *filter, block_t *b)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
-    if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
-    float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((float)((*src++) - 128)) / 128.f;
-out:
-    block_Release(bsrc);
+    size_t n = b->i_buffer;
+
+    b = Widen(b, 4);
+    if (unlikely(b == NULL))
+        return NULL;
+
+    uint8_t *src = (uint8_t *)b->p_buffer + n;
+    float   *dst = (float *)b->p_buffer + n;
+    while (n--)
+        *--dst = ((float)((*--src) - 128)) / 128.f;
     VLC_UNUSED(filter);
-    return bdst;
+    return b;
 }
 
-static block_t *U8toS32(filter_t *filter, block_t *bsrc)
+static block_t *U8toS32(filter_t *filter, block_t *b)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
-    if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
-    int32_t *dst = (int32_t *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((*src++) << 24) - 0x80000000;
-out:
-    block_Release(bsrc);
+    size_t n = b->i_buffer;
+
+    b = Widen(b, 4);
+    if (unlikely(b == NULL))
+        return NULL;
+
+    uint8_t *src = (uint8_t *)b->p_buffer + n;
+    int32_t *dst = (int32_t *)b->p_buffer + n;
+    while (n--)
+        *--dst = ((*--src) << 24) - 0x80000000;
     VLC_UNUSED(filter);
-    return bdst;
+    return b;
 }
 
-static block_t *U8toFl64(filter_t *filter, block_t *bsrc)
+static block_t *U8toFl64(filter_t *filter, block_t *b)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 8);
-    if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
-    double  *dst = (double *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((double)((*src++) - 128)) / 128.;
-out:
-    block_Release(bsrc);
+    size_t n = b->i_buffer;
+
+    b = Widen(b, 8);
+    if (unlikely(b == NULL))
+        return NULL;
+
+    uint8_t *src = (uint8_t *)b->p_buffer + n;
+    double  *dst = (double *)b->p_buffer + n;
+    while (n--)
+        *--dst = ((double)((*--src) - 128)) / 128.;
     VLC_UNUSED(filter);
-    return bdst;
+    return b;
 }
 
 
@@ -166,66 +187,63 @@ static block_t *S16toU8(filter_t *filter, block_t *b)
     return b;
 }
 
-static block_t *S16toFl32(filter_t *filter, block_t *bsrc)
+static block_t *S16toFl32(filter_t *filter, block_t *b)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
-    if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 2; i--;)
+    size_t n = b->i_buffer / 2;
+
+    b = Widen(b, 2);
+    if (unlikely(b == NULL))
+        return NULL;
+
+    int16_t *src = (int16_t *)b->p_buffer + n;
+    float   *dst = (float *)b->p_buffer + n;
+    while (n--)
 #if 0
         /* Slow version */
-        *dst++ = (float)*src++ / 32768.f;
+        *--dst = (float)*--src / 32768.f;
 #else
     {   /* This is Walken's trick based on IEEE float format. On my PIII
          * this takes 16 seconds to perform one billion conversions, instead
          * of 19 seconds for the above division. */
         union { float f; int32_t i; } u;
-        u.i = *src++ + 0x43c00000;
-        *dst++ = u.f - 384.f;
+        u.i = *--src + 0x43c00000;
+        *--dst = u.f - 384.f;
     }
 #endif
-out:
-    block_Release(bsrc);
     VLC_UNUSED(filter);
-    return bdst;
+    return b;
 }
 
-static block_t *S16toS32(filter_t *filter, block_t *bsrc)
+static block_t *S16toS32(filter_t *filter, block_t *b)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
-    if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    int32_t *dst = (int32_t *)bdst->p_buffer;
-    for (int i = bsrc->i_buffer / 2; i--;)
-        *dst++ = *src++ << 16;
-out:
-    block_Release(bsrc);
+    size_t n = b->i_buffer / 2;
+
+    b = Widen(b, 2);
+    if (unlikely(b == NULL))
+        return NULL;
+
+    int16_t *src = (int16_t *)b->p_buffer + n;
+    int32_t *dst = (int32_t *)b->p_buffer + n;
+    while (n--)
+        *--dst = *--src << 16;
     VLC_UNUSED(filter);
-    return bdst;
+    return b;
 }
 
-static block_t *S16toFl64(filter_t *filter, block_t *bsrc)
+static block_t *S16toFl64(filter_t *filter, block_t *b)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
-    if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 2; i--;)
-        *dst++ = (double)*src++ / 32768.;
-out:
-    block_Release(bsrc);
+    size_t n = b->i_buffer / 2;
+
+    b = Widen(b, 4);
+    if (unlikely(b == NULL))
+        return NULL;
+
+    int16_t *src = (int16_t *)b->p_buffer + n;
+    double  *dst = (double *)b->p_buffer + n;
+    while (n--)
+        *--dst = (double)*--src / 32768.;
     VLC_UNUSED(filter);
-    return bdst;
+    return b;
 }
 
 
@@ -250,12 +268,103 @@ static block_t *Fl32toU8(filter_t *filter, block_t *b)
     return b;
 }
 
+/* The vector versions of Fl32toS16() clip in floating point, then round to
+ * nearest even like the IEEE addition of Walken's trick does, so that they
+ * give the same results. They return the number of samples converted, in
+ * place and from the start of the buffer. */
+#ifdef FORMAT_HAVE_AVX2
+VLC_AVX2
+static size_t Fl32toS16AVX2(void *buf, size_t n)
+{
+    const float *src = buf;
+    int16_t *dst = buf;
+    const __m256 scale = _mm256_set1_ps(32768.f);
+    const __m256 min = _mm256_set1_ps(-32768.f);
+    const __m256 max = _mm256_set1_ps(32767.f);
+    size_t done = 0;
+
+    for (; done + 16 <= n; done += 16) {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src + done), scale);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(src + done + 8), scale);
+        a = _mm256_min_ps(_mm256_max_ps(a, min), max);
+        b = _mm256_min_ps(_mm256_max_ps(b, min), max);
+
+        __m256i v = _mm256_packs_epi32(_mm256_cvtps_epi32(a),
+                                       _mm256_cvtps_epi32(b));
+        /* Undo the per-lane interleaving of the pack */
+        v = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *)(dst + done), v);
+    }
+    return done;
+}
+#endif
+
+#ifdef FORMAT_HAVE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static size_t Fl32toS16SSE2(void *buf, size_t n)
+{
+    const float *src = buf;
+    int16_t *dst = buf;
+    const __m128 scale = _mm_set1_ps(32768.f);
+    const __m128 min = _mm_set1_ps(-32768.f);
+    const __m128 max = _mm_set1_ps(32767.f);
+    size_t done = 0;
+
+    for (; done + 8 <= n; done += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src + done), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + done + 4), scale);
+        a = _mm_min_ps(_mm_max_ps(a, min), max);
+        b = _mm_min_ps(_mm_max_ps(b, min), max);
+
+        _mm_storeu_si128((__m128i *)(dst + done),
+                         _mm_packs_epi32(_mm_cvtps_epi32(a),
+                                         _mm_cvtps_epi32(b)));
+    }
+    return done;
+}
+#endif
+
+#ifdef FORMAT_HAVE_NEON
+static size_t Fl32toS16NEON(void *buf, size_t n)
+{
+    const float *src = buf;
+    int16_t *dst = buf;
+    const float32x4_t min = vdupq_n_f32(-32768.f);
+    const float32x4_t max = vdupq_n_f32(32767.f);
+    size_t done = 0;
+
+    for (; done + 8 <= n; done += 8) {
+        float32x4_t a = vmulq_n_f32(vld1q_f32(src + done), 32768.f);
+        float32x4_t b = vmulq_n_f32(vld1q_f32(src + done + 4), 32768.f);
+        a = vminq_f32(vmaxq_f32(a, min), max);
+        b = vminq_f32(vmaxq_f32(b, min), max);
+
+        vst1q_s16(dst + done, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)),
+                                           vqmovn_s32(vcvtnq_s32_f32(b))));
+    }
+    return done;
+}
+#endif
+
 static block_t *Fl32toS16(filter_t *filter, block_t *b)
 {
     VLC_UNUSED(filter);
-    float   *src = (float *)b->p_buffer;
-    int16_t *dst = (int16_t *)src;
-    for (int i = b->i_buffer / 4; i--;) {
+    size_t done = 0;
+#ifdef FORMAT_HAVE_AVX2
+    if (vlc_CPU_AVX2())
+        done = Fl32toS16AVX2(b->p_buffer, b->i_buffer / 4);
+#endif
+#ifdef FORMAT_HAVE_SSE2
+    if (done == 0 && vlc_CPU_SSE2())
+        done = Fl32toS16SSE2(b->p_buffer, b->i_buffer / 4);
+#endif
+#ifdef FORMAT_HAVE_NEON
+    if (vlc_CPU_ARM64_NEON())
+        done = Fl32toS16NEON(b->p_buffer, b->i_buffer / 4);
+#endif
+    float   *src = (float *)b->p_buffer + done;
+    int16_t *dst = (int16_t *)b->p_buffer + done;
+    for (int i = b->i_buffer / 4 - done; i--;) {
 #if 0
         /* Slow version. */
         if (*src >= 1.0) *dst = 32767;
@@ -297,21 +406,20 @@ static block_t *Fl32toS32(filter_t *filter, block_t *b)
     return b;
 }
 
-static block_t *Fl32toFl64(filter_t *filter, block_t *bsrc)
+static block_t *Fl32toFl64(filter_t *filter, block_t *b)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
-    if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    float  *src = (float *)bsrc->p_buffer;
-    double *dst = (double *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 4; i--;)
-        *(dst++) = *(src++);
-out:
-    block_Release(bsrc);
+    size_t n = b->i_buffer / 4;
+
+    b = Widen(b, 2);
+    if (unlikely(b == NULL))
+        return NULL;
+
+    float   *src = (float *)b->p_buffer + n;
+    double  *dst = (double *)b->p_buffer + n;
+    while (n--)
+        *--dst = *--src;
     VLC_UNUSED(filter);
-    return bdst;
+    return b;
 }
 
 
@@ -350,21 +458,20 @@ static block_t *S32toFl32(filter_t *filter, block_t *b)
     return b;
 }
 
-static block_t *S32toFl64(filter_t *filter, block_t *bsrc)
+static block_t *S32toFl64(filter_t *filter, block_t *b)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
-    if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    int32_t *src = (int32_t*)bsrc->p_buffer;
-    double  *dst = (double *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 4; i--;)
-        *dst++ = (double)(*src++) / 2147483648.;
-out:
+    size_t n = b->i_buffer / 4;
+
+    b = Widen(b, 2);
+    if (unlikely(b == NULL))
+        return NULL;
+
+    int32_t *src = (int32_t *)b->p_buffer + n;
+    double  *dst = (double *)b->p_buffer + n;
+    while (n--)
+        *--dst = (double)(*--src) / 2147483648.;
     VLC_UNUSED(filter);
-    block_Release(bsrc);
-    return bdst;
+    return b;
 }
 
 
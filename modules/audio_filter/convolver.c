@@ -0,0 +1,650 @@
+/*****************************************************************************
+ * convolver.c : impulse response convolution (room correction, HRTF...)
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *
+ * The impulse response is split into partitions of BLOCK_SIZE frames, and
+ * the input is convolved with all of them in the frequency domain by
+ * uniformly partitioned overlap-save: each block of input is transformed
+ * once, kept in a frequency-domain delay line, and multiplied with every
+ * partition spectrum. The cost hence grows with the logarithm of the block
+ * size and only linearly with the length of the response, for a fixed
+ * latency of BLOCK_SIZE frames.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_aout.h>
+#include <vlc_block.h>
+#include <vlc_cpu.h>
+#include <vlc_filter.h>
+#include <vlc_fs.h>
+
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+# define CONV_HAVE_AVX2
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CONV_HAVE_NEON
+#endif
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+
+#define HELP_TEXT N_("Convolves the audio with an impulse response, such as " \
+    "a room correction filter or a head-related transfer function. " \
+    "This adds a fixed latency of 256 samples.")
+#define FILE_TEXT N_("Impulse response file")
+#define FILE_LONGTEXT N_("WAV file containing the impulse response. " \
+    "It may contain one channel, applied to all channels, one channel per " \
+    "audio channel, or one channel per pair of output and input channels " \
+    "(e.g. LL, LR, RL, RR for stereo).")
+
+vlc_module_begin ()
+    set_shortname( N_("Convolver") )
+    set_description( N_("Impulse response convolution") )
+    set_help( HELP_TEXT )
+    set_category( CAT_AUDIO )
+    set_subcategory( SUBCAT_AUDIO_AFILTER )
+    set_capability( "audio filter", 0 )
+    set_callbacks( Open, Close )
+
+    add_loadfile( "convolver-file", NULL, FILE_TEXT, FILE_LONGTEXT, false )
+vlc_module_end ()
+
+/*****************************************************************************
+ * Local definitions
+ *****************************************************************************/
+#define BLOCK_SIZE 256 /* partition size and latency, in frames */
+#define FFT_SIZE   (2 * BLOCK_SIZE) /* real transform size */
+#define CFFT_SIZE  BLOCK_SIZE /* complex transform size */
+#define BINS       (BLOCK_SIZE + 1) /* non-redundant real transform bins */
+#define BINS_PAD   (BLOCK_SIZE + 8) /* bins padded for vector loops */
+
+#define IR_MAX_FRAMES (1 << 20) /* about 20 seconds at 48 kHz */
+
+/** Split complex spectrum */
+typedef struct
+{
+    float re[BINS_PAD];
+    float im[BINS_PAD];
+} spectrum_t;
+
+/** One convolution from an input channel to an output channel */
+typedef struct
+{
+    unsigned in;
+    unsigned out;
+    spectrum_t *h; /**< partition spectra */
+} conv_path_t;
+
+typedef void (*conv_mac_t)( spectrum_t *, const spectrum_t *,
+                            const spectrum_t * );
+
+struct filter_sys_t
+{
+    unsigned channels;
+    unsigned partitions;
+    unsigned paths_count;
+    conv_path_t *paths;
+
+    unsigned pos; /**< frames buffered in the current block */
+    unsigned slot; /**< delay line slot of the latest block */
+    float *x; /**< per channel: previous and current input blocks */
+    float *y; /**< per channel: pending output block */
+    spectrum_t *fdl; /**< per channel: frequency-domain delay line */
+    spectrum_t acc;
+    conv_mac_t mac;
+
+    /* FFT tables */
+    float cos_tab[CFFT_SIZE / 2];
+    float sin_tab[CFFT_SIZE / 2];
+    float rcos_tab[BINS];
+    float rsin_tab[BINS];
+    uint16_t bitrev[CFFT_SIZE];
+};
+
+/*****************************************************************************
+ * FFT
+ *****************************************************************************/
+static void FFTInit( filter_sys_t *p_sys )
+{
+    unsigned bits = 0;
+
+    while( (1u << bits) < CFFT_SIZE )
+        bits++;
+
+    for( unsigned i = 0; i < CFFT_SIZE; i++ )
+    {
+        unsigned r = 0;
+
+        for( unsigned b = 0; b < bits; b++ )
+            if( i & (1u << b) )
+                r |= 1u << (bits - 1 - b);
+        p_sys->bitrev[i] = r;
+    }
+
+    for( unsigned i = 0; i < CFFT_SIZE / 2; i++ )
+    {
+        p_sys->cos_tab[i] = cos( 2. * M_PI * i / CFFT_SIZE );
+        p_sys->sin_tab[i] = sin( 2. * M_PI * i / CFFT_SIZE );
+    }
+    for( unsigned i = 0; i < BINS; i++ )
+    {
+        p_sys->rcos_tab[i] = cos( 2. * M_PI * i / FFT_SIZE );
+        p_sys->rsin_tab[i] = sin( 2. * M_PI * i / FFT_SIZE );
+    }
+}
+
+/* In-place complex radix-2 transform, forward if sign is -1 */
+static void CFFT( const filter_sys_t *p_sys, float *re, float *im, float sign )
+{
+    for( unsigned i = 0; i < CFFT_SIZE; i++ )
+    {
+        unsigned j = p_sys->bitrev[i];
+
+        if( i < j )
+        {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for( unsigned half = 1; half < CFFT_SIZE; half *= 2 )
+    {
+        const unsigned step = CFFT_SIZE / (2 * half);
+
+        for( unsigned start = 0; start < CFFT_SIZE; start += 2 * half )
+            for( unsigned k = 0; k < half; k++ )
+            {
+                const float wr = p_sys->cos_tab[k * step];
+                const float wi = sign * p_sys->sin_tab[k * step];
+                float *ar = re + start + k, *ai = im + start + k;
+                float *br = ar + half, *bi = ai + half;
+                float tr = *br * wr - *bi * wi;
+                float ti = *br * wi + *bi * wr;
+
+                *br = *ar - tr;
+                *bi = *ai - ti;
+                *ar += tr;
+                *ai += ti;
+            }
+    }
+}
+
+/* Transforms FFT_SIZE real samples into BINS complex bins */
+static void RFFT( const filter_sys_t *p_sys, const float *x, spectrum_t *s )
+{
+    float zr[CFFT_SIZE], zi[CFFT_SIZE];
+
+    for( unsigned n = 0; n < CFFT_SIZE; n++ )
+    {
+        zr[n] = x[2 * n];
+        zi[n] = x[2 * n + 1];
+    }
+    CFFT( p_sys, zr, zi, -1.f );
+
+    for( unsigned k = 0; k < BINS; k++ )
+    {
+        unsigned a = k % CFFT_SIZE, b = (CFFT_SIZE - k) % CFFT_SIZE;
+        /* Even and odd samples spectra */
+        float even_r = (zr[a] + zr[b]) * .5f, even_i = (zi[a] - zi[b]) * .5f;
+        float odd_r = (zi[a] + zi[b]) * .5f, odd_i = (zr[b] - zr[a]) * .5f;
+        float wr = p_sys->rcos_tab[k], wi = -p_sys->rsin_tab[k];
+
+        s->re[k] = even_r + odd_r * wr - odd_i * wi;
+        s->im[k] = even_i + odd_r * wi + odd_i * wr;
+    }
+}
+
+/* Transforms BINS complex bins back into FFT_SIZE real samples, without
+ * normalization */
+static void IRFFT( const filter_sys_t *p_sys, const spectrum_t *s, float *x )
+{
+    float zr[CFFT_SIZE], zi[CFFT_SIZE];
+
+    for( unsigned k = 0; k < CFFT_SIZE; k++ )
+    {
+        unsigned b = CFFT_SIZE - k;
+        float even_r = s->re[k] + s->re[b], even_i = s->im[k] - s->im[b];
+        float dr = s->re[k] - s->re[b], di = s->im[k] + s->im[b];
+        float wr = p_sys->rcos_tab[k], wi = p_sys->rsin_tab[k];
+        float odd_r = dr * wr - di * wi, odd_i = dr * wi + di * wr;
+
+        zr[k] = even_r - odd_i;
+        zi[k] = even_i + odd_r;
+    }
+    CFFT( p_sys, zr, zi, 1.f );
+
+    for( unsigned n = 0; n < CFFT_SIZE; n++ )
+    {
+        x[2 * n] = zr[n];
+        x[2 * n + 1] = zi[n];
+    }
+}
+
+/*****************************************************************************
+ * Spectra multiply-accumulate: acc += h * x
+ *****************************************************************************/
+static void MacC( spectrum_t *restrict acc, const spectrum_t *restrict h,
+                  const spectrum_t *restrict x )
+{
+    for( unsigned k = 0; k < BINS_PAD; k++ )
+    {
+        acc->re[k] += h->re[k] * x->re[k] - h->im[k] * x->im[k];
+        acc->im[k] += h->re[k] * x->im[k] + h->im[k] * x->re[k];
+    }
+}
+
+#ifdef CONV_HAVE_AVX2
+VLC_AVX2
+static void MacAVX2( spectrum_t *restrict acc, const spectrum_t *restrict h,
+                     const spectrum_t *restrict x )
+{
+    for( unsigned k = 0; k < BINS_PAD; k += 8 )
+    {
+        __m256 hr = _mm256_loadu_ps( h->re + k ), hi = _mm256_loadu_ps( h->im + k );
+        __m256 xr = _mm256_loadu_ps( x->re + k ), xi = _mm256_loadu_ps( x->im + k );
+        __m256 ar = _mm256_loadu_ps( acc->re + k );
+        __m256 ai = _mm256_loadu_ps( acc->im + k );
+
+        ar = _mm256_add_ps( ar, _mm256_sub_ps( _mm256_mul_ps( hr, xr ),
+                                               _mm256_mul_ps( hi, xi ) ) );
+        ai = _mm256_add_ps( ai, _mm256_add_ps( _mm256_mul_ps( hr, xi ),
+                                               _mm256_mul_ps( hi, xr ) ) );
+        _mm256_storeu_ps( acc->re + k, ar );
+        _mm256_storeu_ps( acc->im + k, ai );
+    }
+}
+#endif
+
+#ifdef CONV_HAVE_NEON
+static void MacNEON( spectrum_t *restrict acc, const spectrum_t *restrict h,
+                     const spectrum_t *restrict x )
+{
+    for( unsigned k = 0; k < BINS_PAD; k += 4 )
+    {
+        float32x4_t hr = vld1q_f32( h->re + k ), hi = vld1q_f32( h->im + k );
+        float32x4_t xr = vld1q_f32( x->re + k ), xi = vld1q_f32( x->im + k );
+        float32x4_t ar = vld1q_f32( acc->re + k );
+        float32x4_t ai = vld1q_f32( acc->im + k );
+
+        ar = vmlsq_f32( vmlaq_f32( ar, hr, xr ), hi, xi );
+        ai = vmlaq_f32( vmlaq_f32( ai, hr, xi ), hi, xr );
+        vst1q_f32( acc->re + k, ar );
+        vst1q_f32( acc->im + k, ai );
+    }
+}
+#endif
+
+/*****************************************************************************
+ * Impulse response loading
+ *****************************************************************************/
+/* Reads a WAV file as interleaved floats; returns NULL on error */
+static float *LoadWAV( filter_t *p_filter, const char *path,
+                       unsigned *restrict pi_channels,
+                       unsigned *restrict pi_rate, size_t *restrict pi_frames )
+{
+    FILE *stream = vlc_fopen( path, "rb" );
+    if( stream == NULL )
+    {
+        msg_Err( p_filter, "cannot open %s: %s", path, vlc_strerror_c(errno) );
+        return NULL;
+    }
+
+    uint8_t hdr[12];
+    unsigned channels = 0, rate = 0, bits = 0, tag = 0;
+    float *data = NULL;
+
+    if( fread( hdr, 1, 12, stream ) != 12
+     || memcmp( hdr, "RIFF", 4 ) || memcmp( hdr + 8, "WAVE", 4 ) )
+        goto error;
+
+    for( ;; )
+    {
+        if( fread( hdr, 1, 8, stream ) != 8 )
+            goto error;
+
+        uint32_t size = GetDWLE( hdr + 4 );
+
+        if( !memcmp( hdr, "fmt ", 4 ) && size >= 16 && size <= 64 )
+        {
+            uint8_t fmt[64];
+
+            if( fread( fmt, 1, size + (size & 1), stream ) != size + (size & 1) )
+                goto error;
+            tag = GetWLE( fmt );
+            channels = GetWLE( fmt + 2 );
+            rate = GetDWLE( fmt + 4 );
+            bits = GetWLE( fmt + 14 );
+            if( tag == 0xFFFE /* WAVE_FORMAT_EXTENSIBLE */ && size >= 26 )
+                tag = GetWLE( fmt + 24 ); /* sub-format GUID prefix */
+        }
+        else if( !memcmp( hdr, "data", 4 ) )
+        {
+            if( channels == 0 || channels > AOUT_CHAN_MAX * AOUT_CHAN_MAX
+             || rate == 0
+             || !((tag == 1 && (bits == 16 || bits == 32))
+               || (tag == 3 && bits == 32)) )
+            {
+                msg_Err( p_filter, "unsupported impulse response format" );
+                goto error;
+            }
+
+            size_t frames = size / (channels * bits / 8);
+            if( frames == 0 || frames > IR_MAX_FRAMES )
+            {
+                msg_Err( p_filter, "unsupported impulse response length" );
+                goto error;
+            }
+
+            size_t samples = frames * channels;
+            uint8_t *raw = malloc( samples * (bits / 8) );
+            data = malloc( samples * sizeof (*data) );
+            if( unlikely(raw == NULL || data == NULL)
+             || fread( raw, bits / 8, samples, stream ) != samples )
+            {
+                free( raw );
+                goto error;
+            }
+
+            for( size_t i = 0; i < samples; i++ )
+            {
+                if( tag == 3 )
+                {
+                    union { uint32_t u; float f; } v = {
+                        .u = GetDWLE( raw + 4 * i ) };
+                    data[i] = v.f;
+                }
+                else if( bits == 16 )
+                    data[i] = (int16_t)GetWLE( raw + 2 * i ) / 32768.f;
+                else
+                    data[i] = (int32_t)GetDWLE( raw + 4 * i ) / 2147483648.f;
+            }
+            free( raw );
+
+            *pi_channels = channels;
+            *pi_rate = rate;
+            *pi_frames = frames;
+            fclose( stream );
+            return data;
+        }
+        else if( fseek( stream, size + (size & 1), SEEK_CUR ) )
+            goto error;
+    }
+
+error:
+    msg_Err( p_filter, "cannot read impulse response from %s", path );
+    free( data );
+    fclose( stream );
+    return NULL;
+}
+
+/*****************************************************************************
+ * Processing
+ *****************************************************************************/
+/* Convolves the current input block of all channels */
+static void ProcessBlock( filter_sys_t *p_sys )
+{
+    const unsigned channels = p_sys->channels;
+    float buf[FFT_SIZE];
+
+    p_sys->slot = (p_sys->slot + 1) % p_sys->partitions;
+    for( unsigned c = 0; c < channels; c++ )
+    {
+        float *x = p_sys->x + c * FFT_SIZE;
+
+        RFFT( p_sys, x, &p_sys->fdl[c * p_sys->partitions + p_sys->slot] );
+        memcpy( x, x + BLOCK_SIZE, BLOCK_SIZE * sizeof (*x) );
+    }
+
+    for( unsigned o = 0; o < channels; o++ )
+    {
+        memset( &p_sys->acc, 0, sizeof (p_sys->acc) );
+        for( unsigned i = 0; i < p_sys->paths_count; i++ )
+        {
+            const conv_path_t *path = &p_sys->paths[i];
+            const spectrum_t *fdl = p_sys->fdl + path->in * p_sys->partitions;
+
+            if( path->out != o )
+                continue;
+
+            for( unsigned p = 0, s = p_sys->slot; p < p_sys->partitions; p++ )
+            {
+                p_sys->mac( &p_sys->acc, &path->h[p], &fdl[s] );
+                s = (s > 0 ? s : p_sys->partitions) - 1;
+            }
+        }
+
+        /* Overlap-save: keep the second half, free from circular aliasing */
+        IRFFT( p_sys, &p_sys->acc, buf );
+        memcpy( p_sys->y + o * BLOCK_SIZE, buf + BLOCK_SIZE,
+                BLOCK_SIZE * sizeof (*buf) );
+    }
+}
+
+static block_t *Filter( filter_t *p_filter, block_t *p_block )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned channels = p_sys->channels;
+    float *p = (float *)p_block->p_buffer;
+
+    for( unsigned n = p_block->i_nb_samples; n > 0; n-- )
+    {
+        for( unsigned c = 0; c < channels; c++ )
+        {
+            float in = p[c];
+
+            p[c] = p_sys->y[c * BLOCK_SIZE + p_sys->pos];
+            p_sys->x[c * FFT_SIZE + BLOCK_SIZE + p_sys->pos] = in;
+        }
+        p += channels;
+
+        if( ++p_sys->pos == BLOCK_SIZE )
+        {
+            ProcessBlock( p_sys );
+            p_sys->pos = 0;
+        }
+    }
+    return p_block;
+}
+
+static void Flush( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned channels = p_sys->channels;
+
+    memset( p_sys->x, 0, channels * FFT_SIZE * sizeof (*p_sys->x) );
+    memset( p_sys->y, 0, channels * BLOCK_SIZE * sizeof (*p_sys->y) );
+    memset( p_sys->fdl, 0,
+            channels * p_sys->partitions * sizeof (*p_sys->fdl) );
+    p_sys->pos = 0;
+}
+
+/*****************************************************************************
+ * Open:
+ *****************************************************************************/
+static int Open( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t *)p_this;
+
+    if( p_filter->fmt_in.audio.i_format != VLC_CODEC_FL32
+     || !AOUT_FMTS_IDENTICAL( &p_filter->fmt_in.audio,
+                              &p_filter->fmt_out.audio ) )
+        return VLC_EGENERIC;
+
+    char *path = var_InheritString( p_filter, "convolver-file" );
+    if( path == NULL )
+    {
+        msg_Err( p_filter, "no impulse response file specified" );
+        return VLC_EGENERIC;
+    }
+
+    unsigned ir_channels, ir_rate;
+    size_t ir_frames;
+    float *ir = LoadWAV( p_filter, path, &ir_channels, &ir_rate, &ir_frames );
+    free( path );
+    if( ir == NULL )
+        return VLC_EGENERIC;
+
+    const unsigned channels = aout_FormatNbChannels( &p_filter->fmt_in.audio );
+    unsigned paths_count;
+
+    if( ir_channels == 1 || ir_channels == channels )
+        paths_count = channels;
+    else if( ir_channels == channels * channels )
+        paths_count = ir_channels;
+    else
+    {
+        msg_Err( p_filter, "impulse response has %u channels, expected "
+                 "1, %u or %u", ir_channels, channels, channels * channels );
+        free( ir );
+        return VLC_EGENERIC;
+    }
+
+    filter_sys_t *p_sys = malloc( sizeof (*p_sys) );
+    if( unlikely(p_sys == NULL) )
+    {
+        free( ir );
+        return VLC_ENOMEM;
+    }
+
+    p_sys->channels = channels;
+    p_sys->partitions = (ir_frames + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    p_sys->paths_count = paths_count;
+    p_sys->pos = 0;
+    p_sys->slot = 0;
+    p_sys->paths = calloc( paths_count, sizeof (*p_sys->paths) );
+    p_sys->x = calloc( channels * FFT_SIZE, sizeof (*p_sys->x) );
+    p_sys->y = calloc( channels * BLOCK_SIZE, sizeof (*p_sys->y) );
+    p_sys->fdl = calloc( channels * p_sys->partitions, sizeof (*p_sys->fdl) );
+    if( unlikely(p_sys->paths == NULL || p_sys->x == NULL
+              || p_sys->y == NULL || p_sys->fdl == NULL) )
+        goto error;
+
+    FFTInit( p_sys );
+
+    /* Transform the response partitions, including the normalization of
+     * the inverse transform, which yields twice the samples */
+    const float scale = .5f / CFFT_SIZE;
+    float buf[FFT_SIZE];
+
+    for( unsigned i = 0; i < paths_count; i++ )
+    {
+        conv_path_t *path = &p_sys->paths[i];
+        unsigned ir_channel;
+
+        if( paths_count == channels )
+        {
+            path->in = path->out = i;
+            ir_channel = (ir_channels == 1) ? 0 : i;
+        }
+        else
+        {
+            path->out = i / channels;
+            path->in = i % channels;
+            ir_channel = i;
+        }
+
+        path->h = calloc( p_sys->partitions, sizeof (*path->h) );
+        if( unlikely(path->h == NULL) )
+            goto error;
+
+        for( unsigned p = 0; p < p_sys->partitions; p++ )
+        {
+            memset( buf, 0, sizeof (buf) );
+            for( unsigned n = 0; n < BLOCK_SIZE; n++ )
+            {
+                size_t frame = (size_t)p * BLOCK_SIZE + n;
+
+                if( frame < ir_frames )
+                    buf[n] = ir[frame * ir_channels + ir_channel] * scale;
+            }
+            RFFT( p_sys, buf, &path->h[p] );
+        }
+    }
+    free( ir );
+    ir = NULL;
+
+    p_sys->mac = MacC;
+#ifdef CONV_HAVE_AVX2
+    if( vlc_CPU_AVX2() )
+        p_sys->mac = MacAVX2;
+#endif
+#ifdef CONV_HAVE_NEON
+    if( vlc_CPU_ARM64_NEON() )
+        p_sys->mac = MacNEON;
+#endif
+
+    msg_Dbg( p_filter, "%zu frames impulse response, %u partitions, "
+             "%u paths", ir_frames, p_sys->partitions, paths_count );
+
+    /* Let the pipeline resample to the rate of the response */
+    p_filter->fmt_in.audio.i_rate = ir_rate;
+    p_filter->fmt_out.audio = p_filter->fmt_in.audio;
+    p_filter->p_sys = p_sys;
+    p_filter->pf_audio_filter = Filter;
+    p_filter->pf_flush = Flush;
+    return VLC_SUCCESS;
+
+error:
+    if( p_sys->paths != NULL )
+        for( unsigned i = 0; i < paths_count; i++ )
+            free( p_sys->paths[i].h );
+    free( p_sys->paths );
+    free( p_sys->fdl );
+    free( p_sys->y );
+    free( p_sys->x );
+    free( p_sys );
+    free( ir );
+    return VLC_ENOMEM;
+}
+
+/*****************************************************************************
+ * Close:
+ *****************************************************************************/
+static void Close( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t *)p_this;
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    for( unsigned i = 0; i < p_sys->paths_count; i++ )
+        free( p_sys->paths[i].h );
+    free( p_sys->paths );
+    free( p_sys->fdl );
+    free( p_sys->y );
+    free( p_sys->x );
+    free( p_sys );
+}
@@ -42,11 +42,29 @@
 #include <vlc_aout.h>
 #include <vlc_filter.h>
 #include <vlc_block.h>
+#include <vlc_cpu.h>
 
 #include <assert.h>
 
 #include "bandlimited.h"
 
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+# include <emmintrin.h>
+# define POLY_HAVE_SSE2
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+# define POLY_HAVE_AVX2
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define POLY_HAVE_NEON
+#endif
+
+/* Maximum number of taps of each wing of the up-sampling filter */
+#define POLY_WING ((SMALL_FILTER_NWING + Npc - 1) / Npc)
+#define POLY_TAPS (2 * POLY_WING)
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -62,10 +80,23 @@ static void ResampleFloat( filter_t *p_filter,
                            int i_in, int i_in_end,
                            double d_factor, bool b_factor_old,
                            int i_nb_channels, int i_bytes_per_frame );
+static void PolyInit( filter_sys_t *, int i_nb_channels );
 
 /*****************************************************************************
  * Local structures
  *****************************************************************************/
+
+/* Coefficients of one filter wing for a given table phase, stored by
+ * increasing input sample order (i.e. the left wing is reversed) with
+ * zeroes beyond the end of the table. */
+typedef struct
+{
+    float imp[POLY_WING];
+    float impd[POLY_WING];
+} poly_wing_t;
+
+typedef void (*poly_mac_t)( const float *, const float *, float *, int );
+
 struct filter_sys_t
 {
     int32_t *p_buf;                        /* this filter introduces a delay */
@@ -78,6 +109,11 @@ struct filter_sys_t
     bool b_first;
 
     date_t end_date;
+
+    /* Polyphase layout of the filter table for up-sampling */
+    poly_mac_t pf_poly_mac;
+    poly_wing_t left[Npc];
+    poly_wing_t right[Npc + 1];
 };
 
 /*****************************************************************************
@@ -310,6 +346,7 @@ static int OpenFilter( vlc_object_t *p_this )
 
     p_sys->i_old_wing = 0;
     p_sys->b_first = true;
+    PolyInit( p_sys, aout_FormatNbChannels( &p_filter->fmt_in.audio ) );
     p_filter->pf_audio_filter = Resample;
 
     msg_Dbg( p_this, "%4.4s/%iKHz/%i->%4.4s/%iKHz/%i",
@@ -336,49 +373,6 @@ static void CloseFilter( vlc_object_t *p_this )
     free( p_filter->p_sys );
 }
 
-static void FilterFloatUP( const float Imp[], const float ImpD[], uint16_t Nwing, float *p_in,
-                            float *p_out, uint32_t ui_remainder,
-                            uint32_t ui_output_rate, int16_t Inc, int i_nb_channels )
-{
-    const float *Hp, *Hdp, *End;
-    float t, temp;
-    uint32_t ui_linear_remainder;
-    int i;
-
-    Hp = &Imp[(ui_remainder<<Nhc)/ui_output_rate];
-    Hdp = &ImpD[(ui_remainder<<Nhc)/ui_output_rate];
-
-    End = &Imp[Nwing];
-
-    ui_linear_remainder = (ui_remainder<<Nhc) -
-                            (ui_remainder<<Nhc)/ui_output_rate*ui_output_rate;
-
-    if (Inc == 1)               /* If doing right wing...              */
-    {                           /* ...drop extra coeff, so when Ph is  */
-        End--;                  /*    0.5, we don't do too many mult's */
-        if (ui_remainder == 0)  /* If the phase is zero...           */
-        {                       /* ...then we've already skipped the */
-            Hp += Npc;          /*    first sample, so we must also  */
-            Hdp += Npc;         /*    skip ahead in Imp[] and ImpD[] */
-        }
-    }
-
-    while (Hp < End) {
-        t = *Hp;                /* Get filter coeff */
-                                /* t is now interp'd filter coeff */
-        t += *Hdp * ui_linear_remainder / ui_output_rate / Npc;
-        for( i = 0; i < i_nb_channels; i++ )
-        {
-            temp = t;
-            temp *= *(p_in+i);  /* Mult coeff by input sample */
-            *(p_out+i) += temp; /* The filter output */
-        }
-        Hdp += Npc;             /* Filter coeff differences step */
-        Hp += Npc;              /* Filter coeff step */
-        p_in += (Inc * i_nb_channels); /* Input signal step */
-    }
-}
-
 static void FilterFloatUD( const float Imp[], const float ImpD[], uint16_t Nwing, float *p_in,
                            float *p_out, uint32_t ui_remainder,
                            uint32_t ui_output_rate, uint32_t ui_input_rate,
@@ -435,6 +429,186 @@ static void FilterFloatUD( const float Imp[], const float ImpD[], uint16_t Nwing
     }
 }
 
+/*****************************************************************************
+ * Polyphase up-sampling
+ *****************************************************************************
+ * When up-sampling, both filter wings step through the table by exactly Npc
+ * entries, so that the taps of one output sample only depend on the table
+ * phase (the integer part of the remainder scaled to Npc) and on the linear
+ * interpolation factor, which is the same for all taps of a wing. The table
+ * is thus transposed once into one set of contiguous taps per phase, which
+ * works for any (and any varying) rate ratio.
+ *****************************************************************************/
+static void PolyMacC( const float *coef, const float *p_in, float *p_out,
+                      int i_nb_channels )
+{
+    for( int i = 0; i < POLY_TAPS; i++ )
+    {
+        for( int c = 0; c < i_nb_channels; c++ )
+            p_out[c] += coef[i] * p_in[c];
+        p_in += i_nb_channels;
+    }
+}
+
+#ifdef POLY_HAVE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static void PolyMacStereoSSE2( const float *coef, const float *p_in,
+                               float *p_out, int i_nb_channels )
+{
+    __m128 acc = _mm_setzero_ps();
+
+    assert( i_nb_channels == 2 );
+    VLC_UNUSED(i_nb_channels);
+    for( int i = 0; i < POLY_TAPS; i += 4 )
+    {
+        __m128 c = _mm_loadu_ps( coef + i );
+
+        acc = _mm_add_ps( acc, _mm_mul_ps( _mm_unpacklo_ps( c, c ),
+                                           _mm_loadu_ps( p_in ) ) );
+        acc = _mm_add_ps( acc, _mm_mul_ps( _mm_unpackhi_ps( c, c ),
+                                           _mm_loadu_ps( p_in + 4 ) ) );
+        p_in += 8;
+    }
+    acc = _mm_add_ps( acc, _mm_movehl_ps( acc, acc ) );
+    p_out[0] += _mm_cvtss_f32( acc );
+    p_out[1] += _mm_cvtss_f32( _mm_shuffle_ps( acc, acc, 1 ) );
+}
+#endif
+
+#ifdef POLY_HAVE_AVX2
+VLC_AVX2
+static void PolyMacStereoAVX2( const float *coef, const float *p_in,
+                               float *p_out, int i_nb_channels )
+{
+    __m256 acc = _mm256_setzero_ps();
+
+    assert( i_nb_channels == 2 );
+    VLC_UNUSED(i_nb_channels);
+    for( int i = 0; i < POLY_TAPS; i += 4 )
+    {
+        __m128 c = _mm_loadu_ps( coef + i );
+        __m256 cc = _mm256_insertf128_ps(
+                        _mm256_castps128_ps256( _mm_unpacklo_ps( c, c ) ),
+                        _mm_unpackhi_ps( c, c ), 1 );
+
+        acc = _mm256_add_ps( acc, _mm256_mul_ps( cc,
+                                                 _mm256_loadu_ps( p_in ) ) );
+        p_in += 8;
+    }
+
+    __m128 sum = _mm_add_ps( _mm256_castps256_ps128( acc ),
+                             _mm256_extractf128_ps( acc, 1 ) );
+    sum = _mm_add_ps( sum, _mm_movehl_ps( sum, sum ) );
+    p_out[0] += _mm_cvtss_f32( sum );
+    p_out[1] += _mm_cvtss_f32( _mm_shuffle_ps( sum, sum, 1 ) );
+}
+#endif
+
+#ifdef POLY_HAVE_NEON
+static void PolyMacStereoNEON( const float *coef, const float *p_in,
+                               float *p_out, int i_nb_channels )
+{
+    float32x4_t acc = vdupq_n_f32( 0.f );
+
+    assert( i_nb_channels == 2 );
+    VLC_UNUSED(i_nb_channels);
+    for( int i = 0; i < POLY_TAPS; i += 4 )
+    {
+        float32x4_t c = vld1q_f32( coef + i );
+
+        acc = vmlaq_f32( acc, vzip1q_f32( c, c ), vld1q_f32( p_in ) );
+        acc = vmlaq_f32( acc, vzip2q_f32( c, c ), vld1q_f32( p_in + 4 ) );
+        p_in += 8;
+    }
+
+    float32x2_t sum = vadd_f32( vget_low_f32( acc ), vget_high_f32( acc ) );
+    p_out[0] += vget_lane_f32( sum, 0 );
+    p_out[1] += vget_lane_f32( sum, 1 );
+}
+#endif
+
+static void PolyInit( filter_sys_t *p_sys, int i_nb_channels )
+{
+    static_assert( POLY_TAPS % 4 == 0, "Unaligned polyphase taps" );
+
+    /* Left wing: the input samples before the current one */
+    for( unsigned p = 0; p < Npc; p++ )
+        for( unsigned k = 0; k < POLY_WING; k++ )
+        {
+            unsigned j = p + k * Npc;
+            poly_wing_t *w = &p_sys->left[p];
+
+            w->imp[POLY_WING - 1 - k] =
+                (j < SMALL_FILTER_NWING) ? SMALL_FILTER_FLOAT_IMP[j] : 0.f;
+            w->impd[POLY_WING - 1 - k] =
+                (j < SMALL_FILTER_NWING) ? SMALL_FILTER_FLOAT_IMPD[j] : 0.f;
+        }
+
+    /* Right wing: the input samples after the current one; the last
+     * coefficient is dropped, so that when the phase is 0.5, we do not do too
+     * many multiplications. */
+    for( unsigned p = 0; p <= Npc; p++ )
+        for( unsigned k = 0; k < POLY_WING; k++ )
+        {
+            unsigned j = p + k * Npc;
+            poly_wing_t *w = &p_sys->right[p];
+
+            w->imp[k] = (j < SMALL_FILTER_NWING - 1)
+                      ? SMALL_FILTER_FLOAT_IMP[j] : 0.f;
+            w->impd[k] = (j < SMALL_FILTER_NWING - 1)
+                       ? SMALL_FILTER_FLOAT_IMPD[j] : 0.f;
+        }
+
+    p_sys->pf_poly_mac = PolyMacC;
+    if( i_nb_channels != 2 )
+        return;
+#ifdef POLY_HAVE_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        p_sys->pf_poly_mac = PolyMacStereoAVX2;
+        return;
+    }
+#endif
+#ifdef POLY_HAVE_SSE2
+    if( vlc_CPU_SSE2() )
+    {
+        p_sys->pf_poly_mac = PolyMacStereoSSE2;
+        return;
+    }
+#endif
+#ifdef POLY_HAVE_NEON
+    if( vlc_CPU_ARM64_NEON() )
+        p_sys->pf_poly_mac = PolyMacStereoNEON;
+#endif
+}
+
+static void PolyFilterUP( const filter_sys_t *p_sys, const float *p_in,
+                          float *p_out, uint32_t ui_remainder,
+                          uint32_t ui_output_rate, int i_nb_channels )
+{
+    /* Left wing phase, and right wing phase for the complementary remainder */
+    uint32_t ui_phase = (ui_remainder << Nhc) / ui_output_rate;
+    uint32_t ui_rphase = ((ui_output_rate - ui_remainder) << Nhc)
+                         / ui_output_rate;
+    float f_frac = (float)((ui_remainder << Nhc) - ui_phase * ui_output_rate)
+                   / ui_output_rate / Npc;
+    float f_rfrac = (float)(((ui_output_rate - ui_remainder) << Nhc)
+                            - ui_rphase * ui_output_rate)
+                    / ui_output_rate / Npc;
+    const poly_wing_t *l = &p_sys->left[ui_phase];
+    const poly_wing_t *r = &p_sys->right[ui_rphase];
+    float coef[POLY_TAPS];
+
+    for( int i = 0; i < POLY_WING; i++ )
+    {
+        coef[i] = l->imp[i] + l->impd[i] * f_frac;
+        coef[POLY_WING + i] = r->imp[i] + r->impd[i] * f_rfrac;
+    }
+
+    p_sys->pf_poly_mac( coef, p_in - (POLY_WING - 1) * i_nb_channels, p_out,
+                        i_nb_channels );
+}
+
 static int ReallocBuffer( block_t **pp_out_buf,
                           float **pp_out, size_t i_out,
                           int i_nb_channels, int i_bytes_per_frame )
@@ -491,21 +665,9 @@ static void ResampleFloat( filter_t *p_filter,
 
             if( d_factor >= 1 )
             {
-                /* FilterFloatUP() is faster if we can use it */
-
-                /* Perform left-wing inner product */
-                FilterFloatUP( SMALL_FILTER_FLOAT_IMP, SMALL_FILTER_FLOAT_IMPD,
-                               SMALL_FILTER_NWING, p_in, p_out,
-                               p_sys->i_remainder,
-                               p_filter->fmt_out.audio.i_rate,
-                               -1, i_nb_channels );
-                /* Perform right-wing inner product */
-                FilterFloatUP( SMALL_FILTER_FLOAT_IMP, SMALL_FILTER_FLOAT_IMPD,
-                               SMALL_FILTER_NWING, p_in + i_nb_channels, p_out,
-                               p_filter->fmt_out.audio.i_rate -
-                               p_sys->i_remainder,
-                               p_filter->fmt_out.audio.i_rate,
-                               1, i_nb_channels );
+                /* Perform both wing inner products at once */
+                PolyFilterUP( p_sys, p_in, p_out, p_sys->i_remainder,
+                              p_filter->fmt_out.audio.i_rate, i_nb_channels );
 
 #if 0
                 /* Normalize for unity filter gain */
@@ -32,10 +32,24 @@
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_filter.h>
+#include <vlc_cpu.h>
 
 #include <string.h> /* for memset */
 #include <limits.h> /* form INT_MIN */
 
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+# include <emmintrin.h>
+# define SCALETEMPO_HAVE_SSE2
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+# define SCALETEMPO_HAVE_AVX2
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define SCALETEMPO_HAVE_NEON
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -111,8 +125,81 @@ struct filter_sys_t
     void     *buf_pre_corr;
     void     *table_window;
     unsigned(*best_overlap_offset)( filter_t *p_filter );
+    float   (*dot_product)( const float *, const float *, unsigned );
 };
 
+/*****************************************************************************
+ * dot_product: cross correlation at one offset
+ *****************************************************************************/
+static float dot_product_c( const float *a, const float *b, unsigned n )
+{
+    float corr = 0;
+    for( unsigned i = 0; i < n; i++ )
+        corr += a[i] * b[i];
+    return corr;
+}
+
+#ifdef SCALETEMPO_HAVE_AVX2
+VLC_AVX2
+static float dot_product_avx2( const float *a, const float *b, unsigned n )
+{
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    unsigned i = 0;
+
+    for( ; i + 16 <= n; i += 16 )
+    {
+        acc0 = _mm256_add_ps( acc0, _mm256_mul_ps( _mm256_loadu_ps( a + i ),
+                                                   _mm256_loadu_ps( b + i ) ) );
+        acc1 = _mm256_add_ps( acc1, _mm256_mul_ps( _mm256_loadu_ps( a + i + 8 ),
+                                                   _mm256_loadu_ps( b + i + 8 ) ) );
+    }
+    acc0 = _mm256_add_ps( acc0, acc1 );
+
+    __m128 sum = _mm_add_ps( _mm256_castps256_ps128( acc0 ),
+                             _mm256_extractf128_ps( acc0, 1 ) );
+    sum = _mm_add_ps( sum, _mm_movehl_ps( sum, sum ) );
+    sum = _mm_add_ss( sum, _mm_shuffle_ps( sum, sum, 1 ) );
+    return _mm_cvtss_f32( sum ) + dot_product_c( a + i, b + i, n - i );
+}
+#endif
+
+#ifdef SCALETEMPO_HAVE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static float dot_product_sse2( const float *a, const float *b, unsigned n )
+{
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    unsigned i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        acc0 = _mm_add_ps( acc0, _mm_mul_ps( _mm_loadu_ps( a + i ),
+                                             _mm_loadu_ps( b + i ) ) );
+        acc1 = _mm_add_ps( acc1, _mm_mul_ps( _mm_loadu_ps( a + i + 4 ),
+                                             _mm_loadu_ps( b + i + 4 ) ) );
+    }
+    acc0 = _mm_add_ps( acc0, acc1 );
+    acc0 = _mm_add_ps( acc0, _mm_movehl_ps( acc0, acc0 ) );
+    acc0 = _mm_add_ss( acc0, _mm_shuffle_ps( acc0, acc0, 1 ) );
+    return _mm_cvtss_f32( acc0 ) + dot_product_c( a + i, b + i, n - i );
+}
+#endif
+
+#ifdef SCALETEMPO_HAVE_NEON
+static float dot_product_neon( const float *a, const float *b, unsigned n )
+{
+    float32x4_t acc0 = vdupq_n_f32( 0.f ), acc1 = vdupq_n_f32( 0.f );
+    unsigned i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        acc0 = vmlaq_f32( acc0, vld1q_f32( a + i ), vld1q_f32( b + i ) );
+        acc1 = vmlaq_f32( acc1, vld1q_f32( a + i + 4 ), vld1q_f32( b + i + 4 ) );
+    }
+    return vaddvq_f32( vaddq_f32( acc0, acc1 ) )
+         + dot_product_c( a + i, b + i, n - i );
+}
+#endif
+
 /*****************************************************************************
  * best_overlap_offset: calculate best offset for overlap
  *****************************************************************************/
@@ -134,12 +221,8 @@ static unsigned best_overlap_offset_float( filter_t *p_filter )
 
     search_start = (float *)p->buf_queue + p->samples_per_frame;
     for( off = 0; off < p->frames_search; off++ ) {
-      float corr = 0;
-      float *ps = search_start;
-      ppc = p->buf_pre_corr;
-      for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-        corr += *ppc++ * *ps++;
-      }
+      float corr = p->dot_product( p->buf_pre_corr, search_start,
+                                   p->samples_overlap - p->samples_per_frame );
       if( corr > best_corr ) {
         best_corr = corr;
         best_off  = off;
@@ -416,6 +499,19 @@ static int Open( vlc_object_t *p_this )
     p_sys->table_blend    = NULL;
     p_sys->buf_pre_corr   = NULL;
     p_sys->table_window   = NULL;
+    p_sys->dot_product    = dot_product_c;
+#ifdef SCALETEMPO_HAVE_AVX2
+    if( vlc_CPU_AVX2() )
+        p_sys->dot_product = dot_product_avx2;
+#endif
+#ifdef SCALETEMPO_HAVE_SSE2
+    if( p_sys->dot_product == dot_product_c && vlc_CPU_SSE2() )
+        p_sys->dot_product = dot_product_sse2;
+#endif
+#ifdef SCALETEMPO_HAVE_NEON
+    if( vlc_CPU_ARM64_NEON() )
+        p_sys->dot_product = dot_product_neon;
+#endif
     p_sys->bytes_overlap  = 0;
     p_sys->bytes_queued   = 0;
     p_sys->bytes_to_slide = 0;
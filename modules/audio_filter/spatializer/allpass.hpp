@@ -13,7 +13,7 @@ class allpass
 public:
         allpass();
     void    setbuffer(float *buf, int size);
-    inline  float    process(float inp);
+    inline  void    processblock(float *samples, int numsamples);
     void    mute();
     void    setfeedback(float val);
     float    getfeedback();
@@ -27,19 +27,31 @@ public:
 
 // Big to inline - but crucial for speed
 
-inline float allpass::process(float input)
+// Filters samples[] in place, see comb::processblock()
+inline void allpass::processblock(float *samples, int numsamples)
 {
-    float output;
-    float bufout;
-
-    bufout = undenormalise( buffer[bufidx] );
-
-    output = -input + bufout;
-    buffer[bufidx] = input + (bufout*feedback);
-
-    if(++bufidx>=bufsize) bufidx = 0;
-
-    return output;
+    while (numsamples > 0)
+    {
+        int n = bufsize - bufidx;
+        if (n > numsamples)
+            n = numsamples;
+
+        float *buf = buffer + bufidx;
+        for (int i = 0; i < n; i++)
+        {
+            float input = samples[i];
+            float bufout = buf[i];
+
+            samples[i] = -input + bufout;
+            buf[i] = input + (bufout*feedback);
+        }
+
+        bufidx += n;
+        if (bufidx >= bufsize)
+            bufidx = 0;
+        samples += n;
+        numsamples -= n;
+    }
 }
 
 #endif//_allpass
@@ -9,7 +9,6 @@
 
 comb::comb()
 {
-    filterstore = 0;
     bufidx = 0;
     buffer = NULL;
 }
@@ -18,7 +18,8 @@ class comb
 public:
     comb();
     void    setbuffer(float *buf, int size);
-    inline  float    process(float inp);
+    inline  void    processblock(const float *input, float *output,
+                                 int numsamples);
     void    mute();
     void    setdamp(float val);
     float    getdamp();
@@ -26,7 +27,6 @@ public:
     float    getfeedback();
 private:
     float    feedback;
-    float    filterstore;
     float    damp1;
     float    damp2;
     float    *buffer;
@@ -37,22 +37,37 @@ private:
 
 // Big to inline - but crucial for speed
 
-inline float comb::process(float input)
+// Adds the comb output to output[]. Each delay line sample is read before it
+// is written within a pass, so that the inner loop has no dependency between
+// iterations and can be vectorised. Denormals are flushed by the caller.
+inline void comb::processblock(const float *input, float *output,
+                               int numsamples)
 {
 /* FIXME
 * comb::process is not really ear-friendly the tunning values must
 * be changed*/
-    float output;
+    while (numsamples > 0)
+    {
+        int n = bufsize - bufidx;
+        if (n > numsamples)
+            n = numsamples;
 
-    output = undenormalise( buffer[bufidx] );
+        float *buf = buffer + bufidx;
+        for (int i = 0; i < n; i++)
+        {
+            float out = buf[i];
 
-    filterstore = undenormalise(output*damp2);
+            buf[i] = input[i] + (out*damp2)*feedback;
+            output[i] += out;
+        }
 
-    buffer[bufidx] = input + filterstore*feedback;
-
-    if(++bufidx>=bufsize) bufidx = 0;
-
-    return output;
+        bufidx += n;
+        if (bufidx >= bufsize)
+            bufidx = 0;
+        input += n;
+        output += n;
+        numsamples -= n;
+    }
 }
 
 #endif //_comb_
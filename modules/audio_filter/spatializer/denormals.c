@@ -1,4 +1,4 @@
-// Macro for killing denormalled numbers
+// Control of the denormalled numbers handling
 //
 // Written by Jezar at Dreampoint, June 2000
 // http://www.dreampoint.co.uk
@@ -9,13 +9,70 @@
 # include <config.h>
 #endif
 
-#include <math.h>
 #include "denormals.h"
 
-/* fpclassify() is C99, cannot be compiled into a C++90 file (on some systems) */
-float undenormalise( float f )
+/* The decaying reverb tails would otherwise end up as denormalled numbers,
+ * which are very slow on most processors. Flushing them in hardware for a
+ * whole block is much cheaper than checking every sample. */
+#if defined(__SSE_MATH__)
+# include <xmmintrin.h>
+
+unsigned long denormals_disable( void )
+{
+    unsigned long csr = _mm_getcsr();
+
+    _mm_setcsr( csr | _MM_FLUSH_ZERO_ON );
+    return csr;
+}
+
+void denormals_restore( unsigned long csr )
+{
+    _mm_setcsr( csr );
+}
+
+#elif defined(__aarch64__)
+# define FPCR_FZ (1UL << 24)
+
+unsigned long denormals_disable( void )
+{
+    unsigned long fpcr;
+
+    __asm__ volatile ("mrs %0, fpcr" : "=r" (fpcr));
+    __asm__ volatile ("msr fpcr, %0" :: "r" (fpcr | FPCR_FZ));
+    return fpcr;
+}
+
+void denormals_restore( unsigned long fpcr )
+{
+    __asm__ volatile ("msr fpcr, %0" :: "r" (fpcr));
+}
+
+#elif defined(__arm__) && defined(__ARM_FP)
+# define FPSCR_FZ (1UL << 24)
+
+unsigned long denormals_disable( void )
+{
+    unsigned long fpscr;
+
+    __asm__ volatile ("vmrs %0, fpscr" : "=r" (fpscr));
+    __asm__ volatile ("vmsr fpscr, %0" :: "r" (fpscr | FPSCR_FZ));
+    return fpscr;
+}
+
+void denormals_restore( unsigned long fpscr )
 {
-    if( fpclassify( f ) == FP_SUBNORMAL  )
-        return 0.0;
-    return f;
+    __asm__ volatile ("vmsr fpscr, %0" :: "r" (fpscr));
 }
+
+#else
+/* Denormals are slow but harmless */
+unsigned long denormals_disable( void )
+{
+    return 0;
+}
+
+void denormals_restore( unsigned long state )
+{
+    (void) state;
+}
+#endif
@@ -1,4 +1,4 @@
-// Macro for killing denormalled numbers
+// Control of the denormalled numbers handling
 //
 // Written by Jezar at Dreampoint, June 2000
 // http://www.dreampoint.co.uk
@@ -8,11 +8,19 @@
 #ifndef _denormals_
 #define _denormals_
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Makes the floating point unit flush denormalled results to zero, and
+ * returns the previous control state, to be passed to denormals_restore()
+ * once the processing block is done. */
+unsigned long denormals_disable( void );
+void denormals_restore( unsigned long );
 
 #ifdef __cplusplus
-extern "C"
+}
 #endif
-float undenormalise( float );
 
 #endif//_denormals_
 
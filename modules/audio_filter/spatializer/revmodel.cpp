@@ -83,76 +83,98 @@ void revmodel::mute()
 }
 
 /*****************************************************************************
- *  Transforms the audio stream
+ *  Runs the filters on a block of at most blocksize frames
  * /param float *inputL     input buffer
- * /param float *outputL   output buffer
- * /param long numsamples  number of samples to be processed
- * /param int skip             number of channels in the audio stream
+ * /param float *outL       left reverberation
+ * /param float *outR       right reverberation
+ * /param float *inputR     right (or mono) input
+ * /param int numsamples    number of frames to be processed
+ * /param int skip          number of channels in the audio stream
  *****************************************************************************/
-void revmodel::processreplace(float *inputL, float *outputL, long /* numsamples */, int skip)
+void revmodel::process(const float *inputL, float *outL, float *outR,
+                       float *inputR, int numsamples, int skip)
 {
-    float outL,outR,input;
-    float inputR;
+    float input[blocksize];
     int i;
 
-    outL = outR = 0;
+    for(i=0; i<numsamples; i++)
+    {
         /* TODO this module supports only 2 audio channels, let's improve this */
         if (skip > 1)
-           inputR = inputL[1];
+           inputR[i] = inputL[1];
         else
-           inputR = inputL[0];
-        input = (inputL[0] + inputR) * gain;
-
-        // Accumulate comb filters in parallel
-        for(i=0; i<numcombs; i++)
-        {
-            outL += combL[i].process(input);
-            outR += combR[i].process(input);
-        }
+           inputR[i] = inputL[0];
+        input[i] = (inputL[0] + inputR[i]) * gain;
+        outL[i] = outR[i] = 0;
+        inputL += skip;
+    }
 
-        // Feed through allpasses in series
-        for(i=0; i<numallpasses; i++)
-        {
-            outL = allpassL[i].process(outL);
-            outR = allpassR[i].process(outR);
-        }
+    // Accumulate comb filters in parallel
+    for(i=0; i<numcombs; i++)
+    {
+        combL[i].processblock(input, outL, numsamples);
+        combR[i].processblock(input, outR, numsamples);
+    }
 
-        // Calculate output REPLACING anything already there
-        outputL[0] = (outL*wet1 + outR*wet2 + inputR*dry);
-           if (skip > 1)
-        outputL[1] = (outR*wet1 + outL*wet2 + inputR*dry);
+    // Feed through allpasses in series
+    for(i=0; i<numallpasses; i++)
+    {
+        allpassL[i].processblock(outL, numsamples);
+        allpassR[i].processblock(outR, numsamples);
+    }
 }
 
-void revmodel::processmix(float *inputL, float *outputL, long /* numsamples */, int skip)
+/*****************************************************************************
+ *  Transforms the audio stream
+ * /param float *inputL     input buffer
+ * /param float *outputL   output buffer (may be the input buffer)
+ * /param long numsamples  number of frames to be processed
+ * /param int skip             number of channels in the audio stream
+ *****************************************************************************/
+void revmodel::processreplace(float *inputL, float *outputL, long numsamples, int skip)
 {
-    float outL,outR,input;
-    float inputR;
+    float outL[blocksize], outR[blocksize], inputR[blocksize];
 
-    outL = outR = 0;
-        if (skip > 1)
-           inputR = inputL[1];
-        else
-           inputR = inputL[0];
-        input = (inputL[0] + inputR) * gain;
+    while (numsamples > 0)
+    {
+        int n = (numsamples < blocksize) ? numsamples : blocksize;
 
-        // Accumulate comb filters in parallel
-        for(int i=0; i<numcombs; i++)
+        process(inputL, outL, outR, inputR, n, skip);
+
+        // Calculate output REPLACING anything already there
+        for(int i=0; i<n; i++)
         {
-            outL += combL[i].process(input);
-            outR += combR[i].process(input);
+            outputL[0] = (outL[i]*wet1 + outR[i]*wet2 + inputR[i]*dry);
+            if (skip > 1)
+                outputL[1] = (outR[i]*wet1 + outL[i]*wet2 + inputR[i]*dry);
+            outputL += skip;
         }
+        inputL += n * skip;
+        numsamples -= n;
+    }
+}
 
-        // Feed through allpasses in series
-        for(int i=0; i<numallpasses; i++)
+void revmodel::processmix(float *inputL, float *outputL, long numsamples, int skip)
+{
+    float outL[blocksize], outR[blocksize], inputR[blocksize];
+
+    while (numsamples > 0)
+    {
+        int n = (numsamples < blocksize) ? numsamples : blocksize;
+
+        process(inputL, outL, outR, inputR, n, skip);
+
+        // Calculate output MIXING with anything already there
+        for(int i=0; i<n; i++)
         {
-            outL = allpassL[i].process(outL);
-            outR = allpassR[i].process(outR);
+            outputL[0] += (outL[i]*wet1 + outR[i]*wet2 + inputR[i]*dry);
+            if (skip > 1)
+                outputL[1] += (outR[i]*wet1 + outL[i]*wet2 + inputR[i]*dry);
+            outputL += skip;
         }
-
-        // Calculate output REPLACING anything already there
-        outputL[0] += (outL*wet1 + outR*wet2 + inputR*dry);
-           if (skip > 1)
-        outputL[1] += (outR*wet1 + outL*wet2 + inputR*dry);
+        inputL += n * skip;
+        numsamples -= n;
+    }
 }
 
 void revmodel::update()
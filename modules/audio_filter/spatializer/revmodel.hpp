@@ -35,6 +35,8 @@ public:
     void    setmode(float value);
 private:
     void    update();
+    void    process(const float *inputL, float *outL, float *outR,
+                    float *inputR, int numsamples, int skip);
 private:
     float    gain;
     float    roomsize,roomsize1;
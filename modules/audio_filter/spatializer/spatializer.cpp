@@ -43,6 +43,7 @@ using std::nothrow;
 #include <vlc_filter.h>
 
 #include "revmodel.hpp"
+#include "denormals.h"
 #define SPAT_AMP 0.3
 
 /*****************************************************************************
@@ -197,17 +198,16 @@ static void SpatFilter( filter_t *p_filter, float *out, float *in,
 {
     filter_sys_t *p_sys = p_filter->p_sys;
     vlc_mutex_locker locker( &p_sys->lock );
+    const unsigned i_spat = i_channels < 2 ? i_channels : 2;
 
     for( unsigned i = 0; i < i_samples; i++ )
-    {
-        for( unsigned ch = 0 ; ch < 2; ch++)
-        {
-            in[ch] = in[ch] * SPAT_AMP;
-        }
-        p_sys->p_reverbm->processreplace( in, out , 1, i_channels);
-        in  += i_channels;
-        out += i_channels;
-    }
+        for( unsigned ch = 0 ; ch < i_spat; ch++)
+            in[i * i_channels + ch] *= SPAT_AMP;
+
+    /* Flush denormals once for the whole block, not sample per sample */
+    unsigned long fpstate = denormals_disable();
+    p_sys->p_reverbm->processreplace( in, out, i_samples, i_channels );
+    denormals_restore( fpstate );
 }
 
 static block_t *DoWork( filter_t * p_filter, block_t * p_in_buf )
@@ -34,6 +34,20 @@
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
+#include <vlc_cpu.h>
+
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+# include <emmintrin.h>
+# define FLOAT_HAVE_SSE2
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+# define FLOAT_HAVE_AVX2
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define FLOAT_HAVE_NEON
+#endif
 
 /*****************************************************************************
  * Local prototypes
@@ -67,6 +81,70 @@ static void FilterFL32( audio_volume_t *p_volume, block_t *p_buffer,
     (void) p_volume;
 }
 
+#ifdef FLOAT_HAVE_AVX2
+VLC_AVX2
+static void FilterFL32AVX2( audio_volume_t *p_volume, block_t *p_buffer,
+                            float f_multiplier )
+{
+    if( f_multiplier == 1.f )
+        return; /* nothing to do */
+
+    float *p = (float *)p_buffer->p_buffer;
+    size_t i = p_buffer->i_buffer / sizeof(*p);
+    const __m256 mult = _mm256_set1_ps( f_multiplier );
+
+    for( ; i >= 8; i -= 8, p += 8 )
+        _mm256_storeu_ps( p, _mm256_mul_ps( _mm256_loadu_ps( p ), mult ) );
+    for( ; i > 0; i-- )
+        *(p++) *= f_multiplier;
+
+    (void) p_volume;
+}
+#endif
+
+#ifdef FLOAT_HAVE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static void FilterFL32SSE2( audio_volume_t *p_volume, block_t *p_buffer,
+                            float f_multiplier )
+{
+    if( f_multiplier == 1.f )
+        return; /* nothing to do */
+
+    float *p = (float *)p_buffer->p_buffer;
+    size_t i = p_buffer->i_buffer / sizeof(*p);
+    const __m128 mult = _mm_set1_ps( f_multiplier );
+
+    for( ; i >= 4; i -= 4, p += 4 )
+        _mm_storeu_ps( p, _mm_mul_ps( _mm_loadu_ps( p ), mult ) );
+    for( ; i > 0; i-- )
+        *(p++) *= f_multiplier;
+
+    (void) p_volume;
+}
+#endif
+
+#ifdef FLOAT_HAVE_NEON
+static void FilterFL32NEON( audio_volume_t *p_volume, block_t *p_buffer,
+                            float f_multiplier )
+{
+    if( f_multiplier == 1.f )
+        return; /* nothing to do */
+
+    float *p = (float *)p_buffer->p_buffer;
+    size_t i = p_buffer->i_buffer / sizeof(*p);
+
+    for( ; i >= 8; i -= 8, p += 8 )
+    {
+        vst1q_f32( p, vmulq_n_f32( vld1q_f32( p ), f_multiplier ) );
+        vst1q_f32( p + 4, vmulq_n_f32( vld1q_f32( p + 4 ), f_multiplier ) );
+    }
+    for( ; i > 0; i-- )
+        *(p++) *= f_multiplier;
+
+    (void) p_volume;
+}
+#endif
+
 static void FilterFL64( audio_volume_t *p_volume, block_t *p_buffer,
                         float f_multiplier )
 {
@@ -92,6 +170,24 @@ static int Create( vlc_object_t *p_this )
     {
         case VLC_CODEC_FL32:
             p_volume->amplify = FilterFL32;
+#ifdef FLOAT_HAVE_AVX2
+            if( vlc_CPU_AVX2() )
+            {
+                p_volume->amplify = FilterFL32AVX2;
+                break;
+            }
+#endif
+#ifdef FLOAT_HAVE_SSE2
+            if( vlc_CPU_SSE2() )
+            {
+                p_volume->amplify = FilterFL32SSE2;
+                break;
+            }
+#endif
+#ifdef FLOAT_HAVE_NEON
+            if( vlc_CPU_ARM64_NEON() )
+                p_volume->amplify = FilterFL32NEON;
+#endif
             break;
         case VLC_CODEC_FL64:
             p_volume->amplify = FilterFL64;
@@ -29,6 +29,16 @@
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
+#include <vlc_cpu.h>
+
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+# include <emmintrin.h>
+# define INTEGER_HAVE_SSE2
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+# define INTEGER_HAVE_AVX2
+#endif
 
 static int Activate (vlc_object_t *);
 
@@ -61,15 +71,76 @@ static void FilterS32N (audio_volume_t *vol, block_t *block, float volume)
     (void) vol;
 }
 
+/* The 16-bit vector versions compute the same 32-bit products as the C
+ * version, and saturate them while packing back to 16 bits. They return the
+ * number of samples processed. */
+#ifdef INTEGER_HAVE_AVX2
+VLC_AVX2
+static size_t AmplifyS16AVX2 (int16_t *p, size_t n, int16_t mult)
+{
+    const __m256i m = _mm256_set1_epi16 (mult);
+    size_t done = 0;
+
+    for (; done + 16 <= n; done += 16, p += 16)
+    {
+        __m256i v = _mm256_loadu_si256 ((__m256i *)p);
+        __m256i lo = _mm256_mullo_epi16 (v, m);
+        __m256i hi = _mm256_mulhi_epi16 (v, m);
+        __m256i a = _mm256_srai_epi32 (_mm256_unpacklo_epi16 (lo, hi), 8);
+        __m256i b = _mm256_srai_epi32 (_mm256_unpackhi_epi16 (lo, hi), 8);
+
+        _mm256_storeu_si256 ((__m256i *)p, _mm256_packs_epi32 (a, b));
+    }
+    return done;
+}
+#endif
+
+#ifdef INTEGER_HAVE_SSE2
+__attribute__ ((__target__ ("sse2")))
+static size_t AmplifyS16SSE2 (int16_t *p, size_t n, int16_t mult)
+{
+    const __m128i m = _mm_set1_epi16 (mult);
+    size_t done = 0;
+
+    for (; done + 8 <= n; done += 8, p += 8)
+    {
+        __m128i v = _mm_loadu_si128 ((__m128i *)p);
+        __m128i lo = _mm_mullo_epi16 (v, m);
+        __m128i hi = _mm_mulhi_epi16 (v, m);
+        __m128i a = _mm_srai_epi32 (_mm_unpacklo_epi16 (lo, hi), 8);
+        __m128i b = _mm_srai_epi32 (_mm_unpackhi_epi16 (lo, hi), 8);
+
+        _mm_storeu_si128 ((__m128i *)p, _mm_packs_epi32 (a, b));
+    }
+    return done;
+}
+#endif
+
 static void FilterS16N (audio_volume_t *vol, block_t *block, float volume)
 {
     int16_t *p = (int16_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
 
     int_fast16_t mult = lroundf (volume * 0x1.p8f);
     if (mult == (1 << 8))
         return;
 
-    for (size_t n = block->i_buffer / sizeof (*p); n > 0; n--)
+    if (mult >= INT16_MIN && mult <= INT16_MAX)
+    {
+        size_t done = 0;
+#ifdef INTEGER_HAVE_AVX2
+        if (vlc_CPU_AVX2 ())
+            done = AmplifyS16AVX2 (p, n, mult);
+#endif
+#ifdef INTEGER_HAVE_SSE2
+        if (done == 0 && vlc_CPU_SSE2 ())
+            done = AmplifyS16SSE2 (p, n, mult);
+#endif
+        p += done;
+        n -= done;
+    }
+
+    for (; n > 0; n--)
     {
         int_fast32_t s = (*p * (int_fast32_t)mult) >> 8;
         if (s > INT16_MAX)
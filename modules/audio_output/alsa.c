@@ -68,6 +68,11 @@ static int EnumDevices (vlc_object_t *, char const *, char ***, char ***);
 #define AUDIO_CHAN_LONGTEXT N_("Channels available for audio output. " \
     "If the input has more channels than the output, it will be down-mixed. " \
     "This parameter is ignored when digital pass-through is active.")
+#define LATENCY_TEXT N_("Buffer duration (ms)")
+#define LATENCY_LONGTEXT N_("Duration of the device buffer, for low " \
+    "latency playback such as live monitoring. Periods are then at most " \
+    "5 milliseconds long. Use 0 for the default buffering.")
+
 static const int channels[] = {
     AOUT_CHAN_CENTER, AOUT_CHANS_STEREO, AOUT_CHANS_4_0, AOUT_CHANS_4_1,
     AOUT_CHANS_5_0, AOUT_CHANS_5_1, AOUT_CHANS_7_1,
@@ -88,6 +93,8 @@ vlc_module_begin ()
     add_integer ("alsa-audio-channels", AOUT_CHANS_FRONT,
                  AUDIO_CHAN_TEXT, AUDIO_CHAN_LONGTEXT, false)
         change_integer_list (channels, channels_text)
+    add_integer_with_range ("alsa-latency", 0, 0, 1000,
+                            LATENCY_TEXT, LATENCY_LONGTEXT, true)
     add_sw_gain ()
     set_capability( "audio output", 150 )
     set_callbacks( Open, Close )
@@ -499,8 +506,13 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
     sys->rate = fmt->i_rate;
 
+    /* Low latency mode: small buffer, woken up every (short) period */
+    unsigned latency = var_InheritInteger (aout, "alsa-latency") * 1000;
+
 #if 1 /* work-around for period-long latency outputs (e.g. PulseAudio): */
     param = AOUT_MIN_PREPARE_TIME;
+    if (latency > 0)
+        param = __MIN(latency / 2, 5000);
     val = snd_pcm_hw_params_set_period_time_near (pcm, hw, &param, NULL);
     if (val)
     {
@@ -509,7 +521,7 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
 #endif
     /* Set buffer size */
-    param = AOUT_MAX_ADVANCE_TIME;
+    param = (latency > 0) ? latency : AOUT_MAX_ADVANCE_TIME;
     val = snd_pcm_hw_params_set_buffer_time_near (pcm, hw, &param, NULL);
     if (val)
     {
@@ -0,0 +1,525 @@
+/*****************************************************************************
+ * fanout.c : audio output to several audio output modules at once
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The decoded and filtered stream is played by the first listed output,
+ * which provides the clock to the core. Every other output (a "branch")
+ * gets a copy of each block through its own filters chain, which converts
+ * to the format the branch negotiated, and whose resampler is continuously
+ * adjusted to follow the first output. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_aout.h>
+#include <vlc_block.h>
+#include <vlc_input.h>
+#include <vlc_modules.h>
+
+/* Drift beyond which a branch is resynchronized abruptly */
+#define FANOUT_MAX_DRIFT       (CLOCK_FREQ / 10)
+/* Time constant of the drift correction by resampling */
+#define FANOUT_RESAMPLING_PERIOD (4 * CLOCK_FREQ)
+/* Maximum resampling adjustment (in percent) */
+#define FANOUT_MAX_RESAMPLING  2
+
+typedef struct
+{
+    audio_output_t *output;
+    module_t *module;
+    aout_filters_t *filters; /**< conversion from the primary format */
+    audio_sample_format_t fmt; /**< format negotiated by the output */
+    int resampling;
+    bool started;
+} fanout_branch_t;
+
+struct aout_sys_t
+{
+    audio_sample_format_t fmt; /**< format negotiated by the primary */
+    unsigned count;
+    fanout_branch_t branches[]; /**< primary first */
+};
+
+static void PlaySilence(fanout_branch_t *br, mtime_t length, mtime_t pts)
+{
+    const audio_sample_format_t *fmt = &br->fmt;
+
+    if (!AOUT_FMT_LINEAR(fmt))
+        return;
+
+    size_t frames = length * fmt->i_rate / CLOCK_FREQ;
+    block_t *block = block_Alloc(frames * fmt->i_bytes_per_frame
+                                 / fmt->i_frame_length);
+    if (unlikely(block == NULL))
+        return;
+
+    memset(block->p_buffer, (fmt->i_format == VLC_CODEC_U8) ? 0x80 : 0,
+           block->i_buffer);
+    block->i_nb_samples = frames;
+    block->i_pts = block->i_dts = pts;
+    block->i_length = length;
+    br->output->play(br->output, block);
+}
+
+/**
+ * Compares the delay of a branch with the primary delay, and adjusts the
+ * branch resampling ratio so that the drift converges to zero over
+ * FANOUT_RESAMPLING_PERIOD.
+ */
+static void Synchronize(audio_output_t *aout, fanout_branch_t *br,
+                        mtime_t ref, mtime_t pts)
+{
+    audio_output_t *out = br->output;
+    mtime_t drift;
+
+    if (out->time_get == NULL || out->time_get(out, &drift) != 0)
+        return;
+    drift -= ref;
+
+    if (drift > FANOUT_MAX_DRIFT)
+    {
+        msg_Warn(out, "playback too late (%"PRId64"): flushing buffers",
+                 drift);
+        out->flush(out, false);
+        aout_FiltersFlush(br->filters);
+
+        if (out->time_get(out, &drift) != 0)
+            drift = 0;
+        drift -= ref;
+    }
+
+    if (drift < -FANOUT_MAX_DRIFT)
+    {
+        msg_Dbg(out, "playback too early (%"PRId64"): playing silence",
+                drift);
+        PlaySilence(br, -drift, pts);
+        drift = 0;
+    }
+
+    const int rate = aout->sys->fmt.i_rate;
+    const int max = rate * FANOUT_MAX_RESAMPLING / 100;
+    int adjust = drift * rate / FANOUT_RESAMPLING_PERIOD;
+
+    if (adjust > max)
+        adjust = max;
+    if (adjust < -max)
+        adjust = -max;
+
+    if (adjust != br->resampling)
+    {
+        aout_FiltersAdjustResampling(br->filters, 0);
+        aout_FiltersAdjustResampling(br->filters, adjust);
+        br->resampling = adjust;
+    }
+}
+
+static int TimeGet(audio_output_t *aout, mtime_t *restrict delay)
+{
+    audio_output_t *primary = aout->sys->branches[0].output;
+
+    if (primary->time_get == NULL)
+        return -1;
+    return primary->time_get(primary, delay);
+}
+
+static void Play(audio_output_t *aout, block_t *block)
+{
+    aout_sys_t *sys = aout->sys;
+    audio_output_t *primary = sys->branches[0].output;
+    mtime_t delay;
+    bool sync = primary->time_get != NULL
+             && primary->time_get(primary, &delay) == 0;
+
+    for (unsigned i = 1; i < sys->count; i++)
+    {
+        fanout_branch_t *br = &sys->branches[i];
+
+        if (!br->started)
+            continue;
+
+        block_t *copy = block_Duplicate(block);
+        if (unlikely(copy == NULL))
+            continue;
+
+        if (sync)
+            Synchronize(aout, br, delay, block->i_pts);
+
+        copy = aout_FiltersPlay(br->filters, copy, INPUT_RATE_DEFAULT);
+        if (copy != NULL)
+            br->output->play(br->output, copy);
+    }
+
+    primary->play(primary, block);
+}
+
+static void Pause(audio_output_t *aout, bool paused, mtime_t date)
+{
+    aout_sys_t *sys = aout->sys;
+
+    for (unsigned i = 0; i < sys->count; i++)
+    {
+        audio_output_t *out = sys->branches[i].output;
+
+        if (sys->branches[i].started && out->pause != NULL)
+            out->pause(out, paused, date);
+    }
+}
+
+static void Flush(audio_output_t *aout, bool wait)
+{
+    aout_sys_t *sys = aout->sys;
+
+    for (unsigned i = 0; i < sys->count; i++)
+    {
+        fanout_branch_t *br = &sys->branches[i];
+
+        if (!br->started)
+            continue;
+
+        if (br->filters != NULL)
+        {
+            if (wait)
+            {
+                block_t *block = aout_FiltersDrain(br->filters);
+                if (block != NULL)
+                    br->output->play(br->output, block);
+            }
+            else
+                aout_FiltersFlush(br->filters);
+        }
+        br->output->flush(br->output, wait);
+    }
+}
+
+static int VolumeSet(audio_output_t *aout, float volume)
+{
+    aout_sys_t *sys = aout->sys;
+    int ret = -1;
+
+    for (unsigned i = 0; i < sys->count; i++)
+    {
+        audio_output_t *out = sys->branches[i].output;
+
+        if (out->volume_set != NULL)
+        {
+            int val = out->volume_set(out, volume);
+            if (i == 0)
+                ret = val;
+        }
+    }
+    return ret;
+}
+
+static int MuteSet(audio_output_t *aout, bool mute)
+{
+    aout_sys_t *sys = aout->sys;
+    int ret = -1;
+
+    for (unsigned i = 0; i < sys->count; i++)
+    {
+        audio_output_t *out = sys->branches[i].output;
+
+        if (out->mute_set != NULL)
+        {
+            int val = out->mute_set(out, mute);
+            if (i == 0)
+                ret = val;
+        }
+    }
+    return ret;
+}
+
+static int DeviceSelect(audio_output_t *aout, const char *id)
+{
+    audio_output_t *primary = aout->sys->branches[0].output;
+
+    return primary->device_select(primary, id);
+}
+
+static void StopBranch(fanout_branch_t *br)
+{
+    if (br->output->stop != NULL)
+        br->output->stop(br->output);
+    if (br->filters != NULL)
+    {
+        aout_FiltersDelete((vlc_object_t *)NULL, br->filters);
+        br->filters = NULL;
+    }
+    br->started = false;
+}
+
+static void Stop(audio_output_t *aout)
+{
+    aout_sys_t *sys = aout->sys;
+
+    for (unsigned i = 0; i < sys->count; i++)
+        if (sys->branches[i].started)
+            StopBranch(&sys->branches[i]);
+}
+
+static int Start(audio_output_t *aout, audio_sample_format_t *restrict fmt)
+{
+    aout_sys_t *sys = aout->sys;
+    fanout_branch_t *primary = &sys->branches[0];
+
+    if (primary->output->start(primary->output, fmt))
+        return VLC_EGENERIC;
+    primary->started = true;
+    primary->fmt = *fmt;
+    sys->fmt = *fmt;
+
+    audio_sample_format_t infmt = *fmt;
+    if (AOUT_FMT_LINEAR(&infmt))
+        aout_FormatPrepare(&infmt);
+
+    for (unsigned i = 1; i < sys->count; i++)
+    {
+        fanout_branch_t *br = &sys->branches[i];
+
+        br->fmt = infmt;
+        if (br->output->start(br->output, &br->fmt))
+        {
+            msg_Warn(br->output, "cannot start audio output");
+            continue;
+        }
+        br->started = true;
+
+        if (AOUT_FMT_LINEAR(&br->fmt))
+            aout_FormatPrepare(&br->fmt);
+
+        br->filters = aout_FiltersNew(br->output, &infmt, &br->fmt, NULL);
+        if (br->filters == NULL)
+        {
+            msg_Err(br->output, "cannot convert to the output format");
+            StopBranch(br);
+            continue;
+        }
+        br->resampling = 0;
+    }
+    return VLC_SUCCESS;
+}
+
+/* Only the primary output controls the volume, the device and the software
+ * gain. Restart requests are accepted from any output. */
+static bool IsPrimary(audio_output_t *out)
+{
+    audio_output_t *aout = (audio_output_t *)out->obj.parent;
+
+    return out == aout->sys->branches[0].output;
+}
+
+static void VolumeReport(audio_output_t *out, float volume)
+{
+    if (IsPrimary(out))
+        aout_VolumeReport((audio_output_t *)out->obj.parent, volume);
+}
+
+static void MuteReport(audio_output_t *out, bool mute)
+{
+    if (IsPrimary(out))
+        aout_MuteReport((audio_output_t *)out->obj.parent, mute);
+}
+
+static void PolicyReport(audio_output_t *out, bool cork)
+{
+    if (IsPrimary(out))
+        aout_PolicyReport((audio_output_t *)out->obj.parent, cork);
+}
+
+static void DeviceReport(audio_output_t *out, const char *id)
+{
+    if (IsPrimary(out))
+        aout_DeviceReport((audio_output_t *)out->obj.parent, id);
+}
+
+static void HotplugReport(audio_output_t *out, const char *id,
+                          const char *name)
+{
+    if (IsPrimary(out))
+        aout_HotplugReport((audio_output_t *)out->obj.parent, id, name);
+}
+
+static int GainRequest(audio_output_t *out, float gain)
+{
+    if (!IsPrimary(out))
+        return 0;
+    return aout_GainRequest((audio_output_t *)out->obj.parent, gain);
+}
+
+static void RestartRequest(audio_output_t *out, unsigned mode)
+{
+    aout_RestartRequest((audio_output_t *)out->obj.parent, mode);
+}
+
+static int OpenBranch(audio_output_t *aout, fanout_branch_t *br,
+                      const char *name, config_chain_t *cfg)
+{
+    audio_output_t *out = vlc_object_create(aout, sizeof (*out));
+    if (unlikely(out == NULL))
+        return VLC_ENOMEM;
+
+    br->output = out;
+    br->filters = NULL;
+    br->started = false;
+
+    /* Per-output options, e.g. alsa{alsa-audio-device=hw:1} */
+    unsigned n = 0;
+    for (config_chain_t *c = cfg; c != NULL; c = c->p_next)
+        n++;
+
+    const char *opts[n + 1];
+    n = 0;
+    for (config_chain_t *c = cfg; c != NULL; c = c->p_next)
+        opts[n++] = c->psz_name;
+    opts[n] = NULL;
+    config_ChainParse(out, "", opts, cfg);
+
+    /* Filters are already applied before the fan-out, and the outputs must
+     * not recurse into this module */
+    var_Create(out, "fanout-outputs", VLC_VAR_STRING);
+    var_Create(out, "audio-filter", VLC_VAR_STRING);
+    var_Create(out, "audio-time-stretch", VLC_VAR_BOOL);
+
+    out->event.volume_report = VolumeReport;
+    out->event.mute_report = MuteReport;
+    out->event.policy_report = PolicyReport;
+    out->event.device_report = DeviceReport;
+    out->event.hotplug_report = HotplugReport;
+    out->event.gain_request = GainRequest;
+    out->event.restart_request = RestartRequest;
+
+    out->start = NULL;
+    out->stop = NULL;
+    out->time_get = NULL;
+    out->pause = NULL;
+    out->volume_set = NULL;
+    out->mute_set = NULL;
+    out->device_select = NULL;
+
+    br->module = module_need(out, "audio output", name, true);
+    if (br->module == NULL)
+    {
+        vlc_object_release(out);
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    audio_output_t *aout = (audio_output_t *)obj;
+    aout_sys_t *sys = aout->sys;
+
+    for (unsigned i = 0; i < sys->count; i++)
+    {
+        module_unneed(sys->branches[i].output, sys->branches[i].module);
+        vlc_object_release(sys->branches[i].output);
+    }
+    free(sys);
+}
+
+static int Open(vlc_object_t *obj)
+{
+    audio_output_t *aout = (audio_output_t *)obj;
+    char *list = var_InheritString(aout, "fanout-outputs");
+
+    if (list == NULL)
+        return VLC_EGENERIC;
+
+    /* Upper bound of the number of outputs */
+    unsigned max = 1;
+    for (const char *p = list; (p = strchr(p, ':')) != NULL; p++)
+        max++;
+
+    aout_sys_t *sys = malloc(sizeof (*sys) + max * sizeof (sys->branches[0]));
+    if (unlikely(sys == NULL))
+    {
+        free(list);
+        return VLC_ENOMEM;
+    }
+    sys->count = 0;
+    aout->sys = sys;
+
+    char *chain = list;
+    while (chain != NULL && *chain)
+    {
+        char *name;
+        config_chain_t *cfg;
+        char *next = config_ChainCreate(&name, &cfg, chain);
+
+        if (strcmp(name, "fanout") && strcmp(name, MODULE_STRING))
+        {
+            if (OpenBranch(aout, &sys->branches[sys->count], name, cfg) == 0)
+                sys->count++;
+            else
+                msg_Err(aout, "cannot load audio output %s", name);
+        }
+        config_ChainDestroy(cfg);
+        free(name);
+        free(chain);
+        chain = next;
+    }
+    free(chain);
+
+    if (sys->count == 0 || sys->branches[0].output->start == NULL)
+    {
+        if (sys->count > 0)
+            msg_Err(aout, "the first audio output cannot be started");
+        Close(obj);
+        return VLC_EGENERIC;
+    }
+
+    aout->start = Start;
+    aout->stop = Stop;
+    aout->time_get = TimeGet;
+    aout->play = Play;
+    aout->pause = Pause;
+    aout->flush = Flush;
+
+    audio_output_t *primary = sys->branches[0].output;
+    aout->volume_set = (primary->volume_set != NULL) ? VolumeSet : NULL;
+    aout->mute_set = (primary->mute_set != NULL) ? MuteSet : NULL;
+    aout->device_select = (primary->device_select != NULL) ? DeviceSelect
+                                                           : NULL;
+    return VLC_SUCCESS;
+}
+
+#define OUTPUTS_TEXT N_("Audio outputs")
+#define OUTPUTS_LONGTEXT N_( \
+    "Colon-separated list of the audio output modules to play to, " \
+    "with optional per-output parameters, e.g. " \
+    "alsa{alsa-audio-device=\"hw:0\"}:pulse. " \
+    "The first output provides the playback clock.")
+
+vlc_module_begin ()
+    set_shortname(N_("Fan-out"))
+    set_description(N_("Multiple audio outputs"))
+    set_category(CAT_AUDIO)
+    set_subcategory(SUBCAT_AUDIO_AOUT)
+    set_capability("audio output", 0)
+    add_string("fanout-outputs", NULL, OUTPUTS_TEXT, OUTPUTS_LONGTEXT, false)
+    set_callbacks(Open, Close)
+    add_shortcut("fanout")
+vlc_module_end ()
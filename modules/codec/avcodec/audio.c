@@ -474,24 +474,28 @@ static block_t * ConvertAVFrame( decoder_t *p_dec, AVFrame *frame )
     /* Interleave audio if required */
     if( av_sample_fmt_is_planar( ctx->sample_fmt ) )
     {
-        p_block = block_Alloc(frame->linesize[0] * ctx->channels);
+        /* Extract the channels while interleaving, in a single pass */
+        unsigned i_channels = p_sys->b_extract ? p_dec->fmt_out.audio.i_channels
+                                               : (unsigned)ctx->channels;
+        const void *planes[ctx->channels];
+
+        for (unsigned i = 0; i < i_channels; i++)
+            planes[i] = frame->extended_data[p_sys->b_extract
+                                             ? p_sys->pi_extraction[i] : i];
+
+        p_block = block_Alloc(frame->nb_samples * i_channels
+                              * av_get_bytes_per_sample(ctx->sample_fmt));
         if ( likely(p_block) )
         {
-            const void *planes[ctx->channels];
-            for (int i = 0; i < ctx->channels; i++)
-                planes[i] = frame->extended_data[i];
-
             aout_Interleave(p_block->p_buffer, planes, frame->nb_samples,
-                            ctx->channels, p_dec->fmt_out.audio.i_format);
+                            i_channels, p_dec->fmt_out.audio.i_format);
             p_block->i_nb_samples = frame->nb_samples;
         }
         av_frame_free(&frame);
+        return p_block;
     }
-    else
-    {
-        p_block = vlc_av_frame_Wrap(frame);
-        frame = NULL;
-    }
+
+    p_block = vlc_av_frame_Wrap(frame);
 
     if (p_sys->b_extract && p_block)
     {   /* TODO: do not drop channels... at least not here */
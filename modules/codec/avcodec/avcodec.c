@@ -57,6 +57,10 @@ struct decoder_sys_t
 static int OpenDecoder( vlc_object_t * );
 static void CloseDecoder( vlc_object_t * );
 
+static const int  threads_type_list[] = { 0, 1, 2 };
+static const char *const threads_type_list_text[] =
+  { N_("Automatic"), N_("Frame"), N_("Slice") };
+
 static const int  nloopf_list[] = { 0, 1, 2, 3, 4 };
 static const char *const nloopf_list_text[] =
   { N_("None"), N_("Non-ref"), N_("Bidir"), N_("Non-key"), N_("All") };
@@ -133,6 +137,9 @@ vlc_module_begin ()
 #if defined(FF_THREAD_FRAME)
     add_obsolete_integer( "ffmpeg-threads" ) /* removed since 2.1.0 */
     add_integer( "avcodec-threads", 0, THREADS_TEXT, THREADS_LONGTEXT, true );
+    add_integer( "avcodec-threads-type", 0, THREADS_TYPE_TEXT,
+                 THREADS_TYPE_LONGTEXT, true )
+        change_integer_list( threads_type_list, threads_type_list_text )
 #endif
     add_string( "avcodec-options", NULL, AV_OPTIONS_TEXT, AV_OPTIONS_LONGTEXT, true )
 
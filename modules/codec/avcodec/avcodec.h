@@ -116,6 +116,13 @@ void ffmpeg_CloseCodec( decoder_t *p_dec );
 #define THREADS_TEXT N_( "Threads" )
 #define THREADS_LONGTEXT N_( "Number of threads used for decoding, 0 meaning auto" )
 
+#define THREADS_TYPE_TEXT N_( "Threading mode" )
+#define THREADS_TYPE_LONGTEXT N_( "Frame threading gives the best " \
+    "throughput, but delays the output by one frame per thread. Slice " \
+    "threading adds no delay and suits live inputs, but only scales with " \
+    "streams coded with several slices. Automatic lets libavcodec choose " \
+    "and sizes the thread count with the picture." )
+
 /*
  * Encoder options
  */
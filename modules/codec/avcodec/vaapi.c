@@ -55,14 +55,115 @@
     vaCreateSurfaces(d, w, h, f, ns, s)
 #endif
 
-struct vlc_va_sys_t
+/* The VA display is shared by all the decoders of the process: opening and
+ * initializing it loads the driver, which used to stall every re-creation
+ * of the decoder, as happens on each resolution change of adaptive
+ * streams. */
+static vlc_mutex_t display_lock = VLC_STATIC_MUTEX;
+static struct
+{
+#ifdef VLC_VA_BACKEND_XLIB
+    Display  *p_display_x11;
+#endif
+#ifdef VLC_VA_BACKEND_DRM
+    int       drm_fd;
+#endif
+    VADisplay display;
+    unsigned  refs; /**< decoders using the display */
+    unsigned  surfaces; /**< surfaces allocated by those decoders */
+} shared_display;
+
+static VADisplay DisplayHold(vlc_va_t *va, unsigned surfaces)
+{
+    VADisplay display = NULL;
+
+    vlc_mutex_lock(&display_lock);
+    if (shared_display.refs > 0)
+    {
+        display = shared_display.display;
+        goto out;
+    }
+
+#ifdef VLC_VA_BACKEND_XLIB
+    shared_display.p_display_x11 = XOpenDisplay(NULL);
+    if( !shared_display.p_display_x11 )
+    {
+        msg_Err( va, "Could not connect to X server" );
+        goto error;
+    }
+
+    display = vaGetDisplay(shared_display.p_display_x11);
+#endif
+#ifdef VLC_VA_BACKEND_DRM
+    shared_display.drm_fd = vlc_open("/dev/dri/card0", O_RDWR);
+    if( shared_display.drm_fd == -1 )
+    {
+        msg_Err( va, "Could not access rendering device: %m" );
+        goto error;
+    }
+
+    display = vaGetDisplayDRM(shared_display.drm_fd);
+#endif
+    if (display == NULL)
+    {
+        msg_Err( va, "Could not get a VAAPI device" );
+        goto error;
+    }
+
+    int major, minor;
+    if (vaInitialize(display, &major, &minor))
+    {
+        msg_Err( va, "Failed to initialize the VAAPI device" );
+        vaTerminate(display);
+        display = NULL;
+        goto error;
+    }
+    shared_display.display = display;
+
+out:
+    shared_display.refs++;
+    shared_display.surfaces += surfaces;
+    msg_Dbg(va, "VA display used by %u decoder(s) with %u surfaces",
+            shared_display.refs, shared_display.surfaces);
+    vlc_mutex_unlock(&display_lock);
+    return display;
+
+error:
+#ifdef VLC_VA_BACKEND_XLIB
+    if( shared_display.p_display_x11 != NULL )
+        XCloseDisplay( shared_display.p_display_x11 );
+#endif
+#ifdef VLC_VA_BACKEND_DRM
+    if( shared_display.drm_fd != -1 )
+        vlc_close( shared_display.drm_fd );
+#endif
+    vlc_mutex_unlock(&display_lock);
+    return NULL;
+}
+
+static void DisplayRelease(vlc_va_t *va, unsigned surfaces)
 {
+    vlc_mutex_lock(&display_lock);
+    assert(shared_display.refs > 0);
+    assert(shared_display.surfaces >= surfaces);
+    shared_display.surfaces -= surfaces;
+    msg_Dbg(va, "VA display used by %u decoder(s) with %u surfaces",
+            shared_display.refs - 1, shared_display.surfaces);
+    if (--shared_display.refs == 0)
+    {
+        vaTerminate(shared_display.display);
 #ifdef VLC_VA_BACKEND_XLIB
-        Display  *p_display_x11;
+        XCloseDisplay( shared_display.p_display_x11 );
 #endif
 #ifdef VLC_VA_BACKEND_DRM
-        int       drm_fd;
+        vlc_close( shared_display.drm_fd );
 #endif
+    }
+    vlc_mutex_unlock(&display_lock);
+}
+
+struct vlc_va_sys_t
+{
     struct vaapi_context hw_ctx;
 
     /* */
@@ -111,7 +212,7 @@ static int Extract( vlc_va_t *va, picture_t *p_picture, uint8_t *data )
     if( i_fourcc == VA_FOURCC_YV12 ||
         i_fourcc == VA_FOURCC_IYUV )
     {
-        bool b_swap_uv = i_fourcc == VA_FOURCC_IYUV;
+        bool b_swap_uv = i_fourcc == VA_FOURCC_YV12;
         uint8_t *pp_plane[3];
         size_t  pi_pitch[3];
 
@@ -121,7 +222,8 @@ static int Extract( vlc_va_t *va, picture_t *p_picture, uint8_t *data )
             pp_plane[i] = (uint8_t*)p_base + image.offsets[i_src_plane];
             pi_pitch[i] = image.pitches[i_src_plane];
         }
-        CopyFromYv12( p_picture, pp_plane, pi_pitch, sys->height, &sys->image_cache );
+        CopyFromI420ToNv12( p_picture, pp_plane, pi_pitch, sys->height,
+                            &sys->image_cache );
     }
     else
     {
@@ -134,7 +236,8 @@ static int Extract( vlc_va_t *va, picture_t *p_picture, uint8_t *data )
             pp_plane[i] = (uint8_t*)p_base + image.offsets[i];
             pi_pitch[i] = image.pitches[i];
         }
-        CopyFromNv12( p_picture, pp_plane, pi_pitch, sys->height, &sys->image_cache );
+        CopyFromNv12ToNv12( p_picture, pp_plane, pi_pitch, sys->height,
+                            &sys->image_cache );
     }
 
     vaUnmapBuffer(sys->hw_ctx.display, image.buf);
@@ -196,13 +299,7 @@ static void Delete( vlc_va_t *va, AVCodecContext *avctx )
     vaDestroyContext(sys->hw_ctx.display, sys->hw_ctx.context_id);
     vaDestroySurfaces(sys->hw_ctx.display, sys->surfaces, sys->count);
     vaDestroyConfig(sys->hw_ctx.display, sys->hw_ctx.config_id);
-    vaTerminate(sys->hw_ctx.display);
-#ifdef VLC_VA_BACKEND_XLIB
-    XCloseDisplay( sys->p_display_x11 );
-#endif
-#ifdef VLC_VA_BACKEND_DRM
-    vlc_close( sys->drm_fd );
-#endif
+    DisplayRelease(va, sys->count);
     free( sys );
 }
 
@@ -246,9 +343,11 @@ static int FindFormat(vlc_va_sys_t *sys)
         if (val != VA_STATUS_SUCCESS)
             continue;
 
-        /* Mark NV12 as supported, but favor other formats first */
+        /* Favor NV12: it is the native format of the surfaces, and the
+         * output format of the decoder (a plain copy, and with vaDeriveImage,
+         * no conversion on the GPU either) */
         sys->format = fmts[i];
-        if (fourcc != VA_FOURCC_NV12)
+        if (fourcc == VA_FOURCC_NV12)
             break;
     }
 
@@ -344,39 +443,10 @@ static int Create( vlc_va_t *va, AVCodecContext *ctx, enum PixelFormat pix_fmt,
     assert(count < sizeof (sys->available) * CHAR_BIT);
     assert(count * sizeof (sys->surfaces[0]) <= sizeof (sys->surfaces));
 
-    /* Create a VA display */
-#ifdef VLC_VA_BACKEND_XLIB
-    sys->p_display_x11 = XOpenDisplay(NULL);
-    if( !sys->p_display_x11 )
-    {
-        msg_Err( va, "Could not connect to X server" );
-        goto error;
-    }
-
-    sys->hw_ctx.display = vaGetDisplay(sys->p_display_x11);
-#endif
-#ifdef VLC_VA_BACKEND_DRM
-    sys->drm_fd = vlc_open("/dev/dri/card0", O_RDWR);
-    if( sys->drm_fd == -1 )
-    {
-        msg_Err( va, "Could not access rendering device: %m" );
-        goto error;
-    }
-
-    sys->hw_ctx.display = vaGetDisplayDRM(sys->drm_fd);
-#endif
+    /* Get the VA display */
+    sys->hw_ctx.display = DisplayHold(va, sys->count);
     if (sys->hw_ctx.display == NULL)
-    {
-        msg_Err( va, "Could not get a VAAPI device" );
-        goto error;
-    }
-
-    int major, minor;
-    if (vaInitialize(sys->hw_ctx.display, &major, &minor))
-    {
-        msg_Err( va, "Failed to initialize the VAAPI device" );
         goto error;
-    }
 
     /* Check if the selected profile is supported */
     i_profiles_nb = vaMaxNumProfiles(sys->hw_ctx.display);
@@ -468,15 +538,7 @@ error:
     if (sys->hw_ctx.config_id != VA_INVALID_ID)
         vaDestroyConfig(sys->hw_ctx.display, sys->hw_ctx.config_id);
     if (sys->hw_ctx.display != NULL)
-        vaTerminate(sys->hw_ctx.display);
-#ifdef VLC_VA_BACKEND_XLIB
-    if( sys->p_display_x11 != NULL )
-        XCloseDisplay( sys->p_display_x11 );
-#endif
-#ifdef VLC_VA_BACKEND_DRM
-    if( sys->drm_fd != -1 )
-        vlc_close( sys->drm_fd );
-#endif
+        DisplayRelease(va, sys->count);
     free( sys );
     return VLC_EGENERIC;
 }
@@ -368,6 +368,12 @@ static int OpenVideoCodec( decoder_t *p_dec )
         case FF_THREAD_FRAME:
             msg_Dbg( p_dec, "using frame thread mode with %d threads",
                      p_sys->p_context->thread_count );
+            if( p_dec->fmt_in.video.i_frame_rate > 0 &&
+                p_dec->fmt_in.video.i_frame_rate_base > 0 )
+                msg_Dbg( p_dec, "frame threads delay the output by %"PRId64" ms",
+                         INT64_C(1000) * ( p_sys->p_context->thread_count - 1 ) *
+                         p_dec->fmt_in.video.i_frame_rate_base /
+                         p_dec->fmt_in.video.i_frame_rate );
             break;
         case FF_THREAD_SLICE:
             msg_Dbg( p_dec, "using slice thread mode with %d threads",
@@ -484,8 +490,16 @@ int InitVideoDec( decoder_t *p_dec, AVCodecContext *p_context,
         if( i_thread_count > 1 )
             i_thread_count++;
 
+        /* More threads only pay off with large pictures */
         //FIXME: take in count the decoding time
-        i_thread_count = __MIN( i_thread_count, 4 );
+        unsigned i_area = p_dec->fmt_in.video.i_width *
+                          p_dec->fmt_in.video.i_height;
+        if( i_area > 1920 * 1088 )
+            i_thread_count = __MIN( i_thread_count, 16 );
+        else if( i_area > 1280 * 720 )
+            i_thread_count = __MIN( i_thread_count, 8 );
+        else
+            i_thread_count = __MIN( i_thread_count, 4 );
     }
     i_thread_count = __MIN( i_thread_count, 16 );
     msg_Dbg( p_dec, "allowing %d thread(s) for decoding", i_thread_count );
@@ -512,6 +526,18 @@ int InitVideoDec( decoder_t *p_dec, AVCodecContext *p_context,
             break;
     }
 
+    switch( var_InheritInteger( p_dec, "avcodec-threads-type" ) )
+    {
+        case 1:
+            p_context->thread_type &= ~FF_THREAD_SLICE;
+            break;
+        case 2:
+            p_context->thread_type &= ~FF_THREAD_FRAME;
+            break;
+        default:
+            break;
+    }
+
     if( p_context->thread_type & FF_THREAD_FRAME )
         p_dec->i_extra_picture_buffers = 2 * p_context->thread_count;
 #endif
@@ -1161,8 +1187,16 @@ static int lavc_dr_GetFrame(struct AVCodecContext *ctx, AVFrame *frame,
     avcodec_align_dimensions2(ctx, &width, &height, aligns);
 
     /* Check that the picture is suitable for libavcodec */
-    assert(pic->p[0].i_pitch >= width * pic->p[0].i_pixel_pitch);
-    assert(pic->p[0].i_lines >= height);
+    if (pic->p[0].i_pitch < width * pic->p[0].i_pixel_pitch
+     || pic->p[0].i_lines < height)
+    {
+        if (!atomic_exchange(&sys->b_dr_failure, true))
+            msg_Warn(dec, "plane 0: too small (%dx%d < %dx%d): %s",
+                     pic->p[0].i_pitch / pic->p[0].i_pixel_pitch,
+                     pic->p[0].i_lines, width, height,
+                     "disabling direct rendering");
+        goto error;
+    }
 
     for (int i = 0; i < pic->i_planes; i++)
     {
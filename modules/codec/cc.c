@@ -195,6 +195,9 @@ typedef struct
     eia608_font_t font;
     int i_row_rollup;
 
+    /* Rows of the displayed screen modified since the last subpicture */
+    uint32_t i_dirty_rows;
+
     /* Last command pair (used to reject duplicated command) */
     struct
     {
@@ -210,6 +213,8 @@ static text_segment_t *Eia608Text( eia608_t *h );
 /* It will be enough up to 63 B frames, which is far too high for
  * broadcast environment */
 #define CC_MAX_REORDER_SIZE (64)
+/* Unchanged captions are sent again before their 10s lifetime ends */
+#define CC_REFRESH_DELAY (5 * CLOCK_FREQ)
 struct decoder_sys_t
 {
     int     i_block;
@@ -220,6 +225,7 @@ struct decoder_sys_t
     int i_channel;
 
     mtime_t i_display_time;
+    mtime_t i_last_spu;
 
     eia608_t eia608;
     bool b_opaque;
@@ -290,6 +296,7 @@ static void Flush( decoder_t *p_dec )
 
     Eia608Init( &p_sys->eia608 );
     p_sys->i_display_time = VLC_TS_INVALID;
+    p_sys->i_last_spu = VLC_TS_INVALID;
 }
 
 /****************************************************************************
@@ -495,6 +502,17 @@ static subpicture_t *Convert( decoder_t *p_dec, block_t **pp_block )
      */
     if( i_status & (EIA608_STATUS_DISPLAY | EIA608_STATUS_CHANGED) )
     {
+        /* Most changes target the hidden screen (pop-on captions being
+         * loaded) or leave the displayed rows as they were: do not make the
+         * text renderer lay out the same caption again for those */
+        if( p_sys->eia608.i_dirty_rows == 0 &&
+            p_sys->i_last_spu > VLC_TS_INVALID &&
+            i_pts >= p_sys->i_last_spu &&
+            i_pts - p_sys->i_last_spu < CC_REFRESH_DELAY )
+            return NULL;
+
+        p_sys->eia608.i_dirty_rows = 0;
+        p_sys->i_last_spu = i_pts;
         text_segment_t *p_segments = Eia608Text( &p_sys->eia608 );
         return Subtitle( p_dec, p_segments, i_pts );
     }
@@ -505,6 +523,11 @@ static subpicture_t *Convert( decoder_t *p_dec, block_t **pp_block )
 /*****************************************************************************
  *
  *****************************************************************************/
+static void Eia608SetDirty( eia608_t *h, int i_screen, int i_row )
+{
+    if( i_screen == h->i_screen )
+        h->i_dirty_rows |= 1u << i_row;
+}
 static void Eia608Cursor( eia608_t *h, int dx )
 {
     h->cursor.i_column += dx;
@@ -517,6 +540,10 @@ static void Eia608ClearScreenRowX( eia608_t *h, int i_screen, int i_row, int x )
 {
     eia608_screen *screen = &h->screen[i_screen];
 
+    /* An unused row is blank already */
+    if( screen->row_used[i_row] )
+        Eia608SetDirty( h, i_screen, i_row );
+
     if( x == 0 )
     {
         screen->row_used[i_row] = false;
@@ -583,13 +610,18 @@ static void Eia608Write( eia608_t *h, const uint8_t c )
 {
     const int i_row = h->cursor.i_row;
     const int i_column = h->cursor.i_column;
+    const int i_screen = Eia608GetWritingScreenIndex( h );
     eia608_screen *screen;
 
     if( h->mode == EIA608_MODE_TEXT )
         return;
 
-    screen = &h->screen[Eia608GetWritingScreenIndex( h )];
+    screen = &h->screen[i_screen];
 
+    if( screen->characters[i_row][i_column] != c ||
+        screen->colors[i_row][i_column] != h->color ||
+        screen->fonts[i_row][i_column] != h->font )
+        Eia608SetDirty( h, i_screen, i_row );
     screen->characters[i_row][i_column] = c;
     screen->colors[i_row][i_column] = h->color;
     screen->fonts[i_row][i_column] = h->font;
@@ -607,9 +639,12 @@ static void Eia608Erase( eia608_t *h )
     if( i_column < 0 )
         return;
 
-    screen = &h->screen[Eia608GetWritingScreenIndex( h )];
+    const int i_screen = Eia608GetWritingScreenIndex( h );
+    screen = &h->screen[i_screen];
 
     /* FIXME do we need to reset row_used/colors/font ? */
+    if( screen->characters[i_row][i_column] != ' ' )
+        Eia608SetDirty( h, i_screen, i_row );
     screen->characters[i_row][i_column] = ' ';
     Eia608Cursor( h, -1 );
 }
@@ -655,6 +690,8 @@ static void Eia608RollUp( eia608_t *h )
         if( i_row < 0 )
             continue;
         assert( i_row+1 < EIA608_SCREEN_ROWS );
+        if( screen->row_used[i_row] || screen->row_used[i_row+1] )
+            Eia608SetDirty( h, i_screen, i_row );
         memcpy( screen->characters[i_row], screen->characters[i_row+1], sizeof(*screen->characters) );
         memcpy( screen->colors[i_row], screen->colors[i_row+1], sizeof(*screen->colors) );
         memcpy( screen->fonts[i_row], screen->fonts[i_row+1], sizeof(*screen->fonts) );
@@ -787,7 +824,10 @@ static eia608_status_t Eia608ParseCommand0x14( eia608_t *h, uint8_t d2 )
         break;
     case 0x2f: /* End of caption (flip screen if not paint on) */
         if( h->mode != EIA608_MODE_PAINTON )
+        {
             h->i_screen = 1 - h->i_screen;
+            h->i_dirty_rows = (1u << EIA608_SCREEN_ROWS) - 1;
+        }
         h->mode = EIA608_MODE_POPUP;
         h->cursor.i_column = 0;
         h->cursor.i_row = 0;
@@ -1138,6 +1178,7 @@ static void Eia608Init( eia608_t *h )
     h->i_screen = 0;
     Eia608ClearScreen( h, 0 );
     Eia608ClearScreen( h, 1 );
+    h->i_dirty_rows = (1u << EIA608_SCREEN_ROWS) - 1;
 
     /* Cursor for writing text */
     h->cursor.i_column = 0;
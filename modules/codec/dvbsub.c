@@ -78,6 +78,8 @@
 
 #include <vlc_bits.h>
 
+#include <assert.h>
+
 /* #define DEBUG_DVBSUB 1 */
 
 #define POSX_TEXT N_("Decoding X coordinate")
@@ -159,6 +161,7 @@ typedef struct dvbsub_objectdef_s
     int i_y;
     int i_fg_pc;
     int i_bg_pc;
+    int i_version; /* of the object data last rendered, -1 if none */
     char *psz_text; /* for string of characters objects */
 
 } dvbsub_objectdef_t;
@@ -983,6 +986,7 @@ static void decode_region_composition( decoder_t *p_dec, bs_t *s )
         p_obj->i_x          = bs_read( s, 12 );
         bs_skip( s, 4 ); /* Reserved */
         p_obj->i_y          = bs_read( s, 12 );
+        p_obj->i_version    = -1;
         p_obj->psz_text     = NULL;
 
         i_processed_length += 6;
@@ -1074,14 +1078,14 @@ static void decode_object( decoder_t *p_dec, bs_t *s )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
     dvbsub_region_t *p_region;
-    int i_segment_length, i_coding_method, i_id, i;
+    int i_segment_length, i_coding_method, i_id, i_version, i;
 
     /* ETSI 300-743 paragraph 7.2.4
      * sync_byte, segment_type and page_id have already been processed.
      */
     i_segment_length = bs_read( s, 16 );
     i_id             = bs_read( s, 16 );
-    bs_skip( s, 4 ); /* version */
+    i_version        = bs_read( s, 4 );
     i_coding_method  = bs_read( s, 2 );
 
     if( i_coding_method > 1 )
@@ -1092,12 +1096,15 @@ static void decode_object( decoder_t *p_dec, bs_t *s )
     }
 
     /* Check if the object needs to be rendered in at least one
-     * of the regions */
+     * of the regions. Objects are repeated in every display set: the
+     * regions keep their pixels, so an object which was already rendered
+     * with this version does not need to be decoded again. */
     for( p_region = p_sys->p_regions; p_region != NULL;
          p_region = p_region->p_next )
     {
         for( i = 0; i < p_region->i_object_defs; i++ )
-            if( p_region->p_object_defs[i].i_id == i_id ) break;
+            if( p_region->p_object_defs[i].i_id == i_id &&
+                p_region->p_object_defs[i].i_version != i_version ) break;
 
         if( i != p_region->i_object_defs ) break;
     }
@@ -1139,7 +1146,10 @@ static void decode_object( decoder_t *p_dec, bs_t *s )
         {
             for( i = 0; i < p_region->i_object_defs; i++ )
             {
-                if( p_region->p_object_defs[i].i_id != i_id ) continue;
+                if( p_region->p_object_defs[i].i_id != i_id ||
+                    p_region->p_object_defs[i].i_version == i_version )
+                    continue;
+                p_region->p_object_defs[i].i_version = i_version;
 
                 dvbsub_render_pdata( p_dec, p_region,
                                      p_region->p_object_defs[i].i_x,
@@ -1185,7 +1195,10 @@ static void decode_object( decoder_t *p_dec, bs_t *s )
             {
                 int j;
 
-                if( p_region->p_object_defs[i].i_id != i_id ) continue;
+                if( p_region->p_object_defs[i].i_id != i_id ||
+                    p_region->p_object_defs[i].i_version == i_version )
+                    continue;
+                p_region->p_object_defs[i].i_version = i_version;
 
                 p_region->p_object_defs[i].psz_text =
                     xrealloc( p_region->p_object_defs[i].psz_text,
@@ -1407,13 +1420,18 @@ static void dvbsub_pdata4bpp( bs_t *s, uint8_t *p, int i_width, int *pi_off )
 
 static void dvbsub_pdata8bpp( bs_t *s, uint8_t *p, int i_width, int *pi_off )
 {
-    bool b_stop = false;
+    /* All the 8-bit pixel codes are made of whole bytes, so they are read
+     * directly instead of through the bitstream reader */
+    const uint8_t *p_data = s->p;
+    const uint8_t *p_end = s->p_end;
 
-    while( !b_stop && !bs_eof( s ) )
+    assert( bs_aligned( s ) );
+
+    while( p_data < p_end )
     {
-        int i_count = 0, i_color = 0;
+        int i_count, i_color;
 
-        i_color = bs_read( s, 8 );
+        i_color = *p_data++;
         if( i_color != 0x00 )
         {
             /* Add 1 pixel */
@@ -1421,22 +1439,21 @@ static void dvbsub_pdata8bpp( bs_t *s, uint8_t *p, int i_width, int *pi_off )
         }
         else
         {
-            if( bs_read( s, 1 ) == 0x00 )           // Switch1
+            if( p_data >= p_end )
+                break;
+
+            const uint8_t i_code = *p_data++;
+            i_count = i_code & 0x7f;
+            if( !( i_code & 0x80 ) )                // Switch1
             {
-                if( bs_show( s, 7 ) != 0x00 )
-                {
-                    i_count = bs_read( s, 7 );
-                }
-                else
-                {
-                    bs_skip( s, 7 );
-                    b_stop = true;
-                }
+                if( i_count == 0 )
+                    break; /* end of string */
             }
             else
             {
-                i_count = bs_read( s, 7 );
-                i_color = bs_read( s, 8 );
+                if( p_data >= p_end )
+                    break;
+                i_color = *p_data++;
             }
         }
 
@@ -1451,7 +1468,7 @@ static void dvbsub_pdata8bpp( bs_t *s, uint8_t *p, int i_width, int *pi_off )
         (*pi_off) += i_count;
     }
 
-    bs_align( s );
+    s->p = (uint8_t *)p_data;
 }
 
 static void free_all( decoder_t *p_dec )
@@ -437,6 +437,24 @@ static picture_t *DecodeBlock(decoder_t *p_dec, block_t **pp_block)
 
     p_sys->p_jpeg.out_color_space = JCS_RGB;
 
+    /* When decoding for the image handler, let libjpeg scale down in the
+     * DCT domain (by up to 8) while the picture stays at least as large
+     * as wanted. This is much faster than decoding fully and scaling. */
+    unsigned i_wanted_width = var_GetInteger(p_dec, "image-output-width");
+    unsigned i_wanted_height = var_GetInteger(p_dec, "image-output-height");
+    if (i_wanted_width || i_wanted_height)
+    {
+        unsigned i_denom = 1;
+        while (i_denom < 8 &&
+               (!i_wanted_width ||
+                p_sys->p_jpeg.image_width >= 2 * i_denom * i_wanted_width) &&
+               (!i_wanted_height ||
+                p_sys->p_jpeg.image_height >= 2 * i_denom * i_wanted_height))
+            i_denom *= 2;
+        p_sys->p_jpeg.scale_num = 1;
+        p_sys->p_jpeg.scale_denom = i_denom;
+    }
+
     jpeg_start_decompress(&p_sys->p_jpeg);
 
     /* Set output properties */
@@ -684,26 +684,36 @@ static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img )
         const unsigned g = (p_img->color >> 16)&0xff;
         const unsigned b = (p_img->color >>  8)&0xff;
         const unsigned a = (p_img->color      )&0xff;
-        int x, y;
 
-        for( y = 0; y < p_img->h; y++ )
+        /* Fully transparent images do not change the region */
+        if( a == 0xff )
+            continue;
+
+        for( int y = 0; y < p_img->h; y++ )
         {
-            for( x = 0; x < p_img->w; x++ )
+            const uint8_t *p_alpha = &p_img->bitmap[y * p_img->stride];
+            uint8_t *p_rgba = &p->p_pixels[(y+p_img->dst_y-i_y) * p->i_pitch +
+                                           4 * (p_img->dst_x-i_x)];
+
+            for( int x = 0; x < p_img->w; x++, p_rgba += 4 )
             {
-                const unsigned alpha = p_img->bitmap[y*p_img->stride+x];
-                const unsigned an = (255 - a) * alpha / 255;
+                const unsigned alpha = p_alpha[x];
+                /* Most of a glyph bitmap is empty, and blending with a null
+                 * alpha would only lose precision */
+                if( alpha == 0 )
+                    continue;
 
-                uint8_t *p_rgba = &p->p_pixels[(y+p_img->dst_y-i_y) * p->i_pitch + 4 * (x+p_img->dst_x-i_x)];
+                const unsigned an = (255 - a) * alpha / 255;
                 const unsigned ao = p_rgba[3];
 
                 /* Native endianness, but RGBA ordering */
-                if( ao == 0 )
+                if( ao == 0 || an == 255 )
                 {
                     /* Optimized but the else{} will produce the same result */
                     p_rgba[0] = r;
                     p_rgba[1] = g;
                     p_rgba[2] = b;
-                    p_rgba[3] = an;
+                    p_rgba[3] = ao == 0 ? an : 255;
                 }
                 else
                 {
@@ -118,6 +118,8 @@ struct decoder_sys_t
             AWindowHandler *p_awh;
             unsigned int i_stride, i_slice_height, i_width, i_height;
             int i_pixel_format;
+            /* SSE2 copy cache used for ByteBuffer output */
+            ArchitectureSpecificCopyData ascd;
             uint8_t i_nal_length_size;
             size_t i_h264_profile;
             /* stores the inflight picture for each output buffer or NULL */
@@ -869,6 +871,8 @@ static void CleanDecoder(decoder_t *p_dec)
             timestamp_FifoRelease(p_sys->u.video.timestamp_fifo);
         if (p_sys->u.video.p_awh)
             AWindowHandler_destroy(p_sys->u.video.p_awh);
+        ArchitectureSpecificCopyHooksDestroy(p_sys->u.video.i_pixel_format,
+                                             &p_sys->u.video.ascd);
     }
     free(p_sys->api);
     free(p_sys);
@@ -995,7 +999,8 @@ static int Video_ProcessOutput(decoder_t *p_dec, mc_api_out *p_out,
                               NULL, NULL, &chroma_div);
             CopyOmxPicture(p_sys->u.video.i_pixel_format, p_pic,
                            p_sys->u.video.i_slice_height, p_sys->u.video.i_stride,
-                           (uint8_t *)p_out->u.buf.p_ptr, chroma_div, NULL);
+                           (uint8_t *)p_out->u.buf.p_ptr, chroma_div,
+                           &p_sys->u.video.ascd);
 
             if (p_sys->api->release_out(p_sys->api, p_out->u.buf.i_index, false))
             {
@@ -1008,6 +1013,8 @@ static int Video_ProcessOutput(decoder_t *p_dec, mc_api_out *p_out,
         return 1;
     } else {
         assert(p_out->type == MC_OUT_TYPE_CONF);
+        ArchitectureSpecificCopyHooksDestroy(p_sys->u.video.i_pixel_format,
+                                             &p_sys->u.video.ascd);
         p_sys->u.video.i_pixel_format = p_out->u.conf.video.pixel_format;
 
         const char *name = "unknown";
@@ -1053,6 +1060,14 @@ static int Video_ProcessOutput(decoder_t *p_dec, mc_api_out *p_out,
             p_sys->u.video.i_stride = p_dec->fmt_out.video.i_width;
         }
 
+        /* Output buffers can be read with streaming loads and converted to
+         * planar in the same pass (NV12 only, needs SSE2) */
+        if (!p_sys->api->b_direct_rendering && p_sys->u.video.i_slice_height > 0)
+            ArchitectureSpecificCopyHooks(p_dec, p_sys->u.video.i_pixel_format,
+                                          p_sys->u.video.i_slice_height,
+                                          p_sys->u.video.i_stride,
+                                          &p_sys->u.video.ascd);
+
         if (decoder_UpdateVideoFormat(p_dec) != 0)
         {
             msg_Err(p_dec, "decoder_UpdateVideoFormat failed");
@@ -235,11 +235,22 @@ void CopyOmxPicture( int i_color_format, picture_t *p_pic,
         i_dst_stride = p_pic->p[i_plane].i_pitch;
         i_width = p_pic->p[i_plane].i_visible_pitch;
 
-        for( i_line = 0; i_line < p_pic->p[i_plane].i_visible_lines; i_line++ )
+        /* Same layout on both sides: copy the plane at once */
+        if( i_src_stride == i_dst_stride )
         {
-            memcpy( p_dst, p_src, i_width );
-            p_src += i_src_stride;
-            p_dst += i_dst_stride;
+            const int i_lines = p_pic->p[i_plane].i_visible_lines;
+            if( i_lines > 0 )
+                memcpy( p_dst, p_src, (size_t)i_src_stride * (i_lines - 1) + i_width );
+            p_src += (ptrdiff_t)i_src_stride * i_lines;
+        }
+        else
+        {
+            for( i_line = 0; i_line < p_pic->p[i_plane].i_visible_lines; i_line++ )
+            {
+                memcpy( p_dst, p_src, i_width );
+                p_src += i_src_stride;
+                p_dst += i_dst_stride;
+            }
         }
         /* Handle plane height, which may be indicated via nSliceHeight in OMX.
          * The handling for chroma planes currently assumes vertically
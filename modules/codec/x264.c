@@ -414,6 +414,16 @@ static void x264_log( void *, int i_level, const char *psz, va_list );
 #define LOOKAHEAD_LONGTEXT N_("Framecount to use on frametype lookahead. " \
     "Currently default can cause sync-issues on unmuxable output, like rtsp-output without ts-mux" )
 
+#define SLICED_THREADS_TEXT N_("Sliced threads")
+#define SLICED_THREADS_LONGTEXT N_("Split each frame into slices encoded by " \
+    "separate threads instead of encoding several frames in parallel. " \
+    "This lowers the encoding latency to about one frame, at the cost of " \
+    "some efficiency, and is useful for live streaming." )
+
+#define LOOKAHEAD_THREADS_TEXT N_("Lookahead threads")
+#define LOOKAHEAD_THREADS_LONGTEXT N_("Number of threads used for the " \
+    "frametype lookahead (0 = auto)." )
+
 #define HRD_TEXT N_("HRD-timing information")
 #define TUNE_TEXT N_("Default tune setting used" )
 #define PRESET_TEXT N_("Default preset setting used" )
@@ -689,6 +699,15 @@ vlc_module_begin ()
                  LOOKAHEAD_LONGTEXT, true )
         change_integer_range( 0, 60 )
 
+#if X264_BUILD >= 142
+    add_integer( SOUT_CFG_PREFIX "lookahead-threads", 0, LOOKAHEAD_THREADS_TEXT,
+                 LOOKAHEAD_THREADS_LONGTEXT, true )
+        change_integer_range( 0, 16 )
+#endif
+
+    add_bool( SOUT_CFG_PREFIX "sliced-threads", false, SLICED_THREADS_TEXT,
+              SLICED_THREADS_LONGTEXT, true )
+
     add_bool( SOUT_CFG_PREFIX "intra-refresh", false, INTRAREFRESH_TEXT,
               INTRAREFRESH_LONGTEXT, true )
 
@@ -775,7 +794,7 @@ static const char *const ppsz_sout_options[] = {
     "aq-mode", "aq-strength", "psy-rd", "psy", "profile", "lookahead", "slices",
     "slice-max-size", "slice-max-mbs", "intra-refresh", "mbtree", "hrd",
     "tune","preset", "opengop", "bluray-compat", "frame-packing", "options",
-    "fullrange",
+    "fullrange", "sliced-threads", "lookahead-threads",
     NULL
 };
 
@@ -788,6 +807,11 @@ struct encoder_sys_t
 
     mtime_t         i_initial_delay;
 
+    /* encoding latency statistics */
+    mtime_t         i_latency_total;
+    mtime_t         i_latency_max;
+    unsigned        i_latency_count;
+
     char            *psz_stat_name;
     int             i_sei_size;
     uint32_t         i_colorspace;
@@ -897,6 +921,9 @@ static int  Open ( vlc_object_t *p_this )
     p_enc->pf_encode_video = Encode;
     p_enc->pf_encode_audio = NULL;
     p_sys->i_initial_delay = 0;
+    p_sys->i_latency_total = 0;
+    p_sys->i_latency_max = 0;
+    p_sys->i_latency_count = 0;
     p_sys->psz_stat_name = NULL;
     p_sys->i_sei_size = 0;
     p_sys->p_sei = NULL;
@@ -1377,6 +1404,18 @@ static int  Open ( vlc_object_t *p_this )
        default unless ofcourse transcode threads is explicitly specified.. */
     p_sys->param.i_threads = p_enc->i_threads;
 
+    /* Sliced threads encode each frame with all the threads, so that no
+       frame is held back waiting for a free frame thread. Combined with
+       crf, vbv-maxrate and intra-refresh this gives a live profile with
+       roughly one frame of encoding latency. */
+    if( var_GetBool( p_enc, SOUT_CFG_PREFIX "sliced-threads" ) )
+        p_sys->param.b_sliced_threads = 1;
+#if X264_BUILD >= 142
+    i_val = var_GetInteger( p_enc, SOUT_CFG_PREFIX "lookahead-threads" );
+    if( i_val > 0 )
+        p_sys->param.i_lookahead_threads = i_val;
+#endif
+
     psz_val = var_GetString( p_enc, SOUT_CFG_PREFIX "stats" );
     if( psz_val )
     {
@@ -1549,7 +1588,14 @@ static block_t *Encode( encoder_t *p_enc, picture_t *p_pict )
            pic.img.i_stride[i] = p_pict->p[i].i_pitch;
        }
 
+       mtime_t i_start = mdate();
        x264_encoder_encode( p_sys->h, &nal, &i_nal, &pic, &pic );
+       mtime_t i_latency = mdate() - i_start;
+
+       p_sys->i_latency_total += i_latency;
+       p_sys->i_latency_count++;
+       if( i_latency > p_sys->i_latency_max )
+           p_sys->i_latency_max = i_latency;
     } else {
        if( x264_encoder_delayed_frames( p_sys->h ) ) {
            x264_encoder_encode( p_sys->h, &nal, &i_nal, NULL, &pic );
@@ -1615,6 +1661,12 @@ static void Close( vlc_object_t *p_this )
     free( p_sys->psz_stat_name );
     free( p_sys->p_sei );
 
+    if( p_sys->i_latency_count > 0 )
+        msg_Dbg( p_enc, "encoding latency: %"PRId64" us average, "
+                 "%"PRId64" us max over %u frames",
+                 p_sys->i_latency_total / p_sys->i_latency_count,
+                 p_sys->i_latency_max, p_sys->i_latency_count );
+
     if( p_sys->h )
     {
         msg_Dbg( p_enc, "framecount still in libx264 buffer: %d", x264_encoder_delayed_frames( p_sys->h ) );
@@ -374,16 +374,20 @@ static subpicture_t *Decode( decoder_t *p_dec, block_t **pp_block )
     const unsigned int i_level = p_sys->i_level > 3 ? 3 : p_sys->i_level;
     vlc_mutex_unlock( &p_sys->lock );
 
-    /* Try to see if the page we want is in the cache yet */
     memset( &p_page, 0, sizeof(vbi_page) );
+
+    /* The VBI decoder keeps every received page in its cache: only format
+     * and render the wanted page when it was switched to or retransmitted
+     * with new content, not for each teletext packet */
+    if( i_wanted_page == p_sys->i_last_page && !p_sys->b_update )
+        goto error;
+
+    /* Try to see if the page we want is in the cache yet */
     b_cached = vbi_fetch_vt_page( p_sys->p_vbi_dec, &p_page,
                                   vbi_dec2bcd( i_wanted_page ),
                                   i_wanted_subpage, level_zvbi_values[i_level],
                                   25, true );
 
-    if( i_wanted_page == p_sys->i_last_page && !p_sys->b_update )
-        goto error;
-
     if( !b_cached )
     {
         if( p_sys->b_text && p_sys->i_last_page != i_wanted_page )
@@ -0,0 +1,251 @@
+/*****************************************************************************
+ * metrics.c: OpenMetrics statistics exporter
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_interface.h>
+#include <vlc_playlist.h>
+#include <vlc_input.h>
+#include <vlc_httpd.h>
+#include <vlc_memstream.h>
+
+#define URL_TEXT N_("Metrics URL")
+#define URL_LONGTEXT N_( \
+    "Path of the HTTP resource serving the statistics. The HTTP host and " \
+    "port are set with the --http-host and --http-port options." )
+#define USER_TEXT N_("User name")
+#define USER_LONGTEXT N_("User name required to read the statistics.")
+#define PASS_TEXT N_("Password")
+#define PASS_LONGTEXT N_("Password required to read the statistics.")
+
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+
+vlc_module_begin ()
+    set_shortname( N_("Metrics") )
+    set_description( N_("OpenMetrics statistics exporter") )
+    set_category( CAT_INTERFACE )
+    set_subcategory( SUBCAT_INTERFACE_CONTROL )
+    set_capability( "interface", 0 )
+    set_callbacks( Open, Close )
+    add_string( "metrics-url", "/metrics", URL_TEXT, URL_LONGTEXT, true )
+    add_string( "metrics-user", NULL, USER_TEXT, USER_LONGTEXT, true )
+    add_password( "metrics-password", NULL, PASS_TEXT, PASS_LONGTEXT, true )
+vlc_module_end ()
+
+struct httpd_file_sys_t
+{
+    intf_thread_t *p_intf;
+};
+
+struct intf_sys_t
+{
+    httpd_host_t     *p_host;
+    httpd_file_t     *p_file;
+    httpd_file_sys_t  file_sys;
+};
+
+static void PrintHeader( struct vlc_memstream *ms, const char *name,
+                         const char *type, const char *help )
+{
+    vlc_memstream_printf( ms, "# TYPE vlc_%s %s\n", name, type );
+    vlc_memstream_printf( ms, "# HELP vlc_%s %s\n", name, help );
+}
+
+static void PrintInt( struct vlc_memstream *ms, const char *name,
+                      const char *type, const char *help, int64_t value )
+{
+    PrintHeader( ms, name, type, help );
+    vlc_memstream_printf( ms, "vlc_%s %"PRId64"\n", name, value );
+}
+
+static void PrintFloat( struct vlc_memstream *ms, const char *name,
+                        const char *help, double value )
+{
+    PrintHeader( ms, name, "gauge", help );
+    vlc_memstream_printf( ms, "vlc_%s %f\n", name, value );
+}
+
+static void PrintSeconds( struct vlc_memstream *ms, const char *name,
+                          const char *help, mtime_t value )
+{
+    PrintHeader( ms, name, "counter", help );
+    vlc_memstream_printf( ms, "vlc_%s %f\n", name,
+                          (double)value / CLOCK_FREQ );
+}
+
+static void PrintStats( struct vlc_memstream *ms, const input_stats_t *st )
+{
+    /* The bit rates are stored in bytes per microsecond */
+    PrintInt( ms, "input_read_packets", "counter",
+              "Packets read by the access", st->i_read_packets );
+    PrintInt( ms, "input_read_bytes", "counter",
+              "Bytes read by the access", st->i_read_bytes );
+    PrintInt( ms, "input_lost_packets", "counter",
+              "Packets lost before reaching the access", st->i_read_lost );
+    PrintFloat( ms, "input_bitrate_bytes_per_second",
+                "Input bit rate", st->f_input_bitrate * CLOCK_FREQ );
+    PrintSeconds( ms, "input_cpu_seconds",
+                  "CPU time of the input thread", st->i_input_cpu_time );
+
+    PrintInt( ms, "demux_read_packets", "counter",
+              "Packets read by the demuxer", st->i_demux_read_packets );
+    PrintInt( ms, "demux_read_bytes", "counter",
+              "Bytes read by the demuxer", st->i_demux_read_bytes );
+    PrintFloat( ms, "demux_bitrate_bytes_per_second",
+                "Demuxer bit rate", st->f_demux_bitrate * CLOCK_FREQ );
+    PrintInt( ms, "demux_corrupted_packets", "counter",
+              "Corrupted packets", st->i_demux_corrupted );
+    PrintInt( ms, "demux_discontinuities", "counter",
+              "Discontinuities", st->i_demux_discontinuity );
+
+    PrintInt( ms, "decoded_audio_blocks", "counter",
+              "Audio blocks decoded", st->i_decoded_audio );
+    PrintInt( ms, "decoded_video_blocks", "counter",
+              "Video blocks decoded", st->i_decoded_video );
+    PrintSeconds( ms, "audio_decoder_cpu_seconds",
+                  "CPU time of the audio decoders",
+                  st->i_audio_decoder_cpu_time );
+    PrintSeconds( ms, "video_decoder_cpu_seconds",
+                  "CPU time of the video decoders",
+                  st->i_video_decoder_cpu_time );
+
+    PrintInt( ms, "vout_displayed_pictures", "counter",
+              "Pictures displayed", st->i_displayed_pictures );
+    PrintInt( ms, "vout_lost_pictures", "counter",
+              "Pictures lost", st->i_lost_pictures );
+
+    PrintInt( ms, "aout_played_buffers", "counter",
+              "Audio buffers played", st->i_played_abuffers );
+    PrintInt( ms, "aout_lost_buffers", "counter",
+              "Audio buffers lost", st->i_lost_abuffers );
+
+    PrintInt( ms, "sout_sent_packets", "counter",
+              "Packets sent by the stream output", st->i_sent_packets );
+    PrintInt( ms, "sout_sent_bytes", "counter",
+              "Bytes sent by the stream output", st->i_sent_bytes );
+    PrintFloat( ms, "sout_bitrate_bytes_per_second",
+                "Stream output bit rate", st->f_send_bitrate * CLOCK_FREQ );
+}
+
+static int Fill( httpd_file_sys_t *p_file_sys, httpd_file_t *p_file,
+                 uint8_t *psz_request, uint8_t **pp_data, int *pi_data )
+{
+    intf_thread_t *p_intf = p_file_sys->p_intf;
+    struct vlc_memstream ms;
+
+    VLC_UNUSED(p_file); VLC_UNUSED(psz_request);
+
+    vlc_memstream_open( &ms );
+
+    /* The input thread refreshes the statistics of its item once per second:
+     * only that snapshot is read, not the counters of the running input. */
+    input_thread_t *p_input = playlist_CurrentInput( pl_Get(p_intf) );
+    input_stats_t *p_stats = NULL;
+    if( p_input != NULL )
+    {
+        input_item_t *p_item = input_GetItem( p_input );
+
+        /* The statistics are not freed before the item */
+        vlc_mutex_lock( &p_item->lock );
+        p_stats = p_item->p_stats;
+        vlc_mutex_unlock( &p_item->lock );
+        if( p_stats != NULL )
+            vlc_mutex_lock( &p_stats->lock );
+    }
+
+    PrintInt( &ms, "input_active", "gauge", "Whether an input is playing",
+              p_stats != NULL );
+    if( p_stats != NULL )
+    {
+        PrintStats( &ms, p_stats );
+        vlc_mutex_unlock( &p_stats->lock );
+    }
+    if( p_input != NULL )
+        vlc_object_release( p_input );
+
+    vlc_memstream_puts( &ms, "# EOF\n" );
+
+    if( vlc_memstream_close( &ms ) )
+    {
+        *pp_data = NULL;
+        *pi_data = 0;
+        return VLC_ENOMEM;
+    }
+    *pp_data = (uint8_t *)ms.ptr;
+    *pi_data = ms.length;
+    return VLC_SUCCESS;
+}
+
+static int Open( vlc_object_t *p_this )
+{
+    intf_thread_t *p_intf = (intf_thread_t *)p_this;
+    intf_sys_t *p_sys = malloc( sizeof( *p_sys ) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+
+    p_sys->p_host = vlc_http_HostNew( p_this );
+    if( p_sys->p_host == NULL )
+    {
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+
+    char *psz_url = var_InheritString( p_intf, "metrics-url" );
+    char *psz_user = var_InheritString( p_intf, "metrics-user" );
+    char *psz_pass = var_InheritString( p_intf, "metrics-password" );
+
+    p_sys->file_sys.p_intf = p_intf;
+    p_sys->p_file = httpd_FileNew( p_sys->p_host,
+                                   psz_url ? psz_url : "/metrics",
+                                   "application/openmetrics-text; "
+                                   "version=1.0.0; charset=utf-8",
+                                   psz_user, psz_pass, Fill,
+                                   &p_sys->file_sys );
+    free( psz_pass );
+    free( psz_user );
+    free( psz_url );
+
+    if( p_sys->p_file == NULL )
+    {
+        httpd_HostDelete( p_sys->p_host );
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+
+    p_intf->p_sys = p_sys;
+    return VLC_SUCCESS;
+}
+
+static void Close( vlc_object_t *p_this )
+{
+    intf_thread_t *p_intf = (intf_thread_t *)p_this;
+    intf_sys_t *p_sys = p_intf->p_sys;
+
+    httpd_FileDelete( p_sys->p_file );
+    httpd_HostDelete( p_sys->p_host );
+    free( p_sys );
+}
@@ -25,18 +25,23 @@
 
 #include "PlaylistManager.h"
 #include "SegmentTracker.hpp"
+#include "QoEMetrics.hpp"
 #include "playlist/AbstractPlaylist.hpp"
 #include "playlist/BasePeriod.h"
 #include "playlist/BaseAdaptationSet.h"
 #include "playlist/BaseRepresentation.h"
 #include "http/HTTPConnectionManager.h"
+#include "http/ConnectionParams.hpp"
 #include "logic/AlwaysBestAdaptationLogic.h"
 #include "logic/RateBasedAdaptationLogic.h"
 #include "logic/AlwaysLowestAdaptationLogic.hpp"
 #include "logic/PredictiveAdaptationLogic.hpp"
+#include "logic/BufferBasedAdaptationLogic.hpp"
+#include "logic/BandwidthCache.hpp"
 #include "tools/Debug.hpp"
 #include <vlc_stream.h>
 #include <vlc_demux.h>
+#include <vlc_input.h>
 #include <vlc_threads.h>
 
 #include <algorithm>
@@ -55,9 +60,11 @@ PlaylistManager::PlaylistManager( demux_t *p_demux_,
              logic          ( NULL ),
              playlist       ( pl ),
              streamFactory  ( factory ),
-             p_demux        ( p_demux_ )
+             p_demux        ( p_demux_ ),
+             metrics        ( NULL )
 {
     currentPeriod = playlist->getFirstPeriod();
+    playlist->setLowLatency(var_InheritBool(p_demux, "adaptive-lowlatency"));
     failedupdates = 0;
     b_thread = false;
     b_buffering = false;
@@ -82,6 +89,7 @@ PlaylistManager::~PlaylistManager   ()
     delete playlist;
     delete conManager;
     delete logic;
+    delete metrics;
     vlc_cond_destroy(&waitcond);
     vlc_mutex_destroy(&lock);
     vlc_mutex_destroy(&demux.lock);
@@ -112,9 +120,12 @@ bool PlaylistManager::setupPeriod()
         BaseAdaptationSet *set = *it;
         if(set && streamFactory)
         {
-            SegmentTracker *tracker = new (std::nothrow) SegmentTracker(logic, set);
+            SegmentTracker *tracker = new (std::nothrow) SegmentTracker(logic, set,
+                                            var_InheritInteger(p_demux, "adaptive-prefetch"));
             if(!tracker)
                 continue;
+            if(metrics)
+                tracker->registerListener(metrics);
 
             AbstractStream *st = streamFactory->create(p_demux, set->getStreamFormat(),
                                                        tracker, conManager);
@@ -152,9 +163,31 @@ bool PlaylistManager::start()
     if(!conManager && !(conManager = new (std::nothrow) HTTPConnectionManager(VLC_OBJECT(p_demux->s))))
         return false;
 
+    if(!metrics)
+    {
+        /* published on the input, if any, for applications to poll */
+        vlc_object_t *p_input = p_demux->p_input ? VLC_OBJECT(p_demux->p_input) : NULL;
+        metrics = new (std::nothrow) QoEMetrics(p_input);
+        if(metrics)
+        {
+            metrics->sessionStarted();
+            conManager->addDownloadRateObserver(metrics);
+        }
+    }
+
     if(!setupPeriod())
         return false;
 
+    /* Start from the bandwidth seen by previous sessions on the same origin */
+    const std::string origin = ConnectionParams(playlist->getUrlSegment().toString()).getHostname();
+    conManager->setOrigin(origin);
+    size_t bps = BandwidthCache::lookup(VLC_OBJECT(p_demux), origin);
+    if(bps)
+    {
+        msg_Dbg(p_demux, "using %zu KiB/s estimate for %s", bps / 8192, origin.c_str());
+        logic->setInitialBandwidth(bps);
+    }
+
     playlist->playbackStart.Set(time(NULL));
     nextPlaylistupdate = playlist->playbackStart.Get();
 
@@ -417,7 +450,11 @@ int PlaylistManager::doDemux(int64_t increment)
     }
 
     if(demux.i_firstpcr == VLC_TS_INVALID)
+    {
         demux.i_firstpcr = demux.i_nzpcr;
+        if(metrics)
+            metrics->playbackStarted();
+    }
 
     mtime_t i_nzbarrier = demux.i_nzpcr + increment;
     vlc_mutex_unlock(&demux.lock);
@@ -452,6 +489,8 @@ int PlaylistManager::doDemux(int64_t increment)
         }
         break;
     case AbstractStream::status_buffering:
+        if(metrics)
+            metrics->stalled();
         vlc_mutex_lock(&demux.lock);
         vlc_cond_timedwait(&demux.cond, &demux.lock, mdate() + CLOCK_FREQ / 20);
         vlc_mutex_unlock(&demux.lock);
@@ -464,6 +503,8 @@ int PlaylistManager::doDemux(int64_t increment)
         vlc_mutex_unlock(&demux.lock);
         break;
     case AbstractStream::status_demuxed:
+        if(metrics)
+            metrics->resumed();
         vlc_mutex_lock(&demux.lock);
         if( demux.i_nzpcr != VLC_TS_INVALID && i_nzbarrier != demux.i_nzpcr )
         {
@@ -724,7 +765,7 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
             RateBasedAdaptationLogic *logic =
                     new (std::nothrow) RateBasedAdaptationLogic(VLC_OBJECT(p_demux), width, height);
             if(logic)
-                conn->setDownloadRateObserver(logic);
+                conn->addDownloadRateObserver(logic);
             return logic;
         }
         case AbstractAdaptationLogic::Default:
@@ -732,7 +773,14 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
         {
             AbstractAdaptationLogic *logic = new (std::nothrow) PredictiveAdaptationLogic(VLC_OBJECT(p_demux));
             if(logic)
-                conn->setDownloadRateObserver(logic);
+                conn->addDownloadRateObserver(logic);
+            return logic;
+        }
+        case AbstractAdaptationLogic::BufferBased:
+        {
+            AbstractAdaptationLogic *logic = new (std::nothrow) BufferBasedAdaptationLogic(VLC_OBJECT(p_demux));
+            if(logic)
+                conn->addDownloadRateObserver(logic);
             return logic;
         }
 
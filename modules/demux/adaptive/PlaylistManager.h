@@ -39,6 +39,8 @@ namespace adaptive
         class AbstractConnectionManager;
     }
 
+    class QoEMetrics;
+
     using namespace playlist;
     using namespace logic;
     using namespace http;
@@ -99,6 +101,7 @@ namespace adaptive
             demux_t                             *p_demux;
             std::vector<AbstractStream *>        streams;
             BasePeriod                          *currentPeriod;
+            QoEMetrics                          *metrics;
 
             /* shared with demux/buffering */
             struct
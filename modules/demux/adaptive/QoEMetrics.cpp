@@ -0,0 +1,191 @@
+/*
+ * QoEMetrics.cpp
+ *****************************************************************************
+ * Copyright (C) 2017 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "QoEMetrics.hpp"
+#include "playlist/BaseAdaptationSet.h"
+#include "playlist/BaseRepresentation.h"
+
+#include <vlc_variables.h>
+#include <sstream>
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+
+static const char * const ppsz_integer_vars[] =
+{
+    "adaptive-qoe-startup-time",   /* us from opening to first playback */
+    "adaptive-qoe-switches",       /* representation changes */
+    "adaptive-qoe-rebuffers",      /* stalls after playback started */
+    "adaptive-qoe-rebuffer-time",  /* us spent stalled */
+    "adaptive-qoe-segments",       /* completed downloads */
+    "adaptive-qoe-download-time",  /* us for the last download */
+    "adaptive-qoe-throughput",     /* bps of the last download */
+    "adaptive-qoe-bitrate",        /* bps of all selected representations */
+};
+
+QoEMetrics::QoEMetrics(vlc_object_t *obj)
+{
+    p_obj = obj;
+    vlc_mutex_init(&lock);
+    sessionstart = VLC_TS_INVALID;
+    stallstart = VLC_TS_INVALID;
+    b_started = false;
+    b_stalled = false;
+    switches = 0;
+    rebuffers = 0;
+    rebuffertime = 0;
+    segments = 0;
+    usedBps = 0;
+
+    if(p_obj)
+    {
+        for(size_t i=0; i<ARRAY_SIZE(ppsz_integer_vars); i++)
+            var_Create(p_obj, ppsz_integer_vars[i], VLC_VAR_INTEGER);
+        /* "time(ms):set/representation:bps" entries, most recent last */
+        var_Create(p_obj, "adaptive-qoe-history", VLC_VAR_STRING);
+    }
+}
+
+QoEMetrics::~QoEMetrics()
+{
+    if(p_obj)
+    {
+        for(size_t i=0; i<ARRAY_SIZE(ppsz_integer_vars); i++)
+            var_Destroy(p_obj, ppsz_integer_vars[i]);
+        var_Destroy(p_obj, "adaptive-qoe-history");
+    }
+    vlc_mutex_destroy(&lock);
+}
+
+void QoEMetrics::sessionStarted()
+{
+    vlc_mutex_lock(&lock);
+    sessionstart = mdate();
+    vlc_mutex_unlock(&lock);
+}
+
+void QoEMetrics::playbackStarted()
+{
+    vlc_mutex_lock(&lock);
+    if(!b_started && sessionstart != VLC_TS_INVALID)
+    {
+        b_started = true;
+        if(p_obj)
+            var_SetInteger(p_obj, "adaptive-qoe-startup-time", mdate() - sessionstart);
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void QoEMetrics::stalled()
+{
+    vlc_mutex_lock(&lock);
+    if(b_started && !b_stalled)
+    {
+        b_stalled = true;
+        stallstart = mdate();
+        rebuffers++;
+        if(p_obj)
+            var_SetInteger(p_obj, "adaptive-qoe-rebuffers", rebuffers);
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void QoEMetrics::resumed()
+{
+    vlc_mutex_lock(&lock);
+    if(b_stalled)
+    {
+        b_stalled = false;
+        rebuffertime += mdate() - stallstart;
+        if(p_obj)
+            var_SetInteger(p_obj, "adaptive-qoe-rebuffer-time", rebuffertime);
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void QoEMetrics::trackerEvent(const SegmentTrackerEvent &event)
+{
+    if(event.type != SegmentTrackerEvent::SWITCHING)
+        return;
+
+    BaseRepresentation *prev = event.u.switching.prev;
+    BaseRepresentation *next = event.u.switching.next;
+
+    vlc_mutex_lock(&lock);
+    if(prev)
+        usedBps -= prev->getBandwidth();
+    if(next)
+        usedBps += next->getBandwidth();
+
+    if(next && next != prev)
+    {
+        /* initial selection is not a switch */
+        if(prev)
+            switches++;
+
+        Switch sw;
+        sw.time = (sessionstart != VLC_TS_INVALID) ? mdate() - sessionstart : 0;
+        sw.id = next->getAdaptationSet()->getID().str() + "/" + next->getID().str();
+        sw.bandwidth = next->getBandwidth();
+        history.push_back(sw);
+        if(history.size() > HISTORY_SIZE)
+            history.pop_front();
+    }
+
+    if(p_obj)
+    {
+        var_SetInteger(p_obj, "adaptive-qoe-switches", switches);
+        var_SetInteger(p_obj, "adaptive-qoe-bitrate", usedBps);
+        publishHistory();
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void QoEMetrics::updateDownloadRate(const ID &, size_t size, mtime_t time)
+{
+    if(size == 0 || time <= 0)
+        return;
+
+    vlc_mutex_lock(&lock);
+    segments++;
+    if(p_obj)
+    {
+        var_SetInteger(p_obj, "adaptive-qoe-segments", segments);
+        var_SetInteger(p_obj, "adaptive-qoe-download-time", time);
+        var_SetInteger(p_obj, "adaptive-qoe-throughput", size * 8 * CLOCK_FREQ / time);
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void QoEMetrics::publishHistory()
+{
+    std::stringstream ss;
+    std::deque<Switch>::const_iterator it;
+    for(it=history.begin(); it!=history.end(); ++it)
+    {
+        if(it != history.begin())
+            ss << ",";
+        ss << ((*it).time / 1000) << ":" << (*it).id << ":" << (*it).bandwidth;
+    }
+    var_SetString(p_obj, "adaptive-qoe-history", ss.str().c_str());
+}
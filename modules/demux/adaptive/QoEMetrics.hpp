@@ -0,0 +1,78 @@
+/*
+ * QoEMetrics.hpp
+ *****************************************************************************
+ * Copyright (C) 2017 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef QOEMETRICS_HPP
+#define QOEMETRICS_HPP
+
+#include "SegmentTracker.hpp"
+#include "logic/IDownloadRateObserver.h"
+
+#include <vlc_common.h>
+#include <deque>
+#include <string>
+
+namespace adaptive
+{
+    /* Collects quality of experience figures for a playback session and
+     * publishes them as "adaptive-qoe-*" variables on the input, so they
+     * can be polled by applications. */
+    class QoEMetrics : public SegmentTrackerListenerInterface,
+                       public IDownloadRateObserver
+    {
+        public:
+            QoEMetrics(vlc_object_t *);
+            virtual ~QoEMetrics();
+
+            void sessionStarted();
+            void playbackStarted();
+            void stalled();
+            void resumed();
+
+            virtual void trackerEvent(const SegmentTrackerEvent &); /* impl */
+            virtual void updateDownloadRate(const ID &, size_t, mtime_t); /* impl */
+
+            static const size_t HISTORY_SIZE = 32;
+
+        private:
+            void publishHistory();
+
+            class Switch
+            {
+                public:
+                    mtime_t     time;
+                    std::string id;
+                    uint64_t    bandwidth;
+            };
+
+            vlc_object_t        *p_obj; /* NULL when not publishing */
+            vlc_mutex_t          lock;
+            mtime_t              sessionstart;
+            mtime_t              stallstart;
+            bool                 b_started;
+            bool                 b_stalled;
+            int64_t              switches;
+            int64_t              rebuffers;
+            mtime_t              rebuffertime;
+            int64_t              segments;
+            uint64_t             usedBps;
+            std::deque<Switch>   history;
+    };
+}
+
+#endif // QOEMETRICS_HPP
@@ -75,9 +75,12 @@ SegmentTrackerEvent::SegmentTrackerEvent(const ID &id, mtime_t duration)
     u.segment.id = &id;
 }
 
-SegmentTracker::SegmentTracker(AbstractAdaptationLogic *logic_, BaseAdaptationSet *adaptSet)
+SegmentTracker::SegmentTracker(AbstractAdaptationLogic *logic_, BaseAdaptationSet *adaptSet,
+                               unsigned prefetchCount_)
 {
     first = true;
+    prefetchCount = prefetchCount_;
+    prefetchRep = NULL;
     curNumber = next = 0;
     initializing = true;
     index_sent = false;
@@ -126,6 +129,7 @@ bool SegmentTracker::segmentsListReady() const
 
 void SegmentTracker::reset()
 {
+    resetPrefetch();
     notify(SegmentTrackerEvent(curRepresentation, NULL));
     curRepresentation = NULL;
     init_sent = false;
@@ -172,6 +176,10 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
         initializing = true;
     }
 
+    /* Prefetched chunks are only valid for the same segments list */
+    if(rep != prefetchRep || rep->needsUpdate())
+        resetPrefetch();
+
     bool b_updated = false;
     /* Ensure ephemere content is updated/loaded */
     if(rep->needsUpdate())
@@ -232,11 +240,22 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
     }
 
     bool b_gap = false;
-    segment = rep->getNextSegment(BaseRepresentation::INFOTYPE_MEDIA, next, &next, &b_gap);
-    if(!segment)
+    SegmentChunk *chunk = NULL;
+    if(!prefetched.empty() && prefetched.front().number == next)
     {
-        reset();
-        return NULL;
+        segment = prefetched.front().segment;
+        chunk = prefetched.front().chunk;
+        prefetched.pop_front();
+    }
+    else
+    {
+        resetPrefetch();
+        segment = rep->getNextSegment(BaseRepresentation::INFOTYPE_MEDIA, next, &next, &b_gap);
+        if(!segment)
+        {
+            reset();
+            return NULL;
+        }
     }
 
     if(initializing)
@@ -246,7 +265,8 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
         initializing = false;
     }
 
-    SegmentChunk *chunk = segment->toChunk(next, rep, connManager);
+    if(!chunk)
+        chunk = segment->toChunk(next, rep, connManager);
 
     /* Notify new segment length for stats / logic */
     if(chunk)
@@ -273,11 +293,48 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
     {
         curNumber = next;
         next++;
+        prefetch(rep, connManager);
     }
 
     return chunk;
 }
 
+void SegmentTracker::prefetch(BaseRepresentation *rep, AbstractConnectionManager *connManager)
+{
+    uint64_t number = prefetched.empty() ? next : prefetched.back().number + 1;
+
+    prefetchRep = rep;
+    while(prefetched.size() < prefetchCount)
+    {
+        uint64_t found;
+        bool b_gap = false;
+        ISegment *segment = rep->getNextSegment(BaseRepresentation::INFOTYPE_MEDIA,
+                                                number, &found, &b_gap);
+        /* Stop on gaps, they need to be notified when reached */
+        if(!segment || b_gap || found != number)
+            break;
+
+        PrefetchedChunk p;
+        p.number = number;
+        p.segment = segment;
+        p.chunk = segment->toChunk(number, rep, connManager);
+        if(!p.chunk)
+            break;
+        prefetched.push_back(p);
+        number++;
+    }
+}
+
+void SegmentTracker::resetPrefetch()
+{
+    while(!prefetched.empty())
+    {
+        delete prefetched.front().chunk;
+        prefetched.pop_front();
+    }
+    prefetchRep = NULL;
+}
+
 bool SegmentTracker::setPositionByTime(mtime_t time, bool restarted, bool tryonly)
 {
     uint64_t segnumber;
@@ -303,6 +360,7 @@ void SegmentTracker::setPositionByNumber(uint64_t segnumber, bool restarted)
         index_sent = false;
         init_sent = false;
     }
+    resetPrefetch();
     curNumber = next = segnumber;
 }
 
@@ -43,6 +43,7 @@ namespace adaptive
     {
         class BaseAdaptationSet;
         class BaseRepresentation;
+        class ISegment;
         class SegmentChunk;
     }
 
@@ -111,7 +112,7 @@ namespace adaptive
     class SegmentTracker
     {
         public:
-            SegmentTracker(AbstractAdaptationLogic *, BaseAdaptationSet *);
+            SegmentTracker(AbstractAdaptationLogic *, BaseAdaptationSet *, unsigned = 0);
             ~SegmentTracker();
 
             StreamFormat getCurrentFormat() const;
@@ -130,6 +131,8 @@ namespace adaptive
         private:
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const SegmentTrackerEvent &) const;
+            void prefetch(BaseRepresentation *, AbstractConnectionManager *);
+            void resetPrefetch();
             bool first;
             bool initializing;
             bool index_sent;
@@ -141,6 +144,18 @@ namespace adaptive
             BaseAdaptationSet *adaptationSet;
             BaseRepresentation *curRepresentation;
             std::list<SegmentTrackerListenerInterface *> listeners;
+
+            /* Following media segments already being downloaded */
+            class PrefetchedChunk
+            {
+                public:
+                    uint64_t number;
+                    ISegment *segment;
+                    SegmentChunk *chunk;
+            };
+            unsigned prefetchCount;
+            BaseRepresentation *prefetchRep;
+            std::list<PrefetchedChunk> prefetched;
     };
 }
 
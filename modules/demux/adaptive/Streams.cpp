@@ -32,6 +32,7 @@
 #include "plumbing/CommandsQueue.hpp"
 #include "tools/Debug.hpp"
 #include <vlc_demux.h>
+#include <vlc_membudget.h>
 
 using namespace adaptive;
 using namespace adaptive::http;
@@ -337,6 +338,10 @@ AbstractStream::buffering_status AbstractStream::doBufferize(mtime_t nz_deadline
         }
     }
 
+    /* Leave the memory budget to the other users when it runs short */
+    if(vlc_mem_UnderPressure())
+        i_extra_buffering = 0;
+
     const int64_t i_total_buffering = i_min_buffering + i_extra_buffering;
 
     mtime_t i_demuxed = commandsqueue->getDemuxedAmount();
@@ -75,9 +75,31 @@ static void Close   (vlc_object_t *);
 #define ADAPT_ACCESS_TEXT N_("Use regular HTTP modules")
 #define ADAPT_ACCESS_LONGTEXT N_("Connect using http access instead of custom http code")
 
+#define ADAPT_DOWNLOADERS_TEXT N_("Concurrent downloads")
+#define ADAPT_DOWNLOADERS_LONGTEXT N_("Maximum number of segments downloaded at the same time, " \
+                                      "shared by all the streams")
+
+#define ADAPT_LOWLATENCY_TEXT N_("Low latency")
+#define ADAPT_LOWLATENCY_LONGTEXT N_("Play live streams close to their edge, consuming " \
+                                     "segments as they are produced (chunked transfers, " \
+                                     "HLS partial segments)")
+
+#define ADAPT_BWPERSIST_TEXT N_("Remember bandwidth estimates")
+#define ADAPT_BWPERSIST_LONGTEXT N_("Keep the bandwidth measured for each server " \
+                                    "across restarts, to pick the starting quality")
+
+#define ADAPT_CACHE_TEXT N_("Segments cache size (MiB)")
+#define ADAPT_CACHE_LONGTEXT N_("Memory kept for recently downloaded segments, " \
+                                "reused when seeking back or switching quality")
+
+#define ADAPT_PREFETCH_TEXT N_("Segments lookahead")
+#define ADAPT_PREFETCH_LONGTEXT N_("Number of following segments of each stream to start " \
+                                   "downloading ahead of playback")
+
 static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::Default,
                                 AbstractAdaptationLogic::Predictive,
+                                AbstractAdaptationLogic::BufferBased,
                                 AbstractAdaptationLogic::RateBased,
                                 AbstractAdaptationLogic::FixedRate,
                                 AbstractAdaptationLogic::AlwaysLowest,
@@ -86,6 +108,7 @@ static const AbstractAdaptationLogic::LogicType pi_logics[] = {
 static const char *const ppsz_logics_values[] = {
                                 "",
                                 "predictive",
+                                "buffer",
                                 "rate",
                                 "fixedrate",
                                 "lowest",
@@ -93,6 +116,7 @@ static const char *const ppsz_logics_values[] = {
 
 static const char *const ppsz_logics[] = { N_("Default"),
                                            N_("Predictive"),
+                                           N_("Buffer Based"),
                                            N_("Bandwidth Adaptive"),
                                            N_("Fixed Bandwidth"),
                                            N_("Lowest Bandwidth/Quality"),
@@ -116,6 +140,16 @@ vlc_module_begin ()
         add_integer( "adaptive-height", 0, ADAPT_HEIGHT_TEXT, ADAPT_HEIGHT_TEXT, true )
         add_integer( "adaptive-bw",     250, ADAPT_BW_TEXT,     ADAPT_BW_LONGTEXT,     false )
         add_bool   ( "adaptive-use-access", false, ADAPT_ACCESS_TEXT, ADAPT_ACCESS_LONGTEXT, true );
+        add_integer_with_range( "adaptive-downloaders", 2, 1, 8,
+                                ADAPT_DOWNLOADERS_TEXT, ADAPT_DOWNLOADERS_LONGTEXT, true )
+        add_integer_with_range( "adaptive-prefetch", 1, 0, 8,
+                                ADAPT_PREFETCH_TEXT, ADAPT_PREFETCH_LONGTEXT, true )
+        add_bool   ( "adaptive-lowlatency", false, ADAPT_LOWLATENCY_TEXT,
+                     ADAPT_LOWLATENCY_LONGTEXT, true )
+        add_integer_with_range( "adaptive-cache-size", 16, 0, 1024,
+                                ADAPT_CACHE_TEXT, ADAPT_CACHE_LONGTEXT, true )
+        add_bool   ( "adaptive-bw-persist", false, ADAPT_BWPERSIST_TEXT,
+                     ADAPT_BWPERSIST_LONGTEXT, true )
         set_callbacks( Open, Close )
 vlc_module_end ()
 
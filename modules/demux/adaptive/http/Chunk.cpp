@@ -34,6 +34,7 @@
 #include <vlc_block.h>
 
 #include <algorithm>
+#include <sstream>
 
 using namespace adaptive::http;
 
@@ -149,6 +150,15 @@ bool HTTPChunkSource::init(const std::string &url)
     return true;
 }
 
+std::string HTTPChunkSource::getCacheKey() const
+{
+    std::stringstream ss;
+    ss << params.getUrl();
+    if(bytesRange.isValid())
+        ss << "@" << bytesRange.getStartByte() << "-" << bytesRange.getEndByte();
+    return ss.str();
+}
+
 bool HTTPChunkSource::hasMoreData() const
 {
     if(eof)
@@ -238,7 +248,11 @@ HTTPChunkBufferedSource::HTTPChunkBufferedSource(const std::string& url, Abstrac
     HTTPChunkSource(url, manager, sourceid),
     p_head     (NULL),
     pp_tail    (&p_head),
-    buffered     (0)
+    buffered     (0),
+    p_cachehead  (NULL),
+    pp_cachetail (&p_cachehead),
+    cachesize    (0),
+    cachelimit   (0)
 {
     vlc_mutex_init(&lock);
     vlc_cond_init(&avail);
@@ -256,6 +270,8 @@ HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
         p_head = NULL;
         pp_tail = &p_head;
     }
+    if(p_cachehead)
+        block_ChainRelease(p_cachehead);
     done = true;
     buffered = 0;
     vlc_mutex_unlock(&lock);
@@ -275,6 +291,25 @@ bool HTTPChunkBufferedSource::isDone() const
     return b_done;
 }
 
+void HTTPChunkBufferedSource::setCached(block_t *p_block)
+{
+    vlc_mutex_lock(&lock);
+    p_head = p_block;
+    pp_tail = &p_block->p_next;
+    buffered = contentLength = p_block->i_buffer;
+    prepared = true;
+    done = true;
+    vlc_cond_signal(&avail);
+    vlc_mutex_unlock(&lock);
+}
+
+void HTTPChunkBufferedSource::setCacheable(size_t limit)
+{
+    vlc_mutex_lock(&lock);
+    cachelimit = limit;
+    vlc_mutex_unlock(&lock);
+}
+
 void HTTPChunkBufferedSource::bufferize(size_t readsize)
 {
     vlc_mutex_lock(&lock);
@@ -287,8 +322,8 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         return;
     }
 
-    if(readsize < HTTPChunkSource::CHUNK_SIZE)
-        readsize = HTTPChunkSource::CHUNK_SIZE;
+    if(readsize < HTTPChunkSource::LOW_LATENCY_CHUNK_SIZE)
+        readsize = HTTPChunkSource::LOW_LATENCY_CHUNK_SIZE;
 
     if(contentLength && readsize > contentLength - buffered)
         readsize = contentLength - buffered;
@@ -307,6 +342,7 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         size_t size;
         mtime_t time;
     } rate = {0,0};
+    block_t *p_tocache = NULL;
 
     ssize_t ret = connection->read(p_block->p_buffer, readsize);
     if(ret <= 0)
@@ -317,6 +353,11 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         rate.size = buffered + consumed;
         rate.time = mdate() - downloadstart;
         downloadstart = 0;
+        if(ret == 0 && cachelimit && (!contentLength || cachesize == contentLength))
+        {
+            p_tocache = p_cachehead;
+            p_cachehead = NULL;
+        }
         vlc_mutex_unlock(&lock);
     }
     else
@@ -324,6 +365,24 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         p_block->i_buffer = (size_t) ret;
         vlc_mutex_lock(&lock);
         buffered += p_block->i_buffer;
+        if(cachelimit)
+        {
+            block_t *p_copy;
+            if(cachesize + p_block->i_buffer <= cachelimit &&
+               (p_copy = block_Duplicate(p_block)))
+            {
+                cachesize += p_copy->i_buffer;
+                block_ChainLastAppend(&pp_cachetail, p_copy);
+            }
+            else
+            {
+                /* too large or out of memory, give up caching this one */
+                block_ChainRelease(p_cachehead);
+                p_cachehead = NULL;
+                pp_cachetail = &p_cachehead;
+                cachelimit = 0;
+            }
+        }
         block_ChainLastAppend(&pp_tail, p_block);
         if((size_t) ret < readsize)
         {
@@ -331,6 +390,11 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
             rate.size = buffered + consumed;
             rate.time = mdate() - downloadstart;
             downloadstart = 0;
+            if(cachelimit && (!contentLength || cachesize == contentLength))
+            {
+                p_tocache = p_cachehead;
+                p_cachehead = NULL;
+            }
         }
         vlc_mutex_unlock(&lock);
     }
@@ -340,6 +404,13 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         connManager->updateDownloadRate(sourceid, rate.size, rate.time);
     }
 
+    if(p_tocache)
+    {
+        p_tocache = block_ChainGather(p_tocache);
+        if(p_tocache)
+            connManager->cacheChunk(getCacheKey(), p_tocache);
+    }
+
     vlc_cond_signal(&avail);
 }
 
@@ -90,8 +90,11 @@ namespace adaptive
                 virtual block_t *   readBlock       (); /* impl */
                 virtual block_t *   read            (size_t); /* impl */
                 virtual bool        hasMoreData     () const; /* impl */
+                std::string         getCacheKey     () const;
 
                 static const size_t CHUNK_SIZE = 32768;
+                /* smaller reads to hand over chunked transfers as they arrive */
+                static const size_t LOW_LATENCY_CHUNK_SIZE = 4096;
 
             protected:
                 virtual bool      prepare();
@@ -110,6 +113,7 @@ namespace adaptive
         class HTTPChunkBufferedSource : public HTTPChunkSource
         {
             friend class Downloader;
+            friend class HTTPConnectionManager;
 
             public:
                 HTTPChunkBufferedSource(const std::string &url, AbstractConnectionManager *,
@@ -123,11 +127,17 @@ namespace adaptive
                 virtual bool       prepare(); /* reimpl */
                 void               bufferize(size_t);
                 bool               isDone() const;
+                void               setCached(block_t *);
+                void               setCacheable(size_t);
 
             private:
                 block_t            *p_head; /* read cache buffer */
                 block_t           **pp_tail;
                 size_t              buffered; /* read cache size */
+                block_t            *p_cachehead; /* copy for the chunks cache */
+                block_t           **pp_cachetail;
+                size_t              cachesize;
+                size_t              cachelimit; /* 0 when not caching */
                 bool                done;
                 bool                eof;
                 mtime_t             downloadstart;
@@ -0,0 +1,103 @@
+/*
+ * ChunkCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2017 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ChunkCache.hpp"
+
+#include <vlc_block.h>
+
+using namespace adaptive::http;
+
+ChunkCache::ChunkCache(size_t maxsize_)
+{
+    size = 0;
+    maxsize = maxsize_;
+    vlc_mutex_init(&lock);
+}
+
+ChunkCache::~ChunkCache()
+{
+    std::list<Entry>::iterator it;
+    for(it=entries.begin(); it!=entries.end(); ++it)
+        block_Release((*it).p_block);
+    vlc_mutex_destroy(&lock);
+}
+
+size_t ChunkCache::getMaxSize() const
+{
+    return maxsize;
+}
+
+block_t * ChunkCache::get(const std::string &key)
+{
+    block_t *p_block = NULL;
+    vlc_mutex_lock(&lock);
+    std::list<Entry>::iterator it;
+    for(it=entries.begin(); it!=entries.end(); ++it)
+    {
+        if((*it).key == key)
+        {
+            /* readers consume in place, so hand out a copy */
+            p_block = block_Duplicate((*it).p_block);
+            entries.splice(entries.begin(), entries, it);
+            break;
+        }
+    }
+    vlc_mutex_unlock(&lock);
+    return p_block;
+}
+
+void ChunkCache::put(const std::string &key, block_t *p_block)
+{
+    if(p_block->i_buffer > maxsize)
+    {
+        block_Release(p_block);
+        return;
+    }
+
+    vlc_mutex_lock(&lock);
+    std::list<Entry>::iterator it;
+    for(it=entries.begin(); it!=entries.end(); ++it)
+    {
+        if((*it).key == key)
+        {
+            size -= (*it).p_block->i_buffer;
+            block_Release((*it).p_block);
+            entries.erase(it);
+            break;
+        }
+    }
+
+    while(!entries.empty() && size + p_block->i_buffer > maxsize)
+    {
+        size -= entries.back().p_block->i_buffer;
+        block_Release(entries.back().p_block);
+        entries.pop_back();
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.p_block = p_block;
+    entries.push_front(entry);
+    size += p_block->i_buffer;
+    vlc_mutex_unlock(&lock);
+}
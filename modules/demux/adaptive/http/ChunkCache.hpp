@@ -0,0 +1,59 @@
+/*
+ * ChunkCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2017 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef CHUNKCACHE_HPP
+#define CHUNKCACHE_HPP
+
+#include <vlc_common.h>
+#include <list>
+#include <string>
+
+namespace adaptive
+{
+    namespace http
+    {
+        /* Least recently used cache of downloaded chunks, within a byte
+         * budget, so that seeking back in a timeshift window or fetching
+         * the same init segment again does not hit the network. */
+        class ChunkCache
+        {
+            public:
+                ChunkCache(size_t);
+                ~ChunkCache();
+
+                block_t * get(const std::string &);
+                void      put(const std::string &, block_t *);
+                size_t    getMaxSize() const;
+
+            private:
+                class Entry
+                {
+                    public:
+                        std::string key;
+                        block_t    *p_block;
+                };
+                std::list<Entry> entries; /* most recently used first */
+                size_t           size;
+                size_t           maxsize;
+                vlc_mutex_t      lock;
+        };
+    }
+}
+
+#endif // CHUNKCACHE_HPP
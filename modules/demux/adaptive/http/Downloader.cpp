@@ -28,35 +28,41 @@
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned threads, size_t readsize_)
 {
     vlc_mutex_init(&lock);
     vlc_cond_init(&waitcond);
+    vlc_cond_init(&donecond);
     killed = false;
-    thread_handle_valid = false;
+    threads_started = 0;
+    thread_count = VLC_CLIP(threads, 1, MAX_THREADS);
+    readsize = readsize_;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 reinterpret_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    for( ; threads_started < thread_count; threads_started++)
     {
-        return false;
+        if(vlc_clone(&thread_handles[threads_started], downloaderThread,
+                     reinterpret_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+            break;
     }
-    thread_handle_valid = true;
-    return true;
+    return threads_started > 0;
 }
 
 Downloader::~Downloader()
 {
+    vlc_mutex_lock(&lock);
     killed = true;
-    vlc_cond_signal(&waitcond);
-    if(thread_handle_valid)
-        vlc_join(thread_handle, NULL);
-    vlc_mutex_destroy(&lock);
+    vlc_cond_broadcast(&waitcond);
+    vlc_mutex_unlock(&lock);
+    for(unsigned i=0; i<threads_started; i++)
+        vlc_join(thread_handles[i], NULL);
+    vlc_cond_destroy(&donecond);
     vlc_cond_destroy(&waitcond);
+    vlc_mutex_destroy(&lock);
 }
+
 void Downloader::schedule(HTTPChunkBufferedSource *source)
 {
     vlc_mutex_lock(&lock);
@@ -69,6 +75,9 @@ void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc_mutex_lock(&lock);
     chunks.remove(source);
+    /* Wait for any thread still bufferizing it */
+    while(isActive(source))
+        vlc_cond_wait(&donecond, &lock);
     vlc_mutex_unlock(&lock);
 }
 
@@ -84,34 +93,60 @@ void * Downloader::downloaderThread(void *opaque)
 void Downloader::DownloadSource(HTTPChunkBufferedSource *source)
 {
     if(!source->isDone())
-        source->bufferize(HTTPChunkSource::CHUNK_SIZE);
+        source->bufferize(readsize);
+}
+
+bool Downloader::isActive(const HTTPChunkBufferedSource *source) const
+{
+    std::list<HTTPChunkBufferedSource *>::const_iterator it;
+    for(it = active.begin(); it != active.end(); ++it)
+        if(*it == source)
+            return true;
+    return false;
+}
+
+/* Oldest scheduled source that no other thread is bufferizing */
+HTTPChunkBufferedSource * Downloader::getNextSource() const
+{
+    std::list<HTTPChunkBufferedSource *>::const_iterator it;
+    for(it = chunks.begin(); it != chunks.end(); ++it)
+        if(!isActive(*it))
+            return *it;
+    return NULL;
 }
 
 void Downloader::Run()
 {
+    vlc_mutex_lock(&lock);
     while(1)
     {
-        vlc_mutex_lock(&lock);
-        if(killed)
-            break;
+        HTTPChunkBufferedSource *source;
 
-        while(chunks.empty() && !killed)
-        {
+        while(!killed && (source = getNextSource()) == NULL)
             vlc_cond_wait(&waitcond, &lock);
-        }
 
         if(killed)
             break;
 
-        if(!chunks.empty())
+        active.push_back(source);
+        vlc_mutex_unlock(&lock);
+
+        DownloadSource(source);
+
+        vlc_mutex_lock(&lock);
+        active.remove(source);
+        /* Cancelled sources are no longer scheduled and must not be touched */
+        std::list<HTTPChunkBufferedSource *>::iterator it;
+        for(it = chunks.begin(); it != chunks.end(); ++it)
         {
-            HTTPChunkBufferedSource *source = chunks.front();
-            DownloadSource(source);
-            if(source->isDone())
-                chunks.pop_front();
+            if(*it == source)
+            {
+                if(source->isDone())
+                    chunks.erase(it);
+                break;
+            }
         }
-
-        vlc_mutex_unlock(&lock);
+        vlc_cond_broadcast(&donecond);
     }
     vlc_mutex_unlock(&lock);
 }
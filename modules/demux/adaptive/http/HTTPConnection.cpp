@@ -26,9 +26,12 @@
 #include "Sockets.hpp"
 #include "../adaptive/tools/Helper.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <sstream>
 #include <vlc_stream.h>
+#include <vlc_block.h>
 
 using namespace adaptive::http;
 
@@ -459,6 +462,131 @@ void StreamUrlConnection::setUsed( bool b )
        reset();
 }
 
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_,
+                                           adaptive_http_mgr_t *mgr_)
+    : AbstractConnection(p_object_)
+{
+    mgr = mgr_;
+    res = NULL;
+    p_pending = NULL;
+    psz_useragent = var_InheritString(p_object_, "http-user-agent");
+}
+
+LibVLCHTTPConnection::~LibVLCHTTPConnection()
+{
+    reset();
+    free(psz_useragent);
+}
+
+void LibVLCHTTPConnection::reset()
+{
+    if(p_pending)
+        block_Release(p_pending);
+    p_pending = NULL;
+    if(res)
+        adaptive_http_res_close(res);
+    res = NULL;
+    bytesRead = 0;
+    contentLength = 0;
+    bytesRange = BytesRange();
+}
+
+bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
+{
+    return ( available &&
+             params.getHostname() == params_.getHostname() &&
+             params.getScheme() == params_.getScheme() &&
+             params.getPort() == params_.getPort() );
+}
+
+int LibVLCHTTPConnection::request(const std::string &path, const BytesRange &range)
+{
+    reset();
+
+    /* Set new path for this query */
+    params.setPath(path);
+
+    msg_Dbg(p_object, "Retrieving %s @%zu", params.getUrl().c_str(),
+                      range.isValid() ? range.getStartByte() : 0);
+
+    uintmax_t start = 0, end = UINTMAX_MAX;
+    if(range.isValid() && range.getEndByte() > 0)
+    {
+        start = range.getStartByte();
+        end = range.getEndByte();
+    }
+
+    res = adaptive_http_res_open(mgr, params.getUrl().c_str(), psz_useragent,
+                                 start, end);
+    if(!res)
+        return VLC_EGENERIC;
+
+    if(end != UINTMAX_MAX)
+    {
+        bytesRange = range;
+        contentLength = end - start + 1;
+    }
+
+    uintmax_t i_size = adaptive_http_res_get_size(res);
+    if(i_size != UINTMAX_MAX)
+    {
+        if(end == UINTMAX_MAX || contentLength > i_size)
+            contentLength = i_size;
+    }
+    return VLC_SUCCESS;
+}
+
+ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
+{
+    if( !res )
+        return VLC_EGENERIC;
+
+    if(len == 0)
+        return VLC_SUCCESS;
+
+    const size_t toRead = (contentLength) ? contentLength - bytesRead : len;
+    if (toRead == 0)
+        return VLC_SUCCESS;
+
+    if(len > toRead)
+        len = toRead;
+
+    /* Callers take a short read as EOF: fill the buffer from as many
+     * frames as needed */
+    uint8_t *p_dst = static_cast<uint8_t *>(p_buffer);
+    size_t done = 0;
+    while(done < len)
+    {
+        if(!p_pending && adaptive_http_res_read(res, &p_pending) <= 0)
+            break;
+
+        size_t copy = std::min(len - done, p_pending->i_buffer);
+        memcpy(&p_dst[done], p_pending->p_buffer, copy);
+        done += copy;
+        p_pending->p_buffer += copy;
+        p_pending->i_buffer -= copy;
+        if(p_pending->i_buffer == 0)
+        {
+            block_Release(p_pending);
+            p_pending = NULL;
+        }
+    }
+
+    bytesRead += done;
+
+    if(done < len || contentLength == bytesRead) /* set EOF */
+        reset();
+
+    return done;
+}
+
+void LibVLCHTTPConnection::setUsed( bool b )
+{
+    available = !b;
+    if(available && contentLength == bytesRead)
+       reset();
+}
+
 ConnectionFactory::ConnectionFactory()
 {
 }
@@ -496,3 +624,59 @@ AbstractConnection * StreamUrlConnectionFactory::createConnection(vlc_object_t *
 {
     return new (std::nothrow) StreamUrlConnection(p_object);
 }
+
+LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory()
+    : ConnectionFactory()
+{
+    vlc_mutex_init(&lock);
+}
+
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    std::list<Origin>::const_iterator it;
+    for(it = origins.begin(); it != origins.end(); ++it)
+        adaptive_http_mgr_destroy((*it).mgr);
+    vlc_mutex_destroy(&lock);
+}
+
+AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
+                                                                   const ConnectionParams &params)
+{
+    if((params.getScheme() != "http" && params.getScheme() != "https") || params.getHostname().empty())
+        return NULL;
+
+    adaptive_http_mgr_t *mgr = NULL;
+
+    vlc_mutex_lock(&lock);
+    std::list<Origin>::const_iterator it;
+    for(it = origins.begin(); it != origins.end(); ++it)
+    {
+        if((*it).scheme == params.getScheme() &&
+           (*it).hostname == params.getHostname() &&
+           (*it).port == params.getPort())
+        {
+            mgr = (*it).mgr;
+            break;
+        }
+    }
+
+    if(!mgr)
+    {
+        mgr = adaptive_http_mgr_create(p_object);
+        if(mgr)
+        {
+            Origin origin;
+            origin.scheme = params.getScheme();
+            origin.hostname = params.getHostname();
+            origin.port = params.getPort();
+            origin.mgr = mgr;
+            origins.push_back(origin);
+        }
+    }
+    vlc_mutex_unlock(&lock);
+
+    if(!mgr)
+        return NULL;
+
+    return new (std::nothrow) LibVLCHTTPConnection(p_object, mgr);
+}
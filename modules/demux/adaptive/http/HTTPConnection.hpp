@@ -27,7 +27,9 @@
 
 #include "ConnectionParams.hpp"
 #include "BytesRange.hpp"
+#include "vlchttp.h"
 #include <vlc_common.h>
+#include <list>
 #include <string>
 
 namespace adaptive
@@ -119,6 +121,27 @@ namespace adaptive
                 stream_t *p_streamurl;
        };
 
+       class LibVLCHTTPConnection : public AbstractConnection
+       {
+            public:
+                LibVLCHTTPConnection(vlc_object_t *, adaptive_http_mgr_t *);
+                virtual ~LibVLCHTTPConnection();
+
+                virtual bool    canReuse     (const ConnectionParams &) const;
+
+                virtual int     request     (const std::string& path, const BytesRange & = BytesRange());
+                virtual ssize_t read        (void *p_buffer, size_t len);
+
+                virtual void    setUsed( bool );
+
+            protected:
+                void reset();
+                adaptive_http_mgr_t *mgr;
+                adaptive_http_res_t *res;
+                block_t *p_pending;
+                char *psz_useragent;
+       };
+
        class ConnectionFactory
        {
            public:
@@ -132,6 +155,27 @@ namespace adaptive
            public:
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &);
        };
+
+       /* Shares one HTTP/1.1 or HTTP/2 connection per origin */
+       class LibVLCHTTPConnectionFactory : public ConnectionFactory
+       {
+           public:
+               LibVLCHTTPConnectionFactory();
+               virtual ~LibVLCHTTPConnectionFactory();
+               virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &);
+
+           private:
+               class Origin
+               {
+                   public:
+                       std::string scheme;
+                       std::string hostname;
+                       uint16_t port;
+                       adaptive_http_mgr_t *mgr;
+               };
+               vlc_mutex_t lock;
+               std::list<Origin> origins;
+       };
     }
 }
 
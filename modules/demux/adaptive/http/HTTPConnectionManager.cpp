@@ -30,7 +30,10 @@
 #include "ConnectionParams.hpp"
 #include "Sockets.hpp"
 #include "Downloader.hpp"
+#include "ChunkCache.hpp"
+#include "../logic/BandwidthCache.hpp"
 #include <vlc_url.h>
+#include <vlc_block.h>
 
 using namespace adaptive::http;
 
@@ -38,37 +41,65 @@ AbstractConnectionManager::AbstractConnectionManager(vlc_object_t *p_object_)
     : IDownloadRateObserver()
 {
     p_object = p_object_;
-    rateObserver = NULL;
+    dlsize = 0;
+    dllength = 0;
+    vlc_mutex_init(&lock);
 }
 
 AbstractConnectionManager::~AbstractConnectionManager()
 {
-
+    logic::BandwidthCache::save(p_object);
+    vlc_mutex_destroy(&lock);
 }
 
 void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid, size_t size, mtime_t time)
 {
-    if(rateObserver)
-        rateObserver->updateDownloadRate(sourceid, size, time);
+    std::list<IDownloadRateObserver *>::const_iterator it;
+    for(it=rateObservers.begin(); it!=rateObservers.end(); ++it)
+        (*it)->updateDownloadRate(sourceid, size, time);
+
+    vlc_mutex_lock(&lock);
+    dlsize += size;
+    dllength += time;
+    if(dllength >= CLOCK_FREQ && !origin.empty())
+    {
+        logic::BandwidthCache::update(origin, CLOCK_FREQ * dlsize * 8 / dllength);
+        dlsize = dllength = 0;
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void AbstractConnectionManager::addDownloadRateObserver(IDownloadRateObserver *obs)
+{
+    rateObservers.push_back(obs);
 }
 
-void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *obs)
+void AbstractConnectionManager::setOrigin(const std::string &host)
 {
-    rateObserver = obs;
+    vlc_mutex_lock(&lock);
+    origin = host;
+    vlc_mutex_unlock(&lock);
 }
 
 HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_, ConnectionFactory *factory_)
     : AbstractConnectionManager( p_object_ )
 {
     vlc_mutex_init(&lock);
-    downloader = new (std::nothrow) Downloader();
-    downloader->start();
+    const size_t readsize = var_InheritBool(p_object, "adaptive-lowlatency")
+                          ? HTTPChunkSource::LOW_LATENCY_CHUNK_SIZE
+                          : HTTPChunkSource::CHUNK_SIZE;
+    downloader = new (std::nothrow) Downloader(var_InheritInteger(p_object, "adaptive-downloaders"),
+                                               readsize);
+    if(downloader)
+        downloader->start();
+    const size_t cachesize = var_InheritInteger(p_object, "adaptive-cache-size") * 1024 * 1024;
+    cache = (cachesize) ? new (std::nothrow) ChunkCache(cachesize) : NULL;
     if(!factory_)
     {
         if(var_InheritBool(p_object, "adaptive-use-access"))
             factory = new (std::nothrow) StreamUrlConnectionFactory();
         else
-            factory = new (std::nothrow) ConnectionFactory();
+            factory = new (std::nothrow) LibVLCHTTPConnectionFactory();
     }
     else
         factory = factory_;
@@ -76,8 +107,10 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_, Connec
 HTTPConnectionManager::~HTTPConnectionManager   ()
 {
     delete downloader;
-    delete factory;
+    delete cache;
+    /* connections may refer to the factory shared transports */
     this->closeAllConnections();
+    delete factory;
     vlc_mutex_destroy(&lock);
 }
 
@@ -141,8 +174,21 @@ AbstractConnection * HTTPConnectionManager::getConnection(ConnectionParams &para
 void HTTPConnectionManager::start(AbstractChunkSource *source)
 {
     HTTPChunkBufferedSource *src = dynamic_cast<HTTPChunkBufferedSource *>(source);
-    if(src)
-        downloader->schedule(src);
+    if(!src)
+        return;
+
+    if(cache)
+    {
+        block_t *p_block = cache->get(src->getCacheKey());
+        if(p_block)
+        {
+            src->setCached(p_block);
+            return;
+        }
+        /* a single chunk may not use up the whole budget */
+        src->setCacheable(cache->getMaxSize() / 4);
+    }
+    downloader->schedule(src);
 }
 
 void HTTPConnectionManager::cancel(AbstractChunkSource *source)
@@ -151,3 +197,11 @@ void HTTPConnectionManager::cancel(AbstractChunkSource *source)
     if(src)
         downloader->cancel(src);
 }
+
+void HTTPConnectionManager::cacheChunk(const std::string &key, block_t *p_block)
+{
+    if(cache)
+        cache->put(key, p_block);
+    else
+        block_Release(p_block);
+}
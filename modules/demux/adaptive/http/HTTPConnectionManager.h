@@ -29,6 +29,7 @@
 
 #include <vlc_common.h>
 #include <vector>
+#include <list>
 #include <string>
 
 namespace adaptive
@@ -40,6 +41,7 @@ namespace adaptive
         class AbstractConnection;
         class Downloader;
         class AbstractChunkSource;
+        class ChunkCache;
 
         class AbstractConnectionManager : public IDownloadRateObserver
         {
@@ -50,15 +52,22 @@ namespace adaptive
                 virtual AbstractConnection * getConnection(ConnectionParams &) = 0;
                 virtual void start(AbstractChunkSource *) = 0;
                 virtual void cancel(AbstractChunkSource *) = 0;
+                virtual void cacheChunk(const std::string &, block_t *) = 0;
 
                 virtual void updateDownloadRate(const ID &, size_t, mtime_t); /* impl */
-                void setDownloadRateObserver(IDownloadRateObserver *);
+                void addDownloadRateObserver(IDownloadRateObserver *);
+                void setOrigin(const std::string &);
 
             protected:
                 vlc_object_t                                       *p_object;
 
             private:
-                IDownloadRateObserver                              *rateObserver;
+                std::list<IDownloadRateObserver *>                  rateObservers;
+                /* session estimate fed to the shared bandwidth cache */
+                std::string                                         origin;
+                size_t                                              dlsize;
+                mtime_t                                             dllength;
+                vlc_mutex_t                                         lock;
         };
 
         class HTTPConnectionManager : public AbstractConnectionManager
@@ -72,10 +81,12 @@ namespace adaptive
 
                 virtual void start(AbstractChunkSource *) /* impl */;
                 virtual void cancel(AbstractChunkSource *) /* impl */;
+                virtual void cacheChunk(const std::string &, block_t *) /* impl */;
 
             private:
                 void    releaseAllConnections ();
                 Downloader                                         *downloader;
+                ChunkCache                                         *cache;
                 vlc_mutex_t                                         lock;
                 std::vector<AbstractConnection *>                   connectionPool;
                 ConnectionFactory                                  *factory;
@@ -0,0 +1,167 @@
+/*
+ * vlchttp.c
+ *****************************************************************************
+ * Copyright (C) 2017 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+#include "../../../access/http/message.h"
+#include "../../../access/http/resource.h"
+#include "../../../access/http/connmgr.h"
+#include "vlchttp.h"
+
+struct adaptive_http_mgr
+{
+    struct vlc_http_mgr *mgr;
+    vlc_mutex_t lock;
+};
+
+struct adaptive_http_res
+{
+    struct vlc_http_resource resource; /* must be first */
+    struct
+    {
+        uintmax_t start;
+        uintmax_t end;
+    } range;
+    adaptive_http_mgr_t *owner;
+};
+
+static int adaptive_http_res_req(const struct vlc_http_resource *res,
+                                 struct vlc_http_msg *req, void *opaque)
+{
+    const struct adaptive_http_res *r = (const struct adaptive_http_res *)res;
+
+    if (r->range.end != UINTMAX_MAX
+     && vlc_http_msg_add_header(req, "Range", "bytes=%ju-%ju",
+                                r->range.start, r->range.end))
+        return -1;
+    (void) opaque;
+    return 0;
+}
+
+static int adaptive_http_res_resp(const struct vlc_http_resource *res,
+                                  const struct vlc_http_msg *resp, void *opaque)
+{
+    const struct adaptive_http_res *r = (const struct adaptive_http_res *)res;
+    int status = vlc_http_msg_get_status(resp);
+
+    (void) opaque;
+    if (status == 206)
+        return 0;
+    /* A full response can only stand for a range starting at 0 */
+    if (status == 200 && (r->range.end == UINTMAX_MAX || r->range.start == 0))
+        return 0;
+    return -1;
+}
+
+static const struct vlc_http_resource_cbs adaptive_http_res_callbacks =
+{
+    adaptive_http_res_req,
+    adaptive_http_res_resp,
+    NULL,
+};
+
+adaptive_http_mgr_t *adaptive_http_mgr_create(vlc_object_t *obj)
+{
+    adaptive_http_mgr_t *mgr = malloc(sizeof (*mgr));
+    if (unlikely(mgr == NULL))
+        return NULL;
+
+    mgr->mgr = vlc_http_mgr_create(obj, NULL, false);
+    if (mgr->mgr == NULL)
+    {
+        free(mgr);
+        return NULL;
+    }
+    vlc_mutex_init(&mgr->lock);
+    return mgr;
+}
+
+void adaptive_http_mgr_destroy(adaptive_http_mgr_t *mgr)
+{
+    vlc_http_mgr_destroy(mgr->mgr);
+    vlc_mutex_destroy(&mgr->lock);
+    free(mgr);
+}
+
+adaptive_http_res_t *adaptive_http_res_open(adaptive_http_mgr_t *mgr,
+                                            const char *url, const char *ua,
+                                            uintmax_t start, uintmax_t end)
+{
+    adaptive_http_res_t *res = malloc(sizeof (*res));
+    if (unlikely(res == NULL))
+        return NULL;
+
+    if (vlc_http_res_init(&res->resource, &adaptive_http_res_callbacks,
+                          mgr->mgr, url, ua, NULL))
+    {
+        free(res);
+        return NULL;
+    }
+
+    res->range.start = start;
+    res->range.end = (end >= start) ? end : UINTMAX_MAX;
+    res->owner = mgr;
+
+    /* The manager is not reentrant: serialize opening streams */
+    vlc_mutex_lock(&mgr->lock);
+    int status = vlc_http_res_get_status(&res->resource);
+    vlc_mutex_unlock(&mgr->lock);
+
+    if (status < 200 || status >= 300)
+    {
+        adaptive_http_res_close(res);
+        return NULL;
+    }
+    return res;
+}
+
+uintmax_t adaptive_http_res_get_size(const adaptive_http_res_t *res)
+{
+    return vlc_http_msg_get_size(res->resource.response);
+}
+
+int adaptive_http_res_read(adaptive_http_res_t *res, block_t **pp_block)
+{
+    block_t *block = vlc_http_res_read(&res->resource);
+
+    *pp_block = NULL;
+    if (block == vlc_http_error)
+        return -1;
+    if (block == NULL)
+        return 0;
+    *pp_block = block;
+    return 1;
+}
+
+void adaptive_http_res_close(adaptive_http_res_t *res)
+{
+    adaptive_http_mgr_t *mgr = res->owner;
+
+    /* Closing the stream may release the connection */
+    vlc_mutex_lock(&mgr->lock);
+    vlc_http_res_destroy(&res->resource);
+    vlc_mutex_unlock(&mgr->lock);
+}
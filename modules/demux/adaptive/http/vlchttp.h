@@ -0,0 +1,71 @@
+/*
+ * vlchttp.h
+ *****************************************************************************
+ * Copyright (C) 2017 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef ADAPTIVE_VLCHTTP_H
+#define ADAPTIVE_VLCHTTP_H
+
+/* Thin C glue over the HTTP/1.1 and HTTP/2 client of the http access,
+ * whose headers cannot be included from C++. */
+
+#include <vlc_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct adaptive_http_mgr adaptive_http_mgr_t;
+typedef struct adaptive_http_res adaptive_http_res_t;
+
+/**
+ * Creates a connection manager for a single origin (scheme, host, port).
+ *
+ * Requests from several threads are serialized at the manager level, while
+ * HTTP/2 lets their responses be read concurrently over one connection.
+ */
+adaptive_http_mgr_t *adaptive_http_mgr_create(vlc_object_t *);
+void adaptive_http_mgr_destroy(adaptive_http_mgr_t *);
+
+/**
+ * Sends a GET request and waits for the final response.
+ *
+ * @param start first byte of the range (if end >= start)
+ * @param end last byte of the range, or UINTMAX_MAX for the whole resource
+ * @return the resource, or NULL on failure or non-success response.
+ */
+adaptive_http_res_t *adaptive_http_res_open(adaptive_http_mgr_t *,
+                                            const char *url, const char *ua,
+                                            uintmax_t start, uintmax_t end);
+
+/** @return the response payload size, or UINTMAX_MAX if unknown */
+uintmax_t adaptive_http_res_get_size(const adaptive_http_res_t *);
+
+/**
+ * Reads the next piece of response payload.
+ *
+ * @return 1 with a block, 0 at end of stream, -1 on error
+ */
+int adaptive_http_res_read(adaptive_http_res_t *, block_t **);
+
+void adaptive_http_res_close(adaptive_http_res_t *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
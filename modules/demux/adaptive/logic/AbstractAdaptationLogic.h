@@ -50,6 +50,8 @@ namespace adaptive
                 virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *, BaseRepresentation *) = 0;
                 virtual void                updateDownloadRate     (const ID &, size_t, mtime_t);
                 virtual void                trackerEvent           (const SegmentTrackerEvent &) {}
+                /* estimate from a previous session, before any download */
+                virtual void                setInitialBandwidth    (size_t) {}
 
                 enum LogicType
                 {
@@ -58,7 +60,8 @@ namespace adaptive
                     AlwaysLowest,
                     RateBased,
                     FixedRate,
-                    Predictive
+                    Predictive,
+                    BufferBased
                 };
         };
     }
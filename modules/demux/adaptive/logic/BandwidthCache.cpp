@@ -0,0 +1,166 @@
+/*
+ * BandwidthCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2017 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "BandwidthCache.hpp"
+
+#include <vlc_configuration.h>
+#include <vlc_variables.h>
+#include <vlc_fs.h>
+
+#include <map>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace adaptive::logic;
+
+namespace
+{
+    struct Estimate
+    {
+        size_t bps;
+        time_t updated;
+    };
+}
+
+static vlc_mutex_t cache_lock = VLC_STATIC_MUTEX;
+static std::map<std::string, Estimate> cache;
+static bool b_cache_loaded = false;
+
+size_t BandwidthCache::lookup(vlc_object_t *p_obj, const std::string &origin)
+{
+    size_t bps = 0;
+    vlc_mutex_lock(&cache_lock);
+    if(!b_cache_loaded && var_InheritBool(p_obj, "adaptive-bw-persist"))
+        load(p_obj);
+    std::map<std::string, Estimate>::const_iterator it = cache.find(origin);
+    if(it != cache.end() && time(NULL) - (*it).second.updated < MAX_AGE)
+        bps = (*it).second.bps;
+    vlc_mutex_unlock(&cache_lock);
+    return bps;
+}
+
+void BandwidthCache::update(const std::string &origin, size_t bps)
+{
+    if(origin.empty() || bps == 0)
+        return;
+
+    const time_t now = time(NULL);
+    vlc_mutex_lock(&cache_lock);
+    std::map<std::string, Estimate>::iterator it = cache.find(origin);
+    if(it != cache.end() && now - (*it).second.updated < MAX_AGE)
+    {
+        /* smooth over sessions, but follow current conditions */
+        (*it).second.bps = ((*it).second.bps + bps) / 2;
+        (*it).second.updated = now;
+    }
+    else
+    {
+        Estimate e = { bps, now };
+        cache[origin] = e;
+    }
+    vlc_mutex_unlock(&cache_lock);
+}
+
+char * BandwidthCache::getPath()
+{
+    char *psz_dir = config_GetUserDir(VLC_CACHE_DIR);
+    if(!psz_dir)
+        return NULL;
+    char *psz_path;
+    if(asprintf(&psz_path, "%s" DIR_SEP "adaptive-bandwidth", psz_dir) == -1)
+        psz_path = NULL;
+    free(psz_dir);
+    return psz_path;
+}
+
+/* cache_lock held */
+void BandwidthCache::load(vlc_object_t *p_obj)
+{
+    b_cache_loaded = true;
+
+    char *psz_path = getPath();
+    if(!psz_path)
+        return;
+    FILE *fp = vlc_fopen(psz_path, "rt");
+    free(psz_path);
+    if(!fp)
+        return;
+
+    char host[256];
+    unsigned long long bps;
+    long long updated;
+    while(fscanf(fp, "%255s %llu %lld", host, &bps, &updated) == 3)
+    {
+        if(cache.find(host) != cache.end())
+            continue;
+        Estimate e = { (size_t) bps, (time_t) updated };
+        cache[host] = e;
+    }
+    fclose(fp);
+    msg_Dbg(p_obj, "loaded %zu bandwidth estimates", cache.size());
+}
+
+void BandwidthCache::save(vlc_object_t *p_obj)
+{
+    if(!var_InheritBool(p_obj, "adaptive-bw-persist"))
+        return;
+
+    char *psz_dir = config_GetUserDir(VLC_CACHE_DIR);
+    if(!psz_dir)
+        return;
+    vlc_mkdir(psz_dir, 0700);
+    free(psz_dir);
+
+    char *psz_path = getPath();
+    if(!psz_path)
+        return;
+
+    vlc_mutex_lock(&cache_lock);
+    /* do not drop the estimates from previous processes */
+    if(!b_cache_loaded)
+        load(p_obj);
+
+    FILE *fp = vlc_fopen(psz_path, "wt");
+    if(!fp)
+    {
+        vlc_mutex_unlock(&cache_lock);
+        msg_Warn(p_obj, "cannot write bandwidth estimates to %s", psz_path);
+        free(psz_path);
+        return;
+    }
+    free(psz_path);
+
+    const time_t now = time(NULL);
+    std::map<std::string, Estimate>::const_iterator it;
+    for(it=cache.begin(); it!=cache.end(); ++it)
+    {
+        if(now - (*it).second.updated >= MAX_AGE)
+            continue;
+        fprintf(fp, "%s %llu %lld\n", (*it).first.c_str(),
+                (unsigned long long) (*it).second.bps,
+                (long long) (*it).second.updated);
+    }
+    fclose(fp);
+    vlc_mutex_unlock(&cache_lock);
+}
@@ -0,0 +1,51 @@
+/*
+ * BandwidthCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2017 - VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef BANDWIDTHCACHE_HPP
+#define BANDWIDTHCACHE_HPP
+
+#include <vlc_common.h>
+#include <string>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        /* Process wide bandwidth estimates, keyed by origin host, so that a
+         * new session can start at a sensible representation instead of
+         * ramping up from the lowest one. Optionally stored in the user
+         * cache directory to survive restarts. */
+        class BandwidthCache
+        {
+            public:
+                static size_t lookup(vlc_object_t *, const std::string &);
+                static void   update(const std::string &, size_t);
+                static void   save(vlc_object_t *);
+
+                /* estimates older than this are not trusted anymore */
+                static const time_t MAX_AGE = 600;
+
+            private:
+                static void   load(vlc_object_t *);
+                static char * getPath();
+        };
+    }
+}
+
+#endif // BANDWIDTHCACHE_HPP
@@ -0,0 +1,217 @@
+/*
+ * BufferBasedAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2017 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "BufferBasedAdaptationLogic.hpp"
+
+#include "Representationselectors.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../tools/Debug.hpp"
+
+#include <cmath>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/* Weight of the playback smoothness against the utility (BOLA gamma*p) */
+#define BOLA_GAMMA_P 5.0
+
+BufferBasedStats::BufferBasedStats()
+{
+    buffering_level = 0;
+    buffering_target = 0;
+    last_duration = 0;
+    last_download_rate = 0;
+}
+
+bool BufferBasedStats::starting() const
+{
+    return !last_duration || !buffering_target;
+}
+
+BufferBasedAdaptationLogic::BufferBasedAdaptationLogic(vlc_object_t *p_obj_)
+    : AbstractAdaptationLogic()
+{
+    p_obj = p_obj_;
+    vlc_mutex_init(&lock);
+}
+
+BufferBasedAdaptationLogic::~BufferBasedAdaptationLogic()
+{
+    vlc_mutex_destroy(&lock);
+}
+
+BaseRepresentation *
+BufferBasedAdaptationLogic::getBolaRepresentation(BaseAdaptationSet *adaptSet,
+                                                  const BufferBasedStats &stats) const
+{
+    const std::vector<BaseRepresentation *> &reps = adaptSet->getRepresentations();
+    if(reps.empty())
+        return NULL;
+
+    /* Buffer occupancy and capacity, in segments */
+    const double Q = (double) stats.buffering_level / stats.last_duration;
+    const double Qmax = std::max(2.0, (double) stats.buffering_target / stats.last_duration);
+
+    /* Representations are sorted by bandwidth. Segments sizes are
+     * proportional to it, which is all the utility needs. */
+    const double Smin = std::max((uint64_t) 1, reps.front()->getBandwidth());
+    const double Vmax = std::log(std::max((uint64_t) 1, reps.back()->getBandwidth()) / Smin);
+    const double V = (Qmax - 1.0) / (Vmax + BOLA_GAMMA_P);
+
+    BaseRepresentation *rep = reps.front();
+    double bestscore = -HUGE_VAL;
+    std::vector<BaseRepresentation *>::const_iterator it;
+    for(it = reps.begin(); it != reps.end(); ++it)
+    {
+        const double S = std::max((uint64_t) 1, (*it)->getBandwidth());
+        const double score = (V * (std::log(S / Smin) + BOLA_GAMMA_P) - Q) / S;
+        if(score > bestscore)
+        {
+            bestscore = score;
+            rep = *it;
+        }
+    }
+    return rep;
+}
+
+BaseRepresentation *BufferBasedAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet, BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector;
+    BaseRepresentation *rep;
+
+    vlc_mutex_lock(&lock);
+
+    std::map<ID, BufferBasedStats>::const_iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end() || (*it).second.starting())
+    {
+        /* No buffer yet: start low, unless we already know the link */
+        if(it != streams.end() && (*it).second.last_download_rate)
+            rep = selector.select(adaptSet, (*it).second.last_download_rate);
+        else
+            rep = selector.lowest(adaptSet);
+    }
+    else
+    {
+        const BufferBasedStats &stats = (*it).second;
+        const unsigned i_bw = stats.last_download_rate;
+
+        rep = getBolaRepresentation(adaptSet, stats);
+
+        if(rep && i_bw)
+        {
+            BaseRepresentation *safe = selector.select(adaptSet, i_bw);
+            if(prevRep && rep->getBandwidth() > prevRep->getBandwidth() &&
+               rep->getBandwidth() > safe->getBandwidth())
+            {
+                /* Only switch up to what the link can sustain (BOLA-O) */
+                rep = (safe->getBandwidth() > prevRep->getBandwidth()) ? safe : prevRep;
+            }
+            else if(stats.buffering_level < stats.last_duration &&
+                    rep->getBandwidth() > safe->getBandwidth())
+            {
+                /* Less than a segment left: do not risk stalling */
+                rep = safe;
+            }
+        }
+
+        BwDebug( msg_Info(p_obj, "Stream %s buffering level %.2f segments",
+                          adaptSet->getID().str().c_str(),
+                          (double) stats.buffering_level / stats.last_duration); );
+    }
+
+    BwDebug( if( rep && rep != prevRep )
+                msg_Info(p_obj, "Stream %s new bandwidth usage %zu KiB/s",
+                         adaptSet->getID().str().c_str(), rep->getBandwidth() / 8000); );
+
+    vlc_mutex_unlock(&lock);
+
+    return rep;
+}
+
+void BufferBasedAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize, mtime_t time)
+{
+    if(unlikely(time == 0))
+        return;
+    vlc_mutex_lock(&lock);
+    std::map<ID, BufferBasedStats>::iterator it = streams.find(id);
+    if(it != streams.end())
+    {
+        BufferBasedStats &stats = (*it).second;
+        stats.last_download_rate = stats.average.push(CLOCK_FREQ * dlsize * 8 / time);
+    }
+    vlc_mutex_unlock(&lock);
+}
+
+void BufferBasedAdaptationLogic::trackerEvent(const SegmentTrackerEvent &event)
+{
+    switch(event.type)
+    {
+    case SegmentTrackerEvent::BUFFERING_STATE:
+        {
+            const ID &id = *event.u.buffering.id;
+            vlc_mutex_lock(&lock);
+            if(event.u.buffering.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                {
+                    BufferBasedStats stats;
+                    streams.insert(std::pair<ID, BufferBasedStats>(id, stats));
+                }
+            }
+            else
+            {
+                std::map<ID, BufferBasedStats>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case SegmentTrackerEvent::BUFFERING_LEVEL_CHANGE:
+        {
+            const ID &id = *event.u.buffering_level.id;
+            vlc_mutex_lock(&lock);
+            BufferBasedStats &stats = streams[id];
+            stats.buffering_level = event.u.buffering_level.current;
+            stats.buffering_target = event.u.buffering_level.target;
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case SegmentTrackerEvent::SEGMENT_CHANGE:
+        {
+            const ID &id = *event.u.segment.id;
+            vlc_mutex_lock(&lock);
+            BufferBasedStats &stats = streams[id];
+            stats.last_duration = event.u.segment.duration;
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    default:
+            break;
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * BufferBasedAdaptationLogic.hpp
+ *****************************************************************************
+ * Copyright (C) 2017 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef BUFFERBASEDADAPTATIONLOGIC_HPP
+#define BUFFERBASEDADAPTATIONLOGIC_HPP
+
+#include "AbstractAdaptationLogic.h"
+#include "../tools/MovingAverage.hpp"
+
+#include <map>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        class BufferBasedStats
+        {
+            friend class BufferBasedAdaptationLogic;
+
+            public:
+                BufferBasedStats();
+                bool starting() const;
+
+            private:
+                mtime_t buffering_level;
+                mtime_t buffering_target;
+                mtime_t last_duration;
+                unsigned last_download_rate;
+                MovingAverage<unsigned> average;
+        };
+
+        /* BOLA (Spiteri, Urgaonkar, Sitaraman) like logic: the representation
+         * is picked from the buffered duration only, maximizing a log utility
+         * of its bitrate against the buffer occupancy. The download rate is
+         * only used to refuse up switches it could not sustain (BOLA-O), and
+         * to get out of a nearly empty buffer. */
+        class BufferBasedAdaptationLogic : public AbstractAdaptationLogic
+        {
+            public:
+                BufferBasedAdaptationLogic(vlc_object_t *);
+                virtual ~BufferBasedAdaptationLogic();
+
+                virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *, BaseRepresentation *);
+                virtual void                updateDownloadRate     (const ID &, size_t, mtime_t); /* reimpl */
+                virtual void                trackerEvent           (const SegmentTrackerEvent &); /* reimpl */
+
+            private:
+                BaseRepresentation *        getBolaRepresentation(BaseAdaptationSet *,
+                                                                  const BufferBasedStats &) const;
+                std::map<adaptive::ID, BufferBasedStats> streams;
+                vlc_object_t *              p_obj;
+                vlc_mutex_t                 lock;
+        };
+    }
+}
+
+#endif // BUFFERBASEDADAPTATIONLOGIC_HPP
@@ -84,16 +84,22 @@ void RateBasedAdaptationLogic::updateDownloadRate(const ID &, size_t size, mtime
 {
     if(unlikely(time == 0))
         return;
+
+    /* Results may come from several downloader threads */
+    vlc_mutex_lock(&lock);
+
     /* Accumulate up to observation window */
     dllength += time;
     dlsize += size;
 
     if(dllength < CLOCK_FREQ / 4)
+    {
+        vlc_mutex_unlock(&lock);
         return;
+    }
 
     const size_t bps = CLOCK_FREQ * dlsize * 8 / dllength;
 
-    vlc_mutex_lock(&lock);
     bpsAvg = average.push(bps);
 
     BwDebug(msg_Dbg(p_obj, "alpha1 %lf alpha0 %lf dmax %ld ds %ld", alpha,
@@ -109,6 +115,15 @@ void RateBasedAdaptationLogic::updateDownloadRate(const ID &, size_t size, mtime
     vlc_mutex_unlock(&lock);
 }
 
+void RateBasedAdaptationLogic::setInitialBandwidth(size_t bps)
+{
+    vlc_mutex_lock(&lock);
+    bpsAvg = average.push(bps);
+    currentBps = bpsAvg * 3/4;
+    BwDebug(msg_Info(p_obj, "Initial bandwidth %zu KiB/s", (bpsAvg / 8000)));
+    vlc_mutex_unlock(&lock);
+}
+
 void RateBasedAdaptationLogic::trackerEvent(const SegmentTrackerEvent &event)
 {
     if(event.type == SegmentTrackerEvent::SWITCHING)
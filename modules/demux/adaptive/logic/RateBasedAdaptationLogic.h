@@ -42,6 +42,7 @@ namespace adaptive
                 BaseRepresentation *getNextRepresentation(BaseAdaptationSet *, BaseRepresentation *);
                 virtual void updateDownloadRate(const ID &, size_t, mtime_t); /* reimpl */
                 virtual void trackerEvent(const SegmentTrackerEvent &); /* reimpl */
+                virtual void setInitialBandwidth(size_t); /* reimpl */
 
             private:
                 int                     width;
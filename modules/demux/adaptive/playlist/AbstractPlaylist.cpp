@@ -44,6 +44,7 @@ AbstractPlaylist::AbstractPlaylist (vlc_object_t *p_object_) :
     minUpdatePeriod.Set( 2 * CLOCK_FREQ );
     maxSegmentDuration.Set( 0 );
     minBufferTime = 0;
+    b_lowlatency = false;
     timeShiftBufferDepth.Set( 0 );
 }
 
@@ -83,9 +84,15 @@ void AbstractPlaylist::setMinBuffering( mtime_t min )
     minBufferTime = min;
 }
 
+void AbstractPlaylist::setLowLatency( bool b )
+{
+    b_lowlatency = b;
+}
+
 mtime_t AbstractPlaylist::getMinBuffering() const
 {
-    return std::max(minBufferTime, 6*CLOCK_FREQ);
+    /* Low latency trades the rebuffering margin for a closer live edge */
+    return std::max(minBufferTime, (b_lowlatency ? 1 : 6) * CLOCK_FREQ);
 }
 
 mtime_t AbstractPlaylist::getMaxBuffering() const
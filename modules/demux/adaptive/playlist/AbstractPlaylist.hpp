@@ -43,6 +43,7 @@ namespace adaptive
                 virtual bool                    isLive() const = 0;
                 void                            setType(const std::string &);
                 void                            setMinBuffering( mtime_t );
+                void                            setLowLatency( bool );
                 mtime_t                         getMinBuffering() const;
                 mtime_t                         getMaxBuffering() const;
                 virtual void                    debug() = 0;
@@ -76,6 +77,7 @@ namespace adaptive
                 std::string                         playlistUrl;
                 std::string                         type;
                 mtime_t                             minBufferTime;
+                bool                                b_lowlatency;
         };
     }
 }
@@ -29,6 +29,8 @@
 #include "SegmentInformation.hpp"
 #include "AbstractPlaylist.hpp"
 
+#include <algorithm>
+
 using namespace adaptive::playlist;
 
 BaseSegmentTemplate::BaseSegmentTemplate( ICanonicalUrl *parent ) :
@@ -43,6 +45,7 @@ MediaSegmentTemplate::MediaSegmentTemplate( SegmentInformation *parent ) :
     debugName = "SegmentTemplate";
     classId = Segment::CLASSID_SEGMENT;
     startNumber.Set( 1 );
+    availabilityTimeOffset.Set( 0 );
     initialisationSegment.Set( NULL );
     templated = true;
     parentSegmentInformation = parent;
@@ -54,6 +57,12 @@ void MediaSegmentTemplate::mergeWith(MediaSegmentTemplate *updated, mtime_t prun
     if(timeline && updated->segmentTimeline.Get())
     {
         timeline->mergeWith(*updated->segmentTimeline.Get());
+
+        /* Entries out of the timeshift window are no longer available */
+        const mtime_t depth = parentSegmentInformation->getPlaylist()->timeShiftBufferDepth.Get();
+        if(depth && timeline->end() > timeline->start() + depth)
+            prunebarrier = std::max(prunebarrier, timeline->end() - depth);
+
         if(prunebarrier)
         {
             const Timescale timescale = timeline->inheritTimescale();
@@ -89,7 +98,9 @@ uint64_t MediaSegmentTemplate::getCurrentLiveTemplateNumber() const
         const Timescale timescale = inheritTimescale();
         time_t streamstart = parentSegmentInformation->getPlaylist()->availabilityStartTime.Get();
         streamstart += parentSegmentInformation->getPeriodStart();
-        stime_t elapsed = timescale.ToScaled(CLOCK_FREQ * (playbacktime - streamstart));
+        /* segments are available that much earlier (chunked delivery) */
+        stime_t elapsed = timescale.ToScaled(CLOCK_FREQ * (playbacktime - streamstart) +
+                                             availabilityTimeOffset.Get());
         number += elapsed / dur - 2;
     }
 
@@ -50,16 +50,23 @@ SegmentTimeline::~SegmentTimeline()
 
 void SegmentTimeline::addElement(uint64_t number, stime_t d, uint64_t r, stime_t t)
 {
-    Element *element = new (std::nothrow) Element(number, d, r, t);
-    if(element)
+    if(!elements.empty())
     {
-        if(!elements.empty() && !t)
+        Element *last = elements.back();
+        const stime_t lastend = last->t + (last->d * (last->r + 1));
+        if(!t)
+            t = lastend;
+        /* Run length encoding: long timelines mostly repeat a same duration */
+        if(last->appendable(number, d, t))
         {
-            const Element *el = elements.back();
-            element->t = el->t + (el->d * (el->r + 1));
+            last->r += r + 1;
+            return;
         }
-        elements.push_back(element);
     }
+
+    Element *element = new (std::nothrow) Element(number, d, r, t);
+    if(element)
+        elements.push_back(element);
 }
 
 mtime_t SegmentTimeline::getMinAheadScaledTime(uint64_t number) const
@@ -94,22 +101,21 @@ uint64_t SegmentTimeline::getElementNumberByScaledPlaybackTime(stime_t scaled) c
     {
         const Element *el = *it;
         if(it == elements.begin())
-        {
             scaled -= el->t;
-            prevnumber = el->number;
-        }
-
-        for(uint64_t repeat = 1 + el->r; repeat; repeat--)
-        {
-            if(el->d >= scaled)
-                return prevnumber;
-
-            scaled -= el->d;
-            prevnumber++;
-        }
 
         /* might have been discontinuity */
         prevnumber = el->number;
+
+        /* whole run at once, as repeats can span hours */
+        const stime_t span = el->d * (stime_t)(el->r + 1);
+        if(scaled <= span)
+        {
+            if(scaled > el->d)
+                prevnumber += (scaled - 1) / el->d;
+            return prevnumber;
+        }
+        scaled -= span;
+        prevnumber += el->r;
     }
 
     return prevnumber;
@@ -241,9 +247,17 @@ void SegmentTimeline::mergeWith(SegmentTimeline &other)
         }
         else /* Did not exist in previous list */
         {
-            elements.push_back(el);
             el->number = last->number + last->r + 1;
-            last = el;
+            if(last->appendable(el->number, el->d, el->t))
+            {
+                last->r += el->r + 1;
+                delete el;
+            }
+            else
+            {
+                elements.push_back(el);
+                last = el;
+            }
         }
     }
 }
@@ -283,6 +297,11 @@ SegmentTimeline::Element::Element(uint64_t number_, stime_t d_, uint64_t r_, sti
     r = r_;
 }
 
+bool SegmentTimeline::Element::appendable(uint64_t number_, stime_t d_, stime_t t_) const
+{
+    return d_ == d && number_ == number + r + 1 && t_ == t + (stime_t)(r + 1) * d;
+}
+
 bool SegmentTimeline::Element::contains(stime_t time) const
 {
     if(time >= t && time < t + (stime_t)(r + 1) * d)
@@ -63,6 +63,7 @@ namespace adaptive
                         Element(uint64_t, stime_t, uint64_t, stime_t);
                         void debug(vlc_object_t *, int = 0) const;
                         bool contains(stime_t) const;
+                        bool appendable(uint64_t, stime_t, stime_t) const;
                         stime_t  t;
                         stime_t  d;
                         uint64_t r;
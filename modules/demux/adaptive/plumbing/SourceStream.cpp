@@ -33,7 +33,6 @@ using namespace adaptive;
 
 ChunksSourceStream::ChunksSourceStream(vlc_object_t *p_obj_, ChunksSource *source_)
 {
-    p_block = NULL;
     b_eof = false;
     p_obj = p_obj_;
     source = source_;
@@ -46,9 +45,6 @@ ChunksSourceStream::~ChunksSourceStream()
 
 void ChunksSourceStream::Reset()
 {
-    if(p_block)
-        block_Release(p_block);
-    p_block = NULL;
     b_eof = false;
 }
 
@@ -58,7 +54,10 @@ stream_t * ChunksSourceStream::makeStream()
     if(p_stream)
     {
         p_stream->pf_control = control_Callback;
-        p_stream->pf_read = read_Callback;
+        /* Hands over the downloaded blocks, which block readers
+         * then get without any copy */
+        p_stream->pf_read = NULL;
+        p_stream->pf_block = block_Callback;
         p_stream->pf_readdir = NULL;
         p_stream->pf_seek = seek_Callback;
         p_stream->p_sys = reinterpret_cast<stream_sys_t*>(this);
@@ -66,46 +65,32 @@ stream_t * ChunksSourceStream::makeStream()
     return p_stream;
 }
 
-ssize_t ChunksSourceStream::Read(uint8_t *buf, size_t size)
+block_t * ChunksSourceStream::Block(bool *pb_eof)
 {
-    size_t i_copied = 0;
-    size_t i_toread = size;
-
-    while(i_toread && !b_eof)
+    while(!b_eof)
     {
-        if(!p_block && !(p_block = source->readNextBlock()))
-        {
-            b_eof = true;
+        block_t *p_block = source->readNextBlock();
+        if(!p_block)
             break;
-        }
 
-        if(p_block->i_buffer > i_toread)
+        if(p_block->i_buffer)
         {
-            if(buf)
-                memcpy(buf + i_copied, p_block->p_buffer, i_toread);
-            i_copied += i_toread;
-            p_block->p_buffer += i_toread;
-            p_block->i_buffer -= i_toread;
-            i_toread = 0;
-        }
-        else
-        {
-            if(buf)
-                memcpy(buf + i_copied, p_block->p_buffer, p_block->i_buffer);
-            i_copied += p_block->i_buffer;
-            i_toread -= p_block->i_buffer;
-            block_Release(p_block);
-            p_block = NULL;
+            /* chunks flags are not meant for the demuxer */
+            p_block->i_flags = 0;
+            return p_block;
         }
+        block_Release(p_block);
     }
 
-    return i_copied;
+    b_eof = true;
+    *pb_eof = true;
+    return NULL;
 }
 
-ssize_t ChunksSourceStream::read_Callback(stream_t *s, void *buf, size_t size)
+block_t * ChunksSourceStream::block_Callback(stream_t *s, bool *pb_eof)
 {
     ChunksSourceStream *me = reinterpret_cast<ChunksSourceStream *>(s->p_sys);
-    return me->Read(reinterpret_cast<uint8_t *>(buf), size);
+    return me->Block(pb_eof);
 }
 
 int ChunksSourceStream::seek_Callback(stream_t *, uint64_t)
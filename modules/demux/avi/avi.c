@@ -140,6 +140,7 @@ typedef struct
 static void avi_index_Init( avi_index_t * );
 static void avi_index_Clean( avi_index_t * );
 static void avi_index_Append( avi_index_t *, off_t *, avi_entry_t * );
+static void avi_index_Reserve( avi_index_t *, unsigned int );
 
 typedef struct
 {
@@ -2317,10 +2318,9 @@ static void avi_index_Append( avi_index_t *p_index, off_t *pi_last_pos,
     /* add the entry */
     if( p_index->i_size >= p_index->i_max )
     {
-        p_index->i_max += 16384;
-        p_index->p_entry = realloc_or_free( p_index->p_entry,
-                                            p_index->i_max * sizeof( *p_index->p_entry ) );
-        if( !p_index->p_entry )
+        /* grow geometrically, multi-GB files have millions of entries */
+        avi_index_Reserve( p_index, __MAX( 16384, p_index->i_max * 2 ) );
+        if( p_index->i_size >= p_index->i_max )
             return;
     }
     /* calculate cumulate length */
@@ -2338,6 +2338,19 @@ static void avi_index_Append( avi_index_t *p_index, off_t *pi_last_pos,
     p_index->p_entry[p_index->i_size++] = *p_entry;
 }
 
+static void avi_index_Reserve( avi_index_t *p_index, unsigned int i_max )
+{
+    if( i_max <= p_index->i_max || i_max > SIZE_MAX / sizeof( *p_index->p_entry ) )
+        return;
+
+    avi_entry_t *p_entry = realloc( p_index->p_entry,
+                                    i_max * sizeof( *p_index->p_entry ) );
+    if( !p_entry )
+        return;
+    p_index->p_entry = p_entry;
+    p_index->i_max = i_max;
+}
+
 static int AVI_IndexFind_idx1( demux_t *p_demux,
                                avi_chunk_idx1_t **pp_idx1,
                                uint64_t *pi_offset )
@@ -2401,8 +2414,11 @@ static int AVI_IndexFind_idx1( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
+/* Streams whose indx index already has more than p_min_size[] entries
+ * are skipped, as the longest index is used */
 static int AVI_IndexLoad_idx1( demux_t *p_demux,
-                               avi_index_t p_index[], off_t *pi_last_offset )
+                               avi_index_t p_index[], off_t *pi_last_offset,
+                               const avi_index_t p_min_size[] )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
@@ -2413,6 +2429,9 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
 
     p_sys->b_indexloaded = true;
 
+    /* Count the entries first so that each array is allocated once */
+    unsigned pi_count[p_sys->i_track];
+    memset( pi_count, 0, sizeof( pi_count ) );
     for( unsigned i_index = 0; i_index < p_idx1->i_entry_count; i_index++ )
     {
         unsigned i_cat;
@@ -2423,6 +2442,27 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
                                &i_cat );
         if( i_stream < p_sys->i_track &&
             (i_cat == p_sys->track[i_stream]->i_cat || i_cat == UNKNOWN_ES ) )
+            pi_count[i_stream]++;
+    }
+
+    bool pb_load[p_sys->i_track];
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        pb_load[i] = pi_count[i] >= p_min_size[i].i_size;
+        if( pb_load[i] )
+            avi_index_Reserve( &p_index[i], pi_count[i] );
+    }
+
+    for( unsigned i_index = 0; i_index < p_idx1->i_entry_count; i_index++ )
+    {
+        unsigned i_cat;
+        unsigned i_stream;
+
+        AVI_ParseStreamHeader( p_idx1->entry[i_index].i_fourcc,
+                               &i_stream,
+                               &i_cat );
+        if( i_stream < p_sys->i_track && pb_load[i_stream] &&
+            (i_cat == p_sys->track[i_stream]->i_cat || i_cat == UNKNOWN_ES ) )
         {
             avi_entry_t index;
             index.i_id     = p_idx1->entry[i_index].i_fourcc;
@@ -2574,7 +2614,7 @@ static void AVI_IndexLoad( demux_t *p_demux )
 
     AVI_IndexLoad_indx( p_demux, p_idx_indx, &i_indx_last_pos );
     if( !p_sys->b_odml )
-        AVI_IndexLoad_idx1( p_demux, p_idx_idx1, &i_idx1_last_pos );
+        AVI_IndexLoad_idx1( p_demux, p_idx_idx1, &i_idx1_last_pos, p_idx_indx );
 
     /* Select the longest index */
     for( unsigned i = 0; i < p_sys->i_track; i++ )
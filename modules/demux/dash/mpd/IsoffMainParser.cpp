@@ -172,6 +172,13 @@ size_t IsoffMainParser::parseSegmentTemplate(Node *templateNode, SegmentInformat
     if(templateNode->hasAttribute("duration"))
         mediaTemplate->duration.Set(Integer<stime_t>(templateNode->getAttributeValue("duration")));
 
+    if(templateNode->hasAttribute("availabilityTimeOffset"))
+    {
+        const double offset = Integer<double>(templateNode->getAttributeValue("availabilityTimeOffset"));
+        if(offset > 0.0) /* INF is not meaningful for templates */
+            mediaTemplate->availabilityTimeOffset.Set(offset * CLOCK_FREQ);
+    }
+
     InitSegmentTemplate *initTemplate = NULL;
 
     if(templateNode->hasAttribute("initialization"))
@@ -42,6 +42,7 @@ HLSSegment::HLSSegment( ICanonicalUrl *parent, uint64_t seq ) :
     Segment( parent )
 {
     setSequenceNumber(seq);
+    mediaSequence = seq;
     utcTime = 0;
 #ifdef HAVE_GCRYPT
     ctx = NULL;
@@ -72,10 +73,10 @@ void HLSSegment::onChunkDownload(block_t **pp_block, SegmentChunk *chunk, BaseRe
             {
                 encryption.iv.clear();
                 encryption.iv.resize(16);
-                encryption.iv[15] = (getSequenceNumber() - Segment::SEQUENCE_FIRST) & 0xff;
-                encryption.iv[14] = ((getSequenceNumber() - Segment::SEQUENCE_FIRST) >> 8)& 0xff;
-                encryption.iv[13] = ((getSequenceNumber() - Segment::SEQUENCE_FIRST) >> 16)& 0xff;
-                encryption.iv[12] = ((getSequenceNumber() - Segment::SEQUENCE_FIRST) >> 24)& 0xff;
+                encryption.iv[15] = mediaSequence & 0xff;
+                encryption.iv[14] = (mediaSequence >> 8)& 0xff;
+                encryption.iv[13] = (mediaSequence >> 16)& 0xff;
+                encryption.iv[12] = (mediaSequence >> 24)& 0xff;
             }
 
             if( gcry_cipher_open(&ctx, GCRY_CIPHER_AES, GCRY_CIPHER_MODE_CBC, 0) ||
@@ -59,6 +59,7 @@ namespace hls
 
             protected:
                 mtime_t utcTime;
+                uint64_t mediaSequence; /* differs from number for partial segments */
                 virtual void onChunkDownload(block_t **, SegmentChunk *, BaseRepresentation *); /* reimpl */
 
                 SegmentEncryption encryption;
@@ -45,6 +45,11 @@ using namespace adaptive;
 using namespace adaptive::playlist;
 using namespace hls::playlist;
 
+/* Low latency numbering: parts of media sequence N are numbered from
+ * N * HLS_PART_NUMBER_SCALE, so that whole segments and their parts can
+ * follow each other in a same list */
+#define HLS_PART_NUMBER_SCALE 1000
+
 M3U8Parser::M3U8Parser()
 {
 }
@@ -179,10 +184,115 @@ bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, Representati
     return false;
 }
 
+mtime_t M3U8Parser::appendParts(Representation *rep, SegmentList *segmentList,
+                                const std::list<const AttributesTag *> &parts,
+                                const AttributesTag *hint, uint64_t sequenceNumber,
+                                mtime_t nzStartTime, mtime_t absReferenceTime,
+                                bool discontinuity)
+{
+    mtime_t nzDuration = 0;
+    uint64_t number = sequenceNumber * HLS_PART_NUMBER_SCALE;
+    std::string prevuri;
+    std::size_t prevbyterangeoffset = 0;
+
+    std::list<const AttributesTag *> list = parts;
+    if(hint && hint->getAttributeByName("TYPE") &&
+       hint->getAttributeByName("TYPE")->value == "PART")
+        list.push_back(hint);
+
+    std::list<const AttributesTag *>::const_iterator it;
+    for(it = list.begin(); it != list.end(); ++it, ++number)
+    {
+        const AttributesTag *tag = *it;
+        const Attribute *uriAttr = tag->getAttributeByName("URI");
+        if(!uriAttr || number - sequenceNumber * HLS_PART_NUMBER_SCALE >= HLS_PART_NUMBER_SCALE)
+            break;
+
+        mtime_t nzPartDuration;
+        std::pair<std::size_t,std::size_t> range(0, 0);
+        if(tag == hint)
+        {
+            /* blocking request on the part being produced */
+            nzPartDuration = rep->partTargetDuration;
+            const Attribute *startAttr = tag->getAttributeByName("BYTERANGE-START");
+            const Attribute *lengthAttr = tag->getAttributeByName("BYTERANGE-LENGTH");
+            if(lengthAttr)
+                range = std::make_pair(startAttr ? startAttr->decimal() : 0,
+                                       lengthAttr->decimal());
+            else if(startAttr && startAttr->decimal())
+                break; /* open ended ranges are unsupported */
+        }
+        else
+        {
+            const Attribute *durAttr = tag->getAttributeByName("DURATION");
+            nzPartDuration = durAttr ? CLOCK_FREQ * durAttr->floatingPoint() : 0;
+            const Attribute *byterangeAttr = tag->getAttributeByName("BYTERANGE");
+            if(byterangeAttr)
+            {
+                range = byterangeAttr->unescapeQuotes().getByteRange();
+                /* no offset means it follows the previous part of the same resource */
+                if(byterangeAttr->value.find('@') == std::string::npos)
+                    range.first = (prevuri == uriAttr->quotedString()) ? prevbyterangeoffset : 0;
+            }
+        }
+
+        const Attribute *gapAttr = tag->getAttributeByName("GAP");
+        if(!gapAttr || gapAttr->value != "YES")
+        {
+            HLSSegment *segment = new (std::nothrow) HLSSegment(rep, number);
+            if(!segment)
+                break;
+            segment->mediaSequence = sequenceNumber;
+            segment->setSourceUrl(uriAttr->quotedString());
+            if((unsigned)rep->getStreamFormat() == StreamFormat::UNKNOWN)
+                setFormatFromExtension(rep, uriAttr->quotedString());
+
+            segment->duration.Set(rep->getTimescale().ToScaled(nzPartDuration));
+            segment->startTime.Set(rep->getTimescale().ToScaled(nzStartTime + nzDuration));
+            if(absReferenceTime > VLC_TS_INVALID)
+                segment->utcTime = absReferenceTime + nzDuration;
+
+            if(range.second)
+                segment->setByteRange(range.first, range.first + range.second - 1);
+
+            if(discontinuity)
+            {
+                segment->discontinuity = true;
+                discontinuity = false;
+            }
+
+            segmentList->addSegment(segment);
+        }
+
+        prevuri = uriAttr->quotedString();
+        prevbyterangeoffset = range.first + range.second;
+        nzDuration += nzPartDuration;
+    }
+
+    return nzDuration;
+}
+
 void M3U8Parser::parseSegments(vlc_object_t *p_obj, Representation *rep, const std::list<Tag *> &tagslist)
 {
     SegmentList *segmentList = new (std::nothrow) SegmentList(rep);
 
+    /* On live refresh, the segments up to the last known one are already
+     * in the representation: only account for their timeline */
+    bool b_refresh = false;
+    bool b_knowninit = false;
+    uint64_t knownNumber = 0;
+    if(rep->b_loaded)
+    {
+        std::vector<ISegment *> known;
+        if(rep->getSegments(SegmentInformation::INFOTYPE_MEDIA, known))
+        {
+            b_refresh = true;
+            knownNumber = known.back()->getSequenceNumber();
+        }
+        known.clear();
+        b_knowninit = rep->getSegments(SegmentInformation::INFOTYPE_INIT, known);
+    }
+
     rep->setTimescale(100);
     rep->b_loaded = true;
 
@@ -196,6 +306,13 @@ void M3U8Parser::parseSegments(vlc_object_t *p_obj, Representation *rep, const s
     SegmentEncryption encryption;
     const ValuesListTag *ctx_extinf = NULL;
 
+    /* Partial segments of the next segment, played instead of it when
+     * going for a low latency */
+    const bool b_lowlatency = var_InheritBool(p_obj, "adaptive-lowlatency");
+    const uint64_t numberScale = (b_lowlatency) ? HLS_PART_NUMBER_SCALE : 1;
+    std::list<const AttributesTag *> ctx_parts;
+    const AttributesTag *ctx_preloadhint = NULL;
+
     std::list<Tag *>::const_iterator it;
     for(it = tagslist.begin(); it != tagslist.end(); ++it)
     {
@@ -222,12 +339,72 @@ void M3U8Parser::parseSegments(vlc_object_t *p_obj, Representation *rep, const s
                 {
                     ctx_extinf = NULL;
                     ctx_byterange = NULL;
+                    ctx_parts.clear();
+                    break;
+                }
+
+                if(!ctx_parts.empty() && encryption.method == SegmentEncryption::NONE)
+                {
+                    const bool b_known = b_refresh && ctx_extinf &&
+                                         ctx_extinf->getAttributeByName("DURATION") &&
+                                         knownNumber >= (sequenceNumber + 1) * HLS_PART_NUMBER_SCALE - 1;
+                    const mtime_t nzPartsDuration = (b_known) ? 0 :
+                                                    appendParts(rep, segmentList, ctx_parts, NULL,
+                                                                sequenceNumber, nzStartTime,
+                                                                absReferenceTime, discontinuity);
+                    /* stay aligned on the segments timeline */
+                    const mtime_t nzDuration = (ctx_extinf && ctx_extinf->getAttributeByName("DURATION"))
+                        ? CLOCK_FREQ * ctx_extinf->getAttributeByName("DURATION")->floatingPoint()
+                        : nzPartsDuration;
+                    nzStartTime += nzDuration;
+                    totalduration += nzDuration;
+                    if(absReferenceTime > VLC_TS_INVALID)
+                        absReferenceTime += nzDuration;
+                    if(ctx_byterange)
+                    {
+                        std::pair<std::size_t,std::size_t> range = ctx_byterange->getValue().getByteRange();
+                        if(range.first == 0)
+                            range.first = prevbyterangeoffset;
+                        prevbyterangeoffset = range.first + range.second;
+                    }
+                    discontinuity = false;
+                    ctx_extinf = NULL;
+                    ctx_byterange = NULL;
+                    ctx_parts.clear();
+                    sequenceNumber++;
                     break;
                 }
+                ctx_parts.clear();
 
-                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
+                if(b_refresh && sequenceNumber * numberScale <= knownNumber)
+                {
+                    /* already known, and would be dropped when merging */
+                    if(ctx_extinf && ctx_extinf->getAttributeByName("DURATION"))
+                    {
+                        const mtime_t nzDuration = CLOCK_FREQ * ctx_extinf->getAttributeByName("DURATION")->floatingPoint();
+                        nzStartTime += nzDuration;
+                        totalduration += nzDuration;
+                        if(absReferenceTime > VLC_TS_INVALID)
+                            absReferenceTime += nzDuration;
+                    }
+                    if(ctx_byterange)
+                    {
+                        std::pair<std::size_t,std::size_t> range = ctx_byterange->getValue().getByteRange();
+                        if(range.first == 0)
+                            range.first = prevbyterangeoffset;
+                        prevbyterangeoffset = range.first + range.second;
+                    }
+                    discontinuity = false;
+                    ctx_extinf = NULL;
+                    ctx_byterange = NULL;
+                    sequenceNumber++;
+                    break;
+                }
+
+                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber * numberScale);
                 if(!segment)
                     break;
+                segment->mediaSequence = sequenceNumber++;
 
                 segment->setSourceUrl(uritag->getValue().value);
                 if((unsigned)rep->getStreamFormat() == StreamFormat::UNKNOWN)
@@ -309,15 +486,26 @@ void M3U8Parser::parseSegments(vlc_object_t *p_obj, Representation *rep, const s
                         keyurl.prepend(Helper::getDirectoryPath(rep->getPlaylistUrl().toString()).append("/"));
                     }
 
-                    block_t *p_block = Retrieve::HTTP(p_obj, keyurl.toString());
-                    if(p_block)
+                    /* Live refreshes repeat the same key: only fetch new ones */
+                    const std::string keyurlstr = keyurl.toString();
+                    if(keyurlstr == rep->keyUrl)
                     {
-                        if(p_block->i_buffer == 16)
+                        encryption.key = rep->key;
+                    }
+                    else
+                    {
+                        block_t *p_block = Retrieve::HTTP(p_obj, keyurlstr);
+                        if(p_block)
                         {
-                            encryption.key.resize(16);
-                            memcpy(&encryption.key[0], p_block->p_buffer, 16);
+                            if(p_block->i_buffer == 16)
+                            {
+                                encryption.key.resize(16);
+                                memcpy(&encryption.key[0], p_block->p_buffer, 16);
+                                rep->keyUrl = keyurlstr;
+                                rep->key = encryption.key;
+                            }
+                            block_Release(p_block);
                         }
-                        block_Release(p_block);
                     }
 
                     if(keytag->getAttributeByName("IV"))
@@ -341,6 +529,7 @@ void M3U8Parser::parseSegments(vlc_object_t *p_obj, Representation *rep, const s
                 const AttributesTag *keytag = static_cast<const AttributesTag *>(tag);
                 const Attribute *uriAttr;
                 if(keytag && (uriAttr = keytag->getAttributeByName("URI")) &&
+                   !b_knowninit && /* would be dropped when merging */
                    !segmentList->initialisationSegment.Get()) /* FIXME: handle discontinuities */
                 {
                     InitSegment *initSegment = new (std::nothrow) InitSegment(rep);
@@ -366,9 +555,36 @@ void M3U8Parser::parseSegments(vlc_object_t *p_obj, Representation *rep, const s
             case Tag::EXTXENDLIST:
                 rep->b_live = false;
                 break;
+
+            case AttributesTag::EXTXPART:
+                if(b_lowlatency)
+                    ctx_parts.push_back(static_cast<const AttributesTag *>(tag));
+                break;
+
+            case AttributesTag::EXTXPRELOADHINT:
+                if(b_lowlatency)
+                    ctx_preloadhint = static_cast<const AttributesTag *>(tag);
+                break;
+
+            case AttributesTag::EXTXPARTINF:
+            {
+                const Attribute *targetAttr =
+                        static_cast<const AttributesTag *>(tag)->getAttributeByName("PART-TARGET");
+                if(b_lowlatency && targetAttr)
+                    rep->partTargetDuration = CLOCK_FREQ * targetAttr->floatingPoint();
+            }
+            break;
         }
     }
 
+    /* Parts of the segment being produced, up to the announced next one */
+    if(rep->isLive() && (!ctx_parts.empty() || ctx_preloadhint) &&
+       encryption.method == SegmentEncryption::NONE)
+    {
+        appendParts(rep, segmentList, ctx_parts, ctx_preloadhint, sequenceNumber,
+                    nzStartTime, absReferenceTime, discontinuity);
+    }
+
     if(rep->isLive())
     {
         rep->getPlaylist()->duration.Set(0);
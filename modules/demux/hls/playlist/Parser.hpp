@@ -32,6 +32,7 @@ namespace adaptive
     namespace playlist
     {
         class SegmentInformation;
+        class SegmentList;
         class MediaSegmentTemplate;
         class BasePeriod;
         class BaseAdaptationSet;
@@ -63,6 +64,9 @@ namespace hls
                 void createAndFillRepresentation(vlc_object_t *, BaseAdaptationSet *,
                                                  const AttributesTag *, const std::list<Tag *>&);
                 void parseSegments(vlc_object_t *, Representation *, const std::list<Tag *>&);
+                mtime_t appendParts(Representation *, SegmentList *,
+                                    const std::list<const AttributesTag *> &,
+                                    const AttributesTag *, uint64_t, mtime_t, mtime_t, bool);
                 void setFormatFromExtension(Representation *rep, const std::string &);
                 std::list<Tag *> parseEntries(stream_t *);
         };
@@ -32,8 +32,6 @@
 #include "../adaptive/playlist/BaseAdaptationSet.h"
 #include "../adaptive/playlist/SegmentList.h"
 
-#include <ctime>
-
 using namespace hls;
 using namespace hls::playlist;
 
@@ -45,6 +43,7 @@ Representation::Representation  ( BaseAdaptationSet *set ) :
     switchpolicy = SegmentInformation::SWITCH_SEGMENT_ALIGNED; /* FIXME: based on streamformat */
     nextUpdateTime = 0;
     targetDuration = 0;
+    partTargetDuration = 0;
     streamFormat = StreamFormat::UNKNOWN;
 }
 
@@ -102,14 +101,19 @@ void Representation::debug(vlc_object_t *obj, int indent) const
 void Representation::scheduleNextUpdate(uint64_t number)
 {
     const AbstractPlaylist *playlist = getPlaylist();
-    const time_t now = time(NULL);
+    const mtime_t now = mdate();
 
     /* Compute new update time */
     mtime_t minbuffer = getMinAheadTime(number);
 
+    /* Partial segments are only announced in the next playlist */
+    if(partTargetDuration)
+    {
+        minbuffer = partTargetDuration;
+    }
     /* Update frequency must always be at least targetDuration (if any)
      * but we need to update before reaching that last segment, thus -1 */
-    if(targetDuration)
+    else if(targetDuration)
     {
         if(minbuffer > CLOCK_FREQ * ( 2 * targetDuration + 1 ))
             minbuffer -= CLOCK_FREQ * ( targetDuration + 1 );
@@ -124,22 +128,22 @@ void Representation::scheduleNextUpdate(uint64_t number)
             minbuffer /= 2;
     }
 
-    nextUpdateTime = now + minbuffer / CLOCK_FREQ;
+    nextUpdateTime = now + minbuffer;
 
-    msg_Dbg(playlist->getVLCObject(), "Updated playlist ID %s, next update in %" PRId64 "s",
-            getID().str().c_str(), (mtime_t) nextUpdateTime - now);
+    msg_Dbg(playlist->getVLCObject(), "Updated playlist ID %s, next update in %" PRId64 "ms",
+            getID().str().c_str(), (nextUpdateTime - now) / 1000);
 
     debug(playlist->getVLCObject(), 0);
 }
 
 bool Representation::needsUpdate() const
 {
-    return !b_loaded || (isLive() && nextUpdateTime < time(NULL));
+    return !b_loaded || (isLive() && nextUpdateTime < mdate());
 }
 
 bool Representation::runLocalUpdates(mtime_t, uint64_t number, bool prune)
 {
-    const time_t now = time(NULL);
+    const mtime_t now = mdate();
     const AbstractPlaylist *playlist = getPlaylist();
     if(!b_loaded || (isLive() && nextUpdateTime < now))
     {
@@ -25,6 +25,9 @@
 #include "../adaptive/tools/Properties.hpp"
 #include "../adaptive/StreamFormat.hpp"
 
+#include <string>
+#include <vector>
+
 namespace hls
 {
     namespace playlist
@@ -57,9 +60,12 @@ namespace hls
                 StreamFormat streamFormat;
                 bool b_live;
                 bool b_loaded;
-                time_t nextUpdateTime;
+                mtime_t nextUpdateTime;
                 time_t targetDuration;
+                mtime_t partTargetDuration; /* set when parts are played */
                 Url playlistUrl;
+                std::string keyUrl; /* last fetched AES-128 key, for refreshes */
+                std::vector<uint8_t> key;
         };
     }
 }
@@ -279,43 +279,56 @@ void ValuesListTag::parseAttributes(const std::string &field)
     }
 }
 
-Tag * TagFactory::createTagByName(const std::string &name, const std::string &value)
+namespace
 {
-    struct
+    struct exttagmapping_s
     {
         const char *psz;
-        const int i;
-    } const exttagmapping[] = {
+        int i;
+    };
+
+    /* sorted by name, for bsearch */
+    const struct exttagmapping_s exttagmapping[] = {
+        {"",                                SingleValueTag::URI},
         {"EXT-X-BYTERANGE",                 SingleValueTag::EXTXBYTERANGE},
         {"EXT-X-DISCONTINUITY",             Tag::EXTXDISCONTINUITY},
-        {"EXT-X-KEY",                       AttributesTag::EXTXKEY},
-        {"EXT-X-MAP",                       AttributesTag::EXTXMAP},
-        {"EXT-X-PROGRAM-DATE-TIME",         SingleValueTag::EXTXPROGRAMDATETIME},
-        {"EXT-X-TARGETDURATION",            SingleValueTag::EXTXTARGETDURATION},
-        {"EXT-X-MEDIA-SEQUENCE",            SingleValueTag::EXTXMEDIASEQUENCE},
         {"EXT-X-DISCONTINUITY-SEQUENCE",    SingleValueTag::EXTXDISCONTINUITYSEQUENCE},
         {"EXT-X-ENDLIST",                   Tag::EXTXENDLIST},
-        {"EXT-X-PLAYLIST-TYPE",             SingleValueTag::EXTXPLAYLISTTYPE},
         {"EXT-X-I-FRAMES-ONLY",             Tag::EXTXIFRAMESONLY},
+        {"EXT-X-KEY",                       AttributesTag::EXTXKEY},
+        {"EXT-X-MAP",                       AttributesTag::EXTXMAP},
         {"EXT-X-MEDIA",                     AttributesTag::EXTXMEDIA},
+        {"EXT-X-MEDIA-SEQUENCE",            SingleValueTag::EXTXMEDIASEQUENCE},
+        {"EXT-X-PART",                      AttributesTag::EXTXPART},
+        {"EXT-X-PART-INF",                  AttributesTag::EXTXPARTINF},
+        {"EXT-X-PLAYLIST-TYPE",             SingleValueTag::EXTXPLAYLISTTYPE},
+        {"EXT-X-PRELOAD-HINT",              AttributesTag::EXTXPRELOADHINT},
+        {"EXT-X-PROGRAM-DATE-TIME",         SingleValueTag::EXTXPROGRAMDATETIME},
         {"EXT-X-STREAM-INF",                AttributesTag::EXTXSTREAMINF},
+        {"EXT-X-TARGETDURATION",            SingleValueTag::EXTXTARGETDURATION},
         {"EXTINF",                          ValuesListTag::EXTINF},
-        {"",                                SingleValueTag::URI},
-        {NULL,                              0},
     };
 
-
-    for(int i=0; exttagmapping[i].psz; i++)
+    int exttagmapping_cmp(const void *key, const void *elem)
     {
-        if(name != exttagmapping[i].psz)
-            continue;
+        return strcmp(static_cast<const char *>(key),
+                      static_cast<const struct exttagmapping_s *>(elem)->psz);
+    }
+}
 
-        switch(exttagmapping[i].i)
+Tag * TagFactory::createTagByName(const std::string &name, const std::string &value)
+{
+    const struct exttagmapping_s *mapping = static_cast<const struct exttagmapping_s *>(
+            bsearch(name.c_str(), exttagmapping, ARRAY_SIZE(exttagmapping),
+                    sizeof(exttagmapping[0]), exttagmapping_cmp));
+    if(mapping)
+    {
+        switch(mapping->i)
         {
         case Tag::EXTXDISCONTINUITY:
         case Tag::EXTXENDLIST:
         case Tag::EXTXIFRAMESONLY:
-            return new (std::nothrow) Tag(exttagmapping[i].i);
+            return new (std::nothrow) Tag(mapping->i);
 
         case SingleValueTag::URI:
         case SingleValueTag::EXTXVERSION:
@@ -325,20 +338,21 @@ Tag * TagFactory::createTagByName(const std::string &name, const std::string &va
         case SingleValueTag::EXTXMEDIASEQUENCE:
         case SingleValueTag::EXTXDISCONTINUITYSEQUENCE:
         case SingleValueTag::EXTXPLAYLISTTYPE:
-            return new (std::nothrow) SingleValueTag(exttagmapping[i].i, value);
+            return new (std::nothrow) SingleValueTag(mapping->i, value);
 
         case ValuesListTag::EXTINF:
-            return new (std::nothrow) ValuesListTag(exttagmapping[i].i, value);
+            return new (std::nothrow) ValuesListTag(mapping->i, value);
 
         case AttributesTag::EXTXKEY:
         case AttributesTag::EXTXMAP:
         case AttributesTag::EXTXMEDIA:
         case AttributesTag::EXTXSTREAMINF:
-            return new (std::nothrow) AttributesTag(exttagmapping[i].i, value);
+        case AttributesTag::EXTXPART:
+        case AttributesTag::EXTXPARTINF:
+        case AttributesTag::EXTXPRELOADHINT:
+            return new (std::nothrow) AttributesTag(mapping->i, value);
         }
-
     }
 
-
     return NULL;
 }
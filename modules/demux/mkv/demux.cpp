@@ -789,7 +789,10 @@ bool demux_sys_t::PreparePlayback( virtual_segment_c & new_vsegment, mtime_t i_m
     if( !p_current_vsegment->CurrentSegment() )
         return false;
     if( !p_current_vsegment->CurrentSegment()->b_cues )
+    {
         msg_Warn( &p_current_vsegment->CurrentSegment()->sys.demuxer, "no cues/empty cues found->seek won't be precise" );
+        p_current_vsegment->CurrentSegment()->_seeker.start_indexing( *p_current_vsegment->CurrentSegment() );
+    }
 
     f_duration = p_current_vsegment->Duration();
 
@@ -1199,7 +1199,9 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
             }
 
             vars.simpleblock = &ksblock;
-            vars.simpleblock->ReadData( vars.obj->es.I_O() );
+            /* only the header and lacing, the frames are read straight
+             * into their block_t by BlockDecode */
+            vars.simpleblock->ReadData( vars.obj->es.I_O(), SCOPE_PARTIAL_DATA );
             vars.simpleblock->SetParent( *vars.obj->cluster );
 
             if( ksblock.IsKeyframe() )
@@ -47,6 +47,218 @@ namespace {
 
     template<class It> It prev_( It it ) { return --it; }
     template<class It> It next_( It it ) { return ++it; }
+
+    // minimal EBML element header reader, so that the indexing thread does
+    // not share any libebml state with the demuxer
+
+    bool read_vint( uint8_t const* p, size_t i_size, size_t* pi_len, uint64_t* pi_value, bool b_id )
+    {
+        if( i_size == 0 || p[0] == 0 )
+            return false;
+
+        size_t i_len = 1;
+        while( !( p[0] & ( 0x80 >> ( i_len - 1 ) ) ) )
+            i_len++;
+
+        if( i_len > i_size || ( b_id && i_len > 4 ) )
+            return false;
+
+        uint64_t i_value = b_id ? p[0] : ( p[0] & ( 0xFF >> i_len ) );
+        bool b_unknown = i_value == uint64_t( 0xFF >> i_len );
+        for( size_t i = 1; i < i_len; i++ )
+        {
+            i_value = ( i_value << 8 ) | p[i];
+            b_unknown &= p[i] == 0xFF;
+        }
+
+        *pi_len   = i_len;
+        *pi_value = ( !b_id && b_unknown ) ? UINT64_MAX : i_value;
+        return true;
+    }
+
+    bool read_element_header( uint8_t const* p, size_t i_size, size_t* pi_len,
+                              uint64_t* pi_id, uint64_t* pi_data_size )
+    {
+        size_t i_id_len, i_size_len;
+
+        if( !read_vint( p, i_size, &i_id_len, pi_id, true ) ||
+            !read_vint( p + i_id_len, i_size - i_id_len, &i_size_len, pi_data_size, false ) )
+            return false;
+
+        *pi_len = i_id_len + i_size_len;
+        return true;
+    }
+
+    uint64_t const EBML_ID_CLUSTER          = 0x1F43B675;
+    uint64_t const EBML_ID_CLUSTER_TIMECODE = 0xE7;
+}
+
+SegmentSeeker::SegmentSeeker()
+    : _index_obj( NULL )
+    , _index_mrl( NULL )
+    , _index_running( false )
+    , _index_abort( false )
+{
+    vlc_mutex_init( &_index_lock );
+}
+
+SegmentSeeker::~SegmentSeeker()
+{
+    stop_indexing();
+    vlc_mutex_destroy( &_index_lock );
+}
+
+void
+SegmentSeeker::start_indexing( matroska_segment_c& ms )
+{
+    if( _index_running )
+        return;
+
+    // only scan local files, a second connection to a remote server would
+    // compete with the playback
+    vlc_stream_io_callback& io = static_cast<vlc_stream_io_callback&>( ms.es.I_O() );
+    stream_t* s = io.getStream();
+
+    if( s->psz_filepath == NULL || s->psz_url == NULL )
+        return;
+
+    _index_mrl = strdup( s->psz_url );
+    if( _index_mrl == NULL )
+        return;
+
+    _index_obj       = VLC_OBJECT( &ms.sys.demuxer );
+    _index_start     = ms.segment->GetGlobalPosition( 0 );
+    _index_end       = ms.segment->IsFiniteSize() ? ms.segment->GetEndPosition()
+                                                  : std::numeric_limits<fptr_t>::max();
+    _index_timescale = ms.i_timescale;
+    _index_abort     = false;
+
+    _index_running = !vlc_clone( &_index_thread, index_thread, this, VLC_THREAD_PRIORITY_LOW );
+    if( !_index_running )
+    {
+        free( _index_mrl );
+        _index_mrl = NULL;
+    }
+}
+
+void
+SegmentSeeker::stop_indexing()
+{
+    if( !_index_running )
+        return;
+
+    vlc_mutex_lock( &_index_lock );
+    _index_abort = true;
+    vlc_mutex_unlock( &_index_lock );
+
+    vlc_join( _index_thread, NULL );
+    _index_running = false;
+
+    free( _index_mrl );
+    _index_mrl = NULL;
+}
+
+void *
+SegmentSeeker::index_thread( void * data )
+{
+    static_cast<SegmentSeeker*>( data )->index_clusters();
+    return NULL;
+}
+
+void
+SegmentSeeker::index_clusters()
+{
+    stream_t* s = vlc_stream_NewMRL( _index_obj, _index_mrl );
+    if( s == NULL )
+        return;
+
+    std::vector<Cluster> found;
+    fptr_t fpos = _index_start;
+    bool b_abort = false;
+
+    while( fpos < _index_end && !b_abort )
+    {
+        uint8_t const* p_peek;
+        ssize_t i_peek;
+        size_t i_header;
+        uint64_t i_id, i_size;
+
+        if( vlc_stream_Seek( s, fpos ) ||
+            ( i_peek = vlc_stream_Peek( s, &p_peek, 64 ) ) <= 0 ||
+            !read_element_header( p_peek, i_peek, &i_header, &i_id, &i_size ) ||
+            i_size == UINT64_MAX ) // cannot skip over unknown-sized elements
+            break;
+
+        if( i_id == EBML_ID_CLUSTER )
+        {
+            // the timecode is expected to be the first child
+            for( size_t i_offset = i_header; i_offset < size_t( i_peek ); )
+            {
+                size_t i_child_header;
+                uint64_t i_child_id, i_child_size;
+
+                if( !read_element_header( p_peek + i_offset, i_peek - i_offset,
+                                          &i_child_header, &i_child_id, &i_child_size ) ||
+                    i_child_size > size_t( i_peek ) - i_offset - i_child_header )
+                    break;
+
+                i_offset += i_child_header;
+
+                if( i_child_id == EBML_ID_CLUSTER_TIMECODE && i_child_size <= 8 )
+                {
+                    uint64_t i_timecode = 0;
+                    for( size_t i = 0; i < i_child_size; i++ )
+                        i_timecode = ( i_timecode << 8 ) | p_peek[i_offset + i];
+
+                    Cluster cinfo = {
+                        /* fpos     */ fpos,
+                        /* pts      */ mtime_t( i_timecode * _index_timescale / INT64_C( 1000 ) ),
+                        /* duration */ mtime_t( -1 ),
+                        /* size     */ i_header + i_size
+                    };
+                    found.push_back( cinfo );
+                    break;
+                }
+
+                i_offset += i_child_size;
+            }
+        }
+
+        fptr_t const next = fpos + i_header + i_size;
+        if( next <= fpos )
+            break;
+        fpos = next;
+
+        if( found.size() >= 64 || fpos >= _index_end )
+        {
+            vlc_mutex_lock( &_index_lock );
+            _index_pending.insert( _index_pending.end(), found.begin(), found.end() );
+            b_abort = _index_abort;
+            vlc_mutex_unlock( &_index_lock );
+            found.clear();
+        }
+    }
+
+    vlc_mutex_lock( &_index_lock );
+    _index_pending.insert( _index_pending.end(), found.begin(), found.end() );
+    vlc_mutex_unlock( &_index_lock );
+
+    msg_Dbg( _index_obj, "cluster indexing stopped at %" PRIu64, fpos );
+
+    vlc_stream_Delete( s );
+}
+
+void
+SegmentSeeker::merge_indexed_clusters()
+{
+    std::vector<Cluster> pending;
+
+    vlc_mutex_lock( &_index_lock );
+    pending.swap( _index_pending );
+    vlc_mutex_unlock( &_index_lock );
+
+    for( std::vector<Cluster>::const_iterator it = pending.begin(); it != pending.end(); ++it )
+        add_cluster( *it );
 }
 
 SegmentSeeker::cluster_positions_t::iterator
@@ -73,6 +285,12 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
             : UINT64_MAX
     };
 
+    return add_cluster( cinfo );
+}
+
+SegmentSeeker::cluster_map_t::iterator
+SegmentSeeker::add_cluster( Cluster const& cinfo )
+{
     add_cluster_position( cinfo.fpos );
 
     cluster_map_t::iterator it = _clusters.lower_bound( cinfo.pts );
@@ -262,6 +480,8 @@ SegmentSeeker::get_seekpoints( matroska_segment_c& ms, mtime_t target_pts, track
         }
     };
 
+    merge_indexed_clusters();
+
     for( mtime_t needle_pts = target_pts; ; )
     {
         seekpoint_pair_t seekpoints = get_seekpoints_around( needle_pts, priority_tracks );
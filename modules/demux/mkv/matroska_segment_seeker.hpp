@@ -86,6 +86,9 @@ class SegmentSeeker
         };
 
     public:
+        SegmentSeeker();
+        ~SegmentSeeker();
+
         typedef std::vector<track_id_t> track_ids_t;
         typedef std::vector<Range> ranges_t;
         typedef std::vector<Seekpoint> seekpoints_t;
@@ -107,6 +110,11 @@ class SegmentSeeker
 
         cluster_positions_t::iterator add_cluster_position( fptr_t pos );
         cluster_map_t      ::iterator add_cluster( KaxCluster * const );
+        cluster_map_t      ::iterator add_cluster( Cluster const& );
+
+        void start_indexing( matroska_segment_c& );
+        void stop_indexing();
+        void merge_indexed_clusters();
 
         void mkv_jump_to( matroska_segment_c&, fptr_t );
 
@@ -121,6 +129,22 @@ class SegmentSeeker
         tracks_seekpoints_t _tracks_seekpoints;
         cluster_positions_t _cluster_positions;
         cluster_map_t       _clusters;
+
+    private:
+        static void * index_thread( void * );
+        void index_clusters();
+
+        // background scan of the cluster headers, when there are no cues
+        vlc_object_t *       _index_obj;
+        char *               _index_mrl;
+        fptr_t               _index_start;
+        fptr_t               _index_end;
+        uint64_t             _index_timescale;
+        bool                 _index_running;
+        bool                 _index_abort;
+        vlc_thread_t         _index_thread;
+        vlc_mutex_t          _index_lock;
+        std::vector<Cluster> _index_pending;
 };
 
 #endif /* include-guard */
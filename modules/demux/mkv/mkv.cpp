@@ -554,33 +554,67 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
     const unsigned int i_number_frames = block != NULL ? block->NumberFrames() :
             ( simpleblock != NULL ? simpleblock->NumberFrames() : 0 );
 
+    /* SimpleBlock frames were not loaded by BlockGet */
+    IOCallback & io = p_segment->es.I_O();
+    const uint64 i_block_end = io.getFilePointer();
+
+    const size_t i_header_size =
+        ( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
+          track.p_compression_data != NULL &&
+          track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+        ? track.p_compression_data->GetSize() : 0;
+
     for( unsigned int i_frame = 0; i_frame < i_number_frames; i_frame++ )
     {
         block_t *p_block;
-        DataBuffer *data;
         if( simpleblock != NULL )
         {
-            data = &simpleblock->GetBuffer(i_frame);
+            const uint64 i_size = simpleblock->GetFrameSize(i_frame);
+
+            frame_size += i_size;
+            if( i_size == 0 || i_size > frame_size || frame_size > block_size )
+            {
+                msg_Warn( p_demux, "Cannot read frame (too long or no frame)" );
+                break;
+            }
+
+            p_block = block_Alloc( i_header_size + i_size );
+            if( p_block == NULL )
+                break;
+
+            io.setFilePointer( simpleblock->GetDataPosition(i_frame) );
+            if( io.read( p_block->p_buffer + i_header_size, i_size ) != i_size )
+            {
+                msg_Warn( p_demux, "Cannot read frame (truncated)" );
+                block_Release( p_block );
+                break;
+            }
+
+            if( !i_header_size && unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
+            {
+                block_t *p_packetized = packetize_wavpack( &track, p_block->p_buffer, p_block->i_buffer );
+                block_Release( p_block );
+                p_block = p_packetized;
+            }
         }
         else
         {
-            data = &block->GetBuffer(i_frame);
-        }
-        frame_size += data->Size();
-        if( !data->Buffer() || data->Size() > frame_size || frame_size > block_size  )
-        {
-            msg_Warn( p_demux, "Cannot read frame (too long or no frame)" );
-            break;
-        }
+            DataBuffer *data = &block->GetBuffer(i_frame);
 
-        if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
-            track.p_compression_data != NULL &&
-            track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
-            p_block = MemToBlock( data->Buffer(), data->Size(), track.p_compression_data->GetSize() );
-        else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
-            p_block = packetize_wavpack( &track, data->Buffer(), data->Size() );
-        else
-            p_block = MemToBlock( data->Buffer(), data->Size(), 0 );
+            frame_size += data->Size();
+            if( !data->Buffer() || data->Size() > frame_size || frame_size > block_size  )
+            {
+                msg_Warn( p_demux, "Cannot read frame (too long or no frame)" );
+                break;
+            }
+
+            if( i_header_size )
+                p_block = MemToBlock( data->Buffer(), data->Size(), i_header_size );
+            else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
+                p_block = packetize_wavpack( &track, data->Buffer(), data->Size() );
+            else
+                p_block = MemToBlock( data->Buffer(), data->Size(), 0 );
+        }
 
         if( p_block == NULL )
         {
@@ -647,7 +681,7 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
                 // TODO handle the start/stop times of this packet
                 p_sys->p_ev->SetPci( (const pci_t *)&p_block->p_buffer[1]);
                 block_Release( p_block );
-                return;
+                break;
             }
             p_block->i_dts = p_block->i_pts = i_pts;
         }
@@ -684,6 +718,9 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
                  i_pts + ( mtime_t )track.i_default_duration:
                  ( track.fmt.b_packetized ) ? VLC_TS_INVALID : i_pts + 1;
     }
+
+    if( simpleblock != NULL )
+        io.setFilePointer( i_block_end );
 }
 
 /*****************************************************************************
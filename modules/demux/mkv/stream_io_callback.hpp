@@ -48,5 +48,6 @@ class vlc_stream_io_callback: public IOCallback
     virtual uint64   getFilePointer  ( void );
     virtual void     close           ( void ) { return; }
     uint64           toRead          ( void );
+    stream_t *       getStream       ( void ) const { return s; }
 };
 
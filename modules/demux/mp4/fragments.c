@@ -56,8 +56,10 @@ void MP4_Fragments_Remove( mp4_fragments_t *p_frags, mp4_fragment_t *p_fragment
             p_fragment->p_next = NULL;
             if( p_frags->p_last == p_fragment )
                 p_frags->p_last = p_current;
+            p_frags->index.b_stale = true;
             return;
         }
+        p_current = p_current->p_next;
     }
 }
 
@@ -71,6 +73,10 @@ void MP4_Fragments_Clean( mp4_fragments_t *p_frags )
         p_frags->moov.p_next = p_fragment;
     }
     MP4_Fragment_Clean( &p_frags->moov );
+
+    free( p_frags->index.pp_fragments );
+    free( p_frags->index.pi_end );
+    free( p_frags->index.pi_totals );
 }
 
 void MP4_Fragments_Insert( mp4_fragments_t *p_frags, mp4_fragment_t *p_new )
@@ -85,6 +91,9 @@ void MP4_Fragments_Insert( mp4_fragments_t *p_frags, mp4_fragment_t *p_new )
         return;
     }
 
+    /* not appended, the time index has to be rebuilt */
+    p_frags->index.b_stale = true;
+
     /* start from head */
     p_fragment = MP4_Fragment_Moov( p_frags )->p_next;
     while ( p_fragment && p_fragment->p_moox->i_pos < p_new->p_moox->i_pos )
@@ -109,7 +118,7 @@ void MP4_Fragments_Insert( mp4_fragments_t *p_frags, mp4_fragment_t *p_new )
 
 bool MP4_Fragments_Init( mp4_fragments_t *p_frags )
 {
-    memset( &p_frags->moov, 0, sizeof(mp4_fragment_t) );
+    memset( p_frags, 0, sizeof(*p_frags) );
     return true;
 }
 
@@ -170,43 +179,90 @@ mp4_fragment_t * GetFragmentByPos( mp4_fragments_t *p_frags, uint64_t i_pos, boo
     return NULL;
 }
 
-/* Get a matching fragment data start by clock time */
-mp4_fragment_t * GetFragmentByTime( mp4_fragments_t *p_frags, const mtime_t i_time,
-                                    unsigned i_tracks_id, unsigned *pi_tracks_id,
-                                    uint32_t i_movie_timescale )
+static bool IndexFragments( mp4_fragments_t *p_frags,
+                            unsigned i_tracks_id, const unsigned *pi_tracks_id )
 {
-    const stime_t i_scaled_time = i_time * i_movie_timescale / CLOCK_FREQ;
-    mp4_fragment_t *p_fragment = MP4_Fragment_Moov( p_frags );
-    stime_t *pi_tracks_fragduration_total = calloc( i_tracks_id, sizeof(stime_t) );
-    mtime_t i_segment_start = 0;
+    mp4_fragment_t *p_fragment;
 
-    if( p_fragment->i_chunk_range_max_offset == 0 )
-        p_fragment = p_fragment->p_next;
+    if( p_frags->index.b_stale || p_frags->index.i_tracks != i_tracks_id )
+    {
+        stime_t *pi_totals = realloc( p_frags->index.pi_totals,
+                                      sizeof(stime_t) * (i_tracks_id ? i_tracks_id : 1) );
+        if( !pi_totals )
+            return false;
+        memset( pi_totals, 0, sizeof(stime_t) * i_tracks_id );
+        p_frags->index.pi_totals = pi_totals;
+        p_frags->index.i_tracks = i_tracks_id;
+        p_frags->index.i_count = 0;
+        p_frags->index.b_stale = false;
+    }
 
-    while ( p_fragment && pi_tracks_fragduration_total )
+    if( p_frags->index.i_count )
+        p_fragment = p_frags->index.pp_fragments[p_frags->index.i_count - 1]->p_next;
+    else
     {
-        mtime_t i_segment_end = 0;
-        for( unsigned int i=0; i<i_tracks_id; i++ )
+        p_fragment = MP4_Fragment_Moov( p_frags );
+        if( p_fragment->i_chunk_range_max_offset == 0 )
+            p_fragment = p_fragment->p_next;
+    }
+
+    for( ; p_fragment; p_fragment = p_fragment->p_next )
+    {
+        if( p_frags->index.i_count == p_frags->index.i_alloc )
         {
-            pi_tracks_fragduration_total[i] += GetTrackDurationInFragment( p_fragment, pi_tracks_id[i] );
-            i_segment_end = __MAX(i_segment_end, pi_tracks_fragduration_total[i]);
+            size_t i_alloc = p_frags->index.i_alloc ? p_frags->index.i_alloc * 2 : 64;
+            mp4_fragment_t **pp_fragments =
+                realloc( p_frags->index.pp_fragments, i_alloc * sizeof(*pp_fragments) );
+            if( !pp_fragments )
+                return false;
+            p_frags->index.pp_fragments = pp_fragments;
+            stime_t *pi_end = realloc( p_frags->index.pi_end, i_alloc * sizeof(*pi_end) );
+            if( !pi_end )
+                return false;
+            p_frags->index.pi_end = pi_end;
+            p_frags->index.i_alloc = i_alloc;
         }
 
-        if ( i_scaled_time >= i_segment_start &&
-             i_scaled_time <= i_segment_end )
+        stime_t i_segment_end = 0;
+        for( unsigned int i=0; i<i_tracks_id; i++ )
         {
-            free( pi_tracks_fragduration_total );
-            return p_fragment;
+            p_frags->index.pi_totals[i] += GetTrackDurationInFragment( p_fragment, pi_tracks_id[i] );
+            i_segment_end = __MAX(i_segment_end, p_frags->index.pi_totals[i]);
         }
+
+        p_frags->index.pp_fragments[p_frags->index.i_count] = p_fragment;
+        p_frags->index.pi_end[p_frags->index.i_count] = i_segment_end;
+        p_frags->index.i_count++;
+    }
+
+    return true;
+}
+
+/* Get a matching fragment data start by clock time */
+mp4_fragment_t * GetFragmentByTime( mp4_fragments_t *p_frags, const mtime_t i_time,
+                                    unsigned i_tracks_id, unsigned *pi_tracks_id,
+                                    uint32_t i_movie_timescale )
+{
+    const stime_t i_scaled_time = i_time * i_movie_timescale / CLOCK_FREQ;
+
+    if( i_scaled_time < 0 || !IndexFragments( p_frags, i_tracks_id, pi_tracks_id ) )
+        return NULL;
+
+    /* first fragment ending at or after the time, as segments are
+     * contiguous it also starts before it */
+    size_t i_low = 0, i_high = p_frags->index.i_count;
+    while( i_low < i_high )
+    {
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_frags->index.pi_end[i_mid] < i_scaled_time )
+            i_low = i_mid + 1;
         else
-        {
-            i_segment_start = i_segment_end; /* end = next segment start */
-            p_fragment = p_fragment->p_next;
-        }
+            i_high = i_mid;
     }
 
-    free( pi_tracks_fragduration_total );
-    return NULL;
+    if( i_low == p_frags->index.i_count )
+        return NULL;
+    return p_frags->index.pp_fragments[i_low];
 }
 
 /* Returns fragment scaled time offset */
@@ -46,6 +46,19 @@ typedef struct
 {
     mp4_fragment_t moov; /* known fragments (moof following moov) */
     mp4_fragment_t *p_last;
+
+    /* fragments sorted by end time, for GetFragmentByTime() lookups.
+       Extended as fragments are appended, rebuilt otherwise */
+    struct
+    {
+        mp4_fragment_t **pp_fragments;
+        stime_t *pi_end;     /* movie scaled */
+        size_t i_count;
+        size_t i_alloc;
+        stime_t *pi_totals;  /* per track durations up to the last one */
+        unsigned i_tracks;
+        bool b_stale;
+    } index;
 } mp4_fragments_t;
 
 static inline mp4_fragment_t * MP4_Fragment_Moov(mp4_fragments_t *p_fragments)
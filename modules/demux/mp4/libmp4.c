@@ -434,6 +434,59 @@ static int MP4_ReadBoxContainer( stream_t *p_stream, MP4_Box_t *p_container )
     return MP4_ReadBoxContainerChildren( p_stream, p_container, NULL );
 }
 
+/* Reads the whole container at once and parses its children from memory,
+ * instead of issuing a small read for each of them */
+#define MP4_BUFFERED_CONTAINER_MAX (16 * 1024 * 1024)
+
+static int MP4_ReadBoxContainerBuffered( stream_t *p_stream, MP4_Box_t *p_container )
+{
+    const size_t i_headersize = mp4_box_headersize( p_container );
+
+    if( p_container->i_size == 0 ||
+        p_container->i_size > MP4_BUFFERED_CONTAINER_MAX )
+        return MP4_ReadBoxContainer( p_stream, p_container );
+
+    if( p_container->i_size <= i_headersize + 8 )
+        return 1; /* empty container */
+
+    if( MP4_Seek( p_stream, p_container->i_pos ) )
+        return 0;
+
+    uint8_t *p_buffer = malloc( p_container->i_size );
+    if( !p_buffer )
+        return MP4_ReadBoxContainer( p_stream, p_container );
+
+    ssize_t i_read = vlc_stream_Read( p_stream, p_buffer, p_container->i_size );
+    if( i_read < (ssize_t)i_headersize + 8 )
+    {
+        free( p_buffer );
+        return 0;
+    }
+
+    stream_t *p_substream = vlc_stream_MemoryNew( p_stream, p_buffer, i_read,
+                                                  true );
+    if( !p_substream )
+    {
+        free( p_buffer );
+        return 0;
+    }
+
+    /* parse relatively to the buffer, then fix up the positions */
+    const uint64_t i_pos = p_container->i_pos;
+    int i_ret = 0;
+
+    p_container->i_pos = 0;
+    if( MP4_Seek( p_substream, i_headersize ) == VLC_SUCCESS )
+        i_ret = MP4_ReadBoxContainerChildren( p_substream, p_container, NULL );
+    p_container->i_pos = i_pos;
+    MP4_BoxOffsetUp( p_container->p_first, i_pos );
+
+    vlc_stream_Delete( p_substream );
+    free( p_buffer );
+
+    return i_ret;
+}
+
 static int MP4_ReadBoxSkip( stream_t *p_stream, MP4_Box_t *p_box )
 {
     /* XXX sometime moov is hiden in a free box */
@@ -3651,6 +3704,17 @@ static int MP4_ReadBox_colr( stream_t *p_stream, MP4_Box_t *p_box )
     MP4_READBOX_EXIT( 1 );
 }
 
+/* moov/meta or moov/udta/meta, from the file itself */
+static bool MP4_BoxIsMovieMeta( const MP4_Box_t *p_box )
+{
+    const MP4_Box_t *p_father = p_box->p_father;
+
+    if( p_father && p_father->i_type == ATOM_udta )
+        p_father = p_father->p_father;
+    return p_father && p_father->i_type == ATOM_moov &&
+           p_father->p_father && p_father->p_father->i_type == ATOM_root;
+}
+
 static int MP4_ReadBox_meta( stream_t *p_stream, MP4_Box_t *p_box )
 {
     const uint8_t *p_peek;
@@ -3691,6 +3755,12 @@ static int MP4_ReadBox_meta( stream_t *p_stream, MP4_Box_t *p_box )
         {
             case HANDLER_mdta:
             case HANDLER_mdir:
+                if( MP4_BoxIsMovieMeta( p_box ) )
+                {
+                    /* tags and cover art are only needed on request */
+                    p_box->e_flags |= BOX_FLAG_DEFERRED;
+                    return 1;
+                }
                 /* then it behaves like a container */
                 return MP4_ReadBoxContainerChildren( p_stream, p_box, NULL );
             default:
@@ -4078,7 +4148,7 @@ static const struct
 } MP4_Box_Function [] =
 {
     /* Containers */
-    { ATOM_moov,    MP4_ReadBoxContainer,     0 },
+    { ATOM_moov,    MP4_ReadBoxContainerBuffered, 0 },
     { ATOM_foov,    MP4_ReadBoxContainer,     0 },
     { ATOM_trak,    MP4_ReadBoxContainer,     ATOM_moov },
     { ATOM_trak,    MP4_ReadBoxContainer,     ATOM_foov },
@@ -4593,6 +4663,31 @@ MP4_Box_t *MP4_BoxGetNextChunk( stream_t *s )
     return p_fakeroot;
 }
 
+int MP4_BoxLoadDeferred( stream_t *p_stream, MP4_Box_t *p_box )
+{
+    if( !(p_box->e_flags & BOX_FLAG_DEFERRED) )
+        return 1;
+
+    /* children following the handler */
+    const MP4_Box_t *p_hdlr = MP4_BoxGet( p_box, "hdlr" );
+    if( !p_hdlr )
+        return 0;
+
+    const uint64_t i_tell = vlc_stream_Tell( p_stream );
+    int i_ret = 0;
+
+    if( MP4_Seek( p_stream, p_hdlr->i_pos + p_hdlr->i_size ) == VLC_SUCCESS )
+    {
+        i_ret = MP4_ReadBoxContainerChildren( p_stream, p_box, NULL );
+        p_box->e_flags &= ~BOX_FLAG_DEFERRED;
+    }
+
+    if( MP4_Seek( p_stream, i_tell ) != VLC_SUCCESS )
+        i_ret = 0;
+
+    return i_ret;
+}
+
 /*****************************************************************************
  * MP4_BoxGetRoot : Parse the entire file, and create all boxes in memory
  *****************************************************************************
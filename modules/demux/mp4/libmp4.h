@@ -1675,6 +1675,7 @@ struct MP4_Box_s
     {
         BOX_FLAG_NONE = 0,
         BOX_FLAG_INCOMPLETE,
+        BOX_FLAG_DEFERRED, /* children not loaded yet, see MP4_BoxLoadDeferred */
     }            e_flags;
 
     UUID_t       i_uuid;  /* Set if i_type == "uuid" */
@@ -1843,6 +1844,15 @@ MP4_Box_t * MP4_BoxNew( uint32_t i_type );
  *****************************************************************************/
 void MP4_BoxFree( MP4_Box_t *p_box );
 
+/*****************************************************************************
+ * MP4_BoxLoadDeferred: load the children of a box whose parsing was deferred
+ *****************************************************************************
+ * The movie metadata (moov/meta, moov/udta/meta) is only parsed on demand.
+ * The stream position is restored on return.
+ * returns 0 on failure
+ *****************************************************************************/
+int MP4_BoxLoadDeferred( stream_t *p_stream, MP4_Box_t *p_box );
+
 /*****************************************************************************
  * MP4_DumpBoxStructure: print the structure of the p_box
  *****************************************************************************
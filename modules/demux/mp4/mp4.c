@@ -126,6 +126,7 @@ static uint64_t MP4_TrackGetPos    ( mp4_track_t * );
 static uint32_t MP4_TrackGetReadSize( mp4_track_t *, uint32_t * );
 static int      MP4_TrackNextSample( demux_t *, mp4_track_t *, uint32_t );
 static void     MP4_TrackSetELST( demux_t *, mp4_track_t *, int64_t );
+static int      TrackLoadChunkTables( demux_t *, mp4_track_t *, mp4_chunk_t * );
 
 static void     MP4_UpdateSeekpoint( demux_t *, int64_t );
 
@@ -219,8 +220,13 @@ static inline int64_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
     demux_sys_t *p_sys = p_demux->p_sys;
     const mp4_chunk_t *p_chunk;
 
-    p_chunk = ( p_track->cchunk ) ? p_track->cchunk /* DemuxFrg */
-                                  : &p_track->chunk[p_track->i_chunk];
+    if( p_track->cchunk ) /* DemuxFrg */
+        p_chunk = p_track->cchunk;
+    else
+    {
+        p_chunk = &p_track->chunk[p_track->i_chunk];
+        TrackLoadChunkTables( p_demux, p_track, &p_track->chunk[p_track->i_chunk] );
+    }
 
     unsigned int i_index = 0;
     unsigned int i_sample = p_track->i_sample - p_chunk->i_sample_first;
@@ -268,10 +274,14 @@ static inline int64_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
 static inline bool MP4_TrackGetPTSDelta( demux_t *p_demux, mp4_track_t *p_track,
                                          int64_t *pi_delta )
 {
-    VLC_UNUSED( p_demux );
     mp4_chunk_t *ck;
-    ck = ( p_track->cchunk ) ? p_track->cchunk /* DemuxFrg */
-                             : &p_track->chunk[p_track->i_chunk];
+    if( p_track->cchunk ) /* DemuxFrg */
+        ck = p_track->cchunk;
+    else
+    {
+        ck = &p_track->chunk[p_track->i_chunk];
+        TrackLoadChunkTables( p_demux, p_track, ck );
+    }
 
     unsigned int i_index = 0;
     unsigned int i_sample = p_track->i_sample - ck->i_sample_first;
@@ -1539,6 +1549,19 @@ static bool imageTypeCompatible( const MP4_Box_data_data_t *p_data )
     p_data->e_wellknowntype == DATA_WKT_BMP );
 }
 
+static void LoadDeferredMeta( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const char *psz_metas[] = { "/moov/udta/meta", "/moov/meta" };
+
+    for( size_t i = 0; i < ARRAY_SIZE(psz_metas); i++ )
+    {
+        MP4_Box_t *p_meta = MP4_BoxGet( p_sys->p_root, psz_metas[i] );
+        if( p_meta && !MP4_BoxLoadDeferred( p_demux->s, p_meta ) )
+            msg_Warn( p_demux, "cannot load %s", psz_metas[i] );
+    }
+}
+
 /*****************************************************************************
  * Control:
  *****************************************************************************/
@@ -1634,6 +1657,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             size_t i_count = 0;
             int i_index = 0;
 
+            LoadDeferredMeta( p_demux );
+
             /* Count number of total attachments */
             for( ; psz_roots[i_index] && !p_udta; i_index++ )
             {
@@ -1747,6 +1772,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             MP4_Box_t *p_udta = NULL;
             bool b_attachment_set = false;
 
+            LoadDeferredMeta( p_demux );
+
             for( int i_index = 0; psz_roots[i_index] && !p_udta; i_index++ )
             {
                 p_udta = MP4_BoxGet( p_sys->p_root, psz_roots[i_index] );
@@ -2133,49 +2160,114 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
+/* Walks i_sample_count samples of a stts/ctts table, starting i_index
+ * entries in with i_index_samples_left samples remaining in that entry.
+ * The runs are copied to pi_count/pi_value when not NULL, and the sum of
+ * run * value is added to pi_sum when not NULL. Returns the number of
+ * runs covering the samples */
+static uint32_t xTTS_Walk( uint32_t *pi_index, uint32_t *pi_index_samples_left,
+                           uint32_t i_sample_count,
+                           const uint32_t *pi_table_count,
+                           const int32_t *pi_table_value,
+                           uint32_t i_table_count,
+                           uint32_t *pi_count, int32_t *pi_value,
+                           uint64_t *pi_sum )
 {
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
+    uint32_t i_index = *pi_index;
+    uint32_t i_left = *pi_index_samples_left;
+    uint32_t i_entries = 0;
+
+    while( i_sample_count > 0 && i_index < i_table_count )
     {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
+        if( i_left == 0 )
+            i_left = pi_table_count[i_index];
 
-        if ( i_array_offset >= i_table_count )
+        uint32_t i_run = __MIN( i_left, i_sample_count );
+        if( pi_count )
         {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_ENOVAR;
+            pi_count[i_entries] = i_run;
+            pi_value[i_entries] = pi_table_value[i_index];
         }
+        if( pi_sum )
+            *pi_sum += (uint32_t)( i_run * (uint32_t)pi_table_value[i_index] );
+        i_entries++;
+
+        i_sample_count -= i_run;
+        i_left -= i_run;
+        if( i_left == 0 )
+            i_index++;
+    }
+
+    *pi_index = i_index;
+    *pi_index_samples_left = i_left;
+    return i_entries;
+}
+
+/* Expands the stts/ctts runs of a chunk. Only the chunk being read keeps
+ * its tables, the others are expanded again from the boxes when needed */
+static int TrackLoadChunkTables( demux_t *p_demux, mp4_track_t *p_track,
+                                 mp4_chunk_t *ck )
+{
+    if( ( !ck->i_entries_dts || ck->p_sample_count_dts ) &&
+        ( !ck->i_entries_pts || ck->p_sample_count_pts ) )
+        return VLC_SUCCESS;
 
-        if ( i_index_samples_left )
+    mp4_chunk_t *p_loaded = p_track->p_tables_chunk;
+    if( p_loaded && p_loaded != ck )
+    {
+        FREENULL( p_loaded->p_sample_count_dts );
+        FREENULL( p_loaded->p_sample_delta_dts );
+        FREENULL( p_loaded->p_sample_count_pts );
+        FREENULL( p_loaded->p_sample_offset_pts );
+    }
+    p_track->p_tables_chunk = ck;
+
+    const MP4_Box_t *p_stts = MP4_BoxGet( p_track->p_stbl, "stts" );
+    if( ck->i_entries_dts && !ck->p_sample_count_dts &&
+        p_stts && BOXDATA(p_stts) )
+    {
+        const MP4_Box_data_stts_t *stts = BOXDATA(p_stts);
+        uint32_t i_index = ck->i_dts_index;
+        uint32_t i_left = ck->i_dts_left;
+
+        ck->p_sample_count_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
+        ck->p_sample_delta_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
+        if( !ck->p_sample_count_dts || !ck->p_sample_delta_dts )
         {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
+            FREENULL( ck->p_sample_count_dts );
+            FREENULL( ck->p_sample_delta_dts );
+            msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
+            ck->i_entries_dts = 0;
+            return VLC_ENOMEM;
         }
-        else
+        xTTS_Walk( &i_index, &i_left, ck->i_sample_count,
+                   stts->pi_sample_count, stts->pi_sample_delta,
+                   stts->i_entry_count, ck->p_sample_count_dts,
+                   (int32_t *) ck->p_sample_delta_dts, NULL );
+    }
+
+    const MP4_Box_t *p_ctts = MP4_BoxGet( p_track->p_stbl, "ctts" );
+    if( ck->i_entries_pts && !ck->p_sample_count_pts &&
+        p_ctts && BOXDATA(p_ctts) )
+    {
+        const MP4_Box_data_ctts_t *ctts = BOXDATA(p_ctts);
+        uint32_t i_index = ck->i_pts_index;
+        uint32_t i_left = ck->i_pts_left;
+
+        ck->p_sample_count_pts = calloc( ck->i_entries_pts, sizeof( uint32_t ) );
+        ck->p_sample_offset_pts = calloc( ck->i_entries_pts, sizeof( int32_t ) );
+        if( !ck->p_sample_count_pts || !ck->p_sample_offset_pts )
         {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
+            FREENULL( ck->p_sample_count_pts );
+            FREENULL( ck->p_sample_offset_pts );
+            msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
+            ck->i_entries_pts = 0;
+            return VLC_ENOMEM;
         }
+        xTTS_Walk( &i_index, &i_left, ck->i_sample_count,
+                   ctts->pi_sample_count, ctts->pi_sample_offset,
+                   ctts->i_entry_count, ck->p_sample_count_pts,
+                   ck->p_sample_offset_pts, NULL );
     }
 
     return VLC_SUCCESS;
@@ -2263,20 +2355,16 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
 
     /* Use stts table to create a sample number -> dts table.
-     * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+     * The table is not expanded here: each chunk only records where its
+     * samples start in the stts/ctts runs, and TrackLoadChunkTables()
+     * builds its "extract" when the chunk is read or seeked into */
 
-    mtime_t i_next_dts = 0;
+    uint64_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "stts" );
-    if( !p_box )
+    if( !p_box || !p_box->data.p_stts )
     {
         msg_Warn( p_demux, "cannot find STTS box" );
         return VLC_EGENERIC;
@@ -2287,100 +2375,31 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
         uint32_t i_index = 0;
         uint32_t i_current_index_samples_left = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
 
-            /* save first dts */
+            /* save first dts and table position */
             ck->i_first_dts = i_next_dts;
+            ck->i_dts_index = i_index;
+            ck->i_dts_left = i_current_index_samples_left;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
+            ck->i_entries_dts = xTTS_Walk( &i_index, &i_current_index_samples_left,
                                            ck->i_sample_count,
                                            stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            ck->p_sample_delta_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            if( !ck->p_sample_count_dts || !ck->p_sample_delta_dts )
-            {
-                free( ck->p_sample_count_dts );
-                free( ck->p_sample_delta_dts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-            }
+                                           stts->pi_sample_delta,
+                                           stts->i_entry_count,
+                                           NULL, NULL, &i_next_dts );
+            ck->i_duration = i_next_dts - ck->i_first_dts;
+            if( ck->i_entries_dts == 0 && ck->i_sample_count )
+                msg_Err( p_demux, "invalid index counting total samples %u %u",
+                         i_index, stts->i_entry_count );
         }
     }
 
-
     /* Find ctts
      *  Gives the delta between decoding time (dts) and composition table (pts)
      */
@@ -2391,89 +2410,26 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
-        /* Create pts-dts table per chunk */
         uint32_t i_index = 0;
         uint32_t i_current_index_samples_left = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
+            ck->i_pts_index = i_index;
+            ck->i_pts_left = i_current_index_samples_left;
+
+            ck->i_entries_pts = xTTS_Walk( &i_index, &i_current_index_samples_left,
                                            ck->i_sample_count,
                                            ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_pts = calloc( ck->i_entries_pts, sizeof( uint32_t ) );
-            ck->p_sample_offset_pts = calloc( ck->i_entries_pts, sizeof( int32_t ) );
-            if( !ck->p_sample_count_pts || !ck->p_sample_offset_pts )
-            {
-                free( ck->p_sample_count_pts );
-                free( ck->p_sample_offset_pts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index];
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index];
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index];
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index];
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-
-            }
+                                           ctts->pi_sample_offset,
+                                           ctts->i_entry_count,
+                                           NULL, NULL, NULL );
         }
     }
 
-    msg_Dbg( p_demux, "track[Id 0x%x] read %"PRIu32" samples length:%"PRId64"s",
+    msg_Dbg( p_demux, "track[Id 0x%x] read %"PRIu32" samples length:%"PRIu64"s",
              p_demux_track->i_track_ID, p_demux_track->i_sample_count,
              i_next_dts / p_demux_track->i_timescale );
 
@@ -2772,9 +2728,11 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
     }
 
     /* *** find sample in the chunk *** */
+    TrackLoadChunkTables( p_demux, p_track, &p_track->chunk[i_chunk] );
     i_sample = p_track->chunk[i_chunk].i_sample_first;
     i_dts    = p_track->chunk[i_chunk].i_first_dts;
-    for( i_index = 0; i_sample < p_track->chunk[i_chunk].i_sample_count; )
+    for( i_index = 0; i_sample < p_track->chunk[i_chunk].i_sample_count &&
+                      i_index < p_track->chunk[i_chunk].i_entries_dts; )
     {
         if( i_dts +
             p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
@@ -4685,7 +4643,7 @@ static inline mtime_t LeafGetMOOVTimeInChunk( const mp4_chunk_t *p_chunk, uint32
     mtime_t i_time = 0;
     uint32_t i_index = 0;
 
-    while( i_sample > 0 )
+    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
     {
         if( i_sample > p_chunk->p_sample_count_dts[i_index] )
         {
@@ -4794,6 +4752,7 @@ static int LeafParseMDATwithMOOV( demux_t *p_demux )
                 p_sys->context.i_mdatbytesleft -= i_samplessize;
 
                 /* dts */
+                TrackLoadChunkTables( p_demux, p_track, p_chunk );
                 mtime_t i_time = LeafGetMOOVTimeInChunk( p_chunk, i_nb_samples );
                 i_time += p_chunk->i_first_dts;
                 p_track->i_time = i_time;
@@ -55,6 +55,11 @@ typedef struct
     uint32_t     *p_sample_count_pts;
     int32_t      *p_sample_offset_pts;  /* pts-dts */
 
+    /* stts/ctts entry and samples left in it at the first sample, the
+       tables above are only expanded for the chunk being read */
+    uint32_t     i_dts_index, i_dts_left;
+    uint32_t     i_pts_index, i_pts_left;
+
     uint8_t      **p_sample_data;     /* set when b_fragmented is true */
     uint32_t     *p_sample_size;
     /* TODO if needed add pts
@@ -111,6 +116,7 @@ typedef struct
 
     mp4_chunk_t    *chunk; /* always defined  for each chunk */
     mp4_chunk_t    *cchunk; /* current chunk if b_fragmented is true */
+    mp4_chunk_t    *p_tables_chunk; /* chunk with expanded dts/pts tables */
 
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
@@ -48,6 +48,10 @@ static int  OpenAudio( vlc_object_t * );
 static int  OpenVideo( vlc_object_t * );
 static void Close    ( vlc_object_t * );
 
+#define INDEX_TEXT N_("Build a seek index")
+#define INDEX_LONGTEXT N_("Scan local MPEG audio and ADTS files in the " \
+    "background to seek accurately in variable bitrate streams.")
+
 #define FPS_TEXT N_("Frames per Second")
 #define FPS_LONGTEXT N_("This is the frame rate used as a fallback when " \
     "playing MPEG video elementary streams.")
@@ -66,6 +70,7 @@ vlc_module_begin ()
                   "eac3",
                   "dts",
                   "mlp", "thd" )
+    add_bool( "es-seek-index", false, INDEX_TEXT, INDEX_LONGTEXT, true )
 
     add_submodule()
     set_description( N_("MPEG-4 video" ) )
@@ -119,6 +124,26 @@ typedef struct
     sync_table_ctx_t current;
 } sync_table_t;
 
+typedef struct
+{
+    mtime_t  i_time;
+    uint64_t i_pos;
+} seek_index_entry_t;
+
+typedef struct
+{
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    bool b_started;
+    bool b_abort;
+    char *psz_url;
+    vlc_fourcc_t i_codec;
+    uint64_t i_start;
+    /* Published by the scanner once complete */
+    seek_index_entry_t *p_entries;
+    size_t i_entries;
+} seek_index_t;
+
 struct demux_sys_t
 {
     codec_t codec;
@@ -157,6 +182,7 @@ struct demux_sys_t
     } xing;
 
     sync_table_t mllt;
+    seek_index_t index;
 };
 
 static int MpgaProbe( demux_t *p_demux, int64_t *pi_offset );
@@ -179,6 +205,10 @@ static int MlpInit( demux_t *p_demux );
 static bool Parse( demux_t *p_demux, block_t **pp_output );
 static uint64_t SeekByMlltTable( demux_t *p_demux, mtime_t *pi_time );
 
+static void SeekIndexStart( demux_t *p_demux );
+static void SeekIndexStop( demux_t *p_demux );
+static int SeekByIndex( demux_t *p_demux, mtime_t *pi_time, uint64_t *pi_pos );
+
 static const codec_t p_codecs[] = {
     { VLC_CODEC_MP4A, false, "mp4 audio",  AacProbe,  AacInit },
     { VLC_CODEC_MPGA, false, "mpeg audio", MpgaProbe, MpgaInit },
@@ -270,6 +300,8 @@ static int OpenCommon( demux_t *p_demux,
             break;
     }
 
+    SeekIndexStart( p_demux );
+
     return VLC_SUCCESS;
 }
 static int OpenAudio( vlc_object_t *p_this )
@@ -371,6 +403,7 @@ static void Close( vlc_object_t * p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    SeekIndexStop( p_demux );
     if( p_sys->p_packetized_data )
         block_ChainRelease( p_sys->p_packetized_data );
     if( p_sys->mllt.p_bits )
@@ -433,6 +466,25 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         case DEMUX_SET_TIME:
         {
+            va_list ap;
+            int64_t i_time;
+            uint64_t i_pos;
+
+            va_copy( ap, args );
+            i_time = va_arg( ap, int64_t );
+            va_end( ap );
+            if( SeekByIndex( p_demux, &i_time, &i_pos ) == VLC_SUCCESS )
+            {
+                int i_ret = vlc_stream_Seek( p_demux->s, i_pos );
+                if( i_ret != VLC_SUCCESS )
+                    return i_ret;
+                p_sys->i_time_offset = i_time - p_sys->i_pts;
+                /* And reset buffered data */
+                if( p_sys->p_packetized_data )
+                    block_ChainRelease( p_sys->p_packetized_data );
+                p_sys->p_packetized_data = NULL;
+                return VLC_SUCCESS;
+            }
             if( p_sys->mllt.p_bits )
             {
                 int64_t i_time = va_arg(args, int64_t);
@@ -1253,3 +1305,307 @@ static int VideoInit( demux_t *p_demux )
 
     return VLC_SUCCESS;
 }
+
+/*****************************************************************************
+ * Seek index
+ *****************************************************************************
+ * A background thread walks the frame headers of local MPEG audio and ADTS
+ * files with its own stream, recording the exact time of every
+ * SEEK_INDEX_FRAMES frames. Seeks use it once the whole file is scanned.
+ *****************************************************************************/
+#define SEEK_INDEX_FRAMES 16
+#define SEEK_INDEX_BUFFER (1 << 16)
+#define SEEK_INDEX_REFILL (1 << 14) /* larger than any frame */
+
+/* Returns the frame size, or 0 if p does not start a valid frame */
+static unsigned SeekIndexMpgaFrame( const uint8_t *p, unsigned *pi_samples,
+                                    unsigned *pi_rate )
+{
+    static const uint16_t ppi_bitrate[2][3][16] =
+    {
+        { /* v1: layer I, II, III */
+            { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384,
+              416, 448, 0 },
+            { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320,
+              384, 0 },
+            { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256,
+              320, 0 },
+        },
+        { /* v2 and v2.5: layer I, II, III */
+            { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224,
+              256, 0 },
+            { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160,
+              0 },
+            { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160,
+              0 },
+        },
+    };
+    static const uint16_t pi_rate_table[3] = { 44100, 48000, 32000 };
+
+    if( !MpgaCheckSync( p ) )
+        return 0;
+
+    const uint32_t h = GetDWBE( p );
+    const unsigned i_layer = 3 - ((h >> 17) & 0x03);
+    const unsigned i_bitrate = ppi_bitrate[MPGA_VERSION(h)][i_layer][(h >> 12) & 0x0f];
+    const bool b_padding = (h >> 9) & 0x01;
+    unsigned i_rate = pi_rate_table[(h >> 10) & 0x03];
+
+    if( i_bitrate == 0 ) /* free format */
+        return 0;
+    if( ((h >> 19) & 0x03) == 0x02 )
+        i_rate /= 2;        /* MPEG 2 */
+    else if( ((h >> 19) & 0x03) == 0x00 )
+        i_rate /= 4;        /* MPEG 2.5 */
+
+    *pi_samples = MpgaGetFrameSamples( h );
+    *pi_rate = i_rate;
+    switch( i_layer )
+    {
+        case 0:
+            return (12000 * i_bitrate / i_rate + b_padding) * 4;
+        case 2:
+            if( MPGA_VERSION(h) )
+                return 72000 * i_bitrate / i_rate + b_padding;
+            /* fall through */
+        default:
+            return 144000 * i_bitrate / i_rate + b_padding;
+    }
+}
+
+static unsigned SeekIndexAdtsFrame( const uint8_t *p, unsigned *pi_samples,
+                                    unsigned *pi_rate )
+{
+    static const uint32_t pi_rate_table[16] =
+    {
+        96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050,
+        16000, 12000, 11025, 8000, 7350, 0, 0, 0
+    };
+
+    if( p[0] != 0xff || (p[1] & 0xf6) != 0xf0 )
+        return 0;
+
+    const unsigned i_rate = pi_rate_table[(p[2] >> 2) & 0x0f];
+    const unsigned i_size = ((p[3] & 0x03) << 11) | (p[4] << 3) | (p[5] >> 5);
+    if( i_rate == 0 || i_size < 7 )
+        return 0;
+
+    *pi_samples = 1024 * ((p[6] & 0x03) + 1);
+    *pi_rate = i_rate;
+    return i_size;
+}
+
+static bool SeekIndexAborted( seek_index_t *p_index )
+{
+    vlc_mutex_lock( &p_index->lock );
+    bool b_abort = p_index->b_abort;
+    vlc_mutex_unlock( &p_index->lock );
+    return b_abort;
+}
+
+static void *SeekIndexThread( void *data )
+{
+    demux_t *p_demux = data;
+    seek_index_t *p_index = &p_demux->p_sys->index;
+    unsigned (*pf_frame)( const uint8_t *, unsigned *, unsigned * ) =
+        p_index->i_codec == VLC_CODEC_MPGA ? SeekIndexMpgaFrame
+                                           : SeekIndexAdtsFrame;
+
+    seek_index_entry_t *p_entries = NULL;
+    size_t i_entries = 0, i_alloc = 0;
+    uint8_t *p_buf = malloc( SEEK_INDEX_BUFFER );
+    stream_t *s = vlc_stream_NewMRL( p_demux, p_index->psz_url );
+    bool b_ok = false;
+
+    if( p_buf == NULL || s == NULL ||
+        vlc_stream_Seek( s, p_index->i_start ) != VLC_SUCCESS )
+        goto end;
+
+    const mtime_t i_start_date = mdate();
+    uint64_t i_buf_pos = p_index->i_start;
+    size_t i_buf = 0, i_off = 0;
+    bool b_eof = false;
+    uint64_t i_frames = 0;
+    uint64_t i_samples = 0;
+    unsigned i_rate = 0;
+    mtime_t i_base = 0;
+
+    for( ;; )
+    {
+        if( i_buf - i_off < SEEK_INDEX_REFILL && !b_eof )
+        {
+            if( SeekIndexAborted( p_index ) )
+                goto end;
+
+            memmove( p_buf, &p_buf[i_off], i_buf - i_off );
+            i_buf -= i_off;
+            i_buf_pos += i_off;
+            i_off = 0;
+
+            ssize_t i_read = vlc_stream_Read( s, &p_buf[i_buf],
+                                              SEEK_INDEX_BUFFER - i_buf );
+            if( i_read > 0 )
+                i_buf += i_read;
+            else
+                b_eof = true;
+        }
+
+        const uint8_t *p = &p_buf[i_off];
+        const size_t i_avail = i_buf - i_off;
+        unsigned i_frame_samples, i_frame_rate, i_next_samples, i_next_rate;
+        if( i_avail < 7 )
+            break;
+
+        unsigned i_size = pf_frame( p, &i_frame_samples, &i_frame_rate );
+        if( i_size == 0 ||
+            ( i_avail >= i_size + 7 &&
+              pf_frame( &p[i_size], &i_next_samples, &i_next_rate ) == 0 ) )
+        {
+            /* Not a frame, or no frame after it: resync */
+            if( i_frames == 0 && i_buf_pos + i_off - p_index->i_start
+                                 > SEEK_INDEX_BUFFER )
+                goto end;
+            i_off++;
+            continue;
+        }
+        if( i_size > i_avail )
+            break;
+
+        if( i_frame_rate != i_rate )
+        {
+            if( i_rate )
+                i_base += i_samples * CLOCK_FREQ / i_rate;
+            i_samples = 0;
+            i_rate = i_frame_rate;
+        }
+
+        if( i_frames % SEEK_INDEX_FRAMES == 0 )
+        {
+            if( i_entries == i_alloc )
+            {
+                size_t i_new = i_alloc ? 2 * i_alloc : 1024;
+                seek_index_entry_t *p_new =
+                    realloc( p_entries, i_new * sizeof(*p_new) );
+                if( unlikely(p_new == NULL) )
+                    goto end;
+                p_entries = p_new;
+                i_alloc = i_new;
+            }
+            p_entries[i_entries].i_time = i_base +
+                                          i_samples * CLOCK_FREQ / i_rate;
+            p_entries[i_entries].i_pos = i_buf_pos + i_off;
+            i_entries++;
+        }
+
+        i_samples += i_frame_samples;
+        i_frames++;
+        i_off += i_size;
+    }
+
+    b_ok = i_entries > 0;
+    if( b_ok )
+        msg_Dbg( p_demux, "seek index ready: %"PRIu64" frames, %zu entries, "
+                 "built in %"PRId64" ms", i_frames, i_entries,
+                 (mdate() - i_start_date) / 1000 );
+
+end:
+    if( !b_ok )
+        msg_Dbg( p_demux, "cannot build a seek index" );
+    if( s != NULL )
+        vlc_stream_Delete( s );
+    free( p_buf );
+
+    vlc_mutex_lock( &p_index->lock );
+    if( b_ok )
+    {
+        p_index->p_entries = p_entries;
+        p_index->i_entries = i_entries;
+        p_entries = NULL;
+    }
+    vlc_mutex_unlock( &p_index->lock );
+    free( p_entries );
+    return NULL;
+}
+
+static void SeekIndexStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    seek_index_t *p_index = &p_sys->index;
+    bool b_fastseek = false;
+
+    if( !var_InheritBool( p_demux, "es-seek-index" ) ||
+        ( p_sys->codec.i_codec != VLC_CODEC_MPGA &&
+          p_sys->codec.i_codec != VLC_CODEC_MP4A ) ||
+        p_demux->psz_access == NULL || strcmp( p_demux->psz_access, "file" ) ||
+        vlc_stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseek ) ||
+        !b_fastseek )
+        return;
+
+    if( asprintf( &p_index->psz_url, "%s://%s", p_demux->psz_access,
+                  p_demux->psz_location ) == -1 )
+    {
+        p_index->psz_url = NULL;
+        return;
+    }
+    p_index->i_codec = p_sys->codec.i_codec;
+    p_index->i_start = p_sys->i_stream_offset;
+    p_index->b_abort = false;
+    p_index->p_entries = NULL;
+    p_index->i_entries = 0;
+    vlc_mutex_init( &p_index->lock );
+
+    if( vlc_clone( &p_index->thread, SeekIndexThread, p_demux,
+                   VLC_THREAD_PRIORITY_LOW ) )
+    {
+        vlc_mutex_destroy( &p_index->lock );
+        free( p_index->psz_url );
+        return;
+    }
+    p_index->b_started = true;
+}
+
+static void SeekIndexStop( demux_t *p_demux )
+{
+    seek_index_t *p_index = &p_demux->p_sys->index;
+
+    if( !p_index->b_started )
+        return;
+
+    vlc_mutex_lock( &p_index->lock );
+    p_index->b_abort = true;
+    vlc_mutex_unlock( &p_index->lock );
+    vlc_join( p_index->thread, NULL );
+
+    vlc_mutex_destroy( &p_index->lock );
+    free( p_index->p_entries );
+    free( p_index->psz_url );
+}
+
+/* Finds the last indexed frame at or before *pi_time */
+static int SeekByIndex( demux_t *p_demux, mtime_t *pi_time, uint64_t *pi_pos )
+{
+    seek_index_t *p_index = &p_demux->p_sys->index;
+    int i_ret = VLC_EGENERIC;
+
+    if( !p_index->b_started )
+        return VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_index->lock );
+    if( p_index->i_entries > 0 )
+    {
+        size_t i_lo = 0, i_hi = p_index->i_entries;
+        while( i_hi - i_lo > 1 )
+        {
+            size_t i_mid = (i_lo + i_hi) / 2;
+            if( p_index->p_entries[i_mid].i_time <= *pi_time )
+                i_lo = i_mid;
+            else
+                i_hi = i_mid;
+        }
+        *pi_time = p_index->p_entries[i_lo].i_time;
+        *pi_pos = p_index->p_entries[i_lo].i_pos;
+        i_ret = VLC_SUCCESS;
+    }
+    vlc_mutex_unlock( &p_index->lock );
+    return i_ret;
+}
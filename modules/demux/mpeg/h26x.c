@@ -35,6 +35,7 @@
 #include <vlc_codec.h>
 #include "../packetizer/hevc_nal.h" /* definitions, inline helpers */
 #include "../packetizer/h264_nal.h" /* definitions, inline helpers */
+#include "../packetizer/startcode_helper.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -273,7 +274,6 @@ static int GenericOpen( demux_t *p_demux, const char *psz_module,
         size_t i_probe_offset = 4;
         const uint8_t *p_probe = p_peek;
         bool b_synced = true;
-        unsigned i_bitflow = 0;
 
         for( unsigned i=0; i<H26X_NAL_COUNT; i++ )
         {
@@ -289,13 +289,17 @@ static int GenericOpen( demux_t *p_demux, const char *psz_module,
                 if( i_probe_offset + H26X_MIN_PEEK >= i_peek )
                     break;
 
-                p_probe = &p_peek[i_probe_offset];
-                i_bitflow = (i_bitflow << 1) | (!p_probe[0]);
-                /* Check for annexB */
-                if( p_probe[0] == 0x01 && ((i_bitflow & 0x06) == 0x06) )
+                /* Check for annexB, including a prefix overlapping
+                 * the previous lookup */
+                const uint8_t *p_sc = startcode_FindAnnexB(
+                            &p_peek[i_probe_offset >= 2 ? i_probe_offset - 2 : 0],
+                            &p_peek[i_peek - H26X_MIN_PEEK] );
+                if( p_sc )
+                {
+                    i_probe_offset = p_sc - p_peek + 3;
                     b_synced = true;
-
-                i_probe_offset++;
+                }
+                else i_probe_offset = i_peek - H26X_MIN_PEEK;
             }
 
             if( b_synced )
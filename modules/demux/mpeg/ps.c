@@ -77,6 +77,35 @@ vlc_module_end ()
  * Local prototypes
  *****************************************************************************/
 
+#define PS_INDEX_INTERVAL   (CLOCK_FREQ)        /* one entry per second */
+#define PS_INDEX_MAX        (1 << 16)
+#define PS_PROBE_WINDOW     (1 << 18)           /* pack search span */
+#define PS_SEEK_PRECISION   (CLOCK_FREQ / 2)
+#define PS_INDEX_CACHE_SIZE 4
+
+typedef struct
+{
+    uint64_t i_pos;
+    int64_t  i_scr;
+} ps_index_entry_t;
+
+typedef struct
+{
+    char             *psz_url;
+    uint64_t          i_size;
+    ps_index_entry_t *p_index;
+    size_t            i_index;
+    int64_t           i_first_scr;
+} ps_index_cache_entry_t;
+
+/* Indexes of recently closed files, so that reopening them seeks at once */
+static struct
+{
+    vlc_mutex_t lock;
+    ps_index_cache_entry_t entries[PS_INDEX_CACHE_SIZE];
+    unsigned next;
+} ps_index_cache = { .lock = VLC_STATIC_MUTEX };
+
 struct demux_sys_t
 {
     ps_psm_t    psm;
@@ -94,6 +123,13 @@ struct demux_sys_t
     bool  b_lost_sync;
     bool  b_have_pack;
     bool  b_seekable;
+
+    /* Sparse SCR index, sorted by position, for time based seeking */
+    ps_index_entry_t *p_index;
+    size_t      i_index;
+    size_t      i_index_alloc;
+    int64_t     i_first_scr;
+    bool        b_index_broken; /* SCR discontinuity: cannot bisect */
 };
 
 static int Demux  ( demux_t *p_demux );
@@ -102,6 +138,12 @@ static int Control( demux_t *p_demux, int i_query, va_list args );
 static int      ps_pkt_resynch( stream_t *, uint32_t *pi_code );
 static block_t *ps_pkt_read   ( stream_t *, uint32_t i_code );
 
+static void     ps_index_add  ( demux_t *, uint64_t i_pos, int64_t i_scr,
+                                bool b_force );
+static void     ps_index_load ( demux_t * );
+static void     ps_index_save ( demux_t * );
+static int      ps_seek_time  ( demux_t *, int64_t i_time );
+
 /*****************************************************************************
  * Open
  *****************************************************************************/
@@ -147,7 +189,15 @@ static int OpenCommon( vlc_object_t *p_this, bool b_force )
     p_sys->b_have_pack = false;
     p_sys->b_seekable  = false;
 
+    p_sys->p_index = NULL;
+    p_sys->i_index = 0;
+    p_sys->i_index_alloc = 0;
+    p_sys->i_first_scr = -1;
+    p_sys->b_index_broken = false;
+
     vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &p_sys->b_seekable );
+    if( p_sys->b_seekable )
+        ps_index_load( p_demux );
 
     ps_psm_init( &p_sys->psm );
     ps_track_init( p_sys->tk );
@@ -188,6 +238,8 @@ static void Close( vlc_object_t *p_this )
 
     ps_psm_destroy( &p_sys->psm );
 
+    ps_index_save( p_demux );
+    free( p_sys->p_index );
     free( p_sys );
 }
 
@@ -321,6 +373,7 @@ static int Demux( demux_t *p_demux )
             return VLC_DEMUXER_EGENERIC;
     }
 
+    const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
     if( ( p_pkt = ps_pkt_read( p_demux->s, i_code ) ) == NULL )
     {
         return VLC_DEMUXER_EOF;
@@ -337,6 +390,8 @@ static int Demux( demux_t *p_demux )
         {
             p_sys->i_last_scr = p_sys->i_scr;
             if( !p_sys->b_have_pack ) p_sys->b_have_pack = true;
+            if( p_sys->b_seekable )
+                ps_index_add( p_demux, i_pos, p_sys->i_scr, false );
             /* done later on to work around bad vcd/svcd streams */
             /* es_out_Control( p_demux->out, ES_OUT_SET_PCR, p_sys->i_scr ); */
             if( i_mux_rate > 0 ) p_sys->i_mux_rate = i_mux_rate;
@@ -530,6 +585,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         case DEMUX_SET_TIME:
             i64 = (int64_t)va_arg( args, int64_t );
+            if( ps_seek_time( p_demux, i64 ) == VLC_SUCCESS )
+                return VLC_SUCCESS;
             if( p_sys->i_time_track >= 0 && p_sys->i_current_pts > 0 )
             {
                 int64_t i_now = p_sys->i_current_pts - p_sys->tk[p_sys->i_time_track].i_first_pts;
@@ -663,3 +720,285 @@ static block_t *ps_pkt_read( stream_t *s, uint32_t i_code )
     VLC_UNUSED(i_code);
     return NULL;
 }
+
+/*****************************************************************************
+ * SCR index
+ *****************************************************************************/
+
+/* Position of the first entry at or after i_pos */
+static size_t ps_index_lookup( const demux_sys_t *p_sys, uint64_t i_pos )
+{
+    size_t i_lo = 0, i_hi = p_sys->i_index;
+
+    while( i_lo < i_hi )
+    {
+        size_t i_mid = (i_lo + i_hi) / 2;
+        if( p_sys->p_index[i_mid].i_pos < i_pos )
+            i_lo = i_mid + 1;
+        else
+            i_hi = i_mid;
+    }
+    return i_lo;
+}
+
+/* Records the SCR of the pack at i_pos. Entries are kept sparse while
+ * playing; b_force is used for the seek probes, which are always kept. */
+static void ps_index_add( demux_t *p_demux, uint64_t i_pos, int64_t i_scr,
+                          bool b_force )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->b_index_broken || p_sys->i_index >= PS_INDEX_MAX )
+        return;
+
+    size_t i = ps_index_lookup( p_sys, i_pos );
+    if( i < p_sys->i_index && p_sys->p_index[i].i_pos == i_pos )
+        return;
+
+    /* The index is only usable while the SCR grows with the position */
+    if( ( i > 0 && p_sys->p_index[i - 1].i_scr > i_scr ) ||
+        ( i < p_sys->i_index && p_sys->p_index[i].i_scr < i_scr ) )
+    {
+        msg_Dbg( p_demux, "SCR discontinuity at %"PRIu64", "
+                 "disabling the seek index", i_pos );
+        p_sys->b_index_broken = true;
+        return;
+    }
+
+    if( !b_force && i > 0 &&
+        i_scr - p_sys->p_index[i - 1].i_scr < PS_INDEX_INTERVAL )
+        return;
+
+    if( p_sys->i_index == p_sys->i_index_alloc )
+    {
+        size_t i_alloc = p_sys->i_index_alloc ? 2 * p_sys->i_index_alloc
+                                              : 256;
+        ps_index_entry_t *p_index = realloc( p_sys->p_index,
+                                             i_alloc * sizeof(*p_index) );
+        if( unlikely(p_index == NULL) )
+            return;
+        p_sys->p_index = p_index;
+        p_sys->i_index_alloc = i_alloc;
+    }
+
+    memmove( &p_sys->p_index[i + 1], &p_sys->p_index[i],
+             (p_sys->i_index - i) * sizeof(*p_sys->p_index) );
+    p_sys->p_index[i].i_pos = i_pos;
+    p_sys->p_index[i].i_scr = i_scr;
+    p_sys->i_index++;
+}
+
+static void ps_index_load( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    uint64_t i_size = stream_Size( p_demux->s );
+
+    if( p_demux->psz_location == NULL || i_size == 0 )
+        return;
+
+    vlc_mutex_lock( &ps_index_cache.lock );
+    for( unsigned i = 0; i < PS_INDEX_CACHE_SIZE; i++ )
+    {
+        ps_index_cache_entry_t *e = &ps_index_cache.entries[i];
+
+        if( e->psz_url == NULL || e->i_size != i_size ||
+            strcmp( e->psz_url, p_demux->psz_location ) )
+            continue;
+
+        p_sys->p_index = malloc( e->i_index * sizeof(*p_sys->p_index) );
+        if( p_sys->p_index != NULL )
+        {
+            memcpy( p_sys->p_index, e->p_index,
+                    e->i_index * sizeof(*p_sys->p_index) );
+            p_sys->i_index = p_sys->i_index_alloc = e->i_index;
+            p_sys->i_first_scr = e->i_first_scr;
+            msg_Dbg( p_demux, "reusing a %zu entries seek index",
+                     p_sys->i_index );
+        }
+        break;
+    }
+    vlc_mutex_unlock( &ps_index_cache.lock );
+}
+
+static void ps_index_save( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    uint64_t i_size = stream_Size( p_demux->s );
+
+    if( p_sys->b_index_broken || p_sys->i_index < 2 || i_size == 0 ||
+        p_demux->psz_location == NULL )
+        return;
+
+    char *psz_url = strdup( p_demux->psz_location );
+    ps_index_entry_t *p_index = malloc( p_sys->i_index * sizeof(*p_index) );
+    if( unlikely(psz_url == NULL || p_index == NULL) )
+    {
+        free( psz_url );
+        free( p_index );
+        return;
+    }
+    memcpy( p_index, p_sys->p_index, p_sys->i_index * sizeof(*p_index) );
+
+    vlc_mutex_lock( &ps_index_cache.lock );
+    unsigned i_slot = ps_index_cache.next;
+    for( unsigned i = 0; i < PS_INDEX_CACHE_SIZE; i++ )
+    {
+        const char *psz = ps_index_cache.entries[i].psz_url;
+        if( psz != NULL && !strcmp( psz, psz_url ) )
+        {
+            i_slot = i;
+            break;
+        }
+    }
+    if( i_slot == ps_index_cache.next )
+        ps_index_cache.next = (i_slot + 1) % PS_INDEX_CACHE_SIZE;
+
+    ps_index_cache_entry_t *e = &ps_index_cache.entries[i_slot];
+    free( e->psz_url );
+    free( e->p_index );
+    e->psz_url = psz_url;
+    e->i_size = i_size;
+    e->p_index = p_index;
+    e->i_index = p_sys->i_index;
+    e->i_first_scr = p_sys->i_first_scr;
+    vlc_mutex_unlock( &ps_index_cache.lock );
+}
+
+/* Looks for the first valid pack header at or after i_pos and returns its
+ * position and SCR. Leaves the stream position undefined. */
+static int ps_probe_scr( demux_t *p_demux, uint64_t i_pos,
+                         uint64_t *pi_pos, int64_t *pi_scr )
+{
+    const uint8_t *p_peek;
+
+    if( vlc_stream_Seek( p_demux->s, i_pos ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
+    ssize_t i_peek = vlc_stream_Peek( p_demux->s, &p_peek, PS_PROBE_WINDOW );
+    for( ssize_t i = 0; i + 14 <= i_peek; i++ )
+    {
+        const uint8_t *p = &p_peek[i];
+
+        if( p[0] != 0 || p[1] != 0 || p[2] != 1 || p[3] != 0xba )
+            continue;
+
+        /* Check the marker bits, the start code may be in a payload */
+        bool b_mpeg2 = (p[4] & 0xc4) == 0x44 && (p[6] & 0x04) &&
+                       (p[8] & 0x04) && (p[9] & 0x01);
+        bool b_mpeg1 = (p[4] & 0xf1) == 0x21 && (p[6] & 0x01) &&
+                       (p[8] & 0x01);
+        if( !b_mpeg2 && !b_mpeg1 )
+            continue;
+
+        block_t pkt;
+        int i_mux_rate;
+        block_Init( &pkt, (uint8_t *)p, 14 );
+        if( ps_pkt_parse_pack( &pkt, pi_scr, &i_mux_rate ) == VLC_SUCCESS )
+        {
+            *pi_pos = i_pos + i;
+            return VLC_SUCCESS;
+        }
+    }
+    return VLC_EGENERIC;
+}
+
+/* Bisects the file between the closest known SCRs around the target,
+ * interpolating on the way. Every probe enriches the index so repeated
+ * seeks in the same area converge in fewer steps. */
+static int ps_seek_time( demux_t *p_demux, int64_t i_time )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    uint64_t i_size = stream_Size( p_demux->s );
+    uint64_t i_pos;
+    int64_t i_scr;
+
+    if( !p_sys->b_seekable || p_sys->b_index_broken || i_size == 0 ||
+        !var_InheritBool( p_demux, "ps-trust-timestamps" ) )
+        return VLC_EGENERIC;
+
+    const uint64_t i_saved = vlc_stream_Tell( p_demux->s );
+
+    if( p_sys->i_first_scr < 0 )
+    {
+        if( ps_probe_scr( p_demux, 0, &i_pos, &i_scr ) )
+            goto error;
+        p_sys->i_first_scr = i_scr;
+        ps_index_add( p_demux, i_pos, i_scr, true );
+    }
+    const int64_t i_target = p_sys->i_first_scr + __MAX( i_time, 0 );
+
+    /* Bracket the target with the closest known entries */
+    uint64_t i_lo_pos = 0, i_hi_pos = i_size;
+    int64_t i_lo_scr = p_sys->i_first_scr, i_hi_scr = -1;
+    for( size_t i = 0; i < p_sys->i_index; i++ )
+    {
+        const ps_index_entry_t *e = &p_sys->p_index[i];
+        if( e->i_scr <= i_target )
+        {
+            i_lo_pos = e->i_pos;
+            i_lo_scr = e->i_scr;
+        }
+        else
+        {
+            i_hi_pos = e->i_pos;
+            i_hi_scr = e->i_scr;
+            break;
+        }
+    }
+    if( i_hi_scr < 0 )
+    {
+        if( p_sys->i_length <= 0 )
+            goto error;
+        i_hi_scr = p_sys->i_first_scr + p_sys->i_length;
+        if( i_hi_scr <= i_target )
+            goto error;
+    }
+
+    unsigned i_probes = 0;
+    while( i_hi_scr - i_lo_scr > PS_SEEK_PRECISION &&
+           i_hi_pos - i_lo_pos > PS_PROBE_WINDOW / 4 && i_probes < 32 )
+    {
+        /* Interpolate, but keep clear of the bounds to always converge */
+        uint64_t i_span = i_hi_pos - i_lo_pos;
+        uint64_t i_probe = i_lo_pos + (double)i_span *
+                           (i_target - i_lo_scr) / (i_hi_scr - i_lo_scr);
+        i_probe = VLC_CLIP( i_probe, i_lo_pos + i_span / 16,
+                            i_hi_pos - i_span / 16 );
+        i_probes++;
+
+        if( ps_probe_scr( p_demux, i_probe, &i_pos, &i_scr ) ||
+            i_pos >= i_hi_pos )
+        {
+            /* No pack before the upper bound: tighten it */
+            i_hi_pos = i_probe;
+            continue;
+        }
+
+        ps_index_add( p_demux, i_pos, i_scr, true );
+        if( p_sys->b_index_broken || i_scr < i_lo_scr )
+            goto error;
+
+        if( i_scr <= i_target )
+        {
+            i_lo_pos = i_pos;
+            i_lo_scr = i_scr;
+        }
+        else
+        {
+            i_hi_pos = i_pos;
+            i_hi_scr = i_scr;
+        }
+    }
+
+    msg_Dbg( p_demux, "seek to %"PRId64" us: offset %"PRIu64" after %u "
+             "probe(s)", i_time, i_lo_pos, i_probes );
+    if( vlc_stream_Seek( p_demux->s, i_lo_pos ) != VLC_SUCCESS )
+        goto error;
+    p_sys->i_current_pts = 0;
+    p_sys->i_last_scr = -1;
+    return VLC_SUCCESS;
+
+error:
+    vlc_stream_Seek( p_demux->s, i_saved );
+    return VLC_EGENERIC;
+}
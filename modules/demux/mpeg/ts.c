@@ -113,6 +113,11 @@ static void Close ( vlc_object_t * );
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
+#define PES_THREADS_TEXT N_("PES parsing threads")
+#define PES_THREADS_LONGTEXT N_("Number of threads parsing completed PES " \
+    "packets in parallel, each thread handling its own subset of the PIDs. " \
+    "0 parses everything on the demuxer thread.")
+
 static const char *const ts_standards_list[] =
     { "auto", "mpeg", "dvb", "arib", "atsc", "tdmb" };
 static const char *const ts_standards_list_text[] =
@@ -147,6 +152,8 @@ vlc_module_begin ()
 
     add_bool( "ts-split-es", true, SPLIT_ES_TEXT, SPLIT_ES_LONGTEXT, false )
     add_bool( "ts-seek-percent", false, SEEK_PERCENT_TEXT, SEEK_PERCENT_LONGTEXT, true )
+    add_integer_with_range( "ts-pes-threads", 0, 0, 16,
+                            PES_THREADS_TEXT, PES_THREADS_LONGTEXT, true )
 
     add_obsolete_bool( "ts-silent" );
 
@@ -175,6 +182,10 @@ static inline int PIDGet( block_t *p )
 static mtime_t GetPCR( const block_t * );
 
 static bool ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt );
+static void PESWorkersStart( demux_t *, unsigned );
+static void PESWorkersStop( demux_t * );
+static void PESWorkersCollect( demux_t *, bool );
+static void PESWorkersDrain( demux_t * );
 static bool GatherPESData( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk, size_t, bool );
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, mtime_t i_pcr );
 
@@ -182,6 +193,7 @@ static block_t* ReadTSPacket( demux_t *p_demux );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, int64_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, mtime_t );
+static void PCRIndexAdd( demux_t *, ts_pmt_t *, mtime_t );
 static void PCRFixHandle( demux_t *, ts_pmt_t *, block_t * );
 
 #define TS_PACKET_SIZE_188 188
@@ -379,7 +391,12 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_broken_charset = false;
 
-    ts_pid_list_Init( &p_sys->pids );
+    if( ts_pid_list_Init( &p_sys->pids ) != VLC_SUCCESS )
+    {
+        vlc_mutex_destroy( &p_sys->csa_lock );
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
 
     p_sys->i_packet_size = i_packet_size;
     p_sys->i_packet_header_size = i_packet_header_size;
@@ -395,6 +412,7 @@ static int Open( vlc_object_t *p_this )
     patpid = GetPID(p_sys, 0);
     if ( !PIDSetup( p_demux, TYPE_PAT, patpid, NULL ) )
     {
+        ts_pid_list_Release( p_demux, &p_sys->pids );
         vlc_mutex_destroy( &p_sys->csa_lock );
         free( p_sys );
         return VLC_ENOMEM;
@@ -402,6 +420,7 @@ static int Open( vlc_object_t *p_this )
     if( !ts_psi_PAT_Attach( patpid, p_demux ) )
     {
         PIDRelease( p_demux, patpid );
+        ts_pid_list_Release( p_demux, &p_sys->pids );
         vlc_mutex_destroy( &p_sys->csa_lock );
         free( p_sys );
         return VLC_EGENERIC;
@@ -419,6 +438,11 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_trust_pcr = var_CreateGetBool( p_demux, "ts-trust-pcr" );
 
+    /* Keep the unselected programs flowing for the ES output standby cache,
+     * as long as their packets are received at all */
+    p_sys->b_standby = !p_sys->b_access_control &&
+                       var_InheritInteger( p_demux, "program-standby" ) > 0;
+
     /* We handle description of an extra PMT */
     char* psz_string = var_CreateGetString( p_demux, "ts-extra-pmt" );
     p_sys->b_user_pmt = false;
@@ -506,6 +530,10 @@ static int Open( vlc_object_t *p_this )
     vlc_stream_Control( p_sys->stream, STREAM_CAN_FASTSEEK,
                         &p_sys->b_canfastseek );
 
+    int64_t i_pes_threads = var_InheritInteger( p_demux, "ts-pes-threads" );
+    if( i_pes_threads > 0 )
+        PESWorkersStart( p_demux, i_pes_threads );
+
     /* Preparse time */
     if( p_sys->b_canseek )
     {
@@ -529,6 +557,8 @@ static void Close( vlc_object_t *p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    PESWorkersStop( p_demux );
+
     PIDRelease( p_demux, GetPID(p_sys, 0) );
 
     vlc_mutex_lock( &p_sys->csa_lock );
@@ -591,9 +621,14 @@ static int Demux( demux_t *p_demux )
     demux_sys_t *p_sys = p_demux->p_sys;
     bool b_wait_es = p_sys->i_pmt_es <= 0;
 
+    /* Send what the PES workers completed since the last call */
+    if( p_sys->pes.i_pending > 0 )
+        PESWorkersCollect( p_demux, false );
+
     /* If we had no PAT within MIN_PAT_INTERVAL, create PAT/PMT from probed streams */
     if( p_sys->i_pmt_es == 0 && !SEEN(GetPID(p_sys, 0)) && p_sys->patfix.status == PAT_MISSING )
     {
+        PESWorkersDrain( p_demux );
         MissingPATPMTFixup( p_demux );
         p_sys->patfix.status = PAT_FIXTRIED;
     }
@@ -605,6 +640,7 @@ static int Demux( demux_t *p_demux )
         block_t     *p_pkt;
         if( !(p_pkt = ReadTSPacket( p_demux )) )
         {
+            PESWorkersDrain( p_demux );
             return VLC_DEMUXER_EOF;
         }
 
@@ -622,6 +658,7 @@ static int Demux( demux_t *p_demux )
         if( (p_pkt->p_buffer[1] & 0x40) && (p_pkt->p_buffer[3] & 0x10) &&
             !SCRAMBLED(*p_pid) != !(p_pkt->p_buffer[3] & 0x80) )
         {
+            PESWorkersDrain( p_demux );
             UpdatePIDScrambledState( p_demux, p_pid, p_pkt->p_buffer[3] & 0x80 );
         }
 
@@ -637,7 +674,11 @@ static int Demux( demux_t *p_demux )
         /* Adaptation field cannot be scrambled */
         mtime_t i_pcr = GetPCR( p_pkt );
         if( i_pcr > VLC_TS_INVALID )
+        {
+            /* Everything before the PCR must reach the ES output first */
+            PESWorkersDrain( p_demux );
             PCRHandle( p_demux, p_pid, i_pcr );
+        }
 
         if ( SCRAMBLED(*p_pid) && !p_demux->p_sys->csa && p_sys->b_valid_scrambling )
         {
@@ -659,6 +700,7 @@ static int Demux( demux_t *p_demux )
         {
         case TYPE_PAT:
         case TYPE_PMT:
+            PESWorkersDrain( p_demux );
             ts_psi_Packet_Push( p_pid, p_pkt->p_buffer );
             block_Release( p_pkt );
             break;
@@ -669,6 +711,7 @@ static int Demux( demux_t *p_demux )
             if( p_sys->es_creation == DELAY_ES ) /* No longer delay ES since that pid's program sends data */
             {
                 msg_Dbg( p_demux, "Creating delayed ES" );
+                PESWorkersDrain( p_demux );
                 AddAndCreateES( p_demux, p_pid, true );
             }
 
@@ -681,14 +724,18 @@ static int Demux( demux_t *p_demux )
             }
 
             b_frame = ProcessTSPacket( p_demux, p_pid, p_pkt );
+            if( b_frame && p_sys->pes.i_pending > 0 )
+                PESWorkersCollect( p_demux, false );
             break;
 
         case TYPE_SI:
+            PESWorkersDrain( p_demux );
             ts_si_Packet_Push( p_pid, p_pkt->p_buffer );
             block_Release( p_pkt );
             break;
 
         case TYPE_PSIP:
+            PESWorkersDrain( p_demux );
             ts_psip_Packet_Push( p_pid, p_pkt->p_buffer );
             block_Release( p_pkt );
             break;
@@ -806,6 +853,21 @@ void UpdatePESFilters( demux_t *p_demux, bool b_all )
                 msg_Dbg( p_demux, "enabling pcr pid %d from program %d", p_pmt->i_pid_pcr, p_pmt->i_number );
             }
         }
+        else if( p_sys->b_standby )
+        {
+            /* Gather the audio and video of the program in standby */
+            for( int j=0; j<p_pmt->e_streams.i_size; j++ )
+            {
+                ts_pid_t *espid = p_pmt->e_streams.p_elems[j];
+                const ts_pes_es_t *p_es = espid->u.p_pes->p_es;
+
+                if( p_es && (p_es->fmt.i_cat == VIDEO_ES ||
+                             p_es->fmt.i_cat == AUDIO_ES) )
+                    espid->i_flags |= FLAG_FILTERED;
+            }
+            if( p_pmt->i_pid_pcr > 0 )
+                GetPID(p_sys, p_pmt->i_pid_pcr)->i_flags |= FLAG_FILTERED;
+        }
     }
 
     /* Commit HW changes based on flags */
@@ -837,6 +899,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     const ts_pmt_t *p_pmt = NULL;
     const ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
 
+    PESWorkersDrain( p_demux );
+
     for( int i=0; i<p_pat->programs.i_size && !p_pmt; i++ )
     {
         if( p_pat->programs.p_elems[i]->u.p_pmt->b_selected )
@@ -1228,8 +1292,57 @@ invalid:
 /****************************************************************************
  * gathering stuff
  ****************************************************************************/
-static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
+/* A completed PES on its way to the ES output. When PES workers are in use,
+ * the program clock fields are copied when the job is queued, and the
+ * demuxer thread drains all jobs before touching any PSI or clock state, so
+ * that workers only read data that cannot change under them. */
+typedef struct
+{
+    block_t     self;
+    ts_pid_t   *pid;
+    block_t    *p_data; /* PES chain, then the parsed ES blocks */
+    mtime_t     i_pcr_first;
+    mtime_t     i_pcr_current;
+    bool        b_valid_scrambling;
+    uint8_t     i_stream_id;
+} ts_pes_job_t;
+
+struct ts_pes_worker_t
+{
+    vlc_thread_t  thread;
+    block_fifo_t *p_fifo;
+    demux_t      *p_demux;
+};
+
+static void PESJobInit( demux_t *p_demux, ts_pes_job_t *p_job,
+                        ts_pid_t *pid, block_t *p_data )
+{
+    const ts_pmt_t *p_pmt = pid->u.p_pes->p_es->p_program;
+
+    p_job->pid = pid;
+    p_job->p_data = p_data;
+    p_job->i_pcr_first = p_pmt ? p_pmt->pcr.i_first : -1;
+    p_job->i_pcr_current = p_pmt ? p_pmt->pcr.i_current : -1;
+    p_job->b_valid_scrambling = p_demux->p_sys->b_valid_scrambling;
+    p_job->i_stream_id = 0;
+}
+
+static void PESJobRelease( block_t *p_block )
 {
+    ts_pes_job_t *p_job = (ts_pes_job_t *)p_block;
+
+    block_ChainRelease( p_job->p_data );
+    free( p_job );
+}
+
+/* Parses the header of a completed PES and turns its payload into ES blocks.
+ * This does not touch any program or output state and may run on a PES
+ * worker thread. */
+static void ParsePESJob( demux_t *p_demux, ts_pes_job_t *p_job )
+{
+    ts_pid_t *pid = p_job->pid;
+    block_t *p_pes = p_job->p_data;
+
     uint8_t header[34];
     unsigned i_pes_size = 0;
     unsigned i_skip = 0;
@@ -1241,6 +1354,7 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
     const es_mpeg4_descriptor_t *p_mpeg4desc = NULL;
 
     assert(pid->type == TYPE_PES);
+    p_job->p_data = NULL;
 
     const int i_max = block_ChainExtract( p_pes, header, 34 );
     if ( i_max < 4 )
@@ -1249,7 +1363,7 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
         return;
     }
 
-    if( (p_pes->i_flags & BLOCK_FLAG_SCRAMBLED) && p_demux->p_sys->b_valid_scrambling )
+    if( (p_pes->i_flags & BLOCK_FLAG_SCRAMBLED) && p_job->b_valid_scrambling )
     {
         block_ChainRelease( p_pes );
         return;
@@ -1280,9 +1394,9 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
     else
     {
         if( i_pts != -1 && p_es->p_program )
-            i_pts = TimeStampWrapAround( p_es->p_program->pcr.i_first, i_pts );
+            i_pts = TimeStampWrapAround( p_job->i_pcr_first, i_pts );
         if( i_dts != -1 && p_es->p_program )
-            i_dts = TimeStampWrapAround( p_es->p_program->pcr.i_first, i_dts );
+            i_dts = TimeStampWrapAround( p_job->i_pcr_first, i_dts );
         if( b_pes_scrambling )
             p_pes->i_flags |= BLOCK_FLAG_SCRAMBLED;
     }
@@ -1375,7 +1489,7 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
             {
                 /* Teletext may have missing PTS (ETSI EN 300 472 Annexe A)
                  * In this case use the last PCR + 40ms */
-                mtime_t i_pcr = p_es->p_program->pcr.i_current;
+                mtime_t i_pcr = p_job->i_pcr_current;
                 if( i_pcr > VLC_TS_INVALID )
                     p_block->i_pts = FROM_SCALE(i_pcr) + 40000;
             }
@@ -1415,167 +1529,329 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
                 return;
         }
 
-        ts_pmt_t *p_pmt = p_es->p_program;
-        if( unlikely(!p_pmt) )
-        {
-            block_ChainRelease( p_block );
-            return;
-        }
+        p_job->p_data = p_block;
+        p_job->i_stream_id = i_stream_id;
+    }
+    else
+    {
+        msg_Warn( p_demux, "empty pes" );
+    }
+}
 
-        while (p_block) {
-            block_t *p_next = p_block->p_next;
-            p_block->p_next = NULL;
+/* Sends the blocks of a parsed PES, applying the program clock fixups.
+ * Always runs on the demuxer thread. */
+static void SendPESJob( demux_t *p_demux, ts_pes_job_t *p_job )
+{
+    ts_pid_t *pid = p_job->pid;
+    block_t *p_block = p_job->p_data;
+    const uint8_t i_stream_id = p_job->i_stream_id;
 
-            if( !p_pmt->pcr.b_fix_done ) /* Not seen yet */
-                PCRFixHandle( p_demux, p_pmt, p_block );
+    p_job->p_data = NULL;
+    if( p_block == NULL )
+        return;
 
-            if( p_es->id && (p_pmt->pcr.i_current > -1 || p_pmt->pcr.b_disable) )
+    ts_pes_es_t *p_es = pid->u.p_pes->p_es;
+    ts_pmt_t *p_pmt = p_es->p_program;
+    if( unlikely(!p_pmt) )
+    {
+        block_ChainRelease( p_block );
+        return;
+    }
+
+    while (p_block) {
+        block_t *p_next = p_block->p_next;
+        p_block->p_next = NULL;
+
+        if( !p_pmt->pcr.b_fix_done ) /* Not seen yet */
+            PCRFixHandle( p_demux, p_pmt, p_block );
+
+        if( p_es->id && (p_pmt->pcr.i_current > -1 || p_pmt->pcr.b_disable) )
+        {
+            if( pid->u.p_pes->p_prepcr_outqueue )
             {
-                if( pid->u.p_pes->p_prepcr_outqueue )
-                {
-                    block_ChainAppend( &pid->u.p_pes->p_prepcr_outqueue, p_block );
-                    p_block = pid->u.p_pes->p_prepcr_outqueue;
-                    p_next = p_block->p_next;
-                    p_block->p_next = NULL;
-                    pid->u.p_pes->p_prepcr_outqueue = NULL;
-                }
+                block_ChainAppend( &pid->u.p_pes->p_prepcr_outqueue, p_block );
+                p_block = pid->u.p_pes->p_prepcr_outqueue;
+                p_next = p_block->p_next;
+                p_block->p_next = NULL;
+                pid->u.p_pes->p_prepcr_outqueue = NULL;
+            }
 
-                if ( p_pmt->pcr.b_disable && p_block->i_dts > VLC_TS_INVALID &&
-                     ( p_pmt->i_pid_pcr == pid->i_pid || p_pmt->i_pid_pcr == 0x1FFF ) )
-                {
-                    ProgramSetPCR( p_demux, p_pmt, TO_SCALE(p_block->i_dts) - 120000 );
-                }
+            if ( p_pmt->pcr.b_disable && p_block->i_dts > VLC_TS_INVALID &&
+                 ( p_pmt->i_pid_pcr == pid->i_pid || p_pmt->i_pid_pcr == 0x1FFF ) )
+            {
+                ProgramSetPCR( p_demux, p_pmt, TO_SCALE(p_block->i_dts) - 120000 );
+            }
 
-                /* Compute PCR/DTS offset if any */
-                if( p_pmt->pcr.i_pcroffset == -1 && p_block->i_dts > VLC_TS_INVALID &&
-                    p_pmt->pcr.i_current > VLC_TS_INVALID &&
-                   (p_es->fmt.i_cat == VIDEO_ES || p_es->fmt.i_cat == AUDIO_ES) )
+            /* Compute PCR/DTS offset if any */
+            if( p_pmt->pcr.i_pcroffset == -1 && p_block->i_dts > VLC_TS_INVALID &&
+                p_pmt->pcr.i_current > VLC_TS_INVALID &&
+               (p_es->fmt.i_cat == VIDEO_ES || p_es->fmt.i_cat == AUDIO_ES) )
+            {
+                int64_t i_dts27 = TO_SCALE(p_block->i_dts);
+                i_dts27 = TimeStampWrapAround( p_pmt->pcr.i_first, i_dts27 );
+                int64_t i_pcr = TimeStampWrapAround( p_pmt->pcr.i_first, p_pmt->pcr.i_current );
+                if( i_dts27 < i_pcr )
                 {
-                    int64_t i_dts27 = TO_SCALE(p_block->i_dts);
-                    i_dts27 = TimeStampWrapAround( p_pmt->pcr.i_first, i_dts27 );
-                    int64_t i_pcr = TimeStampWrapAround( p_pmt->pcr.i_first, p_pmt->pcr.i_current );
-                    if( i_dts27 < i_pcr )
-                    {
-                        p_pmt->pcr.i_pcroffset = i_pcr - i_dts27 + 80000;
-                        msg_Warn( p_demux, "Broken stream: pid %d sends packets with dts %"PRId64
-                                           "us later than pcr, applying delay",
-                                  pid->i_pid, FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset) );
-                    }
-                    else p_pmt->pcr.i_pcroffset = 0;
+                    p_pmt->pcr.i_pcroffset = i_pcr - i_dts27 + 80000;
+                    msg_Warn( p_demux, "Broken stream: pid %d sends packets with dts %"PRId64
+                                       "us later than pcr, applying delay",
+                              pid->i_pid, FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset) );
                 }
+                else p_pmt->pcr.i_pcroffset = 0;
+            }
 
-                if( p_pmt->pcr.i_pcroffset != -1 )
-                {
-                    if( p_block->i_dts > VLC_TS_INVALID )
-                        p_block->i_dts += FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset);
-                    if( p_block->i_pts > VLC_TS_INVALID )
-                        p_block->i_pts += FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset);
-                }
+            if( p_pmt->pcr.i_pcroffset != -1 )
+            {
+                if( p_block->i_dts > VLC_TS_INVALID )
+                    p_block->i_dts += FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset);
+                if( p_block->i_pts > VLC_TS_INVALID )
+                    p_block->i_pts += FROM_SCALE_NZ(p_pmt->pcr.i_pcroffset);
+            }
+
+            /* METADATA in PES */
+            if( pid->u.p_pes->i_stream_type == 0x15 && i_stream_id == 0xbd )
+            {
+                ProcessMetadata( p_demux->out, p_es->metadata.i_format, p_pmt->i_number,
+                                 p_block->p_buffer, p_block->i_buffer );
+            }
 
-                /* METADATA in PES */
-                if( pid->u.p_pes->i_stream_type == 0x15 && i_stream_id == 0xbd )
+            /* SL in PES */
+            if( pid->u.p_pes->i_stream_type == 0x12 &&
+                ((i_stream_id & 0xFE) == 0xFA) /* 0xFA || 0xFB */ )
+            {
+                const es_mpeg4_descriptor_t *p_desc = GetMPEG4DescByEsId( p_pmt, p_es->i_sl_es_id );
+                if(!p_desc)
                 {
-                    ProcessMetadata( p_demux->out, p_es->metadata.i_format, p_pmt->i_number,
-                                     p_block->p_buffer, p_block->i_buffer );
+                    block_Release( p_block );
+                    p_block = NULL;
                 }
-
-                /* SL in PES */
-                if( pid->u.p_pes->i_stream_type == 0x12 &&
-                    ((i_stream_id & 0xFE) == 0xFA) /* 0xFA || 0xFB */ )
+                else
                 {
-                    const es_mpeg4_descriptor_t *p_desc = GetMPEG4DescByEsId( p_pmt, p_es->i_sl_es_id );
-                    if(!p_desc)
+                    sl_header_data header = DecodeSLHeader( p_block->i_buffer, p_block->p_buffer,
+                                                            &p_desc->sl_descr );
+                    p_block->i_buffer -= header.i_size;
+                    p_block->p_buffer += header.i_size;
+                    p_block->i_dts = header.i_dts ? header.i_dts : p_block->i_dts;
+                    p_block->i_pts = header.i_pts ? header.i_pts : p_block->i_pts;
+
+                    /* Assemble access units */
+                    if( header.b_au_start && pid->u.p_pes->sl.p_data )
                     {
-                        block_Release( p_block );
-                        p_block = NULL;
+                        block_ChainRelease( pid->u.p_pes->sl.p_data );
+                        pid->u.p_pes->sl.p_data = NULL;
+                        pid->u.p_pes->sl.pp_last = &pid->u.p_pes->sl.p_data;
                     }
-                    else
+                    block_ChainLastAppend( &pid->u.p_pes->sl.pp_last, p_block );
+                    p_block = NULL;
+                    if( header.b_au_end )
                     {
-                        sl_header_data header = DecodeSLHeader( p_block->i_buffer, p_block->p_buffer,
-                                                                &p_mpeg4desc->sl_descr );
-                        p_block->i_buffer -= header.i_size;
-                        p_block->p_buffer += header.i_size;
-                        p_block->i_dts = header.i_dts ? header.i_dts : p_block->i_dts;
-                        p_block->i_pts = header.i_pts ? header.i_pts : p_block->i_pts;
-
-                        /* Assemble access units */
-                        if( header.b_au_start && pid->u.p_pes->sl.p_data )
-                        {
-                            block_ChainRelease( pid->u.p_pes->sl.p_data );
-                            pid->u.p_pes->sl.p_data = NULL;
-                            pid->u.p_pes->sl.pp_last = &pid->u.p_pes->sl.p_data;
-                        }
-                        block_ChainLastAppend( &pid->u.p_pes->sl.pp_last, p_block );
-                        p_block = NULL;
-                        if( header.b_au_end )
-                        {
-                            p_block = block_ChainGather( pid->u.p_pes->sl.p_data );
-                            pid->u.p_pes->sl.p_data = NULL;
-                            pid->u.p_pes->sl.pp_last = &pid->u.p_pes->sl.p_data;
-                        }
+                        p_block = block_ChainGather( pid->u.p_pes->sl.p_data );
+                        pid->u.p_pes->sl.p_data = NULL;
+                        pid->u.p_pes->sl.pp_last = &pid->u.p_pes->sl.p_data;
                     }
                 }
+            }
 
-                if ( p_block )
+            if ( p_block )
+            {
+                ts_pes_es_t *p_es_send = p_es;
+                while( p_es_send )
                 {
-                    ts_pes_es_t *p_es_send = p_es;
-                    while( p_es_send )
+                    if( p_es_send->p_program->b_selected || p_demux->p_sys->b_standby )
                     {
-                        if( p_es_send->p_program->b_selected )
+                        /* Send a copy to each extra es */
+                        ts_pes_es_t *p_extra_es = p_es_send->p_extraes;
+                        while( p_extra_es )
                         {
-                            /* Send a copy to each extra es */
-                            ts_pes_es_t *p_extra_es = p_es_send->p_extraes;
-                            while( p_extra_es )
+                            if( p_extra_es->id )
                             {
-                                if( p_extra_es->id )
-                                {
-                                    block_t *p_dup = block_Duplicate( p_block );
-                                    if( p_dup )
-                                        es_out_Send( p_demux->out, p_extra_es->id, p_dup );
-                                }
-                                p_extra_es = p_extra_es->p_next;
+                                block_t *p_dup = block_Duplicate( p_block );
+                                if( p_dup )
+                                    es_out_Send( p_demux->out, p_extra_es->id, p_dup );
                             }
+                            p_extra_es = p_extra_es->p_next;
+                        }
 
-                            if( p_es_send->p_next )
+                        if( p_es_send->p_next )
+                        {
+                            if( p_es_send->id )
                             {
-                                if( p_es_send->id )
-                                {
-                                    block_t *p_dup = block_Duplicate( p_block );
-                                    if( p_dup )
-                                        es_out_Send( p_demux->out, p_es_send->id, p_dup );
-                                }
+                                block_t *p_dup = block_Duplicate( p_block );
+                                if( p_dup )
+                                    es_out_Send( p_demux->out, p_es_send->id, p_dup );
                             }
-                            else
+                        }
+                        else
+                        {
+                            if( p_es_send->id )
                             {
-                                if( p_es_send->id )
-                                {
-                                    es_out_Send( p_demux->out, p_es_send->id, p_block );
-                                    p_block = NULL;
-                                }
+                                es_out_Send( p_demux->out, p_es_send->id, p_block );
+                                p_block = NULL;
                             }
                         }
-                        p_es_send = p_es_send->p_next;
                     }
-
-                    if( p_block )
-                        block_Release( p_block );
+                    p_es_send = p_es_send->p_next;
                 }
-            }
-            else
-            {
-                if( !p_pmt->pcr.b_fix_done ) /* Not seen yet */
-                    PCRFixHandle( p_demux, p_pmt, p_block );
 
-                block_ChainAppend( &pid->u.p_pes->p_prepcr_outqueue, p_block );
+                if( p_block )
+                    block_Release( p_block );
             }
+        }
+        else
+        {
+            if( !p_pmt->pcr.b_fix_done ) /* Not seen yet */
+                PCRFixHandle( p_demux, p_pmt, p_block );
 
-            p_block = p_next;
+            block_ChainAppend( &pid->u.p_pes->p_prepcr_outqueue, p_block );
         }
+
+        p_block = p_next;
     }
-    else
+}
+
+static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->pes.i_count > 0 )
     {
-        msg_Warn( p_demux, "empty pes" );
+        ts_pes_job_t *p_job = malloc( sizeof(*p_job) );
+        if( likely(p_job != NULL) )
+        {
+            block_Init( &p_job->self, NULL, 0 );
+            p_job->self.pf_release = PESJobRelease;
+            PESJobInit( p_demux, p_job, pid, p_pes );
+
+            /* Keep each PID on the same worker to preserve its order */
+            ts_pes_worker_t *p_worker =
+                &p_sys->pes.p_workers[pid->i_pid % p_sys->pes.i_count];
+            p_sys->pes.i_pending++;
+            block_FifoPut( p_worker->p_fifo, &p_job->self );
+            return;
+        }
+    }
+
+    ts_pes_job_t job;
+    PESJobInit( p_demux, &job, pid, p_pes );
+    ParsePESJob( p_demux, &job );
+    SendPESJob( p_demux, &job );
+}
+
+static void *PESWorkerThread( void *data )
+{
+    ts_pes_worker_t *p_worker = data;
+    demux_t *p_demux = p_worker->p_demux;
+
+    for( ;; )
+    {
+        block_t *p_block = block_FifoGet( p_worker->p_fifo );
+        int canc = vlc_savecancel();
+
+        ParsePESJob( p_demux, (ts_pes_job_t *)p_block );
+        block_FifoPut( p_demux->p_sys->pes.p_done, p_block );
+
+        vlc_restorecancel( canc );
+    }
+    vlc_assert_unreachable();
+}
+
+/* Sends the PES parsed by the workers so far. If b_wait is set, returns only
+ * once every queued PES has been sent. */
+static void PESWorkersCollect( demux_t *p_demux, bool b_wait )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    block_fifo_t *p_done = p_sys->pes.p_done;
+
+    while( p_sys->pes.i_pending > 0 )
+    {
+        vlc_fifo_Lock( p_done );
+        while( b_wait && vlc_fifo_IsEmpty( p_done ) )
+            vlc_fifo_Wait( p_done );
+        block_t *p_list = vlc_fifo_DequeueAllUnlocked( p_done );
+        vlc_fifo_Unlock( p_done );
+
+        if( p_list == NULL )
+            break;
+
+        while( p_list )
+        {
+            block_t *p_next = p_list->p_next;
+            p_list->p_next = NULL;
+
+            SendPESJob( p_demux, (ts_pes_job_t *)p_list );
+            block_Release( p_list );
+            p_sys->pes.i_pending--;
+
+            p_list = p_next;
+        }
+    }
+}
+
+static void PESWorkersDrain( demux_t *p_demux )
+{
+    if( p_demux->p_sys->pes.i_pending > 0 )
+        PESWorkersCollect( p_demux, true );
+}
+
+static void PESWorkersStop( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    PESWorkersDrain( p_demux );
+
+    for( unsigned i = 0; i < p_sys->pes.i_count; i++ )
+    {
+        ts_pes_worker_t *p_worker = &p_sys->pes.p_workers[i];
+
+        vlc_cancel( p_worker->thread );
+        vlc_join( p_worker->thread, NULL );
+        block_FifoRelease( p_worker->p_fifo );
+    }
+    free( p_sys->pes.p_workers );
+    p_sys->pes.p_workers = NULL;
+    p_sys->pes.i_count = 0;
+
+    if( p_sys->pes.p_done )
+    {
+        block_FifoRelease( p_sys->pes.p_done );
+        p_sys->pes.p_done = NULL;
+    }
+}
+
+static void PESWorkersStart( demux_t *p_demux, unsigned i_count )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    p_sys->pes.i_pending = 0;
+    p_sys->pes.p_done = block_FifoNew();
+    p_sys->pes.p_workers = malloc( i_count * sizeof(*p_sys->pes.p_workers) );
+    if( !p_sys->pes.p_done || !p_sys->pes.p_workers )
+        goto error;
+
+    for( ; p_sys->pes.i_count < i_count; p_sys->pes.i_count++ )
+    {
+        ts_pes_worker_t *p_worker = &p_sys->pes.p_workers[p_sys->pes.i_count];
+
+        p_worker->p_demux = p_demux;
+        p_worker->p_fifo = block_FifoNewSPSC();
+        if( !p_worker->p_fifo )
+            break;
+        if( vlc_clone( &p_worker->thread, PESWorkerThread, p_worker,
+                       VLC_THREAD_PRIORITY_INPUT ) )
+        {
+            block_FifoRelease( p_worker->p_fifo );
+            break;
+        }
     }
+
+    if( p_sys->pes.i_count == 0 )
+        goto error;
+    msg_Dbg( p_demux, "parsing PES with %u threads", p_sys->pes.i_count );
+    return;
+
+error:
+    msg_Warn( p_demux, "cannot start PES parsing threads" );
+    PESWorkersStop( p_demux );
 }
 
 static bool PushPESBlock( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, bool b_unit_start )
@@ -1808,6 +2084,67 @@ static void ReadyQueuesPostSeek( demux_t *p_demux )
     }
 }
 
+#define PCR_INDEX_INTERVAL  TO_SCALE_NZ(CLOCK_FREQ / 4)
+#define PCR_INDEX_MAX       (1 << 17)
+#define SEEK_PRECISION      TO_SCALE_NZ(CLOCK_FREQ / 2)
+
+/* Index of the first entry at or after i_pos */
+static int PCRIndexLookup( const ts_pmt_t *p_pmt, uint64_t i_pos )
+{
+    int i_lo = 0, i_hi = p_pmt->pcr_index.entries.i_size;
+
+    while( i_lo < i_hi )
+    {
+        int i_mid = (i_lo + i_hi) / 2;
+        if( p_pmt->pcr_index.entries.p_elems[i_mid].i_pos < i_pos )
+            i_lo = i_mid + 1;
+        else
+            i_hi = i_mid;
+    }
+    return i_lo;
+}
+
+/* Records the position of the packet carrying the program PCR that was just
+ * read. Entries are kept every PCR_INDEX_INTERVAL at most. */
+static void PCRIndexAdd( demux_t *p_demux, ts_pmt_t *p_pmt, mtime_t i_pcr )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->b_canfastseek || p_pmt->pcr.b_disable ||
+        p_pmt->pcr_index.b_broken ||
+        p_pmt->pcr_index.entries.i_size >= PCR_INDEX_MAX )
+        return;
+
+    const uint64_t i_end = vlc_stream_Tell( p_sys->stream );
+    if( i_end < p_sys->i_packet_size )
+        return;
+    const uint64_t i_pos = i_end - p_sys->i_packet_size;
+
+    const ts_pcr_index_entry_t *p_entries = p_pmt->pcr_index.entries.p_elems;
+    const int i_size = p_pmt->pcr_index.entries.i_size;
+    const int i = PCRIndexLookup( p_pmt, i_pos );
+    if( i < i_size && p_entries[i].i_pos == i_pos )
+        return;
+
+    /* The index is only usable while the PCR grows with the position */
+    if( ( i > 0 && p_entries[i - 1].i_pcr > i_pcr ) ||
+        ( i < i_size && p_entries[i].i_pcr < i_pcr ) )
+    {
+        msg_Dbg( p_demux, "Program %d PCR discontinuity at %"PRIu64", "
+                 "disabling the seek index", p_pmt->i_number, i_pos );
+        ARRAY_RESET( p_pmt->pcr_index.entries );
+        p_pmt->pcr_index.b_broken = true;
+        return;
+    }
+
+    if( ( i > 0 && i_pcr - p_entries[i - 1].i_pcr < PCR_INDEX_INTERVAL ) ||
+        ( i < i_size && p_entries[i].i_pcr - i_pcr < PCR_INDEX_INTERVAL ) )
+        return;
+
+    ts_pcr_index_entry_t entry = { .i_pos = i_pos, .i_pcr = i_pcr };
+    ARRAY_INSERT( p_pmt->pcr_index.entries, entry, i );
+}
+
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, int64_t i_scaledtime )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -1828,6 +2165,34 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, int64_t i_scaled
     if( i_head_pos >= i_tail_pos )
         return VLC_EGENERIC;
 
+    /* Narrow the search to the closest PCRs already seen while playing */
+    bool b_indexed = false;
+    if( !p_pmt->pcr_index.b_broken && p_pmt->pcr_index.entries.i_size > 0 )
+    {
+        const ts_pcr_index_entry_t *p_entries = p_pmt->pcr_index.entries.p_elems;
+        int i_lo = 0, i_hi = p_pmt->pcr_index.entries.i_size;
+        while( i_lo < i_hi ) /* first entry past the target */
+        {
+            int i_mid = (i_lo + i_hi) / 2;
+            if( p_entries[i_mid].i_pcr <= i_scaledtime )
+                i_lo = i_mid + 1;
+            else
+                i_hi = i_mid;
+        }
+
+        if( i_lo > 0 )
+        {
+            const ts_pcr_index_entry_t *p_prev = &p_entries[i_lo - 1];
+            if( i_scaledtime - p_prev->i_pcr < SEEK_PRECISION )
+                return vlc_stream_Seek( p_sys->stream, p_prev->i_pos );
+            i_head_pos = p_prev->i_pos;
+            b_indexed = true;
+        }
+        if( i_lo < p_pmt->pcr_index.entries.i_size &&
+            p_entries[i_lo].i_pos < i_tail_pos )
+            i_tail_pos = p_entries[i_lo].i_pos;
+    }
+
     bool b_found = false;
     while( (i_head_pos + p_sys->i_packet_size) <= i_tail_pos && !b_found )
     {
@@ -1890,7 +2255,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, int64_t i_scaled
                 int64_t i_diff = i_scaledtime - TimeStampWrapAround( p_pmt->pcr.i_first, i_pcr );
                 if ( i_diff < 0 )
                     i_tail_pos = (i_splitpos >= p_sys->i_packet_size) ? i_splitpos - p_sys->i_packet_size : 0;
-                else if( i_diff < TO_SCALE(VLC_TS_0 + CLOCK_FREQ / 2) ) // 500ms
+                else if( i_diff < SEEK_PRECISION ) // 500ms
                     b_found = true;
                 else
                     i_head_pos = i_pos;
@@ -1902,6 +2267,10 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, int64_t i_scaled
             i_tail_pos = (i_splitpos >= p_sys->i_packet_size) ? i_splitpos - p_sys->i_packet_size : 0;
     }
 
+    /* The indexed PCR before the target is still better than nothing */
+    if( !b_found && b_indexed )
+        b_found = vlc_stream_Seek( p_sys->stream, i_head_pos ) == VLC_SUCCESS;
+
     if( !b_found )
     {
         msg_Dbg( p_demux, "Seek():cannot find a time position." );
@@ -2223,6 +2592,7 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, mtime_t i_pcr )
             {
                 /* ? update PCR for the whole group program ? */
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+                PCRIndexAdd( p_demux, p_pmt, i_program_pcr );
             }
         }
         else /* set PCR provided by current pid to program(s) referencing it */
@@ -2232,7 +2602,9 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, mtime_t i_pcr )
             {
                 /* We've found a target group for update */
                 PCRCheckDTS( p_demux, p_pmt, i_pcr );
+                PESWorkersDrain( p_demux ); /* flushed by PCRCheckDTS */
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+                PCRIndexAdd( p_demux, p_pmt, i_program_pcr );
             }
         }
 
@@ -2375,10 +2747,9 @@ static bool ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt )
                             pid->i_pid );
                 /* pid->es->p_data->i_flags |= BLOCK_FLAG_DISCONTINUITY; */
             }
-#if 0
-            if( p[5]&0x40 )
-                msg_Dbg( p_demux, "random access indicator (pid=%d) ", pid->i_pid );
-#endif
+            /* random access indicator */
+            if( (p[5]&0x40) && b_unit_start )
+                p_pkt->i_flags |= BLOCK_FLAG_TYPE_I;
         }
     }
 
@@ -2443,7 +2814,7 @@ static bool ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt )
 }
 
 /* Avoids largest memcpy */
-static bool block_Split( block_t **pp_block, block_t **pp_remain, size_t i_offset )
+static bool SplitBlock( block_t **pp_block, block_t **pp_remain, size_t i_offset )
 {
     block_t *p_block = *pp_block;
     block_t *p_split = NULL;
@@ -2599,7 +2970,7 @@ static bool GatherPESData( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt,
                 else /* p_pkt->i_buffer > i_remain */
                 {
                     block_t *p_split;
-                    if( !block_Split( &p_pkt, &p_split, i_remain ) )
+                    if( !SplitBlock( &p_pkt, &p_split, i_remain ) )
                     {
                         block_Release( p_pkt );
                         return false;
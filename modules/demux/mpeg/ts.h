@@ -24,6 +24,7 @@
     typedef struct arib_instance_t arib_instance_t;
 #endif
 typedef struct csa_t csa_t;
+typedef struct ts_pes_worker_t ts_pes_worker_t;
 
 #define TS_USER_PMT_NUMBER (0)
 
@@ -97,6 +98,16 @@ struct demux_sys_t
     bool        b_valid_scrambling;
 
     bool        b_trust_pcr;
+    bool        b_standby; /* Also send the ES of unselected programs */
+
+    /* PES parsing offload */
+    struct
+    {
+        ts_pes_worker_t *p_workers;
+        unsigned         i_count;
+        unsigned         i_pending; /* parsed by workers, not yet sent */
+        block_fifo_t    *p_done;
+    } pes;
 
     /* */
     bool        b_access_control;
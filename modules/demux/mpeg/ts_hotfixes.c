@@ -301,7 +301,7 @@ void MissingPATPMTFixup( demux_t *p_demux )
     };
 
     BuildPAT( GetPID(p_sys, 0)->u.p_pat->handle,
-            &p_sys->pids.pat, BuildPATCallback,
+            GetPID(p_sys, 0), BuildPATCallback,
             0, 1,
             &patstream,
             1, &pmtprogramstream, &i_program_number );
@@ -32,58 +32,50 @@
 
 #define PID_ALLOC_CHUNK 16
 
-void ts_pid_list_Init( ts_pid_list_t *p_list )
+static void ts_pid_Preset( ts_pid_list_t *p_list, uint16_t i_pid, uint8_t i_flags )
 {
-    p_list->dummy.i_pid = 8191;
-    p_list->dummy.i_flags = FLAG_SEEN;
-    p_list->base_si.i_pid = 0x1FFB;
+    ts_pid_t *p_pid = &p_list->p_table[i_pid];
+    p_pid->i_pid = i_pid;
+    p_pid->i_flags = i_flags;
+    p_pid->b_listed = true;
+}
+
+int ts_pid_list_Init( ts_pid_list_t *p_list )
+{
+    p_list->p_table = vlc_memalign( 64, TS_PID_COUNT * sizeof(ts_pid_t) );
+    if( unlikely(p_list->p_table == NULL) )
+        return VLC_ENOMEM;
+    memset( p_list->p_table, 0, TS_PID_COUNT * sizeof(ts_pid_t) );
+
+    /* common ones, never listed */
+    ts_pid_Preset( p_list, 0, FLAGS_NONE );         /* PAT */
+    ts_pid_Preset( p_list, 0x1FFB, FLAGS_NONE );    /* ATSC base SI */
+    ts_pid_Preset( p_list, 0x1FFF, FLAG_SEEN );     /* null packets */
     p_list->pp_all = NULL;
     p_list->i_all = 0;
     p_list->i_all_alloc = 0;
-    p_list->i_last_pid = 0;
-    p_list->p_last = NULL;
+
+    return VLC_SUCCESS;
 }
 
 void ts_pid_list_Release( demux_t *p_demux, ts_pid_list_t *p_list )
 {
+#ifndef NDEBUG
     for( int i = 0; i < p_list->i_all; i++ )
     {
         ts_pid_t *pid = p_list->pp_all[i];
-#ifndef NDEBUG
         if( pid->type != TYPE_FREE )
             msg_Err( p_demux, "PID %d type %d not freed refcount %d", pid->i_pid, pid->type, pid->i_refcount );
-#endif
-        free( pid );
     }
+#else
+    VLC_UNUSED(p_demux);
+#endif
     free( p_list->pp_all );
+    vlc_free( p_list->p_table );
 }
 
-ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
+void ts_pid_List( ts_pid_list_t *p_list, ts_pid_t *p_pid )
 {
-    switch( i_pid )
-    {
-        case 0:
-            return &p_list->pat;
-        case 0x1FFB:
-            return &p_list->base_si;
-        case 0x1FFF:
-            return &p_list->dummy;
-        default:
-            if( p_list->i_last_pid == i_pid )
-                return p_list->p_last;
-        break;
-    }
-
-    for( int i=0; i < p_list->i_all; i++ )
-    {
-        if( p_list->pp_all[i]->i_pid == i_pid )
-        {
-            p_list->p_last = p_list->pp_all[i];
-            p_list->i_last_pid = i_pid;
-            return p_list->p_last;
-        }
-    }
-
     if( p_list->i_all >= p_list->i_all_alloc )
     {
         ts_pid_t **p_realloc = realloc( p_list->pp_all,
@@ -97,20 +89,9 @@ ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
         p_list->i_all_alloc += PID_ALLOC_CHUNK;
     }
 
-    ts_pid_t *p_pid = calloc( 1, sizeof(*p_pid) );
-    if( !p_pid )
-    {
-        abort();
-        //return NULL;
-    }
-
-    p_pid->i_pid = i_pid;
+    p_pid->i_pid = p_pid - p_list->p_table;
+    p_pid->b_listed = true;
     p_list->pp_all[p_list->i_all++] = p_pid;
-
-    p_list->p_last = p_pid;
-    p_list->i_last_pid = i_pid;
-
-    return p_pid;
 }
 
 ts_pid_t * ts_pid_Next( ts_pid_list_t *p_list, ts_pid_next_context_t *p_ctx )
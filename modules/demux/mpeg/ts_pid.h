@@ -48,6 +48,8 @@ enum
 #define SEEN(x) ((x)->i_flags & FLAG_SEEN)
 #define SCRAMBLED(x) ((x).i_flags & FLAG_SCRAMBLED)
 
+/* Per packet state comes first, and the whole record is kept within 32 bytes
+ * so that classifying a packet only touches one cache line of the table */
 struct ts_pid_t
 {
     uint16_t    i_pid;
@@ -55,6 +57,7 @@ struct ts_pid_t
     uint8_t     i_flags;
     uint8_t     i_cc;   /* countinuity counter */
     uint8_t     type;
+    bool        b_listed;
 
     uint16_t    i_refcount;
 
@@ -77,27 +80,32 @@ struct ts_pid_t
 
 };
 
+#define TS_PID_COUNT 8192
+
 struct ts_pid_list_t
 {
-    ts_pid_t   pat;
-    ts_pid_t   dummy;
-    ts_pid_t   base_si;
-    /* all non commons ones, dynamically allocated */
+    /* direct index of all pids, TS_PID_COUNT entries */
+    ts_pid_t  *p_table;
+    /* all non commons ones requested so far */
     ts_pid_t **pp_all;
     int        i_all;
     int        i_all_alloc;
-    /* last recently used */
-    uint16_t   i_last_pid;
-    ts_pid_t  *p_last;
-
 };
 
 /* opacified pid list */
-void ts_pid_list_Init( ts_pid_list_t * );
+int  ts_pid_list_Init( ts_pid_list_t * );
 void ts_pid_list_Release( demux_t *, ts_pid_list_t * );
 
+void ts_pid_List( ts_pid_list_t *, ts_pid_t * );
+
 /* creates missing pid on the fly */
-ts_pid_t * ts_pid_Get( ts_pid_list_t *, uint16_t i_pid );
+static inline ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
+{
+    ts_pid_t *p_pid = &p_list->p_table[i_pid & (TS_PID_COUNT - 1)];
+    if( unlikely(!p_pid->b_listed) )
+        ts_pid_List( p_list, p_pid );
+    return p_pid;
+}
 
 /* returns NULL on end. requires context */
 typedef struct
@@ -133,6 +133,9 @@ ts_pmt_t *ts_pmt_New( demux_t *p_demux )
 
     pmt->pcr.b_fix_done = false;
 
+    ARRAY_INIT( pmt->pcr_index.entries );
+    pmt->pcr_index.b_broken = false;
+
     pmt->eit.i_event_length = 0;
     pmt->eit.i_event_start = 0;
 
@@ -156,6 +159,7 @@ void ts_pmt_Del( demux_t *p_demux, ts_pmt_t *pmt )
     for( int i=0; i<pmt->od.objects.i_size; i++ )
         ODFree( pmt->od.objects.p_elems[i] );
     ARRAY_RESET( pmt->od.objects );
+    ARRAY_RESET( pmt->pcr_index.entries );
     if( pmt->i_number > -1 )
         es_out_Control( p_demux->out, ES_OUT_DEL_GROUP, pmt->i_number );
     free( pmt );
@@ -36,6 +36,12 @@ struct ts_pat_t
 
 };
 
+typedef struct
+{
+    uint64_t i_pos;
+    mtime_t  i_pcr;
+} ts_pcr_index_entry_t;
+
 struct ts_pmt_t
 {
     dvbpsi_t       *handle;
@@ -65,6 +71,13 @@ struct ts_pmt_t
         bool    b_fix_done;
     } pcr;
 
+    /* Sparse PCR index, sorted by position, for time based seeking */
+    struct
+    {
+        DECL_ARRAY(ts_pcr_index_entry_t) entries;
+        bool    b_broken; /* PCR going backwards: cannot bisect */
+    } pcr_index;
+
     struct
     {
         time_t i_event_start;
@@ -286,6 +286,7 @@ static int Demux( demux_t * p_demux )
     int         i_stream;
     bool b_skipping = false;
     bool b_canseek;
+    int64_t i_page_end = -1;
 
     int i_active_streams = p_sys->i_streams;
     for ( int i=0; i < p_sys->i_streams; i++ )
@@ -353,6 +354,9 @@ static int Demux( demux_t * p_demux )
          */
         if( Ogg_ReadPage( p_demux, &p_sys->current_page ) != VLC_SUCCESS )
             return VLC_DEMUXER_EOF; /* EOF */
+        /* the sync layer may still hold data read past that page */
+        i_page_end = vlc_stream_Tell( p_demux->s ) -
+                     ( p_sys->oy.fill - p_sys->oy.returned );
         /* Test for End of Stream */
         if( ogg_page_eos( &p_sys->current_page ) )
         {
@@ -410,6 +414,21 @@ static int Demux( demux_t * p_demux )
             {
                 continue;
             }
+
+            /* Streams without keyframes can restart decoding right after
+             * any page: remember some of those positions for seeking */
+            int64_t i_granule = ogg_page_granulepos( &p_sys->current_page );
+            if( i_granule > 0 && p_stream->p_es &&
+                Ogg_GetKeyframeGranule( p_stream, i_granule ) == i_granule )
+            {
+                int64_t i_time = Oggseek_GranuleToAbsTimestamp( p_stream,
+                                                        i_granule, false );
+                if( i_time >= p_stream->i_idx_next )
+                {
+                    OggSeek_IndexUpdate( p_stream, i_time, i_page_end );
+                    p_stream->i_idx_next = i_time + OGGSEEK_INDEX_INTERVAL;
+                }
+            }
         }
 
         /* clear the finished flag if pages after eos (ex: after a seek) */
@@ -692,6 +711,7 @@ static void Ogg_ResetStream( logical_stream_t *p_stream )
     p_stream->i_pcr = VLC_TS_UNKNOWN;
     p_stream->i_previous_granulepos = -1;
     p_stream->i_previous_pcr = VLC_TS_UNKNOWN;
+    p_stream->i_idx_next = 0;
     ogg_stream_reset( &p_stream->os );
     FREENULL( p_stream->prepcr.pp_blocks );
     p_stream->prepcr.i_size = 0;
@@ -101,6 +101,8 @@ typedef struct logical_stream_s
 
     /* keyframe index for seeking, created as we discover keyframes */
     demux_index_entry_t *idx;
+    /* stream time from which pages are indexed again during playback */
+    int64_t i_idx_next;
 
     /* Skeleton data */
     ogg_skeleton_t *p_skel;
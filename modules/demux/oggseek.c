@@ -151,6 +151,30 @@ const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
     return idx;
 }
 
+/* Records a page boundary met during playback, from which decoding of
+   a stream without keyframes restarts at i_timestamp. The index is kept
+   sparse: nothing is added near an existing entry. */
+void OggSeek_IndexUpdate ( logical_stream_t *p_stream, int64_t i_timestamp,
+                           int64_t i_pagepos )
+{
+    const demux_index_entry_t *idx = p_stream->idx;
+    const demux_index_entry_t *last_idx = NULL;
+
+    while ( idx != NULL && idx->i_pagepos <= i_pagepos )
+    {
+        last_idx = idx;
+        idx = idx->p_next;
+    }
+
+    if ( last_idx != NULL &&
+         i_timestamp - last_idx->i_value < OGGSEEK_INDEX_INTERVAL )
+        return;
+    if ( idx != NULL && idx->i_value - i_timestamp < OGGSEEK_INDEX_INTERVAL )
+        return;
+
+    OggSeek_IndexAdd( p_stream, i_timestamp, i_pagepos );
+}
+
 static bool OggSeekIndexFind ( logical_stream_t *p_stream, int64_t i_timestamp,
                                int64_t *pi_pos_lower, int64_t *pi_pos_upper )
 {
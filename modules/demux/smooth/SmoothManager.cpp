@@ -44,6 +44,7 @@ SmoothManager::SmoothManager(demux_t *demux_, Manifest *playlist,
                        AbstractAdaptationLogic::LogicType type) :
              PlaylistManager(demux_, playlist, factory, type)
 {
+    lastManifestFetch = VLC_TS_INVALID;
 }
 
 SmoothManager::~SmoothManager()
@@ -138,8 +139,11 @@ bool SmoothManager::updatePlaylist(bool forcemanifest)
     /* Timelines updates should be inlined in tfrf atoms.
        We'll just care about pruning live timeline then. */
 
-    if(forcemanifest && nextPlaylistupdate)
+    /* Every reactivated stream asks for it: fetch once for all of them */
+    if(forcemanifest && nextPlaylistupdate &&
+       (lastManifestFetch == VLC_TS_INVALID || mdate() - lastManifestFetch >= CLOCK_FREQ))
     {
+        lastManifestFetch = mdate();
         Manifest *newManifest = fetchManifest();
         if(newManifest)
         {
@@ -57,6 +57,7 @@ namespace smooth
         private:
             bool updatePlaylist(bool);
             playlist::Manifest * fetchManifest();
+            mtime_t lastManifestFetch;
     };
 
 }
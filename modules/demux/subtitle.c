@@ -134,6 +134,8 @@ typedef struct
 {
     int64_t i_start;
     int64_t i_stop;
+    /* highest valid i_stop up to this entry, for seeking */
+    int64_t i_stop_max;
 
     char    *psz_text;
 } subtitle_t;
@@ -152,6 +154,7 @@ struct demux_sys_t
     int         i_subtitle;
     int         i_subtitles;
     subtitle_t  *subtitle;
+    bool        b_sorted;
 
     int64_t     i_length;
 
@@ -229,6 +232,7 @@ static int Demux( demux_t * );
 static int Control( demux_t *, int, va_list );
 
 static void Fix( demux_t * );
+static void Index( demux_t * );
 static char * get_language_from_filename( const char * );
 
 /*****************************************************************************
@@ -520,7 +524,7 @@ static int Open ( vlc_object_t *p_this )
     {
         if( p_sys->i_subtitles >= i_max )
         {
-            i_max += 500;
+            i_max = __MAX( 2 * i_max, 500 );
             if( !( p_sys->subtitle = realloc_or_free( p_sys->subtitle,
                                               sizeof(subtitle_t) * i_max ) ) )
             {
@@ -563,6 +567,8 @@ static int Open ( vlc_object_t *p_this )
     else
         es_format_Init( &fmt, SPU_ES, VLC_CODEC_SUBT );
 
+    Index( p_demux );
+
     /* Stupid language detection in the filename */
     char * psz_language = get_language_from_filename( p_demux->psz_file );
 
@@ -608,6 +614,30 @@ static void Close( vlc_object_t *p_this )
     free( p_sys );
 }
 
+/*****************************************************************************
+ * Lookup: binary search in the sorted subtitles
+ *****************************************************************************
+ * Returns the index of the first subtitle starting after i_time, or, if
+ * b_stop is set, of the first one still shown after i_time.
+ *****************************************************************************/
+static int Lookup( demux_sys_t *p_sys, int64_t i_time, bool b_stop )
+{
+    int i_min = 0;
+    int i_max = p_sys->i_subtitles;
+
+    while( i_min < i_max )
+    {
+        int i_mid = i_min + ( i_max - i_min ) / 2;
+        const subtitle_t *p_subtitle = &p_sys->subtitle[i_mid];
+
+        if( ( b_stop ? p_subtitle->i_stop_max : p_subtitle->i_start ) > i_time )
+            i_max = i_mid;
+        else
+            i_min = i_mid + 1;
+    }
+    return i_min;
+}
+
 /*****************************************************************************
  * Control:
  *****************************************************************************/
@@ -639,17 +669,27 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         case DEMUX_SET_TIME:
             i64 = (int64_t)va_arg( args, int64_t );
-            p_sys->i_subtitle = 0;
-            while( p_sys->i_subtitle < p_sys->i_subtitles )
+            if( p_sys->b_sorted )
+            {
+                /* first subtitle starting after, or still shown at, i64 */
+                int i_after = Lookup( p_sys, i64, false );
+                int i_shown = Lookup( p_sys, i64, true );
+                p_sys->i_subtitle = __MIN( i_after, i_shown );
+            }
+            else
             {
-                const subtitle_t *p_subtitle = &p_sys->subtitle[p_sys->i_subtitle];
+                p_sys->i_subtitle = 0;
+                while( p_sys->i_subtitle < p_sys->i_subtitles )
+                {
+                    const subtitle_t *p_subtitle = &p_sys->subtitle[p_sys->i_subtitle];
 
-                if( p_subtitle->i_start > i64 )
-                    break;
-                if( p_subtitle->i_stop > p_subtitle->i_start && p_subtitle->i_stop > i64 )
-                    break;
+                    if( p_subtitle->i_start > i64 )
+                        break;
+                    if( p_subtitle->i_stop > p_subtitle->i_start && p_subtitle->i_stop > i64 )
+                        break;
 
-                p_sys->i_subtitle++;
+                    p_sys->i_subtitle++;
+                }
             }
 
             if( p_sys->i_subtitle >= p_sys->i_subtitles )
@@ -677,11 +717,16 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             f = (double)va_arg( args, double );
             i64 = f * p_sys->i_length;
 
-            p_sys->i_subtitle = 0;
-            while( p_sys->i_subtitle < p_sys->i_subtitles &&
-                   p_sys->subtitle[p_sys->i_subtitle].i_start < i64 )
+            if( p_sys->b_sorted )
+                p_sys->i_subtitle = Lookup( p_sys, i64 - 1, false );
+            else
             {
-                p_sys->i_subtitle++;
+                p_sys->i_subtitle = 0;
+                while( p_sys->i_subtitle < p_sys->i_subtitles &&
+                       p_sys->subtitle[p_sys->i_subtitle].i_start < i64 )
+                {
+                    p_sys->i_subtitle++;
+                }
             }
             if( p_sys->i_subtitle >= p_sys->i_subtitles )
                 return VLC_EGENERIC;
@@ -781,6 +826,27 @@ static void Fix( demux_t *p_demux )
     qsort( p_sys->subtitle, p_sys->i_subtitles, sizeof( p_sys->subtitle[0] ), subtitle_cmp);
 }
 
+/*****************************************************************************
+ * Index: prepare the subtitles for binary search on seek
+ *****************************************************************************/
+static void Index( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    int64_t i_stop_max = INT64_MIN;
+
+    p_sys->b_sorted = true;
+    for( int i = 0; i < p_sys->i_subtitles; i++ )
+    {
+        subtitle_t *p_subtitle = &p_sys->subtitle[i];
+
+        if( i > 0 && p_subtitle->i_start < p_subtitle[-1].i_start )
+            p_sys->b_sorted = false;
+        if( p_subtitle->i_stop > p_subtitle->i_start )
+            i_stop_max = __MAX( i_stop_max, p_subtitle->i_stop );
+        p_subtitle->i_stop_max = i_stop_max;
+    }
+}
+
 static int TextLoad( text_t *txt, stream_t *s )
 {
     int   i_line_max;
@@ -804,7 +870,7 @@ static int TextLoad( text_t *txt, stream_t *s )
         txt->line[txt->i_line_count++] = psz;
         if( txt->i_line_count >= i_line_max )
         {
-            i_line_max += 100;
+            i_line_max *= 2;
             txt->line = realloc_or_free( txt->line, i_line_max * sizeof( char * ) );
             if( !txt->line )
                 return VLC_ENOMEM;
@@ -584,6 +584,8 @@ InputStatsPanel::InputStatsPanel( QWidget *parent ): QWidget( parent )
                            "0", input, "" );
     CREATE_AND_ADD_TO_CAT( discontinuity_stat, qtr("Dropped (discontinued)"),
                            "0", input, "" );
+    CREATE_AND_ADD_TO_CAT( input_cpu_stat, qtr("CPU time"),
+                           "0", input, "ms" );
 
     CREATE_AND_ADD_TO_CAT( vdecoded_stat, qtr("Decoded"),
                            "0", video, qtr("blocks") );
@@ -591,6 +593,8 @@ InputStatsPanel::InputStatsPanel( QWidget *parent ): QWidget( parent )
                            "0", video, qtr("frames") );
     CREATE_AND_ADD_TO_CAT( vlost_frames_stat, qtr("Lost"),
                            "0", video, qtr("frames") );
+    CREATE_AND_ADD_TO_CAT( vcpu_stat, qtr("Decoder CPU time"),
+                           "0", video, "ms" );
 
     CREATE_AND_ADD_TO_CAT( send_stat, qtr("Sent"), "0", streaming, qtr("packets") );
     CREATE_AND_ADD_TO_CAT( send_bytes_stat, qtr("Sent"),
@@ -603,6 +607,8 @@ InputStatsPanel::InputStatsPanel( QWidget *parent ): QWidget( parent )
     CREATE_AND_ADD_TO_CAT( aplayed_stat, qtr("Played"),
                            "0", audio, qtr("buffers") );
     CREATE_AND_ADD_TO_CAT( alost_stat, qtr("Lost"), "0", audio, qtr("buffers") );
+    CREATE_AND_ADD_TO_CAT( acpu_stat, qtr("Decoder CPU time"),
+                           "0", audio, "ms" );
 
 #undef CREATE_AND_ADD_TO_CAT
 #undef CREATE_CATEGORY
@@ -657,6 +663,7 @@ void InputStatsPanel::update( input_item_t *p_item )
     UPDATE_FLOAT( stream_bitrate_stat, "%6.0f", (float)(p_item->p_stats->f_demux_bitrate *  8000 ));
     UPDATE_INT( corrupted_stat,      p_item->p_stats->i_demux_corrupted );
     UPDATE_INT( discontinuity_stat,  p_item->p_stats->i_demux_discontinuity );
+    UPDATE_INT( input_cpu_stat,      p_item->p_stats->i_input_cpu_time / 1000 );
 
     statsView->addValue( p_item->p_stats->f_input_bitrate * 8000 );
 
@@ -664,6 +671,7 @@ void InputStatsPanel::update( input_item_t *p_item )
     UPDATE_INT( vdecoded_stat,     p_item->p_stats->i_decoded_video );
     UPDATE_INT( vdisplayed_stat,   p_item->p_stats->i_displayed_pictures );
     UPDATE_INT( vlost_frames_stat, p_item->p_stats->i_lost_pictures );
+    UPDATE_INT( vcpu_stat,         p_item->p_stats->i_video_decoder_cpu_time / 1000 );
 
     /* Sout */
     UPDATE_INT( send_stat,        p_item->p_stats->i_sent_packets );
@@ -674,6 +682,7 @@ void InputStatsPanel::update( input_item_t *p_item )
     UPDATE_INT( adecoded_stat, p_item->p_stats->i_decoded_audio );
     UPDATE_INT( aplayed_stat,  p_item->p_stats->i_played_abuffers );
     UPDATE_INT( alost_stat,    p_item->p_stats->i_lost_abuffers );
+    UPDATE_INT( acpu_stat,     p_item->p_stats->i_audio_decoder_cpu_time / 1000 );
 
 #undef UPDATE_INT
 #undef UPDATE_FLOAT
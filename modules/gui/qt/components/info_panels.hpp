@@ -126,12 +126,14 @@ private:
     QTreeWidgetItem *stream_bitrate_stat;
     QTreeWidgetItem *corrupted_stat;
     QTreeWidgetItem *discontinuity_stat;
+    QTreeWidgetItem *input_cpu_stat;
 
     QTreeWidgetItem *video;
     QTreeWidgetItem *vdecoded_stat;
     QTreeWidgetItem *vdisplayed_stat;
     QTreeWidgetItem *vlost_frames_stat;
     QTreeWidgetItem *vfps_stat;
+    QTreeWidgetItem *vcpu_stat;
 
     QTreeWidgetItem *streaming;
     QTreeWidgetItem *send_stat;
@@ -142,6 +144,7 @@ private:
     QTreeWidgetItem *adecoded_stat;
     QTreeWidgetItem *aplayed_stat;
     QTreeWidgetItem *alost_stat;
+    QTreeWidgetItem *acpu_stat;
 
     VLCStatsView *statsView;
 public slots:
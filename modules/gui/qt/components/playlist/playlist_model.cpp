@@ -41,6 +41,10 @@
 #include <assert.h>
 #include <QFont>
 #include <QAction>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+#include <QtAlgorithms>
 
 /*************************************************************************
  * Playlist model implementation
@@ -57,6 +61,12 @@ PLModel::PLModel( playlist_t *_p_playlist,  /* THEPL */
     rootItem          = NULL; /* PLItem rootItem, will be set in rebuild( ) */
     latestSearch      = QString();
 
+    /* Coalesce bursts of appended items (e.g. large playlist loads) */
+    appendTimer = new QTimer( this );
+    appendTimer->setSingleShot( true );
+    appendTimer->setInterval( 50 );
+    CONNECT( appendTimer, timeout(), this, processPendingAppends() );
+
     rebuild( p_root );
     DCONNECT( THEMIM->getIM(), metaChanged( input_item_t *),
               this, processInputItemUpdate( input_item_t *) );
@@ -599,50 +609,111 @@ void PLModel::processInputItemUpdate( input_item_t *p_item )
 void PLModel::processItemRemoval( int i_pl_itemid )
 {
     if( i_pl_itemid <= 0 ) return;
+    /* Keep the events ordered */
+    processPendingAppends();
     removeItem( findByPLId( rootItem, i_pl_itemid ) );
 }
 
 void PLModel::processItemAppend( int i_pl_itemid, int i_pl_itemidparent )
 {
-    playlist_item_t *p_item = NULL;
-    PLItem *newItem = NULL;
-    int pos;
+    pendingAppends.append( qMakePair( i_pl_itemid, i_pl_itemidparent ) );
+    if( !appendTimer->isActive() )
+        appendTimer->start();
+}
 
-    /* Find the Parent */
-    PLItem *nodeParentItem = findByPLId( rootItem, i_pl_itemidparent );
-    if( !nodeParentItem ) return;
+static bool appendPositionLessThan( const QPair<int, PLItem *> &a,
+                                    const QPair<int, PLItem *> &b )
+{
+    return a.first < b.first;
+}
 
-    /* Search for an already matching children */
-    foreach( AbstractPLItem *existing, nodeParentItem->children )
-        if( existing->id( PLAYLIST_ID ) == i_pl_itemid ) return;
+void PLModel::processPendingAppends()
+{
+    appendTimer->stop();
+    if( pendingAppends.isEmpty() ) return;
+
+    QList<QPair<int, int> > appends = pendingAppends;
+    pendingAppends.clear();
+
+    /* Group the new items by parent node, keeping the order in which the
+     * parents showed up, so that new nodes get inserted before their
+     * children */
+    QHash<int, QList<int> > byParent;
+    QList<int> parents;
+    for( int i = 0; i < appends.count(); i++ )
+    {
+        if( !byParent.contains( appends[i].second ) )
+            parents.append( appends[i].second );
+        byParent[appends[i].second].append( appends[i].first );
+    }
 
-    /* Find the child */
+    bool b_inserted = false;
+    foreach( int i_pl_parentid, parents )
     {
-        vlc_playlist_locker pl_lock ( THEPL );
+        /* Find the Parent */
+        PLItem *nodeParentItem = findByPLId( rootItem, i_pl_parentid );
+        if( !nodeParentItem ) continue;
+
+        /* (position, item) of the new children */
+        QList<QPair<int, PLItem *> > newItems;
+        QSet<int> knownIds;
+        foreach( AbstractPLItem *existing, nodeParentItem->children )
+            knownIds.insert( existing->id( PLAYLIST_ID ) );
+        {
+            vlc_playlist_locker pl_lock ( THEPL );
 
-        p_item = playlist_ItemGetById( p_playlist, i_pl_itemid );
-        if( !p_item || p_item->i_flags & PLAYLIST_DBL_FLAG )
-            return;
+            foreach( int i_pl_itemid, byParent.value( i_pl_parentid ) )
+            {
+                /* Skip already matching children */
+                if( knownIds.contains( i_pl_itemid ) ) continue;
+                knownIds.insert( i_pl_itemid );
 
-        for( pos = p_item->p_parent->i_children - 1; pos >= 0; pos-- )
-            if( p_item->p_parent->pp_children[pos] == p_item ) break;
+                /* Find the child */
+                playlist_item_t *p_item = playlist_ItemGetById( p_playlist, i_pl_itemid );
+                if( !p_item || p_item->i_flags & PLAYLIST_DBL_FLAG )
+                    continue;
 
-        newItem = new PLItem( p_item, nodeParentItem );
-    }
+                int pos;
+                for( pos = p_item->p_parent->i_children - 1; pos >= 0; pos-- )
+                    if( p_item->p_parent->pp_children[pos] == p_item ) break;
 
-    /* We insert the newItem (children) inside the parent */
-    beginInsertRows( index( nodeParentItem, 0 ), pos, pos );
-    nodeParentItem->insertChild( newItem, pos );
-    endInsertRows();
-    if ( newItem->inputItem() == THEMIM->currentInputItem() )
-        emit currentIndexChanged( index( newItem, 0 ) );
+                newItems.append( qMakePair( pos, new PLItem( p_item, nodeParentItem ) ) );
+            }
+        }
+        if( newItems.isEmpty() ) continue;
 
-    if( latestSearch.isEmpty() ) return;
+        /* Insert in increasing position order, one range per run of
+         * consecutive positions */
+        qStableSort( newItems.begin(), newItems.end(), appendPositionLessThan );
+        for( int i = 0; i < newItems.count(); )
+        {
+            int pos = qBound( 0, newItems[i].first, nodeParentItem->childCount() );
+            QList<PLItem *> run;
+            run.append( newItems[i].second );
+            for( i++; i < newItems.count()
+                      && newItems[i].first == newItems[i - 1].first + 1; i++ )
+                run.append( newItems[i].second );
+
+            insertChildren( nodeParentItem, run, pos );
+        }
+        b_inserted = true;
+
+        input_item_t *p_current = THEMIM->currentInputItem();
+        for( int i = 0; i < newItems.count(); i++ )
+            if ( newItems[i].second->inputItem() == p_current )
+                emit currentIndexChanged( index( newItems[i].second, 0 ) );
+    }
+
+    if( !b_inserted || latestSearch.isEmpty() ) return;
     filter( latestSearch, index( rootItem, 0), false /*FIXME*/ );
 }
 
 void PLModel::rebuild( playlist_item_t *p_root )
 {
+    /* The rebuilt tree already holds the pending items */
+    appendTimer->stop();
+    pendingAppends.clear();
+
     beginResetModel();
 
     {
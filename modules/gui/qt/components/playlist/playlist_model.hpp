@@ -42,7 +42,10 @@
 #include <QVariant>
 #include <QModelIndex>
 #include <QAction>
+#include <QList>
+#include <QPair>
 
+class QTimer;
 class PLItem;
 class PlMimeData;
 
@@ -156,11 +159,17 @@ private:
     QString latestSearch;
     QFont   customFont;
 
+    /* Appended items waiting to be inserted in one batch:
+     * (playlist item id, parent playlist item id) */
+    QList<QPair<int, int> > pendingAppends;
+    QTimer *appendTimer;
+
 private slots:
     void processInputItemUpdate( input_item_t *);
     void processInputItemUpdate();
     void processItemRemoval( int i_pl_itemid );
     void processItemAppend( int i_pl_itemid, int i_pl_itemidparent );
+    void processPendingAppends();
     void activateItem( playlist_item_t *p_item );
     virtual void activateItem( const QModelIndex &index ) Q_DECL_OVERRIDE;
 };
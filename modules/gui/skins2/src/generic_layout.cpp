@@ -26,6 +26,7 @@
 #include "top_window.hpp"
 #include "os_factory.hpp"
 #include "os_graphics.hpp"
+#include "os_timer.hpp"
 #include "var_manager.hpp"
 #include "anchor.hpp"
 #include "../controls/ctrl_generic.hpp"
@@ -33,6 +34,12 @@
 #include "../utils/var_bool.hpp"
 #include <set>
 
+/// Delay between two redraws of the controls updates, in ms
+#define LAYOUT_REFRESH_DELAY 20
+
+/// Maximum number of disjoint dirty areas before they are merged together
+#define LAYOUT_MAX_DIRTY_RECTS 8
+
 
 GenericLayout::GenericLayout( intf_thread_t *pIntf, int width, int height,
                               int minWidth, int maxWidth, int minHeight,
@@ -42,12 +49,14 @@ GenericLayout::GenericLayout( intf_thread_t *pIntf, int width, int height,
     m_rect( 0, 0, width, height ),
     m_minWidth( minWidth ), m_maxWidth( maxWidth ),
     m_minHeight( minHeight ), m_maxHeight( maxHeight ), m_pVideoCtrlSet(),
-    m_visible( false ), m_pVarActive( NULL )
+    m_visible( false ), m_pVarActive( NULL ), m_cmdRefresh( this )
 {
     // Get the OSFactory
     OSFactory *pOsFactory = OSFactory::instance( getIntf() );
     // Create the graphics buffer
     m_pImage = pOsFactory->createOSGraphics( width, height );
+    // Create the timer coalescing the controls updates
+    m_pRefreshTimer = pOsFactory->createOSTimer( m_cmdRefresh );
 
     // Create the "active layout" variable and register it in the manager
     m_pVarActive = new VarBoolImpl( pIntf );
@@ -57,6 +66,7 @@ GenericLayout::GenericLayout( intf_thread_t *pIntf, int width, int height,
 
 GenericLayout::~GenericLayout()
 {
+    delete m_pRefreshTimer;
     delete m_pImage;
 
     std::list<Anchor*>::const_iterator it;
@@ -166,12 +176,65 @@ void GenericLayout::onControlUpdate( const CtrlGeneric &rCtrl,
         rect inter;
         if( rect::intersect( layout, region, &inter ) )
         {
-            refreshRect( inter.x, inter.y, inter.width, inter.height );
+            // Defer the redraw, so that a burst of updates (e.g. several
+            // variables changing at once) is drawn only once
+            if( m_dirtyRects.empty() )
+                m_pRefreshTimer->start( LAYOUT_REFRESH_DELAY, true );
+            addDirtyRect( inter );
         }
     }
 }
 
 
+void GenericLayout::addDirtyRect( const rect &rRect )
+{
+    rect area = rRect;
+
+    // Absorb all the dirty areas overlapping the new one
+    std::list<rect>::iterator it = m_dirtyRects.begin();
+    while( it != m_dirtyRects.end() )
+    {
+        if( rect::areDisjunct( *it, area ) )
+        {
+            ++it;
+            continue;
+        }
+        rect::join( *it, area, &area );
+        m_dirtyRects.erase( it );
+        it = m_dirtyRects.begin();
+    }
+    m_dirtyRects.push_back( area );
+
+    if( m_dirtyRects.size() > LAYOUT_MAX_DIRTY_RECTS )
+    {
+        area = m_dirtyRects.front();
+        for( it = m_dirtyRects.begin(); it != m_dirtyRects.end(); ++it )
+            rect::join( *it, area, &area );
+        m_dirtyRects.clear();
+        m_dirtyRects.push_back( area );
+    }
+}
+
+
+void GenericLayout::CmdRefresh::execute()
+{
+    std::list<rect> dirtyRects;
+    dirtyRects.swap( m_pParent->m_dirtyRects );
+
+    // The layout may have been resized in between
+    rect layout( 0, 0, m_pParent->m_rect.getWidth(),
+                 m_pParent->m_rect.getHeight() );
+    std::list<rect>::const_iterator it;
+    for( it = dirtyRects.begin(); it != dirtyRects.end(); ++it )
+    {
+        rect inter;
+        if( rect::intersect( layout, *it, &inter ) )
+            m_pParent->refreshRect( inter.x, inter.y,
+                                    inter.width, inter.height );
+    }
+}
+
+
 void GenericLayout::resize( int width, int height )
 {
     // check real resize
@@ -200,6 +263,10 @@ void GenericLayout::resize( int width, int height )
 
 void GenericLayout::refreshAll()
 {
+    // Pending updates are covered by the full redraw
+    m_pRefreshTimer->stop();
+    m_dirtyRects.clear();
+
     refreshRect( 0, 0, m_rect.getWidth(), m_rect.getHeight() );
 }
 
@@ -258,6 +325,10 @@ void GenericLayout::onShow()
 void GenericLayout::onHide()
 {
     m_visible = false;
+
+    // Everything gets redrawn when shown again
+    m_pRefreshTimer->stop();
+    m_dirtyRects.clear();
 }
 
 
@@ -27,6 +27,7 @@
 
 #include "skin_common.hpp"
 #include "top_window.hpp"
+#include "../commands/cmd_generic.hpp"
 #include "../utils/pointer.hpp"
 #include "../utils/position.hpp"
 
@@ -34,6 +35,7 @@
 
 class Anchor;
 class OSGraphics;
+class OSTimer;
 class CtrlGeneric;
 class CtrlVideo;
 class VarBoolImpl;
@@ -177,6 +179,16 @@ private:
      * layout). This way, we avoid using a setActiveLayoutInner method.
      */
     mutable VarBoolImpl *m_pVarActive;
+    /// Areas updated by the controls and not redrawn yet
+    std::list<rect> m_dirtyRects;
+    /// Timer to redraw the dirty areas at most once per frame
+    OSTimer *m_pRefreshTimer;
+
+    /// Add an area to the dirty ones, merging it with any overlapping area
+    void addDirtyRect( const rect &rRect );
+
+    /// Callback to redraw the dirty areas
+    DEFINE_CALLBACK( GenericLayout, Refresh );
 };
 
 
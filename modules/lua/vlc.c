@@ -833,17 +833,139 @@ int vlclua_add_modules_path( lua_State *L, const char *psz_filename )
     return 0;
 }
 
+/*****************************************************************************
+ * Compiled chunks of local scripts
+ *
+ * Every probe (playlist, meta, art...) loads each candidate script in a
+ * fresh state. Keep the compiled chunk in memory, so that it is neither
+ * read from disk nor compiled again while the file is left unchanged.
+ *****************************************************************************/
+#define VLCLUA_CHUNK_CACHE_SIZE 64
+
+struct vlclua_chunk
+{
+    char   *psz_path;
+    time_t  i_mtime;
+    off_t   i_size;
+    char   *p_code;
+    size_t  i_code;
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    struct vlclua_chunk entries[VLCLUA_CHUNK_CACHE_SIZE];
+    unsigned next; /* entry replaced by the next insertion */
+} chunk_cache = { .lock = VLC_STATIC_MUTEX };
+
+static int vlclua_chunk_writer( lua_State *L, const void *p, size_t sz,
+                                void *ud )
+{
+    struct vlclua_chunk *chunk = ud;
+    VLC_UNUSED( L );
+
+    char *p_code = realloc( chunk->p_code, chunk->i_code + sz );
+    if( unlikely(p_code == NULL) )
+        return 1;
+    memcpy( p_code + chunk->i_code, p, sz );
+    chunk->p_code = p_code;
+    chunk->i_code += sz;
+    return 0;
+}
+
+static void vlclua_chunk_store( lua_State *L, const char *psz_path,
+                                const struct stat *st )
+{
+    struct vlclua_chunk chunk = {
+        .psz_path = strdup( psz_path ),
+        .i_mtime = st->st_mtime,
+        .i_size = st->st_size,
+    };
+
+    if( unlikely(chunk.psz_path == NULL) )
+        return;
+#if LUA_VERSION_NUM >= 503
+    if( lua_dump( L, vlclua_chunk_writer, &chunk, 0 ) )
+#else
+    if( lua_dump( L, vlclua_chunk_writer, &chunk ) )
+#endif
+    {
+        free( chunk.p_code );
+        free( chunk.psz_path );
+        return;
+    }
+
+    vlc_mutex_lock( &chunk_cache.lock );
+    struct vlclua_chunk *e = NULL;
+    for( unsigned i = 0; i < VLCLUA_CHUNK_CACHE_SIZE && e == NULL; i++ )
+        if( chunk_cache.entries[i].psz_path != NULL
+         && !strcmp( chunk_cache.entries[i].psz_path, psz_path ) )
+            e = &chunk_cache.entries[i];
+    if( e == NULL )
+    {
+        e = &chunk_cache.entries[chunk_cache.next];
+        chunk_cache.next = (chunk_cache.next + 1) % VLCLUA_CHUNK_CACHE_SIZE;
+    }
+    free( e->psz_path );
+    free( e->p_code );
+    *e = chunk;
+    vlc_mutex_unlock( &chunk_cache.lock );
+}
+
+/** Replacement for luaL_loadfile, using the compiled chunk cache
+ * \param psz_path path of the file (UTF-8)
+ * \param psz_locale same path in the locale encoding */
+static int vlclua_loadfile( lua_State *L, const char *psz_path,
+                            const char *psz_locale )
+{
+    struct stat st;
+
+    if( vlc_stat( psz_path, &st ) )
+        return luaL_loadfile( L, psz_locale );
+
+    char *psz_name;
+    if( asprintf( &psz_name, "@%s", psz_locale ) == -1 )
+        return luaL_loadfile( L, psz_locale );
+
+    int i_ret = -1;
+
+    vlc_mutex_lock( &chunk_cache.lock );
+    for( unsigned i = 0; i < VLCLUA_CHUNK_CACHE_SIZE; i++ )
+    {
+        const struct vlclua_chunk *e = &chunk_cache.entries[i];
+
+        if( e->psz_path != NULL && !strcmp( e->psz_path, psz_path )
+         && e->i_mtime == st.st_mtime && e->i_size == st.st_size )
+        {
+            i_ret = luaL_loadbuffer( L, e->p_code, e->i_code, psz_name );
+            break;
+        }
+    }
+    vlc_mutex_unlock( &chunk_cache.lock );
+    free( psz_name );
+
+    if( i_ret == -1 )
+    {
+        i_ret = luaL_loadfile( L, psz_locale );
+        if( !i_ret )
+            vlclua_chunk_store( L, psz_path, &st );
+    }
+    return i_ret;
+}
+
 /** Replacement for luaL_dofile, using VLC's input capabilities */
 int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *curi )
 {
     char *uri = ToLocaleDup( curi );
     if( !strstr( uri, "://" ) ) {
-        int ret = luaL_dofile( L, uri );
+        int ret = vlclua_loadfile( L, curi, uri )
+               || lua_pcall( L, 0, LUA_MULTRET, 0 );
         free( uri );
         return ret;
     }
     if( !strncasecmp( uri, "file://", 7 ) ) {
-        int ret = luaL_dofile( L, uri + 7 );
+        int ret = vlclua_loadfile( L, curi + 7, uri + 7 )
+               || lua_pcall( L, 0, LUA_MULTRET, 0 );
         free( uri );
         return ret;
     }
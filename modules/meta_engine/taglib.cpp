@@ -876,6 +876,12 @@ static int ReadMeta( vlc_object_t* p_this)
     if( !f.tag() || f.tag()->isEmpty() )
         return VLC_EGENERIC;
 
+    /* The duration is known without a demuxer when preparsing tags only */
+    if( f.audioProperties() && f.audioProperties()->length() > 0
+     && input_item_GetDuration( p_demux_meta->p_item ) <= 0 )
+        input_item_SetDuration( p_demux_meta->p_item,
+                                f.audioProperties()->length() * CLOCK_FREQ );
+
     p_demux_meta->p_meta = p_meta = vlc_meta_New();
     if( !p_meta )
         return VLC_ENOMEM;
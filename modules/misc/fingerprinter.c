@@ -157,10 +157,13 @@ static void DoFingerprint( fingerprinter_thread_t *p_fingerprinter,
          return;
 
     char *psz_sout_option;
-    /* Note: need at -max- 2 channels, but we can't guess it before playing */
-    /* the stereo upmix could make the mono tracks fingerprint to differ :/ */
+    /* Chromaprint works on 11025 Hz mono internally: let the transcoder
+     * downmix and resample once instead of feeding it full rate stereo.
+     * This also makes mono and stereo versions of a track fingerprint
+     * the same way. */
     if ( asprintf( &psz_sout_option,
-                   "sout=#transcode{acodec=%s,channels=2}:chromaprint",
+                   "sout=#transcode{acodec=%s,channels=1,samplerate=11025}"
+                   ":chromaprint",
                    ( VLC_CODEC_S16L == VLC_CODEC_S16N ) ? "s16l" : "s16b" )
          == -1 )
     {
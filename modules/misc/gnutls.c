@@ -388,6 +388,83 @@ done:
     return 0;
 }
 
+/*
+ * Client sessions are kept per server host name, so that the next
+ * connections to the same server resume the session with an abbreviated
+ * handshake instead of a full key exchange.
+ */
+#define SESSION_CACHE_MAX 16
+
+static vlc_mutex_t session_lock = VLC_STATIC_MUTEX;
+static struct
+{
+    char *host;
+    gnutls_datum_t data;
+} session_cache[SESSION_CACHE_MAX];
+static unsigned session_count = 0;
+static unsigned session_users = 0; /**< number of client credentials */
+
+static void gnutls_SessionCacheErase(unsigned i)
+{
+    free(session_cache[i].host);
+    gnutls_free(session_cache[i].data.data);
+    memmove(session_cache + i, session_cache + i + 1,
+            (--session_count - i) * sizeof (session_cache[0]));
+}
+
+static void gnutls_SessionLoad(vlc_tls_creds_t *crd, gnutls_session_t session,
+                               const char *host)
+{
+    vlc_mutex_lock(&session_lock);
+    for (unsigned i = 0; i < session_count; i++)
+        if (!strcmp(session_cache[i].host, host))
+        {
+            int val = gnutls_session_set_data(session,
+                                              session_cache[i].data.data,
+                                              session_cache[i].data.size);
+            if (val != 0)
+            {
+                msg_Dbg(crd, "cannot resume TLS session: %s",
+                        gnutls_strerror(val));
+                gnutls_SessionCacheErase(i);
+            }
+            break;
+        }
+    vlc_mutex_unlock(&session_lock);
+}
+
+static void gnutls_SessionSave(gnutls_session_t session, const char *host)
+{
+    gnutls_datum_t data;
+    char *dup;
+
+    if (gnutls_session_get_data2(session, &data) != 0)
+        return;
+
+    dup = strdup(host);
+    if (unlikely(dup == NULL))
+    {
+        gnutls_free(data.data);
+        return;
+    }
+
+    vlc_mutex_lock(&session_lock);
+    for (unsigned i = 0; i < session_count; i++)
+        if (!strcmp(session_cache[i].host, host))
+        {
+            gnutls_SessionCacheErase(i);
+            break;
+        }
+
+    /* Evict the least recently saved session if needed */
+    if (session_count == SESSION_CACHE_MAX)
+        gnutls_SessionCacheErase(0);
+    session_cache[session_count].host = dup;
+    session_cache[session_count].data = data;
+    session_count++;
+    vlc_mutex_unlock(&session_lock);
+}
+
 static int gnutls_ClientSessionOpen(vlc_tls_creds_t *crd, vlc_tls_t *tls,
                                     vlc_tls_t *sk, const char *hostname,
                                     const char *const *alpn)
@@ -402,24 +479,23 @@ static int gnutls_ClientSessionOpen(vlc_tls_creds_t *crd, vlc_tls_t *tls,
     gnutls_dh_set_prime_bits (session, 1024);
 
     if (likely(hostname != NULL))
-        /* fill Server Name Indication */
+    {   /* fill Server Name Indication */
         gnutls_server_name_set (session, GNUTLS_NAME_DNS,
                                 hostname, strlen (hostname));
+        gnutls_SessionLoad(crd, session, hostname);
+    }
 
     return VLC_SUCCESS;
 }
 
-static int gnutls_ClientHandshake(vlc_tls_creds_t *creds, vlc_tls_t *tls,
-                                  const char *host, const char *service,
-                                  char **restrict alp)
+static int gnutls_ClientVerify(vlc_tls_creds_t *creds, vlc_tls_t *tls,
+                               const char *host, const char *service,
+                               char **restrict alp)
 {
-    int val = gnutls_ContinueHandshake(creds, tls, alp);
-    if (val)
-        return val;
-
     /* certificates chain verification */
     gnutls_session_t session = tls->sys;
     unsigned status;
+    int val;
 
     val = gnutls_certificate_verify_peers3 (session, host, &status);
     if (val)
@@ -539,6 +615,25 @@ error:
     return -1;
 }
 
+static int gnutls_ClientHandshake(vlc_tls_creds_t *creds, vlc_tls_t *tls,
+                                  const char *host, const char *service,
+                                  char **restrict alp)
+{
+    int val = gnutls_ContinueHandshake(creds, tls, alp);
+    if (val)
+        return val;
+
+    gnutls_session_t session = tls->sys;
+
+    if (gnutls_session_is_resumed(session))
+        msg_Dbg(creds, "TLS session resumed");
+
+    val = gnutls_ClientVerify(creds, tls, host, service, alp);
+    if (val == 0 && host != NULL)
+        gnutls_SessionSave(session, host);
+    return val;
+}
+
 /**
  * Initializes a client-side TLS credentials.
  */
@@ -572,6 +667,10 @@ static int OpenClient (vlc_tls_creds_t *crd)
     crd->open = gnutls_ClientSessionOpen;
     crd->handshake = gnutls_ClientHandshake;
 
+    vlc_mutex_lock(&session_lock);
+    session_users++;
+    vlc_mutex_unlock(&session_lock);
+
     return VLC_SUCCESS;
 }
 
@@ -579,6 +678,13 @@ static void CloseClient (vlc_tls_creds_t *crd)
 {
     gnutls_certificate_credentials_t x509 = crd->sys;
 
+    vlc_mutex_lock(&session_lock);
+    assert(session_users > 0);
+    if (--session_users == 0)
+        while (session_count > 0)
+            gnutls_SessionCacheErase(session_count - 1);
+    vlc_mutex_unlock(&session_lock);
+
     gnutls_certificate_free_credentials (x509);
     gnutls_Deinit ();
 }
@@ -591,6 +697,7 @@ typedef struct vlc_tls_creds_sys
 {
     gnutls_certificate_credentials_t x509_cred;
     gnutls_dh_params_t dh_params;
+    gnutls_datum_t ticket_key; /**< session ticket encryption key */
 } vlc_tls_creds_sys_t;
 
 /**
@@ -603,8 +710,15 @@ static int gnutls_ServerSessionOpen(vlc_tls_creds_t *crd, vlc_tls_t *tls,
     vlc_tls_creds_sys_t *sys = crd->sys;
 
     assert (hostname == NULL);
-    return gnutls_SessionOpen(crd, tls, GNUTLS_SERVER, sys->x509_cred, sock,
-                              alpn);
+    int val = gnutls_SessionOpen(crd, tls, GNUTLS_SERVER, sys->x509_cred,
+                                 sock, alpn);
+    if (val != VLC_SUCCESS)
+        return val;
+
+    /* Let clients resume their sessions */
+    if (sys->ticket_key.data != NULL)
+        gnutls_session_ticket_enable_server(tls->sys, &sys->ticket_key);
+    return VLC_SUCCESS;
 }
 
 static int gnutls_ServerHandshake(vlc_tls_creds_t *crd, vlc_tls_t *tls,
@@ -702,6 +816,14 @@ static int OpenServer (vlc_tls_creds_t *crd, const char *cert, const char *key)
 
     msg_Dbg (crd, "ciphers parameters loaded");
 
+    val = gnutls_session_ticket_key_generate (&sys->ticket_key);
+    if (val < 0)
+    {
+        msg_Warn (crd, "cannot generate session ticket key: %s",
+                  gnutls_strerror (val));
+        sys->ticket_key.data = NULL;
+    }
+
     crd->sys = sys;
     crd->open = gnutls_ServerSessionOpen;
     crd->handshake = gnutls_ServerHandshake;
@@ -725,6 +847,7 @@ static void CloseServer (vlc_tls_creds_t *crd)
     /* all sessions depending on the server are now deinitialized */
     gnutls_certificate_free_credentials (sys->x509_cred);
     gnutls_dh_params_deinit (sys->dh_params);
+    gnutls_free (sys->ticket_key.data);
     free (sys);
     gnutls_Deinit ();
 }
@@ -52,6 +52,14 @@
     "Create \"Fast Start\" files. " \
     "\"Fast Start\" files are optimized for downloads and allow the user " \
     "to start previewing the file while it is downloading.")
+#define RESERVE_TEXT N_("Space reserved for the index (kB)")
+#define RESERVE_LONGTEXT N_(\
+    "Space left in front of the media data for the index of \"Fast Start\" " \
+    "files. If the index fits in it when done, the file does not need to " \
+    "be rewritten.")
+#define FRAGDURATION_TEXT N_("Fragment duration (ms)")
+#define FRAGDURATION_LONGTEXT N_(\
+    "Targeted duration of the movie fragments.")
 
 static int  Open   (vlc_object_t *);
 static void Close  (vlc_object_t *);
@@ -69,6 +77,9 @@ vlc_module_begin ()
     add_bool(SOUT_CFG_PREFIX "faststart", true,
               FASTSTART_TEXT, FASTSTART_LONGTEXT,
               true)
+    add_integer(SOUT_CFG_PREFIX "moov-reserve", 0,
+                RESERVE_TEXT, RESERVE_LONGTEXT, true)
+        change_integer_range(0, 1 << 20)
     set_capability("sout mux", 5)
     add_shortcut("mp4", "mov", "3gp")
     set_callbacks(Open, Close)
@@ -79,6 +90,9 @@ add_submodule ()
     set_subcategory(SUBCAT_SOUT_MUX)
     set_shortname("MP4 Frag")
     add_shortcut("mp4frag", "mp4stream")
+    add_integer(SOUT_CFG_PREFIX "frag-duration", 1500,
+                FRAGDURATION_TEXT, FRAGDURATION_LONGTEXT, true)
+        change_integer_range(100, 60000)
     set_capability("sout mux", 0)
     set_callbacks(OpenFrag, CloseFrag)
 
@@ -88,7 +102,11 @@ vlc_module_end ()
  * Exported prototypes
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
-    "faststart", NULL
+    "faststart", "moov-reserve", NULL
+};
+
+static const char *const ppsz_frag_sout_options[] = {
+    "frag-duration", NULL
 };
 
 static int Control(sout_mux_t *, int, va_list);
@@ -160,6 +178,8 @@ struct sout_mux_sys_t
 
     uint64_t i_mdat_pos;
     uint64_t i_pos;
+    uint64_t i_reserve_pos;
+    uint64_t i_reserve_size;
     mtime_t  i_read_duration;
     mtime_t  i_start_dts;
 
@@ -171,6 +191,7 @@ struct sout_mux_sys_t
     bool           b_header_sent;
     mtime_t        i_written_duration;
     uint32_t       i_mfhd_sequence;
+    mtime_t        i_frag_duration;
 };
 
 static void box_send(sout_mux_t *p_mux,  bo_t *box);
@@ -233,6 +254,24 @@ static int Open(vlc_object_t *p_this)
         box_send(p_mux, box);
     }
 
+    /* Reserve room for the moov in front of the data */
+    p_sys->i_reserve_pos  = p_sys->i_pos;
+    p_sys->i_reserve_size = 1024 *
+        var_GetInteger(p_mux, SOUT_CFG_PREFIX "moov-reserve");
+    if (p_sys->i_reserve_size > 0) {
+        block_t *p_free = block_Alloc(p_sys->i_reserve_size);
+        if (!p_free) {
+            free(p_sys);
+            return VLC_ENOMEM;
+        }
+        memset(p_free->p_buffer, 0, p_free->i_buffer);
+        SetDWBE(p_free->p_buffer, p_free->i_buffer);
+        memcpy(&p_free->p_buffer[4], "free", 4);
+        sout_AccessOutWrite(p_mux->p_access, p_free);
+        p_sys->i_pos += p_sys->i_reserve_size;
+        p_sys->i_mdat_pos = p_sys->i_pos;
+    }
+
     /* FIXME FIXME
      * Quicktime actually doesn't like the 64 bits extensions !!! */
     p_sys->b_64_ext = false;
@@ -290,6 +329,22 @@ static void Close(vlc_object_t *p_this)
 
     /* Check we need to create "fast start" files */
     p_sys->b_fast_start = var_GetBool(p_this, SOUT_CFG_PREFIX "faststart");
+
+    /* Write the moov in the reserved space if it fits, leaving the
+     * remainder as a free box */
+    uint64_t i_free_size = 0;
+    if (p_sys->b_fast_start && moov && moov->b && p_sys->i_reserve_size > 0) {
+        uint64_t i_moov_size = moov->b->i_buffer;
+        if (i_moov_size == p_sys->i_reserve_size ||
+            i_moov_size + 8 <= p_sys->i_reserve_size) {
+            i_moov_pos = p_sys->i_reserve_pos;
+            i_free_size = p_sys->i_reserve_size - i_moov_size;
+            p_sys->b_fast_start = false;
+        } else
+            msg_Warn(p_this, "index (%"PRIu64" bytes) exceeds the reserved "
+                     "space, rewriting the file", i_moov_size);
+    }
+
     while (p_sys->b_fast_start && moov && moov->b) {
         /* Move data to the end of the file so we can fit the moov header
          * at the start */
@@ -349,6 +404,15 @@ static void Close(vlc_object_t *p_this)
     if (moov != NULL)
         box_send(p_mux, moov);
 
+    if (i_free_size > 0) {
+        block_t *p_free = block_Alloc(8);
+        if (p_free) {
+            SetDWBE(p_free->p_buffer, i_free_size);
+            memcpy(&p_free->p_buffer[4], "free", 4);
+            sout_AccessOutWrite(p_mux->p_access, p_free);
+        }
+    }
+
 cleanup:
     /* Clean-up */
     for (unsigned int i_trak = 0; i_trak < p_sys->i_nb_streams; i_trak++) {
@@ -780,8 +844,6 @@ static void box_send(sout_mux_t *p_mux,  bo_t *box)
 /***************************************************************************
     MP4 Live submodule
 ****************************************************************************/
-#define FRAGMENT_LENGTH  (CLOCK_FREQ * 3/2)
-
 #define ENQUEUE_ENTRY(object, entry) \
     do {\
         if (object.p_last)\
@@ -1179,6 +1241,8 @@ static int OpenFrag(vlc_object_t *p_this)
     if (!p_sys)
         return VLC_ENOMEM;
 
+    config_ChainParse(p_mux, SOUT_CFG_PREFIX, ppsz_frag_sout_options, p_mux->p_cfg);
+
     p_mux->p_sys = (sout_mux_sys_t *) p_sys;
     p_mux->pf_control   = Control;
     p_mux->pf_addstream = AddStream;
@@ -1202,6 +1266,8 @@ static int OpenFrag(vlc_object_t *p_this)
     p_sys->b_fragmented  = true;
     p_sys->i_start_dts = VLC_TS_INVALID;
     p_sys->i_mfhd_sequence = 1;
+    p_sys->i_frag_duration = CLOCK_FREQ / 1000 *
+        var_GetInteger(p_mux, SOUT_CFG_PREFIX "frag-duration");
 
     return VLC_SUCCESS;
 }
@@ -1210,7 +1276,7 @@ static void WriteFragments(sout_mux_t *p_mux, bool b_flush)
 {
     sout_mux_sys_t *p_sys = (sout_mux_sys_t*) p_mux->p_sys;
     bo_t *moof = NULL;
-    mtime_t i_barrier_time = p_sys->i_written_duration + FRAGMENT_LENGTH;
+    mtime_t i_barrier_time = p_sys->i_written_duration + p_sys->i_frag_duration;
     size_t i_mdat_size = 0;
     bool b_has_samples = false;
 
@@ -1419,7 +1485,7 @@ static int MuxFrag(sout_mux_t *p_mux)
         p_stream->p_held_entry = NULL;
 
         if (p_stream->b_hasiframes && (p_heldblock->i_flags & BLOCK_FLAG_TYPE_I) &&
-            p_stream->mux.i_read_duration - p_sys->i_written_duration < FRAGMENT_LENGTH)
+            p_stream->mux.i_read_duration - p_sys->i_written_duration < p_sys->i_frag_duration)
         {
             /* Flag the last iframe time, we'll use it as boundary so it will start
                next fragment */
@@ -1468,7 +1534,8 @@ static int MuxFrag(sout_mux_t *p_mux)
     p_sys->i_written_duration = i_min_written_duration;
 
     /* we have prerolled enough to know all streams, and have enough date to create a fragment */
-    if (p_stream->read.p_first && p_sys->i_read_duration - p_sys->i_written_duration >= FRAGMENT_LENGTH)
+    if (p_stream->read.p_first &&
+        p_sys->i_read_duration - p_sys->i_written_duration >= p_sys->i_frag_duration)
         WriteFragments(p_mux, false);
 
     return VLC_SUCCESS;
@@ -56,6 +56,16 @@ static void csa_StreamCypher( csa_t *c, int b_init, uint8_t *ck, uint8_t *sb, ui
 static void csa_BlockDecypher( uint8_t kk[57], uint8_t ib[8], uint8_t bd[8] );
 static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] );
 
+#define CSA_BLOCK_LANES 8 /* blocks per csa_Block*Lanes() call */
+
+static void csa_BlockDecypherLanes( const uint8_t kk[57], const uint8_t *const ib[],
+                                    uint8_t *const bd[], int i_lanes );
+static void csa_BlockCypherLanes( const uint8_t kk[57], const uint8_t *const bd[],
+                                  uint8_t *const ib[], int i_lanes );
+
+static void csa_BsStreamXor( const uint8_t ck[8], uint8_t *const pp_data[],
+                             const int pi_len[], int i_lanes );
+
 /*****************************************************************************
  * csa_New:
  *****************************************************************************/
@@ -307,6 +317,182 @@ void csa_Encrypt( csa_t *c, uint8_t *pkt, int i_pkt_size )
     }
 }
 
+/*****************************************************************************
+ * csa_DecryptBatch:
+ *****************************************************************************/
+static void csa_DecryptLanes( uint8_t *ck, uint8_t *kk, uint8_t *const pp_data[],
+                              const int pi_len[], int i_lanes )
+{
+    uint8_t      bd[CSA_BATCH][184/8][8];
+    const uint8_t *pp_in[CSA_BLOCK_LANES];
+    uint8_t      *pp_out[CSA_BLOCK_LANES];
+    int           i_blocks = 0;
+
+    /* remove the stream layer of all packets at once */
+    csa_BsStreamXor( ck, pp_data, pi_len, i_lanes );
+
+    /* the blocks can then be decyphered independently */
+    for( int i = 0; i < i_lanes; i++ )
+    {
+        const int n = (pi_len[i] + 8) / 8;
+        for( int k = 0; k < n; k++ )
+        {
+            pp_in[i_blocks] = &pp_data[i][8*k];
+            pp_out[i_blocks] = bd[i][k];
+            if( ++i_blocks == CSA_BLOCK_LANES )
+            {
+                csa_BlockDecypherLanes( kk, pp_in, pp_out, i_blocks );
+                i_blocks = 0;
+            }
+        }
+    }
+    if( i_blocks > 0 )
+        csa_BlockDecypherLanes( kk, pp_in, pp_out, i_blocks );
+
+    /* and chained */
+    for( int i = 0; i < i_lanes; i++ )
+    {
+        uint8_t *p = pp_data[i];
+        const int n = (pi_len[i] + 8) / 8;
+
+        for( int k = 0; k < n; k++ )
+            for( int j = 0; j < 8; j++ )
+                p[8*k+j] = ( k + 1 < n ? p[8*(k+1)+j] : 0 ) ^ bd[i][k][j];
+    }
+}
+
+void csa_DecryptBatch( csa_t *c, uint8_t **pp_pkt, int i_pkt, int i_pkt_size )
+{
+    /* one pass per key, as a run of the bitsliced cypher uses a single key */
+    for( int i_key = 0; i_key < 2; i_key++ )
+    {
+        const bool b_odd = i_key == 0;
+        uint8_t *ck = b_odd ? c->o_ck : c->e_ck;
+        uint8_t *kk = b_odd ? c->o_kk : c->e_kk;
+        uint8_t *pp_data[CSA_BATCH];
+        int      pi_len[CSA_BATCH];
+        int      i_lanes = 0;
+
+        for( int i = 0; i < i_pkt; i++ )
+        {
+            uint8_t *pkt = pp_pkt[i];
+
+            if( (pkt[3]&0x80) == 0 || !(pkt[3]&0x40) != !b_odd )
+                continue;
+
+            int i_hdr = 4;
+            if( pkt[3]&0x20 )
+                i_hdr += pkt[4] + 1;
+
+            if( i_pkt_size - i_hdr < 8 )
+            {
+                /* less than one block */
+                csa_Decrypt( c, pkt, i_pkt_size );
+                continue;
+            }
+
+            pkt[3] &= 0x3f;
+            pp_data[i_lanes] = &pkt[i_hdr];
+            pi_len[i_lanes] = i_pkt_size - i_hdr - 8;
+            if( ++i_lanes == CSA_BATCH )
+            {
+                csa_DecryptLanes( ck, kk, pp_data, pi_len, i_lanes );
+                i_lanes = 0;
+            }
+        }
+
+        if( i_lanes > 0 )
+            csa_DecryptLanes( ck, kk, pp_data, pi_len, i_lanes );
+    }
+}
+
+/*****************************************************************************
+ * csa_EncryptBatch:
+ *****************************************************************************/
+static void csa_EncryptLanes( uint8_t *ck, uint8_t *kk, uint8_t *const pp_data[],
+                              const int pi_len[], int i_lanes )
+{
+    uint8_t        bd[CSA_BLOCK_LANES][8];
+    const uint8_t *pp_in[CSA_BLOCK_LANES];
+    uint8_t       *pp_out[CSA_BLOCK_LANES];
+    int            i_max = 0;
+
+    for( int i = 0; i < i_lanes; i++ )
+        if( pi_len[i] > i_max )
+            i_max = pi_len[i];
+
+    /* chained block layer, from the last block of each packet, in place */
+    for( int s = 0; s < (i_max + 8) / 8; s++ )
+    {
+        int i_blocks = 0;
+
+        for( int i = 0; i < i_lanes; i++ )
+        {
+            uint8_t *p = pp_data[i];
+            const int n = (pi_len[i] + 8) / 8;
+            const int k = n - 1 - s;
+
+            if( k < 0 )
+                continue;
+
+            for( int j = 0; j < 8; j++ )
+                bd[i_blocks][j] = p[8*k+j] ^ ( k + 1 < n ? p[8*(k+1)+j] : 0 );
+            pp_in[i_blocks] = bd[i_blocks];
+            pp_out[i_blocks] = &p[8*k];
+            if( ++i_blocks == CSA_BLOCK_LANES )
+            {
+                csa_BlockCypherLanes( kk, pp_in, pp_out, i_blocks );
+                i_blocks = 0;
+            }
+        }
+        if( i_blocks > 0 )
+            csa_BlockCypherLanes( kk, pp_in, pp_out, i_blocks );
+    }
+
+    /* then the stream layer of all packets at once */
+    csa_BsStreamXor( ck, pp_data, pi_len, i_lanes );
+}
+
+void csa_EncryptBatch( csa_t *c, uint8_t **pp_pkt, int i_pkt, int i_pkt_size )
+{
+    uint8_t *ck = c->use_odd ? c->o_ck : c->e_ck;
+    uint8_t *kk = c->use_odd ? c->o_kk : c->e_kk;
+
+    uint8_t *pp_data[CSA_BATCH];
+    int      pi_len[CSA_BATCH];
+    int      i_lanes = 0;
+
+    for( int i = 0; i < i_pkt; i++ )
+    {
+        uint8_t *pkt = pp_pkt[i];
+
+        int i_hdr = 4;
+        if( pkt[3]&0x20 )
+            i_hdr += pkt[4] + 1;
+
+        if( i_pkt_size - i_hdr < 8 )
+        {
+            /* less than one block */
+            csa_Encrypt( c, pkt, i_pkt_size );
+            continue;
+        }
+
+        /* set transport scrambling control */
+        pkt[3] |= c->use_odd ? 0xc0 : 0x80;
+
+        pp_data[i_lanes] = &pkt[i_hdr];
+        pi_len[i_lanes] = i_pkt_size - i_hdr - 8;
+        if( ++i_lanes == CSA_BATCH )
+        {
+            csa_EncryptLanes( ck, kk, pp_data, pi_len, i_lanes );
+            i_lanes = 0;
+        }
+    }
+
+    if( i_lanes > 0 )
+        csa_EncryptLanes( ck, kk, pp_data, pi_len, i_lanes );
+}
+
 /*****************************************************************************
  * Divers
  *****************************************************************************/
@@ -494,6 +680,520 @@ static void csa_StreamCypher( csa_t *c, int b_init, uint8_t *ck, uint8_t *sb, ui
 }
 
 
+/*****************************************************************************
+ * Bitsliced stream cypher
+ *****************************************************************************
+ * Runs the stream cypher of up to 64 packets at once: each bit of the cypher
+ * state is held in a 64 bits word, one bit per packet.
+ *****************************************************************************/
+typedef uint64_t csa_bs_t; /* at least CSA_BATCH bits */
+
+/* The s-boxes as boolean functions of their 5 input bits, the least
+ * significant first, returning the low then the high output bit. They are
+ * a Shannon decomposition of the sbox1..sbox7 tables above. */
+static inline void csa_BsSbox1( csa_bs_t x0, csa_bs_t x1, csa_bs_t x2,
+                                 csa_bs_t x3, csa_bs_t x4, csa_bs_t out[2] )
+{
+    const csa_bs_t t0 = ~x2;
+    const csa_bs_t t1 = x2 ^ x4;
+    const csa_bs_t t2 = t1 & x0;
+    const csa_bs_t t3 = t0 ^ x4;
+    const csa_bs_t t4 = t3 | ~x0;
+    const csa_bs_t t5 = t2 ^ t4;
+    const csa_bs_t t6 = t5 & x1;
+    const csa_bs_t t7 = t2 ^ t6;
+    const csa_bs_t t8 = x2 | ~x4;
+    const csa_bs_t t9 = t8 ^ x2;
+    const csa_bs_t t10 = t9 & x0;
+    const csa_bs_t t11 = t8 ^ t10;
+    const csa_bs_t t12 = x2 & x4;
+    const csa_bs_t t13 = t12 ^ t1;
+    const csa_bs_t t14 = t13 & x0;
+    const csa_bs_t t15 = t12 ^ t14;
+    const csa_bs_t t16 = t11 ^ t15;
+    const csa_bs_t t17 = t16 & x1;
+    const csa_bs_t t18 = t11 ^ t17;
+    const csa_bs_t t19 = t7 ^ t18;
+    const csa_bs_t t20 = t19 & x3;
+    const csa_bs_t t21 = t7 ^ t20;
+    const csa_bs_t t22 = x2 | x4;
+    const csa_bs_t t23 = t8 ^ t22;
+    const csa_bs_t t24 = t23 & x0;
+    const csa_bs_t t25 = t8 ^ t24;
+    const csa_bs_t t26 = t1 & ~x0;
+    const csa_bs_t t27 = t25 ^ t26;
+    const csa_bs_t t28 = t27 & x1;
+    const csa_bs_t t29 = t25 ^ t28;
+    const csa_bs_t t30 = t3 ^ t1;
+    const csa_bs_t t31 = t30 & x0;
+    const csa_bs_t t32 = t3 ^ t31;
+    const csa_bs_t t33 = t0 ^ t32;
+    const csa_bs_t t34 = t33 & x1;
+    const csa_bs_t t35 = t0 ^ t34;
+    const csa_bs_t t36 = t29 ^ t35;
+    const csa_bs_t t37 = t36 & x3;
+    const csa_bs_t t38 = t29 ^ t37;
+    out[0] = t21;
+    out[1] = t38;
+}
+
+static inline void csa_BsSbox2( csa_bs_t x0, csa_bs_t x1, csa_bs_t x2,
+                                 csa_bs_t x3, csa_bs_t x4, csa_bs_t out[2] )
+{
+    const csa_bs_t t0 = ~x1;
+    const csa_bs_t t1 = t0 ^ x2;
+    const csa_bs_t t2 = ~x2;
+    const csa_bs_t t3 = t0 ^ t2;
+    const csa_bs_t t4 = t3 & x3;
+    const csa_bs_t t5 = t0 ^ t4;
+    const csa_bs_t t6 = t1 ^ t5;
+    const csa_bs_t t7 = t6 & x0;
+    const csa_bs_t t8 = t1 ^ t7;
+    const csa_bs_t t9 = t0 ^ x3;
+    const csa_bs_t t10 = t2 ^ x3;
+    const csa_bs_t t11 = t9 ^ t10;
+    const csa_bs_t t12 = t11 & x0;
+    const csa_bs_t t13 = t9 ^ t12;
+    const csa_bs_t t14 = t8 ^ t13;
+    const csa_bs_t t15 = t14 & x4;
+    const csa_bs_t t16 = t8 ^ t15;
+    const csa_bs_t t17 = t0 | x2;
+    const csa_bs_t t18 = x1 & ~x2;
+    const csa_bs_t t19 = t17 ^ t18;
+    const csa_bs_t t20 = t19 & x3;
+    const csa_bs_t t21 = t17 ^ t20;
+    const csa_bs_t t22 = x1 ^ x2;
+    const csa_bs_t t23 = t22 ^ t1;
+    const csa_bs_t t24 = t23 & x3;
+    const csa_bs_t t25 = t22 ^ t24;
+    const csa_bs_t t26 = t21 ^ t25;
+    const csa_bs_t t27 = t26 & x0;
+    const csa_bs_t t28 = t21 ^ t27;
+    const csa_bs_t t29 = t1 & x3;
+    const csa_bs_t t30 = t0 ^ t29;
+    const csa_bs_t t31 = x1 | x2;
+    const csa_bs_t t32 = t31 ^ t18;
+    const csa_bs_t t33 = t32 & x3;
+    const csa_bs_t t34 = t31 ^ t33;
+    const csa_bs_t t35 = t30 ^ t34;
+    const csa_bs_t t36 = t35 & x0;
+    const csa_bs_t t37 = t30 ^ t36;
+    const csa_bs_t t38 = t28 ^ t37;
+    const csa_bs_t t39 = t38 & x4;
+    const csa_bs_t t40 = t28 ^ t39;
+    out[0] = t16;
+    out[1] = t40;
+}
+
+static inline void csa_BsSbox3( csa_bs_t x0, csa_bs_t x1, csa_bs_t x2,
+                                 csa_bs_t x3, csa_bs_t x4, csa_bs_t out[2] )
+{
+    const csa_bs_t t0 = ~x3;
+    const csa_bs_t t1 = x3 ^ x4;
+    const csa_bs_t t2 = t0 ^ x4;
+    const csa_bs_t t3 = t1 ^ t2;
+    const csa_bs_t t4 = t3 & x1;
+    const csa_bs_t t5 = t1 ^ t4;
+    const csa_bs_t t6 = t3 & x2;
+    const csa_bs_t t7 = t1 ^ t6;
+    const csa_bs_t t8 = t5 ^ t7;
+    const csa_bs_t t9 = t8 & x0;
+    const csa_bs_t t10 = t5 ^ t9;
+    const csa_bs_t t11 = t2 & ~x1;
+    const csa_bs_t t12 = t0 | ~x4;
+    const csa_bs_t t13 = t12 | x1;
+    const csa_bs_t t14 = t11 ^ t13;
+    const csa_bs_t t15 = t14 & x2;
+    const csa_bs_t t16 = t11 ^ t15;
+    const csa_bs_t t17 = t0 & x4;
+    const csa_bs_t t18 = x3 | ~x4;
+    const csa_bs_t t19 = t17 ^ t18;
+    const csa_bs_t t20 = t19 & x1;
+    const csa_bs_t t21 = t17 ^ t20;
+    const csa_bs_t t22 = t2 ^ t17;
+    const csa_bs_t t23 = t22 & x1;
+    const csa_bs_t t24 = t2 ^ t23;
+    const csa_bs_t t25 = t21 ^ t24;
+    const csa_bs_t t26 = t25 & x2;
+    const csa_bs_t t27 = t21 ^ t26;
+    const csa_bs_t t28 = t16 ^ t27;
+    const csa_bs_t t29 = t28 & x0;
+    const csa_bs_t t30 = t16 ^ t29;
+    out[0] = t10;
+    out[1] = t30;
+}
+
+static inline void csa_BsSbox4( csa_bs_t x0, csa_bs_t x1, csa_bs_t x2,
+                                 csa_bs_t x3, csa_bs_t x4, csa_bs_t out[2] )
+{
+    const csa_bs_t t0 = x0 | ~x1;
+    const csa_bs_t t1 = ~x0;
+    const csa_bs_t t2 = t1 & x1;
+    const csa_bs_t t3 = t0 ^ t2;
+    const csa_bs_t t4 = t3 & x2;
+    const csa_bs_t t5 = t0 ^ t4;
+    const csa_bs_t t6 = t1 ^ x1;
+    const csa_bs_t t7 = t5 ^ t6;
+    const csa_bs_t t8 = t7 & x3;
+    const csa_bs_t t9 = t5 ^ t8;
+    const csa_bs_t t10 = t1 | x1;
+    const csa_bs_t t11 = t10 ^ x0;
+    const csa_bs_t t12 = t11 & x2;
+    const csa_bs_t t13 = t10 ^ t12;
+    const csa_bs_t t14 = x0 & ~x1;
+    const csa_bs_t t15 = t14 ^ t6;
+    const csa_bs_t t16 = t15 & x2;
+    const csa_bs_t t17 = t14 ^ t16;
+    const csa_bs_t t18 = t13 ^ t17;
+    const csa_bs_t t19 = t18 & x3;
+    const csa_bs_t t20 = t13 ^ t19;
+    const csa_bs_t t21 = t9 ^ t20;
+    const csa_bs_t t22 = t21 & x4;
+    const csa_bs_t t23 = t9 ^ t22;
+    const csa_bs_t t24 = t2 ^ t0;
+    const csa_bs_t t25 = t24 & x2;
+    const csa_bs_t t26 = t2 ^ t25;
+    const csa_bs_t t27 = x0 ^ x1;
+    const csa_bs_t t28 = t26 ^ t27;
+    const csa_bs_t t29 = t28 & x3;
+    const csa_bs_t t30 = t26 ^ t29;
+    const csa_bs_t t31 = t20 ^ t30;
+    const csa_bs_t t32 = t31 & x4;
+    const csa_bs_t t33 = t20 ^ t32;
+    out[0] = t23;
+    out[1] = t33;
+}
+
+static inline void csa_BsSbox5( csa_bs_t x0, csa_bs_t x1, csa_bs_t x2,
+                                 csa_bs_t x3, csa_bs_t x4, csa_bs_t out[2] )
+{
+    const csa_bs_t t0 = x0 & x1;
+    const csa_bs_t t1 = x0 & ~x1;
+    const csa_bs_t t2 = t0 ^ t1;
+    const csa_bs_t t3 = t2 & x4;
+    const csa_bs_t t4 = t0 ^ t3;
+    const csa_bs_t t5 = ~x0;
+    const csa_bs_t t6 = x0 | x1;
+    const csa_bs_t t7 = t5 ^ t6;
+    const csa_bs_t t8 = t7 & x4;
+    const csa_bs_t t9 = t5 ^ t8;
+    const csa_bs_t t10 = t4 ^ t9;
+    const csa_bs_t t11 = t10 & x2;
+    const csa_bs_t t12 = t4 ^ t11;
+    const csa_bs_t t13 = t6 ^ t5;
+    const csa_bs_t t14 = t13 & x4;
+    const csa_bs_t t15 = t6 ^ t14;
+    const csa_bs_t t16 = t5 ^ x1;
+    const csa_bs_t t17 = ~x1;
+    const csa_bs_t t18 = t16 ^ t17;
+    const csa_bs_t t19 = t18 & x4;
+    const csa_bs_t t20 = t16 ^ t19;
+    const csa_bs_t t21 = t15 ^ t20;
+    const csa_bs_t t22 = t21 & x2;
+    const csa_bs_t t23 = t15 ^ t22;
+    const csa_bs_t t24 = t12 ^ t23;
+    const csa_bs_t t25 = t24 & x3;
+    const csa_bs_t t26 = t12 ^ t25;
+    const csa_bs_t t27 = t5 & ~x1;
+    const csa_bs_t t28 = t5 | ~x1;
+    const csa_bs_t t29 = t27 ^ t28;
+    const csa_bs_t t30 = t29 & x4;
+    const csa_bs_t t31 = t27 ^ t30;
+    const csa_bs_t t32 = t1 | ~x4;
+    const csa_bs_t t33 = t31 ^ t32;
+    const csa_bs_t t34 = t33 & x2;
+    const csa_bs_t t35 = t31 ^ t34;
+    const csa_bs_t t36 = t5 & x1;
+    const csa_bs_t t37 = t36 ^ t16;
+    const csa_bs_t t38 = t37 & x4;
+    const csa_bs_t t39 = t36 ^ t38;
+    const csa_bs_t t40 = x1 ^ t39;
+    const csa_bs_t t41 = t40 & x2;
+    const csa_bs_t t42 = x1 ^ t41;
+    const csa_bs_t t43 = t35 ^ t42;
+    const csa_bs_t t44 = t43 & x3;
+    const csa_bs_t t45 = t35 ^ t44;
+    out[0] = t26;
+    out[1] = t45;
+}
+
+static inline void csa_BsSbox6( csa_bs_t x0, csa_bs_t x1, csa_bs_t x2,
+                                 csa_bs_t x3, csa_bs_t x4, csa_bs_t out[2] )
+{
+    const csa_bs_t t0 = ~x0;
+    const csa_bs_t t1 = t0 ^ x3;
+    const csa_bs_t t2 = x0 ^ t1;
+    const csa_bs_t t3 = t2 & x2;
+    const csa_bs_t t4 = x0 ^ t3;
+    const csa_bs_t t5 = x0 ^ x3;
+    const csa_bs_t t6 = t5 ^ x3;
+    const csa_bs_t t7 = t6 & x2;
+    const csa_bs_t t8 = t5 ^ t7;
+    const csa_bs_t t9 = t0 & x3;
+    const csa_bs_t t10 = t0 | ~x3;
+    const csa_bs_t t11 = t9 ^ t10;
+    const csa_bs_t t12 = t11 & x2;
+    const csa_bs_t t13 = t9 ^ t12;
+    const csa_bs_t t14 = t8 ^ t13;
+    const csa_bs_t t15 = t14 & x4;
+    const csa_bs_t t16 = t8 ^ t15;
+    const csa_bs_t t17 = t4 ^ t16;
+    const csa_bs_t t18 = t17 & x1;
+    const csa_bs_t t19 = t4 ^ t18;
+    const csa_bs_t t20 = x0 | x3;
+    const csa_bs_t t21 = t20 & x2;
+    const csa_bs_t t22 = t10 ^ t1;
+    const csa_bs_t t23 = t22 & x2;
+    const csa_bs_t t24 = t10 ^ t23;
+    const csa_bs_t t25 = t21 ^ t24;
+    const csa_bs_t t26 = t25 & x4;
+    const csa_bs_t t27 = t21 ^ t26;
+    const csa_bs_t t28 = x0 ^ t9;
+    const csa_bs_t t29 = t28 & x2;
+    const csa_bs_t t30 = x0 ^ t29;
+    const csa_bs_t t31 = t24 ^ t30;
+    const csa_bs_t t32 = t31 & x4;
+    const csa_bs_t t33 = t24 ^ t32;
+    const csa_bs_t t34 = t27 ^ t33;
+    const csa_bs_t t35 = t34 & x1;
+    const csa_bs_t t36 = t27 ^ t35;
+    out[0] = t19;
+    out[1] = t36;
+}
+
+static inline void csa_BsSbox7( csa_bs_t x0, csa_bs_t x1, csa_bs_t x2,
+                                 csa_bs_t x3, csa_bs_t x4, csa_bs_t out[2] )
+{
+    const csa_bs_t t0 = ~x0;
+    const csa_bs_t t1 = x0 ^ x2;
+    const csa_bs_t t2 = t0 ^ x2;
+    const csa_bs_t t3 = t1 ^ t2;
+    const csa_bs_t t4 = t3 & x4;
+    const csa_bs_t t5 = t1 ^ t4;
+    const csa_bs_t t6 = x0 & x2;
+    const csa_bs_t t7 = t0 | ~x2;
+    const csa_bs_t t8 = t6 ^ t7;
+    const csa_bs_t t9 = t8 & x4;
+    const csa_bs_t t10 = t6 ^ t9;
+    const csa_bs_t t11 = t5 ^ t10;
+    const csa_bs_t t12 = t11 & x1;
+    const csa_bs_t t13 = t5 ^ t12;
+    const csa_bs_t t14 = t0 ^ x4;
+    const csa_bs_t t15 = x0 | ~x2;
+    const csa_bs_t t16 = t0 & ~x2;
+    const csa_bs_t t17 = t15 ^ t16;
+    const csa_bs_t t18 = t17 & x4;
+    const csa_bs_t t19 = t15 ^ t18;
+    const csa_bs_t t20 = t14 ^ t19;
+    const csa_bs_t t21 = t20 & x1;
+    const csa_bs_t t22 = t14 ^ t21;
+    const csa_bs_t t23 = t13 ^ t22;
+    const csa_bs_t t24 = t23 & x3;
+    const csa_bs_t t25 = t13 ^ t24;
+    const csa_bs_t t26 = t1 & ~x4;
+    const csa_bs_t t27 = ~x2;
+    const csa_bs_t t28 = t27 ^ t15;
+    const csa_bs_t t29 = t28 & x4;
+    const csa_bs_t t30 = t27 ^ t29;
+    const csa_bs_t t31 = t26 ^ t30;
+    const csa_bs_t t32 = t31 & x1;
+    const csa_bs_t t33 = t26 ^ t32;
+    const csa_bs_t t34 = t2 | x4;
+    const csa_bs_t t35 = t1 ^ t6;
+    const csa_bs_t t36 = t35 & x4;
+    const csa_bs_t t37 = t1 ^ t36;
+    const csa_bs_t t38 = t34 ^ t37;
+    const csa_bs_t t39 = t38 & x1;
+    const csa_bs_t t40 = t34 ^ t39;
+    const csa_bs_t t41 = t33 ^ t40;
+    const csa_bs_t t42 = t41 & x3;
+    const csa_bs_t t43 = t33 ^ t42;
+    out[0] = t25;
+    out[1] = t43;
+}
+
+#define CSA_BS_RING 75 /* room for 64 shifts of the 11 entries registers */
+
+typedef struct
+{
+    /* A[1]..A[10] and B[1]..B[10] are at index i_base + 1..10 */
+    csa_bs_t a[CSA_BS_RING][4];
+    csa_bs_t b[CSA_BS_RING][4];
+    int      i_base;
+    csa_bs_t X[4], Y[4], Z[4];
+    csa_bs_t D[4], E[4], F[4];
+    csa_bs_t p, q, r;
+} csa_bs_state_t;
+
+/* 2 bits per step, as in csa_StreamCypher(); in_a and in_b are the
+ * nibbles fed into T1 and T2 during initialisation, NULL afterwards */
+static void csa_BsStreamStep( csa_bs_state_t *s,
+                              const csa_bs_t *in_a, const csa_bs_t *in_b,
+                              csa_bs_t *p_hi, csa_bs_t *p_lo )
+{
+    csa_bs_t (*A)[4] = &s->a[s->i_base];
+    csa_bs_t (*B)[4] = &s->b[s->i_base];
+    csa_bs_t s1[2], s2[2], s3[2], s4[2], s5[2], s6[2], s7[2];
+    csa_bs_t extra_B[4];
+    csa_bs_t next_A1[4], next_B1[4], next_E[4], rot[4];
+    csa_bs_t carry;
+
+    /* from A[1]..A[10], 35 bits are selected as inputs to 7 s-boxes */
+    csa_BsSbox1( A[9][0], A[7][3], A[6][1], A[1][2], A[4][0], s1 );
+    csa_BsSbox2( A[9][1], A[7][0], A[6][3], A[3][2], A[2][1], s2 );
+    csa_BsSbox3( A[6][2], A[5][3], A[5][1], A[2][0], A[1][3], s3 );
+    csa_BsSbox4( A[8][0], A[4][2], A[2][3], A[1][1], A[3][3], s4 );
+    csa_BsSbox5( A[9][2], A[8][1], A[6][0], A[4][3], A[5][2], s5 );
+    csa_BsSbox6( A[9][3], A[7][2], A[5][0], A[4][1], A[3][1], s6 );
+    csa_BsSbox7( A[8][3], A[8][2], A[7][1], A[3][0], A[2][2], s7 );
+
+    /* 4x4 xor to produce extra nibble for T3 */
+    extra_B[3] = B[3][0] ^ B[6][1] ^ B[7][2] ^ B[9][3];
+    extra_B[2] = B[6][0] ^ B[8][1] ^ B[3][3] ^ B[4][2];
+    extra_B[1] = B[5][3] ^ B[8][2] ^ B[4][0] ^ B[5][1];
+    extra_B[0] = B[9][2] ^ B[6][3] ^ B[3][1] ^ B[8][0];
+
+    /* T1 and T2 */
+    for( int k = 0; k < 4; k++ )
+    {
+        next_A1[k] = A[10][k] ^ s->X[k];
+        next_B1[k] = B[7][k] ^ B[10][k] ^ s->Y[k];
+        if( in_a )
+        {
+            next_A1[k] ^= s->D[k] ^ in_a[k];
+            next_B1[k] ^= in_b[k];
+        }
+    }
+    /* if p=1, rotate left */
+    for( int k = 0; k < 4; k++ )
+        rot[k] = next_B1[(k+3)&3];
+    for( int k = 0; k < 4; k++ )
+        next_B1[k] ^= ( next_B1[k] ^ rot[k] ) & s->p;
+
+    /* T3 */
+    for( int k = 0; k < 4; k++ )
+        s->D[k] = s->E[k] ^ s->Z[k] ^ extra_B[k];
+
+    /* T4 = sum, carry of Z + E + r if q=1, E otherwise */
+    carry = s->r;
+    for( int k = 0; k < 4; k++ )
+    {
+        csa_bs_t sum = s->Z[k] ^ s->E[k] ^ carry;
+        carry = ( s->Z[k] & s->E[k] ) | ( carry & ( s->Z[k] ^ s->E[k] ) );
+        next_E[k] = s->F[k];
+        s->F[k] = s->E[k] ^ ( ( s->E[k] ^ sum ) & s->q );
+    }
+    s->r ^= ( s->r ^ carry ) & s->q;
+    memcpy( s->E, next_E, sizeof(next_E) );
+
+    /* shift the registers by moving their base */
+    if( s->i_base == 0 )
+    {
+        s->i_base = CSA_BS_RING - 11;
+        memmove( s->a[s->i_base], s->a[0], 11 * sizeof(s->a[0]) );
+        memmove( s->b[s->i_base], s->b[0], 11 * sizeof(s->b[0]) );
+    }
+    s->i_base--;
+    memcpy( s->a[s->i_base+1], next_A1, sizeof(next_A1) );
+    memcpy( s->b[s->i_base+1], next_B1, sizeof(next_B1) );
+
+    s->X[3] = s4[0]; s->X[2] = s3[0]; s->X[1] = s2[1]; s->X[0] = s1[1];
+    s->Y[3] = s6[0]; s->Y[2] = s5[0]; s->Y[1] = s4[1]; s->Y[0] = s3[1];
+    s->Z[3] = s2[0]; s->Z[2] = s1[0]; s->Z[1] = s6[1]; s->Z[0] = s5[1];
+    s->p = s7[1];
+    s->q = s7[0];
+
+    /* 2 output bits are a function of the 4 bits of D */
+    *p_hi = s->D[2] ^ s->D[3];
+    *p_lo = s->D[0] ^ s->D[1];
+}
+
+/* Transposes a 8x8 bits matrix, one row per byte */
+static inline uint64_t csa_BsTranspose8( uint64_t x )
+{
+    uint64_t t;
+    t = ( x ^ (x >> 7) ) & UINT64_C(0x00AA00AA00AA00AA);
+    x ^= t ^ (t << 7);
+    t = ( x ^ (x >> 14) ) & UINT64_C(0x0000CCCC0000CCCC);
+    x ^= t ^ (t << 14);
+    t = ( x ^ (x >> 28) ) & UINT64_C(0x00000000F0F0F0F0);
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+/* Initialises the stream cypher of each lane with the 8 bytes at pp_data[],
+ * then xors the following pi_len[] bytes with the generated stream */
+static void csa_BsStreamXor( const uint8_t ck[8], uint8_t *const pp_data[],
+                             const int pi_len[], int i_lanes )
+{
+    csa_bs_state_t s;
+    int i_len = 0;
+
+    memset( &s, 0, sizeof(s) );
+    s.i_base = CSA_BS_RING - 11;
+
+    /* load first 32 bits of CK into A[1]..A[8]
+     * load last  32 bits of CK into B[1]..B[8] */
+    for( int i = 0; i < 4; i++ )
+    {
+        for( int k = 0; k < 4; k++ )
+        {
+            s.a[s.i_base+1+2*i+0][k] = -(csa_bs_t)( (ck[i] >> (4+k))&1 );
+            s.a[s.i_base+1+2*i+1][k] = -(csa_bs_t)( (ck[i] >> k)&1 );
+            s.b[s.i_base+1+2*i+0][k] = -(csa_bs_t)( (ck[4+i] >> (4+k))&1 );
+            s.b[s.i_base+1+2*i+1][k] = -(csa_bs_t)( (ck[4+i] >> k)&1 );
+        }
+    }
+
+    for( int l = 0; l < i_lanes; l++ )
+        if( pi_len[l] > i_len )
+            i_len = pi_len[l];
+
+    /* 8 init bytes, then the stream bytes */
+    for( int i = -8; i < i_len; i++ )
+    {
+        csa_bs_t bits[8] = { 0 };
+
+        if( i < 0 )
+        {
+            for( int g = 0; 8 * g < i_lanes; g++ )
+            {
+                uint64_t m = 0;
+                for( int l = 0; l < 8 && 8 * g + l < i_lanes; l++ )
+                    m |= (uint64_t)pp_data[8*g+l][8+i] << (8 * l);
+                m = csa_BsTranspose8( m );
+                for( int b = 0; b < 8; b++ )
+                    bits[b] |= (csa_bs_t)( (m >> (8 * b))&0xff ) << (8 * g);
+            }
+
+            /* in1 is the high nibble, in2 the low one */
+            for( int j = 0; j < 4; j++ )
+            {
+                csa_bs_t unused;
+                if( j % 2 )
+                    csa_BsStreamStep( &s, &bits[0], &bits[4], &unused, &unused );
+                else
+                    csa_BsStreamStep( &s, &bits[4], &bits[0], &unused, &unused );
+            }
+            continue;
+        }
+
+        for( int j = 0; j < 4; j++ )
+            csa_BsStreamStep( &s, NULL, NULL, &bits[7-2*j], &bits[6-2*j] );
+
+        for( int g = 0; 8 * g < i_lanes; g++ )
+        {
+            uint64_t m = 0;
+            for( int b = 0; b < 8; b++ )
+                m |= (uint64_t)( (bits[b] >> (8 * g))&0xff ) << (8 * b);
+            m = csa_BsTranspose8( m );
+            for( int l = 0; l < 8 && 8 * g + l < i_lanes; l++ )
+                if( i < pi_len[8*g+l] )
+                    pp_data[8*g+l][8+i] ^= (m >> (8 * l))&0xff;
+        }
+    }
+}
+
 // block - sbox
 static const uint8_t block_sbox[256] =
 {
@@ -610,3 +1310,81 @@ static void csa_BlockCypher( uint8_t kk[57], uint8_t bd[8], uint8_t ib[8] )
     }
 }
 
+/* The block cyphers above, on up to 8 independent blocks at once: one per
+ * byte of the registers, so that the table lookups of different blocks
+ * can overlap */
+static inline uint64_t csa_BlockLookup( const uint8_t table[256], uint64_t x )
+{
+    uint64_t y = 0;
+    for( int i = 0; i < 8; i++ )
+        y |= (uint64_t)table[(x >> (8 * i))&0xff] << (8 * i);
+    return y;
+}
+
+static void csa_BlockDecypherLanes( const uint8_t kk[57], const uint8_t *const ib[],
+                                    uint8_t *const bd[], int i_lanes )
+{
+    uint64_t R[9] = { 0 };
+    uint64_t next_R8;
+
+    for( int l = 0; l < i_lanes; l++ )
+        for( int i = 0; i < 8; i++ )
+            R[i+1] |= (uint64_t)ib[l][i] << (8 * l);
+
+    // loop over kk[56]..kk[1]
+    for( int i = 56; i > 0; i-- )
+    {
+        const uint64_t sbox_out =
+            csa_BlockLookup( block_sbox, R[7] ^ (kk[i] * UINT64_C(0x0101010101010101)) );
+        const uint64_t perm_out = csa_BlockLookup( block_perm, sbox_out );
+
+        next_R8 = R[7];
+        R[7] = R[6] ^ perm_out;
+        R[6] = R[5];
+        R[5] = R[4] ^ R[8] ^ sbox_out;
+        R[4] = R[3] ^ R[8] ^ sbox_out;
+        R[3] = R[2] ^ R[8] ^ sbox_out;
+        R[2] = R[1];
+        R[1] = R[8] ^ sbox_out;
+
+        R[8] = next_R8;
+    }
+
+    for( int l = 0; l < i_lanes; l++ )
+        for( int i = 0; i < 8; i++ )
+            bd[l][i] = R[i+1] >> (8 * l);
+}
+
+static void csa_BlockCypherLanes( const uint8_t kk[57], const uint8_t *const bd[],
+                                  uint8_t *const ib[], int i_lanes )
+{
+    uint64_t R[9] = { 0 };
+    uint64_t next_R1;
+
+    for( int l = 0; l < i_lanes; l++ )
+        for( int i = 0; i < 8; i++ )
+            R[i+1] |= (uint64_t)bd[l][i] << (8 * l);
+
+    // loop over kk[1]..kk[56]
+    for( int i = 1; i <= 56; i++ )
+    {
+        const uint64_t sbox_out =
+            csa_BlockLookup( block_sbox, R[8] ^ (kk[i] * UINT64_C(0x0101010101010101)) );
+        const uint64_t perm_out = csa_BlockLookup( block_perm, sbox_out );
+
+        next_R1 = R[2];
+        R[2] = R[3] ^ R[1];
+        R[3] = R[4] ^ R[1];
+        R[4] = R[5] ^ R[1];
+        R[5] = R[6];
+        R[6] = R[7] ^ perm_out;
+        R[7] = R[8];
+        R[8] = R[1] ^ sbox_out;
+
+        R[1] = next_R1;
+    }
+
+    for( int l = 0; l < i_lanes; l++ )
+        for( int i = 0; i < 8; i++ )
+            ib[l][i] = R[i+1] >> (8 * l);
+}
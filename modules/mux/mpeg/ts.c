@@ -1786,9 +1786,12 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
     }
 
     /* msg_Dbg( p_mux, "real pck=%d", i_packet_count ); */
-    for (int i = 0; i < i_packet_count; i++ )
+    uint8_t *pp_csa[CSA_BATCH];
+    int i_csa = 0;
+
+    block_t *p_ts = p_chain_ts->p_first;
+    for (int i = 0; i < i_packet_count; i++, p_ts = p_ts->p_next )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
         mtime_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
 
         p_ts->i_dts    = i_new_dts;
@@ -1801,16 +1804,32 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
         }
         if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
         {
-            vlc_mutex_lock( &p_sys->csa_lock );
-            csa_Encrypt( p_sys->csa, p_ts->p_buffer, p_sys->i_csa_pkt_size );
-            vlc_mutex_unlock( &p_sys->csa_lock );
+            /* scramble by batches, all with the same key */
+            pp_csa[i_csa++] = p_ts->p_buffer;
+            if( i_csa == CSA_BATCH )
+            {
+                vlc_mutex_lock( &p_sys->csa_lock );
+                csa_EncryptBatch( p_sys->csa, pp_csa, i_csa, p_sys->i_csa_pkt_size );
+                vlc_mutex_unlock( &p_sys->csa_lock );
+                i_csa = 0;
+            }
         }
 
         /* latency */
         p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
+    }
 
-        sout_AccessOutWrite( p_mux->p_access, p_ts );
+    if( i_csa > 0 )
+    {
+        vlc_mutex_lock( &p_sys->csa_lock );
+        csa_EncryptBatch( p_sys->csa, pp_csa, i_csa, p_sys->i_csa_pkt_size );
+        vlc_mutex_unlock( &p_sys->csa_lock );
     }
+
+    /* hand the dated packets over at once, access outputs walk chains */
+    block_t *p_chain = p_chain_ts->p_first;
+    BufferChainInit( p_chain_ts );
+    sout_AccessOutWrite( p_mux->p_access, p_chain );
 }
 
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
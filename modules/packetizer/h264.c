@@ -103,6 +103,9 @@ struct decoder_sys_t
     bool   b_pps;
     block_t *pp_sps[H264_SPS_ID_MAX + 1];
     block_t *pp_pps[H264_PPS_ID_MAX + 1];
+    /* last parameter sets parsed, their values are the current ones */
+    const block_t *p_active_sps;
+    const block_t *p_active_pps;
     int    i_recovery_frames;  /* -1 = no recovery */
 
     /* avcC data */
@@ -202,6 +205,8 @@ static int Open( vlc_object_t *p_this )
                      p_h264_startcode, sizeof(p_h264_startcode), startcode_FindAnnexB,
                      p_h264_startcode, 1, 5,
                      PacketizeReset, PacketizeParse, PacketizeValidate, p_dec );
+    /* enough for the AUD, parameter sets and SEI in front of the slice */
+    p_sys->packetizer.i_au_headroom = 1024;
 
     p_sys->b_slice = false;
     p_sys->p_frame = NULL;
@@ -216,6 +221,8 @@ static int Open( vlc_object_t *p_this )
         p_sys->pp_sps[i] = NULL;
     for( i = 0; i <= H264_PPS_ID_MAX; i++ )
         p_sys->pp_pps[i] = NULL;
+    p_sys->p_active_sps = NULL;
+    p_sys->p_active_pps = NULL;
     p_sys->i_recovery_frames = -1;
 
     p_sys->slice.i_nal_type = -1;
@@ -599,11 +606,11 @@ static block_t *OutputPicture( decoder_t *p_dec )
         if( p_sys->p_frame )
             block_ChainAppend( &p_head, p_sys->p_frame );
 
-        p_pic = block_ChainGather( p_head );
+        p_pic = packetizer_ChainGather( p_head );
     }
     else
     {
-        p_pic = block_ChainGather( p_sys->p_frame );
+        p_pic = packetizer_ChainGather( p_sys->p_frame );
     }
 
     unsigned i_num_clock_ts = 2;
@@ -712,10 +719,23 @@ static block_t *OutputPicture( decoder_t *p_dec )
     return p_pic;
 }
 
+static bool IsRepeatedXPS( const block_t *p_xps, const block_t *p_frag )
+{
+    return p_xps && p_xps->i_buffer == p_frag->i_buffer &&
+           !memcmp( p_xps->p_buffer, p_frag->p_buffer, p_frag->i_buffer );
+}
+
 static void PutSPS( decoder_t *p_dec, block_t *p_frag )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
 
+    /* In-band repetition of the current SPS: nothing to parse again */
+    if( IsRepeatedXPS( p_sys->p_active_sps, p_frag ) )
+    {
+        block_Release( p_frag );
+        return;
+    }
+
     const uint8_t *p_buffer = p_frag->p_buffer;
     size_t i_buffer = p_frag->i_buffer;
 
@@ -782,6 +802,7 @@ static void PutSPS( decoder_t *p_dec, block_t *p_frag )
     if( p_sys->pp_sps[p_sps->i_id] )
         block_Release( p_sys->pp_sps[p_sps->i_id] );
     p_sys->pp_sps[p_sps->i_id] = p_frag;
+    p_sys->p_active_sps = p_frag;
 
     h264_release_sps( p_sps );
 }
@@ -789,6 +810,13 @@ static void PutSPS( decoder_t *p_dec, block_t *p_frag )
 static void PutPPS( decoder_t *p_dec, block_t *p_frag )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
+
+    if( IsRepeatedXPS( p_sys->p_active_pps, p_frag ) )
+    {
+        block_Release( p_frag );
+        return;
+    }
+
     const uint8_t *p_buffer = p_frag->p_buffer;
     size_t i_buffer = p_frag->i_buffer;
 
@@ -812,6 +840,7 @@ static void PutPPS( decoder_t *p_dec, block_t *p_frag )
     if( p_sys->pp_pps[p_pps->i_id] )
         block_Release( p_sys->pp_pps[p_pps->i_id] );
     p_sys->pp_pps[p_pps->i_id] = p_frag;
+    p_sys->p_active_pps = p_frag;
 
     h264_release_pps( p_pps );
 }
@@ -86,6 +86,10 @@ struct decoder_sys_t
     hevc_video_parameter_set_t    *rgi_p_decvps[HEVC_VPS_ID_MAX + 1];
     hevc_sequence_parameter_set_t *rgi_p_decsps[HEVC_SPS_ID_MAX + 1];
     hevc_picture_parameter_set_t  *rgi_p_decpps[HEVC_PPS_ID_MAX + 1];
+    /* raw NAL of the decoded versions above, to detect repetitions */
+    block_t *rgi_p_rawvps[HEVC_VPS_ID_MAX + 1];
+    block_t *rgi_p_rawsps[HEVC_SPS_ID_MAX + 1];
+    block_t *rgi_p_rawpps[HEVC_PPS_ID_MAX + 1];
     bool b_init_sequence_complete;
 
     /* */
@@ -176,6 +180,8 @@ static int Open(vlc_object_t *p_this)
                     p_hevc_startcode, sizeof(p_hevc_startcode), startcode_FindAnnexB,
                     p_hevc_startcode, 1, 5,
                     PacketizeReset, PacketizeParse, PacketizeValidate, p_dec);
+    /* enough for the AUD, parameter sets and SEI in front of the slice */
+    p_dec->p_sys->packetizer.i_au_headroom = 1024;
 
     /* Copy properties */
     es_format_Copy(&p_dec->fmt_out, &p_dec->fmt_in);
@@ -234,18 +240,24 @@ static void Close(vlc_object_t *p_this)
     {
         if(p_sys->rgi_p_decpps[i])
             hevc_rbsp_release_pps(p_sys->rgi_p_decpps[i]);
+        if(p_sys->rgi_p_rawpps[i])
+            block_Release(p_sys->rgi_p_rawpps[i]);
     }
 
     for(unsigned i=0;i<=HEVC_SPS_ID_MAX; i++)
     {
         if(p_sys->rgi_p_decsps[i])
             hevc_rbsp_release_sps(p_sys->rgi_p_decsps[i]);
+        if(p_sys->rgi_p_rawsps[i])
+            block_Release(p_sys->rgi_p_rawsps[i]);
     }
 
     for(unsigned i=0;i<=HEVC_VPS_ID_MAX; i++)
     {
         if(p_sys->rgi_p_decvps[i])
             hevc_rbsp_release_vps(p_sys->rgi_p_decvps[i]);
+        if(p_sys->rgi_p_rawvps[i])
+            block_Release(p_sys->rgi_p_rawvps[i]);
     }
 
     cc_storage_delete( p_sys->p_ccs );
@@ -307,25 +319,45 @@ static bool InsertXPS(decoder_t *p_dec, uint8_t i_nal_type, uint8_t i_id,
                       const block_t *p_nalb)
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
+    block_t **pp_raw;
+    const void *p_decoded;
 
     switch(i_nal_type)
     {
         case HEVC_NAL_VPS:
             if(i_id > HEVC_VPS_ID_MAX)
                 return false;
+            pp_raw = &p_sys->rgi_p_rawvps[i_id];
+            p_decoded = p_sys->rgi_p_decvps[i_id];
             break;
         case HEVC_NAL_SPS:
             if(i_id > HEVC_SPS_ID_MAX)
                 return false;
+            pp_raw = &p_sys->rgi_p_rawsps[i_id];
+            p_decoded = p_sys->rgi_p_decsps[i_id];
             break;
         case HEVC_NAL_PPS:
             if(i_id > HEVC_PPS_ID_MAX)
                 return false;
+            pp_raw = &p_sys->rgi_p_rawpps[i_id];
+            p_decoded = p_sys->rgi_p_decpps[i_id];
             break;
         default:
             return false;
     }
 
+    /* Parameter sets are usually repeated in-band: keep the decoded
+     * version of an identical one */
+    if(p_decoded && *pp_raw && (*pp_raw)->i_buffer == p_nalb->i_buffer &&
+       !memcmp((*pp_raw)->p_buffer, p_nalb->p_buffer, p_nalb->i_buffer))
+        return true;
+
+    if(*pp_raw)
+    {
+        block_Release(*pp_raw);
+        *pp_raw = NULL;
+    }
+
     /* Free associated decoded version */
     if(i_nal_type == HEVC_NAL_SPS && p_sys->rgi_p_decsps[i_id])
     {
@@ -375,6 +407,9 @@ static bool InsertXPS(decoder_t *p_dec, uint8_t i_nal_type, uint8_t i_id,
                 return false;
             }
         }
+        *pp_raw = block_Alloc(p_nalb->i_buffer);
+        if(*pp_raw)
+            memcpy((*pp_raw)->p_buffer, p_nalb->p_buffer, p_nalb->i_buffer);
         return true;
 
     }
@@ -610,7 +645,7 @@ static block_t *GatherAndValidateChain(block_t *p_outputchain)
         if(p_outputchain->i_flags & BLOCK_FLAG_CORRUPTED)
             p_output = p_outputchain; /* Avoid useless gather */
         else
-            p_output = block_ChainGather(p_outputchain);
+            p_output = packetizer_ChainGather(p_outputchain);
     }
 
     if(p_output && (p_output->i_flags & BLOCK_FLAG_CORRUPTED))
@@ -54,6 +54,8 @@ typedef struct
     const uint8_t *p_au_prepend;
 
     unsigned i_au_min_size;
+    /* room left in front of each unit, see packetizer_ChainGather() */
+    size_t i_au_headroom;
 
     void *p_private;
     packetizer_reset_t    pf_reset;
@@ -79,6 +81,7 @@ static inline void packetizer_Init( packetizer_t *p_pack,
     p_pack->i_au_prepend = i_au_prepend;
     p_pack->p_au_prepend = p_au_prepend;
     p_pack->i_au_min_size = i_au_min_size;
+    p_pack->i_au_headroom = 0;
 
     p_pack->i_startcode = i_startcode;
     p_pack->p_startcode = p_startcode;
@@ -89,6 +92,73 @@ static inline void packetizer_Init( packetizer_t *p_pack,
     p_pack->p_private = p_private;
 }
 
+/* Same as block_ChainGather(), except that the other blocks are copied
+ * around the payload of the largest one when it has enough room, which
+ * saves copying the bulk of the data (usually a single slice) again */
+static inline block_t *packetizer_ChainGather( block_t *p_list )
+{
+    size_t  i_total = 0;
+    mtime_t i_length = 0;
+
+    if( p_list->p_next == NULL )
+        return p_list;  /* Already gathered */
+
+    block_ChainProperties( p_list, NULL, &i_total, &i_length );
+
+    block_t *p_big = p_list;
+    size_t i_pre = 0, i_big_pre = 0;
+    for( block_t *p = p_list; p != NULL; p = p->p_next )
+    {
+        if( p->i_buffer > p_big->i_buffer )
+        {
+            p_big = p;
+            i_big_pre = i_pre;
+        }
+        i_pre += p->i_buffer;
+    }
+
+    const size_t i_post = i_total - i_big_pre - p_big->i_buffer;
+    if( (size_t)(p_big->p_buffer - p_big->p_start) < i_big_pre ||
+        (size_t)(p_big->p_start + p_big->i_size - p_big->p_buffer) <
+            p_big->i_buffer + i_post )
+        return block_ChainGather( p_list );
+
+    const uint32_t i_flags = p_list->i_flags;
+    const mtime_t i_pts = p_list->i_pts;
+    const mtime_t i_dts = p_list->i_dts;
+
+    block_t *p_after = p_big->p_next;
+    p_big->p_next = NULL;
+
+    uint8_t *p_dst = p_big->p_buffer - i_big_pre;
+    for( block_t *p = p_list; p != p_big; )
+    {
+        block_t *p_next = p->p_next;
+        memcpy( p_dst, p->p_buffer, p->i_buffer );
+        p_dst += p->i_buffer;
+        block_Release( p );
+        p = p_next;
+    }
+
+    p_dst = p_big->p_buffer + p_big->i_buffer;
+    for( block_t *p = p_after; p != NULL; )
+    {
+        block_t *p_next = p->p_next;
+        memcpy( p_dst, p->p_buffer, p->i_buffer );
+        p_dst += p->i_buffer;
+        block_Release( p );
+        p = p_next;
+    }
+
+    p_big->p_buffer -= i_big_pre;
+    p_big->i_buffer = i_total;
+    p_big->i_flags = i_flags;
+    p_big->i_pts = i_pts;
+    p_big->i_dts = i_dts;
+    p_big->i_length = i_length;
+    return p_big;
+}
+
 static inline void packetizer_Clean( packetizer_t *p_pack )
 {
     block_BytestreamRelease( &p_pack->bytestream );
@@ -180,7 +250,10 @@ static inline block_t *packetizer_Packetize( packetizer_t *p_pack, block_t **pp_
             /* Get the new fragment and set the pts/dts */
             block_t *p_block_bytestream = p_pack->bytestream.p_block;
 
-            p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
+            p_pic = block_Alloc( p_pack->i_au_headroom +
+                                 p_pack->i_offset + p_pack->i_au_prepend );
+            p_pic->p_buffer += p_pack->i_au_headroom;
+            p_pic->i_buffer -= p_pack->i_au_headroom;
             p_pic->i_pts = p_block_bytestream->i_pts;
             p_pic->i_dts = p_block_bytestream->i_dts;
 
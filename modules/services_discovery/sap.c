@@ -209,8 +209,15 @@ struct sap_announce_t
     sdp_t       *p_sdp;
 
     input_item_t * p_item;
+
+    /* Next announces in the same hash table buckets */
+    sap_announce_t *p_next_id;
+    sap_announce_t *p_next_origin;
 };
 
+/* Number of hash table buckets for the announces lookup */
+#define SAP_HASH_SIZE 256
+
 struct services_discovery_sys_t
 {
     vlc_thread_t thread;
@@ -223,6 +230,10 @@ struct services_discovery_sys_t
     int i_announces;
     struct sap_announce_t **pp_announces;
 
+    /* Announces by message identifier (if any) and by SDP origin */
+    sap_announce_t *id_table[SAP_HASH_SIZE];
+    sap_announce_t *origin_table[SAP_HASH_SIZE];
+
     /* Modes */
     bool  b_strict;
     bool  b_parse;
@@ -310,6 +321,8 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->i_announces = 0;
     p_sys->pp_announces = NULL;
+    memset( p_sys->id_table, 0, sizeof( p_sys->id_table ) );
+    memset( p_sys->origin_table, 0, sizeof( p_sys->origin_table ) );
     /* TODO: create sockets here, and fix racy sockets table */
     if (vlc_clone (&p_sys->thread, Run, p_sd, VLC_THREAD_PRIORITY_LOW))
     {
@@ -658,14 +671,79 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
  * Local functions
  **************************************************************/
 
+static unsigned HashId( uint16_t i_hash, const uint32_t *i_source )
+{
+    uint32_t h = i_hash;
+
+    for( int i = 0; i < 4; i++ )
+        h = h * 31 + i_source[i];
+    return h % SAP_HASH_SIZE;
+}
+
+static unsigned HashOrigin( const sdp_t *p_sdp )
+{
+    return (p_sdp->session_id ^ (p_sdp->session_id >> 32)) % SAP_HASH_SIZE;
+}
+
+static sap_announce_t *FindAnnounceById( services_discovery_sys_t *p_sys,
+                                         uint16_t i_hash,
+                                         const uint32_t *i_source )
+{
+    sap_announce_t *p_announce = p_sys->id_table[HashId( i_hash, i_source )];
+
+    while( p_announce != NULL
+        && ( p_announce->i_hash != i_hash
+          || memcmp( p_announce->i_source, i_source,
+                     sizeof( p_announce->i_source ) ) ) )
+        p_announce = p_announce->p_next_id;
+    return p_announce;
+}
+
+static sap_announce_t *FindAnnounceByOrigin( services_discovery_sys_t *p_sys,
+                                             sdp_t *p_sdp )
+{
+    sap_announce_t *p_announce = p_sys->origin_table[HashOrigin( p_sdp )];
+
+    while( p_announce != NULL && !IsSameSession( p_announce->p_sdp, p_sdp ) )
+        p_announce = p_announce->p_next_origin;
+    return p_announce;
+}
+
+/* Extracts the SDP origin (o= line) without parsing the whole SDP */
+static bool ParseOrigin( const char *psz_sdp, sdp_t *p_sdp )
+{
+    const char *psz_origin = strstr( psz_sdp, "\no=" );
+
+    return psz_origin != NULL
+        && sscanf( psz_origin + 3, "%63s %"SCNu64" %"SCNu64" IN IP%u %1023s",
+                   p_sdp->username, &p_sdp->session_id,
+                   &p_sdp->session_version, &p_sdp->orig_ip_version,
+                   p_sdp->orig_host ) == 5;
+}
+
+/* Accounts for one more packet of a known announce */
+static void RefreshAnnounce( sap_announce_t *p_announce )
+{
+    /* No need to go after six, as we start to trust the
+     * average period at six */
+    if( p_announce->i_period_trust <= 5 )
+        p_announce->i_period_trust++;
+
+    /* Compute the average period */
+    mtime_t now = mdate();
+    p_announce->i_period = ( p_announce->i_period * (p_announce->i_period_trust-1) + (now - p_announce->i_last) ) / p_announce->i_period_trust;
+    p_announce->i_last = now;
+}
+
 /* i_read is at least > 6 */
 static int ParseSAP( services_discovery_t *p_sd, const uint8_t *buf,
                      size_t len )
 {
-    int i;
+    services_discovery_sys_t *p_sys = p_sd->p_sys;
     const char          *psz_sdp;
     const uint8_t *end = buf + len;
     sdp_t               *p_sdp;
+    sap_announce_t      *p_announce;
     uint32_t            i_source[4];
 
     assert (buf[len] == '\0');
@@ -716,6 +794,23 @@ static int ParseSAP( services_discovery_t *p_sd, const uint8_t *buf,
     if (buf > end)
         return VLC_EGENERIC;
 
+    /* The message identifier changes with the SDP: if it is already known,
+     * there is nothing new to decompress nor parse. */
+    if( i_hash != 0 )
+    {
+        p_announce = FindAnnounceById( p_sys, i_hash, i_source );
+        if( p_announce != NULL )
+        {
+            /* We don't support delete announcement as they can easily
+             * Be used to highjack an announcement by a third party.
+             * Instead we cleverly implement Implicit Announcement removal.
+             */
+            if( !b_need_delete )
+                RefreshAnnounce( p_announce );
+            return VLC_SUCCESS;
+        }
+    }
+
     uint8_t *decomp = NULL;
     if( b_compressed )
     {
@@ -760,6 +855,26 @@ static int ParseSAP( services_discovery_t *p_sd, const uint8_t *buf,
         psz_sdp += clen;
     }
 
+    /* Without message identifier, the SDP origin identifies the session:
+     * only parse the SDP again if its version changed. */
+    if( i_hash == 0 )
+    {
+        sdp_t origin;
+
+        if( ParseOrigin( psz_sdp, &origin ) )
+        {
+            p_announce = FindAnnounceByOrigin( p_sys, &origin );
+            if( p_announce != NULL
+             && p_announce->p_sdp->session_version == origin.session_version )
+            {
+                if( !b_need_delete )
+                    RefreshAnnounce( p_announce );
+                free (decomp);
+                return VLC_SUCCESS;
+            }
+        }
+    }
+
     /* Parse SDP info */
     p_sdp = ParseSDP( VLC_OBJECT(p_sd), psz_sdp );
 
@@ -787,35 +902,17 @@ static int ParseSAP( services_discovery_t *p_sd, const uint8_t *buf,
         goto error;
     }
 
-    for( i = 0 ; i< p_sd->p_sys->i_announces ; i++ )
+    p_announce = FindAnnounceByOrigin( p_sys, p_sdp );
+    if( p_announce != NULL )
     {
-        sap_announce_t * p_announce = p_sd->p_sys->pp_announces[i];
-        /* FIXME: slow */
-        if( ( !i_hash && IsSameSession( p_announce->p_sdp, p_sdp ) )
-            || ( i_hash && p_announce->i_hash == i_hash
-                 && !memcmp(p_announce->i_source, i_source, sizeof(i_source)) ) )
+        if( p_announce->p_sdp->session_version != p_sdp->session_version )
+            /* Superseded by a new version of the session */
+            RemoveAnnounce( p_sd, p_announce );
+        else
+        if( i_hash == 0 )
         {
-            /* We don't support delete announcement as they can easily
-             * Be used to highjack an announcement by a third party.
-             * Instead we cleverly implement Implicit Announcement removal.
-             *
-             * if( b_need_delete )
-             *    RemoveAnnounce( p_sd, p_sd->p_sys->pp_announces[i]);
-             * else
-             */
-
             if( !b_need_delete )
-            {
-                /* No need to go after six, as we start to trust the
-                 * average period at six */
-                if( p_announce->i_period_trust <= 5 )
-                    p_announce->i_period_trust++;
-
-                /* Compute the average period */
-                mtime_t now = mdate();
-                p_announce->i_period = ( p_announce->i_period * (p_announce->i_period_trust-1) + (now - p_announce->i_last) ) / p_announce->i_period_trust;
-                p_announce->i_last = now;
-            }
+                RefreshAnnounce( p_announce );
             FreeSDP( p_sdp );
             free (decomp);
             return VLC_SUCCESS;
@@ -913,6 +1010,19 @@ sap_announce_t *CreateAnnounce( services_discovery_t *p_sd, uint32_t *i_source,
 
     TAB_APPEND( p_sys->i_announces, p_sys->pp_announces, p_sap );
 
+    if( i_hash != 0 )
+    {
+        sap_announce_t **pp = &p_sys->id_table[HashId( i_hash, i_source )];
+        p_sap->p_next_id = *pp;
+        *pp = p_sap;
+    }
+    else
+        p_sap->p_next_id = NULL;
+
+    sap_announce_t **pp = &p_sys->origin_table[HashOrigin( p_sdp )];
+    p_sap->p_next_origin = *pp;
+    *pp = p_sap;
+
     return p_sap;
 }
 
@@ -1550,8 +1660,24 @@ static void FreeSDP( sdp_t *p_sdp )
 static int RemoveAnnounce( services_discovery_t *p_sd,
                            sap_announce_t *p_announce )
 {
+    services_discovery_sys_t *p_sys = p_sd->p_sys;
+    sap_announce_t **pp;
     int i;
 
+    if( p_announce->i_hash != 0 )
+    {
+        pp = &p_sys->id_table[HashId( p_announce->i_hash,
+                                      p_announce->i_source )];
+        while( *pp != p_announce )
+            pp = &(*pp)->p_next_id;
+        *pp = p_announce->p_next_id;
+    }
+
+    pp = &p_sys->origin_table[HashOrigin( p_announce->p_sdp )];
+    while( *pp != p_announce )
+        pp = &(*pp)->p_next_origin;
+    *pp = p_announce->p_next_origin;
+
     if( p_announce->p_sdp )
     {
         FreeSDP( p_announce->p_sdp );
@@ -44,6 +44,11 @@ const char* MEDIA_SERVER_DEVICE_TYPE = "urn:schemas-upnp-org:device:MediaServer:
 const char* CONTENT_DIRECTORY_SERVICE_TYPE = "urn:schemas-upnp-org:service:ContentDirectory:1";
 const char* SATIP_SERVER_DEVICE_TYPE = "urn:ses-com:device:SatIPServer:1";
 
+/* Number of entries requested per Browse action, and number of pages
+ * requested concurrently from a single server */
+#define BROWSE_PAGE_SIZE 1000
+#define BROWSE_PARALLEL  4
+
 #define SATIP_CHANNEL_LIST N_("SAT>IP channel list")
 #define SATIP_CHANNEL_LIST_URL N_("Custom SAT>IP channel list URL")
 static const char *const ppsz_satip_channel_lists[] = {
@@ -778,18 +783,7 @@ Upnp_i11e_cb::~Upnp_i11e_cb()
 void Upnp_i11e_cb::waitAndRelease( void )
 {
     vlc_sem_wait_i11e( &m_sem );
-
-    vlc_mutex_lock( &m_lock );
-    if ( --m_refCount == 0 )
-    {
-        /* The run callback is processed, we can destroy this object */
-        vlc_mutex_unlock( &m_lock );
-        delete this;
-    } else
-    {
-        /* Interrupted, let the run callback destroy this object */
-        vlc_mutex_unlock( &m_lock );
-    }
+    release();
 }
 
 int Upnp_i11e_cb::run( Upnp_EventType eventType, void *p_event, void *p_cookie )
@@ -806,13 +800,28 @@ int Upnp_i11e_cb::run( Upnp_EventType eventType, void *p_event, void *p_cookie )
     }
     /* Process the user callback_ */
     self->m_callback( eventType, p_event, self->m_cookie);
-    vlc_mutex_unlock( &self->m_lock );
 
-    /* Signal that the callback is processed */
+    /* Signal that the callback is processed. This is done before unlocking
+     * so that the caller can't destroy the semaphore under our feet */
     vlc_sem_post( &self->m_sem );
+    vlc_mutex_unlock( &self->m_lock );
     return 0;
 }
 
+void Upnp_i11e_cb::release( void )
+{
+    vlc_mutex_lock( &m_lock );
+    if ( --m_refCount == 0 )
+    {
+        vlc_mutex_unlock( &m_lock );
+        delete this;
+    } else
+    {
+        /* Still pending, let the run callback destroy this object */
+        vlc_mutex_unlock( &m_lock );
+    }
+}
+
 MediaServer::MediaServer( access_t *p_access, input_item_node_t *node )
     : m_psz_objectId( NULL )
     , m_access( p_access )
@@ -1080,22 +1089,36 @@ int MediaServer::sendActionCb( Upnp_EventType eventType,
 }
 
 /* Access part */
-IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
-                                           const char* psz_browser_flag_,
-                                           const char* psz_filter_,
-                                           const char* psz_requested_count_,
-                                           const char* psz_sort_criteria_ )
+
+/*
+ * Sends a Browse action without waiting for its completion. The response is
+ * stored in *pp_response once the returned callback has run; the caller must
+ * then either wait for it or release it.
+ */
+Upnp_i11e_cb* MediaServer::_sendBrowseAction( const char* psz_object_id_,
+                                              const char* psz_browser_flag_,
+                                              const char* psz_filter_,
+                                              unsigned int i_starting_index_,
+                                              unsigned int i_requested_count_,
+                                              const char* psz_sort_criteria_,
+                                              IXML_Document** pp_response )
 {
     IXML_Document* p_action = NULL;
-    IXML_Document* p_response = NULL;
     Upnp_i11e_cb *i11eCb = NULL;
     access_sys_t *sys = (access_sys_t *)m_access->p_sys;
+    char psz_starting_index[11];
+    char psz_requested_count[11];
 
     int i_res;
 
     if ( vlc_killed() )
         return NULL;
 
+    snprintf( psz_starting_index, sizeof( psz_starting_index ), "%u",
+              i_starting_index_ );
+    snprintf( psz_requested_count, sizeof( psz_requested_count ), "%u",
+              i_requested_count_ );
+
     i_res = UpnpAddToAction( &p_action, "Browse",
             CONTENT_DIRECTORY_SERVICE_TYPE, "ObjectID", psz_object_id_ ? psz_object_id_ : "0" );
 
@@ -1127,7 +1150,7 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
-            CONTENT_DIRECTORY_SERVICE_TYPE, "StartingIndex", "0" );
+            CONTENT_DIRECTORY_SERVICE_TYPE, "StartingIndex", psz_starting_index );
     if ( i_res != UPNP_E_SUCCESS )
     {
         msg_Dbg( m_access, "AddToAction 'StartingIndex' failed: %s",
@@ -1136,7 +1159,7 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     }
 
     i_res = UpnpAddToAction( &p_action, "Browse",
-            CONTENT_DIRECTORY_SERVICE_TYPE, "RequestedCount", psz_requested_count_ );
+            CONTENT_DIRECTORY_SERVICE_TYPE, "RequestedCount", psz_requested_count );
 
     if ( i_res != UPNP_E_SUCCESS )
     {
@@ -1157,7 +1180,7 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
 
     /* Setup an interruptible callback that will call sendActionCb if not
      * interrupted by vlc_interrupt_kill */
-    i11eCb = new Upnp_i11e_cb( sendActionCb, &p_response );
+    i11eCb = new Upnp_i11e_cb( sendActionCb, pp_response );
     i_res = UpnpSendActionAsync( sys->p_upnp->handle(),
               m_psz_root,
               CONTENT_DIRECTORY_SERVICE_TYPE,
@@ -1169,37 +1192,51 @@ IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
     {
         msg_Err( m_access, "%s when trying the send() action with URL: %s",
                 UpnpGetErrorMessage( i_res ), m_access->psz_location );
+        /* The callback will never run: drop both references */
+        delete i11eCb;
+        i11eCb = NULL;
     }
-    /* Wait for the callback to fill p_response or wait for an interrupt */
-    i11eCb->waitAndRelease();
 
 browseActionCleanup:
     ixmlDocument_free( p_action );
+    return i11eCb;
+}
+
+IXML_Document* MediaServer::_browseAction( const char* psz_object_id_,
+                                           const char* psz_browser_flag_,
+                                           const char* psz_filter_,
+                                           unsigned int i_starting_index_,
+                                           unsigned int i_requested_count_,
+                                           const char* psz_sort_criteria_ )
+{
+    IXML_Document* p_response = NULL;
+    Upnp_i11e_cb *i11eCb = _sendBrowseAction( psz_object_id_, psz_browser_flag_,
+                                              psz_filter_, i_starting_index_,
+                                              i_requested_count_,
+                                              psz_sort_criteria_, &p_response );
+    /* Wait for the callback to fill p_response or wait for an interrupt */
+    if ( i11eCb != NULL )
+        i11eCb->waitAndRelease();
     return p_response;
 }
 
 /*
- * Fetches and parses the UPNP response
+ * Parses a Browse response and adds its containers and items to the node.
+ * Returns the number of entries of the page and the total number of children
+ * announced by the server (0 if unknown), or false on error.
  */
-bool MediaServer::fetchContents()
+bool MediaServer::addResults( IXML_Document* p_response,
+                              unsigned int* pi_returned, unsigned int* pi_total )
 {
-    IXML_Document* p_response = _browseAction( m_psz_objectId,
-                                      "BrowseDirectChildren",
-                                      "*",
-                                      // Some servers don't understand "0" as "no-limit"
-                                      "1000", /* RequestedCount */
-                                      "" /* SortCriteria */
-                                      );
-    if ( !p_response )
-    {
-        msg_Err( m_access, "No response from browse() action" );
-        return false;
-    }
+    const char* psz_returned =
+        xml_getChildElementValue( (IXML_Element*)p_response, "NumberReturned" );
+    const char* psz_total =
+        xml_getChildElementValue( (IXML_Element*)p_response, "TotalMatches" );
 
-    IXML_Document* p_result = parseBrowseResult( p_response );
-
-    ixmlDocument_free( p_response );
+    *pi_returned = psz_returned ? strtoul( psz_returned, NULL, 10 ) : 0;
+    *pi_total = psz_total ? strtoul( psz_total, NULL, 10 ) : 0;
 
+    IXML_Document* p_result = parseBrowseResult( p_response );
     if ( !p_result )
     {
         msg_Err( m_access, "browse() response parsing failed" );
@@ -1233,6 +1270,98 @@ bool MediaServer::fetchContents()
     return true;
 }
 
+/*
+ * Fetches and parses the UPNP response
+ *
+ * The first page tells how many children the container has and how many
+ * entries the server is willing to return at once. The remaining pages are
+ * then requested BROWSE_PARALLEL at a time, and added in order.
+ */
+bool MediaServer::fetchContents()
+{
+    unsigned int i_returned, i_total;
+
+    IXML_Document* p_response = _browseAction( m_psz_objectId,
+                                      "BrowseDirectChildren",
+                                      "*",
+                                      0, /* StartingIndex */
+                                      // Some servers don't understand "0" as "no-limit"
+                                      BROWSE_PAGE_SIZE, /* RequestedCount */
+                                      "" /* SortCriteria */
+                                      );
+    if ( !p_response )
+    {
+        msg_Err( m_access, "No response from browse() action" );
+        return false;
+    }
+
+    bool b_ok = addResults( p_response, &i_returned, &i_total );
+    ixmlDocument_free( p_response );
+    if ( !b_ok )
+        return false;
+
+    /* Servers may cap the page size below what was requested */
+    const unsigned int i_page = i_returned;
+    unsigned int i_index = i_returned;
+
+    while ( i_page > 0 && ( i_total == 0 || i_index < i_total ) && !vlc_killed() )
+    {
+        IXML_Document* pp_responses[BROWSE_PARALLEL] = { NULL };
+        Upnp_i11e_cb* pp_cbs[BROWSE_PARALLEL] = { NULL };
+        unsigned int i_count = 0;
+
+        /* Without a total count, we can only go one page at a time */
+        do
+        {
+            pp_cbs[i_count] = _sendBrowseAction( m_psz_objectId,
+                                                 "BrowseDirectChildren", "*",
+                                                 i_index + i_count * i_page,
+                                                 i_page, "",
+                                                 &pp_responses[i_count] );
+            if ( pp_cbs[i_count] == NULL )
+                break;
+            i_count++;
+        } while ( i_count < BROWSE_PARALLEL && i_total != 0 &&
+                  i_index + i_count * i_page < i_total );
+
+        bool b_done = i_count == 0;
+        for ( unsigned int i = 0; i < i_count; i++ )
+        {
+            if ( b_done || vlc_killed() )
+            {
+                /* Don't wait for pages we won't use */
+                b_done = true;
+                pp_cbs[i]->release();
+                continue;
+            }
+            pp_cbs[i]->waitAndRelease();
+
+            unsigned int i_page_returned, i_page_total;
+            if ( pp_responses[i] == NULL
+             || !addResults( pp_responses[i], &i_page_returned, &i_page_total )
+             || i_page_returned == 0 )
+            {
+                b_done = true;
+                continue;
+            }
+            i_index += i_page_returned;
+        }
+
+        /* The callbacks are released: the responses can't change anymore */
+        for ( unsigned int i = 0; i < i_count; i++ )
+            if ( pp_responses[i] != NULL )
+                ixmlDocument_free( pp_responses[i] );
+
+        if ( b_done )
+            break;
+    }
+
+    if ( i_total != 0 && i_index < i_total )
+        msg_Warn( m_access, "only %u out of %u entries could be browsed",
+                  i_index, i_total );
+    return true;
+}
+
 static int ReadDirectory( access_t *p_access, input_item_node_t* p_node )
 {
     MediaServer server( p_access, p_node );
@@ -126,6 +126,7 @@ public:
     Upnp_i11e_cb( Upnp_FunPtr callback, void *cookie );
     ~Upnp_i11e_cb();
     void waitAndRelease( void );
+    void release( void );
     static int run( Upnp_EventType, void *, void *);
 
 private:
@@ -150,8 +151,14 @@ private:
     bool addContainer( IXML_Element* containerElement );
     bool addItem( IXML_Element* itemElement );
 
+    bool addResults( IXML_Document* p_response,
+                     unsigned int* pi_returned, unsigned int* pi_total );
+
+    Upnp_i11e_cb* _sendBrowseAction(const char*, const char*,
+            const char*, unsigned int, unsigned int, const char*,
+            IXML_Document** );
     IXML_Document* _browseAction(const char*, const char*,
-            const char*, const char*, const char* );
+            const char*, unsigned int, unsigned int, const char* );
     static int sendActionCb( Upnp_EventType, void *, void *);
 
 private:
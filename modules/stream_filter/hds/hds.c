@@ -51,6 +51,7 @@ typedef struct chunk_s
     uint8_t     *data;
     bool        failed;
     bool        eof;
+    bool        downloading; /* claimed by a download thread */
 } chunk_t;
 
 typedef struct segment_run_s
@@ -121,13 +122,17 @@ typedef struct hds_stream_s
 /* this is effectively just a sanity check  mechanism */
 #define MAX_REQUEST_SIZE (50*1024*1024)
 
+/* number of fragments fetched in parallel */
+#define HDS_DL_THREADS 3
+
 #define BITRATE_AS_BYTES_PER_SECOND 1024/8
 
 struct stream_sys_t
 {
     char         *base_url;    /* URL common part for chunks */
     vlc_thread_t live_thread;
-    vlc_thread_t dl_thread;
+    vlc_thread_t dl_threads[HDS_DL_THREADS];
+    unsigned     dl_thread_count;
 
     /* we pend on peek until some number of segments arrives; otherwise
      * the downstream system dies in case of playback */
@@ -815,6 +820,8 @@ static uint8_t* download_chunk( stream_t *s,
     if( size > MAX_REQUEST_SIZE )
     {
         msg_Err(s, "Strangely-large chunk of %"PRIi64" Bytes", size );
+        vlc_stream_Delete( download_stream );
+        chunk->failed = true;
         return NULL;
     }
 
@@ -822,11 +829,14 @@ static uint8_t* download_chunk( stream_t *s,
     if( ! data )
     {
         msg_Err(s, "Couldn't allocate chunk" );
+        vlc_stream_Delete( download_stream );
+        chunk->failed = true;
         return NULL;
     }
 
     int read = vlc_stream_Read( download_stream, data,
                             size );
+    vlc_stream_Delete( download_stream );
     if( read < 0 )
         read = 0;
     chunk->data_len = read;
@@ -835,21 +845,30 @@ static uint8_t* download_chunk( stream_t *s,
     {
         msg_Err( s, "Requested %"PRIi64" bytes, "\
                  "but only got %d", size, read );
-        data = realloc( chunk->data, read );
-        if( data != NULL )
-            chunk->data = data;
+        free( data );
         chunk->failed = true;
         return NULL;
     }
-    else
-    {
-        chunk->failed = false;
-    }
 
-    vlc_stream_Delete( download_stream );
+    chunk->failed = false;
     return data;
 }
 
+/* returns the first chunk not yet downloaded nor being downloaded */
+static chunk_t* claim_chunk( hds_stream_t* hds_stream )
+{
+    chunk_t* chunk = hds_stream->chunks_downloadpos;
+    if( ! chunk )
+        chunk = hds_stream->chunks_head;
+
+    while( chunk && ( chunk->data || chunk->downloading ) )
+        chunk = chunk->next;
+
+    if( chunk )
+        chunk->downloading = true;
+    return chunk;
+}
+
 static void* download_thread( void* p )
 {
     vlc_object_t* p_this = (vlc_object_t*)p;
@@ -868,46 +887,53 @@ static void* download_thread( void* p )
 
     while( ! sys->closed )
     {
-        if( ! hds_stream->chunks_downloadpos )
+        chunk_t *chunk = claim_chunk( hds_stream );
+        if( ! chunk )
         {
-            chunk_t* chunk = hds_stream->chunks_head;
-            while(chunk && chunk->data )
-            {
-                chunk = chunk->next;
-            }
-
-            if( chunk && ! chunk->data )
-                hds_stream->chunks_downloadpos = chunk;
+            vlc_cond_wait( & hds_stream->dl_cond,
+                           & hds_stream->dl_lock );
+            continue;
         }
 
-        while( hds_stream->chunks_downloadpos )
-        {
-            chunk_t *chunk = hds_stream->chunks_downloadpos;
+        /* the other threads fetch the following chunks meanwhile */
+        vlc_mutex_unlock( & hds_stream->dl_lock );
 
-            uint8_t *data = download_chunk( (stream_t*)p_this,
-                                            sys,
-                                            hds_stream,
-                                            chunk );
-
-            if( ! chunk->failed )
-            {
-                chunk->mdat_len =
-                    find_chunk_mdat( p_this,
-                                     data,
-                                     data + chunk->data_len,
-                                     & chunk->mdat_data );
-                if( chunk->mdat_len == 0 ) {
-                    chunk->mdat_len = chunk->data_len - (chunk->mdat_data - data);
-                }
-                hds_stream->chunks_downloadpos = chunk->next;
-                chunk->data = data;
-
-                sys->chunk_count++;
+        uint8_t *data = download_chunk( (stream_t*)p_this,
+                                        sys,
+                                        hds_stream,
+                                        chunk );
+        if( data )
+        {
+            chunk->mdat_len =
+                find_chunk_mdat( p_this,
+                                 data,
+                                 data + chunk->data_len,
+                                 & chunk->mdat_data );
+            if( chunk->mdat_len == 0 ) {
+                chunk->mdat_len = chunk->data_len - (chunk->mdat_data - data);
             }
         }
 
-        vlc_cond_wait( & hds_stream->dl_cond,
-                       & hds_stream->dl_lock );
+        vlc_mutex_lock( & hds_stream->dl_lock );
+        chunk->downloading = false;
+        if( data )
+        {
+            /* move past the downloaded chunks before publishing this one,
+             * as the reader may free it as soon as it is */
+            if( hds_stream->chunks_downloadpos == chunk )
+                hds_stream->chunks_downloadpos = chunk->next;
+            while( hds_stream->chunks_downloadpos &&
+                   hds_stream->chunks_downloadpos->data )
+                hds_stream->chunks_downloadpos = hds_stream->chunks_downloadpos->next;
+            chunk->data = data;
+            sys->chunk_count++;
+        }
+        else
+        {
+            /* retry later rather than spinning on the failing fragment */
+            vlc_cond_timedwait( & hds_stream->dl_cond,
+                                & hds_stream->dl_lock, mdate() + CLOCK_FREQ );
+        }
     }
 
     vlc_mutex_unlock( & hds_stream->dl_lock );
@@ -1663,7 +1689,13 @@ static int Open( vlc_object_t *p_this )
     s->pf_seek = NULL;
     s->pf_control = Control;
 
-    if( vlc_clone( &p_sys->dl_thread, download_thread, s, VLC_THREAD_PRIORITY_INPUT ) )
+    for( unsigned i = 0; i < HDS_DL_THREADS; i++ )
+    {
+        if( vlc_clone( &p_sys->dl_threads[i], download_thread, s, VLC_THREAD_PRIORITY_INPUT ) )
+            break;
+        p_sys->dl_thread_count++;
+    }
+    if( p_sys->dl_thread_count == 0 )
     {
         goto error;
     }
@@ -1694,11 +1726,17 @@ static void Close( vlc_object_t *p_this )
     hds_stream_t *stream = vlc_array_count(p_sys->hds_streams) ?
         p_sys->hds_streams->pp_elems[0] : NULL;
 
+    if (stream)
+        vlc_mutex_lock( & stream->dl_lock );
     p_sys->closed = true;
     if (stream)
-        vlc_cond_signal( & stream->dl_cond );
+    {
+        vlc_cond_broadcast( & stream->dl_cond );
+        vlc_mutex_unlock( & stream->dl_lock );
+    }
 
-    vlc_join( p_sys->dl_thread, NULL );
+    for( unsigned i = 0; i < p_sys->dl_thread_count; i++ )
+        vlc_join( p_sys->dl_threads[i], NULL );
 
     if( p_sys->live )
     {
@@ -34,6 +34,7 @@
 #include <vlc_stream.h>
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
+#include <vlc_membudget.h>
 
 struct stream_sys_t
 {
@@ -61,8 +62,25 @@ struct stream_sys_t
     char        *buffer;
     size_t       read_size;
     size_t       seek_threshold;
+
+    /* Buffer sizing */
+    size_t       buffer_min;
+    size_t       buffer_max;
+    uint64_t     bytes_in;  /* received since rate_date */
+    uint64_t     bytes_out; /* consumed since rate_date */
+    unsigned     underruns; /* since rate_date */
+    mtime_t      rate_date;
+    mtime_t      underrun_date;
+    vlc_mem_consumer_t *mem;
 };
 
+/* Memory used by all the prefetch buffers of the process */
+static vlc_mutex_t budget_lock = VLC_STATIC_MUTEX;
+static size_t budget_used = 0;
+
+/* Time worth of data kept when the source is faster than the consumer */
+#define KEEP_DURATION (4 * CLOCK_FREQ)
+
 static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
 {
     stream_sys_t *sys = stream->p_sys;
@@ -117,6 +135,146 @@ static int ThreadControl(stream_t *stream, int query, ...)
 #define MAX_READ 65536
 #define SEEK_THRESHOLD MAX_READ
 
+/* The prefetch budget caps this module, the process memory budget caps all
+ * the buffers of the process */
+static bool BudgetTake(stream_t *stream, size_t size)
+{
+    stream_sys_t *sys = stream->p_sys;
+    size_t budget = var_InheritInteger(stream, "prefetch-budget") << 20;
+    bool ok;
+
+    vlc_mutex_lock(&budget_lock);
+    ok = budget == 0 || budget_used + size <= budget;
+    if (ok)
+        budget_used += size;
+    vlc_mutex_unlock(&budget_lock);
+
+    if (ok && !vlc_mem_Take(sys->mem, size))
+    {
+        vlc_mutex_lock(&budget_lock);
+        budget_used -= size;
+        vlc_mutex_unlock(&budget_lock);
+        ok = false;
+    }
+    return ok;
+}
+
+static void BudgetGive(stream_t *stream, size_t size)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    vlc_mutex_lock(&budget_lock);
+    assert(budget_used >= size);
+    budget_used -= size;
+    vlc_mutex_unlock(&budget_lock);
+    vlc_mem_Give(sys->mem, size);
+}
+
+/**
+ * Moves the buffered data to a circular buffer of a different size.
+ * Historical data is dropped first if the new buffer is too small.
+ */
+static void BufferResize(stream_t *stream, size_t size)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    if (sys->stream_offset > sys->buffer_offset
+     && sys->buffer_length > size)
+    {
+        uint64_t history = sys->stream_offset - sys->buffer_offset;
+        size_t drop = sys->buffer_length - size;
+
+        if (drop > history)
+            drop = history;
+        sys->buffer_offset += drop;
+        sys->buffer_length -= drop;
+    }
+    if (size < sys->buffer_length)
+        size = sys->buffer_length;
+    if (size == sys->buffer_size)
+        return;
+
+    if (size > sys->buffer_size
+     && !BudgetTake(stream, size - sys->buffer_size))
+        return;
+
+    char *buffer = malloc(size);
+    if (unlikely(buffer == NULL))
+    {
+        if (size > sys->buffer_size)
+            BudgetGive(stream, size - sys->buffer_size);
+        return;
+    }
+
+    for (size_t done = 0; done < sys->buffer_length;)
+    {
+        uint64_t pos = sys->buffer_offset + done;
+        size_t from = pos % sys->buffer_size;
+        size_t to = pos % size;
+        size_t len = sys->buffer_length - done;
+
+        /* Do not step past the sharp edges of either circular buffer */
+        if (len > sys->buffer_size - from)
+            len = sys->buffer_size - from;
+        if (len > size - to)
+            len = size - to;
+        memcpy(buffer + to, sys->buffer + from, len);
+        done += len;
+    }
+
+    if (size < sys->buffer_size)
+        BudgetGive(stream, sys->buffer_size - size);
+    msg_Dbg(stream, "buffer size %zu -> %zu bytes", sys->buffer_size, size);
+    free(sys->buffer);
+    sys->buffer = buffer;
+    sys->buffer_size = size;
+}
+
+/**
+ * Adapts the buffer size to the input and consumption rates.
+ *
+ * The buffer grows when the reader runs out of data, up to the configured
+ * size and as long as the process memory budget allows. It shrinks back
+ * when the source has been faster than the reader for a while, in which
+ * case only a few seconds worth of data are needed, or when it uses more
+ * than its share of an exhausted memory budget.
+ */
+static void BufferAdapt(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+    mtime_t now = mdate();
+    mtime_t elapsed = now - sys->rate_date;
+
+    if (elapsed < CLOCK_FREQ)
+        return;
+
+    if (vlc_mem_ShouldShrink(sys->mem))
+    {   /* Leave room for the other users of the memory budget */
+        if (sys->buffer_size > sys->buffer_min)
+            BufferResize(stream, __MAX(sys->buffer_size / 2, sys->buffer_min));
+    }
+    else if (sys->underruns > 0 && !sys->eof)
+    {
+        sys->underrun_date = now;
+        if (sys->buffer_size < sys->buffer_max)
+            BufferResize(stream, __MIN(sys->buffer_size * 2, sys->buffer_max));
+    }
+    else if (now - sys->underrun_date >= 10 * CLOCK_FREQ
+          && sys->bytes_in > sys->bytes_out)
+    {
+        uint64_t target = sys->bytes_out * KEEP_DURATION / elapsed;
+
+        if (target < sys->buffer_min)
+            target = sys->buffer_min;
+        if (target * 2 <= sys->buffer_size)
+            BufferResize(stream, __MAX(target, sys->buffer_size / 2));
+    }
+
+    sys->bytes_in = sys->bytes_out = 0;
+    sys->underruns = 0;
+    sys->rate_date = now;
+}
+
 static void *Thread(void *data)
 {
     stream_t *stream = data;
@@ -129,6 +287,9 @@ static void *Thread(void *data)
     mutex_cleanup_push(&sys->lock);
     for (;;)
     {
+        if (!paused)
+            BufferAdapt(stream);
+
         if (sys->paused != paused)
         {   /* Update pause state */
             msg_Dbg(stream, paused ? "resuming" : "pausing");
@@ -248,6 +409,7 @@ static void *Thread(void *data)
         }
 
         assert((size_t)val <= len);
+        sys->bytes_in += val;
         sys->buffer_length += val;
         assert(sys->buffer_length <= sys->buffer_size);
         //msg_Dbg(stream, "buffer: %zu/%zu", sys->buffer_length,
@@ -321,6 +483,8 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
             return 0;
         }
 
+        if (sys->stream_offset > 0)
+            sys->underruns++;
         vlc_interrupt_forward_start(sys->interrupt, data);
         vlc_cond_wait(&sys->wait_data, &sys->lock);
         vlc_interrupt_forward_stop(data);
@@ -335,6 +499,7 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 
     memcpy(buf, sys->buffer + offset, copy);
     sys->stream_offset += copy;
+    sys->bytes_out += copy;
 out:
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
@@ -457,52 +622,79 @@ static int Open(vlc_object_t *obj)
     sys->buffer_offset = 0;
     sys->stream_offset = 0;
     sys->buffer_length = 0;
-    sys->buffer_size = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
+    sys->buffer_max = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
     sys->read_size = var_InheritInteger(obj, "prefetch-read-size");
     sys->seek_threshold = var_InheritInteger(obj, "prefetch-seek-threshold");
 
     uint64_t size = stream_Size(stream->p_source);
     if (size > 0)
     {   /* No point allocating a buffer larger than the source stream */
-        if (sys->buffer_size > size)
-            sys->buffer_size = size;
+        if (sys->buffer_max > size)
+            sys->buffer_max = size;
         if (sys->read_size > size)
             sys->read_size = size;
     }
-    if (sys->buffer_size < sys->read_size)
-        sys->buffer_size = sys->read_size;
+    if (sys->buffer_max < sys->read_size)
+        sys->buffer_max = sys->read_size;
+
+    /* Start small, the buffer grows if the source cannot keep up */
+    sys->buffer_min = __MAX(sys->read_size, 1 << 18);
+    if (sys->buffer_min > sys->buffer_max)
+        sys->buffer_min = sys->buffer_max;
+    sys->buffer_size = sys->buffer_min;
+    sys->bytes_in = sys->bytes_out = 0;
+    sys->underruns = 0;
+    sys->rate_date = sys->underrun_date = mdate();
+
+    sys->mem = vlc_mem_consumer_New(stream, "prefetch buffer");
+    if (unlikely(sys->mem == NULL))
+    {
+        free(sys->content_type);
+        free(sys);
+        return VLC_ENOMEM;
+    }
 
     sys->buffer = malloc(sys->buffer_size);
     if (sys->buffer == NULL)
         goto error;
+    /* The minimum size is granted regardless of the budget */
+    vlc_mutex_lock(&budget_lock);
+    budget_used += sys->buffer_size;
+    vlc_mutex_unlock(&budget_lock);
+    vlc_mem_Charge(sys->mem, sys->buffer_size);
+
+    stream->p_sys = sys;
 
     sys->interrupt = vlc_interrupt_create();
     if (unlikely(sys->interrupt == NULL))
+    {
+        BudgetGive(stream, sys->buffer_size);
         goto error;
+    }
 
     vlc_mutex_init(&sys->lock);
     vlc_cond_init(&sys->wait_data);
     vlc_cond_init(&sys->wait_space);
 
-    stream->p_sys = sys;
-
     if (vlc_clone(&sys->thread, Thread, stream, VLC_THREAD_PRIORITY_LOW))
     {
         vlc_cond_destroy(&sys->wait_space);
         vlc_cond_destroy(&sys->wait_data);
         vlc_mutex_destroy(&sys->lock);
         vlc_interrupt_destroy(sys->interrupt);
+        BudgetGive(stream, sys->buffer_size);
         goto error;
     }
 
-    msg_Dbg(stream, "using %zu bytes buffer, %zu bytes read",
-            sys->buffer_size, sys->read_size);
+    msg_Dbg(stream, "using %zu to %zu bytes buffer, %zu bytes read",
+            sys->buffer_size, sys->buffer_max, sys->read_size);
     stream->pf_read = Read;
     stream->pf_readdir = ReadDir;
     stream->pf_control = Control;
     return VLC_SUCCESS;
 
 error:
+    vlc_mem_consumer_Delete(sys->mem);
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -526,6 +718,8 @@ static void Close (vlc_object_t *obj)
     vlc_cond_destroy(&sys->wait_data);
     vlc_mutex_destroy(&sys->lock);
 
+    BudgetGive(stream, sys->buffer_size);
+    vlc_mem_consumer_Delete(sys->mem);
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -540,8 +734,12 @@ vlc_module_begin()
     set_callbacks(Open, Close)
 
     add_integer("prefetch-buffer-size", 1 << 14, N_("Buffer size"),
-                N_("Prefetch buffer size (KiB)"), false)
+                N_("Maximum prefetch buffer size (KiB)"), false)
         change_integer_range(4, 1 << 20)
+    add_integer("prefetch-budget", 256, N_("Memory budget"),
+                N_("Memory shared by the prefetch buffers of all inputs "
+                   "(MiB, 0 for unlimited)"), true)
+        change_integer_range(0, 1 << 20)
     add_integer("prefetch-read-size", 1 << 14, N_("Read size"),
                 N_("Prefetch background read size (bytes)"), true)
         change_integer_range(1, 1 << 29)
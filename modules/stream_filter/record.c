@@ -32,9 +32,14 @@
 #include <vlc_plugin.h>
 
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <vlc_stream.h>
 #include <vlc_input.h>
 #include <vlc_fs.h>
+#include <vlc_block.h>
 
 
 /*****************************************************************************
@@ -43,21 +48,66 @@
 static int  Open ( vlc_object_t * );
 static void Close( vlc_object_t * );
 
+#define QUEUE_TEXT N_("Record queue size (kB)")
+#define QUEUE_LONGTEXT N_( \
+    "Maximum amount of data waiting to be written to the record file. " \
+    "Data arriving while the queue is full is dropped." )
+#define PREALLOC_TEXT N_("Record preallocation (kB)")
+#define PREALLOC_LONGTEXT N_( \
+    "Disk space reserved ahead of the record file to limit fragmentation " \
+    "(0 disables preallocation)." )
+#define DIRECT_TEXT N_("Direct record I/O")
+#define DIRECT_LONGTEXT N_( \
+    "Write the record file bypassing the operating system page cache." )
+
 vlc_module_begin()
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_STREAM_FILTER )
     set_description( N_("Internal stream record") )
     set_capability( "stream_filter", 0 )
     set_callbacks( Open, Close )
+
+    add_integer( "record-queue-size", 16384, QUEUE_TEXT, QUEUE_LONGTEXT, true )
+        change_integer_range( 64, 1 << 20 )
+    add_integer( "record-prealloc", 8192, PREALLOC_TEXT, PREALLOC_LONGTEXT,
+                 true )
+        change_integer_range( 0, 1 << 20 )
+    add_bool( "record-direct", false, DIRECT_TEXT, DIRECT_LONGTEXT, true )
 vlc_module_end()
 
 /*****************************************************************************
  *
  *****************************************************************************/
+/* O_DIRECT writes must be aligned, in memory, offset and size */
+#define DIRECT_ALIGN 4096
+#define DIRECT_SIZE  (256 * DIRECT_ALIGN)
+
 struct stream_sys_t
 {
-    FILE *f;        /* TODO it could be replaced by access_output_t one day */
-    bool b_error;
+    int fd;         /* -1 when not recording */
+
+    /* Writer thread */
+    vlc_thread_t thread;
+    vlc_mutex_t  lock;
+    vlc_cond_t   wait;
+    block_t     *p_queue;
+    block_t    **pp_queue_last;
+    size_t       i_queued;
+    size_t       i_queue_max;
+    bool         b_stop;
+
+    /* Overflow accounting (protected by lock) */
+    bool         b_overflow;
+    uint64_t     i_dropped;
+    unsigned     i_overflows;
+
+    /* Writer thread private state */
+    bool         b_error;
+    uint64_t     i_written;
+    uint64_t     i_reserved;
+    uint64_t     i_prealloc;
+    uint8_t     *p_direct;  /* aligned staging buffer, NULL without O_DIRECT */
+    size_t       i_direct;
 };
 
 
@@ -70,7 +120,8 @@ static int  Control( stream_t *, int i_query, va_list );
 
 static int  Start  ( stream_t *, const char *psz_extension );
 static int  Stop   ( stream_t * );
-static void Write  ( stream_t *, const uint8_t *p_buffer, size_t i_buffer );
+static void Queue  ( stream_t *, block_t * );
+static void *Thread( void * );
 
 /****************************************************************************
  * Open
@@ -85,7 +136,9 @@ static int Open ( vlc_object_t *p_this )
     if( !p_sys )
         return VLC_ENOMEM;
 
-    p_sys->f = NULL;
+    p_sys->fd = -1;
+    vlc_mutex_init( &p_sys->lock );
+    vlc_cond_init( &p_sys->wait );
 
     /* */
     s->pf_read = Read;
@@ -104,9 +157,11 @@ static void Close( vlc_object_t *p_this )
     stream_t *s = (stream_t*)p_this;
     stream_sys_t *p_sys = s->p_sys;
 
-    if( p_sys->f )
+    if( p_sys->fd != -1 )
         Stop( s );
 
+    vlc_cond_destroy( &p_sys->wait );
+    vlc_mutex_destroy( &p_sys->lock );
     free( p_sys );
 }
 
@@ -116,22 +171,40 @@ static void Close( vlc_object_t *p_this )
 static ssize_t Read( stream_t *s, void *p_read, size_t i_read )
 {
     stream_sys_t *p_sys = s->p_sys;
-    void *p_record = p_read;
 
-    /* Allocate a temporary buffer for record when no p_read */
-    if( p_sys->f && !p_record )
-        p_record = malloc( i_read );
+    if( p_sys->fd == -1 )
+        return vlc_stream_Read( s->p_source, p_read, i_read );
 
-    /* */
-    const ssize_t i_record = vlc_stream_Read( s->p_source, p_record, i_read );
+    /* When skipping, read straight into the block handed to the writer */
+    if( !p_read )
+    {
+        block_t *p_block = block_Alloc( i_read );
+        if( !p_block )
+            return vlc_stream_Read( s->p_source, NULL, i_read );
+
+        const ssize_t i_record = vlc_stream_Read( s->p_source,
+                                                  p_block->p_buffer, i_read );
+        if( i_record > 0 )
+        {
+            p_block->i_buffer = i_record;
+            Queue( s, p_block );
+        }
+        else
+            block_Release( p_block );
+        return i_record;
+    }
+
+    const ssize_t i_record = vlc_stream_Read( s->p_source, p_read, i_read );
 
     /* Dump read data */
-    if( p_sys->f )
+    if( i_record > 0 )
     {
-        if( p_record && i_record > 0 )
-            Write( s, p_record, i_record );
-        if( !p_read )
-            free( p_record );
+        block_t *p_block = block_Alloc( i_record );
+        if( p_block )
+        {
+            memcpy( p_block->p_buffer, p_read, i_record );
+            Queue( s, p_block );
+        }
     }
 
     return i_record;
@@ -153,7 +226,7 @@ static int Control( stream_t *s, int i_query, va_list args )
     if( b_active )
         psz_extension = (const char*)va_arg( args, const char* );
 
-    if( !sys->f == !b_active )
+    if( (sys->fd == -1) == !b_active )
         return VLC_SUCCESS;
 
     if( b_active )
@@ -170,7 +243,7 @@ static int Start( stream_t *s, const char *psz_extension )
     stream_sys_t *p_sys = s->p_sys;
 
     char *psz_file;
-    FILE *f;
+    int fd;
 
     /* */
     if( !psz_extension )
@@ -193,9 +266,55 @@ static int Start( stream_t *s, const char *psz_extension )
     if( !psz_file )
         return VLC_ENOMEM;
 
-    f = vlc_fopen( psz_file, "wb" );
-    if( !f )
+    const int i_flags = O_WRONLY | O_CREAT | O_TRUNC;
+    p_sys->p_direct = NULL;
+    fd = -1;
+#ifdef O_DIRECT
+    if( var_InheritBool( s, "record-direct" ) )
     {
+        p_sys->p_direct = vlc_memalign( DIRECT_ALIGN, DIRECT_SIZE );
+        if( p_sys->p_direct )
+        {
+            /* Not every file system supports it: fall back silently */
+            fd = vlc_open( psz_file, i_flags | O_DIRECT, 0666 );
+            if( fd == -1 )
+            {
+                vlc_free( p_sys->p_direct );
+                p_sys->p_direct = NULL;
+            }
+        }
+    }
+#endif
+    if( fd == -1 )
+        fd = vlc_open( psz_file, i_flags, 0666 );
+    if( fd == -1 )
+    {
+        msg_Err( s, "cannot create %s: %s", psz_file, vlc_strerror_c(errno) );
+        free( psz_file );
+        return VLC_EGENERIC;
+    }
+
+    p_sys->p_queue = NULL;
+    p_sys->pp_queue_last = &p_sys->p_queue;
+    p_sys->i_queued = 0;
+    p_sys->i_queue_max = var_InheritInteger( s, "record-queue-size" ) << 10;
+    p_sys->b_stop = false;
+    p_sys->b_overflow = false;
+    p_sys->i_dropped = 0;
+    p_sys->i_overflows = 0;
+    p_sys->b_error = false;
+    p_sys->i_written = 0;
+    p_sys->i_reserved = 0;
+    p_sys->i_prealloc = var_InheritInteger( s, "record-prealloc" ) << 10;
+    p_sys->i_direct = 0;
+    p_sys->fd = fd;
+
+    if( vlc_clone( &p_sys->thread, Thread, s, VLC_THREAD_PRIORITY_LOW ) )
+    {
+        p_sys->fd = -1;
+        vlc_close( fd );
+        if( p_sys->p_direct )
+            vlc_free( p_sys->p_direct );
         free( psz_file );
         return VLC_EGENERIC;
     }
@@ -203,43 +322,225 @@ static int Start( stream_t *s, const char *psz_extension )
     /* signal new record file */
     var_SetString( s->obj.libvlc, "record-file", psz_file );
 
-    msg_Dbg( s, "Recording into %s", psz_file );
+    msg_Dbg( s, "Recording into %s%s", psz_file,
+             p_sys->p_direct ? " (direct I/O)" : "" );
     free( psz_file );
-
-    /* */
-    p_sys->f = f;
-    p_sys->b_error = false;
     return VLC_SUCCESS;
 }
 static int Stop( stream_t *s )
 {
     stream_sys_t *p_sys = s->p_sys;
 
-    assert( p_sys->f );
-
-    msg_Dbg( s, "Recording completed" );
-    fclose( p_sys->f );
-    p_sys->f = NULL;
+    assert( p_sys->fd != -1 );
+
+    /* The writer drains the queue before exiting */
+    vlc_mutex_lock( &p_sys->lock );
+    p_sys->b_stop = true;
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+    vlc_join( p_sys->thread, NULL );
+
+    /* Give back the space reserved past the end of the file */
+    if( p_sys->i_reserved > p_sys->i_written &&
+        ftruncate( p_sys->fd, p_sys->i_written ) )
+        msg_Warn( s, "cannot release preallocated space: %s",
+                  vlc_strerror_c(errno) );
+
+    if( p_sys->i_dropped > 0 )
+        msg_Warn( s, "Recording dropped %"PRIu64" bytes in %u overflow(s)",
+                  p_sys->i_dropped, p_sys->i_overflows );
+    msg_Dbg( s, "Recording completed (%"PRIu64" bytes)", p_sys->i_written );
+    vlc_close( p_sys->fd );
+    p_sys->fd = -1;
+    if( p_sys->p_direct )
+        vlc_free( p_sys->p_direct );
     return VLC_SUCCESS;
 }
 
+/* Hands a block over to the writer thread without ever blocking on it */
+static void Queue( stream_t *s, block_t *p_block )
+{
+    stream_sys_t *p_sys = s->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    if( p_sys->i_queued + p_block->i_buffer > p_sys->i_queue_max )
+    {
+        if( !p_sys->b_overflow )
+        {
+            p_sys->b_overflow = true;
+            p_sys->i_overflows++;
+            msg_Warn( s, "Recording queue full, dropping data (begin)" );
+        }
+        p_sys->i_dropped += p_block->i_buffer;
+        vlc_mutex_unlock( &p_sys->lock );
+        block_Release( p_block );
+        return;
+    }
+    if( p_sys->b_overflow )
+    {
+        p_sys->b_overflow = false;
+        msg_Warn( s, "Recording queue full, dropping data (end)" );
+    }
+
+    p_sys->i_queued += p_block->i_buffer;
+    block_ChainLastAppend( &p_sys->pp_queue_last, p_block );
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+/****************************************************************************
+ * Writer thread
+ ****************************************************************************/
+static bool WriteAll( int fd, const uint8_t *p_buffer, size_t i_buffer )
+{
+    while( i_buffer > 0 )
+    {
+        ssize_t i_ret = vlc_write( fd, p_buffer, i_buffer );
+        if( i_ret < 0 )
+        {
+            if( errno == EINTR )
+                continue;
+            return false;
+        }
+        p_buffer += i_ret;
+        i_buffer -= i_ret;
+    }
+    return true;
+}
+
+static void Reserve( stream_t *s, size_t i_buffer )
+{
+    stream_sys_t *p_sys = s->p_sys;
+
+    if( p_sys->i_prealloc == 0 ||
+        p_sys->i_written + i_buffer <= p_sys->i_reserved )
+        return;
+#ifdef FALLOC_FL_KEEP_SIZE
+    /* Keep the size so that an interrupted recording has no zero tail */
+    uint64_t i_length = __MAX( p_sys->i_prealloc, i_buffer );
+    if( fallocate( p_sys->fd, FALLOC_FL_KEEP_SIZE,
+                   p_sys->i_reserved, i_length ) == 0 )
+    {
+        p_sys->i_reserved += i_length;
+        return;
+    }
+    msg_Dbg( s, "preallocation not available: %s", vlc_strerror_c(errno) );
+#endif
+    p_sys->i_prealloc = 0;
+}
+
+#ifdef O_DIRECT
+static void DirectDisable( stream_t *s )
+{
+    stream_sys_t *p_sys = s->p_sys;
+    int i_flags = fcntl( p_sys->fd, F_GETFL );
+
+    if( i_flags != -1 )
+        fcntl( p_sys->fd, F_SETFL, i_flags & ~O_DIRECT );
+}
+#endif
+
 static void Write( stream_t *s, const uint8_t *p_buffer, size_t i_buffer )
 {
     stream_sys_t *p_sys = s->p_sys;
 
-    assert( p_sys->f );
+    Reserve( s, i_buffer );
+
+    const bool b_previous_error = p_sys->b_error;
+    p_sys->b_error = !WriteAll( p_sys->fd, p_buffer, i_buffer );
+#ifdef O_DIRECT
+    if( p_sys->b_error && errno == EINVAL && p_sys->p_direct )
+    {
+        /* Alignment constraints not met: retry through the page cache */
+        msg_Dbg( s, "direct I/O rejected, disabling it" );
+        DirectDisable( s );
+        p_sys->b_error = !WriteAll( p_sys->fd, p_buffer, i_buffer );
+    }
+#endif
+    if( !p_sys->b_error )
+        p_sys->i_written += i_buffer;
+
+    /* TODO maybe a intf_UserError or something like that ? */
+    if( p_sys->b_error && !b_previous_error )
+        msg_Err( s, "Failed to record data (begin)" );
+    else if( !p_sys->b_error && b_previous_error )
+        msg_Err( s, "Failed to record data (end)" );
+}
+
+#ifdef O_DIRECT
+/* Stages data in the aligned buffer and writes it out in full chunks */
+static void DirectWrite( stream_t *s, const uint8_t *p_buffer, size_t i_buffer )
+{
+    stream_sys_t *p_sys = s->p_sys;
 
-    if( i_buffer > 0 )
+    while( i_buffer > 0 )
     {
-        const bool b_previous_error = p_sys->b_error;
-        const size_t i_written = fwrite( p_buffer, 1, i_buffer, p_sys->f );
+        size_t i_copy = __MIN( i_buffer, DIRECT_SIZE - p_sys->i_direct );
+
+        memcpy( &p_sys->p_direct[p_sys->i_direct], p_buffer, i_copy );
+        p_sys->i_direct += i_copy;
+        p_buffer += i_copy;
+        i_buffer -= i_copy;
+
+        if( p_sys->i_direct == DIRECT_SIZE )
+        {
+            Write( s, p_sys->p_direct, DIRECT_SIZE );
+            p_sys->i_direct = 0;
+        }
+    }
+}
 
-        p_sys->b_error = i_written != i_buffer;
+/* The unaligned tail cannot be written with O_DIRECT */
+static void DirectFlush( stream_t *s )
+{
+    stream_sys_t *p_sys = s->p_sys;
 
-        /* TODO maybe a intf_UserError or something like that ? */
-        if( p_sys->b_error && !b_previous_error )
-            msg_Err( s, "Failed to record data (begin)" );
-        else if( !p_sys->b_error && b_previous_error )
-            msg_Err( s, "Failed to record data (end)" );
+    DirectDisable( s );
+    if( p_sys->i_direct > 0 )
+        Write( s, p_sys->p_direct, p_sys->i_direct );
+    p_sys->i_direct = 0;
+}
+#endif
+
+static void *Thread( void *data )
+{
+    stream_t *s = data;
+    stream_sys_t *p_sys = s->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    for( ;; )
+    {
+        while( p_sys->p_queue == NULL && !p_sys->b_stop )
+            vlc_cond_wait( &p_sys->wait, &p_sys->lock );
+        if( p_sys->p_queue == NULL )
+            break;
+
+        block_t *p_chain = p_sys->p_queue;
+        p_sys->p_queue = NULL;
+        p_sys->pp_queue_last = &p_sys->p_queue;
+        p_sys->i_queued = 0;
+        vlc_mutex_unlock( &p_sys->lock );
+
+        while( p_chain != NULL )
+        {
+            block_t *p_next = p_chain->p_next;
+#ifdef O_DIRECT
+            if( p_sys->p_direct )
+                DirectWrite( s, p_chain->p_buffer, p_chain->i_buffer );
+            else
+#endif
+                Write( s, p_chain->p_buffer, p_chain->i_buffer );
+            block_Release( p_chain );
+            p_chain = p_next;
+        }
+
+        vlc_mutex_lock( &p_sys->lock );
     }
+    vlc_mutex_unlock( &p_sys->lock );
+
+#ifdef O_DIRECT
+    if( p_sys->p_direct )
+        DirectFlush( s );
+#endif
+    return NULL;
 }
@@ -119,6 +119,8 @@ static int Open( vlc_object_t *p_this )
     p_stream->pf_add  = Add;
     p_stream->pf_del  = Del;
     p_stream->pf_send = Send;
+    /* Nothing is rendered: decode as fast as the input allows */
+    p_stream->pace_nocontrol = true;
     return VLC_SUCCESS;
 }
 
@@ -225,7 +225,7 @@ int sout_stream_sys_t::UpdateOutput( sout_stream_t *p_stream )
     {
         es_changed = false;
 
-        bool canRemux = true;
+        bool canRemuxAudio = true, canRemuxVideo = true;
         vlc_fourcc_t i_codec_video = 0, i_codec_audio = 0;
 
         for (std::vector<sout_stream_id_sys_t*>::iterator it = streams.begin(); it != streams.end(); ++it)
@@ -236,7 +236,7 @@ int sout_stream_sys_t::UpdateOutput( sout_stream_t *p_stream )
                 if (!canDecodeAudio( p_es ))
                 {
                     msg_Dbg( p_stream, "can't remux audio track %d codec %4.4s", p_es->i_id, (const char*)&p_es->i_codec );
-                    canRemux = false;
+                    canRemuxAudio = false;
                 }
                 else if (i_codec_audio == 0)
                     i_codec_audio = p_es->i_codec;
@@ -246,44 +246,55 @@ int sout_stream_sys_t::UpdateOutput( sout_stream_t *p_stream )
                 if (!canDecodeVideo( p_es ))
                 {
                     msg_Dbg( p_stream, "can't remux video track %d codec %4.4s", p_es->i_id, (const char*)&p_es->i_codec );
-                    canRemux = false;
+                    canRemuxVideo = false;
                 }
                 else if (i_codec_video == 0)
                     i_codec_video = p_es->i_codec;
             }
         }
 
+        /* Only transcode the categories the receiver can't decode: the other
+         * elementary streams are passed through to the muxer untouched */
         std::stringstream ssout;
-        if ( !canRemux )
+        if ( !canRemuxAudio || !canRemuxVideo )
         {
-            if ( i_codec_audio == 0 )
-                i_codec_audio = DEFAULT_TRANSCODE_AUDIO;
-            /* avcodec AAC encoder is experimental */
-            if ( i_codec_audio == VLC_CODEC_MP4A ||
-                 i_codec_audio == VLC_FOURCC('h', 'a', 'a', 'c') ||
-                 i_codec_audio == VLC_FOURCC('l', 'a', 'a', 'c') ||
-                 i_codec_audio == VLC_FOURCC('s', 'a', 'a', 'c'))
-                i_codec_audio = DEFAULT_TRANSCODE_AUDIO;
-
-            if ( i_codec_video == 0 )
-                i_codec_video = DEFAULT_TRANSCODE_VIDEO;
-
-            /* TODO: provide audio samplerate and channels */
-            ssout << "transcode{acodec=";
             char s_fourcc[5];
-            vlc_fourcc_to_char( i_codec_audio, s_fourcc );
-            s_fourcc[4] = '\0';
-            ssout << s_fourcc;
-            if ( b_has_video )
+            const char *psz_sep = "";
+
+            ssout << "transcode{";
+            if ( !canRemuxAudio )
             {
+                if ( i_codec_audio == 0 )
+                    i_codec_audio = DEFAULT_TRANSCODE_AUDIO;
+                /* avcodec AAC encoder is experimental */
+                if ( i_codec_audio == VLC_CODEC_MP4A ||
+                     i_codec_audio == VLC_FOURCC('h', 'a', 'a', 'c') ||
+                     i_codec_audio == VLC_FOURCC('l', 'a', 'a', 'c') ||
+                     i_codec_audio == VLC_FOURCC('s', 'a', 'a', 'c'))
+                    i_codec_audio = DEFAULT_TRANSCODE_AUDIO;
+
+                /* TODO: provide audio samplerate and channels */
+                ssout << "acodec=";
+                vlc_fourcc_to_char( i_codec_audio, s_fourcc );
+                s_fourcc[4] = '\0';
+                ssout << s_fourcc;
+                psz_sep = ",";
+            }
+            if ( !canRemuxVideo )
+            {
+                if ( i_codec_video == 0 )
+                    i_codec_video = DEFAULT_TRANSCODE_VIDEO;
+
                 /* TODO: provide maxwidth,maxheight */
-                ssout << ",vcodec=";
+                ssout << psz_sep << "vcodec=";
                 vlc_fourcc_to_char( i_codec_video, s_fourcc );
                 s_fourcc[4] = '\0';
                 ssout << s_fourcc;
             }
             ssout << "}:";
         }
+        else
+            msg_Dbg( p_stream, "remuxing all tracks without transcoding" );
         std::string mime;
         if ( !b_has_video && default_muxer == DEFAULT_MUXER )
             mime = "audio/x-matroska";
@@ -135,6 +135,12 @@
     "This sends and receives RTCP packet multiplexed over the same port " \
     "as RTP packets." )
 
+#define GOP_CACHE_TEXT N_("Start new clients on a key frame")
+#define GOP_CACHE_LONGTEXT N_( \
+    "This keeps the video packets sent since the last key frame, and " \
+    "sends them at once to each new receiver, so that it can start " \
+    "decoding without waiting for the next key frame." )
+
 #define CACHING_TEXT N_("Caching value (ms)")
 #define CACHING_LONGTEXT N_( \
     "Default caching value for outbound RTP streams. This " \
@@ -229,6 +235,8 @@ vlc_module_begin ()
                  TTL_LONGTEXT, true )
     add_bool( SOUT_CFG_PREFIX "rtcp-mux", false,
               RTCP_MUX_TEXT, RTCP_MUX_LONGTEXT, false )
+    add_bool( SOUT_CFG_PREFIX "gop-cache", false,
+              GOP_CACHE_TEXT, GOP_CACHE_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000,
                  CACHING_TEXT, CACHING_LONGTEXT, true )
 
@@ -267,7 +275,7 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "dst", "name", "cat", "port", "port-audio", "port-video", "*sdp", "ttl",
     "mux", "sap", "description", "url", "email", "phone",
-    "proto", "rtcp-mux", "caching",
+    "proto", "rtcp-mux", "gop-cache", "caching",
 #ifdef HAVE_SRTP
     "key", "salt",
 #endif
@@ -389,6 +397,13 @@ struct sout_stream_id_sys_t
 
     block_fifo_t     *p_fifo;
     int64_t           i_caching;
+
+    /* Packets sent since the last key frame, for new sinks */
+    bool              b_gop_cache;
+    bool              b_gop_start; /* next packet starts a key frame */
+    block_t          *p_gop;
+    block_t         **pp_gop_last;
+    size_t            i_gop_size;
 };
 
 /*****************************************************************************
@@ -983,6 +998,12 @@ static sout_stream_id_sys_t *Add( sout_stream_t *p_stream,
     id->listen.fd = NULL;
 
     id->b_first_packet = true;
+    id->b_gop_cache = p_fmt != NULL && p_fmt->i_cat == VIDEO_ES
+                   && var_GetBool( p_stream, SOUT_CFG_PREFIX "gop-cache" );
+    id->b_gop_start = false;
+    id->p_gop = NULL;
+    id->pp_gop_last = &id->p_gop;
+    id->i_gop_size = 0;
     id->i_caching =
         (int64_t)1000 * var_GetInteger( p_stream, SOUT_CFG_PREFIX "caching");
 
@@ -1254,6 +1275,7 @@ static void Del( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
     if( id->srtp != NULL )
         srtp_destroy( id->srtp );
 #endif
+    block_ChainRelease( id->p_gop );
 
     vlc_mutex_destroy( &id->lock_sink );
 
@@ -1286,6 +1308,9 @@ static int Send( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                           p_buffer->i_pts);
         }
 
+        if( id->b_gop_cache && (p_buffer->i_flags & BLOCK_FLAG_TYPE_I) )
+            id->b_gop_start = true;
+
         if( id->rtp_fmt.pf_packetize( id, p_buffer ) )
             break;
 
@@ -1394,52 +1419,168 @@ static int  HttpCallback( httpd_file_sys_t *p_args,
 /****************************************************************************
  * RTP send
  ****************************************************************************/
-static void* ThreadSend( void *data )
-{
 #ifdef _WIN32
 # define ENOBUFS      WSAENOBUFS
 # define EAGAIN       WSAEWOULDBLOCK
 # define EWOULDBLOCK  WSAEWOULDBLOCK
 #endif
+
+/* Maximum number of packets sent together */
+#define RTP_BATCH_MAX 64
+
+/* Handles a failed packet send; returns false if the connection is broken */
+static bool SendError( int fd, const block_t *out )
+{
+    if( net_errno == EAGAIN || net_errno == EWOULDBLOCK
+     || net_errno == ENOBUFS || net_errno == ENOMEM )
+        return true; /* drop the packet */
+
+    int type;
+    getsockopt( fd, SOL_SOCKET, SO_TYPE, &type, &(socklen_t){ sizeof(type) });
+    if( type != SOCK_DGRAM )
+        return false;
+
+    /* ICMP soft error: ignore and retry */
+    send( fd, out->p_buffer, out->i_buffer, 0 );
+    return true;
+}
+
+/* Sends packets to a sink; returns false if the connection is broken */
+static bool SendPackets( int fd, block_t *const *pkv, unsigned pkc )
+{
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgv[RTP_BATCH_MAX];
+    struct iovec iov[RTP_BATCH_MAX];
+
+    assert( pkc <= RTP_BATCH_MAX );
+    memset( msgv, 0, pkc * sizeof (*msgv) );
+    for( unsigned i = 0; i < pkc; i++ )
+    {
+        iov[i].iov_base = pkv[i]->p_buffer;
+        iov[i].iov_len = pkv[i]->i_buffer;
+        msgv[i].msg_hdr.msg_iov = &iov[i];
+        msgv[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    for( unsigned i = 0; i < pkc; )
+    {
+        int val = sendmmsg( fd, msgv + i, pkc - i, 0 );
+        if( val > 0 )
+        {
+            i += val;
+            continue;
+        }
+        if( !SendError( fd, pkv[i] ) )
+            return false;
+        i++; /* skip the failed packet */
+    }
+#else
+    for( unsigned i = 0; i < pkc; i++ )
+        if( send( fd, pkv[i]->p_buffer, pkv[i]->i_buffer, 0 ) == -1
+         && !SendError( fd, pkv[i] ) )
+            return false;
+#endif
+    return true;
+}
+
+/* Upper bound on the cached packets; a longer GOP is not cached */
+#define RTP_GOP_CACHE_MAX (4 << 20)
+
+/* Keeps sent packets for the next sinks, taking ownership of them */
+static void GopCacheAppend( sout_stream_id_sys_t *id,
+                            block_t *const *pkv, unsigned pkc )
+{
+    for( unsigned i = 0; i < pkc; i++ )
+    {
+        block_t *out = pkv[i];
+
+        if( out->i_flags & BLOCK_FLAG_TYPE_I )
+        {   /* New key frame: forget the previous GOP */
+            block_ChainRelease( id->p_gop );
+            id->p_gop = NULL;
+            id->pp_gop_last = &id->p_gop;
+            id->i_gop_size = 0;
+        }
+        else
+        if( id->p_gop == NULL )
+        {   /* No key frame to start from */
+            block_Release( out );
+            continue;
+        }
+        else
+        if( id->i_gop_size + out->i_buffer > RTP_GOP_CACHE_MAX )
+        {
+            block_ChainRelease( id->p_gop );
+            id->p_gop = NULL;
+            id->pp_gop_last = &id->p_gop;
+            id->i_gop_size = 0;
+            block_Release( out );
+            continue;
+        }
+
+        block_ChainLastAppend( &id->pp_gop_last, out );
+        id->i_gop_size += out->i_buffer;
+    }
+}
+
+static void ReleasePackets( void *data )
+{
+    block_t **pkv = data;
+
+    for( unsigned i = 0; i < RTP_BATCH_MAX && pkv[i] != NULL; i++ )
+        block_Release( pkv[i] );
+}
+
+static void* ThreadSend( void *data )
+{
     sout_stream_id_sys_t *id = data;
     unsigned i_caching = id->i_caching;
 
     for (;;)
     {
-        block_t *out = block_FifoGet( id->p_fifo );
-        block_cleanup_push (out);
+        block_t *pkv[RTP_BATCH_MAX] = { NULL };
+        unsigned pkc = 0;
+        mtime_t i_date = 0;
+
+        vlc_cleanup_push( ReleasePackets, pkv );
 
+        /* Gather the packets already queued that are due at the same time,
+         * typically those of a single frame, to send them together. */
+        do
+        {
+            block_t *out = block_FifoGet( id->p_fifo );
 #ifdef HAVE_SRTP
-        if( id->srtp )
-        {   /* FIXME: this is awfully inefficient */
-            size_t len = out->i_buffer;
-            out = block_Realloc( out, 0, len + 10 );
-            out->i_buffer = len;
-
-            int canc = vlc_savecancel ();
-            int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
-            vlc_restorecancel (canc);
-            if( val )
-            {
-                msg_Dbg( id->p_stream, "SRTP sending error: %s",
-                         vlc_strerror_c(val) );
-                block_Release( out );
-                out = NULL;
-            }
-            else
+            if( id->srtp )
+            {   /* FIXME: this is awfully inefficient */
+                size_t len = out->i_buffer;
+                out = block_Realloc( out, 0, len + 10 );
                 out->i_buffer = len;
+
+                int canc = vlc_savecancel ();
+                int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
+                vlc_restorecancel (canc);
+                if( val )
+                {
+                    msg_Dbg( id->p_stream, "SRTP sending error: %s",
+                             vlc_strerror_c(val) );
+                    block_Release( out );
+                    continue;
+                }
+                out->i_buffer = len;
+            }
+#endif
+            if( pkc == 0 )
+                i_date = out->i_dts + i_caching;
+            pkv[pkc++] = out;
         }
-        if (out)
-            mwait (out->i_dts + i_caching);
-        vlc_cleanup_pop ();
-        if (out == NULL)
-            continue;
-#else
-        mwait (out->i_dts + i_caching);
+        while( pkc == 0 || (pkc < RTP_BATCH_MAX
+                         && block_FifoCount( id->p_fifo ) > 0
+                         && block_FifoShow( id->p_fifo )->i_dts + i_caching
+                            <= i_date) );
+
+        mwait( i_date );
         vlc_cleanup_pop ();
-#endif
 
-        ssize_t len = out->i_buffer;
         int canc = vlc_savecancel ();
 
         vlc_mutex_lock( &id->lock_sink );
@@ -1451,26 +1592,19 @@ static void* ThreadSend( void *data )
 #ifdef HAVE_SRTP
             if( !id->srtp ) /* FIXME: SRTCP support */
 #endif
-                SendRTCP( id->sinkv[i].rtcp, out );
+                for( unsigned j = 0; j < pkc; j++ )
+                    SendRTCP( id->sinkv[i].rtcp, pkv[j] );
 
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
-            {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
-            }
+            if( !SendPackets( id->sinkv[i].rtp_fd, pkv, pkc ) )
+                /* Broken connection */
+                deadv[deadc++] = id->sinkv[i].rtp_fd;
         }
-        id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
+        id->i_seq_sent_next = ntohs(((uint16_t *) pkv[pkc - 1]->p_buffer)[1]) + 1;
+        if( id->b_gop_cache )
+            GopCacheAppend( id, pkv, pkc );
         vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
+        if( !id->b_gop_cache )
+            ReleasePackets( pkv );
 
         for( unsigned i = 0; i < deadc; i++ )
         {
@@ -1516,6 +1650,28 @@ int rtp_add_sink( sout_stream_id_sys_t *id, int fd, bool rtcp_mux, uint16_t *seq
     INSERT_ELEM( id->sinkv, id->sinkc, id->sinkc, sink );
     if( seq != NULL )
         *seq = id->i_seq_sent_next;
+
+    /* Catch up from the last key frame, so the sink can start decoding
+     * right away. The sequence then starts from the cached packets. */
+    if( id->p_gop != NULL )
+    {
+        block_t *pkv[RTP_BATCH_MAX];
+        unsigned pkc = 0;
+
+        if( seq != NULL )
+            *seq = ntohs(((uint16_t *) id->p_gop->p_buffer)[1]);
+
+        for( block_t *out = id->p_gop; out != NULL; out = out->p_next )
+        {
+            pkv[pkc++] = out;
+            if( pkc == RTP_BATCH_MAX || out->p_next == NULL )
+            {
+                if( !SendPackets( fd, pkv, pkc ) )
+                    break;
+                pkc = 0;
+            }
+        }
+    }
     vlc_mutex_unlock( &id->lock_sink );
     return VLC_SUCCESS;
 }
@@ -1661,6 +1817,11 @@ uint16_t rtp_get_extended_sequence( sout_stream_id_sys_t *id )
 
 void rtp_packetize_send( sout_stream_id_sys_t *id, block_t *out )
 {
+    if( id->b_gop_start )
+    {   /* Mark the first packet of the key frame */
+        out->i_flags |= BLOCK_FLAG_TYPE_I;
+        id->b_gop_start = false;
+    }
     block_FifoPut( id->p_fifo, out );
 }
 
@@ -37,6 +37,10 @@
  *
  * the video-data and audio-data pointers will be passed to lock/unlock function
  *
+ * Alternatively, the packet callback receives the blocks of every elementary
+ * stream as they are, without copy, e.g. with:
+ * --sout="#smem{packet-callback=...,packet-data=...}"
+ *
  ******************************************************************************/
 
 /*****************************************************************************
@@ -80,6 +84,13 @@
 #define T_AUDIO_DATA N_( "Audio callback data" )
 #define LT_AUDIO_DATA N_( "Data for the audio callback function." )
 
+#define T_PACKET_CALLBACK N_( "Packet callback" )
+#define LT_PACKET_CALLBACK N_( "Address of the packet callback function. " \
+                               "This function will be given every block, without copy." )
+
+#define T_PACKET_DATA N_( "Packet callback data" )
+#define LT_PACKET_DATA N_( "Data for the packet callback function." )
+
 #define T_TIME_SYNC N_( "Time Synchronized output" )
 #define LT_TIME_SYNC N_( "Time Synchronisation option for output. " \
                         "If true, stream will render as usual, else " \
@@ -111,6 +122,10 @@ vlc_module_begin ()
         change_volatile()
     add_string( SOUT_PREFIX_AUDIO "data", "0", T_AUDIO_DATA, LT_VIDEO_DATA, true )
         change_volatile()
+    add_string( SOUT_CFG_PREFIX "packet-callback", "0", T_PACKET_CALLBACK, LT_PACKET_CALLBACK, true )
+        change_volatile()
+    add_string( SOUT_CFG_PREFIX "packet-data", "0", T_PACKET_DATA, LT_PACKET_DATA, true )
+        change_volatile()
     add_bool( SOUT_CFG_PREFIX "time-sync", true, T_TIME_SYNC, LT_TIME_SYNC, true )
         change_private()
     set_callbacks( Open, Close )
@@ -122,7 +137,8 @@ vlc_module_end ()
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
     "video-prerender-callback", "audio-prerender-callback",
-    "video-postrender-callback", "audio-postrender-callback", "video-data", "audio-data", "time-sync", NULL
+    "video-postrender-callback", "audio-postrender-callback", "video-data", "audio-data", "time-sync",
+    "packet-callback", "packet-data", NULL
 };
 
 static sout_stream_id_sys_t *Add( sout_stream_t *, const es_format_t * );
@@ -139,12 +155,43 @@ static int SendVideo( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 static int SendAudio( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                       block_t *p_buffer );
 
+static sout_stream_id_sys_t *AddPacket( sout_stream_t *p_stream,
+                                        const es_format_t *p_fmt );
+static int SendPacket( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                       block_t *p_buffer );
+
 struct sout_stream_id_sys_t
 {
     es_format_t* format;
     void *p_data;
 };
 
+/* NOTE: the layout must match that of libvlc_packet_t */
+struct smem_packet
+{
+    int            i_id;
+    int            type;
+    uint32_t       codec;
+    const uint8_t *p_data;
+    size_t         i_size;
+    int64_t        pts;
+    int64_t        dts;
+    int64_t        length;
+    unsigned       flags;
+    void         (*release)( struct smem_packet * );
+
+    block_t       *p_block; /* held until released */
+};
+
+/* libvlc_track_type_t and LIBVLC_PACKET_* values */
+#define SMEM_TRACK_UNKNOWN        (-1)
+#define SMEM_TRACK_AUDIO          0
+#define SMEM_TRACK_VIDEO          1
+#define SMEM_TRACK_TEXT           2
+#define SMEM_PACKET_KEYFRAME      0x1
+#define SMEM_PACKET_DISCONTINUITY 0x2
+#define SMEM_PACKET_CORRUPTED     0x4
+
 struct sout_stream_sys_t
 {
     vlc_mutex_t *p_lock;
@@ -152,6 +199,8 @@ struct sout_stream_sys_t
     void ( *pf_audio_prerender_callback ) ( void* p_audio_data, uint8_t** pp_pcm_buffer, size_t size );
     void ( *pf_video_postrender_callback ) ( void* p_video_data, uint8_t* p_pixel_buffer, int width, int height, int pixel_pitch, size_t size, mtime_t pts );
     void ( *pf_audio_postrender_callback ) ( void* p_audio_data, uint8_t* p_pcm_buffer, unsigned int channels, unsigned int rate, unsigned int nb_samples, unsigned int bits_per_sample, size_t size, mtime_t pts );
+    void ( *pf_packet_callback ) ( void* p_packet_data, struct smem_packet *p_packet );
+    void *p_packet_data;
     bool time_sync;
 };
 
@@ -237,10 +286,27 @@ static int Open( vlc_object_t *p_this )
     if (p_sys->pf_audio_postrender_callback == NULL)
         p_sys->pf_audio_postrender_callback = AudioPostrenderDefaultCallback;
 
+    psz_tmp = var_GetString( p_stream, SOUT_CFG_PREFIX "packet-callback" );
+    p_sys->pf_packet_callback = (void (*) (void*, struct smem_packet *))(intptr_t)atoll( psz_tmp );
+    free( psz_tmp );
+
+    psz_tmp = var_GetString( p_stream, SOUT_CFG_PREFIX "packet-data" );
+    p_sys->p_packet_data = (void *)( intptr_t )atoll( psz_tmp );
+    free( psz_tmp );
+
     /* Setting stream out module callbacks */
-    p_stream->pf_add    = Add;
-    p_stream->pf_del    = Del;
-    p_stream->pf_send   = Send;
+    if( p_sys->pf_packet_callback != NULL )
+    {
+        p_stream->pf_add    = AddPacket;
+        p_stream->pf_del    = Del;
+        p_stream->pf_send   = SendPacket;
+    }
+    else
+    {
+        p_stream->pf_add    = Add;
+        p_stream->pf_del    = Del;
+        p_stream->pf_send   = Send;
+    }
     p_stream->pace_nocontrol = p_sys->time_sync;
 
     return VLC_SUCCESS;
@@ -422,3 +488,72 @@ static int SendAudio( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
     return VLC_SUCCESS;
 }
 
+static sout_stream_id_sys_t *AddPacket( sout_stream_t *p_stream,
+                                        const es_format_t *p_fmt )
+{
+    VLC_UNUSED( p_stream );
+    sout_stream_id_sys_t *id = calloc( 1, sizeof( sout_stream_id_sys_t ) );
+    if( !id )
+        return NULL;
+
+    id->format = (es_format_t *)p_fmt;
+    return id;
+}
+
+static void PacketRelease( struct smem_packet *p_packet )
+{
+    block_Release( p_packet->p_block );
+    free( p_packet );
+}
+
+static int SendPacket( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                       block_t *p_buffer )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    int type;
+
+    switch( id->format->i_cat )
+    {
+        case AUDIO_ES: type = SMEM_TRACK_AUDIO; break;
+        case VIDEO_ES: type = SMEM_TRACK_VIDEO; break;
+        case SPU_ES:   type = SMEM_TRACK_TEXT; break;
+        default:       type = SMEM_TRACK_UNKNOWN; break;
+    }
+
+    while( p_buffer != NULL )
+    {
+        block_t *p_next = p_buffer->p_next;
+        p_buffer->p_next = NULL;
+
+        struct smem_packet *p_packet = malloc( sizeof( *p_packet ) );
+        if( unlikely(p_packet == NULL) )
+        {
+            block_Release( p_buffer );
+            block_ChainRelease( p_next );
+            return VLC_ENOMEM;
+        }
+
+        /* Handing the block itself: no copy */
+        p_packet->i_id = id->format->i_id;
+        p_packet->type = type;
+        p_packet->codec = id->format->i_codec;
+        p_packet->p_data = p_buffer->p_buffer;
+        p_packet->i_size = p_buffer->i_buffer;
+        p_packet->pts = p_buffer->i_pts;
+        p_packet->dts = p_buffer->i_dts;
+        p_packet->length = p_buffer->i_length;
+        p_packet->flags = 0;
+        if( p_buffer->i_flags & BLOCK_FLAG_TYPE_I )
+            p_packet->flags |= SMEM_PACKET_KEYFRAME;
+        if( p_buffer->i_flags & BLOCK_FLAG_DISCONTINUITY )
+            p_packet->flags |= SMEM_PACKET_DISCONTINUITY;
+        if( p_buffer->i_flags & BLOCK_FLAG_CORRUPTED )
+            p_packet->flags |= SMEM_PACKET_CORRUPTED;
+        p_packet->release = PacketRelease;
+        p_packet->p_block = p_buffer;
+
+        p_sys->pf_packet_callback( p_sys->p_packet_data, p_packet );
+        p_buffer = p_next;
+    }
+    return VLC_SUCCESS;
+}
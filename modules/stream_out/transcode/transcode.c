@@ -76,6 +76,13 @@
 #define MAXHEIGHT_TEXT N_("Maximum video height")
 #define MAXHEIGHT_LONGTEXT N_( \
     "Maximum output video height." )
+#define LADDER_TEXT N_("Video renditions")
+#define LADDER_LONGTEXT N_( \
+    "Comma-separated list of additional video renditions, as " \
+    "[width]x[height][@bitrate] (eg: x720@2500,x480@1200,640x360@800). " \
+    "The pictures are decoded and filtered once, then scaled and encoded " \
+    "for every rendition in its own thread. The rendition n is output with " \
+    "the ES id of the video plus n*1000." )
 #define VFILTER_TEXT N_("Video filter")
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
@@ -131,6 +138,10 @@
 #define HP_LONGTEXT N_( \
     "Runs the optional encoder thread at the OUTPUT priority instead of " \
     "VIDEO." )
+#define ASYNC_TEXT N_("Asynchronous decoding")
+#define ASYNC_LONGTEXT N_( \
+    "Decodes, filters and (for audio) encodes every transcoded audio and " \
+    "video stream in its own thread, fed with at most pool-size blocks." )
 #define POOL_TEXT N_("Picture pool size")
 #define POOL_LONGTEXT N_( "Defines how many pictures we allow to be in pool "\
     "between decoder/encoder threads when threads > 0" )
@@ -182,6 +193,8 @@ vlc_module_begin ()
                  MAXHEIGHT_LONGTEXT, true )
     add_module_list( SOUT_CFG_PREFIX "vfilter", "video filter",
                      NULL, VFILTER_TEXT, VFILTER_LONGTEXT, false )
+    add_string( SOUT_CFG_PREFIX "ladder", NULL, LADDER_TEXT,
+                LADDER_LONGTEXT, true )
 
     set_section( N_("Audio"), NULL )
     add_module( SOUT_CFG_PREFIX "aenc", "encoder", NULL, AENC_TEXT,
@@ -223,6 +236,8 @@ vlc_module_begin ()
         change_integer_range( 1, 1000 )
     add_bool( SOUT_CFG_PREFIX "high-priority", false, HP_TEXT, HP_LONGTEXT,
               true )
+    add_bool( SOUT_CFG_PREFIX "async", false, ASYNC_TEXT, ASYNC_LONGTEXT,
+              true )
 
 vlc_module_end ()
 
@@ -232,7 +247,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "osd", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "ladder", "async", NULL
 };
 
 /*****************************************************************************
@@ -242,6 +257,50 @@ static sout_stream_id_sys_t *Add( sout_stream_t *, const es_format_t * );
 static void              Del ( sout_stream_t *, sout_stream_id_sys_t * );
 static int               Send( sout_stream_t *, sout_stream_id_sys_t *, block_t* );
 
+static int  AsyncStart( sout_stream_t *, sout_stream_id_sys_t * );
+static void AsyncStop ( sout_stream_id_sys_t * );
+
+/*****************************************************************************
+ * ParseLadder: parses the list of additional video renditions
+ *****************************************************************************/
+static void ParseLadder( sout_stream_t *p_stream, sout_stream_sys_t *p_sys,
+                         char *psz_ladder )
+{
+    char *psz_save;
+
+    for( char *psz = strtok_r( psz_ladder, ",", &psz_save ); psz != NULL;
+         psz = strtok_r( NULL, ",", &psz_save ) )
+    {
+        transcode_rendition_t rendition = { 0, 0, 0 };
+        char *psz_end;
+
+        rendition.i_width = strtoul( psz, &psz_end, 10 );
+        if( *psz_end == 'x' )
+            rendition.i_height = strtoul( psz_end + 1, &psz_end, 10 );
+        if( *psz_end == '@' )
+            rendition.i_bitrate = strtol( psz_end + 1, &psz_end, 10 );
+
+        if( *psz_end != '\0' ||
+            ( rendition.i_width == 0 && rendition.i_height == 0 ) )
+        {
+            msg_Warn( p_stream, "invalid video rendition `%s'", psz );
+            continue;
+        }
+        if( rendition.i_bitrate < 16000 ) rendition.i_bitrate *= 1000;
+
+        transcode_rendition_t *p_ladder =
+            realloc( p_sys->p_ladder,
+                     ( p_sys->i_ladder + 1 ) * sizeof( *p_ladder ) );
+        if( !p_ladder )
+            break;
+        p_ladder[p_sys->i_ladder++] = rendition;
+        p_sys->p_ladder = p_ladder;
+
+        msg_Dbg( p_stream, "video rendition %ux%u %dkb/s", rendition.i_width,
+                 rendition.i_height, rendition.i_bitrate / 1000 );
+    }
+}
+
 /*****************************************************************************
  * Open:
  *****************************************************************************/
@@ -363,6 +422,11 @@ static int Open( vlc_object_t *p_this )
         p_sys->psz_vf2 = NULL;
     free( psz_string );
 
+    psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "ladder" );
+    if( psz_string && *psz_string )
+        ParseLadder( p_stream, p_sys, psz_string );
+    free( psz_string );
+
     p_sys->b_deinterlace = var_GetBool( p_stream, SOUT_CFG_PREFIX "deinterlace" );
 
     psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "deinterlace-module" );
@@ -381,6 +445,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_threads = var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" );
     p_sys->pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
     p_sys->b_high_priority = var_GetBool( p_stream, SOUT_CFG_PREFIX "high-priority" );
+    p_sys->b_async = var_GetBool( p_stream, SOUT_CFG_PREFIX "async" );
 
     if( p_sys->i_vcodec )
     {
@@ -491,6 +556,7 @@ static void Close( vlc_object_t * p_this )
     free( p_sys->psz_alang );
 
     free( p_sys->psz_vf2 );
+    free( p_sys->p_ladder );
 
     config_ChainDestroy( p_sys->p_video_cfg );
     free( p_sys->psz_venc );
@@ -572,6 +638,11 @@ static sout_stream_id_sys_t *Add( sout_stream_t *p_stream,
     if(!success)
         goto error;
 
+    if( id->b_transcode && p_sys->b_async &&
+        ( p_fmt->i_cat == AUDIO_ES || p_fmt->i_cat == VIDEO_ES ) &&
+        AsyncStart( p_stream, id ) != VLC_SUCCESS )
+        msg_Warn( p_stream, "cannot decode asynchronously" );
+
     return id;
 
 error:
@@ -599,6 +670,18 @@ static void Del( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
 {
     sout_stream_sys_t *p_sys = p_stream->p_sys;
 
+    /* Stop decoding asynchronously first, as it may clear b_transcode. The
+     * encoders are then flushed from here. */
+    if( id->b_async )
+    {
+        AsyncStop( id );
+        if( id->p_async_out && id->id )
+            sout_StreamIdSend( p_stream->p_next, id->id, id->p_async_out );
+        else
+            block_ChainRelease( id->p_async_out );
+        id->p_async_out = NULL;
+    }
+
     if( id->b_transcode )
     {
         switch( id->p_decoder->fmt_in.i_cat )
@@ -637,62 +720,158 @@ static void Del( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
     free( id );
 }
 
-static int Send( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
-                 block_t *p_buffer )
+static int Process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                    block_t *p_buffer, block_t **pp_out )
 {
     sout_stream_sys_t *p_sys = p_stream->p_sys;
-    block_t *p_out = NULL;
-
-    if( !id->b_transcode )
-    {
-        if( id->id )
-            return sout_StreamIdSend( p_stream->p_next, id->id, p_buffer );
 
-        block_Release( p_buffer );
-        return VLC_EGENERIC;
-    }
+    *pp_out = NULL;
 
     switch( id->p_decoder->fmt_in.i_cat )
     {
     case AUDIO_ES:
-        if( transcode_audio_process( p_stream, id, p_buffer, &p_out )
-            != VLC_SUCCESS )
-        {
-            return VLC_EGENERIC;
-        }
-        break;
+        return transcode_audio_process( p_stream, id, p_buffer, pp_out );
 
     case VIDEO_ES:
-        if( transcode_video_process( p_stream, id, p_buffer, &p_out )
-            != VLC_SUCCESS )
-        {
-            return VLC_EGENERIC;
-        }
-        break;
+        return transcode_video_process( p_stream, id, p_buffer, pp_out );
 
     case SPU_ES:
         /* Transcode OSD menu pictures. */
         if( p_sys->b_osd )
-        {
-            if( transcode_osd_process( p_stream, id, p_buffer, &p_out ) !=
-                VLC_SUCCESS )
-            {
-                return VLC_EGENERIC;
-            }
-        }
-        else if ( transcode_spu_process( p_stream, id, p_buffer, &p_out ) !=
-            VLC_SUCCESS )
-        {
-            return VLC_EGENERIC;
-        }
-        break;
+            return transcode_osd_process( p_stream, id, p_buffer, pp_out );
+        return transcode_spu_process( p_stream, id, p_buffer, pp_out );
 
     default:
-        p_out = NULL;
+        if( p_buffer )
+            block_Release( p_buffer );
+        return VLC_SUCCESS;
+    }
+}
+
+static void *AsyncThread( void *data )
+{
+    sout_stream_id_sys_t *id = data;
+    vlc_fifo_t *p_fifo = id->p_async_in;
+    int canc = vlc_savecancel();
+
+    vlc_fifo_Lock( p_fifo );
+    for( ;; )
+    {
+        block_t *p_block, *p_out = NULL;
+
+        while( vlc_fifo_IsEmpty( p_fifo ) && !id->b_async_eos )
+            vlc_fifo_Wait( p_fifo );
+
+        p_block = vlc_fifo_DequeueUnlocked( p_fifo );
+        if( p_block == NULL )
+            break;
+        vlc_cond_signal( &id->async_room );
+        vlc_fifo_Unlock( p_fifo );
+
+        /* The video decoder may give up on transcoding from its own
+         * thread: this one is the only one to look at b_transcode */
+        if( id->b_transcode )
+            Process( id->p_stream, id, p_block, &p_out );
+        else
+            block_Release( p_block );
+
+        vlc_fifo_Lock( p_fifo );
+        block_ChainAppend( &id->p_async_out, p_out );
+        if( id->b_transcode && id->p_decoder->fmt_in.i_cat == VIDEO_ES )
+            id->i_async_rungs = id->i_rungs;
+    }
+    vlc_fifo_Unlock( p_fifo );
+
+    vlc_restorecancel( canc );
+    return NULL;
+}
+
+static int AsyncStart( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
+{
+    id->p_async_in = block_FifoNew();
+    if( !id->p_async_in )
+        return VLC_ENOMEM;
+
+    id->p_stream = p_stream;
+    id->p_async_out = NULL;
+    id->b_async_eos = false;
+    id->i_async_rungs = 0;
+    vlc_cond_init( &id->async_room );
+    id->b_async = true;
+
+    int i_priority = id->p_decoder->fmt_in.i_cat == AUDIO_ES ?
+                     VLC_THREAD_PRIORITY_AUDIO : VLC_THREAD_PRIORITY_VIDEO;
+    if( vlc_clone( &id->async_thread, AsyncThread, id, i_priority ) )
+    {
+        id->b_async = false;
+        vlc_cond_destroy( &id->async_room );
+        block_FifoRelease( id->p_async_in );
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+/* Decodes all the queued blocks and stops the thread. Its last output is
+ * left in p_async_out. */
+static void AsyncStop( sout_stream_id_sys_t *id )
+{
+    vlc_fifo_Lock( id->p_async_in );
+    id->b_async_eos = true;
+    vlc_fifo_Signal( id->p_async_in );
+    vlc_fifo_Unlock( id->p_async_in );
+
+    vlc_join( id->async_thread, NULL );
+
+    vlc_cond_destroy( &id->async_room );
+    block_FifoRelease( id->p_async_in );
+    id->b_async = false;
+}
+
+static int SendAsync( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                      block_t *p_buffer )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    vlc_fifo_t *p_fifo = id->p_async_in;
+    block_t *p_out;
+    unsigned i_rungs;
+
+    vlc_fifo_Lock( p_fifo );
+    while( vlc_fifo_GetCount( p_fifo ) >= p_sys->pool_size )
+        vlc_fifo_WaitCond( p_fifo, &id->async_room );
+    vlc_fifo_QueueUnlocked( p_fifo, p_buffer );
+
+    p_out = id->p_async_out;
+    id->p_async_out = NULL;
+    i_rungs = id->i_async_rungs;
+    vlc_fifo_Unlock( p_fifo );
+
+    if( i_rungs > 0 )
+        transcode_video_rungs_output( p_stream, id, i_rungs, false );
+    if( p_out )
+        return sout_StreamIdSend( p_stream->p_next, id->id, p_out );
+    return VLC_SUCCESS;
+}
+
+static int Send( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                 block_t *p_buffer )
+{
+    block_t *p_out = NULL;
+
+    if( id->b_async )
+        return SendAsync( p_stream, id, p_buffer );
+
+    if( !id->b_transcode )
+    {
+        if( id->id )
+            return sout_StreamIdSend( p_stream->p_next, id->id, p_buffer );
+
         block_Release( p_buffer );
-        break;
+        return VLC_EGENERIC;
     }
 
+    if( Process( p_stream, id, p_buffer, &p_out ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
     if( p_out )
         return sout_StreamIdSend( p_stream->p_next, id->id, p_out );
     return VLC_SUCCESS;
@@ -14,6 +14,38 @@
 /*100ms is around the limit where people are noticing lipsync issues*/
 #define MASTER_SYNC_MAX_DRIFT 100000
 
+/* Offset between the ES ids of the renditions of a ladder */
+#define LADDER_ES_ID_OFFSET 1000
+
+/* Requested parameters of an additional video rendition */
+typedef struct
+{
+    unsigned int    i_width;    /* 0 to keep the aspect ratio */
+    unsigned int    i_height;   /* 0 to keep the aspect ratio */
+    int             i_bitrate;  /* 0 for the main video bitrate */
+} transcode_rendition_t;
+
+/* Additional video rendition, scaled and encoded from the pictures of the
+ * main video encoder */
+typedef struct
+{
+    sout_stream_t   *p_stream;
+    encoder_t       *p_encoder;
+    filter_chain_t  *p_chain; /**< Scaling and chroma conversion */
+    video_format_t  fmt_src; /**< Input format of p_chain */
+
+    /* id of the out stream */
+    void            *id;
+
+    block_t         *p_buffers;
+    vlc_mutex_t     lock_out;
+    vlc_cond_t      cond;
+    bool            b_abort;
+    picture_fifo_t  *pp_pics;
+    vlc_sem_t       picture_pool_has_room;
+    vlc_thread_t    thread;
+} transcode_rung_t;
+
 struct sout_stream_sys_t
 {
     sout_stream_id_sys_t *id_video;
@@ -25,6 +57,7 @@ struct sout_stream_sys_t
     vlc_sem_t       picture_pool_has_room;
     uint32_t        pool_size;
     vlc_thread_t    thread;
+    bool            b_async;
 
     /* Audio */
     vlc_fourcc_t    i_acodec;   /* codec audio (0 if not transcode) */
@@ -55,6 +88,9 @@ struct sout_stream_sys_t
 
     char            *psz_vf2;
 
+    transcode_rendition_t *p_ladder;
+    unsigned int    i_ladder;
+
     /* SPU */
     vlc_fourcc_t    i_scodec;   /* codec spu (0 if not transcode) */
     char            *psz_senc;
@@ -94,6 +130,8 @@ struct sout_stream_id_sys_t
              filter_chain_t  *p_f_chain; /**< Video filters */
              filter_chain_t  *p_uf_chain; /**< User-specified video filters */
              video_format_t  fmt_input_video;
+             transcode_rung_t *p_rungs; /**< Additional renditions */
+             unsigned int    i_rungs;
          };
          struct
          {
@@ -110,6 +148,15 @@ struct sout_stream_id_sys_t
     date_t          next_input_pts; /**< Incoming calculated PTS */
     date_t          next_output_pts; /**< output calculated PTS */
 
+    /* Asynchronous decoding */
+    bool            b_async;
+    sout_stream_t   *p_stream;
+    vlc_thread_t    async_thread;
+    block_fifo_t    *p_async_in; /**< Blocks to decode */
+    vlc_cond_t      async_room; /**< Signaled when a block is dequeued */
+    block_t         *p_async_out; /**< Encoded blocks, to send downstream */
+    bool            b_async_eos;
+    unsigned int    i_async_rungs; /**< Renditions opened so far */
 };
 
 /* OSD */
@@ -145,3 +192,5 @@ int  transcode_video_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
 bool transcode_video_add    ( sout_stream_t *, const es_format_t *,
                                 sout_stream_id_sys_t *);
+void transcode_video_rungs_output( sout_stream_t *, sout_stream_id_sys_t *,
+                                   unsigned, bool );
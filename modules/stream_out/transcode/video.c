@@ -611,6 +611,373 @@ static int transcode_video_encoder_open( sout_stream_t *p_stream,
     return VLC_SUCCESS;
 }
 
+/* Scales a picture of the main encoder to the format of a rendition and
+ * encodes it. The chain is (re)built from the format of the picture, so that
+ * it is only ever used by the thread encoding the rendition. */
+static block_t *transcode_rung_encode( sout_stream_t *p_stream,
+                                       transcode_rung_t *p_rung,
+                                       picture_t *p_pic )
+{
+    if( p_rung->p_chain == NULL ||
+        !video_format_IsSimilar( &p_rung->fmt_src, &p_pic->format ) )
+    {
+        filter_owner_t owner = {
+            .sys = p_stream->p_sys,
+            .video = {
+                .buffer_new = transcode_video_filter_buffer_new,
+            },
+        };
+        es_format_t fmt_src;
+
+        if( p_rung->p_chain == NULL )
+            p_rung->p_chain = filter_chain_NewVideo( p_stream, false, &owner );
+        if( p_rung->p_chain == NULL )
+        {
+            picture_Release( p_pic );
+            return NULL;
+        }
+
+        es_format_Init( &fmt_src, VIDEO_ES, p_pic->format.i_chroma );
+        fmt_src.video = p_pic->format;
+        p_rung->fmt_src = p_pic->format;
+
+        filter_chain_Reset( p_rung->p_chain, &fmt_src,
+                            &p_rung->p_encoder->fmt_in );
+        if( !video_format_IsSimilar( &p_pic->format,
+                                     &p_rung->p_encoder->fmt_in.video ) &&
+            filter_chain_AppendFilter( p_rung->p_chain, NULL, NULL, &fmt_src,
+                                       &p_rung->p_encoder->fmt_in ) == NULL )
+            msg_Err( p_stream, "cannot scale %ux%u to %ux%u",
+                     p_pic->format.i_visible_width,
+                     p_pic->format.i_visible_height,
+                     p_rung->p_encoder->fmt_in.video.i_visible_width,
+                     p_rung->p_encoder->fmt_in.video.i_visible_height );
+    }
+
+    if( filter_chain_GetLength( p_rung->p_chain ) > 0 )
+    {
+        p_pic = filter_chain_VideoFilter( p_rung->p_chain, p_pic );
+        if( p_pic == NULL )
+            return NULL;
+    }
+    else if( !video_format_IsSimilar( &p_pic->format,
+                                      &p_rung->p_encoder->fmt_in.video ) )
+    {
+        picture_Release( p_pic );
+        return NULL;
+    }
+
+    block_t *p_block = p_rung->p_encoder->pf_encode_video( p_rung->p_encoder,
+                                                           p_pic );
+    picture_Release( p_pic );
+    return p_block;
+}
+
+static void* RungThread( void *obj )
+{
+    transcode_rung_t *p_rung = obj;
+    sout_stream_t *p_stream = p_rung->p_stream;
+    picture_t *p_pic = NULL;
+    int canc = vlc_savecancel ();
+    block_t *p_block = NULL;
+
+    vlc_mutex_lock( &p_rung->lock_out );
+
+    for( ;; )
+    {
+        while( !p_rung->b_abort &&
+               (p_pic = picture_fifo_Pop( p_rung->pp_pics )) == NULL )
+            vlc_cond_wait( &p_rung->cond, &p_rung->lock_out );
+
+        if( p_pic )
+        {
+            vlc_sem_post( &p_rung->picture_pool_has_room );
+
+            /* release lock while scaling and encoding */
+            vlc_mutex_unlock( &p_rung->lock_out );
+            p_block = transcode_rung_encode( p_stream, p_rung, p_pic );
+            vlc_mutex_lock( &p_rung->lock_out );
+
+            block_ChainAppend( &p_rung->p_buffers, p_block );
+        }
+
+        if( p_rung->b_abort )
+            break;
+    }
+
+    /*Encode what we have in the buffer on closing*/
+    while( (p_pic = picture_fifo_Pop( p_rung->pp_pics )) != NULL )
+    {
+        vlc_sem_post( &p_rung->picture_pool_has_room );
+        p_block = transcode_rung_encode( p_stream, p_rung, p_pic );
+        block_ChainAppend( &p_rung->p_buffers, p_block );
+    }
+
+    /*Now flush encoder*/
+    do {
+        p_block = p_rung->p_encoder->pf_encode_video( p_rung->p_encoder, NULL );
+        block_ChainAppend( &p_rung->p_buffers, p_block );
+    } while( p_block );
+
+    vlc_mutex_unlock( &p_rung->lock_out );
+
+    vlc_restorecancel (canc);
+
+    return NULL;
+}
+
+static void transcode_rung_close( sout_stream_t *p_stream,
+                                  transcode_rung_t *p_rung )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    if( p_sys->i_threads >= 1 )
+    {
+        if( !p_rung->b_abort )
+        {
+            vlc_mutex_lock( &p_rung->lock_out );
+            p_rung->b_abort = true;
+            vlc_cond_signal( &p_rung->cond );
+            vlc_mutex_unlock( &p_rung->lock_out );
+
+            vlc_join( p_rung->thread, NULL );
+        }
+
+        picture_fifo_Delete( p_rung->pp_pics );
+        vlc_sem_destroy( &p_rung->picture_pool_has_room );
+    }
+    vlc_mutex_destroy( &p_rung->lock_out );
+    vlc_cond_destroy( &p_rung->cond );
+    block_ChainRelease( p_rung->p_buffers );
+
+    if( p_rung->id )
+        sout_StreamIdDel( p_stream->p_next, p_rung->id );
+    if( p_rung->p_chain )
+        filter_chain_Delete( p_rung->p_chain );
+
+    module_unneed( p_rung->p_encoder, p_rung->p_encoder->p_module );
+    es_format_Clean( &p_rung->p_encoder->fmt_in );
+    es_format_Clean( &p_rung->p_encoder->fmt_out );
+    vlc_object_release( p_rung->p_encoder );
+}
+
+/* Opens the encoder of an additional rendition, once the format of the
+ * main video encoder is known. */
+static int transcode_rung_open( sout_stream_t *p_stream,
+                                sout_stream_id_sys_t *id,
+                                transcode_rung_t *p_rung,
+                                const transcode_rendition_t *p_cfg,
+                                unsigned i_index )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    const video_format_t *p_src = &id->p_encoder->fmt_in.video;
+    unsigned i_src_width = p_src->i_visible_width ? p_src->i_visible_width
+                                                  : p_src->i_width;
+    unsigned i_src_height = p_src->i_visible_height ? p_src->i_visible_height
+                                                    : p_src->i_height;
+    unsigned i_sar_num = p_src->i_sar_num ? p_src->i_sar_num : 1;
+    unsigned i_sar_den = p_src->i_sar_den ? p_src->i_sar_den : 1;
+    unsigned i_width = p_cfg->i_width;
+    unsigned i_height = p_cfg->i_height;
+
+    /* Keep the display aspect ratio of the main rendition */
+    if( i_height == 0 )
+        i_height = 2 * lround( (double)i_width * i_src_height * i_sar_den /
+                               i_src_width / i_sar_num / 2 );
+    else if( i_width == 0 )
+        i_width = 2 * lround( (double)i_height * i_src_width * i_sar_num /
+                              i_src_height / i_sar_den / 2 );
+    i_width &= ~1;
+    i_height &= ~1;
+    if( i_width == 0 || i_height == 0 )
+        return VLC_EGENERIC;
+
+    memset( p_rung, 0, sizeof( *p_rung ) );
+    p_rung->p_stream = p_stream;
+    p_rung->p_encoder = sout_EncoderCreate( p_stream );
+    if( !p_rung->p_encoder )
+        return VLC_ENOMEM;
+
+    encoder_t *p_enc = p_rung->p_encoder;
+
+    es_format_Init( &p_enc->fmt_in, VIDEO_ES, id->p_encoder->fmt_in.i_codec );
+    p_enc->fmt_in.video = *p_src;
+    p_enc->fmt_in.video.p_palette = NULL;
+    p_enc->fmt_in.video.i_x_offset = p_enc->fmt_in.video.i_y_offset = 0;
+    p_enc->fmt_in.video.i_width = p_enc->fmt_in.video.i_visible_width = i_width;
+    p_enc->fmt_in.video.i_height = p_enc->fmt_in.video.i_visible_height = i_height;
+    vlc_ureduce( &p_enc->fmt_in.video.i_sar_num,
+                 &p_enc->fmt_in.video.i_sar_den,
+                 (uint64_t)i_src_width * i_sar_num * i_height,
+                 (uint64_t)i_src_height * i_sar_den * i_width, 0 );
+
+    es_format_Init( &p_enc->fmt_out, VIDEO_ES, p_sys->i_vcodec );
+    p_enc->fmt_out.video = p_enc->fmt_in.video;
+    p_enc->fmt_out.video.i_chroma = 0;
+    p_enc->fmt_out.i_id = id->p_encoder->fmt_out.i_id +
+                          LADDER_ES_ID_OFFSET * (i_index + 1);
+    p_enc->fmt_out.i_group = id->p_encoder->fmt_out.i_group;
+    if( id->p_encoder->fmt_out.psz_language )
+        p_enc->fmt_out.psz_language =
+            strdup( id->p_encoder->fmt_out.psz_language );
+    p_enc->fmt_out.i_bitrate = p_cfg->i_bitrate ? p_cfg->i_bitrate
+                                                : p_sys->i_vbitrate;
+
+    p_enc->i_threads = p_sys->i_threads;
+    p_enc->p_cfg = p_sys->p_video_cfg;
+
+    p_enc->p_module = module_need( p_enc, "encoder", p_sys->psz_venc, true );
+    if( !p_enc->p_module )
+    {
+        msg_Err( p_stream, "cannot find video encoder (module:%s fourcc:%4.4s)",
+                 p_sys->psz_venc ? p_sys->psz_venc : "any",
+                 (char *)&p_sys->i_vcodec );
+        es_format_Clean( &p_enc->fmt_out );
+        vlc_object_release( p_enc );
+        return VLC_EGENERIC;
+    }
+
+    p_enc->fmt_in.video.i_chroma = p_enc->fmt_in.i_codec;
+    p_enc->fmt_out.i_codec = vlc_fourcc_GetCodec( VIDEO_ES,
+                                                  p_enc->fmt_out.i_codec );
+
+    msg_Dbg( p_stream, "rendition %u: %ux%u %dkb/s, es id %d", i_index + 1,
+             i_width, i_height, p_enc->fmt_out.i_bitrate / 1000,
+             p_enc->fmt_out.i_id );
+
+    p_rung->id = sout_StreamIdAdd( p_stream->p_next, &p_enc->fmt_out );
+    if( !p_rung->id )
+    {
+        msg_Err( p_stream, "cannot add this stream" );
+        goto error;
+    }
+
+    vlc_mutex_init( &p_rung->lock_out );
+    vlc_cond_init( &p_rung->cond );
+
+    if( p_sys->i_threads <= 0 )
+        return VLC_SUCCESS;
+
+    int i_priority = p_sys->b_high_priority ? VLC_THREAD_PRIORITY_OUTPUT :
+                       VLC_THREAD_PRIORITY_VIDEO;
+    p_rung->pp_pics = picture_fifo_New();
+    if( p_rung->pp_pics == NULL )
+        goto error_lock;
+
+    vlc_sem_init( &p_rung->picture_pool_has_room, p_sys->pool_size );
+    if( vlc_clone( &p_rung->thread, RungThread, p_rung, i_priority ) )
+    {
+        msg_Err( p_stream, "cannot spawn encoder thread" );
+        vlc_sem_destroy( &p_rung->picture_pool_has_room );
+        picture_fifo_Delete( p_rung->pp_pics );
+        goto error_lock;
+    }
+    return VLC_SUCCESS;
+
+error_lock:
+    vlc_mutex_destroy( &p_rung->lock_out );
+    vlc_cond_destroy( &p_rung->cond );
+error:
+    if( p_rung->id )
+        sout_StreamIdDel( p_stream->p_next, p_rung->id );
+    module_unneed( p_enc, p_enc->p_module );
+    es_format_Clean( &p_enc->fmt_out );
+    vlc_object_release( p_enc );
+    return VLC_EGENERIC;
+}
+
+static void transcode_rungs_open( sout_stream_t *p_stream,
+                                  sout_stream_id_sys_t *id )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    if( p_sys->i_ladder == 0 )
+        return;
+
+    id->p_rungs = calloc( p_sys->i_ladder, sizeof( *id->p_rungs ) );
+    if( !id->p_rungs )
+        return;
+
+    for( unsigned i = 0; i < p_sys->i_ladder; i++ )
+    {
+        if( transcode_rung_open( p_stream, id, &id->p_rungs[id->i_rungs],
+                                 &p_sys->p_ladder[i], i ) == VLC_SUCCESS )
+            id->i_rungs++;
+        else
+            msg_Warn( p_stream, "dropping rendition %u", i + 1 );
+    }
+}
+
+/* Hands a picture of the main encoder to all the additional renditions */
+static void transcode_rungs_push( sout_stream_t *p_stream,
+                                  sout_stream_id_sys_t *id, picture_t *p_pic )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    for( unsigned i = 0; i < id->i_rungs; i++ )
+    {
+        transcode_rung_t *p_rung = &id->p_rungs[i];
+
+        if( p_sys->i_threads == 0 )
+        {
+            block_t *p_block = transcode_rung_encode( p_stream, p_rung,
+                                                      picture_Hold( p_pic ) );
+            vlc_mutex_lock( &p_rung->lock_out );
+            block_ChainAppend( &p_rung->p_buffers, p_block );
+            vlc_mutex_unlock( &p_rung->lock_out );
+            continue;
+        }
+
+        vlc_sem_wait( &p_rung->picture_pool_has_room );
+        vlc_mutex_lock( &p_rung->lock_out );
+        picture_fifo_Push( p_rung->pp_pics, picture_Hold( p_pic ) );
+        vlc_cond_signal( &p_rung->cond );
+        vlc_mutex_unlock( &p_rung->lock_out );
+    }
+}
+
+/* Sends the output of the first i_rungs additional renditions downstream.
+ * With flush, the encoders are drained first. */
+void transcode_video_rungs_output( sout_stream_t *p_stream,
+                                   sout_stream_id_sys_t *id,
+                                   unsigned i_rungs, bool flush )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    for( unsigned i = 0; i < i_rungs; i++ )
+    {
+        transcode_rung_t *p_rung = &id->p_rungs[i];
+        block_t *p_out;
+
+        if( flush && p_sys->i_threads == 0 )
+        {
+            block_t *p_block;
+            do {
+                p_block = p_rung->p_encoder->pf_encode_video(
+                                                    p_rung->p_encoder, NULL );
+                block_ChainAppend( &p_rung->p_buffers, p_block );
+            } while( p_block );
+        }
+        else if( flush && !p_rung->b_abort )
+        {
+            vlc_mutex_lock( &p_rung->lock_out );
+            p_rung->b_abort = true;
+            vlc_cond_signal( &p_rung->cond );
+            vlc_mutex_unlock( &p_rung->lock_out );
+
+            vlc_join( p_rung->thread, NULL );
+        }
+
+        vlc_mutex_lock( &p_rung->lock_out );
+        p_out = p_rung->p_buffers;
+        p_rung->p_buffers = NULL;
+        vlc_mutex_unlock( &p_rung->lock_out );
+
+        if( p_out )
+            sout_StreamIdSend( p_stream->p_next, p_rung->id, p_out );
+    }
+}
+
 void transcode_video_close( sout_stream_t *p_stream,
                                    sout_stream_id_sys_t *id )
 {
@@ -633,6 +1000,13 @@ void transcode_video_close( sout_stream_t *p_stream,
         vlc_cond_destroy( &p_stream->p_sys->cond );
     }
 
+    /* Close additional renditions */
+    for( unsigned i = 0; i < id->i_rungs; i++ )
+        transcode_rung_close( p_stream, &id->p_rungs[i] );
+    free( id->p_rungs );
+    id->p_rungs = NULL;
+    id->i_rungs = 0;
+
     /* Close decoder */
     if( id->p_decoder->p_module )
         module_unneed( id->p_decoder, id->p_decoder->p_module );
@@ -699,6 +1073,8 @@ static void OutputFrame( sout_stream_t *p_stream, picture_t *p_pic, sout_stream_
         }
     }
 
+    transcode_rungs_push( p_stream, id, p_pic );
+
     if( p_sys->i_threads == 0 )
     {
         block_t *p_block;
@@ -755,6 +1131,7 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
             msg_Dbg( p_stream, "Flushing done");
         }
+        transcode_video_rungs_output( p_stream, id, id->i_rungs, true );
         return VLC_SUCCESS;
     }
 
@@ -813,6 +1190,7 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                 id->b_transcode = false;
                 return VLC_EGENERIC;
             }
+            transcode_rungs_open( p_stream, id );
         }
 
         /* Run the filter and output chains; first with the picture,
@@ -855,6 +1233,10 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
         vlc_mutex_unlock( &p_sys->lock_out );
     }
 
+    /* With asynchronous decoding, the renditions are output from Send() */
+    if( !id->b_async )
+        transcode_video_rungs_output( p_stream, id, id->i_rungs, false );
+
     return VLC_SUCCESS;
 }
 
@@ -161,6 +161,199 @@ typedef struct paragraph_t
 
 } paragraph_t;
 
+/**
+ * Loaded glyph, as found in the glyph cache
+ */
+typedef struct glyph_cache_entry_t glyph_cache_entry_t;
+struct glyph_cache_entry_t
+{
+    glyph_cache_entry_t *p_hash_next;       /**< next in the hash bucket */
+    glyph_cache_entry_t *p_prev;            /**< more recently used */
+    glyph_cache_entry_t *p_next;            /**< less recently used */
+
+    FT_Face              p_face;
+    FT_UInt              i_glyph_index;
+    int                  i_style_flags;
+    int                  i_outline_radius;  /**< -1 if not outlined */
+
+    FT_Glyph             p_glyph;
+    FT_Glyph             p_outline;
+    FT_Vector            advance;
+};
+
+#define GLYPH_CACHE_BUCKETS 1024
+#define GLYPH_CACHE_SIZE    2048
+
+struct glyph_cache_t
+{
+    glyph_cache_entry_t *pp_buckets[ GLYPH_CACHE_BUCKETS ];
+    glyph_cache_entry_t *p_first;           /**< most recently used */
+    glyph_cache_entry_t *p_last;            /**< least recently used */
+    int                  i_count;
+};
+
+glyph_cache_t *GlyphCache_New( void )
+{
+    return calloc( 1, sizeof( glyph_cache_t ) );
+}
+
+void GlyphCache_Delete( glyph_cache_t *p_cache )
+{
+    glyph_cache_entry_t *p_entry = p_cache->p_first;
+    while( p_entry )
+    {
+        glyph_cache_entry_t *p_next = p_entry->p_next;
+        FT_Done_Glyph( p_entry->p_glyph );
+        if( p_entry->p_outline )
+            FT_Done_Glyph( p_entry->p_outline );
+        free( p_entry );
+        p_entry = p_next;
+    }
+    free( p_cache );
+}
+
+static unsigned GlyphCacheHash( FT_Face p_face, FT_UInt i_glyph_index,
+                                int i_style_flags, int i_outline_radius )
+{
+    uintptr_t i_hash = (uintptr_t) p_face;
+    i_hash ^= i_hash >> 9;
+    i_hash += i_glyph_index * 2654435761u;
+    i_hash ^= ( i_style_flags << 16 ) ^ i_outline_radius;
+    return i_hash % GLYPH_CACHE_BUCKETS;
+}
+
+static void GlyphCacheUnlink( glyph_cache_t *p_cache,
+                              glyph_cache_entry_t *p_entry )
+{
+    if( p_entry->p_prev )
+        p_entry->p_prev->p_next = p_entry->p_next;
+    else
+        p_cache->p_first = p_entry->p_next;
+    if( p_entry->p_next )
+        p_entry->p_next->p_prev = p_entry->p_prev;
+    else
+        p_cache->p_last = p_entry->p_prev;
+}
+
+static void GlyphCachePushFront( glyph_cache_t *p_cache,
+                                 glyph_cache_entry_t *p_entry )
+{
+    p_entry->p_prev = NULL;
+    p_entry->p_next = p_cache->p_first;
+    if( p_cache->p_first )
+        p_cache->p_first->p_prev = p_entry;
+    else
+        p_cache->p_last = p_entry;
+    p_cache->p_first = p_entry;
+}
+
+/**
+ * Copies a cached glyph into \p p_bitmaps
+ *
+ * \return VLC_SUCCESS if the glyph was found in the cache
+ */
+static int GlyphCacheGet( glyph_cache_t *p_cache, FT_Face p_face,
+                          FT_UInt i_glyph_index, int i_style_flags,
+                          int i_outline_radius, glyph_bitmaps_t *p_bitmaps,
+                          FT_Vector *p_advance )
+{
+    unsigned i_bucket = GlyphCacheHash( p_face, i_glyph_index,
+                                        i_style_flags, i_outline_radius );
+    glyph_cache_entry_t *p_entry = p_cache->pp_buckets[ i_bucket ];
+
+    while( p_entry && ( p_entry->p_face != p_face
+                     || p_entry->i_glyph_index != i_glyph_index
+                     || p_entry->i_style_flags != i_style_flags
+                     || p_entry->i_outline_radius != i_outline_radius ) )
+        p_entry = p_entry->p_hash_next;
+
+    if( !p_entry )
+        return VLC_EGENERIC;
+
+    if( FT_Glyph_Copy( p_entry->p_glyph, &p_bitmaps->p_glyph ) )
+        return VLC_EGENERIC;
+    p_bitmaps->p_outline = NULL;
+    if( p_entry->p_outline
+     && FT_Glyph_Copy( p_entry->p_outline, &p_bitmaps->p_outline ) )
+        p_bitmaps->p_outline = NULL;
+    *p_advance = p_entry->advance;
+
+    if( p_entry != p_cache->p_first )
+    {
+        GlyphCacheUnlink( p_cache, p_entry );
+        GlyphCachePushFront( p_cache, p_entry );
+    }
+    return VLC_SUCCESS;
+}
+
+/**
+ * Stores a copy of a freshly loaded glyph, evicting the least recently used
+ * one if the cache is full
+ */
+static void GlyphCachePut( glyph_cache_t *p_cache, FT_Face p_face,
+                           FT_UInt i_glyph_index, int i_style_flags,
+                           int i_outline_radius,
+                           const glyph_bitmaps_t *p_bitmaps,
+                           const FT_Vector *p_advance )
+{
+    FT_Glyph p_glyph, p_outline = NULL;
+
+    if( FT_Glyph_Copy( p_bitmaps->p_glyph, &p_glyph ) )
+        return;
+    if( p_bitmaps->p_outline
+     && FT_Glyph_Copy( p_bitmaps->p_outline, &p_outline ) )
+    {
+        FT_Done_Glyph( p_glyph );
+        return;
+    }
+
+    glyph_cache_entry_t *p_entry;
+    if( p_cache->i_count >= GLYPH_CACHE_SIZE )
+    {
+        /* Recycle the least recently used entry */
+        p_entry = p_cache->p_last;
+        GlyphCacheUnlink( p_cache, p_entry );
+
+        glyph_cache_entry_t **pp_entry = &p_cache->pp_buckets[
+            GlyphCacheHash( p_entry->p_face, p_entry->i_glyph_index,
+                            p_entry->i_style_flags,
+                            p_entry->i_outline_radius ) ];
+        while( *pp_entry != p_entry )
+            pp_entry = &(*pp_entry)->p_hash_next;
+        *pp_entry = p_entry->p_hash_next;
+
+        FT_Done_Glyph( p_entry->p_glyph );
+        if( p_entry->p_outline )
+            FT_Done_Glyph( p_entry->p_outline );
+    }
+    else
+    {
+        p_entry = malloc( sizeof( *p_entry ) );
+        if( unlikely( !p_entry ) )
+        {
+            FT_Done_Glyph( p_glyph );
+            if( p_outline )
+                FT_Done_Glyph( p_outline );
+            return;
+        }
+        p_cache->i_count++;
+    }
+
+    p_entry->p_face = p_face;
+    p_entry->i_glyph_index = i_glyph_index;
+    p_entry->i_style_flags = i_style_flags;
+    p_entry->i_outline_radius = i_outline_radius;
+    p_entry->p_glyph = p_glyph;
+    p_entry->p_outline = p_outline;
+    p_entry->advance = *p_advance;
+
+    unsigned i_bucket = GlyphCacheHash( p_face, i_glyph_index,
+                                        i_style_flags, i_outline_radius );
+    p_entry->p_hash_next = p_cache->pp_buckets[ i_bucket ];
+    p_cache->pp_buckets[ i_bucket ] = p_entry;
+    GlyphCachePushFront( p_cache, p_entry );
+}
+
 static void FreeLine( line_desc_t *p_line )
 {
     for( int i = 0; i < p_line->i_character_count; i++ )
@@ -957,18 +1150,23 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
         else
             p_face = p_run->p_face;
 
+        int i_radius = -1; /* no outline */
         if( p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
         {
             double f_outline_thickness =
                 var_InheritInteger( p_filter, "freetype-outline-thickness" ) / 100.0;
             f_outline_thickness = VLC_CLIP( f_outline_thickness, 0.0, 0.5 );
-            int i_radius = ( i_live_size << 6 ) * f_outline_thickness;
+            i_radius = ( i_live_size << 6 ) * f_outline_thickness;
             FT_Stroker_Set( p_sys->p_stroker,
                             i_radius,
                             FT_STROKER_LINECAP_ROUND,
                             FT_STROKER_LINEJOIN_ROUND, 0 );
         }
 
+        /* Only the styles altering the glyph shapes matter to the cache */
+        const int i_cache_flags = p_style->i_style_flags
+                                & ( STYLE_BOLD | STYLE_ITALIC );
+
         for( int j = p_run->i_start_offset; j < p_run->i_end_offset; ++j )
         {
             int i_glyph_index;
@@ -1019,39 +1217,51 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                     SKIP_GLYPH( p_bitmaps )
             }
 
-            if( FT_Load_Glyph( p_face, i_glyph_index,
-                               FT_LOAD_NO_BITMAP | FT_LOAD_DEFAULT )
-             && FT_Load_Glyph( p_face, i_glyph_index, FT_LOAD_DEFAULT ) )
-                SKIP_GLYPH( p_bitmaps )
+            FT_Vector advance;
+            if( GlyphCacheGet( p_sys->p_glyph_cache, p_face, i_glyph_index,
+                               i_cache_flags, i_radius,
+                               p_bitmaps, &advance ) != VLC_SUCCESS )
+            {
+                if( FT_Load_Glyph( p_face, i_glyph_index,
+                                   FT_LOAD_NO_BITMAP | FT_LOAD_DEFAULT )
+                 && FT_Load_Glyph( p_face, i_glyph_index, FT_LOAD_DEFAULT ) )
+                    SKIP_GLYPH( p_bitmaps )
 
-            if( ( p_style->i_style_flags & STYLE_BOLD )
-                  && !( p_face->style_flags & FT_STYLE_FLAG_BOLD ) )
-                FT_GlyphSlot_Embolden( p_face->glyph );
-            if( ( p_style->i_style_flags & STYLE_ITALIC )
-                  && !( p_face->style_flags & FT_STYLE_FLAG_ITALIC ) )
-                FT_GlyphSlot_Oblique( p_face->glyph );
+                if( ( p_style->i_style_flags & STYLE_BOLD )
+                      && !( p_face->style_flags & FT_STYLE_FLAG_BOLD ) )
+                    FT_GlyphSlot_Embolden( p_face->glyph );
+                if( ( p_style->i_style_flags & STYLE_ITALIC )
+                      && !( p_face->style_flags & FT_STYLE_FLAG_ITALIC ) )
+                    FT_GlyphSlot_Oblique( p_face->glyph );
 
-            if( FT_Get_Glyph( p_face->glyph, &p_bitmaps->p_glyph ) )
-                SKIP_GLYPH( p_bitmaps )
+                if( FT_Get_Glyph( p_face->glyph, &p_bitmaps->p_glyph ) )
+                    SKIP_GLYPH( p_bitmaps )
 
-#undef SKIP_GLYPH
+                p_bitmaps->p_outline = 0;
+                if( i_radius >= 0 )
+                {
+                    p_bitmaps->p_outline = p_bitmaps->p_glyph;
+                    if( FT_Glyph_StrokeBorder( &p_bitmaps->p_outline,
+                                               p_sys->p_stroker, 0, 0 ) )
+                        p_bitmaps->p_outline = 0;
+                }
 
-            if( p_filter->p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
-            {
-                p_bitmaps->p_outline = p_bitmaps->p_glyph;
-                if( FT_Glyph_StrokeBorder( &p_bitmaps->p_outline,
-                                           p_filter->p_sys->p_stroker, 0, 0 ) )
-                    p_bitmaps->p_outline = 0;
+                advance = p_face->glyph->advance;
+                GlyphCachePut( p_sys->p_glyph_cache, p_face, i_glyph_index,
+                               i_cache_flags, i_radius, p_bitmaps, &advance );
             }
 
+#undef SKIP_GLYPH
+
+            p_bitmaps->p_shadow = 0;
             if( p_style->i_shadow_alpha != STYLE_ALPHA_TRANSPARENT )
                 p_bitmaps->p_shadow = p_bitmaps->p_outline ?
                                       p_bitmaps->p_outline : p_bitmaps->p_glyph;
 
             if( b_overwrite_advance )
             {
-                p_bitmaps->i_x_advance = p_face->glyph->advance.x;
-                p_bitmaps->i_y_advance = p_face->glyph->advance.y;
+                p_bitmaps->i_x_advance = advance.x;
+                p_bitmaps->i_y_advance = advance.y;
             }
         }
 
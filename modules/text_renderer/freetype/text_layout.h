@@ -60,6 +60,17 @@ struct line_desc_t
 };
 
 void FreeLines( line_desc_t *p_lines );
+
+/**
+ * Creates the cache of loaded glyphs.
+ *
+ * Glyphs are kept in outline form, after emboldening, slanting and
+ * stroking, so that repeated text only needs to be rasterized again.
+ * The least recently used glyphs are evicted first. Cached glyphs refer
+ * to their FT_Face, so the cache must be deleted before the faces.
+ */
+glyph_cache_t *GlyphCache_New( void );
+void GlyphCache_Delete( glyph_cache_t *p_cache );
 line_desc_t *NewLine( int i_count );
 
 /**
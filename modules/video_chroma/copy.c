@@ -27,8 +27,12 @@
 
 #include <vlc_common.h>
 #include <vlc_picture.h>
+#include <vlc_filter.h>
 #include <vlc_cpu.h>
 #include <assert.h>
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
 
 #include "copy.h"
 
@@ -261,6 +265,124 @@ static void SSE_SplitUV(uint8_t *dstu, size_t dstu_pitch,
     }
 }
 
+#ifdef HAVE_AVX2_INTRINSICS
+/* Same as CopyFromUswc() with 32 bytes streaming loads */
+VLC_AVX2
+static void AVX2_CopyFromUswc(uint8_t *dst, size_t dst_pitch,
+                              const uint8_t *src, size_t src_pitch,
+                              unsigned width, unsigned height)
+{
+    _mm_mfence();
+
+    for (unsigned y = 0; y < height; y++) {
+        const unsigned unaligned = (-(uintptr_t)src) & 0x1f;
+        unsigned x = 0;
+
+        if (width >= 32) {
+            if (unaligned)
+                _mm256_storeu_si256((__m256i *)dst,
+                                    _mm256_loadu_si256((const __m256i *)src));
+            x = unaligned;
+        }
+
+        for (; x+127 < width; x += 128) {
+            __m256i a = _mm256_stream_load_si256((__m256i *)&src[x]);
+            __m256i b = _mm256_stream_load_si256((__m256i *)&src[x+32]);
+            __m256i c = _mm256_stream_load_si256((__m256i *)&src[x+64]);
+            __m256i d = _mm256_stream_load_si256((__m256i *)&src[x+96]);
+
+            _mm256_storeu_si256((__m256i *)&dst[x],    a);
+            _mm256_storeu_si256((__m256i *)&dst[x+32], b);
+            _mm256_storeu_si256((__m256i *)&dst[x+64], c);
+            _mm256_storeu_si256((__m256i *)&dst[x+96], d);
+        }
+
+        for (; x < width; x++)
+            dst[x] = src[x];
+
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    _mm_mfence();
+}
+
+/* Same as Copy2d() */
+VLC_AVX2
+static void AVX2_Copy2d(uint8_t *dst, size_t dst_pitch,
+                        const uint8_t *src, size_t src_pitch,
+                        unsigned width, unsigned height)
+{
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        if (((uintptr_t)dst & 0x1f) == 0) {
+            for (; x+63 < width; x += 64) {
+                __m256i a = _mm256_loadu_si256((const __m256i *)&src[x]);
+                __m256i b = _mm256_loadu_si256((const __m256i *)&src[x+32]);
+
+                _mm256_stream_si256((__m256i *)&dst[x],    a);
+                _mm256_stream_si256((__m256i *)&dst[x+32], b);
+            }
+        } else {
+            for (; x+63 < width; x += 64) {
+                __m256i a = _mm256_loadu_si256((const __m256i *)&src[x]);
+                __m256i b = _mm256_loadu_si256((const __m256i *)&src[x+32]);
+
+                _mm256_storeu_si256((__m256i *)&dst[x],    a);
+                _mm256_storeu_si256((__m256i *)&dst[x+32], b);
+            }
+        }
+
+        for (; x < width; x++)
+            dst[x] = src[x];
+
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    _mm_sfence();
+}
+
+/* Same as SSE_SplitUV(), 32 pixels at a time */
+VLC_AVX2
+static void AVX2_SplitUV(uint8_t *dstu, size_t dstu_pitch,
+                         uint8_t *dstv, size_t dstv_pitch,
+                         const uint8_t *src, size_t src_pitch,
+                         unsigned width, unsigned height)
+{
+    const __m256i shuffle = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14,
+                                             1, 3, 5, 7, 9, 11, 13, 15,
+                                             0, 2, 4, 6, 8, 10, 12, 14,
+                                             1, 3, 5, 7, 9, 11, 13, 15);
+
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        for (; x+31 < width; x += 32) {
+            /* Each 128-bits lane holds 8 U then 8 V samples */
+            __m256i a = _mm256_shuffle_epi8(
+                _mm256_loadu_si256((const __m256i *)&src[2*x]), shuffle);
+            __m256i b = _mm256_shuffle_epi8(
+                _mm256_loadu_si256((const __m256i *)&src[2*x+32]), shuffle);
+
+            a = _mm256_permute4x64_epi64(a, _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256((__m256i *)&dstu[x],
+                                _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256((__m256i *)&dstv[x],
+                                _mm256_permute2x128_si256(a, b, 0x31));
+        }
+
+        for (; x < width; x++) {
+            dstu[x] = src[2*x+0];
+            dstv[x] = src[2*x+1];
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+#endif
+
 static void SSE_CopyPlane(uint8_t *dst, size_t dst_pitch,
                           const uint8_t *src, size_t src_pitch,
                           uint8_t *cache, size_t cache_size,
@@ -276,6 +398,13 @@ static void SSE_CopyPlane(uint8_t *dst, size_t dst_pitch,
     for (unsigned y = 0; y < height; y += hstep) {
         const unsigned hblock =  __MIN(hstep, height - y);
 
+#ifdef HAVE_AVX2_INTRINSICS
+        if (vlc_CPU_AVX2()) {
+            AVX2_CopyFromUswc(cache, w16, src, src_pitch, src_pitch, hblock);
+            AVX2_Copy2d(dst, dst_pitch, cache, w16, src_pitch, hblock);
+        } else
+#endif
+        {
         /* Copy a bunch of line into our cache */
         CopyFromUswc(cache, w16,
                      src, src_pitch,
@@ -285,6 +414,7 @@ static void SSE_CopyPlane(uint8_t *dst, size_t dst_pitch,
         Copy2d(dst, dst_pitch,
                cache, w16,
                src_pitch, hblock);
+        }
 
         /* */
         src += src_pitch * hblock;
@@ -305,6 +435,15 @@ static void SSE_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
     for (unsigned y = 0; y < height; y += hstep) {
         const unsigned hblock =  __MIN(hstep, height - y);
 
+#ifdef HAVE_AVX2_INTRINSICS
+        if (vlc_CPU_AVX2()) {
+            AVX2_CopyFromUswc(cache, w16, src, src_pitch,
+                              2*src_pitch, hblock);
+            AVX2_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
+                         cache, w16, src_pitch, hblock);
+        } else
+#endif
+        {
         /* Copy a bunch of line into our cache */
         CopyFromUswc(cache, w16, src, src_pitch,
                      2*src_pitch, hblock, cpu);
@@ -312,6 +451,7 @@ static void SSE_SplitPlanes(uint8_t *dstu, size_t dstu_pitch,
         /* Copy from our cache to the destination */
         SSE_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
                     cache, w16, src_pitch, hblock, cpu);
+        }
 
         /* */
         src  += src_pitch  * hblock;
@@ -581,3 +721,66 @@ void CopyFromYv12(picture_t *dst, uint8_t *src[3], size_t src_pitch[3],
      CopyPlane(dst->p[2].p_pixels, dst->p[2].i_pitch,
                src[2], src_pitch[2], height / 2);
 }
+
+struct copy_bands
+{
+    copy_func_t func;
+    picture_t *dst;
+    uint8_t **src;
+    size_t *src_pitch;
+    unsigned planes;
+    unsigned height;
+    copy_cache_t *caches;
+};
+
+static void CopyBand(filter_t *filter, void *data,
+                     unsigned index, unsigned count)
+{
+    const struct copy_bands *job = data;
+
+    VLC_UNUSED(filter);
+    if (count > COPY_CACHE_MAX) {
+        /* More threads than caches: the first band does everything */
+        if (index > 0)
+            return;
+        index = 0;
+        count = 1;
+    }
+
+    /* Band boundaries on even lines, i.e. on 4:2:0 chroma lines */
+    const unsigned y0 = (job->height * index / count) & ~1;
+    const unsigned y1 = index + 1 < count
+                      ? (job->height * (index + 1) / count) & ~1
+                      : job->height;
+    if (y1 <= y0)
+        return;
+
+    picture_t band = *job->dst;
+    uint8_t *src[PICTURE_PLANE_MAX];
+
+    for (unsigned i = 0; i < job->planes; i++) {
+        const unsigned lines = i > 0 ? y0 / 2 : y0;
+
+        src[i] = job->src[i] + lines * job->src_pitch[i];
+        band.p[i].p_pixels += lines * band.p[i].i_pitch;
+    }
+    job->func(&band, src, job->src_pitch, y1 - y0, &job->caches[index]);
+}
+
+void CopyBands(filter_t *filter, copy_func_t func, picture_t *dst,
+               uint8_t *src[], size_t src_pitch[], unsigned planes,
+               unsigned height, copy_cache_t caches[COPY_CACHE_MAX])
+{
+    struct copy_bands job = {
+        .func = func,
+        .dst = dst,
+        .src = src,
+        .src_pitch = src_pitch,
+        .planes = planes,
+        .height = height,
+        .caches = caches,
+    };
+
+    assert(planes <= PICTURE_PLANE_MAX);
+    filter_RunSlices(filter, CopyBand, &job);
+}
@@ -53,4 +53,18 @@ void CopyFromI420ToNv12(picture_t *dst, uint8_t *src[3], size_t src_pitch[3],
 void CopyFromI420_10ToP010(picture_t *dst, uint8_t *src[3], size_t src_pitch[3],
                         unsigned height, copy_cache_t *cache);
 
+/* Maximum number of bands copied in parallel by CopyBands() */
+#define COPY_CACHE_MAX 16
+
+typedef void (*copy_func_t)(picture_t *dst, uint8_t *src[],
+                            size_t src_pitch[], unsigned height,
+                            copy_cache_t *cache);
+
+/* Copies a 4:2:0 picture with one of the functions above, in horizontal
+ * bands processed in parallel through filter_RunSlices(). Each band uses its
+ * own cache out of the COPY_CACHE_MAX initialized ones. */
+void CopyBands(filter_t *filter, copy_func_t func, picture_t *dst,
+               uint8_t *src[], size_t src_pitch[], unsigned planes,
+               unsigned height, copy_cache_t caches[COPY_CACHE_MAX]);
+
 #endif
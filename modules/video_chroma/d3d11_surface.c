@@ -62,7 +62,7 @@ struct picture_sys_t
 };
 
 struct filter_sys_t {
-    copy_cache_t     cache;
+    copy_cache_t     cache[COPY_CACHE_MAX];
     ID3D11Texture2D  *staging;
     vlc_mutex_t      staging_lock;
 };
@@ -154,7 +154,8 @@ static void D3D11_YUY2(filter_t *p_filter, picture_t *src, picture_t *dst)
                                  + pitch[1] * src->format.i_height / 2,
         };
 
-        CopyFromYv12(dst, plane, pitch, src->format.i_height, &sys->cache);
+        CopyBands(p_filter, CopyFromYv12, dst, plane, pitch, 3,
+                  src->format.i_height, sys->cache);
     } else if (desc.Format == DXGI_FORMAT_NV12) {
         uint8_t *plane[2] = {
             lock.pData,
@@ -164,7 +165,8 @@ static void D3D11_YUY2(filter_t *p_filter, picture_t *src, picture_t *dst)
             lock.RowPitch,
             lock.RowPitch,
         };
-        CopyFromNv12(dst, plane, pitch, src->format.i_height, &sys->cache);
+        CopyBands(p_filter, CopyFromNv12, dst, plane, pitch, 2,
+                  src->format.i_height, sys->cache);
     } else {
         msg_Err(p_filter, "Unsupported D3D11VA conversion from 0x%08X to YV12", desc.Format);
     }
@@ -222,7 +224,8 @@ static void D3D11_NV12(filter_t *p_filter, picture_t *src, picture_t *dst)
             lock.RowPitch,
             lock.RowPitch,
         };
-        CopyFromNv12ToNv12(dst, plane, pitch, src->format.i_height, &sys->cache);
+        CopyBands(p_filter, CopyFromNv12ToNv12, dst, plane, pitch, 2,
+                  src->format.i_height, sys->cache);
     } else {
         msg_Err(p_filter, "Unsupported D3D11VA conversion from 0x%08X to NV12", desc.Format);
     }
@@ -260,7 +263,8 @@ static int OpenConverter( vlc_object_t *obj )
     filter_sys_t *p_sys = calloc(1, sizeof(filter_sys_t));
     if (!p_sys)
          return VLC_ENOMEM;
-    CopyInitCache(&p_sys->cache, p_filter->fmt_in.video.i_width );
+    for (unsigned i = 0; i < COPY_CACHE_MAX; i++)
+        CopyInitCache(&p_sys->cache[i], p_filter->fmt_in.video.i_width );
     vlc_mutex_init(&p_sys->staging_lock);
     p_filter->p_sys = p_sys;
 
@@ -271,7 +275,8 @@ static void CloseConverter( vlc_object_t *obj )
 {
     filter_t *p_filter = (filter_t *)obj;
     filter_sys_t *p_sys = (filter_sys_t*) p_filter->p_sys;
-    CopyCleanCache(&p_sys->cache);
+    for (unsigned i = 0; i < COPY_CACHE_MAX; i++)
+        CopyCleanCache(&p_sys->cache[i]);
     vlc_mutex_destroy(&p_sys->staging_lock);
     if (p_sys->staging)
         ID3D11Texture2D_Release(p_sys->staging);
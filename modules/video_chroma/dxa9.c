@@ -108,7 +108,8 @@ static void DXA9_YV12(filter_t *p_filter, picture_t *src, picture_t *dst)
             plane[1] = plane[2];
             plane[2] = V;
         }
-        CopyFromYv12(dst, plane, pitch, src->format.i_height, p_copy_cache);
+        CopyBands(p_filter, CopyFromYv12, dst, plane, pitch, 3,
+                  src->format.i_height, p_copy_cache);
     } else if (desc.Format == MAKEFOURCC('N','V','1','2')) {
         uint8_t *plane[2] = {
             lock.pBits,
@@ -118,7 +119,8 @@ static void DXA9_YV12(filter_t *p_filter, picture_t *src, picture_t *dst)
             lock.Pitch,
             lock.Pitch,
         };
-        CopyFromNv12(dst, plane, pitch, src->format.i_height, p_copy_cache);
+        CopyBands(p_filter, CopyFromNv12, dst, plane, pitch, 2,
+                  src->format.i_height, p_copy_cache);
     } else {
         msg_Err(p_filter, "Unsupported DXA9 conversion from 0x%08X to YV12", desc.Format);
     }
@@ -151,7 +153,8 @@ static void DXA9_NV12(filter_t *p_filter, picture_t *src, picture_t *dst)
             lock.Pitch,
             lock.Pitch,
         };
-        CopyFromNv12ToNv12(dst, plane, pitch, src->format.i_height, p_copy_cache);
+        CopyBands(p_filter, CopyFromNv12ToNv12, dst, plane, pitch, 2,
+                  src->format.i_height, p_copy_cache);
     } else {
         msg_Err(p_filter, "Unsupported DXA9 conversion from 0x%08X to NV12", desc.Format);
     }
@@ -185,10 +188,12 @@ static int OpenConverter( vlc_object_t *obj )
         return VLC_EGENERIC;
     }
 
-    copy_cache_t *p_copy_cache = calloc(1, sizeof(*p_copy_cache));
+    /* One cache per band copied in parallel */
+    copy_cache_t *p_copy_cache = calloc(COPY_CACHE_MAX, sizeof(*p_copy_cache));
     if (!p_copy_cache)
          return VLC_ENOMEM;
-    CopyInitCache(p_copy_cache, p_filter->fmt_in.video.i_width );
+    for (unsigned i = 0; i < COPY_CACHE_MAX; i++)
+        CopyInitCache(&p_copy_cache[i], p_filter->fmt_in.video.i_width );
     p_filter->p_sys = (filter_sys_t*) p_copy_cache;
 
     return VLC_SUCCESS;
@@ -198,7 +203,8 @@ static void CloseConverter( vlc_object_t *obj )
 {
     filter_t *p_filter = (filter_t *)obj;
     copy_cache_t *p_copy_cache = (copy_cache_t*) p_filter->p_sys;
-    CopyCleanCache(p_copy_cache);
+    for (unsigned i = 0; i < COPY_CACHE_MAX; i++)
+        CopyCleanCache(&p_copy_cache[i]);
     free( p_copy_cache );
     p_filter->p_sys = NULL;
 }
@@ -81,6 +81,11 @@ vlc_module_end ()
  * Local prototypes
  ****************************************************************************/
 
+/* Maximum number of bands converted in parallel */
+#define SWS_BANDS_MAX (16)
+/* Band boundaries fall on the chroma lines of all subsamplings */
+#define BAND_ALIGN (4)
+
 /**
  * Internal swscale filter structure.
  */
@@ -105,6 +110,16 @@ struct filter_sys_t
     bool b_copy;
     bool b_swap_uvi;
     bool b_swap_uvo;
+
+    /* Unscaled conversions are split into bands converted in parallel,
+     * each with its own context */
+    bool b_bands;
+    int i_bands_fmti;
+    int i_bands_fmto;
+    int i_bands_flags;
+    vlc_mutex_t bands_lock; /**< Serializes the contexts creation */
+    struct SwsContext *bands_ctx[SWS_BANDS_MAX];
+    int i_bands_height[SWS_BANDS_MAX];
 };
 
 static picture_t *Filter( filter_t *, picture_t * );
@@ -182,11 +197,13 @@ static int OpenScaler( vlc_object_t *p_this )
     /* Misc init */
     memset( &p_sys->fmt_in,  0, sizeof(p_sys->fmt_in) );
     memset( &p_sys->fmt_out, 0, sizeof(p_sys->fmt_out) );
+    vlc_mutex_init( &p_sys->bands_lock );
 
     if( Init( p_filter ) )
     {
         if( p_sys->p_filter )
             sws_freeFilter( p_sys->p_filter );
+        vlc_mutex_destroy( &p_sys->bands_lock );
         free( p_sys );
         return VLC_EGENERIC;
     }
@@ -217,6 +234,7 @@ static void CloseScaler( vlc_object_t *p_this )
     Clean( p_filter );
     if( p_sys->p_filter )
         sws_freeFilter( p_sys->p_filter );
+    vlc_mutex_destroy( &p_sys->bands_lock );
     free( p_sys );
 }
 
@@ -462,6 +480,17 @@ static int Init( filter_t *p_filter )
     p_sys->b_swap_uvi = cfg.b_swap_uvi;
     p_sys->b_swap_uvo = cfg.b_swap_uvo;
 
+    /* Without scaling, every output line only depends on the input line at
+     * the same position, so the picture can be converted in bands */
+    p_sys->b_bands = !cfg.b_copy && !cfg.b_has_a &&
+                     p_sys->i_extend_factor == 1 &&
+                     p_fmti->i_chroma != VLC_CODEC_RGBP &&
+                     p_fmti->i_visible_width == p_fmto->i_visible_width &&
+                     p_fmti->i_visible_height == p_fmto->i_visible_height;
+    p_sys->i_bands_fmti = cfg.i_fmti;
+    p_sys->i_bands_fmto = cfg.i_fmto;
+    p_sys->i_bands_flags = cfg.i_sws_flags | p_sys->i_cpu_mask;
+
     return VLC_SUCCESS;
 }
 
@@ -485,6 +514,14 @@ static void Clean( filter_t *p_filter )
     if( p_sys->ctx )
         sws_freeContext( p_sys->ctx );
 
+    for( unsigned i = 0; i < SWS_BANDS_MAX; i++ )
+    {
+        if( p_sys->bands_ctx[i] )
+            sws_freeContext( p_sys->bands_ctx[i] );
+        p_sys->bands_ctx[i] = NULL;
+    }
+    p_sys->b_bands = false;
+
     /* We have to set it to null has we call be called again :( */
     p_sys->ctx = NULL;
     p_sys->ctxA = NULL;
@@ -614,6 +651,85 @@ static void Convert( filter_t *p_filter, struct SwsContext *ctx,
 #endif
 }
 
+struct sws_band
+{
+    picture_t *p_dst;
+    picture_t *p_src;
+    int i_plane_count;
+};
+
+static void ConvertBand( filter_t *p_filter, void *data,
+                         unsigned index, unsigned count )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const struct sws_band *band = data;
+    const int i_height = p_filter->fmt_in.video.i_visible_height;
+
+    if( count == 1 || count > SWS_BANDS_MAX )
+    {
+        /* The first band does the whole picture with the main context */
+        if( index == 0 )
+            Convert( p_filter, p_sys->ctx, band->p_dst, band->p_src,
+                     i_height, band->i_plane_count,
+                     p_sys->b_swap_uvi, p_sys->b_swap_uvo );
+        return;
+    }
+
+    const int i_start = (i_height * index / count) & ~(BAND_ALIGN - 1);
+    const int i_end = index + 1 < count
+                    ? (int)(i_height * (index + 1) / count) & ~(BAND_ALIGN - 1)
+                    : i_height;
+    if( i_end <= i_start )
+        return;
+
+    struct SwsContext *ctx = p_sys->bands_ctx[index];
+    if( ctx == NULL || p_sys->i_bands_height[index] != i_end - i_start )
+    {
+        const int i_width = p_filter->fmt_in.video.i_visible_width;
+
+        vlc_mutex_lock( &p_sys->bands_lock );
+        if( ctx )
+            sws_freeContext( ctx );
+        ctx = sws_getContext( i_width, i_end - i_start, p_sys->i_bands_fmti,
+                              i_width, i_end - i_start, p_sys->i_bands_fmto,
+                              p_sys->i_bands_flags, p_sys->p_filter, NULL, 0 );
+        vlc_mutex_unlock( &p_sys->bands_lock );
+
+        p_sys->bands_ctx[index] = ctx;
+        p_sys->i_bands_height[index] = i_end - i_start;
+        if( ctx == NULL )
+        {
+            msg_Err( p_filter, "could not init SwScaler for band %u", index );
+            return;
+        }
+    }
+
+    uint8_t *src[4]; int src_stride[4];
+    uint8_t *dst[4]; int dst_stride[4];
+
+    GetPixels( src, src_stride, p_sys->desc_in, &p_filter->fmt_in.video,
+               band->p_src, band->i_plane_count, p_sys->b_swap_uvi );
+    GetPixels( dst, dst_stride, p_sys->desc_out, &p_filter->fmt_out.video,
+               band->p_dst, band->i_plane_count, p_sys->b_swap_uvo );
+
+    for( unsigned i = 0; i < 4; i++ )
+    {
+        if( src[i] != NULL && i < p_sys->desc_in->plane_count )
+            src[i] += i_start * p_sys->desc_in->p[i].h.num
+                    / p_sys->desc_in->p[i].h.den * src_stride[i];
+        if( dst[i] != NULL && i < p_sys->desc_out->plane_count )
+            dst[i] += i_start * p_sys->desc_out->p[i].h.num
+                    / p_sys->desc_out->p[i].h.den * dst_stride[i];
+    }
+
+#if LIBSWSCALE_VERSION_INT  >= ((0<<16)+(5<<8)+0)
+    sws_scale( ctx, src, src_stride, 0, i_end - i_start, dst, dst_stride );
+#else
+    sws_scale_ordered( ctx, src, src_stride, 0, i_end - i_start,
+                       dst, dst_stride );
+#endif
+}
+
 /****************************************************************************
  * Filter: the whole thing
  ****************************************************************************
@@ -661,8 +777,19 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
         /* Even if alpha is unused, swscale expects the pointer to be set */
         const int n_planes = !p_sys->ctxA && (p_src->i_planes == 4 ||
                              p_dst->i_planes == 4) ? 4 : 3;
-        Convert( p_filter, p_sys->ctx, p_dst, p_src, p_fmti->i_visible_height,
-                 n_planes, p_sys->b_swap_uvi, p_sys->b_swap_uvo );
+        if( p_sys->b_bands )
+        {
+            struct sws_band band = {
+                .p_dst = p_dst,
+                .p_src = p_src,
+                .i_plane_count = n_planes,
+            };
+            filter_RunSlices( p_filter, ConvertBand, &band );
+        }
+        else
+            Convert( p_filter, p_sys->ctx, p_dst, p_src,
+                     p_fmti->i_visible_height, n_planes,
+                     p_sys->b_swap_uvi, p_sys->b_swap_uvo );
     }
     if( p_sys->ctxA )
     {
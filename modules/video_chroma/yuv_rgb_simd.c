@@ -0,0 +1,527 @@
+/*****************************************************************************
+ * yuv_rgb_simd.c : YUV 4:2:0 to RGB conversions with AVX2 or AArch64 NEON
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * All the kernels use the same fixed point arithmetic, so that they output
+ * exactly the same pixels as the C code used for the end of the lines:
+ * samples are centered and scaled by 64, multiplied by Q13 coefficients
+ * keeping the high 16 bits, and the sums are rounded from Q3.
+ *
+ * Semi-planar and 10-bits pictures are converted one line at a time to
+ * planar 8-bits samples first.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_cpu.h>
+
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CAN_COMPILE_ARM64_NEON
+#endif
+
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+
+vlc_module_begin ()
+    set_description( N_("SIMD YUV 4:2:0 to RGB conversions") )
+    set_capability( "video filter", 160 )
+    set_callbacks( Open, Close )
+vlc_module_end ()
+
+struct filter_sys_t
+{
+    /* Conversion matrix (Q13) */
+    int16_t y_offset;
+    int16_t y_coef;
+    int16_t v_r;
+    int16_t u_g;
+    int16_t v_g;
+    int16_t u_b;
+
+    /* Pixel packing */
+    bool rgb16;
+    uint8_t rr, lr, rg, lg, rb, lb;
+    uint32_t alpha; /**< bits of the pixel not covered by the masks */
+
+    void (*row)( const filter_sys_t *, void *, const uint8_t *,
+                 const uint8_t *, const uint8_t *, unsigned );
+
+    /* Planar 8-bits lines of semi-planar or 10-bits pictures */
+    uint8_t *line_y, *line_u, *line_v;
+};
+
+static inline int16_t MulHi( int a, int c )
+{
+    return (a * c) >> 16;
+}
+
+static inline uint8_t Round8( int v )
+{
+    v = (v + 4) >> 3;
+    return (v < 0) ? 0 : (v > 255) ? 255 : v;
+}
+
+static void PixelsC( const filter_sys_t *sys, void *dst, const uint8_t *y,
+                     const uint8_t *u, const uint8_t *v,
+                     unsigned from, unsigned to )
+{
+    for( unsigned i = from; i < to; i++ )
+    {
+        int yy = MulHi( (y[i] - sys->y_offset) * 64, sys->y_coef );
+        int uu = (u[i / 2] - 128) * 64;
+        int vv = (v[i / 2] - 128) * 64;
+
+        uint32_t r = Round8( yy + MulHi( vv, sys->v_r ) );
+        uint32_t g = Round8( yy + MulHi( uu, sys->u_g )
+                                + MulHi( vv, sys->v_g ) );
+        uint32_t b = Round8( yy + MulHi( uu, sys->u_b ) );
+        uint32_t px = ((r >> sys->rr) << sys->lr)
+                    | ((g >> sys->rg) << sys->lg)
+                    | ((b >> sys->rb) << sys->lb) | sys->alpha;
+
+        if( sys->rgb16 )
+        {
+            uint16_t px16 = px;
+            memcpy( (uint8_t *)dst + 2 * i, &px16, 2 );
+        }
+        else
+            memcpy( (uint8_t *)dst + 4 * i, &px, 4 );
+    }
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+VLC_AVX2
+static void RowAVX2( const filter_sys_t *sys, void *dst, const uint8_t *y,
+                     const uint8_t *u, const uint8_t *v, unsigned width )
+{
+    const __m256i y_offset = _mm256_set1_epi16( sys->y_offset );
+    const __m256i y_coef = _mm256_set1_epi16( sys->y_coef );
+    const __m256i v_r = _mm256_set1_epi16( sys->v_r );
+    const __m256i u_g = _mm256_set1_epi16( sys->u_g );
+    const __m256i v_g = _mm256_set1_epi16( sys->v_g );
+    const __m256i u_b = _mm256_set1_epi16( sys->u_b );
+    const __m256i c128 = _mm256_set1_epi16( 128 );
+    const __m256i round = _mm256_set1_epi16( 4 );
+    const __m256i max = _mm256_set1_epi16( 255 );
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha = _mm256_set1_epi32( sys->alpha );
+    const __m128i rr = _mm_cvtsi32_si128( sys->rr );
+    const __m128i lr = _mm_cvtsi32_si128( sys->lr );
+    const __m128i rg = _mm_cvtsi32_si128( sys->rg );
+    const __m128i lg = _mm_cvtsi32_si128( sys->lg );
+    const __m128i rb = _mm_cvtsi32_si128( sys->rb );
+    const __m128i lb = _mm_cvtsi32_si128( sys->lb );
+    unsigned i = 0;
+
+    for( ; i + 16 <= width; i += 16 )
+    {
+        __m128i u8 = _mm_loadl_epi64( (const __m128i *)(u + i / 2) );
+        __m128i v8 = _mm_loadl_epi64( (const __m128i *)(v + i / 2) );
+        __m256i yy = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128( (const __m128i *)(y + i) ) );
+        __m256i uu = _mm256_cvtepu8_epi16( _mm_unpacklo_epi8( u8, u8 ) );
+        __m256i vv = _mm256_cvtepu8_epi16( _mm_unpacklo_epi8( v8, v8 ) );
+
+        yy = _mm256_slli_epi16( _mm256_sub_epi16( yy, y_offset ), 6 );
+        yy = _mm256_mulhi_epi16( yy, y_coef );
+        uu = _mm256_slli_epi16( _mm256_sub_epi16( uu, c128 ), 6 );
+        vv = _mm256_slli_epi16( _mm256_sub_epi16( vv, c128 ), 6 );
+
+        __m256i r = _mm256_add_epi16( yy, _mm256_mulhi_epi16( vv, v_r ) );
+        __m256i g = _mm256_add_epi16( yy, _mm256_add_epi16(
+                        _mm256_mulhi_epi16( uu, u_g ),
+                        _mm256_mulhi_epi16( vv, v_g ) ) );
+        __m256i b = _mm256_add_epi16( yy, _mm256_mulhi_epi16( uu, u_b ) );
+
+        r = _mm256_srai_epi16( _mm256_add_epi16( r, round ), 3 );
+        g = _mm256_srai_epi16( _mm256_add_epi16( g, round ), 3 );
+        b = _mm256_srai_epi16( _mm256_add_epi16( b, round ), 3 );
+        r = _mm256_min_epi16( _mm256_max_epi16( r, zero ), max );
+        g = _mm256_min_epi16( _mm256_max_epi16( g, zero ), max );
+        b = _mm256_min_epi16( _mm256_max_epi16( b, zero ), max );
+
+        if( sys->rgb16 )
+        {
+            __m256i px = _mm256_or_si256( _mm256_or_si256(
+                _mm256_sll_epi16( _mm256_srl_epi16( r, rr ), lr ),
+                _mm256_sll_epi16( _mm256_srl_epi16( g, rg ), lg ) ),
+                _mm256_sll_epi16( _mm256_srl_epi16( b, rb ), lb ) );
+
+            _mm256_storeu_si256( (__m256i *)((uint16_t *)dst + i), px );
+        }
+        else
+        {
+            /* The unpacking works within each 128-bits lane: pixels 0-3 and
+             * 8-11 end up in lo, pixels 4-7 and 12-15 in hi. */
+            __m256i lo = _mm256_or_si256( alpha, _mm256_or_si256(
+                _mm256_sll_epi32( _mm256_srl_epi32(
+                    _mm256_unpacklo_epi16( r, zero ), rr ), lr ),
+                _mm256_sll_epi32( _mm256_srl_epi32(
+                    _mm256_unpacklo_epi16( g, zero ), rg ), lg ) ) );
+            lo = _mm256_or_si256( lo, _mm256_sll_epi32( _mm256_srl_epi32(
+                    _mm256_unpacklo_epi16( b, zero ), rb ), lb ) );
+
+            __m256i hi = _mm256_or_si256( alpha, _mm256_or_si256(
+                _mm256_sll_epi32( _mm256_srl_epi32(
+                    _mm256_unpackhi_epi16( r, zero ), rr ), lr ),
+                _mm256_sll_epi32( _mm256_srl_epi32(
+                    _mm256_unpackhi_epi16( g, zero ), rg ), lg ) ) );
+            hi = _mm256_or_si256( hi, _mm256_sll_epi32( _mm256_srl_epi32(
+                    _mm256_unpackhi_epi16( b, zero ), rb ), lb ) );
+
+            uint32_t *out = (uint32_t *)dst + i;
+            _mm256_storeu_si256( (__m256i *)out,
+                                 _mm256_permute2x128_si256( lo, hi, 0x20 ) );
+            _mm256_storeu_si256( (__m256i *)(out + 8),
+                                 _mm256_permute2x128_si256( lo, hi, 0x31 ) );
+        }
+    }
+
+    PixelsC( sys, dst, y, u, v, i, width );
+}
+#endif
+
+#ifdef CAN_COMPILE_ARM64_NEON
+static inline int16x8_t MulHiNEON( int16x8_t a, int16x8_t c )
+{
+    int32x4_t lo = vmull_s16( vget_low_s16( a ), vget_low_s16( c ) );
+    int32x4_t hi = vmull_high_s16( a, c );
+
+    return vcombine_s16( vshrn_n_s32( lo, 16 ), vshrn_n_s32( hi, 16 ) );
+}
+
+static inline void PixelsNEON( const filter_sys_t *sys, void *dst,
+                               uint8x8_t y8, uint8x8_t u8, uint8x8_t v8 )
+{
+    const int16x8_t c128 = vdupq_n_s16( 128 );
+
+    int16x8_t yy = vreinterpretq_s16_u16( vmovl_u8( y8 ) );
+    int16x8_t uu = vreinterpretq_s16_u16( vmovl_u8( u8 ) );
+    int16x8_t vv = vreinterpretq_s16_u16( vmovl_u8( v8 ) );
+
+    yy = vshlq_n_s16( vsubq_s16( yy, vdupq_n_s16( sys->y_offset ) ), 6 );
+    yy = MulHiNEON( yy, vdupq_n_s16( sys->y_coef ) );
+    uu = vshlq_n_s16( vsubq_s16( uu, c128 ), 6 );
+    vv = vshlq_n_s16( vsubq_s16( vv, c128 ), 6 );
+
+    int16x8_t r = vaddq_s16( yy, MulHiNEON( vv, vdupq_n_s16( sys->v_r ) ) );
+    int16x8_t g = vaddq_s16( yy, vaddq_s16(
+                      MulHiNEON( uu, vdupq_n_s16( sys->u_g ) ),
+                      MulHiNEON( vv, vdupq_n_s16( sys->v_g ) ) ) );
+    int16x8_t b = vaddq_s16( yy, MulHiNEON( uu, vdupq_n_s16( sys->u_b ) ) );
+
+    uint16x8_t r16 = vmovl_u8( vqrshrun_n_s16( r, 3 ) );
+    uint16x8_t g16 = vmovl_u8( vqrshrun_n_s16( g, 3 ) );
+    uint16x8_t b16 = vmovl_u8( vqrshrun_n_s16( b, 3 ) );
+
+    if( sys->rgb16 )
+    {
+        uint16x8_t px = vorrq_u16( vorrq_u16(
+            vshlq_u16( vshlq_u16( r16, vdupq_n_s16( -sys->rr ) ),
+                       vdupq_n_s16( sys->lr ) ),
+            vshlq_u16( vshlq_u16( g16, vdupq_n_s16( -sys->rg ) ),
+                       vdupq_n_s16( sys->lg ) ) ),
+            vshlq_u16( vshlq_u16( b16, vdupq_n_s16( -sys->rb ) ),
+                       vdupq_n_s16( sys->lb ) ) );
+
+        vst1q_u16( dst, px );
+    }
+    else
+    {
+        const int32x4_t rr = vdupq_n_s32( -sys->rr );
+        const int32x4_t lr = vdupq_n_s32( sys->lr );
+        const int32x4_t rg = vdupq_n_s32( -sys->rg );
+        const int32x4_t lg = vdupq_n_s32( sys->lg );
+        const int32x4_t rb = vdupq_n_s32( -sys->rb );
+        const int32x4_t lb = vdupq_n_s32( sys->lb );
+        const uint32x4_t alpha = vdupq_n_u32( sys->alpha );
+
+        uint32x4_t lo = vorrq_u32( alpha, vorrq_u32( vorrq_u32(
+            vshlq_u32( vshlq_u32( vmovl_u16( vget_low_u16( r16 ) ), rr ), lr ),
+            vshlq_u32( vshlq_u32( vmovl_u16( vget_low_u16( g16 ) ), rg ), lg ) ),
+            vshlq_u32( vshlq_u32( vmovl_u16( vget_low_u16( b16 ) ), rb ), lb ) ) );
+        uint32x4_t hi = vorrq_u32( alpha, vorrq_u32( vorrq_u32(
+            vshlq_u32( vshlq_u32( vmovl_high_u16( r16 ), rr ), lr ),
+            vshlq_u32( vshlq_u32( vmovl_high_u16( g16 ), rg ), lg ) ),
+            vshlq_u32( vshlq_u32( vmovl_high_u16( b16 ), rb ), lb ) ) );
+
+        vst1q_u32( dst, lo );
+        vst1q_u32( (uint32_t *)dst + 4, hi );
+    }
+}
+
+static void RowNEON( const filter_sys_t *sys, void *dst, const uint8_t *y,
+                     const uint8_t *u, const uint8_t *v, unsigned width )
+{
+    const size_t pixel_size = sys->rgb16 ? 2 : 4;
+    unsigned i = 0;
+
+    for( ; i + 16 <= width; i += 16 )
+    {
+        uint8x16_t y8 = vld1q_u8( y + i );
+        uint8x8x2_t u8 = vzip_u8( vld1_u8( u + i / 2 ), vld1_u8( u + i / 2 ) );
+        uint8x8x2_t v8 = vzip_u8( vld1_u8( v + i / 2 ), vld1_u8( v + i / 2 ) );
+        uint8_t *out = (uint8_t *)dst + i * pixel_size;
+
+        PixelsNEON( sys, out, vget_low_u8( y8 ), u8.val[0], v8.val[0] );
+        PixelsNEON( sys, out + 8 * pixel_size, vget_high_u8( y8 ),
+                    u8.val[1], v8.val[1] );
+    }
+
+    PixelsC( sys, dst, y, u, v, i, width );
+}
+#endif
+
+/* Semi-planar chroma to planar */
+static void SplitChroma8( uint8_t *u, uint8_t *v, const uint8_t *uv,
+                          unsigned count )
+{
+    for( unsigned i = 0; i < count; i++ )
+    {
+        u[i] = uv[2 * i];
+        v[i] = uv[2 * i + 1];
+    }
+}
+
+static inline uint8_t To8( uint16_t sample )
+{
+    /* The 10 significant bits are the most significant ones */
+    return __MIN( (sample + 0x80) >> 8, 255 );
+}
+
+static void SplitChroma16( uint8_t *u, uint8_t *v, const uint16_t *uv,
+                           unsigned count )
+{
+    for( unsigned i = 0; i < count; i++ )
+    {
+        u[i] = To8( uv[2 * i] );
+        v[i] = To8( uv[2 * i + 1] );
+    }
+}
+
+static void Convert( filter_t *filter, picture_t *src, picture_t *dst )
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned width = filter->fmt_in.video.i_visible_width;
+    const unsigned height = filter->fmt_in.video.i_visible_height;
+    const unsigned chroma_width = (width + 1) / 2;
+    const plane_t *yp = &src->p[0];
+
+    for( unsigned j = 0; j < height; j++ )
+    {
+        const uint8_t *y = yp->p_pixels + j * yp->i_pitch;
+        const uint8_t *u, *v;
+        const unsigned cj = j / 2;
+
+        switch( filter->fmt_in.video.i_chroma )
+        {
+            case VLC_CODEC_I420:
+                u = src->p[1].p_pixels + cj * src->p[1].i_pitch;
+                v = src->p[2].p_pixels + cj * src->p[2].i_pitch;
+                break;
+            case VLC_CODEC_YV12:
+                v = src->p[1].p_pixels + cj * src->p[1].i_pitch;
+                u = src->p[2].p_pixels + cj * src->p[2].i_pitch;
+                break;
+            case VLC_CODEC_NV12:
+                if( (j & 1) == 0 )
+                    SplitChroma8( sys->line_u, sys->line_v,
+                                  src->p[1].p_pixels + cj * src->p[1].i_pitch,
+                                  chroma_width );
+                u = sys->line_u;
+                v = sys->line_v;
+                break;
+            case VLC_CODEC_P010:
+            {
+                const uint16_t *y16 = (const uint16_t *)y;
+
+                for( unsigned i = 0; i < width; i++ )
+                    sys->line_y[i] = To8( y16[i] );
+                y = sys->line_y;
+
+                if( (j & 1) == 0 )
+                    SplitChroma16( sys->line_u, sys->line_v,
+                        (const uint16_t *)(src->p[1].p_pixels
+                                           + cj * src->p[1].i_pitch),
+                        chroma_width );
+                u = sys->line_u;
+                v = sys->line_v;
+                break;
+            }
+            default:
+                vlc_assert_unreachable();
+        }
+
+        sys->row( sys, dst->p[0].p_pixels + j * dst->p[0].i_pitch,
+                  y, u, v, width );
+    }
+}
+
+VIDEO_FILTER_WRAPPER( Convert )
+
+static void SetMatrix( filter_sys_t *sys, const video_format_t *fmt )
+{
+    video_color_space_t space = fmt->space;
+    double kr, kb;
+
+    if( space == COLOR_SPACE_UNDEF )
+        space = (fmt->i_height > 576) ? COLOR_SPACE_BT709 : COLOR_SPACE_BT601;
+
+    switch( space )
+    {
+        case COLOR_SPACE_BT709:
+            kr = 0.2126;
+            kb = 0.0722;
+            break;
+        case COLOR_SPACE_BT2020:
+            kr = 0.2627;
+            kb = 0.0593;
+            break;
+        default:
+            kr = 0.299;
+            kb = 0.114;
+            break;
+    }
+
+    const double kg = 1. - kr - kb;
+    const bool full = fmt->b_color_range_full;
+    const double ys = full ? 1. : 255. / 219.;
+    const double cs = full ? 1. : 255. / 224.;
+
+    sys->y_offset = full ? 0 : 16;
+    sys->y_coef = lround( ys * 8192. );
+    sys->v_r = lround( 2. * (1. - kr) * cs * 8192. );
+    sys->u_g = -lround( 2. * kb * (1. - kb) / kg * cs * 8192. );
+    sys->v_g = -lround( 2. * kr * (1. - kr) / kg * cs * 8192. );
+    sys->u_b = lround( 2. * (1. - kb) * cs * 8192. );
+}
+
+static int Open( vlc_object_t *obj )
+{
+    filter_t *filter = (filter_t *)obj;
+    void (*row)( const filter_sys_t *, void *, const uint8_t *,
+                 const uint8_t *, const uint8_t *, unsigned ) = NULL;
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if( vlc_CPU_AVX2() )
+        row = RowAVX2;
+#endif
+#ifdef CAN_COMPILE_ARM64_NEON
+    if( vlc_CPU_ARM64_NEON() )
+        row = RowNEON;
+#endif
+    if( row == NULL )
+        return VLC_EGENERIC;
+
+    if( filter->fmt_in.video.i_width != filter->fmt_out.video.i_width
+     || filter->fmt_in.video.i_height != filter->fmt_out.video.i_height
+     || filter->fmt_in.video.orientation != filter->fmt_out.video.orientation )
+        return VLC_EGENERIC;
+
+    switch( filter->fmt_in.video.i_chroma )
+    {
+        case VLC_CODEC_I420:
+        case VLC_CODEC_YV12:
+        case VLC_CODEC_NV12:
+        case VLC_CODEC_P010:
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+
+    video_format_t fmt = filter->fmt_out.video;
+    bool rgb16;
+
+    switch( fmt.i_chroma )
+    {
+        case VLC_CODEC_RGB15:
+        case VLC_CODEC_RGB16:
+            rgb16 = true;
+            break;
+        case VLC_CODEC_RGB32:
+            rgb16 = false;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+    video_format_FixRgb( &fmt );
+
+    filter_sys_t *sys = malloc( sizeof (*sys) );
+    if( unlikely(sys == NULL) )
+        return VLC_ENOMEM;
+
+    const unsigned width = filter->fmt_in.video.i_visible_width;
+
+    sys->line_y = malloc( width + 2 * ((width + 1) / 2) );
+    if( unlikely(sys->line_y == NULL) )
+    {
+        free( sys );
+        return VLC_ENOMEM;
+    }
+    sys->line_u = sys->line_y + width;
+    sys->line_v = sys->line_u + (width + 1) / 2;
+
+    SetMatrix( sys, &filter->fmt_in.video );
+    sys->rgb16 = rgb16;
+    sys->rr = fmt.i_rrshift;
+    sys->lr = fmt.i_lrshift;
+    sys->rg = fmt.i_rgshift;
+    sys->lg = fmt.i_lgshift;
+    sys->rb = fmt.i_rbshift;
+    sys->lb = fmt.i_lbshift;
+    sys->alpha = rgb16 ? 0 : ~(fmt.i_rmask | fmt.i_gmask | fmt.i_bmask);
+    sys->row = row;
+
+    filter->p_sys = sys;
+    filter->pf_video_filter = Convert_Filter;
+
+    msg_Dbg( filter, "%4.4s to %4.4s conversion with %s",
+             (const char *)&filter->fmt_in.video.i_chroma,
+             (const char *)&fmt.i_chroma,
+#ifdef CAN_COMPILE_ARM64_NEON
+             "NEON"
+#else
+             "AVX2"
+#endif
+           );
+    return VLC_SUCCESS;
+}
+
+static void Close( vlc_object_t *obj )
+{
+    filter_t *filter = (filter_t *)obj;
+    filter_sys_t *sys = filter->p_sys;
+
+    free( sys->line_y );
+    free( sys );
+}
@@ -31,8 +31,22 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+# include <emmintrin.h>
+# define BLEND_HAVE_SSE2
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+# define BLEND_HAVE_AVX2
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(WORDS_BIGENDIAN)
+# include <arm_neon.h>
+# define BLEND_HAVE_NEON
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -382,6 +396,28 @@ private:
     uint8_t *data;
 };
 
+/* Gives direct access to the lines, for the row-based blending below */
+class CPictureRows : public CPicture {
+public:
+    CPictureRows(const CPicture &cfg) : CPicture(cfg)
+    {
+    }
+    uint8_t *getRow(unsigned plane, unsigned dy, unsigned ry,
+                    unsigned rx = 1, unsigned dx = 0) const
+    {
+        const plane_t *p = &picture->p[plane];
+        return &p->p_pixels[(y + dy) / ry * p->i_pitch + (x + dx) / rx];
+    }
+    unsigned getX() const
+    {
+        return x;
+    }
+    unsigned getY() const
+    {
+        return y;
+    }
+};
+
 typedef CPictureYUVPlanar<uint8_t,  1,1, true,  false> CPictureYUVA;
 
 typedef CPictureYUVPlanar<uint8_t,  4,4, false, true>  CPictureYV9;
@@ -547,6 +583,302 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
     }
 }
 
+/*****************************************************************************
+ * Row-based blending of YUVA pictures onto 8-bit planar and semi-planar YUV
+ *****************************************************************************/
+static unsigned BlendRowC(uint8_t *dst, const uint8_t *src,
+                          const uint8_t *src_a, unsigned n,
+                          unsigned, unsigned alpha)
+{
+    for (unsigned x = 0; x < n; x++) {
+        unsigned a = div255(alpha * src_a[x]);
+        if (a > 0)
+            merge(&dst[x], src[x], a);
+    }
+    return n;
+}
+
+static unsigned BlendRowSubC(uint8_t *dst, const uint8_t *src,
+                             const uint8_t *src_a, unsigned n,
+                             unsigned, unsigned alpha)
+{
+    for (unsigned x = 0; x < n; x++) {
+        unsigned a = div255(alpha * src_a[2 * x]);
+        if (a > 0)
+            merge(&dst[x], src[2 * x], a);
+    }
+    return n;
+}
+
+static unsigned BlendRowSubPackedC(uint8_t *dst, const uint8_t *src0,
+                                   const uint8_t *src1, const uint8_t *src_a,
+                                   unsigned n, unsigned, unsigned alpha)
+{
+    for (unsigned x = 0; x < n; x++) {
+        unsigned a = div255(alpha * src_a[2 * x]);
+        if (a > 0) {
+            merge(&dst[2 * x + 0], src0[2 * x], a);
+            merge(&dst[2 * x + 1], src1[2 * x], a);
+        }
+    }
+    return n;
+}
+
+#ifdef BLEND_HAVE_SSE2
+# define VEC __m128i
+# define LANES 8
+# define V_TARGET __attribute__ ((__target__ ("sse2")))
+# define V_LOAD(p) \
+    _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p)), _mm_setzero_si128())
+# define V_LOAD_EVEN(p) \
+    _mm_and_si128(_mm_loadu_si128((const __m128i *)(p)), _mm_set1_epi16(0xff))
+# define V_LOAD_W(p) _mm_loadu_si128((const __m128i *)(p))
+# define V_STORE(p, v) \
+    _mm_storel_epi64((__m128i *)(p), _mm_packus_epi16(v, v))
+# define V_STORE_W(p, v) _mm_storeu_si128((__m128i *)(p), v)
+# define V_ADD _mm_add_epi16
+# define V_SUB _mm_sub_epi16
+# define V_MUL _mm_mullo_epi16
+# define V_AND _mm_and_si128
+# define V_OR _mm_or_si128
+# define V_SET1 _mm_set1_epi16
+# define V_SRL8(v) _mm_srli_epi16(v, 8)
+# define V_SLL8(v) _mm_slli_epi16(v, 8)
+# define RENAME(a) a ## SSE2
+# include "blend_template.h"
+# undef VEC
+# undef LANES
+# undef V_TARGET
+# undef V_LOAD
+# undef V_LOAD_EVEN
+# undef V_LOAD_W
+# undef V_STORE
+# undef V_STORE_W
+# undef V_ADD
+# undef V_SUB
+# undef V_MUL
+# undef V_AND
+# undef V_OR
+# undef V_SET1
+# undef V_SRL8
+# undef V_SLL8
+# undef RENAME
+#endif
+
+#ifdef BLEND_HAVE_AVX2
+VLC_AVX2
+static inline void StoreAVX2(uint8_t *p, __m256i v)
+{
+    v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0xD8);
+    _mm_storeu_si128((__m128i *)p, _mm256_castsi256_si128(v));
+}
+
+# define VEC __m256i
+# define LANES 16
+# define V_TARGET VLC_AVX2
+# define V_LOAD(p) _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(p)))
+# define V_LOAD_EVEN(p) \
+    _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(p)), \
+                     _mm256_set1_epi16(0xff))
+# define V_LOAD_W(p) _mm256_loadu_si256((const __m256i *)(p))
+# define V_STORE(p, v) StoreAVX2(p, v)
+# define V_STORE_W(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+# define V_ADD _mm256_add_epi16
+# define V_SUB _mm256_sub_epi16
+# define V_MUL _mm256_mullo_epi16
+# define V_AND _mm256_and_si256
+# define V_OR _mm256_or_si256
+# define V_SET1 _mm256_set1_epi16
+# define V_SRL8(v) _mm256_srli_epi16(v, 8)
+# define V_SLL8(v) _mm256_slli_epi16(v, 8)
+# define RENAME(a) a ## AVX2
+# include "blend_template.h"
+# undef VEC
+# undef LANES
+# undef V_TARGET
+# undef V_LOAD
+# undef V_LOAD_EVEN
+# undef V_LOAD_W
+# undef V_STORE
+# undef V_STORE_W
+# undef V_ADD
+# undef V_SUB
+# undef V_MUL
+# undef V_AND
+# undef V_OR
+# undef V_SET1
+# undef V_SRL8
+# undef V_SLL8
+# undef RENAME
+#endif
+
+#ifdef BLEND_HAVE_NEON
+# define VEC uint16x8_t
+# define LANES 8
+# define V_TARGET
+# define V_LOAD(p) vmovl_u8(vld1_u8(p))
+# define V_LOAD_EVEN(p) vmovl_u8(vld2_u8(p).val[0])
+# define V_LOAD_W(p) vld1q_u16((const uint16_t *)(p))
+# define V_STORE(p, v) vst1_u8(p, vmovn_u16(v))
+# define V_STORE_W(p, v) vst1q_u16((uint16_t *)(p), v)
+# define V_ADD vaddq_u16
+# define V_SUB vsubq_u16
+# define V_MUL vmulq_u16
+# define V_AND vandq_u16
+# define V_OR vorrq_u16
+# define V_SET1 vdupq_n_u16
+# define V_SRL8(v) vshrq_n_u16(v, 8)
+# define V_SLL8(v) vshlq_n_u16(v, 8)
+# define RENAME(a) a ## NEON
+# include "blend_template.h"
+# undef VEC
+# undef LANES
+# undef V_TARGET
+# undef V_LOAD
+# undef V_LOAD_EVEN
+# undef V_LOAD_W
+# undef V_STORE
+# undef V_STORE_W
+# undef V_ADD
+# undef V_SUB
+# undef V_MUL
+# undef V_AND
+# undef V_OR
+# undef V_SET1
+# undef V_SRL8
+# undef V_SLL8
+# undef RENAME
+#endif
+
+/* The SIMD rows return how many samples they blended, the C rows do the
+ * rest */
+struct blend_rows_t {
+    unsigned (*row)(uint8_t *, const uint8_t *, const uint8_t *,
+                    unsigned, unsigned, unsigned);
+    unsigned (*row_sub)(uint8_t *, const uint8_t *, const uint8_t *,
+                        unsigned, unsigned, unsigned);
+    unsigned (*row_sub_packed)(uint8_t *, const uint8_t *, const uint8_t *,
+                               const uint8_t *, unsigned, unsigned, unsigned);
+};
+
+static const blend_rows_t *GetBlendRows()
+{
+    static const blend_rows_t rows_c = {
+        BlendRowC, BlendRowSubC, BlendRowSubPackedC,
+    };
+#ifdef BLEND_HAVE_AVX2
+    static const blend_rows_t rows_avx2 = {
+        BlendRowAVX2, BlendRowSubAVX2, BlendRowSubPackedAVX2,
+    };
+    if (vlc_CPU_AVX2())
+        return &rows_avx2;
+#endif
+#ifdef BLEND_HAVE_SSE2
+    static const blend_rows_t rows_sse2 = {
+        BlendRowSSE2, BlendRowSubSSE2, BlendRowSubPackedSSE2,
+    };
+    if (vlc_CPU_SSE2())
+        return &rows_sse2;
+#endif
+#ifdef BLEND_HAVE_NEON
+    static const blend_rows_t rows_neon = {
+        BlendRowNEON, BlendRowSubNEON, BlendRowSubPackedNEON,
+    };
+    if (vlc_CPU_ARM64_NEON())
+        return &rows_neon;
+#endif
+    return &rows_c;
+}
+
+static void BlendRow(const blend_rows_t *rows, uint8_t *dst,
+                     const uint8_t *src, const uint8_t *src_a,
+                     unsigned n, unsigned alpha)
+{
+    unsigned done = rows->row(dst, src, src_a, n, n, alpha);
+    BlendRowC(&dst[done], &src[done], &src_a[done], n - done, 0, alpha);
+}
+
+static void BlendRowSub(const blend_rows_t *rows, uint8_t *dst,
+                        const uint8_t *src, const uint8_t *src_a,
+                        unsigned width, unsigned alpha)
+{
+    unsigned n = (width + 1) / 2;
+    unsigned done = rows->row_sub(dst, src, src_a, n, width, alpha);
+    BlendRowSubC(&dst[done], &src[2 * done], &src_a[2 * done], n - done,
+                 0, alpha);
+}
+
+static void BlendRowSubPacked(const blend_rows_t *rows, uint8_t *dst,
+                              const uint8_t *src0, const uint8_t *src1,
+                              const uint8_t *src_a,
+                              unsigned width, unsigned alpha)
+{
+    unsigned n = (width + 1) / 2;
+    unsigned done = rows->row_sub_packed(dst, src0, src1, src_a, n, width,
+                                         alpha);
+    BlendRowSubPackedC(&dst[2 * done], &src0[2 * done], &src1[2 * done],
+                       &src_a[2 * done], n - done, 0, alpha);
+}
+
+/* Same as Blend<CPictureYUVPlanar<uint8_t, rx, ry, false, swap_uv>,
+ * CPictureYUVA, convertNone> with rx and ry up to 2, one row at a time */
+template <unsigned rx, unsigned ry, bool swap_uv>
+void BlendYUVAToPlanar(const CPicture &dst_data, const CPicture &src_data,
+                       unsigned width, unsigned height, int alpha)
+{
+    const blend_rows_t *rows = GetBlendRows();
+    CPictureRows src(src_data);
+    CPictureRows dst(dst_data);
+    /* First column that covers a chroma sample */
+    const unsigned dx = dst.getX() % rx;
+
+    for (unsigned y = 0; y < height; y++) {
+        const uint8_t *src_a = src.getRow(3, y, 1);
+
+        BlendRow(rows, dst.getRow(0, y, 1), src.getRow(0, y, 1), src_a,
+                 width, alpha);
+        if ((dst.getY() + y) % ry != 0 || width <= dx)
+            continue;
+
+        for (unsigned plane = 1; plane <= 2; plane++) {
+            uint8_t *d = dst.getRow(swap_uv ? 3 - plane : plane, y, ry, rx, dx);
+            const uint8_t *s = src.getRow(plane, y, 1, 1, dx);
+
+            if (rx == 1)
+                BlendRow(rows, d, s, src_a, width, alpha);
+            else
+                BlendRowSub(rows, d, s, &src_a[dx], width - dx, alpha);
+        }
+    }
+}
+
+/* Same as Blend<CPictureYUVSemiPlanar<swap_uv>, CPictureYUVA, convertNone>,
+ * one row at a time */
+template <bool swap_uv>
+void BlendYUVAToSemiPlanar(const CPicture &dst_data, const CPicture &src_data,
+                           unsigned width, unsigned height, int alpha)
+{
+    const blend_rows_t *rows = GetBlendRows();
+    CPictureRows src(src_data);
+    CPictureRows dst(dst_data);
+    const unsigned dx = dst.getX() % 2;
+
+    for (unsigned y = 0; y < height; y++) {
+        const uint8_t *src_a = src.getRow(3, y, 1);
+
+        BlendRow(rows, dst.getRow(0, y, 1), src.getRow(0, y, 1), src_a,
+                 width, alpha);
+        if ((dst.getY() + y) % 2 != 0 || width <= dx)
+            continue;
+
+        const uint8_t *u = src.getRow(1, y, 1, 1, dx);
+        const uint8_t *v = src.getRow(2, y, 1, 1, dx);
+        BlendRowSubPacked(rows, dst.getRow(1, y, 2, 1, dx),
+                          swap_uv ? v : u, swap_uv ? u : v, &src_a[dx],
+                          width - dx, alpha);
+    }
+}
+
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
@@ -555,6 +887,18 @@ static const struct {
     vlc_fourcc_t     src;
     blend_function_t blend;
 } blends[] = {
+    /* The first match is used, so these take precedence over the generic
+     * per-pixel versions below */
+    { VLC_CODEC_I420, VLC_CODEC_YUVA, BlendYUVAToPlanar<2, 2, false> },
+    { VLC_CODEC_J420, VLC_CODEC_YUVA, BlendYUVAToPlanar<2, 2, false> },
+    { VLC_CODEC_YV12, VLC_CODEC_YUVA, BlendYUVAToPlanar<2, 2, true> },
+    { VLC_CODEC_I422, VLC_CODEC_YUVA, BlendYUVAToPlanar<2, 1, false> },
+    { VLC_CODEC_J422, VLC_CODEC_YUVA, BlendYUVAToPlanar<2, 1, false> },
+    { VLC_CODEC_I444, VLC_CODEC_YUVA, BlendYUVAToPlanar<1, 1, false> },
+    { VLC_CODEC_J444, VLC_CODEC_YUVA, BlendYUVAToPlanar<1, 1, false> },
+    { VLC_CODEC_NV12, VLC_CODEC_YUVA, BlendYUVAToSemiPlanar<false> },
+    { VLC_CODEC_NV21, VLC_CODEC_YUVA, BlendYUVAToSemiPlanar<true> },
+
 #undef RGB
 #undef YUV
 #define RGB(csp, picture, cvt) \
@@ -671,8 +1015,10 @@ static int Open(vlc_object_t *object)
 
     filter_sys_t *sys = new filter_sys_t();
     for (size_t i = 0; i < sizeof(blends) / sizeof(*blends); i++) {
-        if (blends[i].src == src && blends[i].dst == dst)
+        if (blends[i].src == src && blends[i].dst == dst) {
             sys->blend = blends[i].blend;
+            break;
+        }
     }
 
     if (!sys->blend) {
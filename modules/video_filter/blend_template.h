@@ -0,0 +1,106 @@
+/*****************************************************************************
+ * blend_template.h: SIMD rows for the alpha blending of YUVA pictures
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* This file is included once per instruction set, with the following
+ * defined:
+ *  - VEC: a vector of LANES unsigned 16-bit integers,
+ *  - V_TARGET: the function attributes required by the instruction set,
+ *  - V_LOAD(p): loads LANES bytes,
+ *  - V_LOAD_EVEN(p): loads the LANES even bytes out of 2 * LANES bytes,
+ *  - V_LOAD_W(p) / V_STORE_W(p, v): loads/stores LANES 16-bit words,
+ *  - V_STORE(p, v): stores LANES bytes,
+ *  - the V_ADD, V_SUB, V_MUL, V_AND, V_OR, V_SET1, V_SRL8 and V_SLL8
+ *    arithmetic;
+ *  - RENAME(a): the instruction set specific name of a.
+ *
+ * All the intermediate values fit in 16 bits, so that the results are
+ * exactly the same as with the C merge() and div255(). */
+
+V_TARGET
+static inline VEC RENAME(div255)(VEC v)
+{
+    return V_SRL8(V_ADD(V_ADD(V_SRL8(v), v), V_SET1(1)));
+}
+
+V_TARGET
+static inline VEC RENAME(merge)(VEC dst, VEC src, VEC a)
+{
+    return RENAME(div255)(V_ADD(V_MUL(V_SUB(V_SET1(255), a), dst),
+                                V_MUL(src, a)));
+}
+
+/* Blends n samples with their own alpha */
+V_TARGET
+static unsigned RENAME(BlendRow)(uint8_t *dst, const uint8_t *src,
+                                 const uint8_t *src_a, unsigned n,
+                                 unsigned width, unsigned alpha)
+{
+    const VEC va = V_SET1(alpha);
+    unsigned x = 0;
+
+    VLC_UNUSED(width);
+    for (; x + LANES <= n; x += LANES) {
+        VEC a = RENAME(div255)(V_MUL(va, V_LOAD(&src_a[x])));
+
+        V_STORE(&dst[x], RENAME(merge)(V_LOAD(&dst[x]), V_LOAD(&src[x]), a));
+    }
+    return x;
+}
+
+/* Blends n horizontally subsampled samples with the alpha of every other
+ * source sample, out of width source samples */
+V_TARGET
+static unsigned RENAME(BlendRowSub)(uint8_t *dst, const uint8_t *src,
+                                    const uint8_t *src_a, unsigned n,
+                                    unsigned width, unsigned alpha)
+{
+    const VEC va = V_SET1(alpha);
+    unsigned x = 0;
+
+    for (; x + LANES <= n && 2 * (x + LANES) <= width; x += LANES) {
+        VEC a = RENAME(div255)(V_MUL(va, V_LOAD_EVEN(&src_a[2 * x])));
+
+        V_STORE(&dst[x], RENAME(merge)(V_LOAD(&dst[x]),
+                                       V_LOAD_EVEN(&src[2 * x]), a));
+    }
+    return x;
+}
+
+/* Same as BlendRowSub() for two interleaved destination planes */
+V_TARGET
+static unsigned RENAME(BlendRowSubPacked)(uint8_t *dst, const uint8_t *src0,
+                                          const uint8_t *src1,
+                                          const uint8_t *src_a, unsigned n,
+                                          unsigned width, unsigned alpha)
+{
+    const VEC va = V_SET1(alpha);
+    const VEC mask = V_SET1(0xff);
+    unsigned x = 0;
+
+    for (; x + LANES <= n && 2 * (x + LANES) <= width; x += LANES) {
+        VEC a = RENAME(div255)(V_MUL(va, V_LOAD_EVEN(&src_a[2 * x])));
+        VEC d = V_LOAD_W(&dst[2 * x]);
+        VEC d0 = RENAME(merge)(V_AND(d, mask), V_LOAD_EVEN(&src0[2 * x]), a);
+        VEC d1 = RENAME(merge)(V_SRL8(d), V_LOAD_EVEN(&src1[2 * x]), a);
+
+        V_STORE_W(&dst[2 * x], V_OR(d0, V_SLL8(d1)));
+    }
+    return x;
+}
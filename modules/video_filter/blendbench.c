@@ -37,6 +37,8 @@
 #include <vlc_filter.h>
 #include <vlc_image.h>
 
+#include <string.h>
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -56,17 +58,22 @@ static picture_t *Filter( filter_t *, picture_t * );
 #define ALPHA_LONGTEXT N_("Alpha with which the blend image is blended")
 
 #define BASE_IMAGE_TEXT N_("Image to be blended onto")
-#define BASE_IMAGE_LONGTEXT N_("The image which will be used to blend onto")
+#define BASE_IMAGE_LONGTEXT N_("The image which will be used to blend onto. " \
+                               "A noise image is generated if none is given.")
 
-#define BASE_CHROMA_TEXT N_("Chroma for the base image")
-#define BASE_CHROMA_LONGTEXT N_("Chroma which the base image will be loaded in")
+#define BASE_CHROMA_TEXT N_("Chromas for the base image")
+#define BASE_CHROMA_LONGTEXT N_("Comma-separated list of chromas which the " \
+                                "base image will be loaded in")
 
 #define BLEND_IMAGE_TEXT N_("Image which will be blended")
-#define BLEND_IMAGE_LONGTEXT N_("The image blended onto the base image")
+#define BLEND_IMAGE_LONGTEXT N_("The image blended onto the base image. " \
+                                "A noise image is generated if none is given.")
 
-#define BLEND_CHROMA_TEXT N_("Chroma for the blend image")
-#define BLEND_CHROMA_LONGTEXT N_("Chroma which the blend image will be loaded" \
-                                 " in")
+#define BLEND_CHROMA_TEXT N_("Chromas for the blend image")
+#define BLEND_CHROMA_LONGTEXT N_("Comma-separated list of chromas which the " \
+                                 "blend image will be loaded in. Every " \
+                                 "blend chroma is benchmarked onto every " \
+                                 "base chroma.")
 
 #define CFG_PREFIX "blendbench-"
 
@@ -106,21 +113,101 @@ static const char *const ppsz_filter_options[] = {
 /*****************************************************************************
  * filter_sys_t: filter method descriptor
  *****************************************************************************/
+#define MAX_CHROMAS 16
+
+/* Size of the generated images */
+#define NOISE_WIDTH  1920
+#define NOISE_HEIGHT 1080
+
 struct filter_sys_t
 {
     bool b_done;
     int i_loops, i_alpha;
 
-    picture_t *p_base_image;
-    picture_t *p_blend_image;
+    char *psz_base_image;
+    char *psz_blend_image;
 
-    vlc_fourcc_t i_base_chroma;
-    vlc_fourcc_t i_blend_chroma;
+    unsigned i_base_chromas;
+    unsigned i_blend_chromas;
+    vlc_fourcc_t pi_base_chroma[MAX_CHROMAS];
+    vlc_fourcc_t pi_blend_chroma[MAX_CHROMAS];
 };
 
+static unsigned blendbench_ParseChromas( vlc_object_t *p_this,
+                                         vlc_fourcc_t *pi_chroma,
+                                         const char *psz_list )
+{
+    char *psz_dup = strdup( psz_list ), *psz_save;
+    unsigned i_count = 0;
+
+    if( psz_dup == NULL )
+        return 0;
+
+    for( char *psz = strtok_r( psz_dup, ",", &psz_save );
+         psz != NULL && i_count < MAX_CHROMAS;
+         psz = strtok_r( NULL, ",", &psz_save ) )
+    {
+        vlc_fourcc_t i_chroma = vlc_fourcc_GetCodecFromString( VIDEO_ES, psz );
+        if( i_chroma == 0 )
+        {
+            msg_Warn( p_this, "Unknown chroma %s", psz );
+            continue;
+        }
+        pi_chroma[i_count++] = i_chroma;
+    }
+    free( psz_dup );
+    return i_count;
+}
+
+static picture_t *blendbench_GenerateImage( vlc_object_t *p_this,
+                                            vlc_fourcc_t i_chroma,
+                                            const char *psz_name )
+{
+    if( i_chroma == VLC_CODEC_YUVP )
+    {
+        msg_Err( p_this, "Cannot generate a %s image without palette",
+                 psz_name );
+        return NULL;
+    }
+
+    video_format_t fmt;
+    video_format_Init( &fmt, 0 );
+    video_format_Setup( &fmt, i_chroma, NOISE_WIDTH, NOISE_HEIGHT,
+                        NOISE_WIDTH, NOISE_HEIGHT, 1, 1 );
+
+    picture_t *p_pic = picture_NewFromFormat( &fmt );
+    if( p_pic == NULL )
+    {
+        msg_Err( p_this, "Unable to generate %s image", psz_name );
+        return NULL;
+    }
+
+    /* Noise, including the alpha channel, so that the blending cannot take
+     * shortcuts on fully transparent areas */
+    uint32_t i_seed = 0x5eed;
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        plane_t *p = &p_pic->p[i];
+
+        for( int j = 0; j < p->i_lines * p->i_pitch; j++ )
+        {
+            i_seed = i_seed * 1103515245 + 12345;
+            p->p_pixels[j] = i_seed >> 24;
+        }
+    }
+    return p_pic;
+}
+
 static int blendbench_LoadImage( vlc_object_t *p_this, picture_t **pp_pic,
-                                 vlc_fourcc_t i_chroma, char *psz_file, const char *psz_name )
+                                 vlc_fourcc_t i_chroma, const char *psz_file,
+                                 const char *psz_name )
 {
+    if( psz_file == NULL || *psz_file == '\0' )
+    {
+        *pp_pic = blendbench_GenerateImage( p_this, i_chroma, psz_name );
+        return *pp_pic != NULL ? VLC_SUCCESS : VLC_EGENERIC;
+    }
+
     image_handler_t *p_image;
     video_format_t fmt_in, fmt_out;
 
@@ -152,8 +239,7 @@ static int Create( vlc_object_t *p_this )
 {
     filter_t *p_filter = (filter_t *)p_this;
     filter_sys_t *p_sys;
-    char *psz_temp, *psz_cmd;
-    int i_ret;
+    char *psz_temp;
 
     /* Allocate structure */
     p_filter->p_sys = malloc( sizeof( filter_sys_t ) );
@@ -176,28 +262,29 @@ static int Create( vlc_object_t *p_this )
                                                   CFG_PREFIX "alpha" );
 
     psz_temp = var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-chroma" );
-    p_sys->i_base_chroma = VLC_FOURCC( psz_temp[0], psz_temp[1],
-                                       psz_temp[2], psz_temp[3] );
-    psz_cmd = var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-image" );
-    i_ret = blendbench_LoadImage( p_this, &p_sys->p_base_image,
-                                  p_sys->i_base_chroma, psz_cmd, "Base" );
+    p_sys->i_base_chromas = blendbench_ParseChromas( p_this,
+                                                     p_sys->pi_base_chroma,
+                                                     psz_temp );
     free( psz_temp );
-    free( psz_cmd );
-    if( i_ret != VLC_SUCCESS )
-    {
-        free( p_sys );
-        return i_ret;
-    }
 
     psz_temp = var_CreateGetStringCommand( p_filter,
                                            CFG_PREFIX "blend-chroma" );
-    p_sys->i_blend_chroma = VLC_FOURCC( psz_temp[0], psz_temp[1],
-                                        psz_temp[2], psz_temp[3] );
-    psz_cmd = var_CreateGetStringCommand( p_filter, CFG_PREFIX "blend-image" );
-    blendbench_LoadImage( p_this, &p_sys->p_blend_image, p_sys->i_blend_chroma,
-                          psz_cmd, "Blend" );
+    p_sys->i_blend_chromas = blendbench_ParseChromas( p_this,
+                                                      p_sys->pi_blend_chroma,
+                                                      psz_temp );
     free( psz_temp );
-    free( psz_cmd );
+
+    if( p_sys->i_base_chromas == 0 || p_sys->i_blend_chromas == 0 )
+    {
+        msg_Err( p_filter, "No valid chroma to benchmark" );
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+
+    p_sys->psz_base_image = var_CreateGetStringCommand( p_filter,
+                                                  CFG_PREFIX "base-image" );
+    p_sys->psz_blend_image = var_CreateGetStringCommand( p_filter,
+                                                  CFG_PREFIX "blend-image" );
 
     return VLC_SUCCESS;
 }
@@ -210,57 +297,95 @@ static void Destroy( vlc_object_t *p_this )
     filter_t *p_filter = (filter_t *)p_this;
     filter_sys_t *p_sys = p_filter->p_sys;
 
-    picture_Release( p_sys->p_base_image );
-    picture_Release( p_sys->p_blend_image );
+    free( p_sys->psz_base_image );
+    free( p_sys->psz_blend_image );
+    free( p_sys );
 }
 
 /*****************************************************************************
- * Render: displays previously rendered output
+ * Benchmark: blends one image onto another many times
  *****************************************************************************/
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+static void blendbench_Run( filter_t *p_filter, picture_t *p_base,
+                            picture_t *p_blend )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    filter_t *p_blend;
-
-    if( p_sys->b_done )
-        return p_pic;
-
-    p_blend = vlc_object_create( p_filter, sizeof(filter_t) );
-    if( !p_blend )
-    {
-        picture_Release( p_pic );
-        return NULL;
-    }
-    p_blend->fmt_out.video = p_sys->p_base_image->format;
-    p_blend->fmt_in.video = p_sys->p_blend_image->format;
-    p_blend->p_module = module_need( p_blend, "video blending", NULL, false );
-    if( !p_blend->p_module )
+    const vlc_fourcc_t i_base = p_base->format.i_chroma;
+    const vlc_fourcc_t i_blend = p_blend->format.i_chroma;
+
+    filter_t *p_blender = vlc_object_create( p_filter, sizeof(filter_t) );
+    if( !p_blender )
+        return;
+    p_blender->fmt_out.video = p_base->format;
+    p_blender->fmt_in.video = p_blend->format;
+    p_blender->p_module = module_need( p_blender, "video blending", NULL,
+                                       false );
+    if( !p_blender->p_module )
     {
-        picture_Release( p_pic );
-        vlc_object_release( p_blend );
-        return NULL;
+        msg_Warn( p_filter, "Cannot blend %4.4s onto %4.4s",
+                  (const char *)&i_blend, (const char *)&i_base );
+        vlc_object_release( p_blender );
+        return;
     }
 
     mtime_t time = mdate();
     for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
     {
-        p_blend->pf_video_blend( p_blend,
-                                 p_sys->p_base_image, p_sys->p_blend_image,
-                                 0, 0, p_sys->i_alpha );
+        p_blender->pf_video_blend( p_blender, p_base, p_blend,
+                                   0, 0, p_sys->i_alpha );
     }
     time = mdate() - time;
 
-    msg_Info( p_filter, "Blended %d images in %f sec", p_sys->i_loops,
+    const unsigned i_width = __MIN( p_base->format.i_visible_width,
+                                    p_blend->format.i_visible_width );
+    const unsigned i_height = __MIN( p_base->format.i_visible_height,
+                                     p_blend->format.i_visible_height );
+
+    msg_Info( p_filter, "Blended %d %4.4s images onto %4.4s in %f sec",
+              p_sys->i_loops, (const char *)&i_blend, (const char *)&i_base,
               time / 1000000.0f );
-    msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
-              (float) p_sys->i_loops / time * 1000000,
-              (float) p_sys->i_loops / time * 1000000 *
-                  p_sys->p_blend_image->p[Y_PLANE].i_visible_pitch *
-                  p_sys->p_blend_image->p[Y_PLANE].i_visible_lines );
+    if( time > 0 )
+        msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
+                  (float) p_sys->i_loops / time * 1000000,
+                  (float) p_sys->i_loops / time * 1000000 *
+                      i_width * i_height );
+
+    module_unneed( p_blender, p_blender->p_module );
+    vlc_object_release( p_blender );
+}
+
+/*****************************************************************************
+ * Render: displays previously rendered output
+ *****************************************************************************/
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    vlc_object_t *p_this = VLC_OBJECT(p_filter);
 
-    module_unneed( p_blend, p_blend->p_module );
+    if( p_sys->b_done )
+        return p_pic;
+
+    for( unsigned i = 0; i < p_sys->i_base_chromas; i++ )
+    {
+        picture_t *p_base;
 
-    vlc_object_release( p_blend );
+        if( blendbench_LoadImage( p_this, &p_base, p_sys->pi_base_chroma[i],
+                                  p_sys->psz_base_image, "Base" ) )
+            continue;
+
+        for( unsigned j = 0; j < p_sys->i_blend_chromas; j++ )
+        {
+            picture_t *p_blend;
+
+            if( blendbench_LoadImage( p_this, &p_blend,
+                                      p_sys->pi_blend_chroma[j],
+                                      p_sys->psz_blend_image, "Blend" ) )
+                continue;
+
+            blendbench_Run( p_filter, p_base, p_blend );
+            picture_Release( p_blend );
+        }
+        picture_Release( p_base );
+    }
 
     p_sys->b_done = true;
     return p_pic;
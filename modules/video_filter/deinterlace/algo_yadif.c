@@ -108,6 +108,11 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
         void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
                        int w, int prefs, int mrefs, int parity, int mode);
 
+#if defined(HAVE_YADIF_AVX2)
+        if( vlc_CPU_AVX2() )
+            filter = yadif_filter_line_avx2;
+        else
+#endif
 #if defined(HAVE_YADIF_SSSE3)
         if( vlc_CPU_SSSE3() )
             filter = yadif_filter_line_ssse3;
@@ -122,6 +127,11 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
         if( vlc_CPU_MMX() )
             filter = yadif_filter_line_mmx;
         else
+#endif
+#if defined(HAVE_YADIF_NEON)
+        if( vlc_CPU_ARM64_NEON() )
+            filter = yadif_filter_line_neon;
+        else
 #endif
             filter = yadif_filter_line_c;
 
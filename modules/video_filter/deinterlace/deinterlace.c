@@ -55,6 +55,11 @@
 #define SOUT_MODE_TEXT N_("Streaming deinterlace mode")
 #define SOUT_MODE_LONGTEXT N_("Deinterlace method to use for streaming.")
 
+#define THREADED_TEXT N_("Deinterlace in a separate thread")
+#define THREADED_LONGTEXT N_("Process the frames in a dedicated thread, " \
+                             "overlapping with their display or encoding. " \
+                             "This delays the output by one frame.")
+
 #define FILTER_CFG_PREFIX "sout-deinterlace-"
 
 /* Tooltips drop linefeeds (at least in the Qt GUI);
@@ -111,6 +116,8 @@ vlc_module_begin ()
                 PHOSPHOR_DIMMER_LONGTEXT, true )
         change_integer_list( phosphor_dimmer_list, phosphor_dimmer_list_text )
         change_safe ()
+    add_bool( FILTER_CFG_PREFIX "threaded", true, THREADED_TEXT,
+              THREADED_LONGTEXT, true )
     add_shortcut( "deinterlace" )
     set_callbacks( Open, Close )
 vlc_module_end ()
@@ -126,7 +133,7 @@ vlc_module_end ()
  * and reading logic for them implemented in Open().
  */
 static const char *const ppsz_filter_options[] = {
-    "mode", "phosphor-chroma", "phosphor-dimmer",
+    "mode", "phosphor-chroma", "phosphor-dimmer", "threaded",
     NULL
 };
 
@@ -274,6 +281,15 @@ static void GetOutputFormat( filter_t *p_filter,
 
 #define DEINTERLACE_DST_SIZE 3
 
+/* The filter owner's picture allocator may only be used from the calling
+ * thread, so the worker thread allocates the output pictures itself. */
+static picture_t *NewPicture( filter_t *p_filter )
+{
+    if( p_filter->p_sys->worker.b_active )
+        return picture_NewFromFormat( &p_filter->fmt_out.video );
+    return filter_NewPicture( p_filter );
+}
+
 /* This is the filter function. See Open(). */
 picture_t *Deinterlace( filter_t *p_filter, picture_t *p_pic )
 {
@@ -281,7 +297,7 @@ picture_t *Deinterlace( filter_t *p_filter, picture_t *p_pic )
     picture_t *p_dst[DEINTERLACE_DST_SIZE];
 
     /* Request output picture */
-    p_dst[0] = filter_NewPicture( p_filter );
+    p_dst[0] = NewPicture( p_filter );
     if( p_dst[0] == NULL )
     {
         picture_Release( p_pic );
@@ -410,7 +426,7 @@ picture_t *Deinterlace( filter_t *p_filter, picture_t *p_pic )
         for( int i = 1; i < i_double_rate_alloc_end ; ++i )
         {
             p_dst[i-1]->p_next =
-            p_dst[i]           = filter_NewPicture( p_filter );
+            p_dst[i]           = NewPicture( p_filter );
             if( p_dst[i] )
             {
                 picture_CopyProperties( p_dst[i], p_pic );
@@ -557,6 +573,158 @@ drop:
     return NULL;
 }
 
+/*****************************************************************************
+ * Asynchronous deinterlacing
+ *****************************************************************************/
+
+/* Maximum number of input frames queued or being processed when
+ * DeinterlaceAsync() returns. */
+#define WORKER_DEPTH 1
+
+static void *Thread( void *data )
+{
+    filter_t *p_filter = data;
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    vlc_mutex_lock( &p_sys->worker.lock );
+    for( ;; )
+    {
+        while( p_sys->worker.p_in == NULL && !p_sys->worker.b_exit )
+            vlc_cond_wait( &p_sys->worker.wait_input, &p_sys->worker.lock );
+        if( p_sys->worker.b_exit )
+            break;
+
+        picture_t *p_pic = p_sys->worker.p_in;
+        p_sys->worker.p_in = p_pic->p_next;
+        if( p_sys->worker.p_in == NULL )
+            p_sys->worker.pp_in_last = &p_sys->worker.p_in;
+        p_pic->p_next = NULL;
+        vlc_mutex_unlock( &p_sys->worker.lock );
+
+        picture_t *p_out = Deinterlace( p_filter, p_pic );
+
+        vlc_mutex_lock( &p_sys->worker.lock );
+        *p_sys->worker.pp_out_last = p_out;
+        for( ; p_out != NULL; p_out = p_out->p_next )
+            p_sys->worker.pp_out_last = &p_out->p_next;
+        p_sys->worker.i_pending--;
+        vlc_cond_signal( &p_sys->worker.wait_output );
+    }
+    vlc_mutex_unlock( &p_sys->worker.lock );
+    return NULL;
+}
+
+/**
+ * Queues a frame for the worker thread, and returns those already done.
+ *
+ * The caller only waits if the worker thread lags behind by more than
+ * WORKER_DEPTH frames, so that the deinterlacing of a frame overlaps with
+ * the display or encoding of the previous one.
+ */
+static picture_t *DeinterlaceAsync( filter_t *p_filter, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    p_pic->p_next = NULL;
+
+    vlc_mutex_lock( &p_sys->worker.lock );
+    *p_sys->worker.pp_in_last = p_pic;
+    p_sys->worker.pp_in_last = &p_pic->p_next;
+    p_sys->worker.i_pending++;
+    vlc_cond_signal( &p_sys->worker.wait_input );
+
+    while( p_sys->worker.i_pending > WORKER_DEPTH )
+        vlc_cond_wait( &p_sys->worker.wait_output, &p_sys->worker.lock );
+
+    picture_t *p_out = p_sys->worker.p_out;
+    p_sys->worker.p_out = NULL;
+    p_sys->worker.pp_out_last = &p_sys->worker.p_out;
+    vlc_mutex_unlock( &p_sys->worker.lock );
+
+    return p_out;
+}
+
+/* Discards the queued frames and waits for the worker thread to be idle.
+ * The worker lock must be held. */
+static void WorkerDrop( filter_sys_t *p_sys )
+{
+    while( p_sys->worker.p_in != NULL )
+    {
+        picture_t *p_pic = p_sys->worker.p_in;
+
+        p_sys->worker.p_in = p_pic->p_next;
+        picture_Release( p_pic );
+        p_sys->worker.i_pending--;
+    }
+    p_sys->worker.pp_in_last = &p_sys->worker.p_in;
+
+    while( p_sys->worker.i_pending > 0 )
+        vlc_cond_wait( &p_sys->worker.wait_output, &p_sys->worker.lock );
+
+    while( p_sys->worker.p_out != NULL )
+    {
+        picture_t *p_pic = p_sys->worker.p_out;
+
+        p_sys->worker.p_out = p_pic->p_next;
+        picture_Release( p_pic );
+    }
+    p_sys->worker.pp_out_last = &p_sys->worker.p_out;
+}
+
+static void FlushAsync( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    vlc_mutex_lock( &p_sys->worker.lock );
+    WorkerDrop( p_sys );
+    Flush( p_filter );
+    vlc_mutex_unlock( &p_sys->worker.lock );
+}
+
+static int WorkerStart( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    vlc_mutex_init( &p_sys->worker.lock );
+    vlc_cond_init( &p_sys->worker.wait_input );
+    vlc_cond_init( &p_sys->worker.wait_output );
+    p_sys->worker.b_exit = false;
+    p_sys->worker.p_in = NULL;
+    p_sys->worker.pp_in_last = &p_sys->worker.p_in;
+    p_sys->worker.p_out = NULL;
+    p_sys->worker.pp_out_last = &p_sys->worker.p_out;
+    p_sys->worker.i_pending = 0;
+    p_sys->worker.b_active = true;
+
+    if( vlc_clone( &p_sys->worker.thread, Thread, p_filter,
+                   VLC_THREAD_PRIORITY_OUTPUT ) )
+    {
+        p_sys->worker.b_active = false;
+        vlc_cond_destroy( &p_sys->worker.wait_output );
+        vlc_cond_destroy( &p_sys->worker.wait_input );
+        vlc_mutex_destroy( &p_sys->worker.lock );
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void WorkerStop( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    vlc_mutex_lock( &p_sys->worker.lock );
+    WorkerDrop( p_sys );
+    p_sys->worker.b_exit = true;
+    vlc_cond_signal( &p_sys->worker.wait_input );
+    vlc_mutex_unlock( &p_sys->worker.lock );
+
+    vlc_join( p_sys->worker.thread, NULL );
+    vlc_cond_destroy( &p_sys->worker.wait_output );
+    vlc_cond_destroy( &p_sys->worker.wait_input );
+    vlc_mutex_destroy( &p_sys->worker.lock );
+    p_sys->worker.b_active = false;
+}
+
 /*****************************************************************************
  * Flush
  *****************************************************************************/
@@ -643,6 +811,7 @@ notsupp:
         return VLC_ENOMEM;
 
     p_sys->chroma = chroma;
+    p_sys->worker.b_active = false;
 
     config_ChainParse( p_filter, FILTER_CFG_PREFIX, ppsz_filter_options,
                        p_filter->p_cfg );
@@ -668,6 +837,14 @@ notsupp:
         p_sys->pf_merge = MergeAltivec;
     else
 #endif
+#if defined(HAVE_AVX2_INTRINSICS)
+    if( vlc_CPU_AVX2() )
+    {
+        p_sys->pf_merge = pixel_size == 1 ? Merge8BitAVX2 : Merge16BitAVX2;
+        p_sys->pf_end_merge = NULL;
+    }
+    else
+#endif
 #if defined(CAN_COMPILE_SSE2)
     if( vlc_CPU_SSE2() )
     {
@@ -765,6 +942,15 @@ notsupp:
     p_filter->pf_flush = Flush;
     p_filter->pf_video_mouse  = Mouse;
 
+    if( vlc_GetCPUCount() > 1
+     && var_InheritBool( p_filter, FILTER_CFG_PREFIX "threaded" )
+     && WorkerStart( p_filter ) == VLC_SUCCESS )
+    {
+        p_filter->pf_video_filter = DeinterlaceAsync;
+        p_filter->pf_flush = FlushAsync;
+        msg_Dbg( p_filter, "deinterlacing in a separate thread" );
+    }
+
     msg_Dbg( p_filter, "deinterlacing" );
 
     return VLC_SUCCESS;
@@ -778,6 +964,8 @@ void Close( vlc_object_t *p_this )
 {
     filter_t *p_filter = (filter_t*)p_this;
 
+    if( p_filter->p_sys->worker.b_active )
+        WorkerStop( p_filter );
     Flush( p_filter );
     free( p_filter->p_sys );
 }
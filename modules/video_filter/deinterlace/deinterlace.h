@@ -121,6 +121,25 @@ struct filter_sys_t
     /* Algorithm-specific substructures */
     phosphor_sys_t phosphor; /**< Phosphor algorithm state. */
     ivtc_sys_t ivtc;         /**< IVTC algorithm state. */
+
+    /**
+     * Worker thread state, used when deinterlacing asynchronously.
+     * @see DeinterlaceAsync()
+     */
+    struct
+    {
+        bool b_active;              /**< Is the worker thread running? */
+        bool b_exit;                /**< Shall the worker thread exit? */
+        vlc_thread_t thread;
+        vlc_mutex_t lock;
+        vlc_cond_t wait_input;      /**< Signaled on new input or exit */
+        vlc_cond_t wait_output;     /**< Signaled when a frame is done */
+        picture_t *p_in;            /**< Queued input frames */
+        picture_t **pp_in_last;
+        picture_t *p_out;           /**< Deinterlaced output frames */
+        picture_t **pp_out_last;
+        unsigned i_pending;         /**< Queued or in-progress input frames */
+    } worker;
 };
 
 /*****************************************************************************
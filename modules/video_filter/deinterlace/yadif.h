@@ -147,3 +147,259 @@ static void yadif_filter_line_c_16bit(uint16_t *dst, uint16_t *prev, uint16_t *c
     prefs /= 2;
     FILTER
 }
+
+#ifdef HAVE_AVX2_INTRINSICS
+// ================ AVX2 =================
+/* Same algorithm as FILTER, on 16 pixels at once widened to 16 bits, so that
+ * intermediate sums can neither overflow nor saturate. */
+#include <immintrin.h>
+#define HAVE_YADIF_AVX2
+
+VLC_AVX2
+static inline __m256i yadif_load_avx2(const uint8_t *p)
+{
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)p));
+}
+
+VLC_AVX2
+static inline __m256i yadif_absdiff_avx2(__m256i a, __m256i b)
+{
+    return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+}
+
+VLC_AVX2
+static inline __m256i yadif_score_avx2(const uint8_t *cur, int prefs, int mrefs,
+                                       int j)
+{
+    __m256i s0 = yadif_absdiff_avx2(yadif_load_avx2(&cur[mrefs-1+j]),
+                                    yadif_load_avx2(&cur[prefs-1-j]));
+    __m256i s1 = yadif_absdiff_avx2(yadif_load_avx2(&cur[mrefs  +j]),
+                                    yadif_load_avx2(&cur[prefs  -j]));
+    __m256i s2 = yadif_absdiff_avx2(yadif_load_avx2(&cur[mrefs+1+j]),
+                                    yadif_load_avx2(&cur[prefs+1-j]));
+    return _mm256_add_epi16(_mm256_add_epi16(s0, s1), s2);
+}
+
+VLC_AVX2
+static inline __m256i yadif_pred_avx2(const uint8_t *cur, int prefs, int mrefs,
+                                      int j)
+{
+    return _mm256_srai_epi16(_mm256_add_epi16(yadif_load_avx2(&cur[mrefs+j]),
+                                              yadif_load_avx2(&cur[prefs-j])),
+                             1);
+}
+
+/* Applies CHECK(j) then, where it succeeded, CHECK(2*j) */
+VLC_AVX2
+static inline void yadif_check_avx2(const uint8_t *cur, int prefs, int mrefs,
+                                    int j, __m256i *score, __m256i *pred)
+{
+    __m256i s = yadif_score_avx2(cur, prefs, mrefs, j);
+    __m256i mask = _mm256_cmpgt_epi16(*score, s);
+
+    *score = _mm256_blendv_epi8(*score, s, mask);
+    *pred = _mm256_blendv_epi8(*pred, yadif_pred_avx2(cur, prefs, mrefs, j),
+                               mask);
+
+    s = yadif_score_avx2(cur, prefs, mrefs, 2 * j);
+    mask = _mm256_and_si256(mask, _mm256_cmpgt_epi16(*score, s));
+
+    *score = _mm256_blendv_epi8(*score, s, mask);
+    *pred = _mm256_blendv_epi8(*pred,
+                               yadif_pred_avx2(cur, prefs, mrefs, 2 * j), mask);
+}
+
+VLC_AVX2
+static void yadif_filter_line_avx2(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode) {
+    const __m256i one = _mm256_set1_epi16(1);
+    int x;
+
+    for (x = 0; x + 16 <= w; x += 16) {
+        const uint8_t *prev2 = parity ? prev : cur;
+        const uint8_t *next2 = parity ? cur  : next;
+
+        __m256i c = yadif_load_avx2(&cur[mrefs]);
+        __m256i e = yadif_load_avx2(&cur[prefs]);
+        __m256i p2 = yadif_load_avx2(prev2);
+        __m256i n2 = yadif_load_avx2(next2);
+        __m256i d = _mm256_srai_epi16(_mm256_add_epi16(p2, n2), 1);
+
+        __m256i temporal_diff0 = yadif_absdiff_avx2(p2, n2);
+        __m256i temporal_diff1 = _mm256_srai_epi16(_mm256_add_epi16(
+                    yadif_absdiff_avx2(yadif_load_avx2(&prev[mrefs]), c),
+                    yadif_absdiff_avx2(yadif_load_avx2(&prev[prefs]), e)), 1);
+        __m256i temporal_diff2 = _mm256_srai_epi16(_mm256_add_epi16(
+                    yadif_absdiff_avx2(yadif_load_avx2(&next[mrefs]), c),
+                    yadif_absdiff_avx2(yadif_load_avx2(&next[prefs]), e)), 1);
+        __m256i diff = _mm256_max_epi16(_mm256_max_epi16(
+                    _mm256_srai_epi16(temporal_diff0, 1), temporal_diff1),
+                    temporal_diff2);
+
+        __m256i spatial_pred = _mm256_srai_epi16(_mm256_add_epi16(c, e), 1);
+        __m256i spatial_score = _mm256_sub_epi16(_mm256_add_epi16(
+                    _mm256_add_epi16(
+                        yadif_absdiff_avx2(yadif_load_avx2(&cur[mrefs-1]),
+                                           yadif_load_avx2(&cur[prefs-1])),
+                        yadif_absdiff_avx2(c, e)),
+                    yadif_absdiff_avx2(yadif_load_avx2(&cur[mrefs+1]),
+                                       yadif_load_avx2(&cur[prefs+1]))), one);
+
+        yadif_check_avx2(cur, prefs, mrefs, -1, &spatial_score, &spatial_pred);
+        yadif_check_avx2(cur, prefs, mrefs,  1, &spatial_score, &spatial_pred);
+
+        if (mode < 2) {
+            __m256i b = _mm256_srai_epi16(_mm256_add_epi16(
+                        yadif_load_avx2(&prev2[2*mrefs]),
+                        yadif_load_avx2(&next2[2*mrefs])), 1);
+            __m256i f = _mm256_srai_epi16(_mm256_add_epi16(
+                        yadif_load_avx2(&prev2[2*prefs]),
+                        yadif_load_avx2(&next2[2*prefs])), 1);
+            __m256i de = _mm256_sub_epi16(d, e);
+            __m256i dc = _mm256_sub_epi16(d, c);
+            __m256i bc = _mm256_sub_epi16(b, c);
+            __m256i fe = _mm256_sub_epi16(f, e);
+            __m256i max = _mm256_max_epi16(_mm256_max_epi16(de, dc),
+                                           _mm256_min_epi16(bc, fe));
+            __m256i min = _mm256_min_epi16(_mm256_min_epi16(de, dc),
+                                           _mm256_max_epi16(bc, fe));
+
+            diff = _mm256_max_epi16(_mm256_max_epi16(diff, min),
+                                    _mm256_sub_epi16(_mm256_setzero_si256(),
+                                                     max));
+        }
+
+        /* diff is never negative, so this is the same as the C clipping */
+        spatial_pred = _mm256_max_epi16(spatial_pred, _mm256_sub_epi16(d, diff));
+        spatial_pred = _mm256_min_epi16(spatial_pred, _mm256_add_epi16(d, diff));
+
+        __m256i packed = _mm256_packus_epi16(spatial_pred, spatial_pred);
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm_storeu_si128((__m128i *)dst,
+                         _mm256_castsi256_si128(packed));
+
+        dst += 16;
+        cur += 16;
+        prev += 16;
+        next += 16;
+    }
+
+    if (x < w)
+        yadif_filter_line_c(dst, prev, cur, next, w - x, prefs, mrefs,
+                            parity, mode);
+}
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+// ================ NEON =================
+/* Same algorithm as FILTER, on 8 pixels at once widened to 16 bits */
+#include <arm_neon.h>
+#define HAVE_YADIF_NEON
+
+static inline int16x8_t yadif_load_neon(const uint8_t *p)
+{
+    return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)));
+}
+
+static inline int16x8_t yadif_score_neon(const uint8_t *cur, int prefs,
+                                         int mrefs, int j)
+{
+    int16x8_t s = vabdq_s16(yadif_load_neon(&cur[mrefs-1+j]),
+                            yadif_load_neon(&cur[prefs-1-j]));
+    s = vabaq_s16(s, yadif_load_neon(&cur[mrefs  +j]),
+                     yadif_load_neon(&cur[prefs  -j]));
+    return vabaq_s16(s, yadif_load_neon(&cur[mrefs+1+j]),
+                        yadif_load_neon(&cur[prefs+1-j]));
+}
+
+static inline int16x8_t yadif_pred_neon(const uint8_t *cur, int prefs,
+                                        int mrefs, int j)
+{
+    return vshrq_n_s16(vaddq_s16(yadif_load_neon(&cur[mrefs+j]),
+                                 yadif_load_neon(&cur[prefs-j])), 1);
+}
+
+/* Applies CHECK(j) then, where it succeeded, CHECK(2*j) */
+static inline void yadif_check_neon(const uint8_t *cur, int prefs, int mrefs,
+                                    int j, int16x8_t *score, int16x8_t *pred)
+{
+    int16x8_t s = yadif_score_neon(cur, prefs, mrefs, j);
+    uint16x8_t mask = vcltq_s16(s, *score);
+
+    *score = vbslq_s16(mask, s, *score);
+    *pred = vbslq_s16(mask, yadif_pred_neon(cur, prefs, mrefs, j), *pred);
+
+    s = yadif_score_neon(cur, prefs, mrefs, 2 * j);
+    mask = vandq_u16(mask, vcltq_s16(s, *score));
+
+    *score = vbslq_s16(mask, s, *score);
+    *pred = vbslq_s16(mask, yadif_pred_neon(cur, prefs, mrefs, 2 * j), *pred);
+}
+
+static void yadif_filter_line_neon(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode) {
+    int x;
+
+    for (x = 0; x + 8 <= w; x += 8) {
+        const uint8_t *prev2 = parity ? prev : cur;
+        const uint8_t *next2 = parity ? cur  : next;
+
+        int16x8_t c = yadif_load_neon(&cur[mrefs]);
+        int16x8_t e = yadif_load_neon(&cur[prefs]);
+        int16x8_t p2 = yadif_load_neon(prev2);
+        int16x8_t n2 = yadif_load_neon(next2);
+        int16x8_t d = vshrq_n_s16(vaddq_s16(p2, n2), 1);
+
+        int16x8_t temporal_diff0 = vabdq_s16(p2, n2);
+        int16x8_t temporal_diff1 = vshrq_n_s16(vaddq_s16(
+                    vabdq_s16(yadif_load_neon(&prev[mrefs]), c),
+                    vabdq_s16(yadif_load_neon(&prev[prefs]), e)), 1);
+        int16x8_t temporal_diff2 = vshrq_n_s16(vaddq_s16(
+                    vabdq_s16(yadif_load_neon(&next[mrefs]), c),
+                    vabdq_s16(yadif_load_neon(&next[prefs]), e)), 1);
+        int16x8_t diff = vmaxq_s16(vmaxq_s16(vshrq_n_s16(temporal_diff0, 1),
+                                             temporal_diff1), temporal_diff2);
+
+        int16x8_t spatial_pred = vshrq_n_s16(vaddq_s16(c, e), 1);
+        int16x8_t spatial_score = vabdq_s16(yadif_load_neon(&cur[mrefs-1]),
+                                            yadif_load_neon(&cur[prefs-1]));
+        spatial_score = vabaq_s16(spatial_score, c, e);
+        spatial_score = vabaq_s16(spatial_score,
+                                  yadif_load_neon(&cur[mrefs+1]),
+                                  yadif_load_neon(&cur[prefs+1]));
+        spatial_score = vsubq_s16(spatial_score, vdupq_n_s16(1));
+
+        yadif_check_neon(cur, prefs, mrefs, -1, &spatial_score, &spatial_pred);
+        yadif_check_neon(cur, prefs, mrefs,  1, &spatial_score, &spatial_pred);
+
+        if (mode < 2) {
+            int16x8_t b = vshrq_n_s16(vaddq_s16(
+                        yadif_load_neon(&prev2[2*mrefs]),
+                        yadif_load_neon(&next2[2*mrefs])), 1);
+            int16x8_t f = vshrq_n_s16(vaddq_s16(
+                        yadif_load_neon(&prev2[2*prefs]),
+                        yadif_load_neon(&next2[2*prefs])), 1);
+            int16x8_t de = vsubq_s16(d, e);
+            int16x8_t dc = vsubq_s16(d, c);
+            int16x8_t bc = vsubq_s16(b, c);
+            int16x8_t fe = vsubq_s16(f, e);
+            int16x8_t max = vmaxq_s16(vmaxq_s16(de, dc), vminq_s16(bc, fe));
+            int16x8_t min = vminq_s16(vminq_s16(de, dc), vmaxq_s16(bc, fe));
+
+            diff = vmaxq_s16(vmaxq_s16(diff, min), vnegq_s16(max));
+        }
+
+        spatial_pred = vmaxq_s16(spatial_pred, vsubq_s16(d, diff));
+        spatial_pred = vminq_s16(spatial_pred, vaddq_s16(d, diff));
+
+        vst1_u8(dst, vqmovun_s16(spatial_pred));
+
+        dst += 8;
+        cur += 8;
+        prev += 8;
+        next += 8;
+    }
+
+    if (x < w)
+        yadif_filter_line_c(dst, prev, cur, next, w - x, prefs, mrefs,
+                            parity, mode);
+}
+#endif
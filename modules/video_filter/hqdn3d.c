@@ -32,6 +32,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
 
@@ -86,6 +87,30 @@ static const char *const filter_options[] = {
 /*****************************************************************************
  * filter_sys_t
  *****************************************************************************/
+#define MAX_THREADS 8
+
+/* Pass of a plane run by all the threads, each on its own slice */
+struct denoise_task
+{
+    enum
+    {
+        PASS_TEMPORAL,   /* temporal only, by lines */
+        PASS_HORIZONTAL, /* by lines */
+        PASS_VERTICAL,   /* vertical and temporal, by columns */
+    } pass;
+    unsigned char *src, *dst;
+    unsigned short *frame_ant;
+    int w, h, src_pitch, dst_pitch;
+    int *spatial, *temporal;
+};
+
+struct denoise_worker
+{
+    vlc_thread_t thread;
+    filter_sys_t *sys;
+    unsigned index;
+};
+
 struct filter_sys_t
 {
     const vlc_chroma_description_t *chroma;
@@ -95,8 +120,138 @@ struct filter_sys_t
     bool   b_recalc_coefs;
     vlc_mutex_t coefs_mutex;
     float  luma_spat, luma_temp, chroma_spat, chroma_temp;
+
+    /* Worker threads (the filter thread runs slice 0) */
+    struct denoise_worker workers[MAX_THREADS - 1];
+    unsigned worker_count;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    vlc_cond_t done;
+    unsigned generation;
+    unsigned running;
+    bool quit;
+    struct denoise_task task;
 };
 
+/*****************************************************************************
+ * Threading
+ *****************************************************************************/
+static void RunSlice(filter_sys_t *sys, unsigned index)
+{
+    const struct denoise_task *task = &sys->task;
+    const unsigned count = sys->worker_count + 1;
+    struct vf_priv_s *cfg = &sys->cfg;
+
+    if (task->pass == PASS_VERTICAL) {
+        const int x0 = task->w * index / count;
+        const int x1 = task->w * (index + 1) / count;
+
+        deNoiseVertical(cfg->Horiz, task->dst, cfg->Line, task->frame_ant,
+                        task->w, task->h, x0, x1, task->dst_pitch,
+                        task->spatial, task->temporal);
+        return;
+    }
+
+    const int y0 = task->h * index / count;
+    const int y1 = task->h * (index + 1) / count;
+
+    if (task->pass == PASS_HORIZONTAL)
+        deNoiseHorizontal(task->src, cfg->Horiz, task->w, y0, y1,
+                          task->src_pitch, task->spatial);
+    else
+        deNoiseTemporal(task->src, task->dst, task->frame_ant, task->w, y0, y1,
+                        task->src_pitch, task->dst_pitch, task->temporal);
+}
+
+static void *Worker(void *data)
+{
+    struct denoise_worker *worker = data;
+    filter_sys_t *sys = worker->sys;
+    unsigned generation = 0;
+
+    vlc_mutex_lock(&sys->lock);
+    for (;;) {
+        while (!sys->quit && sys->generation == generation)
+            vlc_cond_wait(&sys->wait, &sys->lock);
+        if (sys->quit)
+            break;
+        generation = sys->generation;
+        vlc_mutex_unlock(&sys->lock);
+
+        RunSlice(sys, worker->index);
+
+        vlc_mutex_lock(&sys->lock);
+        if (--sys->running == 0)
+            vlc_cond_signal(&sys->done);
+    }
+    vlc_mutex_unlock(&sys->lock);
+    return NULL;
+}
+
+/* Runs the current task on all the threads and waits for its completion */
+static void RunTask(filter_sys_t *sys)
+{
+    if (sys->worker_count > 0) {
+        vlc_mutex_lock(&sys->lock);
+        sys->generation++;
+        sys->running = sys->worker_count;
+        vlc_cond_broadcast(&sys->wait);
+        vlc_mutex_unlock(&sys->lock);
+    }
+
+    RunSlice(sys, 0);
+
+    if (sys->worker_count > 0) {
+        vlc_mutex_lock(&sys->lock);
+        while (sys->running > 0)
+            vlc_cond_wait(&sys->done, &sys->lock);
+        vlc_mutex_unlock(&sys->lock);
+    }
+}
+
+static void DenoisePlane(filter_sys_t *sys, const plane_t *src, plane_t *dst,
+                         unsigned short *frame_ant, int w, int h,
+                         int *spatial, int *temporal)
+{
+    struct denoise_task *task = &sys->task;
+
+    task->src = src->p_pixels;
+    task->dst = dst->p_pixels;
+    task->frame_ant = frame_ant;
+    task->w = w;
+    task->h = h;
+    task->src_pitch = src->i_pitch;
+    task->dst_pitch = dst->i_pitch;
+    task->spatial = spatial;
+    task->temporal = temporal;
+
+    if (!spatial[0]) {
+        task->pass = PASS_TEMPORAL;
+        RunTask(sys);
+        return;
+    }
+
+    task->pass = PASS_HORIZONTAL;
+    RunTask(sys);
+    task->pass = PASS_VERTICAL;
+    RunTask(sys);
+}
+
+static void StopWorkers(filter_sys_t *sys)
+{
+    vlc_mutex_lock(&sys->lock);
+    sys->quit = true;
+    vlc_cond_broadcast(&sys->wait);
+    vlc_mutex_unlock(&sys->lock);
+
+    for (unsigned i = 0; i < sys->worker_count; i++)
+        vlc_join(sys->workers[i].thread, NULL);
+
+    vlc_cond_destroy(&sys->done);
+    vlc_cond_destroy(&sys->wait);
+    vlc_mutex_destroy(&sys->lock);
+}
+
 /*****************************************************************************
  * Open
  *****************************************************************************/
@@ -109,7 +264,7 @@ static int Open(vlc_object_t *this)
     const video_format_t *fmt_out = &filter->fmt_out.video;
     const vlc_fourcc_t fourcc_in  = fmt_in->i_chroma;
     const vlc_fourcc_t fourcc_out = fmt_out->i_chroma;
-    int wmax = 0;
+    int wmax = 0, hmax = 0;
 
     const vlc_chroma_description_t *chroma =
             vlc_fourcc_GetChromaDescription(fourcc_in);
@@ -136,13 +291,34 @@ static int Open(vlc_object_t *this)
         sys->w[i] = fmt_in->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
         if (sys->w[i] > wmax) wmax = sys->w[i];
         sys->h[i] = fmt_out->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
+        if (sys->h[i] > hmax) hmax = sys->h[i];
     }
     cfg->Line = malloc(wmax*sizeof(unsigned int));
-    if (!cfg->Line) {
+    cfg->Horiz = malloc(wmax*hmax*sizeof(unsigned int));
+    if (!cfg->Line || !cfg->Horiz) {
+        free(cfg->Horiz);
+        free(cfg->Line);
         free(sys);
         return VLC_ENOMEM;
     }
 
+    vlc_mutex_init(&sys->lock);
+    vlc_cond_init(&sys->wait);
+    vlc_cond_init(&sys->done);
+
+    unsigned threads = __MIN(vlc_GetCPUCount(), MAX_THREADS);
+    for (unsigned i = 0; i + 1 < threads; i++) {
+        struct denoise_worker *worker = &sys->workers[sys->worker_count];
+
+        worker->sys = sys;
+        worker->index = sys->worker_count + 1;
+        if (vlc_clone(&worker->thread, Worker, worker,
+                      VLC_THREAD_PRIORITY_VIDEO))
+            break;
+        sys->worker_count++;
+    }
+    msg_Dbg(filter, "using %u threads", sys->worker_count + 1);
+
     config_ChainParse(filter, FILTER_PREFIX, filter_options,
                       filter->p_cfg);
 
@@ -180,10 +356,12 @@ static void Close(vlc_object_t *this)
     var_DelCallback( filter, FILTER_PREFIX "chroma-temp", DenoiseCallback, sys );
 
     vlc_mutex_destroy( &sys->coefs_mutex );
+    StopWorkers(sys);
 
     for (int i = 0; i < 3; ++i) {
         free(cfg->Frame[i]);
     }
+    free(cfg->Horiz);
     free(cfg->Line);
     free(sys);
 }
@@ -220,32 +398,23 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-
-    if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
-    {
-        picture_Release( src );
-        picture_Release( dst );
-        return NULL;
+    for (int i = 0; i < 3; ++i) {
+        if (!cfg->Frame[i])
+            cfg->Frame[i] = deNoiseInit(src->p[i].p_pixels, sys->w[i],
+                                        sys->h[i], src->p[i].i_pitch);
+        if (unlikely(!cfg->Frame[i])) {
+            picture_Release( src );
+            picture_Release( dst );
+            return NULL;
+        }
     }
 
+    DenoisePlane(sys, &src->p[0], &dst->p[0], cfg->Frame[0],
+                 sys->w[0], sys->h[0], cfg->Coefs[0], cfg->Coefs[1]);
+    for (int i = 1; i < 3; ++i)
+        DenoisePlane(sys, &src->p[i], &dst->p[i], cfg->Frame[i],
+                     sys->w[i], sys->h[i], cfg->Coefs[2], cfg->Coefs[3]);
+
     return CopyInfoAndRelease(dst, src);
 }
 
@@ -266,9 +435,9 @@ static int DenoiseCallback( vlc_object_t *p_this, char const *psz_var,
     else if( !strcmp( psz_var, FILTER_PREFIX "luma-temp") )
         sys->luma_temp = newval.f_float;
     else if( !strcmp( psz_var, FILTER_PREFIX "chroma-temp") )
-        sys->chroma_spat = newval.f_float;
-    else if( !strcmp( psz_var, FILTER_PREFIX "chroma-spat") )
         sys->chroma_temp = newval.f_float;
+    else if( !strcmp( psz_var, FILTER_PREFIX "chroma-spat") )
+        sys->chroma_spat = newval.f_float;
     sys->b_recalc_coefs = true;
     vlc_mutex_unlock( &sys->coefs_mutex );
 
@@ -33,6 +33,7 @@
 struct vf_priv_s {
         int Coefs[4][512*16];
         unsigned int *Line;
+        unsigned int *Horiz;
         unsigned short *Frame[3];
 };
 
@@ -46,16 +47,29 @@ static /*inline*/ unsigned int LowPassMul(unsigned int PrevMul, unsigned int Cur
     return CurrMul + Coef[d];
 }
 
+/*
+ * The spatial filter is split in two passes, so that each can be run on
+ * independent parts of the plane:
+ *  - the horizontal pass only depends on the previous pixel of the same
+ *    line, so lines can be processed independently;
+ *  - the vertical (and temporal) pass only depends on the pixel above, so
+ *    columns can be processed independently.
+ */
+
 static void deNoiseTemporal(
                     unsigned char *Frame,        // mpi->planes[x]
                     unsigned char *FrameDest,    // dmpi->planes[x]
                     unsigned short *FrameAnt,
-                    int W, int H, int sStride, int dStride,
+                    int W, int Y0, int Y1, int sStride, int dStride,
                     int *Temporal)
 {
     unsigned int PixelDst;
 
-    for (long Y = 0; Y < H; Y++){
+    Frame += Y0 * sStride;
+    FrameDest += Y0 * dStride;
+    FrameAnt += Y0 * W;
+
+    for (long Y = Y0; Y < Y1; Y++){
         for (long X = 0; X < W; X++){
             PixelDst = LowPassMul(FrameAnt[X]<<8, Frame[X]<<16, Temporal);
             FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
@@ -67,117 +81,76 @@ static void deNoiseTemporal(
     }
 }
 
-static void deNoiseSpacial(
+/* Horizontal pass of lines [Y0, Y1[ into Horiz (W values per line) */
+static void deNoiseHorizontal(
                     unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,       // vf->priv->Line (width bytes)
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical)
+                    unsigned int *Horiz,
+                    int W, int Y0, int Y1, int sStride,
+                    int *Horizontal)
 {
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
-    unsigned int PixelDst;
+    Frame += Y0 * sStride;
+    Horiz += Y0 * W;
 
-    /* First pixel has no left nor top neighbor. */
-    PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+    for (long Y = Y0; Y < Y1; Y++){
+        /* First pixel on each line doesn't have previous pixel */
+        unsigned int PixelAnt = Horiz[0] = Frame[0]<<16;
 
-    /* First line has no top neighbor, only left. */
-    for (long X = 1; X < W; X++){
-        PixelDst = LineAnt[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-    }
+        for (long X = 1; X < W; X++)
+            PixelAnt = Horiz[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
 
-    for (long Y = 1; Y < H; Y++){
-        unsigned int PixelAnt;
-        sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        PixelDst = LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (long X = 1; X < W; X++){
-            unsigned int PixelDst;
-            /* The rest are normal */
-            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
-            PixelDst = LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
-            FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
-        }
+        Frame += sStride;
+        Horiz += W;
     }
 }
 
-static void deNoise(unsigned char *Frame,        // mpi->planes[x]
+/* Vertical and temporal passes of columns [X0, X1[ */
+static void deNoiseVertical(
+                    unsigned int *Horiz,
                     unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,      // vf->priv->Line (width bytes)
-                    unsigned short **FrameAntPtr,
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical, int *Temporal)
+                    unsigned int *LineAnt,       // vf->priv->Line (width bytes)
+                    unsigned short *FrameAnt,
+                    int W, int H, int X0, int X1, int dStride,
+                    int *Vertical, int *Temporal)
 {
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
     unsigned int PixelDst;
-    unsigned short* FrameAnt=(*FrameAntPtr);
-
-    if(!FrameAnt){
-        (*FrameAntPtr)=FrameAnt=malloc(W*H*sizeof(unsigned short));
-        if(!FrameAnt)
-            return;
-        for (long Y = 0; Y < H; Y++){
-            unsigned short* dst=&FrameAnt[Y*W];
-            unsigned char* src=Frame+Y*sStride;
-            for (long X = 0; X < W; X++) dst[X]=src[X]<<8;
-        }
-    }
-
-    if(!Horizontal[0] && !Vertical[0]){
-        deNoiseTemporal(Frame, FrameDest, FrameAnt,
-                        W, H, sStride, dStride, Temporal);
-        return;
-    }
-    if(!Temporal[0]){
-        deNoiseSpacial(Frame, FrameDest, LineAnt,
-                       W, H, sStride, dStride, Horizontal, Vertical);
-        return;
-    }
 
-    /* First pixel has no left nor top neighbor. Only previous frame */
-    LineAnt[0] = PixelAnt = Frame[0]<<16;
-    PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
-    FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
-
-    /* First line has no top neighbor. Only left one for each pixel and
-     * last frame */
-    for (long X = 1; X < W; X++){
-        LineAnt[X] = PixelAnt = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        PixelDst = LowPassMul(FrameAnt[X]<<8, PixelAnt, Temporal);
-        FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-    }
-
-    for (long Y = 1; Y < H; Y++){
-        unsigned int PixelAnt;
-        unsigned short* LinePrev=&FrameAnt[Y*W];
-        sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        PixelDst = LowPassMul(LinePrev[0]<<8, LineAnt[0], Temporal);
-        LinePrev[0] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (long X = 1; X < W; X++){
-            unsigned int PixelDst;
-            /* The rest are normal */
-            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
-            LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
-            PixelDst = LowPassMul(LinePrev[X]<<8, LineAnt[X], Temporal);
-            LinePrev[X] = ((PixelDst+0x1000007F)>>8);
-            FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
+    for (long Y = 0; Y < H; Y++){
+        /* First line has no top neighbor */
+        if (Y == 0)
+            memcpy(&LineAnt[X0], &Horiz[X0], (X1 - X0) * sizeof(*LineAnt));
+        else
+            for (long X = X0; X < X1; X++)
+                LineAnt[X] = LowPassMul(LineAnt[X], Horiz[X], Vertical);
+
+        for (long X = X0; X < X1; X++){
+            if (Temporal[0]){
+                PixelDst = LowPassMul(FrameAnt[X]<<8, LineAnt[X], Temporal);
+                FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
+            }
+            else
+                PixelDst = LineAnt[X];
+            FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
         }
+        Horiz += W;
+        FrameDest += dStride;
+        FrameAnt += W;
     }
 }
 
+/* Initialize the previous frame from the first one */
+static unsigned short *deNoiseInit(unsigned char *Frame, int W, int H,
+                                   int sStride)
+{
+    unsigned short *FrameAnt = malloc(W*H*sizeof(unsigned short));
+    if(!FrameAnt)
+        return NULL;
+    for (long Y = 0; Y < H; Y++){
+        unsigned short* dst=&FrameAnt[Y*W];
+        unsigned char* src=Frame+Y*sStride;
+        for (long X = 0; X < W; X++) dst[X]=src[X]<<8;
+    }
+    return FrameAnt;
+}
 
 //===========================================================================//
 
@@ -37,6 +37,7 @@
 
 #include <vlc_filter.h>
 #include <vlc_image.h>
+#include <vlc_executor.h>
 
 #include "mosaic.h"
 
@@ -52,6 +53,23 @@ static subpicture_t *Filter ( filter_t *, mtime_t );
 static int MosaicCallback   ( vlc_object_t *, char const *, vlc_value_t,
                               vlc_value_t, void * );
 
+/*****************************************************************************
+ * mosaic_tile_t : scaled picture of one substream
+ *****************************************************************************/
+typedef struct
+{
+    const bridged_es_t *p_es; /* Substream (only compared, never used) */
+    image_handler_t *p_image;
+
+    picture_t *p_source;      /* Bridged picture the tile was scaled from */
+    picture_t *p_converted;   /* Scaled picture, NULL if conversion failed */
+    video_format_t fmt_in;
+    video_format_t fmt_out;
+    bool b_used;              /* Displayed in the current frame */
+
+    struct vlc_runnable runnable;
+} mosaic_tile_t;
+
 /*****************************************************************************
  * filter_sys_t : filter descriptor
  *****************************************************************************/
@@ -59,7 +77,9 @@ struct filter_sys_t
 {
     vlc_mutex_t lock;         /* Internal filter lock */
 
-    image_handler_t *p_image;
+    mosaic_tile_t **pp_tiles; /* Scaled pictures cache */
+    int i_tiles;
+    vlc_executor_t *p_executor; /* Scaling threads, NULL if serial */
 
     int i_position;           /* Mosaic positioning method */
     bool b_ar;          /* Do we keep the aspect ratio ? */
@@ -151,6 +171,11 @@ struct filter_sys_t
         "(only used if positioning method is set to \"offsets\"). You " \
         "must give a comma-separated list of coordinates (eg: 10,10,150,10)." )
 
+#define THREADS_TEXT N_("Threads")
+#define THREADS_LONGTEXT N_( \
+        "Number of threads used to resize the mosaic elements " \
+        "(0 = number of CPUs, 1 = resize on the video thread)." )
+
 #define DELAY_TEXT N_("Delay")
 #define DELAY_LONGTEXT N_( \
         "Pictures coming from the mosaic elements will be delayed " \
@@ -223,13 +248,16 @@ vlc_module_begin ()
 
     add_integer( CFG_PREFIX "delay", 0, DELAY_TEXT, DELAY_LONGTEXT,
                  false )
+
+    add_integer( CFG_PREFIX "threads", 0, THREADS_TEXT, THREADS_LONGTEXT,
+                 true )
 vlc_module_end ()
 
 static const char *const ppsz_filter_options[] = {
     "alpha", "height", "width", "align", "xoffset", "yoffset",
     "borderw", "borderh", "position", "rows", "cols",
     "keep-aspect-ratio", "keep-picture", "order", "offsets",
-    "delay", NULL
+    "delay", "threads", NULL
 };
 
 /*****************************************************************************
@@ -272,6 +300,96 @@ static void mosaic_ParseSetOffsets( vlc_object_t *p_this,
 #define mosaic_ParseSetOffsets( a, b, c ) \
             mosaic_ParseSetOffsets( VLC_OBJECT( a ), b, c )
 
+/*****************************************************************************
+ * Tiles: the scaled picture of a substream is kept until a new picture is
+ * bridged or the size of the tile changes.
+ *****************************************************************************/
+static void TileConvert( void *data )
+{
+    mosaic_tile_t *p_tile = data;
+
+    p_tile->p_converted = image_Convert( p_tile->p_image, p_tile->p_source,
+                                         &p_tile->fmt_in, &p_tile->fmt_out );
+}
+
+static mosaic_tile_t *TileNew( filter_t *p_filter, const bridged_es_t *p_es )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    mosaic_tile_t *p_tile = calloc( 1, sizeof( *p_tile ) );
+    if( p_tile == NULL )
+        return NULL;
+
+    p_tile->p_image = image_HandlerCreate( p_filter );
+    if( p_tile->p_image == NULL )
+    {
+        free( p_tile );
+        return NULL;
+    }
+    p_tile->p_es = p_es;
+    p_tile->runnable.run = TileConvert;
+    p_tile->runnable.userdata = p_tile;
+
+    TAB_APPEND( p_sys->i_tiles, p_sys->pp_tiles, p_tile );
+    return p_tile;
+}
+
+static void TileDelete( mosaic_tile_t *p_tile )
+{
+    if( p_tile->p_source != NULL )
+        picture_Release( p_tile->p_source );
+    if( p_tile->p_converted != NULL )
+        picture_Release( p_tile->p_converted );
+    image_HandlerDelete( p_tile->p_image );
+    free( p_tile );
+}
+
+/* Returns the tile of a substream, scheduled for scaling if it is stale. */
+static mosaic_tile_t *TileGet( filter_t *p_filter, const bridged_es_t *p_es,
+                               const video_format_t *p_fmt_in,
+                               const video_format_t *p_fmt_out,
+                               bool *pb_stale )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    mosaic_tile_t *p_tile = NULL;
+
+    for( int i = 0; i < p_sys->i_tiles; i++ )
+        if( p_sys->pp_tiles[i]->p_es == p_es && !p_sys->pp_tiles[i]->b_used )
+        {
+            p_tile = p_sys->pp_tiles[i];
+            break;
+        }
+
+    if( p_tile == NULL )
+    {
+        p_tile = TileNew( p_filter, p_es );
+        if( p_tile == NULL )
+            return NULL;
+    }
+    p_tile->b_used = true;
+
+    *pb_stale = p_tile->p_source != p_es->p_picture
+             || p_tile->fmt_in.i_chroma != p_fmt_in->i_chroma
+             || p_tile->fmt_in.i_width != p_fmt_in->i_width
+             || p_tile->fmt_in.i_height != p_fmt_in->i_height
+             || p_tile->fmt_out.i_chroma != p_fmt_out->i_chroma
+             || p_tile->fmt_out.i_width != p_fmt_out->i_width
+             || p_tile->fmt_out.i_height != p_fmt_out->i_height;
+    if( *pb_stale )
+    {
+        if( p_tile->p_source != NULL )
+            picture_Release( p_tile->p_source );
+        if( p_tile->p_converted != NULL )
+            picture_Release( p_tile->p_converted );
+        /* The source is held so that its address cannot be reused by
+         * another bridged picture while the tile refers to it. */
+        p_tile->p_source = picture_Hold( p_es->p_picture );
+        p_tile->p_converted = NULL;
+        p_tile->fmt_in = *p_fmt_in;
+        p_tile->fmt_out = *p_fmt_out;
+    }
+    return p_tile;
+}
+
 /*****************************************************************************
  * CreateFiler: allocate mosaic video filter
  *****************************************************************************/
@@ -328,10 +446,17 @@ static int CreateFilter( vlc_object_t *p_this )
 
     p_sys->b_keep = var_CreateGetBoolCommand( p_filter,
                                               CFG_PREFIX "keep-picture" );
-    if ( !p_sys->b_keep )
-    {
-        p_sys->p_image = image_HandlerCreate( p_filter );
-    }
+    p_sys->pp_tiles = NULL;
+    p_sys->i_tiles = 0;
+    p_sys->p_executor = NULL;
+    /* The executor spawns its threads on demand, so it costs nothing
+     * while the original pictures are kept. */
+    int i_threads = var_CreateGetInteger( p_filter, CFG_PREFIX "threads" );
+    if( i_threads <= 0 )
+        i_threads = vlc_GetCPUCount();
+    if( i_threads > 1 )
+        p_sys->p_executor = vlc_executor_New( i_threads,
+                                              VLC_THREAD_PRIORITY_VIDEO );
 
     p_sys->i_order_length = 0;
     p_sys->ppsz_order = NULL;
@@ -401,10 +526,11 @@ static void DestroyFilter( vlc_object_t *p_this )
     DEL_CB( order );
 #undef DEL_CB
 
-    if( !p_sys->b_keep )
-    {
-        image_HandlerDelete( p_sys->p_image );
-    }
+    if( p_sys->p_executor != NULL )
+        vlc_executor_Delete( p_sys->p_executor );
+    for( int i_index = 0; i_index < p_sys->i_tiles; i_index++ )
+        TileDelete( p_sys->pp_tiles[i_index] );
+    free( p_sys->pp_tiles );
 
     if( p_sys->i_order_length )
     {
@@ -428,6 +554,16 @@ static void DestroyFilter( vlc_object_t *p_this )
 /*****************************************************************************
  * Filter
  *****************************************************************************/
+typedef struct
+{
+    mosaic_tile_t *p_tile;    /* Scaled picture, NULL if kept as is */
+    picture_t *p_picture;     /* Held bridged picture if kept as is */
+    bool b_stale;             /* Tile scaled in this frame */
+    int i_real_index;
+    int i_alpha;
+    int i_x, i_y;
+} mosaic_slot_t;
+
 static subpicture_t *Filter( filter_t *p_filter, mtime_t date )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
@@ -521,11 +657,27 @@ static subpicture_t *Filter( filter_t *p_filter, mtime_t date )
 
     i_real_index = 0;
 
+    /* Snapshot the displayed substreams, so that the bridge is not locked
+     * while the pictures are scaled. */
+    mosaic_slot_t *p_slots = NULL;
+    int i_slots = 0;
+    if( p_bridge->i_es_num > 0 )
+    {
+        p_slots = malloc( p_bridge->i_es_num * sizeof( *p_slots ) );
+        if( p_slots == NULL )
+        {
+            subpicture_Delete( p_spu );
+            vlc_global_unlock( VLC_MOSAIC_MUTEX );
+            vlc_mutex_unlock( &p_sys->lock );
+            return NULL;
+        }
+    }
+
     for( int i_index = 0; i_index < p_bridge->i_es_num; i_index++ )
     {
         bridged_es_t *p_es = p_bridge->pp_es[i_index];
+        mosaic_slot_t *p_slot = &p_slots[i_slots];
         video_format_t fmt_in, fmt_out;
-        picture_t *p_converted;
 
         memset( &fmt_in, 0, sizeof( video_format_t ) );
         memset( &fmt_out, 0, sizeof( video_format_t ) );
@@ -582,8 +734,11 @@ static subpicture_t *Filter( filter_t *p_filter, mtime_t date )
             if ( i == p_sys->i_order_length )
                 i_real_index = ++i_greatest_real_index_used;
         }
-        i_row = ( i_real_index / p_sys->i_cols ) % p_sys->i_rows;
-        i_col = i_real_index % p_sys->i_cols ;
+
+        p_slot->i_real_index = i_real_index;
+        p_slot->i_alpha = p_es->i_alpha;
+        p_slot->i_x = p_es->i_x;
+        p_slot->i_y = p_es->i_y;
 
         if ( !p_sys->b_keep )
         {
@@ -618,45 +773,108 @@ static subpicture_t *Filter( filter_t *p_filter, mtime_t date )
             fmt_out.i_visible_width = fmt_out.i_width;
             fmt_out.i_visible_height = fmt_out.i_height;
 
-            p_converted = image_Convert( p_sys->p_image, p_es->p_picture,
-                                         &fmt_in, &fmt_out );
+            p_slot->p_tile = TileGet( p_filter, p_es, &fmt_in, &fmt_out,
+                                      &p_slot->b_stale );
+            if( p_slot->p_tile == NULL )
+                continue;
+            p_slot->p_picture = NULL;
+        }
+        else
+        {
+            p_slot->p_tile = NULL;
+            p_slot->b_stale = false;
+            p_slot->p_picture = picture_Hold( p_es->p_picture );
+        }
+        i_slots++;
+    }
+
+    vlc_global_unlock( VLC_MOSAIC_MUTEX );
+
+    /* Scale the new pictures, in parallel if possible */
+    bool b_submitted = false;
+    for( int i_slot = 0; i_slot < i_slots; i_slot++ )
+    {
+        mosaic_tile_t *p_tile = p_slots[i_slot].p_tile;
+
+        if( !p_slots[i_slot].b_stale )
+            continue;
+        if( p_sys->p_executor != NULL
+         && vlc_executor_Submit( p_sys->p_executor,
+                                 &p_tile->runnable ) == VLC_SUCCESS )
+            b_submitted = true;
+        else
+            TileConvert( p_tile );
+    }
+    if( b_submitted )
+        vlc_executor_WaitIdle( p_sys->p_executor );
+
+    /* Drop the tiles of the substreams that are not displayed anymore */
+    for( int i_tile = 0; i_tile < p_sys->i_tiles; )
+    {
+        mosaic_tile_t *p_tile = p_sys->pp_tiles[i_tile];
+
+        if( p_tile->b_used )
+        {
+            p_tile->b_used = false;
+            i_tile++;
+        }
+        else
+        {
+            TAB_ERASE( p_sys->i_tiles, p_sys->pp_tiles, i_tile );
+            TileDelete( p_tile );
+        }
+    }
+
+    for( int i_slot = 0; i_slot < i_slots; i_slot++ )
+    {
+        mosaic_slot_t *p_slot = &p_slots[i_slot];
+        video_format_t fmt_out;
+        picture_t *p_converted;
+
+        if( p_slot->p_tile != NULL )
+        {
+            p_converted = p_slot->p_tile->p_converted;
             if( !p_converted )
             {
-                msg_Warn( p_filter,
-                           "image resizing and chroma conversion failed" );
+                if( p_slot->b_stale )
+                    msg_Warn( p_filter,
+                              "image resizing and chroma conversion failed" );
                 continue;
             }
+            fmt_out = p_slot->p_tile->fmt_out;
         }
         else
         {
-            p_converted = p_es->p_picture;
-            fmt_in.i_width = fmt_out.i_width = p_converted->format.i_width;
-            fmt_in.i_height = fmt_out.i_height = p_converted->format.i_height;
-            fmt_in.i_chroma = fmt_out.i_chroma = p_converted->format.i_chroma;
+            p_converted = p_slot->p_picture;
+            memset( &fmt_out, 0, sizeof( video_format_t ) );
+            fmt_out.i_width = p_converted->format.i_width;
+            fmt_out.i_height = p_converted->format.i_height;
+            fmt_out.i_chroma = p_converted->format.i_chroma;
             fmt_out.i_visible_width = fmt_out.i_width;
             fmt_out.i_visible_height = fmt_out.i_height;
         }
 
+        i_real_index = p_slot->i_real_index;
+        i_row = ( i_real_index / p_sys->i_cols ) % p_sys->i_rows;
+        i_col = i_real_index % p_sys->i_cols ;
+
         p_region = subpicture_region_New( &fmt_out );
         /* FIXME the copy is probably not needed anymore */
         if( p_region )
             picture_Copy( p_region->p_picture, p_converted );
-        if( !p_sys->b_keep )
-            picture_Release( p_converted );
 
         if( !p_region )
         {
             msg_Err( p_filter, "cannot allocate SPU region" );
             subpicture_Delete( p_spu );
-            vlc_global_unlock( VLC_MOSAIC_MUTEX );
-            vlc_mutex_unlock( &p_sys->lock );
-            return NULL;
+            p_spu = NULL;
+            break;
         }
 
-        if( p_es->i_x >= 0 && p_es->i_y >= 0 )
+        if( p_slot->i_x >= 0 && p_slot->i_y >= 0 )
         {
-            p_region->i_x = p_es->i_x;
-            p_region->i_y = p_es->i_y;
+            p_region->i_x = p_slot->i_x;
+            p_region->i_y = p_slot->i_y;
         }
         else if( p_sys->i_position == position_offsets )
         {
@@ -702,7 +920,7 @@ static subpicture_t *Filter( filter_t *p_filter, mtime_t date )
             }
         }
         p_region->i_align = p_sys->i_align;
-        p_region->i_alpha = p_es->i_alpha;
+        p_region->i_alpha = p_slot->i_alpha;
 
         if( p_region_prev == NULL )
         {
@@ -716,7 +934,11 @@ static subpicture_t *Filter( filter_t *p_filter, mtime_t date )
         p_region_prev = p_region;
     }
 
-    vlc_global_unlock( VLC_MOSAIC_MUTEX );
+    for( int i_slot = 0; i_slot < i_slots; i_slot++ )
+        if( p_slots[i_slot].p_picture != NULL )
+            picture_Release( p_slots[i_slot].p_picture );
+    free( p_slots );
+
     vlc_mutex_unlock( &p_sys->lock );
 
     return p_spu;
@@ -912,10 +1134,6 @@ static int MosaicCallback( vlc_object_t *p_this, char const *psz_var,
     {
         vlc_mutex_lock( &p_sys->lock );
         p_sys->b_keep = newval.b_bool;
-        if ( !p_sys->b_keep && !p_sys->p_image )
-        {
-            p_sys->p_image = image_HandlerCreate( p_this );
-        }
         vlc_mutex_unlock( &p_sys->lock );
     }
 
@@ -34,6 +34,7 @@
 #include <vlc_sout.h>
 
 #include <vlc_filter.h>
+#include <vlc_memstream.h>
 #include "filter_picture.h"
 
 /*****************************************************************************
@@ -44,6 +45,12 @@ static void Destroy   ( vlc_object_t * );
 
 #define FILTER_PREFIX "motiondetect-"
 
+#define DRAW_TEXT N_("Draw the moving areas")
+#define DRAW_LONGTEXT N_("Draw rectangles around the moving areas. " \
+    "The areas are also published in the \"" FILTER_PREFIX "areas\" " \
+    "variable of the video output, as \"x,y,width,height\" items " \
+    "separated by semicolons.")
+
 vlc_module_begin ()
     set_description( N_("Motion detect video filter") )
     set_shortname( N_( "Motion Detect" ))
@@ -51,6 +58,8 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     set_capability( "video filter", 0 )
 
+    add_bool( FILTER_PREFIX "draw", true, DRAW_TEXT, DRAW_LONGTEXT, false )
+
     add_shortcut( "motion" )
     set_callbacks( Create, Destroy )
 vlc_module_end ()
@@ -66,11 +75,18 @@ static int FindShapes( uint32_t *, uint32_t *, int, int, int,
 static void Draw( filter_t *p_filter, uint8_t *p_pix, int i_pix_pitch, int i_pix_size );
 #define NUM_COLORS (5000)
 
+/* The motion is analysed on blocks of BLOCK_SIZE x BLOCK_SIZE pixels */
+#define BLOCK_SIZE 4
+
 struct filter_sys_t
 {
     bool is_yuv_planar;
     bool b_old;
+    bool b_draw;
     picture_t *p_old;
+    /* Analysis buffers, one value per block */
+    unsigned i_blocks_w;
+    unsigned i_blocks_h;
     uint32_t *p_buf;
     uint32_t *p_buf2;
 
@@ -108,6 +124,13 @@ static int Create( vlc_object_t *p_this )
                      (char*)&(p_fmt->i_chroma) );
             return VLC_EGENERIC;
     }
+    /* The smoothing needs at least 5x5 blocks */
+    if( p_fmt->i_width < 5 * BLOCK_SIZE || p_fmt->i_height < 5 * BLOCK_SIZE )
+    {
+        msg_Err( p_filter, "Picture too small (%ux%u)",
+                 p_fmt->i_width, p_fmt->i_height );
+        return VLC_EGENERIC;
+    }
     p_filter->pf_video_filter = Filter;
 
     /* Allocate structure */
@@ -117,9 +140,12 @@ static int Create( vlc_object_t *p_this )
 
     p_sys->is_yuv_planar = is_yuv_planar;
     p_sys->b_old = false;
+    p_sys->b_draw = var_InheritBool( p_filter, FILTER_PREFIX "draw" );
     p_sys->p_old = picture_NewFromFormat( p_fmt );
-    p_sys->p_buf  = calloc( p_fmt->i_width * p_fmt->i_height, sizeof(*p_sys->p_buf) );
-    p_sys->p_buf2 = calloc( p_fmt->i_width * p_fmt->i_height, sizeof(*p_sys->p_buf) );
+    p_sys->i_blocks_w = p_fmt->i_width / BLOCK_SIZE;
+    p_sys->i_blocks_h = p_fmt->i_height / BLOCK_SIZE;
+    p_sys->p_buf  = calloc( p_sys->i_blocks_w * p_sys->i_blocks_h, sizeof(*p_sys->p_buf) );
+    p_sys->p_buf2 = calloc( p_sys->i_blocks_w * p_sys->i_blocks_h, sizeof(*p_sys->p_buf) );
 
     if( !p_sys->p_old || !p_sys->p_buf || !p_sys->p_buf2 )
     {
@@ -127,9 +153,15 @@ static int Create( vlc_object_t *p_this )
         free( p_sys->p_buf );
         if( p_sys->p_old )
             picture_Release( p_sys->p_old );
+        free( p_sys );
         return VLC_ENOMEM;
     }
 
+    /* Motion events for the owner (video output) */
+    vlc_object_t *p_owner = p_filter->obj.parent;
+    var_Create( p_owner, FILTER_PREFIX "shapes", VLC_VAR_INTEGER );
+    var_Create( p_owner, FILTER_PREFIX "areas", VLC_VAR_STRING );
+
     return VLC_SUCCESS;
 }
 
@@ -141,6 +173,9 @@ static void Destroy( vlc_object_t *p_this )
     filter_t *p_filter = (filter_t *)p_this;
     filter_sys_t *p_sys = p_filter->p_sys;
 
+    var_Destroy( p_filter->obj.parent, FILTER_PREFIX "areas" );
+    var_Destroy( p_filter->obj.parent, FILTER_PREFIX "shapes" );
+
     free( p_sys->p_buf2 );
     free( p_sys->p_buf );
     picture_Release( p_sys->p_old );
@@ -150,25 +185,49 @@ static void Destroy( vlc_object_t *p_this )
 
 /*****************************************************************************
  * Filter YUV Planar/Packed
+ *****************************************************************************
+ * The difference with the previous picture is computed as the mean absolute
+ * difference (SAD / pixel count) of each block of BLOCK_SIZE x BLOCK_SIZE
+ * pixels, so that the shapes are searched on a downscaled picture.
  *****************************************************************************/
+static unsigned BlockSAD( const uint8_t *p_a, int i_pitch_a,
+                          const uint8_t *p_b, int i_pitch_b,
+                          int i_width, int i_height )
+{
+    unsigned i_sad = 0;
+
+    for( int y = 0; y < i_height; y++ )
+    {
+        for( int x = 0; x < i_width; x++ )
+            i_sad += abs( p_a[x] - p_b[x] );
+        p_a += i_pitch_a;
+        p_b += i_pitch_b;
+    }
+    return i_sad;
+}
+
 static void PreparePlanar( filter_t *p_filter, picture_t *p_inpic )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    const video_format_t *p_fmt = &p_filter->fmt_in.video;
-
-    uint8_t *p_oldpix   = p_sys->p_old->p[Y_PLANE].p_pixels;
-    const int i_old_pitch = p_sys->p_old->p[Y_PLANE].i_pitch;
+    const unsigned i_blocks_w = p_sys->i_blocks_w;
+    const unsigned i_blocks_h = p_sys->i_blocks_h;
 
-    const uint8_t *p_inpix = p_inpic->p[Y_PLANE].p_pixels;
-    const int i_src_pitch = p_inpic->p[Y_PLANE].i_pitch;
+    const plane_t *p_old = &p_sys->p_old->p[Y_PLANE];
+    const plane_t *p_in = &p_inpic->p[Y_PLANE];
 
     /**
      * Substract Y planes
      */
-    for( unsigned y = 0; y < p_fmt->i_height; y++ )
+    for( unsigned by = 0; by < i_blocks_h; by++ )
     {
-        for( unsigned x = 0; x < p_fmt->i_width; x++ )
-            p_sys->p_buf2[y*p_fmt->i_width+x] = abs( p_inpix[y*i_src_pitch+x] - p_oldpix[y*i_old_pitch+x] );
+        const uint8_t *p_inpix = &p_in->p_pixels[by * BLOCK_SIZE * p_in->i_pitch];
+        const uint8_t *p_oldpix = &p_old->p_pixels[by * BLOCK_SIZE * p_old->i_pitch];
+
+        for( unsigned bx = 0; bx < i_blocks_w; bx++ )
+            p_sys->p_buf2[by * i_blocks_w + bx] =
+                BlockSAD( &p_inpix[bx * BLOCK_SIZE], p_in->i_pitch,
+                          &p_oldpix[bx * BLOCK_SIZE], p_old->i_pitch,
+                          BLOCK_SIZE, BLOCK_SIZE ) / (BLOCK_SIZE * BLOCK_SIZE);
     }
 
     int i_chroma_dx;
@@ -193,28 +252,25 @@ static void PreparePlanar( filter_t *p_filter, picture_t *p_inpic )
             return;
     }
 
-    const uint8_t *p_inpix_u = p_inpic->p[U_PLANE].p_pixels;
-    const uint8_t *p_inpix_v = p_inpic->p[V_PLANE].p_pixels;
-    const int i_src_pitch_u = p_inpic->p[U_PLANE].i_pitch;
-    const int i_src_pitch_v = p_inpic->p[V_PLANE].i_pitch;
-
-    const uint8_t *p_oldpix_u = p_sys->p_old->p[U_PLANE].p_pixels;
-    const uint8_t *p_oldpix_v = p_sys->p_old->p[V_PLANE].p_pixels;
-    const int i_old_pitch_u = p_sys->p_old->p[U_PLANE].i_pitch;
-    const int i_old_pitch_v = p_sys->p_old->p[V_PLANE].i_pitch;
+    /* Add the chroma difference of the co-located chroma blocks */
+    const int i_cw = BLOCK_SIZE / i_chroma_dx;
+    const int i_ch = BLOCK_SIZE / i_chroma_dy;
 
-    for( unsigned y = 0; y < p_fmt->i_height/i_chroma_dy; y++ )
+    for( int i_plane = U_PLANE; i_plane <= V_PLANE; i_plane++ )
     {
-        for( unsigned x = 0; x < p_fmt->i_width/i_chroma_dx; x ++ )
-        {
-            const int d = abs( p_inpix_u[y*i_src_pitch_u+x] - p_oldpix_u[y*i_old_pitch_u+x] ) +
-                          abs( p_inpix_v[y*i_src_pitch_v+x] - p_oldpix_v[y*i_old_pitch_v+x] );
+        p_old = &p_sys->p_old->p[i_plane];
+        p_in = &p_inpic->p[i_plane];
 
-            for( int j = 0; j < i_chroma_dy; j++ )
-            {
-                for( int i = 0; i < i_chroma_dx; i++ )
-                    p_sys->p_buf2[i_chroma_dy*p_fmt->i_width*j + i_chroma_dx*i] = d;
-            }
+        for( unsigned by = 0; by < i_blocks_h; by++ )
+        {
+            const uint8_t *p_inpix = &p_in->p_pixels[by * i_ch * p_in->i_pitch];
+            const uint8_t *p_oldpix = &p_old->p_pixels[by * i_ch * p_old->i_pitch];
+
+            for( unsigned bx = 0; bx < i_blocks_w; bx++ )
+                p_sys->p_buf2[by * i_blocks_w + bx] +=
+                    BlockSAD( &p_inpix[bx * i_cw], p_in->i_pitch,
+                              &p_oldpix[bx * i_cw], p_old->i_pitch,
+                              i_cw, i_ch ) / (i_cw * i_ch);
         }
     }
 }
@@ -235,23 +291,37 @@ static int PreparePacked( filter_t *p_filter, picture_t *p_inpic, int *pi_pix_of
     *pi_pix_offset = i_y_offset;
 
     /* Substract all planes at once */
-    uint8_t *p_oldpix   = p_sys->p_old->p[Y_PLANE].p_pixels;
-    const int i_old_pitch = p_sys->p_old->p[Y_PLANE].i_pitch;
-
-    const uint8_t *p_inpix = p_inpic->p[Y_PLANE].p_pixels;
-    const int i_src_pitch = p_inpic->p[Y_PLANE].i_pitch;
+    const plane_t *p_old = &p_sys->p_old->p[Y_PLANE];
+    const plane_t *p_in = &p_inpic->p[Y_PLANE];
 
-    for( unsigned y = 0; y < p_fmt->i_height; y++ )
+    for( unsigned by = 0; by < p_sys->i_blocks_h; by++ )
     {
-        for( unsigned x = 0; x < p_fmt->i_width; x+=2 )
+        for( unsigned bx = 0; bx < p_sys->i_blocks_w; bx++ )
         {
-            int d;
-            d = abs( p_inpix[y*i_src_pitch+2*x+i_u_offset] - p_oldpix[y*i_old_pitch+2*x+i_u_offset] ) +
-                abs( p_inpix[y*i_src_pitch+2*x+i_v_offset] - p_oldpix[y*i_old_pitch+2*x+i_v_offset] );
+            const uint8_t *p_inpix = &p_in->p_pixels[by * BLOCK_SIZE * p_in->i_pitch
+                                                     + bx * BLOCK_SIZE * 2];
+            const uint8_t *p_oldpix = &p_old->p_pixels[by * BLOCK_SIZE * p_old->i_pitch
+                                                       + bx * BLOCK_SIZE * 2];
+            unsigned i_luma = 0, i_chroma = 0;
+
+            for( int y = 0; y < BLOCK_SIZE; y++ )
+            {
+                for( int x = 0; x < BLOCK_SIZE; x += 2 )
+                {
+                    const uint8_t *a = &p_inpix[2 * x], *b = &p_oldpix[2 * x];
 
-            for( int i = 0; i < 2; i++ )
-                p_sys->p_buf2[y*p_fmt->i_width+x+i] =
-                    abs( p_inpix[y*i_src_pitch+2*(x+i)+i_y_offset] - p_oldpix[y*i_old_pitch+2*(x+i)+i_y_offset] ) + d;
+                    i_luma += abs( a[i_y_offset] - b[i_y_offset] )
+                            + abs( a[i_y_offset + 2] - b[i_y_offset + 2] );
+                    i_chroma += abs( a[i_u_offset] - b[i_u_offset] )
+                              + abs( a[i_v_offset] - b[i_v_offset] );
+                }
+                p_inpix += p_in->i_pitch;
+                p_oldpix += p_old->i_pitch;
+            }
+
+            p_sys->p_buf2[by * p_sys->i_blocks_w + bx] =
+                i_luma / (BLOCK_SIZE * BLOCK_SIZE) +
+                i_chroma / (BLOCK_SIZE * BLOCK_SIZE / 2);
         }
     }
     return VLC_SUCCESS;
@@ -297,8 +367,8 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_inpic )
     /**
      * Get the areas where movement was detected
      */
-    const video_format_t *p_fmt = &p_filter->fmt_in.video;
-    p_sys->i_colors = FindShapes( p_sys->p_buf2, p_sys->p_buf, p_fmt->i_width, p_fmt->i_width, p_fmt->i_height,
+    p_sys->i_colors = FindShapes( p_sys->p_buf2, p_sys->p_buf,
+                                  p_sys->i_blocks_w, p_sys->i_blocks_w, p_sys->i_blocks_h,
                                   p_sys->colors, p_sys->color_x_min, p_sys->color_x_max, p_sys->color_y_min, p_sys->color_y_max );
 
     /**
@@ -520,8 +590,11 @@ static int FindShapes( uint32_t *p_diff, uint32_t *p_smooth,
 static void Draw( filter_t *p_filter, uint8_t *p_pix, int i_pix_pitch, int i_pix_size )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
+    const video_format_t *p_fmt = &p_filter->fmt_in.video;
 
     int j = 0;
+    struct vlc_memstream areas;
+    bool b_areas = vlc_memstream_open( &areas ) == 0;
 
     for( int i = 1; i < p_sys->i_colors; i++ )
     {
@@ -529,19 +602,31 @@ static void Draw( filter_t *p_filter, uint8_t *p_pix, int i_pix_pitch, int i_pix
 
         if( p_sys->colors[i] != i )
             continue;
+        if( p_sys->color_x_min[i] == -1 )
+            continue;
 
-        const int color_x_min = p_sys->color_x_min[i];
-        const int color_x_max = p_sys->color_x_max[i];
-        const int color_y_min = p_sys->color_y_min[i];
-        const int color_y_max = p_sys->color_y_max[i];
+        /* Back to picture coordinates */
+        const int color_x_min = p_sys->color_x_min[i] * BLOCK_SIZE;
+        const int color_x_max = __MIN( (p_sys->color_x_max[i] + 1) * BLOCK_SIZE,
+                                       (int)p_fmt->i_width ) - 1;
+        const int color_y_min = p_sys->color_y_min[i] * BLOCK_SIZE;
+        const int color_y_max = __MIN( (p_sys->color_y_max[i] + 1) * BLOCK_SIZE,
+                                       (int)p_fmt->i_height ) - 1;
 
-        if( color_x_min == -1 )
-            continue;
         if( ( color_y_max - color_y_min ) * ( color_x_max - color_x_min ) < 16 )
             continue;
 
         j++;
 
+        if( b_areas )
+            vlc_memstream_printf( &areas, "%s%d,%d,%d,%d", j > 1 ? ";" : "",
+                     color_x_min, color_y_min,
+                     color_x_max - color_x_min + 1,
+                     color_y_max - color_y_min + 1 );
+
+        if( !p_sys->b_draw )
+            continue;
+
         y = color_y_min;
         for( x = color_x_min; x <= color_x_max; x++ )
             p_pix[y*i_pix_pitch+x*i_pix_size] = 0xff;
@@ -559,4 +644,12 @@ static void Draw( filter_t *p_filter, uint8_t *p_pix, int i_pix_pitch, int i_pix
             p_pix[y*i_pix_pitch+x*i_pix_size] = 0xff;
     }
     msg_Dbg( p_filter, "Counted %d moving shapes.", j );
+
+    /* Publish the moving areas */
+    if( b_areas && vlc_memstream_close( &areas ) == 0 )
+    {
+        var_SetString( p_filter->obj.parent, FILTER_PREFIX "areas", areas.ptr );
+        free( areas.ptr );
+    }
+    var_SetInteger( p_filter->obj.parent, FILTER_PREFIX "shapes", j );
 }
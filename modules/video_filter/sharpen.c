@@ -160,46 +160,35 @@ static void Destroy( vlc_object_t *p_this )
     free( p_sys );
 }
 
-/*****************************************************************************
- * Render: displays previously rendered output
- *****************************************************************************
- * This function send the currently rendered image to Invert image, waits
- * until it is displayed and switch the two rendering buffers, preparing next
- * frame.
- *****************************************************************************/
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+struct sharpen_job
 {
-    picture_t *p_outpic;
-    uint8_t *restrict p_src = NULL;
-    uint8_t *restrict p_out = NULL;
-    int i_src_pitch;
-    int i_out_pitch;
-    int pix;
+    const plane_t *src;
+    plane_t *out;
+    int sigma;
+};
+
+/* Convolution of the rows of one band, avoiding the border lines */
+static void FilterSlice( filter_t *p_filter, void *data,
+                         unsigned index, unsigned count )
+{
+    const struct sharpen_job *job = data;
+    const uint8_t *restrict p_src = job->src->p_pixels;
+    uint8_t *restrict p_out = job->out->p_pixels;
+    const int i_src_pitch = job->src->i_pitch;
+    const int i_out_pitch = job->out->i_pitch;
+    const unsigned i_visible_lines = job->src->i_visible_lines;
+    const unsigned i_visible_pitch = job->src->i_visible_pitch;
+    const unsigned i_start = __MAX( 1, i_visible_lines * index / count );
+    const unsigned i_end = __MIN( i_visible_lines - 1,
+                                  i_visible_lines * (index + 1) / count );
+    const int sigma = job->sigma;
     const int v1 = -1;
     const int v2 = 3; /* 2^3 = 8 */
-    const unsigned i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
-    const unsigned i_visible_pitch = p_pic->p[Y_PLANE].i_visible_pitch;
-    const int sigma = var_GetFloat( p_filter, FILTER_PREFIX "sigma" ) * (1 << 20);
-
-    p_outpic = filter_NewPicture( p_filter );
-    if( !p_outpic )
-    {
-        picture_Release( p_pic );
-        return NULL;
-    }
-
-    /* process the Y plane */
-    p_src = p_pic->p[Y_PLANE].p_pixels;
-    p_out = p_outpic->p[Y_PLANE].p_pixels;
-    i_src_pitch = p_pic->p[Y_PLANE].i_pitch;
-    i_out_pitch = p_outpic->p[Y_PLANE].i_pitch;
-
-    /* perform convolution only on Y plane. Avoid border line. */
-    vlc_mutex_lock( &p_filter->p_sys->lock );
+    int pix;
 
-    memcpy(p_out, p_src, i_visible_pitch);
+    VLC_UNUSED(p_filter);
 
-    for( unsigned i = 1; i < i_visible_lines - 1; i++ )
+    for( unsigned i = i_start; i < i_end; i++ )
     {
         p_out[i * i_out_pitch] = p_src[i * i_src_pitch];
 
@@ -223,8 +212,44 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
         p_out[i * i_out_pitch + i_visible_pitch - 1] =
             p_src[i * i_src_pitch + i_visible_pitch - 1];
     }
-    memcpy(&p_out[(i_visible_lines - 1) * i_out_pitch],
-           &p_src[(i_visible_lines - 1) * i_src_pitch], i_visible_pitch);
+}
+
+/*****************************************************************************
+ * Render: displays previously rendered output
+ *****************************************************************************
+ * This function send the currently rendered image to Invert image, waits
+ * until it is displayed and switch the two rendering buffers, preparing next
+ * frame.
+ *****************************************************************************/
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    picture_t *p_outpic;
+    const unsigned i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
+    const unsigned i_visible_pitch = p_pic->p[Y_PLANE].i_visible_pitch;
+
+    p_outpic = filter_NewPicture( p_filter );
+    if( !p_outpic )
+    {
+        picture_Release( p_pic );
+        return NULL;
+    }
+
+    /* process the Y plane */
+    struct sharpen_job job = {
+        .src = &p_pic->p[Y_PLANE],
+        .out = &p_outpic->p[Y_PLANE],
+        .sigma = var_GetFloat( p_filter, FILTER_PREFIX "sigma" ) * (1 << 20),
+    };
+    uint8_t *p_src = job.src->p_pixels;
+    uint8_t *p_out = job.out->p_pixels;
+
+    /* perform convolution only on Y plane. Avoid border line. */
+    vlc_mutex_lock( &p_filter->p_sys->lock );
+
+    memcpy(p_out, p_src, i_visible_pitch);
+    filter_RunSlices( p_filter, FilterSlice, &job );
+    memcpy(&p_out[(i_visible_lines - 1) * job.out->i_pitch],
+           &p_src[(i_visible_lines - 1) * job.src->i_pitch], i_visible_pitch);
 
     vlc_mutex_unlock( &p_filter->p_sys->lock );
 
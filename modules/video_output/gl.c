@@ -42,6 +42,11 @@ static void Close (vlc_object_t *);
 #define GLES_TEXT N_("OpenGL ES extension")
 #define PROVIDER_LONGTEXT N_( \
     "Extension through which to use the Open Graphics Library (OpenGL).")
+#define ADJUST_TEXT N_("Adjust colors on the GPU")
+#define ADJUST_LONGTEXT N_( \
+    "Apply the contrast, brightness, hue and saturation settings of the " \
+    "image adjustment filter while converting YUV pictures to RGB, instead " \
+    "of running that filter on the CPU. Gamma is not supported.")
 
 vlc_module_begin ()
 #if USE_OPENGL_ES == 2
@@ -78,6 +83,8 @@ vlc_module_begin ()
     add_module ("gl", "opengl", NULL,
                 GL_TEXT, PROVIDER_LONGTEXT, true)
 #endif
+    add_bool (MODULE_VARNAME"-adjust", false, ADJUST_TEXT, ADJUST_LONGTEXT,
+              true)
 vlc_module_end ()
 
 struct vout_display_sys_t
@@ -131,6 +138,15 @@ static int Open (vlc_object_t *obj)
     if (sys->vgl == NULL)
         goto error;
 
+    if (var_InheritBool (vd, MODULE_VARNAME"-adjust")
+     && vout_display_opengl_SetAdjust (sys->vgl,
+                                       var_InheritFloat (vd, "contrast"),
+                                       var_InheritFloat (vd, "brightness"),
+                                       var_InheritFloat (vd, "hue"),
+                                       var_InheritFloat (vd, "saturation")))
+        msg_Warn (vd, "cannot adjust %4.4s pictures on the GPU",
+                  (const char *)&vd->fmt.i_chroma);
+
     vd->sys = sys;
     vd->info.has_pictures_invalid = false;
     vd->info.has_event_thread = false;
@@ -203,6 +219,10 @@ static void PictureDisplay (vout_display_t *vd, picture_t *pic, subpicture_t *su
     vout_display_opengl_Display (sys->vgl, &vd->source);
     vlc_gl_ReleaseCurrent (sys->gl);
 
+    mtime_t date, period;
+    if (vlc_gl_GetVsync (sys->gl, &date, &period) == VLC_SUCCESS)
+        vout_display_SendEventVsync (vd, date, period);
+
     picture_Release (pic);
     (void) subpicture;
 }
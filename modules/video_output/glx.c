@@ -40,6 +40,10 @@ typedef struct vlc_gl_sys_t
     Display *display;
     GLXWindow win;
     GLXContext ctx;
+#ifdef GLX_OML_sync_control
+    PFNGLXGETSYNCVALUESOMLPROC GetSyncValues;
+    mtime_t period;
+#endif
 } vlc_gl_sys_t;
 
 static int MakeCurrent (vlc_gl_t *gl)
@@ -65,6 +69,26 @@ static void SwapBuffers (vlc_gl_t *gl)
     glXSwapBuffers (sys->display, sys->win);
 }
 
+#ifdef GLX_OML_sync_control
+static int GetVsync (vlc_gl_t *gl, mtime_t *date, mtime_t *period)
+{
+    vlc_gl_sys_t *sys = gl->sys;
+    int64_t ust, msc, sbc;
+
+    if (!sys->GetSyncValues (sys->display, sys->win, &ust, &msc, &sbc))
+        return VLC_EGENERIC;
+
+    /* The unadjusted system time is not specified, but it is the monotonic
+     * clock in microseconds in practice. Check that just in case. */
+    if (llabs (ust - mdate ()) > CLOCK_FREQ)
+        return VLC_EGENERIC;
+
+    *date = ust;
+    *period = sys->period;
+    return VLC_SUCCESS;
+}
+#endif
+
 static void *GetSymbol(vlc_gl_t *gl, const char *procname)
 {
     (void) gl;
@@ -233,6 +257,25 @@ static int Open (vlc_object_t *obj)
         SwapIntervalEXT (dpy, sys->win, 1);
         is_swap_interval_set = true;
     }
+# endif
+# ifdef GLX_OML_sync_control
+    if (is_swap_interval_set
+     && CheckGLXext (dpy, snum, "GLX_OML_sync_control"))
+    {
+        PFNGLXGETMSCRATEOMLPROC GetMscRate = (PFNGLXGETMSCRATEOMLPROC)
+            glXGetProcAddressARB ((const GLubyte *)"glXGetMscRateOML");
+        int32_t num, den;
+
+        sys->GetSyncValues = (PFNGLXGETSYNCVALUESOMLPROC)
+            glXGetProcAddressARB ((const GLubyte *)"glXGetSyncValuesOML");
+        if (GetMscRate != NULL && sys->GetSyncValues != NULL
+         && GetMscRate (dpy, sys->win, &num, &den) && num > 0 && den > 0)
+        {
+            sys->period = CLOCK_FREQ * den / num;
+            gl->getVsync = GetVsync;
+            msg_Dbg (obj, "display refresh period %"PRId64" us", sys->period);
+        }
+    }
 # endif
     ReleaseCurrent (gl);
 #endif
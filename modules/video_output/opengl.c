@@ -74,6 +74,18 @@
 #   import <CoreFoundation/CoreFoundation.h>
 #endif
 #endif
+#if defined(__APPLE__) && !USE_OPENGL_ES
+#   define PFNGLMAPBUFFERPROC                typeof(glMapBuffer)*
+#   define PFNGLUNMAPBUFFERPROC              typeof(glUnmapBuffer)*
+#endif
+
+#ifndef GL_PIXEL_UNPACK_BUFFER
+# define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+
+#if !USE_OPENGL_ES && !defined(__APPLE__) && defined(GL_MAP_PERSISTENT_BIT)
+#   define SUPPORTS_BUFFER_STORAGE
+#endif
 
 #if USE_OPENGL_ES
 #   define GLSL_VERSION "100"
@@ -112,8 +124,21 @@ typedef struct {
 
     float    tex_width;
     float    tex_height;
+
+    /* Picture last uploaded into the texture, with its crop */
+    picture_t *picture;
+    unsigned   x_offset;
+    unsigned   y_offset;
 } gl_region_t;
 
+#ifdef SUPPORTS_BUFFER_STORAGE
+/* Pool picture backed by a persistently mapped pixel buffer object */
+struct picture_sys_t {
+    GLuint buffer;
+    size_t offset[PICTURE_PLANE_MAX];
+};
+#endif
+
 struct vout_display_opengl_t {
 
     vlc_gl_t   *gl;
@@ -143,6 +168,10 @@ struct vout_display_opengl_t {
     int        local_count;
     GLfloat    local_value[16];
 
+    /* YUV to RGB conversion matrix, NULL if YUV is not converted by shader */
+    const float *yuv_matrix;
+    float       yuv_range_correction;
+
     GLuint vertex_buffer_object;
     GLuint index_buffer_object;
     GLuint texture_buffer_object[PICTURE_PLANE_MAX];
@@ -150,6 +179,19 @@ struct vout_display_opengl_t {
     GLuint *subpicture_buffer_object;
     int    subpicture_buffer_object_count;
 
+    /* Pixel buffer objects used to upload the picture planes without
+     * stalling on the texture transfer */
+    bool   use_pbo;
+    GLuint pixel_buffer_object[PICTURE_PLANE_MAX];
+
+#ifdef SUPPORTS_BUFFER_STORAGE
+    /* Pool pictures are directly written into GPU-visible memory */
+    bool     use_persistent;
+    unsigned persistent_count;
+    GLuint   persistent_buffer[VLCGL_PICTURE_MAX];
+    GLsync   upload_fence;
+#endif
+
     /* Shader variables commands*/
 #ifdef SUPPORTS_SHADERS
     PFNGLGETUNIFORMLOCATIONPROC      GetUniformLocation;
@@ -185,6 +227,17 @@ struct vout_display_opengl_t {
     PFNGLBINDBUFFERPROC    BindBuffer;
     PFNGLBUFFERDATAPROC    BufferData;
     PFNGLDELETEBUFFERSPROC DeleteBuffers;
+#if !USE_OPENGL_ES
+    PFNGLMAPBUFFERPROC     MapBuffer;
+    PFNGLUNMAPBUFFERPROC   UnmapBuffer;
+#endif
+#ifdef SUPPORTS_BUFFER_STORAGE
+    PFNGLBUFFERSTORAGEPROC   BufferStorage;
+    PFNGLMAPBUFFERRANGEPROC  MapBufferRange;
+    PFNGLFENCESYNCPROC       FenceSync;
+    PFNGLCLIENTWAITSYNCPROC  ClientWaitSync;
+    PFNGLDELETESYNCPROC      DeleteSync;
+#endif
 #endif
 
 #if defined(_WIN32)
@@ -263,6 +316,63 @@ static void BuildVertexShader(vout_display_opengl_t *vgl,
     vgl->CompileShader(*shader);
 }
 
+/**
+ * Fills the YUV to RGB conversion coefficients.
+ *
+ * The picture adjustment of the adjust video filter (except gamma) is a
+ * linear transformation of the normalized YUV values, so it is folded into
+ * the conversion matrix and costs nothing per pixel.
+ *
+ * \param adjust contrast, brightness, hue (degrees) and saturation,
+ *               or NULL for no adjustment
+ */
+static void SetYUVCoefficients(GLfloat *local_value,
+                               const float matrix[static 12],
+                               float yuv_range_correction,
+                               const float *adjust)
+{
+    float m[12];
+
+    memcpy(m, matrix, sizeof (m));
+    if (adjust != NULL) {
+        const float contrast = adjust[0], brightness = adjust[1];
+        const float hue = adjust[2] * (float)(M_PI / 180.);
+        const float hcos = cosf(hue) * adjust[3], hsin = sinf(hue) * adjust[3];
+
+        /* [Y' U' V'] = A * [Y U V] + a, as done by the adjust filter */
+        const float A[3][3] = {
+            { contrast, 0.f,   0.f  },
+            { 0.f,      hcos,  hsin },
+            { 0.f,     -hsin,  hcos },
+        };
+        const float a[3] = {
+            brightness - .5f - contrast / 2.f,
+            .5f - (hcos + hsin) / 2.f,
+            .5f - (hcos - hsin) / 2.f,
+        };
+
+        for (int j = 0; j < 3; j++) {
+            float offset = matrix[j*4+3];
+            for (int k = 0; k < 3; k++) {
+                float v = 0.f;
+                for (int i = 0; i < 3; i++)
+                    v += matrix[j*4+i] * A[i][k];
+                m[j*4+k] = v;
+                offset += matrix[j*4+k] * a[k];
+            }
+            m[j*4+3] = offset;
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        float correction = i < 3 ? yuv_range_correction : 1.f;
+        /* We place coefficient values for coefficient[4] in one array from matrix values.
+           Notice that we fill values from top down instead of left to right.*/
+        for (int j = 0; j < 4; j++)
+            local_value[i*4+j] = j < 3 ? correction * m[j*4+i] : 0.f;
+    }
+}
+
 static void BuildYUVFragmentShader(vout_display_opengl_t *vgl,
                                    GLint *shader,
                                    int *local_count,
@@ -272,15 +382,15 @@ static void BuildYUVFragmentShader(vout_display_opengl_t *vgl,
 
 {
     /* [R/G/B][Y U V O] from TV range to full range
-     * XXX we could also do hue/brightness/constrast/gamma
-     * by simply changing the coefficients
+     * hue/brightness/contrast/saturation are applied by changing the
+     * coefficients, see SetYUVCoefficients()
      */
-    const float matrix_bt601_tv2full[12] = {
+    static const float matrix_bt601_tv2full[12] = {
         1.164383561643836,  0.0000,             1.596026785714286, -0.874202217873451 ,
         1.164383561643836, -0.391762290094914, -0.812967647237771,  0.531667823499146 ,
         1.164383561643836,  2.017232142857142,  0.0000,            -1.085630789302022 ,
     };
-    const float matrix_bt709_tv2full[12] = {
+    static const float matrix_bt709_tv2full[12] = {
         1.164383561643836,  0.0000,             1.792741071428571, -0.972945075016308 ,
         1.164383561643836, -0.21324861427373,  -0.532909328559444,  0.301482665475862 ,
         1.164383561643836,  2.112401785714286,  0.0000,            -1.133402217873451 ,
@@ -325,14 +435,10 @@ static void BuildYUVFragmentShader(vout_display_opengl_t *vgl,
                  swap_uv ? 'y' : 'z') < 0)
         code = NULL;
 
-    for (int i = 0; i < 4; i++) {
-        float correction = i < 3 ? yuv_range_correction : 1.f;
-        /* We place coefficient values for coefficient[4] in one array from matrix values.
-           Notice that we fill values from top down instead of left to right.*/
-        for (int j = 0; j < 4; j++)
-            local_value[*local_count + i*4+j] = j < 3 ? correction * matrix[j*4+i]
-                                                      : 0.f;
-    }
+    SetYUVCoefficients(&local_value[*local_count], matrix,
+                       yuv_range_correction, NULL);
+    vgl->yuv_matrix = matrix;
+    vgl->yuv_range_correction = yuv_range_correction;
     (*local_count) += 4;
 
 
@@ -515,9 +621,33 @@ vout_display_opengl_t *vout_display_opengl_New(video_format_t *fmt,
     vgl->BindBuffer    = (PFNGLBINDBUFFERPROC)vlc_gl_GetProcAddress(vgl->gl, "glBindBuffer");
     vgl->BufferData    = (PFNGLBUFFERDATAPROC)vlc_gl_GetProcAddress(vgl->gl, "glBufferData");
     vgl->DeleteBuffers = (PFNGLDELETEBUFFERSPROC)vlc_gl_GetProcAddress(vgl->gl, "glDeleteBuffers");
+    vgl->MapBuffer     = (PFNGLMAPBUFFERPROC)vlc_gl_GetProcAddress(vgl->gl, "glMapBuffer");
+    vgl->UnmapBuffer   = (PFNGLUNMAPBUFFERPROC)vlc_gl_GetProcAddress(vgl->gl, "glUnmapBuffer");
 
     if (!vgl->CreateShader || !vgl->ShaderSource || !vgl->CreateProgram)
         supports_shaders = false;
+
+    /* Pixel buffer objects are core since OpenGL 2.1 */
+    vgl->use_pbo = supports_shaders && vgl->MapBuffer && vgl->UnmapBuffer
+        && (strverscmp((const char *)ogl_version, "2.1") >= 0
+         || HasExtension(extensions, "GL_ARB_pixel_buffer_object"));
+
+#ifdef SUPPORTS_BUFFER_STORAGE
+    vgl->BufferStorage  = (PFNGLBUFFERSTORAGEPROC)vlc_gl_GetProcAddress(vgl->gl, "glBufferStorage");
+    vgl->MapBufferRange = (PFNGLMAPBUFFERRANGEPROC)vlc_gl_GetProcAddress(vgl->gl, "glMapBufferRange");
+    vgl->FenceSync      = (PFNGLFENCESYNCPROC)vlc_gl_GetProcAddress(vgl->gl, "glFenceSync");
+    vgl->ClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)vlc_gl_GetProcAddress(vgl->gl, "glClientWaitSync");
+    vgl->DeleteSync     = (PFNGLDELETESYNCPROC)vlc_gl_GetProcAddress(vgl->gl, "glDeleteSync");
+
+    /* Persistent mappings are core since OpenGL 4.4, fences since 3.2 */
+    vgl->use_persistent = vgl->use_pbo && vgl->BufferStorage
+        && vgl->MapBufferRange && vgl->FenceSync && vgl->ClientWaitSync
+        && vgl->DeleteSync
+        && (strverscmp((const char *)ogl_version, "4.4") >= 0
+         || (HasExtension(extensions, "GL_ARB_buffer_storage")
+          && (strverscmp((const char *)ogl_version, "3.2") >= 0
+           || HasExtension(extensions, "GL_ARB_sync"))));
+#endif
 #endif
 
 #if defined(_WIN32)
@@ -629,6 +759,7 @@ vout_display_opengl_t *vout_display_opengl_New(video_format_t *fmt,
     vgl->shader[1] =
     vgl->shader[2] = -1;
     vgl->local_count = 0;
+    vgl->yuv_matrix = NULL;
     if (supports_shaders && (need_fs_yuv || need_fs_xyz|| need_fs_rgba)) {
 #ifdef SUPPORTS_SHADERS
         if (need_fs_xyz)
@@ -722,6 +853,9 @@ vout_display_opengl_t *vout_display_opengl_New(video_format_t *fmt,
     }
     vgl->subpicture_buffer_object_count = subpicture_buffer_object_count;
     vgl->GenBuffers(vgl->subpicture_buffer_object_count, vgl->subpicture_buffer_object);
+
+    if (vgl->use_pbo)
+        vgl->GenBuffers(vgl->chroma->plane_count, vgl->pixel_buffer_object);
 #endif
 
     vlc_gl_Unlock(vgl->gl);
@@ -753,6 +887,8 @@ void vout_display_opengl_Delete(vout_display_opengl_t *vgl)
         for (int i = 0; i < vgl->region_count; i++) {
             if (vgl->region[i].texture)
                 glDeleteTextures(1, &vgl->region[i].texture);
+            if (vgl->region[i].picture)
+                picture_Release(vgl->region[i].picture);
         }
         free(vgl->region);
 
@@ -769,6 +905,16 @@ void vout_display_opengl_Delete(vout_display_opengl_t *vgl)
         if (vgl->subpicture_buffer_object_count > 0)
             vgl->DeleteBuffers(vgl->subpicture_buffer_object_count, vgl->subpicture_buffer_object);
         free(vgl->subpicture_buffer_object);
+        if (vgl->use_pbo)
+            vgl->DeleteBuffers(vgl->chroma->plane_count, vgl->pixel_buffer_object);
+#endif
+#ifdef SUPPORTS_BUFFER_STORAGE
+        if (vgl->upload_fence != NULL)
+            vgl->DeleteSync(vgl->upload_fence);
+        /* This also unmaps the buffers: the pool pictures must not be used
+         * anymore */
+        if (vgl->persistent_count > 0)
+            vgl->DeleteBuffers(vgl->persistent_count, vgl->persistent_buffer);
 #endif
 
         free(vgl->texture_temp_buf);
@@ -779,6 +925,78 @@ void vout_display_opengl_Delete(vout_display_opengl_t *vgl)
     free(vgl);
 }
 
+int vout_display_opengl_SetAdjust(vout_display_opengl_t *vgl, float contrast,
+                                  float brightness, float hue,
+                                  float saturation)
+{
+    if (vgl->yuv_matrix == NULL || vgl->chroma->plane_count != 3)
+        return VLC_EGENERIC;
+
+    const float adjust[4] = { contrast, brightness, hue, saturation };
+    /* The coefficients are uploaded for every picture */
+    SetYUVCoefficients(vgl->local_value, vgl->yuv_matrix,
+                       vgl->yuv_range_correction, adjust);
+    return VLC_SUCCESS;
+}
+
+#define ALIGN(x, y) (((x) + ((y) - 1)) & ~((y) - 1))
+
+#ifdef SUPPORTS_BUFFER_STORAGE
+/* Allocates a picture in a persistently and coherently mapped pixel buffer
+ * object, so that the decoder writes directly into GPU-visible memory.
+ * The OpenGL context must be current. */
+static picture_t *NewPersistentPicture(vout_display_opengl_t *vgl)
+{
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+                           | GL_MAP_COHERENT_BIT;
+    picture_resource_t rsc;
+    size_t size = 0;
+
+    memset(&rsc, 0, sizeof (rsc));
+    rsc.p_sys = malloc(sizeof (*rsc.p_sys));
+    if (unlikely(rsc.p_sys == NULL))
+        return NULL;
+
+    for (unsigned j = 0; j < vgl->chroma->plane_count; j++) {
+        const vlc_chroma_description_t *dsc = vgl->chroma;
+
+        rsc.p[j].i_pitch = ALIGN(ALIGN(vgl->fmt.i_width, 64) * dsc->p[j].w.num
+                                 / dsc->p[j].w.den * dsc->pixel_size, 64);
+        rsc.p[j].i_lines = ALIGN(vgl->fmt.i_height, 32) * dsc->p[j].h.num
+                         / dsc->p[j].h.den;
+        rsc.p_sys->offset[j] = size;
+        size += rsc.p[j].i_pitch * rsc.p[j].i_lines;
+    }
+
+    GLuint buffer;
+    vgl->GenBuffers(1, &buffer);
+    vgl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    vgl->BufferStorage(GL_PIXEL_UNPACK_BUFFER, size, NULL, flags);
+
+    uint8_t *base = vgl->MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                        flags);
+    vgl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (base == NULL) {
+        vgl->DeleteBuffers(1, &buffer);
+        free(rsc.p_sys);
+        return NULL;
+    }
+
+    for (unsigned j = 0; j < vgl->chroma->plane_count; j++)
+        rsc.p[j].p_pixels = base + rsc.p_sys->offset[j];
+    rsc.p_sys->buffer = buffer;
+
+    picture_t *picture = picture_NewFromResource(&vgl->fmt, &rsc);
+    if (picture == NULL) {
+        vgl->DeleteBuffers(1, &buffer);
+        free(rsc.p_sys);
+        return NULL;
+    }
+    vgl->persistent_buffer[vgl->persistent_count++] = buffer;
+    return picture;
+}
+#endif
+
 picture_pool_t *vout_display_opengl_GetPool(vout_display_opengl_t *vgl, unsigned requested_count)
 {
     if (vgl->pool)
@@ -786,9 +1004,19 @@ picture_pool_t *vout_display_opengl_GetPool(vout_display_opengl_t *vgl, unsigned
 
     /* Allocate our pictures */
     picture_t *picture[VLCGL_PICTURE_MAX] = {NULL, };
-    unsigned count;
+    unsigned count = 0;
 
-    for (count = 0; count < __MIN(VLCGL_PICTURE_MAX, requested_count); count++) {
+#ifdef SUPPORTS_BUFFER_STORAGE
+    if (vgl->use_persistent && !vlc_gl_Lock(vgl->gl)) {
+        for (; count < __MIN(VLCGL_PICTURE_MAX, requested_count); count++) {
+            picture[count] = NewPersistentPicture(vgl);
+            if (!picture[count])
+                break;
+        }
+        vlc_gl_Unlock(vgl->gl);
+    }
+#endif
+    for (; count < __MIN(VLCGL_PICTURE_MAX, requested_count); count++) {
         picture[count] = picture_NewFromFormat(&vgl->fmt);
         if (!picture[count])
             break;
@@ -842,7 +1070,6 @@ error:
     return NULL;
 }
 
-#define ALIGN(x, y) (((x) + ((y) - 1)) & ~((y) - 1))
 static void Upload(vout_display_opengl_t *vgl, int in_width, int in_height,
                    int in_full_width, int in_full_height,
                    int w_num, int w_den, int h_num, int h_den,
@@ -907,12 +1134,99 @@ static void Upload(vout_display_opengl_t *vgl, int in_width, int in_height,
     }
 }
 
+#ifdef SUPPORTS_BUFFER_STORAGE
+/* Starts the transfer of a picture plane from its own pixel buffer object:
+ * no copy is involved. */
+static void UploadPersistent(vout_display_opengl_t *vgl, unsigned plane,
+                             const picture_t *picture)
+{
+    const plane_t *p = &picture->p[plane];
+    const int width = picture->format.i_visible_width
+                    * vgl->chroma->p[plane].w.num / vgl->chroma->p[plane].w.den;
+    const int height = vgl->fmt.i_visible_height
+                     * vgl->chroma->p[plane].h.num / vgl->chroma->p[plane].h.den;
+
+    vgl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, picture->p_sys->buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, p->i_pitch / p->i_pixel_pitch);
+    glTexSubImage2D(vgl->tex_target, 0, 0, 0, width, height,
+                    vgl->tex_format, vgl->tex_type,
+                    (const void *)(uintptr_t)picture->p_sys->offset[plane]);
+    vgl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+/* Waits until the GPU is done reading the last uploaded picture, which can
+ * then be written again by the decoder */
+static void WaitUpload(vout_display_opengl_t *vgl)
+{
+    if (vgl->upload_fence == NULL)
+        return;
+
+    while (vgl->ClientWaitSync(vgl->upload_fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                               INT64_C(1000000000)) == GL_TIMEOUT_EXPIRED);
+    vgl->DeleteSync(vgl->upload_fence);
+    vgl->upload_fence = NULL;
+}
+#endif
+
+#if defined(SUPPORTS_SHADERS) && !USE_OPENGL_ES
+/* Copies a picture plane into its pixel buffer object and starts the
+ * transfer to the bound texture. The buffer storage is orphaned first, so
+ * that neither the copy nor the next frame waits for the GPU to be done with
+ * the previous transfer. */
+static bool UploadPBO(vout_display_opengl_t *vgl, unsigned plane,
+                      const picture_t *picture)
+{
+    const plane_t *p = &picture->p[plane];
+    const int width = picture->format.i_visible_width
+                    * vgl->chroma->p[plane].w.num / vgl->chroma->p[plane].w.den;
+    const int height = vgl->fmt.i_visible_height
+                     * vgl->chroma->p[plane].h.num / vgl->chroma->p[plane].h.den;
+    const int line = width * p->i_pixel_pitch;
+    const int pitch = ALIGN(line, 4);
+
+    vgl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, vgl->pixel_buffer_object[plane]);
+    vgl->BufferData(GL_PIXEL_UNPACK_BUFFER, pitch * height, NULL,
+                    GL_STREAM_DRAW);
+
+    uint8_t *dst = vgl->MapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (dst == NULL) {
+        vgl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    const uint8_t *src = p->p_pixels;
+    for (int y = 0; y < height; y++) {
+        memcpy(dst, src, line);
+        src += p->i_pitch;
+        dst += pitch;
+    }
+
+    if (!vgl->UnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+        /* The buffer content was lost (e.g. mode switch) */
+        vgl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glTexSubImage2D(vgl->tex_target, 0, 0, 0, width, height,
+                    vgl->tex_format, vgl->tex_type, NULL);
+    vgl->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
+#endif
+
 int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
                                 picture_t *picture, subpicture_t *subpicture)
 {
     if (vlc_gl_Lock(vgl->gl))
         return VLC_EGENERIC;
 
+#ifdef SUPPORTS_BUFFER_STORAGE
+    WaitUpload(vgl);
+#endif
+
     /* Update the texture */
     for (unsigned j = 0; j < vgl->chroma->plane_count; j++) {
         if (vgl->use_multitexture) {
@@ -921,12 +1235,28 @@ int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
         }
         glBindTexture(vgl->tex_target, vgl->texture[0][j]);
 
+#ifdef SUPPORTS_BUFFER_STORAGE
+        if (picture->p_sys != NULL && vgl->use_persistent) {
+            UploadPersistent(vgl, j, picture);
+            continue;
+        }
+#endif
+#if defined(SUPPORTS_SHADERS) && !USE_OPENGL_ES
+        if (vgl->use_pbo && UploadPBO(vgl, j, picture))
+            continue;
+#endif
         Upload(vgl, picture->format.i_visible_width, vgl->fmt.i_visible_height,
                vgl->fmt.i_width, vgl->fmt.i_height,
                vgl->chroma->p[j].w.num, vgl->chroma->p[j].w.den, vgl->chroma->p[j].h.num, vgl->chroma->p[j].h.den,
                picture->p[j].i_pitch, picture->p[j].i_pixel_pitch, 0, picture->p[j].p_pixels, vgl->tex_target, vgl->tex_format, vgl->tex_type);
     }
 
+#ifdef SUPPORTS_BUFFER_STORAGE
+    /* The picture goes back to the decoder once displayed */
+    if (picture->p_sys != NULL && vgl->use_persistent)
+        vgl->upload_fence = vgl->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+
     int         last_count = vgl->region_count;
     gl_region_t *last = vgl->region;
 
@@ -970,6 +1300,31 @@ int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
             glr->bottom = -2.0 * (r->i_y + r->fmt.i_visible_height) / subpicture->i_original_picture_height + 1.0;
 
             glr->texture = 0;
+            glr->x_offset = r->fmt.i_x_offset;
+            glr->y_offset = r->fmt.i_y_offset;
+
+            /* The SPU renders static regions into the same picture, frame
+               after frame. Keep the texture that already holds it as is. */
+            bool uploaded = false;
+            for (int j = 0; j < last_count; j++) {
+                if (last[j].texture &&
+                    last[j].picture  == r->p_picture &&
+                    last[j].x_offset == glr->x_offset &&
+                    last[j].y_offset == glr->y_offset &&
+                    last[j].width  == glr->width &&
+                    last[j].height == glr->height &&
+                    last[j].format == glr->format &&
+                    last[j].type   == glr->type) {
+                    glr->texture = last[j].texture;
+                    glr->picture = last[j].picture;
+                    memset(&last[j], 0, sizeof(last[j]));
+                    uploaded = true;
+                    break;
+                }
+            }
+            if (uploaded)
+                continue;
+
             /* Try to recycle the textures allocated by the previous
                call to this function. */
             for (int j = 0; j < last_count; j++) {
@@ -979,10 +1334,13 @@ int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
                     last[j].format == glr->format &&
                     last[j].type   == glr->type) {
                     glr->texture = last[j].texture;
+                    if (last[j].picture)
+                        picture_Release(last[j].picture);
                     memset(&last[j], 0, sizeof(last[j]));
                     break;
                 }
             }
+            glr->picture = picture_Hold(r->p_picture);
 
             const int pixels_offset = r->fmt.i_y_offset * r->p_picture->p->i_pitch +
                                       r->fmt.i_x_offset * r->p_picture->p->i_pixel_pitch;
@@ -1013,6 +1371,8 @@ int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
     for (int i = 0; i < last_count; i++) {
         if (last[i].texture)
             glDeleteTextures(1, &last[i].texture);
+        if (last[i].picture)
+            picture_Release(last[i].picture);
     }
     free(last);
 
@@ -1769,6 +2129,10 @@ int vout_display_opengl_Display(vout_display_opengl_t *vgl,
     glDisable(GL_TEXTURE_2D);
 #endif
 
+#ifdef SUPPORTS_BUFFER_STORAGE
+    WaitUpload(vgl);
+#endif
+
     /* Display */
     vlc_gl_Swap(vgl->gl);
 
@@ -94,6 +94,16 @@ vout_display_opengl_t *vout_display_opengl_New(video_format_t *fmt,
                                                vlc_gl_t *gl);
 void vout_display_opengl_Delete(vout_display_opengl_t *vgl);
 
+/**
+ * Adjusts the picture colors, like the adjust video filter but without gamma,
+ * as part of the YUV to RGB conversion on the GPU.
+ *
+ * @return VLC_EGENERIC if the pictures are not converted by shaders
+ */
+int vout_display_opengl_SetAdjust(vout_display_opengl_t *vgl, float contrast,
+                                  float brightness, float hue,
+                                  float saturation);
+
 picture_pool_t *vout_display_opengl_GetPool(vout_display_opengl_t *vgl, unsigned);
 
 int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
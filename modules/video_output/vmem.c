@@ -85,6 +85,22 @@ struct picture_sys_t {
     void *id;
 };
 
+/* NOTE: the layout must match that of libvlc_video_frame_t */
+struct vmem_frame {
+    char     chroma[5];
+    unsigned width;
+    unsigned height;
+    unsigned planes_count;
+    void    *planes[PICTURE_PLANE_MAX];
+    unsigned pitches[PICTURE_PLANE_MAX];
+    unsigned lines[PICTURE_PLANE_MAX];
+    int64_t  pts;
+    void    *surface;
+    void   (*release)(struct vmem_frame *);
+
+    picture_t *picture; /* reference held until released */
+};
+
 /* NOTE: the callback prototypes must match those of LibVLC */
 struct vout_display_sys_t {
     picture_pool_t *pool;
@@ -95,6 +111,7 @@ struct vout_display_sys_t {
     void (*unlock)(void *sys, void *id, void *const *plane);
     void (*display)(void *sys, void *id);
     void (*cleanup)(void *sys);
+    void (*frame)(void *sys, struct vmem_frame *frame);
 
     unsigned pitches[PICTURE_PLANE_MAX];
     unsigned lines[PICTURE_PLANE_MAX];
@@ -123,8 +140,9 @@ static int Open(vlc_object_t *object)
     /* Get the callbacks */
     vlc_format_cb setup = var_InheritAddress(vd, "vmem-setup");
 
+    sys->frame = var_InheritAddress(vd, "vmem-frame");
     sys->lock = var_InheritAddress(vd, "vmem-lock");
-    if (sys->lock == NULL) {
+    if (sys->frame == NULL && sys->lock == NULL) {
         msg_Err(vd, "missing lock callback");
         free(sys);
         return VLC_EGENERIC;
@@ -137,6 +155,20 @@ static int Open(vlc_object_t *object)
 
     /* Define the video format */
     video_format_t fmt;
+
+    if (sys->frame != NULL) {
+        /* Frames are handed as decoded: keep the format as is, so that no
+         * converter nor copy is inserted in between */
+        const vlc_chroma_description_t *dsc =
+            vlc_fourcc_GetChromaDescription(vd->fmt.i_chroma);
+
+        fmt = vd->fmt;
+        if (dsc == NULL || dsc->plane_count == 0)
+            fmt.i_chroma = VLC_CODEC_I420;
+        sys->cleanup = NULL;
+        goto done;
+    }
+
     video_format_ApplyRotation(&fmt, &vd->fmt);
 
     if (setup != NULL) {
@@ -207,6 +239,7 @@ static int Open(vlc_object_t *object)
         break;
     }
 
+done:;
     /* */
     vout_display_info_t info = vd->info;
     info.has_hide_mouse = true;
@@ -255,6 +288,9 @@ static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic)
     picture_resource_t rsc = { .p_sys = NULL };
     void *planes[PICTURE_PLANE_MAX];
 
+    if (sys->frame != NULL)
+        return; /* handed without copy in Display() */
+
     sys->pic_opaque = sys->lock(sys->opaque, planes);
 
     for (unsigned i = 0; i < PICTURE_PLANE_MAX; i++) {
@@ -275,11 +311,62 @@ static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic)
     (void) subpic;
 }
 
+static void FrameRelease(struct vmem_frame *frame)
+{
+    picture_Release(frame->picture);
+    free(frame);
+}
+
+static void DisplayFrame(vout_display_t *vd, picture_t *pic)
+{
+    vout_display_sys_t *sys = vd->sys;
+    const video_format_t *fmt = &vd->fmt;
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(fmt->i_chroma);
+
+    struct vmem_frame *frame = malloc(sizeof(*frame));
+    if (unlikely(frame == NULL))
+        return;
+
+    memcpy(frame->chroma, &fmt->i_chroma, 4);
+    frame->chroma[4] = '\0';
+    frame->width = fmt->i_visible_width;
+    frame->height = fmt->i_visible_height;
+    frame->planes_count = pic->i_planes;
+
+    /* point at the visible area */
+    for (int i = 0; i < pic->i_planes; i++) {
+        const plane_t *p = &pic->p[i];
+        size_t offset = fmt->i_y_offset * dsc->p[i].h.num / dsc->p[i].h.den
+                        * p->i_pitch
+                      + fmt->i_x_offset * dsc->p[i].w.num / dsc->p[i].w.den
+                        * p->i_pixel_pitch;
+
+        frame->planes[i] = p->p_pixels + offset;
+        frame->pitches[i] = p->i_pitch;
+        frame->lines[i] = p->i_visible_lines;
+    }
+    for (int i = pic->i_planes; i < PICTURE_PLANE_MAX; i++) {
+        frame->planes[i] = NULL;
+        frame->pitches[i] = 0;
+        frame->lines[i] = 0;
+    }
+
+    frame->pts = pic->date;
+    frame->surface = pic->context;
+    frame->release = FrameRelease;
+    frame->picture = picture_Hold(pic);
+
+    sys->frame(sys->opaque, frame);
+}
+
 static void Display(vout_display_t *vd, picture_t *pic, subpicture_t *subpic)
 {
     vout_display_sys_t *sys = vd->sys;
 
-    if (sys->display != NULL)
+    if (sys->frame != NULL)
+        DisplayFrame(vd, pic);
+    else if (sys->display != NULL)
         sys->display(sys->opaque, sys->pic_opaque);
 
     picture_Release(pic);
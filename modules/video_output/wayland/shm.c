@@ -31,9 +31,11 @@
 
 #include <sys/types.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <wayland-client.h>
+#include "presentation-time-client-protocol.h"
 #include "scaler-client-protocol.h"
 
 #include <vlc_common.h>
@@ -51,6 +53,8 @@ struct vout_display_sys_t
     struct wl_shm *shm;
     struct wl_scaler *scaler;
     struct wl_viewport *viewport;
+    struct wp_presentation *presentation;
+    bool presentation_monotonic; /* Presentation clock is mdate() clock */
 
     picture_pool_t *pool; /* picture pool */
 
@@ -228,12 +232,61 @@ static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic)
     (void) subpic;
 }
 
+static void feedback_sync_output_cb(void *data,
+                                    struct wp_presentation_feedback *fb,
+                                    struct wl_output *output)
+{
+    (void) data; (void) fb; (void) output;
+}
+
+static void feedback_presented_cb(void *data,
+                                  struct wp_presentation_feedback *fb,
+                                  uint32_t sec_hi, uint32_t sec_lo,
+                                  uint32_t nsec, uint32_t refresh,
+                                  uint32_t seq_hi, uint32_t seq_lo,
+                                  uint32_t flags)
+{
+    vout_display_t *vd = data;
+    uint64_t sec = ((uint64_t)sec_hi << 32) | sec_lo;
+
+    /* Only refreshes with a known period can be used for scheduling */
+    if (refresh != 0 && (flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC))
+        vout_display_SendEventVsync(vd, sec * CLOCK_FREQ + nsec / 1000,
+                                    refresh / 1000);
+
+    wp_presentation_feedback_destroy(fb);
+    (void) seq_hi; (void) seq_lo;
+}
+
+static void feedback_discarded_cb(void *data,
+                                  struct wp_presentation_feedback *fb)
+{
+    wp_presentation_feedback_destroy(fb);
+    (void) data;
+}
+
+static const struct wp_presentation_feedback_listener feedback_cbs =
+{
+    feedback_sync_output_cb,
+    feedback_presented_cb,
+    feedback_discarded_cb,
+};
+
 static void Display(vout_display_t *vd, picture_t *pic, subpicture_t *subpic)
 {
     vout_display_sys_t *sys = vd->sys;
     struct wl_display *display = sys->embed->display.wl;
     struct wl_surface *surface = sys->embed->handle.wl;
 
+    if (sys->presentation_monotonic)
+    {
+        struct wp_presentation_feedback *fb =
+            wp_presentation_feedback(sys->presentation, surface);
+
+        if (fb != NULL)
+            wp_presentation_feedback_add_listener(fb, &feedback_cbs, vd);
+    }
+
     wl_surface_commit(surface);
     wl_display_roundtrip_queue(display, sys->eventq);
 
@@ -359,6 +412,25 @@ static const struct wl_shm_listener shm_cbs =
     shm_format_cb,
 };
 
+static void presentation_clock_id_cb(void *data,
+                                     struct wp_presentation *presentation,
+                                     uint32_t clock)
+{
+    vout_display_t *vd = data;
+    vout_display_sys_t *sys = vd->sys;
+
+    /* mdate() uses the monotonic clock: other clocks cannot be converted */
+    sys->presentation_monotonic = clock == CLOCK_MONOTONIC;
+    msg_Dbg(vd, "presentation clock %"PRIu32"%s", clock,
+            sys->presentation_monotonic ? "" : " (unusable)");
+    (void) presentation;
+}
+
+static const struct wp_presentation_listener presentation_cbs =
+{
+    presentation_clock_id_cb,
+};
+
 static void registry_global_cb(void *data, struct wl_registry *registry,
                                uint32_t name, const char *iface, uint32_t vers)
 {
@@ -374,6 +446,10 @@ static void registry_global_cb(void *data, struct wl_registry *registry,
         sys->scaler = wl_registry_bind(registry, name, &wl_scaler_interface,
                                        1);
     else
+    if (!strcmp(iface, "wp_presentation"))
+        sys->presentation = wl_registry_bind(registry, name,
+                                             &wp_presentation_interface, 1);
+    else
     if (!strcmp(iface, "wl_compositor"))
         sys->use_buffer_transform = vers >= 2;
 }
@@ -405,6 +481,8 @@ static int Open(vlc_object_t *obj)
     sys->eventq = NULL;
     sys->shm = NULL;
     sys->scaler = NULL;
+    sys->presentation = NULL;
+    sys->presentation_monotonic = false;
     sys->pool = NULL;
     sys->x = 0;
     sys->y = 0;
@@ -434,6 +512,9 @@ static int Open(vlc_object_t *obj)
         goto error;
 
     wl_shm_add_listener(sys->shm, &shm_cbs, vd);
+    if (sys->presentation != NULL)
+        wp_presentation_add_listener(sys->presentation, &presentation_cbs,
+                                     vd);
     wl_display_roundtrip_queue(display, sys->eventq);
 
     struct wl_surface *surface = sys->embed->handle.wl;
@@ -479,6 +560,8 @@ static int Open(vlc_object_t *obj)
     return VLC_SUCCESS;
 
 error:
+    if (sys->presentation != NULL)
+        wp_presentation_destroy(sys->presentation);
     if (sys->eventq != NULL)
         wl_event_queue_destroy(sys->eventq);
     if (sys->embed != NULL)
@@ -498,6 +581,8 @@ static void Close(vlc_object_t *obj)
         wl_viewport_destroy(sys->viewport);
     if (sys->scaler != NULL)
         wl_scaler_destroy(sys->scaler);
+    if (sys->presentation != NULL)
+        wp_presentation_destroy(sys->presentation);
     wl_shm_destroy(sys->shm);
     wl_display_flush(sys->embed->display.wl);
     wl_event_queue_destroy(sys->eventq);
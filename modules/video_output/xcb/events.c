@@ -225,7 +225,7 @@ static void HandleVisibilityNotify (vout_display_t *vd, bool *visible,
 /**
  * Process an X11 event.
  */
-static int ProcessEvent (vout_display_t *vd, xcb_connection_t *conn,
+int vlc_xcb_ProcessEvent(vout_display_t *vd, xcb_connection_t *conn,
                          bool *visible, xcb_generic_event_t *ev)
 {
     switch (ev->response_type & 0x7f)
@@ -263,7 +263,7 @@ int vlc_xcb_Manage(vout_display_t *vd, xcb_connection_t *conn, bool *visible)
     xcb_generic_event_t *ev;
 
     while ((ev = xcb_poll_for_event (conn)) != NULL)
-        ProcessEvent (vd, conn, visible, ev);
+        vlc_xcb_ProcessEvent(vd, conn, visible, ev);
 
     if (xcb_connection_has_error (conn))
     {
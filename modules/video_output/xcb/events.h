@@ -63,6 +63,12 @@ struct vout_window_t *vlc_xcb_parent_Create(vout_display_t *obj,
 xcb_cursor_t vlc_xcb_cursor_Create(xcb_connection_t *conn,
                                    const xcb_screen_t *scr);
 
+/**
+ * Processes one XCB event, and frees it.
+ */
+int vlc_xcb_ProcessEvent(vout_display_t *vd, xcb_connection_t *conn,
+                         bool *visible, xcb_generic_event_t *ev);
+
 /**
  * Processes XCB events.
  */
@@ -150,6 +150,118 @@ int XCB_picture_Alloc (vout_display_t *vd, picture_resource_t *res,
     return 0;
 }
 
+void XCB_shm_QueueInit (xcb_shm_queue_t *queue, xcb_connection_t *conn)
+{
+    const xcb_query_extension_reply_t *ext;
+
+    queue->first = NULL;
+    queue->lastp = &queue->first;
+
+    ext = xcb_get_extension_data (conn, &xcb_shm_id);
+    if (ext != NULL && ext->present)
+        queue->completion = ext->first_event + XCB_SHM_COMPLETION;
+    else
+        queue->completion = 0;
+}
+
+/**
+ * Keeps a picture until the X server is done reading it.
+ * The queue takes ownership of the picture reference.
+ */
+void XCB_shm_QueuePush (xcb_shm_queue_t *queue, picture_t *pic)
+{
+    if (queue->completion == 0)
+    {   /* No completion event will ever come */
+        picture_Release (pic);
+        return;
+    }
+
+    pic->p_next = NULL;
+    *queue->lastp = pic;
+    queue->lastp = &pic->p_next;
+}
+
+/**
+ * Releases all pending pictures.
+ *
+ * This is safe even if the server has not completed the requests yet, as the
+ * shared memory segments are only detached when the pool is destroyed, and
+ * the server processes the detach requests after the put requests.
+ */
+void XCB_shm_QueueFlush (xcb_shm_queue_t *queue)
+{
+    picture_t *pic = queue->first;
+
+    while (pic != NULL)
+    {
+        picture_t *next = pic->p_next;
+
+        pic->p_next = NULL;
+        picture_Release (pic);
+        pic = next;
+    }
+    queue->first = NULL;
+    queue->lastp = &queue->first;
+}
+
+static void XCB_shm_QueueComplete (xcb_shm_queue_t *queue, xcb_shm_seg_t seg)
+{
+    /* The server processes requests in order: all pictures put before the
+     * completed one have been read too. */
+    for (picture_t *pic = queue->first; pic != NULL; pic = pic->p_next)
+    {
+        if (XCB_picture_GetSegment (pic) != seg)
+            continue;
+
+        picture_t *done = queue->first;
+
+        queue->first = pic->p_next;
+        if (queue->first == NULL)
+            queue->lastp = &queue->first;
+        pic->p_next = NULL;
+
+        while (done != NULL)
+        {
+            picture_t *next = done->p_next;
+
+            done->p_next = NULL;
+            picture_Release (done);
+            done = next;
+        }
+        break;
+    }
+}
+
+/**
+ * Processes X events, including shared memory completion events.
+ */
+int XCB_shm_Manage (vout_display_t *vd, xcb_connection_t *conn, bool *visible,
+                    xcb_shm_queue_t *queue)
+{
+    xcb_generic_event_t *ev;
+
+    while ((ev = xcb_poll_for_event (conn)) != NULL)
+    {
+        if (queue->completion != 0
+         && (ev->response_type & 0x7f) == queue->completion)
+        {
+            const xcb_shm_completion_event_t *ce = (void *)ev;
+
+            XCB_shm_QueueComplete (queue, ce->shmseg);
+            free (ev);
+        }
+        else
+            vlc_xcb_ProcessEvent (vd, conn, visible, ev);
+    }
+
+    if (xcb_connection_has_error (conn))
+    {
+        msg_Err (vd, "X server failure");
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
 picture_t *XCB_picture_NewFromResource (const video_format_t *restrict fmt,
                                         const picture_resource_t *restrict res,
                                         xcb_connection_t *conn)
@@ -41,3 +41,24 @@ static inline xcb_shm_seg_t XCB_picture_GetSegment(const picture_t *pic)
 {
     return (uintptr_t)pic->p_sys;
 }
+
+/**
+ * Shared memory pictures still being read by the X server.
+ *
+ * Pictures are put with the send_event flag and kept here, in submission
+ * order, until the matching ShmCompletion event arrives. This way, the
+ * picture pool never hands out a buffer that the server is reading, and the
+ * video output does not need to wait for the server after each frame.
+ */
+typedef struct
+{
+    picture_t *first; /**< oldest pending picture */
+    picture_t **lastp;
+    uint8_t completion; /**< ShmCompletion event type, 0 if unknown */
+} xcb_shm_queue_t;
+
+void XCB_shm_QueueInit (xcb_shm_queue_t *, xcb_connection_t *);
+void XCB_shm_QueuePush (xcb_shm_queue_t *, picture_t *);
+void XCB_shm_QueueFlush (xcb_shm_queue_t *);
+int XCB_shm_Manage (vout_display_t *, xcb_connection_t *, bool *visible,
+                    xcb_shm_queue_t *);
@@ -74,6 +74,7 @@ struct vout_display_sys_t
     uint8_t depth; /* useful bits per pixel */
 
     picture_pool_t *pool; /* picture pool */
+    xcb_shm_queue_t queue; /* pictures being read by the server */
 };
 
 static picture_pool_t *Pool (vout_display_t *, unsigned);
@@ -122,6 +123,7 @@ static int Open (vlc_object_t *obj)
         return VLC_EGENERIC;
     }
     sys->conn = conn;
+    XCB_shm_QueueInit (&sys->queue, conn);
 
     const xcb_setup_t *setup = xcb_get_setup (conn);
 
@@ -410,12 +412,15 @@ static void Display (vout_display_t *vd, picture_t *pic, subpicture_t *subpictur
 {
     vout_display_sys_t *sys = vd->sys;
     xcb_shm_seg_t segment = XCB_picture_GetSegment(pic);
-    xcb_void_cookie_t ck;
+
+    /* Recycle the pictures that the server is done with */
+    XCB_shm_Manage (vd, sys->conn, &sys->visible, &sys->queue);
 
     if (!sys->visible)
         goto out;
     if (segment != 0)
-        ck = xcb_shm_put_image_checked (sys->conn, sys->window, sys->gc,
+    {
+        xcb_shm_put_image (sys->conn, sys->window, sys->gc,
           /* real width */ pic->p->i_pitch / pic->p->i_pixel_pitch,
          /* real height */ pic->p->i_lines,
                    /* x */ vd->fmt.i_x_offset,
@@ -423,33 +428,37 @@ static void Display (vout_display_t *vd, picture_t *pic, subpicture_t *subpictur
                /* width */ vd->fmt.i_visible_width,
               /* height */ vd->fmt.i_visible_height,
                            0, 0, sys->depth, XCB_IMAGE_FORMAT_Z_PIXMAP,
-                           0, segment, 0);
-    else
-    {
-        const size_t offset = vd->fmt.i_y_offset * pic->p->i_pitch;
-        const unsigned lines = pic->p->i_lines - vd->fmt.i_y_offset;
-
-        ck = xcb_put_image_checked (sys->conn, XCB_IMAGE_FORMAT_Z_PIXMAP,
-                       sys->window, sys->gc,
-                       pic->p->i_pitch / pic->p->i_pixel_pitch,
-                       lines, -vd->fmt.i_x_offset, 0, 0, sys->depth,
-                       pic->p->i_pitch * lines, pic->p->p_pixels + offset);
+                           1 /* send ShmCompletion */, segment, 0);
+        xcb_flush (sys->conn);
+
+        /* Do not wait for the server: the picture is kept out of the pool
+         * until the completion event, so it cannot be overwritten while it is
+         * being read. */
+        XCB_shm_QueuePush (&sys->queue, pic);
+        (void)subpicture;
+        return;
     }
 
+    const size_t offset = vd->fmt.i_y_offset * pic->p->i_pitch;
+    const unsigned lines = pic->p->i_lines - vd->fmt.i_y_offset;
+    xcb_void_cookie_t ck;
+
+    ck = xcb_put_image_checked (sys->conn, XCB_IMAGE_FORMAT_Z_PIXMAP,
+                   sys->window, sys->gc,
+                   pic->p->i_pitch / pic->p->i_pixel_pitch,
+                   lines, -vd->fmt.i_x_offset, 0, 0, sys->depth,
+                   pic->p->i_pitch * lines, pic->p->p_pixels + offset);
+
     /* Wait for reply. This makes sure that the X server gets CPU time to
-     * display the picture. xcb_flush() is *not* sufficient: especially with
-     * shared memory the PUT requests are so short that many of them can fit in
-     * X11 socket output buffer before the kernel preempts VLC. */
+     * display the picture. xcb_flush() is *not* sufficient: the PUT requests
+     * can fit in the X11 socket output buffer before the kernel preempts
+     * VLC. */
     xcb_generic_error_t *e = xcb_request_check (sys->conn, ck);
     if (e != NULL)
     {
         msg_Dbg (vd, "%s: X11 error %d", "cannot put image", e->error_code);
         free (e);
     }
-
-    /* FIXME might be WAY better to wait in some case (be carefull with
-     * VOUT_DISPLAY_RESET_PICTURES if done) + does not work with
-     * vout_display wrapper. */
 out:
     picture_Release (pic);
     (void)subpicture;
@@ -530,13 +539,15 @@ static void Manage (vout_display_t *vd)
 {
     vout_display_sys_t *sys = vd->sys;
 
-    vlc_xcb_Manage(vd, sys->conn, &sys->visible);
+    XCB_shm_Manage (vd, sys->conn, &sys->visible, &sys->queue);
 }
 
 static void ResetPictures (vout_display_t *vd)
 {
     vout_display_sys_t *sys = vd->sys;
 
+    XCB_shm_QueueFlush (&sys->queue);
+
     if (!sys->pool)
         return;
 
@@ -96,6 +96,7 @@ struct vout_display_sys_t
 
     xcb_xv_query_image_attributes_reply_t *att;
     picture_pool_t *pool; /* picture pool */
+    xcb_shm_queue_t queue; /* pictures being read by the server */
 };
 
 static picture_pool_t *Pool (vout_display_t *, unsigned);
@@ -379,6 +380,7 @@ static int Open (vlc_object_t *obj)
     }
 
     p_sys->conn = conn;
+    XCB_shm_QueueInit (&p_sys->queue, conn);
     p_sys->att = NULL;
     p_sys->pool = NULL;
 
@@ -590,6 +592,7 @@ static void Close (vlc_object_t *obj)
     vout_display_t *vd = (vout_display_t *)obj;
     vout_display_sys_t *p_sys = vd->sys;
 
+    XCB_shm_QueueFlush (&p_sys->queue);
     if (p_sys->pool)
         picture_pool_Release (p_sys->pool);
 
@@ -682,24 +685,36 @@ static void Display (vout_display_t *vd, picture_t *pic, subpicture_t *subpictur
 {
     vout_display_sys_t *p_sys = vd->sys;
     xcb_shm_seg_t segment = XCB_picture_GetSegment(pic);
-    xcb_void_cookie_t ck;
     video_format_t fmt;
 
+    /* Recycle the pictures that the server is done with */
+    XCB_shm_Manage (vd, p_sys->conn, &p_sys->visible, &p_sys->queue);
+
     if (!p_sys->visible)
         goto out;
 
     video_format_ApplyRotation(&fmt, &vd->source);
 
     if (segment)
-        ck = xcb_xv_shm_put_image_checked (p_sys->conn, p_sys->port,
+    {
+        xcb_xv_shm_put_image (p_sys->conn, p_sys->port,
                               p_sys->window, p_sys->gc, segment, p_sys->id, 0,
                    /* Src: */ fmt.i_x_offset, fmt.i_y_offset,
                               fmt.i_visible_width, fmt.i_visible_height,
                    /* Dst: */ 0, 0, p_sys->width, p_sys->height,
                 /* Memory: */ pic->p->i_pitch / pic->p->i_pixel_pitch,
-                              pic->p->i_lines, false);
-    else
-        ck = xcb_xv_put_image_checked (p_sys->conn, p_sys->port, p_sys->window,
+                              pic->p->i_lines, true /* ShmCompletion */);
+        xcb_flush (p_sys->conn);
+
+        /* Do not wait for the server. See x11.c for rationale. */
+        XCB_shm_QueuePush (&p_sys->queue, pic);
+        (void)subpicture;
+        return;
+    }
+
+    xcb_void_cookie_t ck;
+
+    ck = xcb_xv_put_image_checked (p_sys->conn, p_sys->port, p_sys->window,
                           p_sys->gc, p_sys->id,
                           fmt.i_x_offset, fmt.i_y_offset,
                           fmt.i_visible_width, fmt.i_visible_height,
@@ -782,7 +797,7 @@ static void Manage (vout_display_t *vd)
 {
     vout_display_sys_t *p_sys = vd->sys;
 
-    vlc_xcb_Manage(vd, p_sys->conn, &p_sys->visible);
+    XCB_shm_Manage (vd, p_sys->conn, &p_sys->visible, &p_sys->queue);
 }
 
 static int EnumAdaptors (vlc_object_t *obj, const char *var,
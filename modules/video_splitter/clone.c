@@ -153,6 +153,7 @@ static int Open( vlc_object_t *p_this )
     }
 
     /* */
+    p_splitter->b_reference = true;
     p_splitter->pf_filter = Filter;
     p_splitter->pf_mouse  = NULL;
 
@@ -184,14 +185,9 @@ static void Close( vlc_object_t *p_this )
 static int Filter( video_splitter_t *p_splitter,
                    picture_t *pp_dst[], picture_t *p_src )
 {
-    if( video_splitter_NewPicture( p_splitter, pp_dst ) )
-    {
-        picture_Release( p_src );
-        return VLC_EGENERIC;
-    }
-
+    /* Every output shares the source picture */
     for( int i = 0; i < p_splitter->i_output; i++ )
-        picture_Copy( pp_dst[i], p_src );
+        pp_dst[i] = picture_Hold( p_src );
 
     picture_Release( p_src );
     return VLC_SUCCESS;
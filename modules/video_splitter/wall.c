@@ -369,6 +369,7 @@ static int Open( vlc_object_t *p_this )
     }
 
     /* */
+    p_splitter->b_reference = true;
     p_splitter->pf_filter = Filter;
     p_splitter->pf_mouse = Mouse;
 
@@ -391,12 +392,8 @@ static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t
 {
     video_splitter_sys_t *p_sys = p_splitter->p_sys;
 
-    if( video_splitter_NewPicture( p_splitter, pp_dst ) )
-    {
-        picture_Release( p_src );
-        return VLC_EGENERIC;
-    }
-
+    /* The outputs reference their area of the source picture, so that the
+     * memory traffic does not grow with the size of the wall. */
     for( int y = 0; y < p_sys->i_row; y++ )
     {
         for( int x = 0; x < p_sys->i_col; x++ )
@@ -405,20 +402,17 @@ static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t
             if( !p_output->b_active )
                 continue;
 
-            picture_t *p_dst = pp_dst[p_output->i_output];
-
-            /* */
-            picture_t tmp = *p_src;
-            for( int i = 0; i < tmp.i_planes; i++ )
+            const int i_index = p_output->i_output;
+            pp_dst[i_index] = picture_NewSubRect( p_src,
+                                    &p_splitter->p_output[i_index].fmt,
+                                    p_output->i_left, p_output->i_top );
+            if( pp_dst[i_index] == NULL )
             {
-                plane_t *p0 = &tmp.p[0];
-                plane_t *p = &tmp.p[i];
-                const int i_y = p_output->i_top  * p->i_visible_pitch / p0->i_visible_pitch;
-                const int i_x = p_output->i_left * p->i_visible_lines / p0->i_visible_lines;
-
-                p->p_pixels += i_y * p->i_pitch + ( i_x - (i_x % p->i_pixel_pitch));
+                for( int i = 0; i < i_index; i++ )
+                    picture_Release( pp_dst[i] );
+                picture_Release( p_src );
+                return VLC_EGENERIC;
             }
-            picture_Copy( p_dst, &tmp );
         }
     }
 
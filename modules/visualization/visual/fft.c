@@ -42,7 +42,8 @@ static void fft_prepare(const sound_sample *input, float * re, float * im,
                         const unsigned int *bitReverse);
 static void fft_calculate(float * re, float * im,
                           const float *costable, const float *sintable );
-static void fft_output(const float *re, const float *im, float *output);
+static void fft_output(const float *re, const float *im, float *output,
+                       const float *costable, const float *sintable);
 static int reverseBits(unsigned int initial);
 
 /*****************************************************************************
@@ -64,7 +65,7 @@ fft_state *visual_fft_init(void)
     if(! p_state )
         return NULL;
 
-    for(i = 0; i < FFT_BUFFER_SIZE; i++)
+    for(i = 0; i < FFT_BUFFER_SIZE / 2; i++)
     {
         p_state->bitReverse[i] = reverseBits(i);
     }
@@ -95,7 +96,8 @@ void fft_perform(const sound_sample *input, float *output, fft_state *state) {
     fft_calculate(state->real, state->imag, state->costable, state->sintable);
 
     /* Convert the FFT output into intensities */
-    fft_output(state->real, state->imag, output);
+    fft_output(state->real, state->imag, output,
+               state->costable, state->sintable);
 }
 
 /*
@@ -111,6 +113,8 @@ void fft_close(fft_state *state) {
 
 /*
  * Prepare data to perform an FFT on
+ * The real input is packed as a complex signal of half the size: even
+ * samples as the real parts and odd samples as the imaginary parts.
  */
 static void fft_prepare( const sound_sample *input, float * re, float * im,
                          const unsigned int *bitReverse ) {
@@ -119,38 +123,51 @@ static void fft_prepare( const sound_sample *input, float * re, float * im,
     float *p_imag = im;
 
     /* Get input, in reverse bit order */
-    for(i = 0; i < FFT_BUFFER_SIZE; i++)
+    for(i = 0; i < FFT_BUFFER_SIZE / 2; i++)
     {
-        *p_real++ = input[bitReverse[i]];
-        *p_imag++ = 0;
+        const sound_sample *p_in = input + 2 * bitReverse[i];
+        *p_real++ = p_in[0];
+        *p_imag++ = p_in[1];
     }
 }
 
 /*
  * Take result of an FFT and calculate the intensities of each frequency
+ * The spectrum of the real input is recovered from the half size complex
+ * one: with Z the transform of the packed signal, E and O the transforms of
+ * the even and odd samples,
+ *   E[k] = (Z[k] + conj(Z[M-k])) / 2
+ *   O[k] = (Z[k] - conj(Z[M-k])) / 2i
+ *   X[k] = E[k] + W^k O[k]
  * Note: only produces half as many data points as the input had.
  */
-static void fft_output(const float * re, const float * im, float *output)
+static void fft_output(const float * re, const float * im, float *output,
+                       const float *costable, const float *sintable)
 {
-    float *p_output = output;
-    const float *p_real   = re;
-    const float *p_imag   = im;
-    float *p_end    = output + FFT_BUFFER_SIZE / 2;
+    const unsigned int half = FFT_BUFFER_SIZE / 2;
 
-    while(p_output <= p_end)
+    for(unsigned int k = 0; k <= half; k++)
     {
-        *p_output = (*p_real * *p_real) + (*p_imag * *p_imag);
-        p_output++; p_real++; p_imag++;
+        unsigned int k1 = k % half;
+        unsigned int k2 = (half - k) % half;
+        float er = (re[k1] + re[k2]) / 2, ei = (im[k1] - im[k2]) / 2;
+        float odd_r = (im[k1] + im[k2]) / 2, odd_i = (re[k2] - re[k1]) / 2;
+        float wr = (k < half) ? costable[k] : -1.f;
+        float wi = (k < half) ? sintable[k] : 0.f;
+        float xr = er + wr * odd_r - wi * odd_i;
+        float xi = ei + wr * odd_i + wi * odd_r;
+
+        output[k] = xr * xr + xi * xi;
     }
     /* Do divisions to keep the constant and highest frequency terms in scale
      * with the other terms. */
-    *output /= 4;
-    *p_end /= 4;
+    output[0] /= 4;
+    output[half] /= 4;
 }
 
 
 /*
- * Actually perform the FFT
+ * Actually perform the FFT (on FFT_BUFFER_SIZE / 2 complex points)
  */
 static void fft_calculate(float * re, float * im, const float *costable, const float *sintable )
 {
@@ -165,9 +182,9 @@ static void fft_calculate(float * re, float * im, const float *costable, const f
     factfact = FFT_BUFFER_SIZE / 2;
 
     /* Loop through the divide and conquer steps */
-    for(i = FFT_BUFFER_SIZE_LOG; i != 0; i--) {
+    for(i = FFT_BUFFER_SIZE_LOG - 1; i != 0; i--) {
         /* In this step, we have 2 ^ (i - 1) exchange groups, each with
-         * 2 ^ (FFT_BUFFER_SIZE_LOG - i) exchanges
+         * 2 ^ (FFT_BUFFER_SIZE_LOG - 1 - i) exchanges
          */
         /* Loop through the exchanges in a group */
         for(j = 0; j != exchanges; j++) {
@@ -180,7 +197,7 @@ static void fft_calculate(float * re, float * im, const float *costable, const f
             fact_imag = sintable[j * factfact];
 
             /* Loop through all the exchange groups */
-            for(k = j; k < FFT_BUFFER_SIZE; k += exchanges << 1) {
+            for(k = j; k < FFT_BUFFER_SIZE / 2; k += exchanges << 1) {
                 int k1 = k + exchanges;
                 tmp_real = fact_real * re[k1] - fact_imag * im[k1];
                 tmp_imag = fact_real * im[k1] + fact_imag * re[k1];
@@ -198,7 +215,7 @@ static void fft_calculate(float * re, float * im, const float *costable, const f
 static int reverseBits(unsigned int initial)
 {
     unsigned int reversed = 0, loop;
-    for(loop = 0; loop < FFT_BUFFER_SIZE_LOG; loop++) {
+    for(loop = 0; loop < FFT_BUFFER_SIZE_LOG - 1; loop++) {
         reversed <<= 1;
         reversed += (initial & 1);
         initial >>= 1;
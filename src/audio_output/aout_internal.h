@@ -29,12 +29,6 @@
 /* Max input rate factor (1/4 -> 4) */
 # define AOUT_MAX_INPUT_RATE (4)
 
-enum {
-    AOUT_RESAMPLING_NONE=0,
-    AOUT_RESAMPLING_UP,
-    AOUT_RESAMPLING_DOWN
-};
-
 struct aout_request_vout
 {
     struct vout_thread_t  *(*pf_request_vout)( void *, struct vout_thread_t *,
@@ -70,8 +64,8 @@ typedef struct
     struct
     {
         mtime_t end; /**< Last seen PTS */
-        unsigned resamp_start_drift; /**< Resampler drift absolute value */
-        int resamp_type; /**< Resampler mode (FIXME: redundant / resampling) */
+        int resampling; /**< Current resampling (Hz) */
+        float resamp_integral; /**< Integral term of the resampling (Hz) */
         bool discontinuity;
     } sync;
 
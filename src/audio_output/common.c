@@ -364,15 +364,21 @@ do { \
 void aout_Interleave( void *restrict dst, const void *const *srcv,
                       unsigned samples, unsigned chans, vlc_fourcc_t fourcc )
 {
+/* The destination is written sequentially, in a single pass. */
 #define INTERLEAVE_TYPE(type) \
 do { \
     type *d = dst; \
-    for( size_t i = 0; i < chans; i++ ) { \
-        const type *s = srcv[i]; \
-        for( size_t j = 0, k = 0; j < samples; j++, k += chans ) \
-            d[k] = *(s++); \
-        d++; \
+    if( chans == 2 ) { \
+        const type *l = srcv[0], *r = srcv[1]; \
+        for( size_t j = 0; j < samples; j++ ) { \
+            *(d++) = l[j]; \
+            *(d++) = r[j]; \
+        } \
+        break; \
     } \
+    for( size_t j = 0; j < samples; j++ ) \
+        for( size_t i = 0; i < chans; i++ ) \
+            *(d++) = ((const type *)srcv[i])[j]; \
 } while(0)
 
     switch( fourcc )
@@ -29,6 +29,7 @@
 #endif
 
 #include <assert.h>
+#include <math.h>
 
 #include <vlc_common.h>
 #include <vlc_aout.h>
@@ -103,7 +104,8 @@ error:
     }
 
     owner->sync.end = VLC_TS_INVALID;
-    owner->sync.resamp_type = AOUT_RESAMPLING_NONE;
+    owner->sync.resampling = 0;
+    owner->sync.resamp_integral = 0.f;
     owner->sync.discontinuity = true;
     aout_OutputUnlock (p_aout);
 
@@ -157,7 +159,8 @@ static int aout_CheckReady (audio_output_t *aout)
 
         msg_Dbg (aout, "restarting filters...");
         owner->sync.end = VLC_TS_INVALID;
-        owner->sync.resamp_type = AOUT_RESAMPLING_NONE;
+        owner->sync.resampling = 0;
+        owner->sync.resamp_integral = 0.f;
 
         if (owner->mixer_format.i_format)
         {
@@ -192,11 +195,15 @@ void aout_RequestRestart (audio_output_t *aout, unsigned mode)
  * Buffer management
  */
 
+/* Duration over which the resampler absorbs the current drift */
+#define AOUT_RESAMPLING_PERIOD (10 * CLOCK_FREQ)
+
 static void aout_StopResampling (audio_output_t *aout)
 {
     aout_owner_t *owner = aout_owner (aout);
 
-    owner->sync.resamp_type = AOUT_RESAMPLING_NONE;
+    owner->sync.resampling = 0;
+    owner->sync.resamp_integral = 0.f;
     aout_FiltersAdjustResampling (owner->filters, 0);
 }
 
@@ -221,16 +228,15 @@ static void aout_DecSilence (audio_output_t *aout, mtime_t length, mtime_t pts)
 }
 
 static void aout_DecSynchronize (audio_output_t *aout, mtime_t dec_pts,
-                                 int input_rate)
+                                 mtime_t length, int input_rate)
 {
     aout_owner_t *owner = aout_owner (aout);
     mtime_t drift;
 
     /**
      * Depending on the drift between the actual and intended playback times,
-     * the audio core may ignore the drift, trigger upsampling or downsampling,
-     * insert silence or even discard samples.
-     * Future VLC versions may instead adjust the input rate.
+     * the audio core may adjust the resampling ratio, insert silence or even
+     * discard samples.
      *
      * The audio output plugin is responsible for estimating its actual
      * playback time, or rather the estimated time when the next sample will
@@ -288,51 +294,45 @@ static void aout_DecSynchronize (audio_output_t *aout, mtime_t dec_pts,
         drift = 0;
     }
 
-    /* Resampling */
-    if (drift > +AOUT_MAX_PTS_DELAY
-     && owner->sync.resamp_type != AOUT_RESAMPLING_UP)
-    {
-        msg_Warn (aout, "playback too late (%"PRId64"): up-sampling",
-                  drift);
-        owner->sync.resamp_type = AOUT_RESAMPLING_UP;
-        owner->sync.resamp_start_drift = +drift;
-    }
-    if (drift < -AOUT_MAX_PTS_ADVANCE
-     && owner->sync.resamp_type != AOUT_RESAMPLING_DOWN)
-    {
-        msg_Warn (aout, "playback too early (%"PRId64"): down-sampling",
-                  drift);
-        owner->sync.resamp_type = AOUT_RESAMPLING_DOWN;
-        owner->sync.resamp_start_drift = -drift;
-    }
-
-    if (owner->sync.resamp_type == AOUT_RESAMPLING_NONE)
-        return; /* Everything is fine. Nothing to do. */
-
-    if (llabs (drift) > 2 * owner->sync.resamp_start_drift)
-    {   /* If the drift is ever increasing, then something is seriously wrong.
-         * Cease resampling and hope for the best. */
-        msg_Warn (aout, "timing screwed (drift: %"PRId64" us): "
-                  "stopping resampling", drift);
-        aout_StopResampling (aout);
+    /* Resampling
+     * The drift is corrected continuously by a proportional-integral
+     * controller: the proportional term absorbs the current drift over
+     * AOUT_RESAMPLING_PERIOD, while the integral term converges to the
+     * steady clock rate mismatch (e.g. sound card versus system clock, or
+     * residual source clock drift), so that no correction bursts occur. */
+    const float rate = owner->mixer_format.i_rate;
+    const float max = rate * AOUT_MAX_RESAMPLING / 100;
+    float integral = owner->sync.resamp_integral
+        + rate * drift * length / ((float)AOUT_RESAMPLING_PERIOD
+                                          * AOUT_RESAMPLING_PERIOD);
+
+    if (integral > max)
+        integral = max;
+    if (integral < -max)
+        integral = -max;
+    owner->sync.resamp_integral = integral;
+
+    float target = integral + rate * drift / AOUT_RESAMPLING_PERIOD;
+    if (target > max)
+        target = max;
+    if (target < -max)
+        target = -max;
+
+    int resampling = lroundf (target);
+    if (resampling == owner->sync.resampling)
         return;
-    }
 
-    /* Resampling has been triggered earlier. This checks if it needs to be
-     * increased or decreased. Resampling rate changes must be kept slow for
-     * the comfort of listeners. */
-    int adj = (owner->sync.resamp_type == AOUT_RESAMPLING_UP) ? +2 : -2;
-
-    if (2 * llabs (drift) <= owner->sync.resamp_start_drift)
-        /* If the drift has been reduced from more than half its initial
-         * value, then it is time to switch back the resampling direction. */
-        adj *= -1;
-
-    if (!aout_FiltersAdjustResampling (owner->filters, adj))
-    {   /* Everything is back to normal: stop resampling. */
-        owner->sync.resamp_type = AOUT_RESAMPLING_NONE;
+    if (owner->sync.resampling == 0)
+        msg_Dbg (aout, "resampling started (drift: %"PRId64" us)", drift);
+    /* NOTE: adjusting by zero resets the resampling */
+    if (!aout_FiltersAdjustResampling (owner->filters,
+                                       resampling - owner->sync.resampling))
+    {
+        if (resampling != 0)
+            return; /* no resampler */
         msg_Dbg (aout, "resampling stopped (drift: %"PRId64" us)", drift);
     }
+    owner->sync.resampling = resampling;
 }
 
 /*****************************************************************************
@@ -379,7 +379,7 @@ int aout_DecPlay (audio_output_t *aout, block_t *block, int input_rate)
     aout_volume_Amplify (owner->volume, block);
 
     /* Drift correction */
-    aout_DecSynchronize (aout, block->i_pts, input_rate);
+    aout_DecSynchronize (aout, block->i_pts, block->i_length, input_rate);
 
     /* Output */
     owner->sync.end = block->i_pts + block->i_length + 1;
@@ -498,24 +498,11 @@ ssize_t config_GetPszChoices (vlc_object_t *obj, const char *name,
     return count;
 }
 
-static int confcmp (const void *a, const void *b)
-{
-    const module_config_t *const *ca = a, *const *cb = b;
-
-    return strcmp ((*ca)->psz_name, (*cb)->psz_name);
-}
-
-static int confnamecmp (const void *key, const void *elem)
-{
-    const module_config_t *const *conf = elem;
-
-    return strcmp (key, (*conf)->psz_name);
-}
-
+/* Open addressing hash table of the configuration items, by name */
 static struct
 {
     module_config_t **list;
-    size_t count;
+    size_t size; /* power of two */
 } config = { NULL, 0 };
 
 /**
@@ -529,11 +516,15 @@ int config_SortConfig (void)
     for (p = vlc_plugins; p != NULL; p = p->next)
          nconf += p->conf.size;
 
-    module_config_t **clist = malloc (sizeof (*clist) * nconf);
+    /* Keep the table at most half full */
+    size_t size = 16;
+    while (size < 2 * nconf)
+        size *= 2;
+
+    module_config_t **clist = calloc (size, sizeof (*clist));
     if (unlikely(clist == NULL))
         return VLC_ENOMEM;
 
-    nconf = 0;
     for (p = vlc_plugins; p != NULL; p = p->next)
     {
         module_config_t *item, *end;
@@ -544,14 +535,18 @@ int config_SortConfig (void)
         {
             if (!CONFIG_ITEM(item->i_type))
                 continue; /* ignore hints */
-            clist[nconf++] = item;
+
+            size_t i = DictHash (item->psz_name, size);
+            while (clist[i] != NULL
+                && strcmp (clist[i]->psz_name, item->psz_name))
+                i = (i + 1) & (size - 1);
+            if (clist[i] == NULL) /* first item wins for duplicate names */
+                clist[i] = item;
         }
     }
 
-    qsort (clist, nconf, sizeof (*clist), confcmp);
-
     config.list = clist;
-    config.count = nconf;
+    config.size = size;
     return VLC_SUCCESS;
 }
 
@@ -561,7 +556,7 @@ void config_UnsortConfig (void)
 
     clist = config.list;
     config.list = NULL;
-    config.count = 0;
+    config.size = 0;
 
     free (clist);
 }
@@ -578,9 +573,18 @@ module_config_t *config_FindConfig (vlc_object_t *p_this, const char *name)
     if (unlikely(name == NULL))
         return NULL;
 
-    module_config_t *const *p;
-    p = bsearch (name, config.list, config.count, sizeof (*p), confnamecmp);
-    return p ? *p : NULL;
+    if (config.list == NULL)
+        return NULL;
+
+    size_t i = DictHash (name, config.size);
+    module_config_t *item;
+    while ((item = config.list[i]) != NULL && strcmp (item->psz_name, name))
+        i = (i + 1) & (config.size - 1);
+    if (item == NULL)
+        return NULL;
+
+    vlc_cache_load_choices(item->owner);
+    return item;
 }
 
 /**
@@ -174,23 +174,60 @@ int config_LoadConfigFile( vlc_object_t *p_this )
     if (file == NULL)
         return VLC_EGENERIC;
 
-    /* Skip UTF-8 Byte Order Mark if present */
-    char bom[3];
-    if (fread (bom, 1, 3, file) != 3 || memcmp (bom, "\xEF\xBB\xBF", 3))
-        rewind (file); /* no BOM, rewind */
+    /* Read the whole file at once, then parse it in place */
+    char *buf = NULL;
+    size_t buflen = 0, bufsize = 0;
+    struct stat st;
+
+    if (fstat (fileno (file), &st) == 0 && st.st_size > 0
+     && (uintmax_t)st.st_size < SIZE_MAX - 2)
+        bufsize = st.st_size + 2; /* one spare byte to hit end-of-file */
 
-    char *line = NULL;
-    size_t bufsize;
-    ssize_t linelen;
+    for (;;)
+    {
+        if (buflen + 1 >= bufsize)
+        {   /* The file grew, or its size is unknown */
+            bufsize = bufsize ? bufsize * 2 : 65536;
+            char *newbuf = realloc (buf, bufsize);
+            if (unlikely(newbuf == NULL))
+                break;
+            buf = newbuf;
+        }
+
+        size_t val = fread (buf + buflen, 1, bufsize - 1 - buflen, file);
+        buflen += val;
+        if (val == 0 || feof (file) || ferror (file))
+            break;
+    }
+
+    if (buf == NULL)
+    {
+        fclose (file);
+        return VLC_ENOMEM;
+    }
+    buf[buflen] = '\0';
+
+    char *line = buf, *end = buf + buflen;
+
+    /* Skip UTF-8 Byte Order Mark if present */
+    if (buflen >= 3 && !memcmp (buf, "\xEF\xBB\xBF", 3))
+        line += 3;
 
     /* Ensure consistent number formatting... */
     locale_t loc = newlocale (LC_NUMERIC_MASK, "C", NULL);
     locale_t baseloc = uselocale (loc);
 
     vlc_rwlock_wrlock (&config_lock);
-    while ((linelen = getline (&line, &bufsize, file)) != -1)
+    for (char *next; line < end; line = next)
     {
-        line[linelen - 1] = '\0'; /* trim newline */
+        char *eol = memchr (line, '\n', end - line);
+        if (eol != NULL)
+        {
+            *eol = '\0'; /* trim newline */
+            next = eol + 1;
+        }
+        else
+            next = end;
 
         /* Ignore comments, section and empty lines */
         if (memchr ("#[", line[0], 3) != NULL)
@@ -242,7 +279,7 @@ int config_LoadConfigFile( vlc_object_t *p_this )
         }
     }
     vlc_rwlock_unlock (&config_lock);
-    free (line);
+    free (buf);
 
     if (ferror (file))
     {
@@ -401,6 +438,8 @@ int config_SaveConfigFile (vlc_object_t *p_this)
         vlc_mutex_unlock (&lock);
         goto error;
     }
+    /* The whole file is a few hundred kilobytes of small writes */
+    setvbuf (file, NULL, _IOFBF, 1 << 16);
 
     fprintf( file,
         "\xEF\xBB\xBF###\n"
@@ -577,7 +577,7 @@ static void Usage (vlc_object_t *p_this, char const *psz_search)
     const bool advanced = var_InheritBool(p_this, "advanced");
 
     /* Enumerate the config for each module */
-    for (const vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
+    for (vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
     {
         const module_t *m = p->module;
         const module_config_t *section = NULL;
@@ -603,6 +603,7 @@ static void Usage (vlc_object_t *p_this, char const *psz_search)
                    module_gettext(m, m->psz_help));
 
         /* Print module options */
+        vlc_cache_load_choices(p);
         for (size_t j = 0; j < p->conf.size; j++)
         {
             const module_config_t *item = p->conf.items + j;
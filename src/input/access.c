@@ -38,6 +38,7 @@
 #include <libvlc.h>
 #include "stream.h"
 #include "input_internal.h"
+#include "../misc/tracer.h"
 
 /* Decode URL (which has had its scheme stripped earlier) to a file path. */
 char *get_path(const char *location)
@@ -199,6 +200,10 @@ static block_t *AStreamReadBlock(stream_t *s, bool *restrict eof)
 
     block = vlc_stream_ReadBlock(access);
 
+    if (block != NULL)
+        vlc_tracer_Event(VLC_TRACE_ACCESS_READ, input, s, block->i_dts,
+                         block->i_buffer);
+
     if (block != NULL && input != NULL)
     {
         uint64_t total;
@@ -209,6 +214,17 @@ static block_t *AStreamReadBlock(stream_t *s, bool *restrict eof)
         stats_Update(input_priv(input)->counters.p_input_bitrate, total, NULL);
         stats_Update(input_priv(input)->counters.p_read_packets, 1, NULL);
         vlc_mutex_unlock(&input_priv(input)->counters.counters_lock);
+
+        /* The access flags the first block following lost packets */
+        uint64_t lost;
+
+        if ((block->i_flags & BLOCK_FLAG_DISCONTINUITY)
+         && vlc_stream_Control(access, STREAM_GET_LOST_PACKETS, &lost) == 0)
+        {
+            vlc_mutex_lock(&input_priv(input)->counters.counters_lock);
+            stats_Update(input_priv(input)->counters.p_read_lost, lost, NULL);
+            vlc_mutex_unlock(&input_priv(input)->counters.counters_lock);
+        }
     }
 
     return block;
@@ -227,6 +243,10 @@ static ssize_t AStreamReadStream(stream_t *s, void *buf, size_t len)
 
     ssize_t val = vlc_stream_ReadPartial(access, buf, len);
 
+    if (val > 0)
+        vlc_tracer_Event(VLC_TRACE_ACCESS_READ, input, s, VLC_TS_INVALID,
+                         val);
+
     if (val > 0 && input != NULL)
     {
         uint64_t total;
@@ -34,6 +34,7 @@
 #include <vlc_input.h>
 #include "clock.h"
 #include <assert.h>
+#include <math.h>
 
 /* TODO:
  * - clean up locking once clock code is stable
@@ -68,10 +69,13 @@
  * in all the FIFOs, but it may be not enough.
  */
 
-/* i_cr_average : Maximum number of samples used to compute the
- * dynamic average value.
- * We use the following formula :
- * new_average = (old_average * c_average + new_sample_value) / (c_average +1)
+/* The low pass filter is a second order phase-locked loop. It tracks both
+ * the offset between the two clocks (the phase) and its rate of change (the
+ * frequency error), so that converted timestamps follow a slowly drifting
+ * source continuously rather than in steps.
+ *
+ * The loop bandwidth is either set explicitly, or derived from i_cr_average,
+ * the number of drift samples the estimation is averaged over.
  */
 
 
@@ -99,28 +103,32 @@
 /* Due to some problems in es_out, we cannot use a large value yet */
 #define CR_BUFFERING_TARGET (100000)
 
+/* Interval between two drift samples */
+#define CR_DRIFT_PERIOD (CLOCK_FREQ/5)
+
+/* Maximum frequency error between the stream and system clocks (0.5%) */
+#define CR_MAX_FREQ_ERROR (0.005)
+
 /*****************************************************************************
  * Structures
  *****************************************************************************/
 
 /**
- * This structure holds long term average
+ * This structure holds the drift estimation
  */
 typedef struct
 {
-    mtime_t i_value;
-    int     i_residue;
-
-    int     i_count;
-    int     i_divider;
-} average_t;
-static void    AvgInit( average_t *, int i_divider );
-static void    AvgClean( average_t * );
-
-static void    AvgReset( average_t * );
-static void    AvgUpdate( average_t *, mtime_t i_value );
-static mtime_t AvgGet( average_t * );
-static void    AvgRescale( average_t *, int i_divider );
+    double  f_phase;     /* drift at i_stream (stream clock unit) */
+    double  f_freq;      /* drift variation per stream clock unit */
+    mtime_t i_stream;    /* stream date of the last sample */
+    bool    b_locked;
+
+    double  f_bandwidth; /* loop noise bandwidth (Hz) */
+} pll_t;
+static void    PllInit( pll_t *, double f_bandwidth );
+static void    PllReset( pll_t * );
+static void    PllUpdate( pll_t *, mtime_t i_stream, mtime_t i_drift );
+static mtime_t PllGet( const pll_t *, mtime_t i_stream );
 
 /* */
 typedef struct
@@ -156,7 +164,8 @@ struct input_clock_t
 
     /* Clock drift */
     mtime_t i_next_drift_update;
-    average_t drift;
+    pll_t drift;
+    float f_bandwidth; /* configured loop bandwidth, or 0 */
 
     /* Late statistics */
     struct
@@ -188,7 +197,7 @@ static mtime_t ClockGetTsOffset( input_clock_t * );
 /*****************************************************************************
  * input_clock_New: create a new clock
  *****************************************************************************/
-input_clock_t *input_clock_New( int i_rate )
+input_clock_t *input_clock_New( int i_rate, float f_bandwidth )
 {
     input_clock_t *cl = malloc( sizeof(*cl) );
     if( !cl )
@@ -206,7 +215,9 @@ input_clock_t *input_clock_New( int i_rate )
     cl->i_buffering_duration = 0;
 
     cl->i_next_drift_update = VLC_TS_INVALID;
-    AvgInit( &cl->drift, 10 );
+    cl->f_bandwidth = f_bandwidth;
+    PllInit( &cl->drift, f_bandwidth > 0.f ? f_bandwidth
+                                           : CLOCK_FREQ / (4. * 10 * CR_DRIFT_PERIOD) );
 
     cl->late.i_index = 0;
     for( int i = 0; i < INPUT_CLOCK_LATE_COUNT; i++ )
@@ -225,7 +236,6 @@ input_clock_t *input_clock_New( int i_rate )
  *****************************************************************************/
 void input_clock_Delete( input_clock_t *cl )
 {
-    AvgClean( &cl->drift );
     vlc_mutex_destroy( &cl->lock );
     free( cl );
 }
@@ -271,7 +281,7 @@ void input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
     if( b_reset_reference )
     {
         cl->i_next_drift_update = VLC_TS_INVALID;
-        AvgReset( &cl->drift );
+        PllReset( &cl->drift );
 
         /* Feed synchro with a new reference point. */
         cl->b_has_reference = true;
@@ -286,9 +296,9 @@ void input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
     {
         const mtime_t i_converted = ClockSystemToStream( cl, i_ck_system );
 
-        AvgUpdate( &cl->drift, i_converted - i_ck_stream );
+        PllUpdate( &cl->drift, i_ck_stream, i_converted - i_ck_stream );
 
-        cl->i_next_drift_update = i_ck_system + CLOCK_FREQ/5; /* FIXME why that */
+        cl->i_next_drift_update = i_ck_system + CR_DRIFT_PERIOD;
     }
 
     /* Update the extra buffering value */
@@ -314,7 +324,7 @@ void input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
 
     /* It does not take the decoder latency into account but it is not really
      * the goal of the clock here */
-    const mtime_t i_system_expected = ClockStreamToSystem( cl, i_ck_stream + AvgGet( &cl->drift ) );
+    const mtime_t i_system_expected = ClockStreamToSystem( cl, i_ck_stream + PllGet( &cl->drift, i_ck_stream ) );
     const mtime_t i_late = ( i_ck_system - cl->i_pts_delay ) - i_system_expected;
     *pb_late = i_late > 0;
     if( i_late > 0 )
@@ -394,7 +404,7 @@ mtime_t input_clock_GetWakeup( input_clock_t *cl )
 
     /* Synchronized, we can wait */
     if( cl->b_has_reference )
-        i_wakeup = ClockStreamToSystem( cl, cl->last.i_stream + AvgGet( &cl->drift ) - cl->i_buffering_duration );
+        i_wakeup = ClockStreamToSystem( cl, cl->last.i_stream + PllGet( &cl->drift, cl->last.i_stream ) - cl->i_buffering_duration );
 
     vlc_mutex_unlock( &cl->lock );
 
@@ -432,7 +442,7 @@ int input_clock_ConvertTS( vlc_object_t *p_object, input_clock_t *cl,
     /* */
     if( *pi_ts0 > VLC_TS_INVALID )
     {
-        *pi_ts0 = ClockStreamToSystem( cl, *pi_ts0 + AvgGet( &cl->drift ) );
+        *pi_ts0 = ClockStreamToSystem( cl, *pi_ts0 + PllGet( &cl->drift, *pi_ts0 ) );
         if( *pi_ts0 > cl->i_ts_max )
             cl->i_ts_max = *pi_ts0;
         *pi_ts0 += i_ts_delay;
@@ -441,7 +451,7 @@ int input_clock_ConvertTS( vlc_object_t *p_object, input_clock_t *cl,
     /* XXX we do not update i_ts_max on purpose */
     if( pi_ts1 && *pi_ts1 > VLC_TS_INVALID )
     {
-        *pi_ts1 = ClockStreamToSystem( cl, *pi_ts1 + AvgGet( &cl->drift ) ) +
+        *pi_ts1 = ClockStreamToSystem( cl, *pi_ts1 + PllGet( &cl->drift, *pi_ts1 ) ) +
                   i_ts_delay;
     }
 
@@ -570,8 +580,10 @@ void input_clock_SetJitter( input_clock_t *cl,
     if( i_cr_average < 10 )
         i_cr_average = 10;
 
-    if( cl->drift.i_divider != i_cr_average )
-        AvgRescale( &cl->drift, i_cr_average );
+    /* A first order average over N samples has a noise bandwidth of
+     * 1/(4 N T) where T is the sampling period */
+    if( cl->f_bandwidth <= 0.f )
+        cl->drift.f_bandwidth = CLOCK_FREQ / (4. * i_cr_average * CR_DRIFT_PERIOD);
 
     vlc_mutex_unlock( &cl->lock );
 }
@@ -632,44 +644,58 @@ static mtime_t ClockGetTsOffset( input_clock_t *cl )
 }
 
 /*****************************************************************************
- * Long term average helpers
+ * Drift estimation helpers
  *****************************************************************************/
-static void AvgInit( average_t *p_avg, int i_divider )
-{
-    p_avg->i_divider = i_divider;
-    AvgReset( p_avg );
-}
-static void AvgClean( average_t *p_avg )
+static void PllInit( pll_t *p_pll, double f_bandwidth )
 {
-    VLC_UNUSED(p_avg);
+    p_pll->f_bandwidth = f_bandwidth;
+    PllReset( p_pll );
 }
-static void AvgReset( average_t *p_avg )
+static void PllReset( pll_t *p_pll )
 {
-    p_avg->i_value = 0;
-    p_avg->i_residue = 0;
-    p_avg->i_count = 0;
+    p_pll->f_phase = 0.;
+    p_pll->f_freq = 0.;
+    p_pll->i_stream = VLC_TS_INVALID;
+    p_pll->b_locked = false;
 }
-static void AvgUpdate( average_t *p_avg, mtime_t i_value )
+static void PllUpdate( pll_t *p_pll, mtime_t i_stream, mtime_t i_drift )
 {
-    const int i_f0 = __MIN( p_avg->i_divider - 1, p_avg->i_count );
-    const int i_f1 = p_avg->i_divider - i_f0;
-
-    const mtime_t i_tmp = i_f0 * p_avg->i_value + i_f1 * i_value + p_avg->i_residue;
-
-    p_avg->i_value   = i_tmp / p_avg->i_divider;
-    p_avg->i_residue = i_tmp % p_avg->i_divider;
+    if( !p_pll->b_locked )
+    {
+        p_pll->f_phase = i_drift;
+        p_pll->f_freq = 0.;
+        p_pll->i_stream = i_stream;
+        p_pll->b_locked = true;
+        return;
+    }
 
-    p_avg->i_count++;
+    const mtime_t i_dt = i_stream - p_pll->i_stream;
+    if( i_dt <= 0 )
+        return;
+
+    /* Critically damped loop (zeta = 1/sqrt(2)), the natural frequency
+     * follows from the noise bandwidth: Bn = wn/2 (zeta + 1/(4 zeta)) */
+    const double f_zeta = M_SQRT1_2;
+    const double f_wn = 2. * p_pll->f_bandwidth / (f_zeta + 1. / (4. * f_zeta));
+    const double f_wt = f_wn * i_dt / CLOCK_FREQ;
+    const double f_alpha = __MIN( 2. * f_zeta * f_wt, 1. );
+    const double f_beta = __MIN( f_wt * f_wt, f_alpha );
+
+    const double f_predicted = p_pll->f_phase + p_pll->f_freq * i_dt;
+    const double f_error = i_drift - f_predicted;
+
+    p_pll->f_phase = f_predicted + f_alpha * f_error;
+    p_pll->f_freq += f_beta * f_error / i_dt;
+    if( p_pll->f_freq > CR_MAX_FREQ_ERROR )
+        p_pll->f_freq = CR_MAX_FREQ_ERROR;
+    if( p_pll->f_freq < -CR_MAX_FREQ_ERROR )
+        p_pll->f_freq = -CR_MAX_FREQ_ERROR;
+    p_pll->i_stream = i_stream;
 }
-static mtime_t AvgGet( average_t *p_avg )
+static mtime_t PllGet( const pll_t *p_pll, mtime_t i_stream )
 {
-    return p_avg->i_value;
-}
-static void AvgRescale( average_t *p_avg, int i_divider )
-{
-    const mtime_t i_tmp = p_avg->i_value * p_avg->i_divider + p_avg->i_residue;
-
-    p_avg->i_divider = i_divider;
-    p_avg->i_value   = i_tmp / p_avg->i_divider;
-    p_avg->i_residue = i_tmp % p_avg->i_divider;
+    if( !p_pll->b_locked )
+        return 0;
+    return llround( p_pll->f_phase
+                  + p_pll->f_freq * (i_stream - p_pll->i_stream) );
 }
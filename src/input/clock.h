@@ -39,8 +39,11 @@ typedef struct input_clock_t input_clock_t;
 /**
  * This function creates a new input_clock_t.
  * You must use input_clock_Delete to delete it once unused.
+ *
+ * \param f_bandwidth drift estimation loop bandwidth in Hz, or 0 to derive
+ * it from the clock reference average counter (see input_clock_SetJitter)
  */
-input_clock_t *input_clock_New( int i_rate );
+input_clock_t *input_clock_New( int i_rate, float f_bandwidth );
 
 /**
  * This function destroys a input_clock_t created by input_clock_New.
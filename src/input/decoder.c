@@ -53,6 +53,7 @@
 #include "resource.h"
 
 #include "../video_output/vout_control.h"
+#include "../misc/tracer.h"
 
 /*
  * Possibles values set in p_owner->reload atomic
@@ -64,6 +65,19 @@ enum reload
     RELOAD_DECODER_AOUT /* Stop the aout and reload the decoder module */
 };
 
+/* Maximum number of packetized blocks the packetizer thread may queue ahead
+ * of the decoder */
+#define DECODER_PACKETIZER_DEPTH 8
+
+/* Packetizer output format change, applied by the decoder thread when it
+ * reaches p_block */
+struct decoder_fmt_change
+{
+    block_t *p_block;
+    es_format_t fmt;
+    struct decoder_fmt_change *p_next;
+};
+
 struct decoder_owner_sys_t
 {
     input_thread_t  *p_input;
@@ -78,12 +92,36 @@ struct decoder_owner_sys_t
     sout_instance_t         *p_sout;
     sout_packetizer_input_t *p_sout_input;
 
+    mtime_t          i_cpu_time; /* decoder thread only */
+
     vlc_thread_t     thread;
 
     /* Some decoders require already packetized data (ie. not truncated) */
     decoder_t *p_packetizer;
     bool b_packetizer;
 
+    /* Packetizer thread (optional), feeding p_fifo with packetized blocks */
+    struct
+    {
+        bool b_enabled;
+        vlc_thread_t thread;
+        block_fifo_t *p_fifo; /* input blocks, not yet packetized */
+        vlc_cond_t wait; /* room in p_fifo (input pacing) */
+        vlc_cond_t wait_room; /* room in the decoder fifo, under lock */
+        vlc_cond_t wait_flush; /* flush acknowledgement, under lock */
+        atomic_bool flushing;
+        bool b_draining; /* under p_fifo lock */
+        bool b_idle; /* under p_fifo lock */
+        es_format_t fmt; /* last output format (packetizer thread only) */
+
+        /* Under the decoder fifo lock */
+        struct decoder_fmt_change *p_changes;
+        size_t i_stale; /* blocks queued before the last flush */
+
+        /* Decoder thread only */
+        struct decoder_fmt_change *p_change;
+    } pkt;
+
     /* Current format in use by the output */
     es_format_t    fmt;
 
@@ -120,6 +158,9 @@ struct decoder_owner_sys_t
     bool b_first;
     bool b_has_data;
 
+    /* Offline processing: output as soon as decoded */
+    bool b_offline;
+
     /* Flushing */
     bool flushing;
     bool b_draining;
@@ -721,6 +762,21 @@ static void DecoderFixTs( decoder_t *p_dec, mtime_t *pi_ts0, mtime_t *pi_ts1,
     if( !p_clock )
         return;
 
+    if( p_owner->b_offline )
+    {
+        /* Shift the timestamps to now, keeping the length */
+        if( *pi_ts0 > VLC_TS_INVALID )
+        {
+            const mtime_t now = mdate();
+            if( pi_ts1 && *pi_ts1 > VLC_TS_INVALID )
+                *pi_ts1 = now + *pi_ts1 - *pi_ts0;
+            *pi_ts0 = now;
+        }
+        if( pi_rate )
+            *pi_rate = INPUT_RATE_DEFAULT;
+        return;
+    }
+
     const bool b_ephemere = pi_ts1 && *pi_ts0 == *pi_ts1;
     int i_rate;
 
@@ -854,6 +910,18 @@ static void DecoderProcessSout( decoder_t *p_dec, block_t *p_block )
 }
 #endif
 
+static void DecoderFmtChangesDelete( struct decoder_fmt_change *p_change )
+{
+    while( p_change != NULL )
+    {
+        struct decoder_fmt_change *p_next = p_change->p_next;
+
+        es_format_Clean( &p_change->fmt );
+        free( p_change );
+        p_change = p_next;
+    }
+}
+
 static void DecoderGetCc( decoder_t *p_dec, decoder_t *p_dec_cc )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
@@ -904,6 +972,9 @@ static int DecoderPlayVideo( decoder_t *p_dec, picture_t *p_picture,
     vout_thread_t  *p_vout = p_owner->p_vout;
     bool prerolled;
 
+    vlc_tracer_Event( VLC_TRACE_DECODER_OUT, p_owner->p_input, p_dec,
+                      p_picture->date, 0 );
+
     vlc_mutex_lock( &p_owner->lock );
     if( p_owner->i_preroll_end > p_picture->date )
     {
@@ -954,6 +1025,8 @@ static int DecoderPlayVideo( decoder_t *p_dec, picture_t *p_picture,
         p_owner->b_first = false;
         p_picture->b_force = true;
     }
+    if( p_owner->b_offline )
+        p_picture->b_force = true; /* never drop as late */
 
     const bool b_dated = p_picture->date > VLC_TS_INVALID;
     int i_rate = INPUT_RATE_DEFAULT;
@@ -1059,7 +1132,38 @@ static void DecoderProcessVideo( decoder_t *p_dec, block_t *p_block )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
 
-    if( p_owner->p_packetizer )
+    if( p_owner->pkt.b_enabled )
+    {   /* Already packetized by DecoderPacketizerThread() */
+        struct decoder_fmt_change *p_change = p_owner->pkt.p_change;
+
+        p_owner->pkt.p_change = NULL;
+        if( p_change != NULL )
+        {
+            int i_ret = VLC_SUCCESS;
+
+            if( !es_format_IsSimilar( &p_dec->fmt_in, &p_change->fmt ) )
+            {
+                msg_Dbg( p_dec, "restarting module due to input format change");
+
+                /* Drain the decoder module */
+                DecoderDecodeVideo( p_dec, NULL );
+
+                i_ret = ReloadDecoder( p_dec, false, &p_change->fmt,
+                                       RELOAD_DECODER );
+            }
+            DecoderFmtChangesDelete( p_change );
+
+            if( i_ret != VLC_SUCCESS )
+            {
+                if( p_block )
+                    block_Release( p_block );
+                return;
+            }
+        }
+        /* NULL drains the decoder after the packetizer thread is drained */
+        DecoderDecodeVideo( p_dec, p_block );
+    }
+    else if( p_owner->p_packetizer )
     {
         block_t *p_packetized_block;
         block_t **pp_block = p_block ? &p_block : NULL;
@@ -1119,6 +1223,9 @@ static int DecoderPlayAudio( decoder_t *p_dec, block_t *p_audio,
 
     assert( p_audio != NULL );
 
+    vlc_tracer_Event( VLC_TRACE_DECODER_OUT, p_owner->p_input, p_dec,
+                      p_audio->i_pts, p_audio->i_buffer );
+
     vlc_mutex_lock( &p_owner->lock );
     if( p_owner->i_preroll_end > p_audio->i_pts )
     {
@@ -1220,6 +1327,37 @@ static void DecoderUpdateStatAudio( decoder_t *p_dec, unsigned decoded,
     vlc_mutex_unlock( &input_priv(p_input)->counters.counters_lock);
 }
 
+/**
+ * Accounts CPU time used by the decoder thread
+ */
+static void DecoderUpdateStatCpu( decoder_t *p_dec, mtime_t i_cpu )
+{
+    decoder_owner_sys_t *p_owner = p_dec->p_owner;
+    input_thread_t *p_input = p_owner->p_input;
+
+    p_owner->i_cpu_time += i_cpu;
+
+    if( p_input == NULL || !libvlc_stats( p_input ) )
+        return;
+
+    counter_t *p_counter;
+    switch( p_dec->fmt_out.i_cat )
+    {
+        case AUDIO_ES:
+            p_counter = input_priv(p_input)->counters.p_audio_decoder_cpu;
+            break;
+        case VIDEO_ES:
+            p_counter = input_priv(p_input)->counters.p_video_decoder_cpu;
+            break;
+        default:
+            return;
+    }
+
+    vlc_mutex_lock( &input_priv(p_input)->counters.counters_lock );
+    stats_Update( p_counter, i_cpu, NULL );
+    vlc_mutex_unlock( &input_priv(p_input)->counters.counters_lock );
+}
+
 static int DecoderQueueAudio( decoder_t *p_dec, block_t *p_aout_buf )
 {
     unsigned lost = 0;
@@ -1424,9 +1562,16 @@ static void DecoderProcess( decoder_t *p_dec, block_t *p_block )
         if( p_block->i_buffer <= 0 )
             goto error;
 
-        vlc_mutex_lock( &p_owner->lock );
-        DecoderUpdatePreroll( &p_owner->i_preroll_end, p_block );
-        vlc_mutex_unlock( &p_owner->lock );
+        vlc_tracer_Event( VLC_TRACE_DECODER_IN, p_owner->p_input, p_dec,
+                          p_block->i_dts, p_block->i_buffer );
+
+        /* Otherwise done on input blocks by the packetizer thread */
+        if( !p_owner->pkt.b_enabled )
+        {
+            vlc_mutex_lock( &p_owner->lock );
+            DecoderUpdatePreroll( &p_owner->i_preroll_end, p_block );
+            vlc_mutex_unlock( &p_owner->lock );
+        }
     }
 
 #ifdef ENABLE_SOUT
@@ -1461,7 +1606,9 @@ static void DecoderProcessFlush( decoder_t *p_dec )
     if( p_dec->b_error )
         return;
 
-    if( p_packetizer != NULL && p_packetizer->pf_flush != NULL )
+    /* The packetizer thread flushes the packetizer (and the preroll) */
+    if( !p_owner->pkt.b_enabled
+     && p_packetizer != NULL && p_packetizer->pf_flush != NULL )
         p_packetizer->pf_flush( p_packetizer );
 
     if ( p_dec->pf_flush != NULL )
@@ -1497,9 +1644,12 @@ static void DecoderProcessFlush( decoder_t *p_dec )
         }
     }
 
-    vlc_mutex_lock( &p_owner->lock );
-    p_owner->i_preroll_end = INT64_MIN;
-    vlc_mutex_unlock( &p_owner->lock );
+    if( !p_owner->pkt.b_enabled )
+    {
+        vlc_mutex_lock( &p_owner->lock );
+        p_owner->i_preroll_end = INT64_MIN;
+        vlc_mutex_unlock( &p_owner->lock );
+    }
 }
 
 /**
@@ -1524,6 +1674,17 @@ static void *DecoderThread( void *p_data )
              * for the sake of flushing (glitches could otherwise happen). */
             int canc = vlc_savecancel();
 
+            /* With the packetizer thread, only this thread may dequeue */
+            while( p_owner->pkt.i_stale > 0 )
+            {
+                block_t *p_stale = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
+                if( p_stale == NULL )
+                    break;
+                block_Release( p_stale );
+                p_owner->pkt.i_stale--;
+            }
+            p_owner->pkt.i_stale = 0;
+
             vlc_fifo_Unlock( p_owner->p_fifo );
 
             /* Flush the decoder (and the output) */
@@ -1572,6 +1733,14 @@ static void *DecoderThread( void *p_data )
         vlc_testcancel(); /* forced expedited cancellation in case of stop */
 
         block_t *p_block = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
+        if( p_block != NULL && p_owner->pkt.p_changes != NULL
+         && p_owner->pkt.p_changes->p_block == p_block )
+        {   /* The packetizer output format changed at this block */
+            DecoderFmtChangesDelete( p_owner->pkt.p_change );
+            p_owner->pkt.p_change = p_owner->pkt.p_changes;
+            p_owner->pkt.p_changes = p_owner->pkt.p_change->p_next;
+            p_owner->pkt.p_change->p_next = NULL;
+        }
         if( p_block == NULL )
         {
             if( likely(!p_owner->b_draining) )
@@ -1589,7 +1758,9 @@ static void *DecoderThread( void *p_data )
         vlc_fifo_Unlock( p_owner->p_fifo );
 
         int canc = vlc_savecancel();
+        mtime_t i_cpu = vlc_thread_cputime();
         DecoderProcess( p_dec, p_block );
+        DecoderUpdateStatCpu( p_dec, vlc_thread_cputime() - i_cpu );
 
         if( p_block == NULL )
         {   /* Draining: the decoder is drained and all decoded buffers are
@@ -1606,12 +1777,150 @@ static void *DecoderThread( void *p_data )
         vlc_mutex_lock( &p_owner->lock );
         vlc_fifo_Lock( p_owner->p_fifo );
         vlc_cond_signal( &p_owner->wait_acknowledge );
+        if( p_owner->pkt.b_enabled )
+            vlc_cond_signal( &p_owner->pkt.wait_room );
         vlc_mutex_unlock( &p_owner->lock );
     }
     vlc_cleanup_pop();
     vlc_assert_unreachable();
 }
 
+/**
+ * Packetizes input blocks and hands them over to the decoder thread
+ */
+static void DecoderPacketizerProcess( decoder_t *p_dec, block_t *p_block )
+{
+    decoder_owner_sys_t *p_owner = p_dec->p_owner;
+    decoder_t *p_packetizer = p_owner->p_packetizer;
+    block_t **pp_block = p_block ? &p_block : NULL;
+    block_t *p_packetized_block;
+
+    if( p_block )
+    {
+        if( p_block->i_buffer <= 0 )
+        {
+            block_Release( p_block );
+            return;
+        }
+
+        vlc_mutex_lock( &p_owner->lock );
+        DecoderUpdatePreroll( &p_owner->i_preroll_end, p_block );
+        vlc_mutex_unlock( &p_owner->lock );
+    }
+
+    while( (p_packetized_block =
+            p_packetizer->pf_packetize( p_packetizer, pp_block ) ) )
+    {
+        if( !es_format_IsSimilar( &p_owner->pkt.fmt, &p_packetizer->fmt_out ) )
+        {
+            struct decoder_fmt_change *p_change = malloc( sizeof(*p_change) );
+            if( likely(p_change != NULL) )
+            {
+                p_change->p_block = p_packetized_block;
+                p_change->p_next = NULL;
+                es_format_Copy( &p_change->fmt, &p_packetizer->fmt_out );
+                es_format_Clean( &p_owner->pkt.fmt );
+                es_format_Copy( &p_owner->pkt.fmt, &p_packetizer->fmt_out );
+
+                vlc_fifo_Lock( p_owner->p_fifo );
+                struct decoder_fmt_change **pp = &p_owner->pkt.p_changes;
+                while( *pp != NULL )
+                    pp = &(*pp)->p_next;
+                *pp = p_change;
+                vlc_fifo_Unlock( p_owner->p_fifo );
+            }
+        }
+
+        if( p_packetizer->pf_get_cc )
+            DecoderGetCc( p_dec, p_packetizer );
+
+        /* Lock-free unless the decoder thread sleeps */
+        block_FifoPut( p_owner->p_fifo, p_packetized_block );
+    }
+
+    if( !pp_block )
+    {   /* Now drain the decoder */
+        vlc_fifo_Lock( p_owner->p_fifo );
+        p_owner->b_draining = true;
+        vlc_fifo_Signal( p_owner->p_fifo );
+        vlc_fifo_Unlock( p_owner->p_fifo );
+    }
+}
+
+/**
+ * The packetizer main loop, when packetizing runs apart from decoding
+ *
+ * \param p_dec the decoder
+ */
+static void *DecoderPacketizerThread( void *p_data )
+{
+    decoder_t *p_dec = (decoder_t *)p_data;
+    decoder_owner_sys_t *p_owner = p_dec->p_owner;
+    block_fifo_t *p_fifo = p_owner->pkt.p_fifo;
+
+    for( ;; )
+    {
+        /* Do not run too far ahead of the decoder */
+        vlc_mutex_lock( &p_owner->lock );
+        mutex_cleanup_push( &p_owner->lock );
+        while( block_FifoCount( p_owner->p_fifo ) >= DECODER_PACKETIZER_DEPTH
+            && !atomic_load( &p_owner->pkt.flushing ) )
+            vlc_cond_wait( &p_owner->pkt.wait_room, &p_owner->lock );
+        vlc_cleanup_pop();
+
+        /* Lock the input fifo before acknowledging, so that
+         * input_DecoderWait() sees the idle state */
+        vlc_fifo_Lock( p_fifo );
+        vlc_cond_signal( &p_owner->wait_acknowledge );
+        vlc_mutex_unlock( &p_owner->lock );
+
+        block_t *p_block = NULL;
+        bool b_drain = false;
+
+        vlc_fifo_CleanupPush( p_fifo );
+        while( !atomic_load( &p_owner->pkt.flushing ) )
+        {
+            p_block = vlc_fifo_DequeueUnlocked( p_fifo );
+            if( p_block != NULL )
+                break;
+            if( p_owner->pkt.b_draining )
+            {
+                p_owner->pkt.b_draining = false;
+                b_drain = true;
+                break;
+            }
+            p_owner->pkt.b_idle = true;
+            vlc_fifo_Wait( p_fifo );
+            p_owner->pkt.b_idle = false;
+        }
+        vlc_cond_signal( &p_owner->pkt.wait );
+        vlc_cleanup_pop();
+        vlc_fifo_Unlock( p_fifo );
+
+        int canc = vlc_savecancel();
+        if( p_block != NULL || b_drain )
+            DecoderPacketizerProcess( p_dec, p_block );
+        else
+        {   /* Flush request: the decoder thread discards what was already
+             * queued, and restarts from a known output format */
+            decoder_t *p_packetizer = p_owner->p_packetizer;
+
+            if( p_packetizer->pf_flush != NULL )
+                p_packetizer->pf_flush( p_packetizer );
+            es_format_Clean( &p_owner->pkt.fmt );
+            es_format_Init( &p_owner->pkt.fmt, UNKNOWN_ES, 0 );
+
+            vlc_mutex_lock( &p_owner->lock );
+            p_owner->i_preroll_end = INT64_MIN;
+            atomic_store( &p_owner->pkt.flushing, false );
+            vlc_cond_signal( &p_owner->pkt.wait_flush );
+            vlc_mutex_unlock( &p_owner->lock );
+        }
+        vlc_restorecancel( canc );
+    }
+    vlc_assert_unreachable();
+}
+
 /**
  * Create a decoder object
  *
@@ -1651,7 +1960,13 @@ static decoder_t * CreateDecoder( vlc_object_t *p_parent,
     p_owner->i_spu_order = 0;
     p_owner->p_sout = p_sout;
     p_owner->p_sout_input = NULL;
+    /* the stream output keeps the original timestamps */
+    p_owner->b_offline = p_input != NULL && p_sout == NULL &&
+                         input_priv(p_input)->b_offline;
+    p_owner->i_cpu_time = 0;
     p_owner->p_packetizer = NULL;
+    p_owner->pkt.b_enabled = false;
+    p_owner->pkt.p_fifo = NULL;
 
     p_owner->b_fmt_description = false;
     p_owner->p_description = NULL;
@@ -1758,6 +2073,39 @@ static decoder_t * CreateDecoder( vlc_object_t *p_parent,
         p_owner->cc.pp_decoder[i] = NULL;
     }
     p_owner->i_ts_delay = 0;
+
+    /* Run the video packetizer in its own thread if requested. The decoder
+     * fifo then has a single producer and a single consumer. */
+    if( p_owner->p_packetizer != NULL && p_dec->fmt_out.i_cat == VIDEO_ES
+     && var_InheritBool( p_dec, "packetizer-thread" ) )
+    {
+        block_fifo_t *p_fifo = block_FifoNewSPSC();
+        p_owner->pkt.p_fifo = block_FifoNew();
+        if( likely(p_fifo != NULL && p_owner->pkt.p_fifo != NULL) )
+        {
+            block_FifoRelease( p_owner->p_fifo );
+            p_owner->p_fifo = p_fifo;
+            p_owner->pkt.b_enabled = true;
+            vlc_cond_init( &p_owner->pkt.wait );
+            vlc_cond_init( &p_owner->pkt.wait_room );
+            vlc_cond_init( &p_owner->pkt.wait_flush );
+            atomic_init( &p_owner->pkt.flushing, false );
+            p_owner->pkt.b_draining = false;
+            p_owner->pkt.b_idle = false;
+            es_format_Init( &p_owner->pkt.fmt, UNKNOWN_ES, 0 );
+            p_owner->pkt.p_changes = NULL;
+            p_owner->pkt.i_stale = 0;
+            p_owner->pkt.p_change = NULL;
+        }
+        else
+        {
+            if( p_fifo != NULL )
+                block_FifoRelease( p_fifo );
+            if( p_owner->pkt.p_fifo != NULL )
+                block_FifoRelease( p_owner->pkt.p_fifo );
+            p_owner->pkt.p_fifo = NULL;
+        }
+    }
     return p_dec;
 }
 
@@ -1771,9 +2119,10 @@ static void DeleteDecoder( decoder_t * p_dec )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
 
-    msg_Dbg( p_dec, "killing decoder fourcc `%4.4s', %u PES in FIFO",
-             (char*)&p_dec->fmt_in.i_codec,
-             (unsigned)block_FifoCount( p_owner->p_fifo ) );
+    msg_Dbg( p_dec, "killing decoder fourcc `%4.4s', %u PES in FIFO, "
+             "%"PRId64" ms of CPU time", (char*)&p_dec->fmt_in.i_codec,
+             (unsigned)block_FifoCount( p_owner->p_fifo ),
+             p_owner->i_cpu_time / 1000 );
 
     const bool b_flush_spu = p_dec->fmt_out.i_cat == SPU_ES;
     UnloadDecoder( p_dec );
@@ -1826,6 +2175,17 @@ static void DeleteDecoder( decoder_t * p_dec )
     if( p_owner->p_description )
         vlc_meta_Delete( p_owner->p_description );
 
+    if( p_owner->pkt.b_enabled )
+    {
+        block_FifoRelease( p_owner->pkt.p_fifo );
+        DecoderFmtChangesDelete( p_owner->pkt.p_changes );
+        DecoderFmtChangesDelete( p_owner->pkt.p_change );
+        es_format_Clean( &p_owner->pkt.fmt );
+        vlc_cond_destroy( &p_owner->pkt.wait_flush );
+        vlc_cond_destroy( &p_owner->pkt.wait_room );
+        vlc_cond_destroy( &p_owner->pkt.wait );
+    }
+
     if( p_owner->p_packetizer )
     {
         UnloadDecoder( p_owner->p_packetizer );
@@ -1897,10 +2257,25 @@ static decoder_t *decoder_New( vlc_object_t *p_parent, input_thread_t *p_input,
     else
         i_priority = VLC_THREAD_PRIORITY_VIDEO;
 
+    /* Spawn the packetizer thread, if any */
+    if( p_dec->p_owner->pkt.b_enabled
+     && vlc_clone( &p_dec->p_owner->pkt.thread, DecoderPacketizerThread,
+                   p_dec, i_priority ) )
+    {
+        msg_Err( p_dec, "cannot spawn packetizer thread" );
+        DeleteDecoder( p_dec );
+        return NULL;
+    }
+
     /* Spawn the decoder thread */
     if( vlc_clone( &p_dec->p_owner->thread, DecoderThread, p_dec, i_priority ) )
     {
         msg_Err( p_dec, "cannot spawn decoder thread" );
+        if( p_dec->p_owner->pkt.b_enabled )
+        {
+            vlc_cancel( p_dec->p_owner->pkt.thread );
+            vlc_join( p_dec->p_owner->pkt.thread, NULL );
+        }
         DeleteDecoder( p_dec );
         return NULL;
     }
@@ -1945,6 +2320,13 @@ void input_DecoderDelete( decoder_t *p_dec )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
 
+    /* Stop feeding the decoder first */
+    if( p_owner->pkt.b_enabled )
+    {
+        vlc_cancel( p_owner->pkt.thread );
+        vlc_join( p_owner->pkt.thread, NULL );
+    }
+
     vlc_cancel( p_owner->thread );
 
     vlc_fifo_Lock( p_owner->p_fifo );
@@ -1992,18 +2374,26 @@ void input_DecoderDelete( decoder_t *p_dec )
 void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
+    block_fifo_t *p_fifo = p_owner->p_fifo;
+    vlc_cond_t *p_wait = &p_owner->wait_fifo;
 
-    vlc_fifo_Lock( p_owner->p_fifo );
+    if( p_owner->pkt.b_enabled )
+    {   /* Feed the packetizer thread instead */
+        p_fifo = p_owner->pkt.p_fifo;
+        p_wait = &p_owner->pkt.wait;
+    }
+
+    vlc_fifo_Lock( p_fifo );
     if( !b_do_pace )
     {
         /* FIXME: ideally we would check the time amount of data
          * in the FIFO instead of its size. */
         /* 400 MiB, i.e. ~ 50mb/s for 60s */
-        if( vlc_fifo_GetBytes( p_owner->p_fifo ) > 400*1024*1024 )
+        if( vlc_fifo_GetBytes( p_fifo ) > 400*1024*1024 )
         {
             msg_Warn( p_dec, "decoder/packetizer fifo full (data not "
                       "consumed quickly enough), resetting fifo!" );
-            block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+            block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_fifo ) );
         }
     }
     else
@@ -2011,12 +2401,27 @@ void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
     {   /* The FIFO is not consumed when waiting, so pacing would deadlock VLC.
          * Locking is not necessary as b_waiting is only read, not written by
          * the decoder thread. */
-        while( vlc_fifo_GetCount( p_owner->p_fifo ) >= 10 )
-            vlc_fifo_WaitCond( p_owner->p_fifo, &p_owner->wait_fifo );
+        while( vlc_fifo_GetCount( p_fifo ) >= 10 )
+            vlc_fifo_WaitCond( p_fifo, p_wait );
     }
 
-    vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_block );
-    vlc_fifo_Unlock( p_owner->p_fifo );
+    vlc_fifo_QueueUnlocked( p_fifo, p_block );
+    vlc_fifo_Unlock( p_fifo );
+}
+
+static bool DecoderPacketizerIsEmpty( decoder_t *p_dec )
+{
+    decoder_owner_sys_t *p_owner = p_dec->p_owner;
+    bool b_empty = true;
+
+    if( p_owner->pkt.b_enabled )
+    {
+        vlc_fifo_Lock( p_owner->pkt.p_fifo );
+        b_empty = p_owner->pkt.b_idle
+               && vlc_fifo_IsEmpty( p_owner->pkt.p_fifo );
+        vlc_fifo_Unlock( p_owner->pkt.p_fifo );
+    }
+    return b_empty;
 }
 
 bool input_DecoderIsEmpty( decoder_t * p_dec )
@@ -2025,6 +2430,10 @@ bool input_DecoderIsEmpty( decoder_t * p_dec )
 
     assert( !p_owner->b_waiting );
 
+    /* Check the packetizer thread first: it hands blocks over before idling */
+    if( !DecoderPacketizerIsEmpty( p_dec ) )
+        return false;
+
     if( block_FifoCount( p_dec->p_owner->p_fifo ) > 0 )
         return false;
 
@@ -2059,6 +2468,15 @@ void input_DecoderDrain( decoder_t *p_dec )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
 
+    if( p_owner->pkt.b_enabled )
+    {   /* The packetizer thread will forward the request to the decoder */
+        vlc_fifo_Lock( p_owner->pkt.p_fifo );
+        p_owner->pkt.b_draining = true;
+        vlc_fifo_Signal( p_owner->pkt.p_fifo );
+        vlc_fifo_Unlock( p_owner->pkt.p_fifo );
+        return;
+    }
+
     vlc_fifo_Lock( p_owner->p_fifo );
     p_owner->b_draining = true;
     vlc_fifo_Signal( p_owner->p_fifo );
@@ -2073,10 +2491,34 @@ void input_DecoderFlush( decoder_t *p_dec )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
 
+    if( p_owner->pkt.b_enabled )
+    {
+        vlc_fifo_Lock( p_owner->pkt.p_fifo );
+        block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->pkt.p_fifo ) );
+        atomic_store( &p_owner->pkt.flushing, true );
+        vlc_fifo_Signal( p_owner->pkt.p_fifo );
+        vlc_fifo_Unlock( p_owner->pkt.p_fifo );
+
+        /* Wait for the packetizer to be flushed, so that it does not queue
+         * anything stale past this point (this is bounded by one block). */
+        vlc_mutex_lock( &p_owner->lock );
+        vlc_cond_signal( &p_owner->pkt.wait_room );
+        while( atomic_load( &p_owner->pkt.flushing ) )
+            vlc_cond_wait( &p_owner->pkt.wait_flush, &p_owner->lock );
+        vlc_mutex_unlock( &p_owner->lock );
+    }
+
     vlc_fifo_Lock( p_owner->p_fifo );
 
     /* Empty the fifo */
-    block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
+    if( p_owner->pkt.b_enabled )
+    {   /* Only the decoder thread may dequeue from this one */
+        p_owner->pkt.i_stale = vlc_fifo_GetCount( p_owner->p_fifo );
+        DecoderFmtChangesDelete( p_owner->pkt.p_changes );
+        p_owner->pkt.p_changes = NULL;
+    }
+    else
+        block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
 
     /* Don't need to wait for the DecoderThread to flush. Indeed, if called a
      * second time, this function will clear the FIFO again before anything was
@@ -2242,7 +2684,8 @@ void input_DecoderWait( decoder_t *p_dec )
         if( p_owner->paused )
             break;
         vlc_fifo_Lock( p_owner->p_fifo );
-        if( p_owner->b_idle && vlc_fifo_IsEmpty( p_owner->p_fifo ) )
+        if( p_owner->b_idle && vlc_fifo_IsEmpty( p_owner->p_fifo )
+         && DecoderPacketizerIsEmpty( p_dec ) )
         {
             msg_Err( p_dec, "buffer deadlock prevented" );
             vlc_fifo_Unlock( p_owner->p_fifo );
@@ -2306,8 +2749,11 @@ bool input_DecoderHasFormatChanged( decoder_t *p_dec, es_format_t *p_fmt, vlc_me
 size_t input_DecoderGetFifoSize( decoder_t *p_dec )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
+    size_t i_size = block_FifoSize( p_owner->p_fifo );
 
-    return block_FifoSize( p_owner->p_fifo );
+    if( p_owner->pkt.b_enabled )
+        i_size += block_FifoSize( p_owner->pkt.p_fifo );
+    return i_size;
 }
 
 void input_DecoderGetObjects( decoder_t *p_dec,
@@ -160,6 +160,86 @@ typedef struct demux_priv_t
     void (*destroy)(demux_t *);
 } demux_priv_t;
 
+/* Winning demuxers of recent probes, keyed by the probed content, so that
+ * the likely demuxer is tried first rather than every one in score order */
+#define DEMUX_PROBE_SIG_SIZE  64
+#define DEMUX_PROBE_CACHE_SIZE 16
+
+struct demux_probe_entry
+{
+    uint8_t sig[DEMUX_PROBE_SIG_SIZE];
+    size_t  sig_len;
+    char    ext[8];
+    char    mime[48];
+    char    module[32];
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    struct demux_probe_entry entries[DEMUX_PROBE_CACHE_SIZE];
+    unsigned next; /* entry replaced by the next insertion */
+} demux_probe_cache = { .lock = VLC_STATIC_MUTEX };
+
+static void demux_ProbeKey( demux_t *p_demux, struct demux_probe_entry *key )
+{
+    const uint8_t *p_peek;
+    ssize_t i_peek = vlc_stream_Peek( p_demux->s, &p_peek,
+                                      DEMUX_PROBE_SIG_SIZE );
+
+    memset( key, 0, sizeof( *key ) );
+    if( i_peek > 0 )
+    {
+        memcpy( key->sig, p_peek, i_peek );
+        key->sig_len = i_peek;
+    }
+
+    const char *psz_ext = p_demux->psz_file ?
+                          strrchr( p_demux->psz_file, '.' ) : NULL;
+    if( psz_ext != NULL && strlen( psz_ext + 1 ) < sizeof( key->ext ) )
+        strcpy( key->ext, psz_ext + 1 );
+
+    char *type = stream_ContentType( p_demux->s );
+    if( type != NULL )
+    {
+        strlcpy( key->mime, type, sizeof( key->mime ) );
+        free( type );
+    }
+}
+
+static struct demux_probe_entry *demux_ProbeFind( const struct demux_probe_entry *key )
+{
+    for( unsigned i = 0; i < DEMUX_PROBE_CACHE_SIZE; i++ )
+    {
+        struct demux_probe_entry *e = &demux_probe_cache.entries[i];
+
+        if( e->module[0] != '\0' && e->sig_len == key->sig_len
+         && !memcmp( e->sig, key->sig, key->sig_len )
+         && !strcasecmp( e->ext, key->ext ) && !strcmp( e->mime, key->mime ) )
+            return e;
+    }
+    return NULL;
+}
+
+static void demux_ProbeStore( struct demux_probe_entry *key,
+                              const char *psz_module )
+{
+    if( strlen( psz_module ) >= sizeof( key->module ) )
+        return;
+
+    vlc_mutex_lock( &demux_probe_cache.lock );
+    struct demux_probe_entry *e = demux_ProbeFind( key );
+    if( e == NULL )
+    {
+        e = &demux_probe_cache.entries[demux_probe_cache.next];
+        demux_probe_cache.next = (demux_probe_cache.next + 1)
+                               % DEMUX_PROBE_CACHE_SIZE;
+    }
+    strcpy( key->module, psz_module );
+    *e = *key;
+    vlc_mutex_unlock( &demux_probe_cache.lock );
+}
+
 static void demux_DestroyDemux(demux_t *demux)
 {
     assert(demux->s != NULL);
@@ -255,9 +335,39 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_parent_input,
           ;
         SkipAPETag( p_demux );
 
-        p_demux->p_module =
-            module_need( p_demux, "demux", psz_module,
-                         !strcmp( psz_module, p_demux->psz_demux ) );
+        /* Fetch the probe window once for all the candidate demuxers */
+        int64_t i_probe = var_InheritInteger( p_demux, "demux-probe-size" );
+        if( i_probe > 0 )
+            stream_ProbeStart( p_demux->s, i_probe );
+
+        if( !strcmp( psz_module, "any" ) )
+        {
+            /* Try the previous winner for the same content first, then
+             * fall back to all the modules */
+            struct demux_probe_entry key;
+            char psz_cached[sizeof( key.module ) + sizeof( ",any" )];
+
+            demux_ProbeKey( p_demux, &key );
+
+            vlc_mutex_lock( &demux_probe_cache.lock );
+            const struct demux_probe_entry *e = demux_ProbeFind( &key );
+            if( e != NULL )
+                snprintf( psz_cached, sizeof( psz_cached ), "%s,any",
+                          e->module );
+            vlc_mutex_unlock( &demux_probe_cache.lock );
+
+            p_demux->p_module =
+                module_need( p_demux, "demux", e != NULL ? psz_cached : "any",
+                             false );
+            if( p_demux->p_module != NULL )
+                demux_ProbeStore( &key, module_get_object( p_demux->p_module ) );
+        }
+        else
+            p_demux->p_module =
+                module_need( p_demux, "demux", psz_module,
+                             !strcmp( psz_module, p_demux->psz_demux ) );
+
+        stream_ProbeStop( p_demux->s );
     }
     else
     {
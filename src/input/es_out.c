@@ -49,6 +49,7 @@
 #include "item.h"
 
 #include "../stream_output/stream_output.h"
+#include "../misc/tracer.h"
 
 #include <vlc_iso_lang.h>
 /* FIXME we should find a better way than including that */
@@ -101,6 +102,11 @@ struct es_out_id_t
 
     /* ID for the meta data */
     int         i_meta_id;
+
+    /* Data cached while the program is not selected */
+    block_t     *p_standby;
+    block_t     **pp_standby_last;
+    size_t      i_standby_size;
 };
 
 typedef struct
@@ -160,6 +166,9 @@ struct es_out_sys_t
     /* Current preroll */
     mtime_t     i_preroll_end;
 
+    /* Duration of data cached for the unselected programs, or 0 */
+    mtime_t     i_standby;
+
     /* Used for buffering */
     bool        b_buffering;
     mtime_t     i_buffering_extra_initial;
@@ -202,6 +211,8 @@ static char **LanguageSplit( const char *psz_langs );
 static int LanguageArrayIndex( char **ppsz_langs, const char *psz_lang );
 
 static char *EsOutProgramGetMetaName( es_out_pgrm_t *p_pgrm );
+static void EsStandbyClean( es_out_id_t *es );
+static void EsStandbyAppend( es_out_sys_t *p_sys, es_out_id_t *es, block_t * );
 static char *EsInfoCategoryName( es_out_id_t* es );
 
 static const vlc_fourcc_t EsOutFourccClosedCaptions[4] = {
@@ -334,6 +345,8 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, int i_rate )
     p_sys->i_preroll_end = -1;
     p_sys->i_prev_stream_level = -1;
 
+    p_sys->i_standby = var_InheritInteger( p_input, "program-standby" ) * 1000;
+
     return out;
 }
 
@@ -613,6 +626,9 @@ static void EsOutChangePosition( es_out_t *out )
         }
     }
 
+    for( int i = 0; i < p_sys->i_es; i++ )
+        EsStandbyClean( p_sys->es[i] );
+
     for( int i = 0; i < p_sys->i_pgrm; i++ )
         input_clock_Reset( p_sys->pgrm[i]->p_clock );
 
@@ -1082,7 +1098,8 @@ static es_out_pgrm_t *EsOutProgramAdd( es_out_t *out, int i_group )
     p_pgrm->b_selected = false;
     p_pgrm->b_scrambled = false;
     p_pgrm->p_meta = NULL;
-    p_pgrm->p_clock = input_clock_New( p_sys->i_rate );
+    p_pgrm->p_clock = input_clock_New( p_sys->i_rate,
+                          var_InheritFloat( p_sys->p_input, "clock-bandwidth" ) );
     if( !p_pgrm->p_clock )
     {
         free( p_pgrm );
@@ -1579,6 +1596,9 @@ static es_out_id_t *EsOutAddSlave( es_out_t *out, const es_format_t *fmt, es_out
     for( i = 0; i < 4; i++ )
         es->pb_cc_present[i] = false;
     es->p_master = p_master;
+    es->p_standby = NULL;
+    es->pp_standby_last = &es->p_standby;
+    es->i_standby_size = 0;
 
     TAB_APPEND( out->p_sys->i_es, out->p_sys->es, es );
     p_sys->i_id++;  /* always incremented */
@@ -1665,6 +1685,82 @@ static void EsDestroyDecoder( es_out_t *out, es_out_id_t *p_es )
     }
 }
 
+/* Standby caching
+ *
+ * While a program is not selected, the last standby period of its audio
+ * and video data is kept, starting from the most recent random access
+ * point when the demuxer flags them. When the program gets selected, the
+ * cache is sent as preroll to the new decoders, so that they need not wait
+ * for the next key frame to output anything. */
+static void EsStandbyClean( es_out_id_t *es )
+{
+    block_ChainRelease( es->p_standby );
+    es->p_standby = NULL;
+    es->pp_standby_last = &es->p_standby;
+    es->i_standby_size = 0;
+}
+
+/* Upper bound of the standby cache of one ES, whatever its duration */
+#define ES_OUT_STANDBY_MAX_SIZE (16 << 20)
+
+static mtime_t EsStandbyDate( const block_t *p_block )
+{
+    return p_block->i_dts > VLC_TS_INVALID ? p_block->i_dts : p_block->i_pts;
+}
+
+static void EsStandbyAppend( es_out_sys_t *p_sys, es_out_id_t *es,
+                             block_t *p_block )
+{
+    if( (p_block->i_flags & (BLOCK_FLAG_TYPE_I|BLOCK_FLAG_DISCONTINUITY))
+     || es->i_standby_size + p_block->i_buffer > ES_OUT_STANDBY_MAX_SIZE )
+        EsStandbyClean( es );
+
+    block_ChainLastAppend( &es->pp_standby_last, p_block );
+    es->i_standby_size += p_block->i_buffer;
+
+    const mtime_t i_date = EsStandbyDate( p_block );
+    if( i_date <= VLC_TS_INVALID )
+        return;
+
+    /* Drop what is older than the standby duration */
+    while( es->p_standby->p_next != NULL )
+    {
+        const mtime_t i_first = EsStandbyDate( es->p_standby );
+        if( i_first > VLC_TS_INVALID && i_date - i_first <= p_sys->i_standby )
+            break;
+
+        block_t *p_old = es->p_standby;
+        es->p_standby = p_old->p_next;
+        es->i_standby_size -= p_old->i_buffer;
+        block_Release( p_old );
+    }
+}
+
+static void EsStandbyFlush( es_out_t *out, es_out_id_t *es )
+{
+    input_thread_t *p_input = out->p_sys->p_input;
+    block_t *p_block = es->p_standby;
+
+    if( p_block == NULL )
+        return;
+
+    msg_Dbg( p_input, "prerolling ES 0x%x from standby cache", es->i_id );
+    es->p_standby = NULL;
+    es->pp_standby_last = &es->p_standby;
+    es->i_standby_size = 0;
+
+    while( p_block != NULL )
+    {
+        block_t *p_next = p_block->p_next;
+
+        p_block->p_next = NULL;
+        p_block->i_flags |= BLOCK_FLAG_PREROLL;
+        input_DecoderDecode( es->p_dec, p_block,
+                             input_priv(p_input)->b_out_pace_control );
+        p_block = p_next;
+    }
+}
+
 static void EsSelect( es_out_t *out, es_out_id_t *es )
 {
     es_out_sys_t   *p_sys = out->p_sys;
@@ -1719,7 +1815,10 @@ static void EsSelect( es_out_t *out, es_out_id_t *es )
 
         EsCreateDecoder( out, es );
 
-        if( es->p_dec == NULL || es->p_pgrm != p_sys->p_pgrm )
+        if( es->p_dec == NULL )
+            return;
+        EsStandbyFlush( out, es );
+        if( es->p_pgrm != p_sys->p_pgrm )
             return;
     }
 
@@ -1933,6 +2032,9 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
     es_out_sys_t   *p_sys = out->p_sys;
     input_thread_t *p_input = p_sys->p_input;
 
+    vlc_tracer_Event( VLC_TRACE_DEMUX_SEND, p_input, es, p_block->i_dts,
+                      p_block->i_buffer );
+
     if( libvlc_stats( p_input ) )
     {
         uint64_t i_total;
@@ -1970,7 +2072,11 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
 
     if( !es->p_dec )
     {
-        block_Release( p_block );
+        if( p_sys->i_standby > 0 && es->p_pgrm != p_sys->p_pgrm &&
+            !es->p_master && es->fmt.i_cat != SPU_ES )
+            EsStandbyAppend( p_sys, es, p_block );
+        else
+            block_Release( p_block );
         vlc_mutex_unlock( &p_sys->lock );
         return VLC_SUCCESS;
     }
@@ -2114,6 +2220,7 @@ static void EsOutDel( es_out_t *out, es_out_id_t *es )
         }
     }
 
+    EsStandbyClean( es );
     free( es->psz_language );
     free( es->psz_language_code );
 
@@ -2365,8 +2472,7 @@ static int EsOutControlLocked( es_out_t *out, int i_query, va_list args )
         }
         else if( p_pgrm == p_sys->p_pgrm )
         {
-            if( b_late && ( !input_priv(p_sys->p_input)->p_sout ||
-                            !input_priv(p_sys->p_input)->b_out_pace_control ) )
+            if( b_late && !input_priv(p_sys->p_input)->b_out_pace_control )
             {
                 const mtime_t i_pts_delay_base = p_sys->i_pts_delay - p_sys->i_pts_jitter;
                 mtime_t i_pts_delay = input_clock_GetJitter( p_pgrm->p_clock );
@@ -2639,8 +2745,7 @@ static int EsOutControlLocked( es_out_t *out, int i_query, va_list args )
             mtime_t i_delay;
 
             /* Fix for buffering delay */
-            if( !input_priv(p_sys->p_input)->p_sout ||
-                !input_priv(p_sys->p_input)->b_out_pace_control )
+            if( !input_priv(p_sys->p_input)->b_out_pace_control )
                 i_delay = EsOutGetBuffering( out );
             else
                 i_delay = 0;
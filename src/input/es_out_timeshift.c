@@ -37,6 +37,9 @@
 #endif
 #include <sys/stat.h>
 #include <unistd.h>
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_fs.h>
@@ -156,6 +159,21 @@ typedef struct attribute_packed
     } u;
 } ts_cmd_t;
 
+/* Block properties, written in front of the payload in the storage file */
+typedef struct
+{
+    size_t   i_buffer;
+    uint32_t i_flags;
+    unsigned i_nb_samples;
+    mtime_t  i_pts;
+    mtime_t  i_dts;
+    mtime_t  i_length;
+} ts_storage_block_t;
+
+/* Payloads from this size are read back as private mappings of the
+ * storage file instead of being copied */
+#define TS_STORAGE_MMAP_MIN (64 * 1024)
+
 typedef struct ts_storage_t ts_storage_t;
 struct ts_storage_t
 {
@@ -169,14 +187,27 @@ struct ts_storage_t
     int64_t i_file_size;/* Current size in bytes */
     FILE    *p_filew;   /* FILE handle for data writing */
     FILE    *p_filer;   /* FILE handle for data reading */
+#ifdef HAVE_MMAP
+    uint8_t *p_map;     /* Read-only mapping of the first i_file_max bytes */
+    size_t  i_page_mask;
+#endif
 
     /* */
     int      i_cmd_r;
     int      i_cmd_w;
     int      i_cmd_max;
+    int      i_cmd_played; /* Commands before this one were executed */
     ts_cmd_t *p_cmd;
 };
 
+/* Position of an ES_OUT_SET_TIMES command, used to seek inside the buffer */
+typedef struct
+{
+    mtime_t      i_time;
+    ts_storage_t *p_storage;
+    int          i_cmd;
+} ts_index_t;
+
 typedef struct
 {
     vlc_thread_t   thread;
@@ -184,6 +215,7 @@ typedef struct
     es_out_t       *p_out;
     int64_t        i_tmp_size_max;
     const char     *psz_tmp_path;
+    mtime_t        i_history;
 
     /* Lock for all following fields */
     vlc_mutex_t    lock;
@@ -203,11 +235,18 @@ typedef struct
     mtime_t        i_buffering_delay;
 
     /* */
+    ts_storage_t   *p_storage_h; /* Oldest storage, kept to seek backward */
     ts_storage_t   *p_storage_r;
     ts_storage_t   *p_storage_w;
 
     mtime_t        i_cmd_delay;
 
+    /* Seeking inside the buffer */
+    int            i_index;
+    ts_index_t     *p_index;     /* Ordered by position */
+    int            i_skip;       /* Commands to fast forward */
+    bool           b_seek;       /* Reset the output before the next command */
+    mtime_t        i_last_date;  /* Date of the last popped command */
 } ts_thread_t;
 
 struct es_out_id_t
@@ -223,6 +262,7 @@ struct es_out_sys_t
     /* Configuration */
     int64_t        i_tmp_size_max;    /* Maximal temporary file size in byte */
     char           *psz_tmp_path;     /* Path for temporary files */
+    mtime_t        i_history;         /* Played duration kept for seeking */
 
     /* Lock for all following fields */
     vlc_mutex_t    lock;
@@ -253,11 +293,12 @@ static void         TsAutoStop( es_out_t * );
 
 static void         TsStop( ts_thread_t * );
 static void         TsPushCmd( ts_thread_t *, ts_cmd_t * );
-static int          TsPopCmdLocked( ts_thread_t *, ts_cmd_t *, bool b_flush );
+static int          TsPopCmdLocked( ts_thread_t *, ts_cmd_t *, bool b_flush, bool *pb_skip );
 static bool         TsHasCmd( ts_thread_t * );
 static bool         TsIsUnused( ts_thread_t * );
 static int          TsChangePause( ts_thread_t *, bool b_source_paused, bool b_paused, mtime_t i_date );
 static int          TsChangeRate( ts_thread_t *, int i_src_rate, int i_rate );
+static int          TsChangeTime( ts_thread_t *, mtime_t i_time );
 
 static void         *TsRun( void * );
 
@@ -267,7 +308,8 @@ static void         TsStoragePack( ts_storage_t *p_storage );
 static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
 static bool         TsStorageIsEmpty( ts_storage_t * );
 static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd, bool b_flush );
-static void         TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
+static bool         TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
+static int          TsStorageReadBlock( ts_storage_t *, int i_offset, ts_storage_block_t *, block_t ** );
 
 static void CmdClean( ts_cmd_t * );
 static void cmd_cleanup_routine( void *p ) { CmdClean( p ); }
@@ -339,6 +381,8 @@ es_out_t *input_EsOutTimeshiftNew( input_thread_t *p_input, es_out_t *p_next_out
     msg_Dbg( p_input, "using timeshift granularity of %d MiB",
              (int)p_sys->i_tmp_size_max/(1024*1024) );
 
+    p_sys->i_history = var_InheritInteger( p_input, "input-timeshift-history" ) * CLOCK_FREQ;
+
     p_sys->psz_tmp_path = var_InheritString( p_input, "input-timeshift-path" );
 #if defined (_WIN32) && !VLC_WINSTORE_APP
     if( p_sys->psz_tmp_path == NULL )
@@ -603,6 +647,13 @@ static int ControlLockedSetTime( es_out_t *p_out, mtime_t i_date )
 {
     es_out_sys_t *p_sys = p_out->p_sys;
 
+    if( i_date >= 0 )
+    {   /* Only possible from the buffer */
+        if( !p_sys->b_delayed )
+            return VLC_EGENERIC;
+        return TsChangeTime( p_sys->p_ts, i_date );
+    }
+
     if( !p_sys->b_delayed )
         return es_out_SetTime( p_sys->p_out, i_date );
 
@@ -770,6 +821,7 @@ static int Control( es_out_t *p_out, int i_query, va_list args )
  *****************************************************************************/
 static void TsDestroy( ts_thread_t *p_ts )
 {
+    TAB_CLEAN( p_ts->i_index, p_ts->p_index );
     vlc_cond_destroy( &p_ts->wait );
     vlc_mutex_destroy( &p_ts->lock );
     free( p_ts );
@@ -787,6 +839,7 @@ static int TsStart( es_out_t *p_out )
 
     p_ts->i_tmp_size_max = p_sys->i_tmp_size_max;
     p_ts->psz_tmp_path = p_sys->psz_tmp_path;
+    p_ts->i_history = p_sys->i_history;
     p_ts->p_input = p_sys->p_input;
     p_ts->p_out = p_sys->p_out;
     vlc_mutex_init( &p_ts->lock );
@@ -799,8 +852,13 @@ static int TsStart( es_out_t *p_out )
     p_ts->i_rate_delay = 0;
     p_ts->i_buffering_delay = 0;
     p_ts->i_cmd_delay = 0;
+    p_ts->p_storage_h = NULL;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    TAB_INIT( p_ts->i_index, p_ts->p_index );
+    p_ts->i_skip = 0;
+    p_ts->b_seek = false;
+    p_ts->i_last_date = -1;
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts, VLC_THREAD_PRIORITY_INPUT ) )
@@ -837,14 +895,19 @@ static void TsStop( ts_thread_t *p_ts )
     {
         ts_cmd_t cmd;
 
-        if( TsPopCmdLocked( p_ts, &cmd, true ) )
+        if( TsPopCmdLocked( p_ts, &cmd, true, NULL ) )
             break;
 
         CmdClean( &cmd );
     }
     assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
-    if( p_ts->p_storage_r )
-        TsStorageDelete( p_ts->p_storage_r );
+    while( p_ts->p_storage_h )
+    {
+        ts_storage_t *p_next = p_ts->p_storage_h->p_next;
+
+        TsStorageDelete( p_ts->p_storage_h );
+        p_ts->p_storage_h = p_next;
+    }
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
@@ -867,6 +930,7 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 
         if( !p_ts->p_storage_w )
         {
+            p_ts->p_storage_h =
             p_ts->p_storage_r = p_ts->p_storage_w = p_storage;
         }
         else
@@ -878,32 +942,116 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
     }
 
     /* TODO return error and warn the user (but only once) */
+    const bool b_times = p_cmd->i_type == C_CONTROL &&
+                         p_cmd->u.control.i_query == ES_OUT_SET_TIMES;
+    const mtime_t i_time = b_times ? p_cmd->u.control.u.times.i_time : 0;
+
     TsStoragePushCmd( p_ts->p_storage_w, p_cmd, p_ts->p_storage_r == p_ts->p_storage_w );
 
+    if( b_times )
+    {
+        ts_index_t index = {
+            .i_time = i_time,
+            .p_storage = p_ts->p_storage_w,
+            .i_cmd = p_ts->p_storage_w->i_cmd_w - 1,
+        };
+        TAB_APPEND( p_ts->i_index, p_ts->p_index, index );
+    }
+
     vlc_cond_signal( &p_ts->wait );
 
     vlc_mutex_unlock( &p_ts->lock );
 }
-static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
+static bool CmdIsReplayable( const ts_cmd_t *p_cmd )
 {
-    vlc_assert_locked( &p_ts->lock );
-
-    if( TsStorageIsEmpty( p_ts->p_storage_r ) )
-        return VLC_EGENERIC;
+    /* Only commands that do not own any resource can be executed again */
+    if( p_cmd->i_type == C_SEND )
+        return true;
+    if( p_cmd->i_type != C_CONTROL )
+        return false;
 
-    TsStoragePopCmd( p_ts->p_storage_r, p_cmd, b_flush );
+    switch( p_cmd->u.control.i_query )
+    {
+    case ES_OUT_SET_PCR:
+    case ES_OUT_SET_GROUP_PCR:
+    case ES_OUT_RESET_PCR:
+    case ES_OUT_SET_TIMES:
+        return true;
+    default:
+        return false;
+    }
+}
+static void TsPruneLocked( ts_thread_t *p_ts )
+{
+    vlc_assert_locked( &p_ts->lock );
 
-    while( p_ts->p_storage_r && TsStorageIsEmpty( p_ts->p_storage_r ) )
+    /* Drop the storages played for longer than the history duration */
+    while( p_ts->p_storage_h != p_ts->p_storage_r )
     {
-        ts_storage_t *p_next = p_ts->p_storage_r->p_next;
-        if( !p_next )
+        ts_storage_t *p_storage = p_ts->p_storage_h;
+
+        if( p_storage->i_cmd_w > 0 &&
+            p_storage->p_cmd[p_storage->i_cmd_w - 1].i_date + p_ts->i_history
+                >= p_ts->i_last_date )
             break;
 
-        TsStorageDelete( p_ts->p_storage_r );
-        p_ts->p_storage_r = p_next;
+        int i_drop = 0;
+        while( i_drop < p_ts->i_index &&
+               p_ts->p_index[i_drop].p_storage == p_storage )
+            i_drop++;
+        p_ts->i_index -= i_drop;
+        memmove( p_ts->p_index, &p_ts->p_index[i_drop],
+                 p_ts->i_index * sizeof(*p_ts->p_index) );
+
+        p_ts->p_storage_h = p_storage->p_next;
+        TsStorageDelete( p_storage );
     }
+}
+static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush, bool *pb_skip )
+{
+    vlc_assert_locked( &p_ts->lock );
 
-    return VLC_SUCCESS;
+    for( ;; )
+    {
+        if( TsStorageIsEmpty( p_ts->p_storage_r ) )
+            return VLC_EGENERIC;
+
+        const bool b_skip = p_ts->i_skip > 0;
+        if( b_skip )
+            p_ts->i_skip--;
+
+        /* Fast forwarded blocks are not read back */
+        const bool b_replay = TsStoragePopCmd( p_ts->p_storage_r, p_cmd,
+                                               b_flush || b_skip );
+
+        while( p_ts->p_storage_r && TsStorageIsEmpty( p_ts->p_storage_r ) )
+        {
+            ts_storage_t *p_next = p_ts->p_storage_r->p_next;
+            if( !p_next )
+                break;
+
+            p_ts->p_storage_r = p_next;
+        }
+        if( !b_flush )
+        {
+            p_ts->i_last_date = p_cmd->i_date;
+            TsPruneLocked( p_ts );
+        }
+
+        if( b_replay && !CmdIsReplayable( p_cmd ) )
+            continue; /* Already executed, and its resources released */
+
+        /* Nothing to execute when fast forwarding through replayed data */
+        if( b_replay && b_skip )
+        {
+            CmdClean( p_cmd );
+            continue;
+        }
+
+        if( pb_skip )
+            *pb_skip = b_skip;
+        return VLC_SUCCESS;
+    }
 }
 static bool TsHasCmd( ts_thread_t *p_ts )
 {
@@ -976,6 +1124,138 @@ static int TsChangeRate( ts_thread_t *p_ts, int i_src_rate, int i_rate )
 
     return i_ret;
 }
+static bool TsIndexIsPlayedLocked( ts_thread_t *p_ts, const ts_index_t *p_index )
+{
+    vlc_assert_locked( &p_ts->lock );
+
+    for( ts_storage_t *p_storage = p_ts->p_storage_h;
+         p_storage != p_ts->p_storage_r; p_storage = p_storage->p_next )
+    {
+        if( p_storage == p_index->p_storage )
+            return true;
+    }
+    return p_index->p_storage == p_ts->p_storage_r &&
+           p_index->i_cmd < p_ts->p_storage_r->i_cmd_r;
+}
+static void TsForgetHistoryLocked( ts_thread_t *p_ts )
+{
+    vlc_assert_locked( &p_ts->lock );
+
+    int i_drop = 0;
+    while( i_drop < p_ts->i_index &&
+           TsIndexIsPlayedLocked( p_ts, &p_ts->p_index[i_drop] ) )
+        i_drop++;
+    p_ts->i_index -= i_drop;
+    memmove( p_ts->p_index, &p_ts->p_index[i_drop],
+             p_ts->i_index * sizeof(*p_ts->p_index) );
+
+    while( p_ts->p_storage_h != p_ts->p_storage_r )
+    {
+        ts_storage_t *p_next = p_ts->p_storage_h->p_next;
+
+        TsStorageDelete( p_ts->p_storage_h );
+        p_ts->p_storage_h = p_next;
+    }
+}
+static int TsChangeTime( ts_thread_t *p_ts, mtime_t i_time )
+{
+    vlc_mutex_lock( &p_ts->lock );
+
+    if( p_ts->i_index <= 0 ||
+        i_time < p_ts->p_index[0].i_time ||
+        i_time > p_ts->p_index[p_ts->i_index - 1].i_time )
+    {
+        vlc_mutex_unlock( &p_ts->lock );
+        return VLC_EGENERIC;
+    }
+
+    /* Find the last indexed position not after the requested time */
+    int i_low = 0;
+    int i_high = p_ts->i_index - 1;
+    while( i_low < i_high )
+    {
+        const int i_mid = ( i_low + i_high + 1 ) / 2;
+        if( p_ts->p_index[i_mid].i_time <= i_time )
+            i_low = i_mid;
+        else
+            i_high = i_mid - 1;
+    }
+    const ts_index_t *p_index = &p_ts->p_index[i_low];
+    ts_storage_t *p_target = p_index->p_storage;
+
+    if( TsIndexIsPlayedLocked( p_ts, p_index ) )
+    {
+        /* Rewind every storage up to the current read position */
+        if( p_target != p_ts->p_storage_r )
+        {
+            for( ts_storage_t *p_storage = p_target->p_next; ;
+                 p_storage = p_storage->p_next )
+            {
+                p_storage->i_cmd_r = 0;
+                if( p_storage == p_ts->p_storage_r )
+                    break;
+            }
+        }
+        p_target->i_cmd_r = p_index->i_cmd;
+        p_ts->p_storage_r = p_target;
+        p_ts->i_skip = 0;
+    }
+    else
+    {
+        /* Fast forward through the commands in between */
+        int i_skip = 0;
+        ts_storage_t *p_storage;
+        for( p_storage = p_ts->p_storage_r; p_storage != p_target;
+             p_storage = p_storage->p_next )
+            i_skip += p_storage->i_cmd_w - p_storage->i_cmd_r;
+        i_skip += p_index->i_cmd - p_target->i_cmd_r;
+        p_ts->i_skip = i_skip;
+    }
+
+    /* Play the target position now */
+    p_ts->i_cmd_delay += p_ts->i_rate_delay;
+    p_ts->i_rate_date = -1;
+    p_ts->i_rate_delay = 0;
+    if( p_ts->i_last_date >= 0 )
+        p_ts->i_cmd_delay += p_ts->i_last_date -
+                             p_target->p_cmd[p_index->i_cmd].i_date;
+
+    p_ts->b_seek = true;
+    vlc_cond_signal( &p_ts->wait );
+    vlc_mutex_unlock( &p_ts->lock );
+
+    return VLC_SUCCESS;
+}
+
+static void TsExecuteCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
+{
+    switch( p_cmd->i_type )
+    {
+    case C_ADD:
+        CmdExecuteAdd( p_ts->p_out, p_cmd );
+        CmdCleanAdd( p_cmd );
+        break;
+    case C_SEND:
+        CmdExecuteSend( p_ts->p_out, p_cmd );
+        CmdCleanSend( p_cmd );
+        break;
+    case C_CONTROL:
+        CmdExecuteControl( p_ts->p_out, p_cmd );
+        CmdCleanControl( p_cmd );
+        break;
+    case C_DEL:
+        CmdExecuteDel( p_ts->p_out, p_cmd );
+
+        /* The ES is gone: its data before this point cannot be replayed */
+        vlc_mutex_lock( &p_ts->lock );
+        TsForgetHistoryLocked( p_ts );
+        vlc_mutex_unlock( &p_ts->lock );
+        break;
+    default:
+        vlc_assert_unreachable();
+        break;
+    }
+}
 
 static void *TsRun( void *p_data )
 {
@@ -987,6 +1267,7 @@ static void *TsRun( void *p_data )
         ts_cmd_t cmd;
         mtime_t  i_deadline;
         bool b_buffering;
+        bool b_skip;
 
         /* Pop a command to execute */
         vlc_mutex_lock( &p_ts->lock );
@@ -995,9 +1276,16 @@ static void *TsRun( void *p_data )
         for( ;; )
         {
             const int canc = vlc_savecancel();
+            if( p_ts->b_seek )
+            {   /* Jumped inside the buffer: reset the decoders and clocks */
+                p_ts->b_seek = false;
+                es_out_SetTime( p_ts->p_out, -1 );
+                i_buffering_date = -1;
+            }
             b_buffering = es_out_GetBuffering( p_ts->p_out );
 
-            if( ( !p_ts->b_paused || b_buffering ) && !TsPopCmdLocked( p_ts, &cmd, false ) )
+            if( ( !p_ts->b_paused || b_buffering || p_ts->i_skip > 0 ) &&
+                !TsPopCmdLocked( p_ts, &cmd, false, &b_skip ) )
             {
                 vlc_restorecancel( canc );
                 break;
@@ -1007,58 +1295,72 @@ static void *TsRun( void *p_data )
             vlc_cond_wait( &p_ts->wait, &p_ts->lock );
         }
 
-        if( b_buffering && i_buffering_date < 0 )
-        {
-            i_buffering_date = cmd.i_date;
-        }
-        else if( i_buffering_date > 0 )
+        if( !b_skip )
         {
-            p_ts->i_buffering_delay += i_buffering_date - cmd.i_date; /* It is < 0 */
-            if( b_buffering )
+            if( b_buffering && i_buffering_date < 0 )
+            {
                 i_buffering_date = cmd.i_date;
-            else
-                i_buffering_date = -1;
-        }
+            }
+            else if( i_buffering_date > 0 )
+            {
+                p_ts->i_buffering_delay += i_buffering_date - cmd.i_date; /* It is < 0 */
+                if( b_buffering )
+                    i_buffering_date = cmd.i_date;
+                else
+                    i_buffering_date = -1;
+            }
 
-        if( p_ts->i_rate_date < 0 )
-            p_ts->i_rate_date = cmd.i_date;
+            if( p_ts->i_rate_date < 0 )
+                p_ts->i_rate_date = cmd.i_date;
 
-        p_ts->i_rate_delay = 0;
-        if( p_ts->i_rate_source != p_ts->i_rate )
-        {
-            const mtime_t i_duration = cmd.i_date - p_ts->i_rate_date;
-            p_ts->i_rate_delay = i_duration * p_ts->i_rate / p_ts->i_rate_source - i_duration;
-        }
-        if( p_ts->i_cmd_delay + p_ts->i_rate_delay + p_ts->i_buffering_delay < 0 && p_ts->i_rate != p_ts->i_rate_source )
-        {
-            const int canc = vlc_savecancel();
+            p_ts->i_rate_delay = 0;
+            if( p_ts->i_rate_source != p_ts->i_rate )
+            {
+                const mtime_t i_duration = cmd.i_date - p_ts->i_rate_date;
+                p_ts->i_rate_delay = i_duration * p_ts->i_rate / p_ts->i_rate_source - i_duration;
+            }
+            if( p_ts->i_cmd_delay + p_ts->i_rate_delay + p_ts->i_buffering_delay < 0 && p_ts->i_rate != p_ts->i_rate_source )
+            {
+                const int canc = vlc_savecancel();
 
-            /* Auto reset to rate 1.0 */
-            msg_Warn( p_ts->p_input, "es out timeshift: auto reset rate to %d", p_ts->i_rate_source );
+                /* Auto reset to rate 1.0 */
+                msg_Warn( p_ts->p_input, "es out timeshift: auto reset rate to %d", p_ts->i_rate_source );
 
-            p_ts->i_cmd_delay = 0;
-            p_ts->i_buffering_delay = 0;
+                p_ts->i_cmd_delay = 0;
+                p_ts->i_buffering_delay = 0;
 
-            p_ts->i_rate_delay = 0;
-            p_ts->i_rate_date = -1;
-            p_ts->i_rate = p_ts->i_rate_source;
+                p_ts->i_rate_delay = 0;
+                p_ts->i_rate_date = -1;
+                p_ts->i_rate = p_ts->i_rate_source;
 
-            if( !es_out_SetRate( p_ts->p_out, p_ts->i_rate_source, p_ts->i_rate ) )
-            {
-                vlc_value_t val = { .i_int = p_ts->i_rate };
-                /* Warn back input
-                 * FIXME it is perfectly safe BUT it is ugly as it may hide a
-                 * rate change requested by user */
-                input_ControlPush( p_ts->p_input, INPUT_CONTROL_SET_RATE, &val );
-            }
+                if( !es_out_SetRate( p_ts->p_out, p_ts->i_rate_source, p_ts->i_rate ) )
+                {
+                    vlc_value_t val = { .i_int = p_ts->i_rate };
+                    /* Warn back input
+                     * FIXME it is perfectly safe BUT it is ugly as it may hide a
+                     * rate change requested by user */
+                    input_ControlPush( p_ts->p_input, INPUT_CONTROL_SET_RATE, &val );
+                }
 
-            vlc_restorecancel( canc );
+                vlc_restorecancel( canc );
+            }
+            i_deadline = cmd.i_date + p_ts->i_cmd_delay + p_ts->i_rate_delay + p_ts->i_buffering_delay;
         }
-        i_deadline = cmd.i_date + p_ts->i_cmd_delay + p_ts->i_rate_delay + p_ts->i_buffering_delay;
 
         vlc_cleanup_pop();
         vlc_mutex_unlock( &p_ts->lock );
 
+        if( b_skip )
+        {   /* Fast forwarding: drop the data, but keep the ES states */
+            const int canc = vlc_savecancel();
+            if( CmdIsReplayable( &cmd ) )
+                CmdClean( &cmd );
+            else
+                TsExecuteCmd( p_ts, &cmd );
+            vlc_restorecancel( canc );
+            continue;
+        }
+
         /* Regulate the speed of command processing to the same one than
          * reading  */
         vlc_cleanup_push( cmd_cleanup_routine, &cmd );
@@ -1069,27 +1371,7 @@ static void *TsRun( void *p_data )
 
         /* Execute the command  */
         const int canc = vlc_savecancel();
-        switch( cmd.i_type )
-        {
-        case C_ADD:
-            CmdExecuteAdd( p_ts->p_out, &cmd );
-            CmdCleanAdd( &cmd );
-            break;
-        case C_SEND:
-            CmdExecuteSend( p_ts->p_out, &cmd );
-            CmdCleanSend( &cmd );
-            break;
-        case C_CONTROL:
-            CmdExecuteControl( p_ts->p_out, &cmd );
-            CmdCleanControl( &cmd );
-            break;
-        case C_DEL:
-            CmdExecuteDel( p_ts->p_out, &cmd );
-            break;
-        default:
-            vlc_assert_unreachable();
-            break;
-        }
+        TsExecuteCmd( p_ts, &cmd );
         vlc_restorecancel( canc );
     }
 
@@ -1141,9 +1423,21 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
     p_storage->i_file_max = i_tmp_size_max;
     p_storage->i_file_size = 0;
 
+#ifdef HAVE_MMAP
+    /* The file grows into the mapping as commands are written. Only flushed
+     * data is ever read, so pages past the end of file are not touched. If
+     * the address space is short, fall back to plain reads. */
+    p_storage->p_map = mmap( NULL, p_storage->i_file_max, PROT_READ,
+                             MAP_SHARED, fileno( p_storage->p_filer ), 0 );
+    if( p_storage->p_map == MAP_FAILED )
+        p_storage->p_map = NULL;
+    p_storage->i_page_mask = sysconf( _SC_PAGESIZE ) - 1;
+#endif
+
     /* */
     p_storage->i_cmd_w = 0;
     p_storage->i_cmd_r = 0;
+    p_storage->i_cmd_played = 0;
     p_storage->i_cmd_max = 30000;
     p_storage->p_cmd = malloc( p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) );
     //fprintf( stderr, "\nSTORAGE name=%s size=%d KiB\n", p_storage->psz_file, p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) /1024 );
@@ -1162,6 +1456,8 @@ error:
 
 static void TsStorageDelete( ts_storage_t *p_storage )
 {
+    /* Only clean the commands that were never executed */
+    p_storage->i_cmd_r = __MAX( p_storage->i_cmd_r, p_storage->i_cmd_played );
     while( p_storage->i_cmd_r < p_storage->i_cmd_w )
     {
         ts_cmd_t cmd;
@@ -1172,6 +1468,10 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     }
     free( p_storage->p_cmd );
 
+#ifdef HAVE_MMAP
+    if( p_storage->p_map != NULL )
+        munmap( p_storage->p_map, p_storage->i_file_max );
+#endif
     fclose( p_storage->p_filer );
     fclose( p_storage->p_filew );
 #ifdef _WIN32
@@ -1183,6 +1483,9 @@ static void TsStorageDelete( ts_storage_t *p_storage )
 
 static void TsStoragePack( ts_storage_t *p_storage )
 {
+    /* No more writes: make the tail readable */
+    fflush( p_storage->p_filew );
+
     /* Try to release a bit of memory */
     if( p_storage->i_cmd_w >= p_storage->i_cmd_max )
         return;
@@ -1197,7 +1500,7 @@ static bool TsStorageIsFull( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
 {
     if( p_cmd && p_cmd->i_type == C_SEND && p_storage->i_cmd_w > 0 )
     {
-        size_t i_size = sizeof(*p_cmd->u.send.p_block) + p_cmd->u.send.p_block->i_buffer;
+        size_t i_size = sizeof(ts_storage_block_t) + p_cmd->u.send.p_block->i_buffer;
 
         if( p_storage->i_file_size + i_size >= p_storage->i_file_max )
             return true;
@@ -1217,16 +1520,24 @@ static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bo
     if( cmd.i_type == C_SEND )
     {
         block_t *p_block = cmd.u.send.p_block;
+        const ts_storage_block_t header = {
+            .i_buffer = p_block->i_buffer,
+            .i_flags = p_block->i_flags,
+            .i_nb_samples = p_block->i_nb_samples,
+            .i_pts = p_block->i_pts,
+            .i_dts = p_block->i_dts,
+            .i_length = p_block->i_length,
+        };
 
         cmd.u.send.p_block = NULL;
         cmd.u.send.i_offset = ftell( p_storage->p_filew );
 
-        if( fwrite( p_block, sizeof(*p_block), 1, p_storage->p_filew ) != 1 )
+        if( fwrite( &header, sizeof(header), 1, p_storage->p_filew ) != 1 )
         {
             block_Release( p_block );
             return;
         }
-        p_storage->i_file_size += sizeof(*p_block);
+        p_storage->i_file_size += sizeof(header);
         if( p_block->i_buffer > 0 )
         {
             if( fwrite( p_block->p_buffer, p_block->i_buffer, 1, p_storage->p_filew ) != 1 )
@@ -1243,30 +1554,36 @@ static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bo
     }
     p_storage->p_cmd[p_storage->i_cmd_w++] = cmd;
 }
-static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush )
+/* Returns true if the command was already popped once (seeking backward) */
+static bool TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush )
 {
     assert( !TsStorageIsEmpty( p_storage ) );
 
+    const bool b_replay = p_storage->i_cmd_r < p_storage->i_cmd_played;
+
     *p_cmd = p_storage->p_cmd[p_storage->i_cmd_r++];
+    p_storage->i_cmd_played = __MAX( p_storage->i_cmd_played, p_storage->i_cmd_r );
+
+    if( b_replay && p_cmd->i_type != C_SEND )
+        return true;
+
     if( p_cmd->i_type == C_SEND )
     {
-        block_t block;
+        ts_storage_block_t header;
 
         if( !b_flush &&
-            !fseek( p_storage->p_filer, p_cmd->u.send.i_offset, SEEK_SET ) &&
-            fread( &block, sizeof(block), 1, p_storage->p_filer ) == 1 )
+            !TsStorageReadBlock( p_storage, p_cmd->u.send.i_offset, &header,
+                                 &p_cmd->u.send.p_block ) )
         {
-            block_t *p_block = block_Alloc( block.i_buffer );
+            block_t *p_block = p_cmd->u.send.p_block;
             if( p_block )
             {
-                p_block->i_dts      = block.i_dts;
-                p_block->i_pts      = block.i_pts;
-                p_block->i_flags    = block.i_flags;
-                p_block->i_length   = block.i_length;
-                p_block->i_nb_samples = block.i_nb_samples;
-                p_block->i_buffer = fread( p_block->p_buffer, 1, block.i_buffer, p_storage->p_filer );
+                p_block->i_dts      = header.i_dts;
+                p_block->i_pts      = header.i_pts;
+                p_block->i_flags    = header.i_flags;
+                p_block->i_length   = header.i_length;
+                p_block->i_nb_samples = header.i_nb_samples;
             }
-            p_cmd->u.send.p_block = p_block;
         }
         else
         {
@@ -1274,6 +1591,58 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
             p_cmd->u.send.p_block = block_Alloc( 1 );
         }
     }
+    return b_replay;
+}
+static int TsStorageReadBlock( ts_storage_t *p_storage, int i_offset,
+                               ts_storage_block_t *p_header, block_t **pp_block )
+{
+    block_t *p_block;
+
+#ifdef HAVE_MMAP
+    const size_t i_data = (size_t)i_offset + sizeof(*p_header);
+
+    if( p_storage->p_map != NULL && i_data <= p_storage->i_file_max )
+    {
+        memcpy( p_header, &p_storage->p_map[i_offset], sizeof(*p_header) );
+
+        if( p_header->i_buffer <= p_storage->i_file_max - i_data )
+        {
+            p_block = NULL;
+            if( p_header->i_buffer >= TS_STORAGE_MMAP_MIN )
+            {   /* Zero-copy, writable thanks to copy-on-write */
+                const size_t i_skew = i_data & p_storage->i_page_mask;
+                uint8_t *p_addr = mmap( NULL, i_skew + p_header->i_buffer,
+                                        PROT_READ|PROT_WRITE, MAP_PRIVATE,
+                                        fileno( p_storage->p_filer ),
+                                        i_data - i_skew );
+                if( p_addr != MAP_FAILED )
+                    p_block = block_mmap_Alloc( p_addr + i_skew,
+                                                p_header->i_buffer );
+            }
+            if( p_block == NULL )
+            {
+                p_block = block_Alloc( p_header->i_buffer );
+                if( p_block )
+                    memcpy( p_block->p_buffer, &p_storage->p_map[i_data],
+                            p_header->i_buffer );
+            }
+            *pp_block = p_block;
+            return VLC_SUCCESS;
+        }
+    }
+    /* Oversized command (only the first one of a storage may be) */
+#endif
+
+    if( fseek( p_storage->p_filer, i_offset, SEEK_SET ) ||
+        fread( p_header, sizeof(*p_header), 1, p_storage->p_filer ) != 1 )
+        return VLC_EGENERIC;
+
+    p_block = block_Alloc( p_header->i_buffer );
+    if( p_block )
+        p_block->i_buffer = fread( p_block->p_buffer, 1, p_header->i_buffer,
+                                   p_storage->p_filer );
+    *pp_block = p_block;
+    return VLC_SUCCESS;
 }
 
 /*****************************************************************************
@@ -32,6 +32,7 @@
 #include <vlc_common.h>
 
 #include <limits.h>
+#include <errno.h>
 #include <assert.h>
 #include <math.h>
 #include <sys/stat.h>
@@ -43,6 +44,7 @@
 #include "demux.h"
 #include "item.h"
 #include "resource.h"
+#include "../misc/tracer.h"
 
 #include <vlc_sout.h>
 #include <vlc_dialog.h>
@@ -323,6 +325,7 @@ static input_thread_t *Create( vlc_object_t *p_parent, input_item_t *p_item,
     priv->attachment_demux = NULL;
     priv->p_sout   = NULL;
     priv->b_out_pace_control = false;
+    priv->b_offline = false;
 
     vlc_gc_incref( p_item ); /* Released in Destructor() */
     priv->p_item = p_item;
@@ -468,6 +471,24 @@ static input_thread_t *Create( vlc_object_t *p_parent, input_item_t *p_item,
     return p_input;
 }
 
+static void InputDumpTrace( input_thread_t *p_input, const char *psz_path,
+                            mtime_t i_since )
+{
+    FILE *stream = vlc_fopen( psz_path, "wt" );
+    if( stream == NULL )
+    {
+        msg_Err( p_input, "cannot create trace file %s: %s", psz_path,
+                 vlc_strerror_c(errno) );
+        return;
+    }
+
+    if( vlc_tracer_Dump( p_input, i_since, stream ) )
+        msg_Err( p_input, "cannot write trace file %s", psz_path );
+    else
+        msg_Dbg( p_input, "trace written to %s", psz_path );
+    fclose( stream );
+}
+
 /*****************************************************************************
  * Run: main thread loop
  * This is the "normal" thread that spawns the input processing chain,
@@ -480,6 +501,14 @@ static void *Run( void *data )
 
     vlc_interrupt_set(&priv->interrupt);
 
+    char *psz_trace = var_InheritString( p_input, "input-trace" );
+    const mtime_t i_trace_start = mdate();
+    if( psz_trace != NULL && vlc_tracer_Start() )
+    {
+        free( psz_trace );
+        psz_trace = NULL;
+    }
+
     if( !Init( p_input ) )
     {
         if( priv->b_can_pace_control && priv->b_out_pace_control )
@@ -495,6 +524,13 @@ static void *Run( void *data )
         End( p_input );
     }
 
+    if( psz_trace != NULL )
+    {
+        InputDumpTrace( p_input, psz_trace, i_trace_start );
+        vlc_tracer_Stop();
+        free( psz_trace );
+    }
+
     input_SendEventDead( p_input );
     return NULL;
 }
@@ -629,6 +665,22 @@ static int MainLoopTryRepeat( input_thread_t *p_input )
     return VLC_SUCCESS;
 }
 
+/**
+ * Accounts the CPU time used by the input thread since the last call.
+ * This must be called from the input thread.
+ */
+static void UpdateCpuStatistics( input_thread_t *p_input )
+{
+    input_thread_private_t *priv = input_priv(p_input);
+    mtime_t i_cpu = vlc_thread_cputime();
+
+    vlc_mutex_lock( &priv->counters.counters_lock );
+    stats_Update( priv->counters.p_input_cpu,
+                  i_cpu - priv->counters.i_input_cpu_last, NULL );
+    vlc_mutex_unlock( &priv->counters.counters_lock );
+    priv->counters.i_input_cpu_last = i_cpu;
+}
+
 /**
  * Update timing infos and statistics.
  */
@@ -659,6 +711,8 @@ static void MainLoopStatistics( input_thread_t *p_input )
     input_priv(p_input)->bookmark.i_time_offset = i_time;
     vlc_mutex_unlock( &input_priv(p_input)->p_item->lock );
 
+    if( libvlc_stats( p_input ) )
+        UpdateCpuStatistics( p_input );
     stats_ComputeInputStats( p_input, input_priv(p_input)->p_item->p_stats );
     input_SendEventStatistics( p_input );
 }
@@ -797,6 +851,7 @@ static void InitStatistics( input_thread_t *p_input )
     {
         INIT_COUNTER( read_bytes, COUNTER );
         INIT_COUNTER( read_packets, COUNTER );
+        INIT_COUNTER( read_lost, COUNTER );
         INIT_COUNTER( demux_read, COUNTER );
         INIT_COUNTER( input_bitrate, DERIVATIVE );
         INIT_COUNTER( demux_bitrate, DERIVATIVE );
@@ -809,6 +864,10 @@ static void InitStatistics( input_thread_t *p_input )
         INIT_COUNTER( decoded_audio, COUNTER );
         INIT_COUNTER( decoded_video, COUNTER );
         INIT_COUNTER( decoded_sub, COUNTER );
+        INIT_COUNTER( input_cpu, COUNTER );
+        INIT_COUNTER( audio_decoder_cpu, COUNTER );
+        INIT_COUNTER( video_decoder_cpu, COUNTER );
+        priv->counters.i_input_cpu_last = 0;
         priv->counters.p_sout_send_bitrate = NULL;
         priv->counters.p_sout_sent_packets = NULL;
         priv->counters.p_sout_sent_bytes = NULL;
@@ -930,6 +989,7 @@ static void StartTitle( input_thread_t * p_input )
         priv->i_stop = 0;
     }
     priv->b_fast_seek = var_GetBool( p_input, "input-fast-seek" );
+    priv->b_offline = var_GetBool( p_input, "input-offline" );
 }
 
 static int SlaveCompare(const void *a, const void *b)
@@ -1333,6 +1393,13 @@ static int Init( input_thread_t * p_input )
         msg_Dbg( p_input, "starting in %ssync mode",
                  priv->b_out_pace_control ? "a" : "" );
     }
+    else if( !priv->b_preparsing && priv->b_offline )
+    {
+        /* Demux without waiting for the clock: only the decoder FIFOs
+         * hold the input back */
+        priv->b_out_pace_control = true;
+        msg_Dbg( p_input, "starting in offline mode" );
+    }
 
     vlc_meta_t *p_meta = vlc_meta_New();
     if( p_meta != NULL )
@@ -1382,6 +1449,7 @@ error:
                                input_priv(p_input)->counters.p_##c = NULL; } while(0)
         EXIT_COUNTER( read_bytes );
         EXIT_COUNTER( read_packets );
+        EXIT_COUNTER( read_lost );
         EXIT_COUNTER( demux_read );
         EXIT_COUNTER( input_bitrate );
         EXIT_COUNTER( demux_bitrate );
@@ -1394,6 +1462,9 @@ error:
         EXIT_COUNTER( decoded_audio );
         EXIT_COUNTER( decoded_video );
         EXIT_COUNTER( decoded_sub );
+        EXIT_COUNTER( input_cpu );
+        EXIT_COUNTER( audio_decoder_cpu );
+        EXIT_COUNTER( video_decoder_cpu );
 
         if( input_priv(p_input)->p_sout )
         {
@@ -1451,9 +1522,11 @@ do { \
         if( libvlc_stats( p_input ) )
         {
             /* make sure we are up to date */
+            UpdateCpuStatistics( p_input );
             stats_ComputeInputStats( p_input, priv->p_item->p_stats );
             CL_CO( read_bytes );
             CL_CO( read_packets );
+            CL_CO( read_lost );
             CL_CO( demux_read );
             CL_CO( input_bitrate );
             CL_CO( demux_bitrate );
@@ -1466,6 +1539,9 @@ do { \
             CL_CO( decoded_audio) ;
             CL_CO( decoded_video );
             CL_CO( decoded_sub) ;
+            CL_CO( input_cpu );
+            CL_CO( audio_decoder_cpu );
+            CL_CO( video_decoder_cpu );
         }
 
         /* Close optional stream output instance */
@@ -1767,6 +1843,14 @@ static bool Control( input_thread_t *p_input,
             if( i_time < 0 )
                 i_time = 0;
 
+            /* Jump inside the timeshift buffer if possible, the source does
+             * not need to seek then */
+            if( !es_out_SetTime( input_priv(p_input)->p_es_out, i_time ) )
+            {
+                b_force_update = true;
+                break;
+            }
+
             /* Reset the decoders states and clock sync (before calling the demuxer */
             es_out_SetTime( input_priv(p_input)->p_es_out, -1 );
 
@@ -103,6 +103,7 @@ typedef struct input_thread_private_t
     int64_t     i_stop;     /* :stop-time, 0 if none */
     int64_t     i_time;     /* Current time */
     bool        b_fast_seek;/* :input-fast-seek */
+    bool        b_offline;  /* :input-offline */
 
     /* Output */
     bool            b_out_pace_control; /* XXX Move it ot es_sout ? */
@@ -146,6 +147,7 @@ typedef struct input_thread_private_t
     struct {
         counter_t *p_read_packets;
         counter_t *p_read_bytes;
+        counter_t *p_read_lost;
         counter_t *p_input_bitrate;
         counter_t *p_demux_read;
         counter_t *p_demux_bitrate;
@@ -161,7 +163,11 @@ typedef struct input_thread_private_t
         counter_t *p_lost_abuffers;
         counter_t *p_displayed_pictures;
         counter_t *p_lost_pictures;
+        counter_t *p_input_cpu;
+        counter_t *p_audio_decoder_cpu;
+        counter_t *p_video_decoder_cpu;
         vlc_mutex_t counters_lock;
+        mtime_t i_input_cpu_last; /* input thread only */
     } counters;
 
     /* Buffer of pending actions */
@@ -482,6 +482,42 @@ void input_resource_TerminateVout( input_resource_t *p_resource )
 {
     input_resource_RequestVout( p_resource, NULL, NULL, 0, false );
 }
+
+int input_resource_PreloadVout( input_resource_t *p_resource )
+{
+    vlc_mutex_lock( &p_resource->lock );
+    if( p_resource->p_vout_free != NULL || p_resource->i_vout > 0 )
+    {
+        vlc_mutex_unlock( &p_resource->lock );
+        return VLC_SUCCESS;
+    }
+
+    /* The format is reinitialized when an input requests the vout */
+    video_format_t fmt;
+    video_format_Init( &fmt, VLC_CODEC_I420 );
+    video_format_Setup( &fmt, VLC_CODEC_I420, 16, 16, 16, 16, 1, 1 );
+
+    vout_configuration_t cfg = {
+        .vout       = NULL,
+        .input      = NULL,
+        .change_fmt = true,
+        .fmt        = &fmt,
+        .dpb_size   = 0,
+    };
+    vout_thread_t *p_vout = vout_Request( p_resource->p_parent, &cfg );
+    if( p_vout != NULL )
+    {
+        msg_Dbg( p_resource->p_parent, "saving a preloaded vout" );
+        cfg.vout = p_vout;
+        cfg.change_fmt = false;
+        cfg.fmt = NULL;
+        p_resource->p_vout_free = vout_Request( p_resource->p_parent, &cfg );
+    }
+    const bool b_vout = p_resource->p_vout_free != NULL;
+    vlc_mutex_unlock( &p_resource->lock );
+
+    return b_vout ? VLC_SUCCESS : VLC_EGENERIC;
+}
 bool input_resource_HasVout( input_resource_t *p_resource )
 {
     vlc_mutex_lock( &p_resource->lock );
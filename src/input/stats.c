@@ -91,15 +91,21 @@ void stats_ComputeInputStats(input_thread_t *input, input_stats_t *st)
     /* Input */
     st->i_read_packets = stats_GetTotal(priv->counters.p_read_packets);
     st->i_read_bytes = stats_GetTotal(priv->counters.p_read_bytes);
+    st->i_read_lost = stats_GetTotal(priv->counters.p_read_lost);
     st->f_input_bitrate = stats_GetRate(priv->counters.p_input_bitrate);
     st->i_demux_read_bytes = stats_GetTotal(priv->counters.p_demux_read);
     st->f_demux_bitrate = stats_GetRate(priv->counters.p_demux_bitrate);
     st->i_demux_corrupted = stats_GetTotal(priv->counters.p_demux_corrupted);
     st->i_demux_discontinuity = stats_GetTotal(priv->counters.p_demux_discontinuity);
+    st->i_input_cpu_time = stats_GetTotal(priv->counters.p_input_cpu);
 
     /* Decoders */
     st->i_decoded_video = stats_GetTotal(priv->counters.p_decoded_video);
     st->i_decoded_audio = stats_GetTotal(priv->counters.p_decoded_audio);
+    st->i_video_decoder_cpu_time =
+        stats_GetTotal(priv->counters.p_video_decoder_cpu);
+    st->i_audio_decoder_cpu_time =
+        stats_GetTotal(priv->counters.p_audio_decoder_cpu);
 
     /* Sout */
     if (priv->counters.p_sout_send_bitrate)
@@ -124,7 +130,7 @@ void stats_ComputeInputStats(input_thread_t *input, input_stats_t *st)
 void stats_ReinitInputStats( input_stats_t *p_stats )
 {
     vlc_mutex_lock( &p_stats->lock );
-    p_stats->i_read_packets = p_stats->i_read_bytes =
+    p_stats->i_read_packets = p_stats->i_read_bytes = p_stats->i_read_lost =
     p_stats->f_input_bitrate = p_stats->f_average_input_bitrate =
     p_stats->i_demux_read_packets = p_stats->i_demux_read_bytes =
     p_stats->f_demux_bitrate = p_stats->f_average_demux_bitrate =
@@ -132,8 +138,9 @@ void stats_ReinitInputStats( input_stats_t *p_stats )
     p_stats->i_displayed_pictures = p_stats->i_lost_pictures =
     p_stats->i_played_abuffers = p_stats->i_lost_abuffers =
     p_stats->i_decoded_video = p_stats->i_decoded_audio =
-    p_stats->i_sent_bytes = p_stats->i_sent_packets = p_stats->f_send_bitrate
-     = 0;
+    p_stats->i_sent_bytes = p_stats->i_sent_packets = p_stats->f_send_bitrate =
+    p_stats->i_input_cpu_time = p_stats->i_audio_decoder_cpu_time =
+    p_stats->i_video_decoder_cpu_time = 0;
     vlc_mutex_unlock( &p_stats->lock );
 }
 
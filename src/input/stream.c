@@ -41,6 +41,9 @@
 #include <libvlc.h>
 #include "stream.h"
 
+/* Smaller reads are copied, not to pin large access blocks in memory */
+#define STREAM_SPLIT_MIN 4096
+
 typedef struct stream_priv_t
 {
     stream_t stream;
@@ -50,6 +53,10 @@ typedef struct stream_priv_t
     uint64_t offset;
     bool eof;
 
+    /* Read-only copy of the probe window, see stream_ProbeStart() */
+    block_t *probe;
+    uint64_t probe_offset;
+
     /* UTF-16 and UTF-32 file reading */
     struct {
         vlc_iconv_t   conv;
@@ -86,6 +93,7 @@ stream_t *vlc_stream_CommonNew(vlc_object_t *parent,
     priv->peek = NULL;
     priv->offset = 0;
     priv->eof = false;
+    priv->probe = NULL;
 
     /* UTF16 and UTF32 text file conversion */
     priv->text.conv = (vlc_iconv_t)(-1);
@@ -106,6 +114,8 @@ void stream_CommonDelete(stream_t *s)
         block_Release(priv->peek);
     if (priv->block != NULL)
         block_Release(priv->block);
+    if (priv->probe != NULL)
+        block_Release(priv->probe);
 
     free(s->psz_url);
     vlc_object_release(s);
@@ -545,6 +555,94 @@ bool vlc_stream_Eof(const stream_t *s)
     return priv->eof;
 }
 
+/**
+ * Offset of the underlying stream, past any buffered data
+ */
+static uint64_t vlc_stream_RawTell(const stream_priv_t *priv)
+{
+    uint64_t offset = priv->offset;
+
+    if (priv->peek != NULL)
+        offset += priv->peek->i_buffer;
+    if (priv->block != NULL)
+        offset += priv->block->i_buffer;
+    return offset;
+}
+
+int stream_ProbeStart(stream_t *s, size_t len)
+{
+    stream_priv_t *priv = (stream_priv_t *)s;
+    const uint8_t *peek;
+
+    stream_ProbeStop(s);
+
+    ssize_t ret = vlc_stream_Peek(s, &peek, len);
+    if (ret < 0)
+        return VLC_EGENERIC;
+
+    /* Keep everything buffered, so that the window ends exactly where the
+     * underlying stream stands */
+    size_t peeklen = (priv->peek != NULL) ? priv->peek->i_buffer : 0;
+    size_t blocklen = (priv->block != NULL) ? priv->block->i_buffer : 0;
+    block_t *probe = block_Alloc(peeklen + blocklen);
+    if (unlikely(probe == NULL))
+        return VLC_ENOMEM;
+
+    if (peeklen > 0)
+        memcpy(probe->p_buffer, priv->peek->p_buffer, peeklen);
+    if (blocklen > 0)
+        memcpy(probe->p_buffer + peeklen, priv->block->p_buffer, blocklen);
+
+    priv->probe = probe;
+    priv->probe_offset = priv->offset;
+    return VLC_SUCCESS;
+}
+
+void stream_ProbeStop(stream_t *s)
+{
+    stream_priv_t *priv = (stream_priv_t *)s;
+
+    if (priv->probe != NULL)
+    {
+        block_Release(priv->probe);
+        priv->probe = NULL;
+    }
+}
+
+/**
+ * Seeks back within the probe window without touching the underlying
+ * stream, as long as it has not been read past the window.
+ */
+static int vlc_stream_SeekProbe(stream_priv_t *priv, uint64_t offset)
+{
+    block_t *probe = priv->probe;
+
+    if (probe == NULL || offset < priv->probe_offset
+     || offset > priv->probe_offset + probe->i_buffer
+     || vlc_stream_RawTell(priv) != priv->probe_offset + probe->i_buffer)
+        return VLC_EGENERIC;
+
+    size_t skip = offset - priv->probe_offset;
+    block_t *peek = NULL;
+
+    if (skip < probe->i_buffer)
+    {
+        peek = block_Alloc(probe->i_buffer - skip);
+        if (unlikely(peek == NULL))
+            return VLC_ENOMEM;
+        memcpy(peek->p_buffer, probe->p_buffer + skip, peek->i_buffer);
+    }
+
+    if (priv->peek != NULL)
+        block_Release(priv->peek);
+    if (priv->block != NULL)
+        block_Release(priv->block);
+    priv->peek = peek;
+    priv->block = NULL;
+    priv->offset = offset;
+    return VLC_SUCCESS;
+}
+
 int vlc_stream_Seek(stream_t *s, uint64_t offset)
 {
     stream_priv_t *priv = (stream_priv_t *)s;
@@ -578,6 +676,9 @@ int vlc_stream_Seek(stream_t *s, uint64_t offset)
             return VLC_SUCCESS; /* Nothing to do! */
     }
 
+    if (vlc_stream_SeekProbe(priv, offset) == VLC_SUCCESS)
+        return VLC_SUCCESS;
+
     if (s->pf_seek == NULL)
         return VLC_EGENERIC;
 
@@ -621,6 +722,7 @@ int vlc_stream_vaControl(stream_t *s, int cmd, va_list args)
                 return ret;
 
             priv->offset = 0;
+            stream_ProbeStop(s);
 
             if (priv->peek != NULL)
             {
@@ -651,9 +753,38 @@ int vlc_stream_vaControl(stream_t *s, int cmd, va_list args)
  */
 block_t *vlc_stream_Block( stream_t *s, size_t size )
 {
+    stream_priv_t *priv = (stream_priv_t *)s;
+
     if( unlikely(size > SSIZE_MAX) )
         return NULL;
 
+    /* Hand out the data buffered from a block access without copying it */
+    if( size >= STREAM_SPLIT_MIN )
+    {
+        block_t **pp = (priv->peek != NULL) ? &priv->peek : &priv->block;
+
+        if( *pp == NULL && s->pf_block != NULL && !vlc_killed() )
+        {
+            bool eof = false;
+
+            *pp = s->pf_block( s, &eof );
+        }
+
+        if( *pp != NULL && (*pp)->i_buffer >= size )
+        {
+            block_t *block = block_Split( pp, size );
+            if( likely(block != NULL) )
+            {   /* Same as a block read below */
+                block->i_flags = 0;
+                block->i_nb_samples = 0;
+                block->i_pts = block->i_dts = VLC_TS_INVALID;
+                block->i_length = 0;
+                priv->offset += size;
+                return block;
+            }
+        }
+    }
+
     block_t *block = block_Alloc( size );
     if( unlikely(block == NULL) )
         return NULL;
@@ -53,6 +53,21 @@ stream_t *stream_FilterAutoNew( stream_t *source ) VLC_USED;
  */
 stream_t *stream_FilterChainNew( stream_t *p_source, const char *psz_chain );
 
+/**
+ * Prefetches the next \p len bytes of the stream and keeps a copy of them
+ * until stream_ProbeStop(). Seeking back within that window is then served
+ * from memory instead of re-fetching the data from the source.
+ *
+ * This is used while probing, so that every candidate module sees the same
+ * data for a single read of the source.
+ */
+int stream_ProbeStart(stream_t *s, size_t len);
+
+/**
+ * Releases the probe window, if any.
+ */
+void stream_ProbeStop(stream_t *s);
+
 char *get_path(const char *location);
 
 #endif
@@ -0,0 +1,420 @@
+/*****************************************************************************
+ * thumbnailer.c: headless thumbnail capture
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_codec.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_input_item.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+#include <vlc_thumbnailer.h>
+
+#include "input_internal.h"
+#include "demux.h"
+
+/* Give up if no picture is decoded within that delay (e.g. live streams) */
+#define THUMBNAILER_TIMEOUT (CLOCK_FREQ * 10)
+
+struct es_out_id_t
+{
+    es_format_t fmt;
+};
+
+struct es_out_sys_t
+{
+    vlc_object_t *obj;
+
+    es_out_id_t *id;          /**< Captured video ES */
+    decoder_t *packetizer;    /**< NULL if the ES is packetized */
+    decoder_t *decoder;       /**< NULL until the first packetized block */
+    bool b_error;
+
+    int i_width, i_height;    /**< Wanted size, as decoder hints */
+    picture_t *picture;       /**< Captured picture */
+};
+
+/*****************************************************************************
+ * Decoder owner
+ *****************************************************************************/
+typedef struct
+{
+    decoder_t dec;
+    es_out_sys_t *sys;
+} thumbnailer_decoder_t;
+
+static int VideoFormatUpdate( decoder_t *dec )
+{
+    dec->fmt_out.video.i_chroma = dec->fmt_out.i_codec;
+    return 0;
+}
+
+static picture_t *VideoBufferNew( decoder_t *dec )
+{
+    return picture_NewFromFormat( &dec->fmt_out.video );
+}
+
+static int VideoQueue( decoder_t *dec, picture_t *pic )
+{
+    es_out_sys_t *sys = ((thumbnailer_decoder_t *)dec)->sys;
+
+    if( sys->picture == NULL )
+        sys->picture = pic;
+    else
+        picture_Release( pic );
+    return 0;
+}
+
+static void DeleteDecoder( decoder_t *dec )
+{
+    if( dec->p_module != NULL )
+        module_unneed( dec, dec->p_module );
+    es_format_Clean( &dec->fmt_in );
+    es_format_Clean( &dec->fmt_out );
+    if( dec->p_description != NULL )
+        vlc_meta_Delete( dec->p_description );
+    vlc_object_release( dec );
+}
+
+static decoder_t *CreateDecoder( es_out_sys_t *sys, const es_format_t *fmt,
+                                 bool b_packetizer )
+{
+    thumbnailer_decoder_t *owner =
+        vlc_custom_create( sys->obj, sizeof( *owner ),
+                           b_packetizer ? "packetizer" : "decoder" );
+    if( unlikely(owner == NULL) )
+        return NULL;
+
+    decoder_t *dec = &owner->dec;
+    owner->sys = sys;
+
+    es_format_Copy( &dec->fmt_in, fmt );
+    es_format_Init( &dec->fmt_out, VIDEO_ES, 0 );
+    dec->b_frame_drop_allowed = false;
+
+    if( b_packetizer )
+    {
+        dec->fmt_in.b_packetized = false;
+        dec->p_module = module_need( dec, "packetizer", "$packetizer",
+                                     false );
+    }
+    else
+    {
+        dec->pf_vout_format_update = VideoFormatUpdate;
+        dec->pf_vout_buffer_new = VideoBufferNew;
+        dec->pf_queue_video = VideoQueue;
+
+        /* Only decode key frames: the first one after the seek point is
+         * captured, and the other frames would only be thrown away. */
+        var_Create( dec, "avcodec-skip-frame", VLC_VAR_INTEGER );
+        var_SetInteger( dec, "avcodec-skip-frame", 3 );
+        /* Hardware surfaces cannot be read back without video output */
+        var_Create( dec, "avcodec-hw", VLC_VAR_STRING );
+        var_SetString( dec, "avcodec-hw", "none" );
+        /* Some decoders can directly decode at a lower resolution */
+        var_Create( dec, "image-output-width", VLC_VAR_INTEGER );
+        var_SetInteger( dec, "image-output-width", __MAX(sys->i_width, 0) );
+        var_Create( dec, "image-output-height", VLC_VAR_INTEGER );
+        var_SetInteger( dec, "image-output-height", __MAX(sys->i_height, 0) );
+
+        dec->p_module = module_need( dec, "decoder", "$codec", false );
+    }
+
+    if( dec->p_module == NULL )
+    {
+        msg_Err( sys->obj, "cannot find %s for `%4.4s'",
+                 b_packetizer ? "packetizer" : "decoder",
+                 (const char *)&fmt->i_codec );
+        DeleteDecoder( dec );
+        return NULL;
+    }
+    return dec;
+}
+
+static void Decode( es_out_sys_t *sys, block_t *block )
+{
+    block_t **pp_block = block != NULL ? &block : NULL;
+    picture_t *pic;
+
+    while( (pic = sys->decoder->pf_decode_video( sys->decoder, pp_block ))
+               != NULL )
+        VideoQueue( sys->decoder, pic );
+}
+
+static void DecodeBlock( es_out_sys_t *sys, block_t *block )
+{
+    if( sys->decoder == NULL )
+    {
+        const es_format_t *fmt = sys->packetizer != NULL
+                               ? &sys->packetizer->fmt_out : &sys->id->fmt;
+
+        sys->decoder = CreateDecoder( sys, fmt, false );
+        if( sys->decoder == NULL )
+        {
+            sys->b_error = true;
+            block_Release( block );
+            return;
+        }
+    }
+    Decode( sys, block );
+}
+
+/*****************************************************************************
+ * ES output
+ *****************************************************************************/
+static es_out_id_t *EsOutAdd( es_out_t *out, const es_format_t *fmt )
+{
+    es_out_sys_t *sys = out->p_sys;
+    es_out_id_t *id = malloc( sizeof( *id ) );
+    if( unlikely(id == NULL) )
+        return NULL;
+
+    es_format_Copy( &id->fmt, fmt );
+
+    if( sys->id == NULL && fmt->i_cat == VIDEO_ES && !sys->b_error )
+    {
+        sys->id = id;
+        if( !fmt->b_packetized )
+        {
+            sys->packetizer = CreateDecoder( sys, fmt, true );
+            if( sys->packetizer == NULL )
+                sys->b_error = true;
+        }
+    }
+    return id;
+}
+
+static int EsOutSend( es_out_t *out, es_out_id_t *id, block_t *block )
+{
+    es_out_sys_t *sys = out->p_sys;
+
+    if( id != sys->id || sys->b_error || sys->picture != NULL )
+    {
+        block_Release( block );
+        return VLC_SUCCESS;
+    }
+
+    if( sys->packetizer != NULL )
+    {
+        block_t *packet;
+
+        /* The packetizer owns the block until it returns NULL */
+        while( (packet = sys->packetizer->pf_packetize( sys->packetizer,
+                                                        &block )) != NULL )
+        {
+            while( packet != NULL )
+            {
+                block_t *next = packet->p_next;
+
+                packet->p_next = NULL;
+                if( sys->picture == NULL && !sys->b_error )
+                    DecodeBlock( sys, packet );
+                else
+                    block_Release( packet );
+                packet = next;
+            }
+        }
+    }
+    else
+        DecodeBlock( sys, block );
+
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel( es_out_t *out, es_out_id_t *id )
+{
+    es_out_sys_t *sys = out->p_sys;
+
+    if( id == sys->id )
+    {
+        if( sys->decoder != NULL && sys->picture == NULL )
+            Decode( sys, NULL );
+        sys->b_error = sys->picture == NULL;
+        sys->id = NULL;
+    }
+    es_format_Clean( &id->fmt );
+    free( id );
+}
+
+static int EsOutControl( es_out_t *out, int i_query, va_list args )
+{
+    es_out_sys_t *sys = out->p_sys;
+
+    switch( i_query )
+    {
+        case ES_OUT_GET_ES_STATE:
+        {
+            es_out_id_t *id = va_arg( args, es_out_id_t * );
+            bool *pb_selected = va_arg( args, bool * );
+
+            *pb_selected = id == sys->id;
+            return VLC_SUCCESS;
+        }
+        case ES_OUT_GET_EMPTY:
+            *va_arg( args, bool * ) = true;
+            return VLC_SUCCESS;
+
+        case ES_OUT_SET_ES:
+        case ES_OUT_RESTART_ES:
+        case ES_OUT_SET_ES_DEFAULT:
+        case ES_OUT_SET_ES_STATE:
+        case ES_OUT_SET_ES_CAT_POLICY:
+        case ES_OUT_SET_GROUP:
+        case ES_OUT_SET_PCR:
+        case ES_OUT_SET_GROUP_PCR:
+        case ES_OUT_RESET_PCR:
+        case ES_OUT_SET_NEXT_DISPLAY_TIME:
+        case ES_OUT_SET_GROUP_META:
+        case ES_OUT_SET_GROUP_EPG:
+        case ES_OUT_DEL_GROUP:
+        case ES_OUT_SET_ES_SCRAMBLED_STATE:
+        case ES_OUT_SET_META:
+            return VLC_SUCCESS;
+
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static void EsOutDestroy( es_out_t *out )
+{
+    (void) out;
+}
+
+/*****************************************************************************
+ * Capture
+ *****************************************************************************/
+static picture_t *Capture( vlc_object_t *obj, input_item_t *item,
+                           es_out_sys_t *sys, mtime_t i_time )
+{
+    char *psz_uri = input_item_GetURI( item );
+    if( psz_uri == NULL )
+        return NULL;
+
+    const char *psz_access, *psz_demux, *psz_path, *psz_anchor = NULL;
+    input_SplitMRL( &psz_access, &psz_demux, &psz_path, &psz_anchor,
+                    psz_uri );
+
+    es_out_t out = {
+        .pf_add = EsOutAdd,
+        .pf_send = EsOutSend,
+        .pf_del = EsOutDel,
+        .pf_control = EsOutControl,
+        .pf_destroy = EsOutDestroy,
+        .p_sys = sys,
+    };
+
+    demux_t *demux = input_DemuxNew( obj, psz_access, psz_demux, psz_path,
+                                     &out, false, NULL );
+    free( psz_uri );
+    if( demux == NULL )
+        return NULL;
+
+    if( demux->pf_demux == NULL )
+    {
+        msg_Err( obj, "cannot capture thumbnails from access-only modules" );
+        demux_Delete( demux );
+        return NULL;
+    }
+
+    /* Seek to the key frame before the wanted time, by time if possible,
+     * else by position */
+    if( i_time > 0
+     && demux_Control( demux, DEMUX_SET_TIME, i_time, false ) )
+    {
+        int64_t i_length;
+        int i_ret = demux_Control( demux, DEMUX_GET_LENGTH, &i_length );
+
+        if( i_ret == VLC_SUCCESS && i_length > 0 )
+            i_ret = demux_Control( demux, DEMUX_SET_POSITION,
+                                   (double)i_time / i_length, false );
+        else
+            i_ret = VLC_EGENERIC;
+        if( i_ret != VLC_SUCCESS )
+            msg_Warn( obj, "cannot seek, capturing from the start" );
+    }
+
+    const mtime_t deadline = mdate() + THUMBNAILER_TIMEOUT;
+
+    while( sys->picture == NULL && !sys->b_error )
+    {
+        if( demux_Demux( demux ) != VLC_DEMUXER_SUCCESS )
+        {   /* Get the pictures still held by the decoder */
+            if( sys->decoder != NULL && sys->picture == NULL )
+                Decode( sys, NULL );
+            break;
+        }
+        if( mdate() > deadline )
+        {
+            msg_Err( obj, "no picture decoded in time" );
+            break;
+        }
+    }
+
+    demux_Delete( demux );
+    return sys->picture;
+}
+
+#undef vlc_thumbnailer_Capture
+int vlc_thumbnailer_Capture( vlc_object_t *parent, input_item_t *item,
+                             mtime_t i_time, vlc_fourcc_t i_format,
+                             int i_width, int i_height, block_t **pp_image )
+{
+    vlc_object_t *obj = vlc_custom_create( parent, sizeof( *obj ),
+                                           "thumbnailer" );
+    if( unlikely(obj == NULL) )
+        return VLC_ENOMEM;
+
+    input_item_ApplyOptions( obj, item );
+
+    es_out_sys_t sys = {
+        .obj = obj,
+        .i_width = i_width,
+        .i_height = i_height,
+    };
+
+    picture_t *pic = Capture( obj, item, &sys, i_time );
+
+    if( sys.decoder != NULL )
+        DeleteDecoder( sys.decoder );
+    if( sys.packetizer != NULL )
+        DeleteDecoder( sys.packetizer );
+
+    int ret = VLC_EGENERIC;
+    if( pic != NULL )
+    {
+        ret = picture_Export( obj, pp_image, NULL, pic, i_format,
+                              i_width, i_height );
+        picture_Release( pic );
+    }
+    else
+        msg_Err( obj, "cannot capture a thumbnail" );
+
+    vlc_object_release( obj );
+    return ret;
+}
@@ -103,6 +103,7 @@ static int InputEvent( vlc_object_t *p_this, char const *psz_cmd,
         vlm_SendEventMediaInstanceState( p_vlm, p_media->cfg.id, p_media->cfg.psz_name, psz_instance_name, var_GetInteger( p_input, "state" ) );
 
         vlc_mutex_lock( &p_vlm->lock_manage );
+        p_media->b_state_changed = true;
         p_vlm->input_state_changed = true;
         vlc_cond_signal( &p_vlm->wait_manage );
         vlc_mutex_unlock( &p_vlm->lock_manage );
@@ -410,6 +411,14 @@ static void* Manage( void* p_object )
         {
             vlm_media_sys_t *p_media = vlm->media[i];
 
+            /* Only look at the media whose inputs changed state */
+            vlc_mutex_lock( &vlm->lock_manage );
+            bool b_changed = p_media->b_state_changed;
+            p_media->b_state_changed = false;
+            vlc_mutex_unlock( &vlm->lock_manage );
+            if( !b_changed )
+                continue;
+
             for( j = 0; j < p_media->i_instance; )
             {
                 vlm_media_instance_sys_t *p_instance = p_media->instance[j];
@@ -458,17 +467,16 @@ static void* Manage( void* p_object )
                 }
                 else if( vlm->schedule[i]->period != 0 )
                 {
-                    int j = 0;
-                    while( ((vlm->schedule[i]->date + j *
-                             vlm->schedule[i]->period) <= lastcheck) &&
-                           ( vlm->schedule[i]->i_repeat > j ||
-                             vlm->schedule[i]->i_repeat < 0 ) )
-                    {
-                        j++;
-                    }
+                    /* first repetition after the last check */
+                    const vlm_schedule_sys_t *p_sched = vlm->schedule[i];
+                    int64_t n = 0;
+
+                    if( p_sched->date <= lastcheck )
+                        n = ( lastcheck - p_sched->date ) / p_sched->period + 1;
+                    if( p_sched->i_repeat >= 0 && n > p_sched->i_repeat )
+                        n = p_sched->i_repeat;
 
-                    real_date = vlm->schedule[i]->date + j *
-                        vlm->schedule[i]->period;
+                    real_date = p_sched->date + n * p_sched->period;
                 }
 
                 if( real_date <= now )
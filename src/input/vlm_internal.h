@@ -59,6 +59,9 @@ typedef struct
     /* actual input instances */
     int                      i_instance;
     vlm_media_instance_sys_t **instance;
+
+    /* an instance changed state (protected by vlm_t.lock_manage) */
+    bool b_state_changed;
 } vlm_media_sys_t;
 
 typedef struct
@@ -85,6 +85,12 @@ static const char *const ppsz_snap_formats[] =
     "This is the verbosity level (0=only errors and " \
     "standard messages, 1=warnings, 2=debug).")
 
+#define LOG_ASYNC_TEXT N_("Asynchronous logging")
+#define LOG_ASYNC_LONGTEXT N_( \
+    "Pass the messages to the logger from a separate thread, so that " \
+    "logging does not slow down the threads emitting the messages. " \
+    "Messages may be dropped if they are emitted faster than logged.")
+
 #define OPEN_TEXT N_("Default stream")
 #define OPEN_LONGTEXT N_( \
     "This stream will always be opened at VLC startup." )
@@ -514,11 +520,25 @@ static const char *const ppsz_pos_descriptions[] =
 #define NETWORK_CACHING_LONGTEXT N_( \
     "Caching value for network resources, in milliseconds." )
 
+#define MEM_BUDGET_TEXT N_("Memory budget (MiB)")
+#define MEM_BUDGET_LONGTEXT N_( \
+    "Maximum amount of memory used by the resizable buffers and caches " \
+    "of the whole process, such as prefetch buffers, in mebibytes. " \
+    "Once it is nearly reached, the largest users shrink their buffers " \
+    "and caches stop retaining memory. 0 means unlimited." )
+
 #define CR_AVERAGE_TEXT N_("Clock reference average counter")
 #define CR_AVERAGE_LONGTEXT N_( \
     "When using the PVR input (or a very irregular source), you should " \
     "set this to 10000.")
 
+#define CLOCK_BANDWIDTH_TEXT N_("Clock recovery bandwidth")
+#define CLOCK_BANDWIDTH_LONGTEXT N_( \
+    "Bandwidth (in Hz) of the loop estimating the drift of the stream " \
+    "clock. Lower values reject more network jitter but follow clock " \
+    "changes more slowly. 0 derives it from the clock reference average " \
+    "counter.")
+
 #define CLOCK_SYNCHRO_TEXT N_("Clock synchronisation")
 #define CLOCK_SYNCHRO_LONGTEXT N_( \
     "It is possible to disable the input clock synchronisation for " \
@@ -574,6 +594,13 @@ static const char *const ppsz_clock_descriptions[] =
     "Only use this option if you want to read a multi-program stream " \
     "(like DVB streams for example)." )
 
+#define INPUT_STANDBY_TEXT N_("Program standby duration (ms)")
+#define INPUT_STANDBY_LONGTEXT N_( \
+    "Keep the last milliseconds of the unselected programs of a " \
+    "multi-program stream in memory, so that switching program can start " \
+    "decoding immediately. This should cover the key frame interval of " \
+    "the programs. 0 disables this." )
+
 /// \todo Document how to find it
 #define INPUT_AUDIOTRACK_TEXT N_("Audio track")
 #define INPUT_AUDIOTRACK_LONGTEXT N_( \
@@ -643,6 +670,13 @@ static const char *const ppsz_prefres[] = {
 #define INPUT_FAST_SEEK_LONGTEXT N_( \
     "Favor speed over precision while seeking" )
 
+#define INPUT_OFFLINE_TEXT N_("Offline processing")
+#define INPUT_OFFLINE_LONGTEXT N_( \
+    "Process the input as fast as possible rather than at playback speed: " \
+    "the demuxer and the decoders are not paced by the clock, and the " \
+    "outputs get the frames as soon as they are decoded. This is meant for " \
+    "batch processing with dummy or callback outputs." )
+
 #define INPUT_RATE_TEXT N_("Playback speed")
 #define INPUT_RATE_LONGTEXT N_( \
     "This defines the playback speed (nominal speed is 1.0)." )
@@ -682,6 +716,17 @@ static const char *const ppsz_prefres[] = {
     "This is the maximum size in bytes of the temporary files " \
     "that will be used to store the timeshifted streams." )
 
+#define INPUT_TIMESHIFT_HISTORY_TEXT N_("Timeshift history")
+#define INPUT_TIMESHIFT_HISTORY_LONGTEXT N_( \
+    "Duration in seconds of already played data kept in the timeshift " \
+    "temporary files, so that seeking backward does not need the source." )
+
+#define INPUT_TRACE_TEXT N_("Latency trace file")
+#define INPUT_TRACE_LONGTEXT N_( \
+    "Record the time at which the data goes through the access, the " \
+    "demuxer, the decoders and the video output, and write it to this file " \
+    "in Chrome trace event format when the input ends." )
+
 #define INPUT_TITLE_FORMAT_TEXT N_( "Change title according to current media" )
 #define INPUT_TITLE_FORMAT_LONGTEXT N_( "This option allows you to set the title according to what's being played<br>"  \
     "$a: Artist<br>$b: Album<br>$c: Copyright<br>$t: Title<br>$g: Genre<br>"  \
@@ -896,6 +941,11 @@ static const char *const ppsz_prefres[] = {
     "before trying the other ones. Only advanced users should " \
     "alter this option as it can break playback of all your streams." )
 
+#define PACKETIZER_THREAD_TEXT N_("Packetize video in a separate thread")
+#define PACKETIZER_THREAD_LONGTEXT N_( \
+    "Run the video packetizer (and closed captions extraction) in its own " \
+    "thread, so that it overlaps with decoding on multi-core systems." )
+
 #define ENCODER_TEXT N_("Preferred encoders list")
 #define ENCODER_LONGTEXT N_( \
     "This allows you to select a list of encoders that VLC will use in " \
@@ -950,6 +1000,13 @@ static const char *const ppsz_prefres[] = {
     "This allow you to configure the initial caching amount for stream output " \
     "muxer. This value should be set in milliseconds." )
 
+#define SOUT_MUX_QUANTUM_TEXT N_("Stream output muxer quantum (ms)")
+#define SOUT_MUX_QUANTUM_LONGTEXT N_( \
+    "Run the muxer once enough input has been received to cover this " \
+    "amount of time instead of after every block. This reduces the muxing " \
+    "overhead and makes the output more regular, at the expense of some " \
+    "latency. This value should be set in milliseconds (0 to disable)." )
+
 #define PACKETIZER_TEXT N_("Preferred packetizer list")
 #define PACKETIZER_LONGTEXT N_( \
     "This allows you to select the order in which VLC will choose its " \
@@ -1003,6 +1060,11 @@ static const char *const ppsz_prefres[] = {
     "the correct demuxer is not automatically detected. You should not "\
     "set this as a global option unless you really know what you are doing." )
 
+#define DEMUX_PROBE_SIZE_TEXT N_("Demux probe size")
+#define DEMUX_PROBE_SIZE_LONGTEXT N_( \
+    "Amount of data (in bytes) fetched once from the start of the stream " \
+    "and shared by all the demultiplexers while probing. Zero disables it." )
+
 #define VOD_SERVER_TEXT N_("VoD server module")
 #define VOD_SERVER_LONGTEXT N_( \
     "You can select which VoD server module you want to use. Set this " \
@@ -1030,6 +1092,17 @@ static const char *const ppsz_prefres[] = {
 #define VLM_CONF_LONGTEXT N_( \
     "Read a VLM configuration file as soon as VLM is started." )
 
+#define AVX_TEXT N_("Use AVX instructions")
+#define AVX_LONGTEXT N_( \
+    "Allow the optimized code paths requiring AVX (and AVX2, XOP, FMA4) " \
+    "to be used when the CPU supports them. Disable this to benchmark or " \
+    "debug the fallback code paths.")
+
+#define AVX2_TEXT N_("Use AVX2 instructions")
+#define AVX2_LONGTEXT N_( \
+    "Allow the optimized code paths requiring AVX2 to be used when the " \
+    "CPU supports them.")
+
 #define PLUGINS_CACHE_TEXT N_("Use a plugins cache")
 #define PLUGINS_CACHE_LONGTEXT N_( \
     "Use a plugins cache which will greatly improve the startup time of VLC.")
@@ -1115,6 +1188,16 @@ static const char *const ppsz_prefres[] = {
 #define PREPARSE_TIMEOUT_LONGTEXT N_( \
     "Maximum time allowed to preparse a file" )
 
+#define PREPARSE_THREADS_TEXT N_( "Preparsing threads" )
+#define PREPARSE_THREADS_LONGTEXT N_( \
+    "Maximum number of files preparsed at the same time" )
+
+#define PREPARSE_CACHE_TEXT N_( "Cache preparsed metadata" )
+#define PREPARSE_CACHE_LONGTEXT N_( \
+    "Store the metadata and tracks of the preparsed local files in the " \
+    "user cache directory, so that they are not parsed again until they " \
+    "are modified." )
+
 #define METADATA_NETWORK_TEXT N_( "Allow metadata network access" )
 
 #define SD_TEXT N_( "Services discovery modules")
@@ -1678,6 +1761,9 @@ vlc_module_begin ()
     add_string( "programs", "",
                 INPUT_PROGRAMS_TEXT, INPUT_PROGRAMS_LONGTEXT, true )
         change_safe ()
+    add_integer( "program-standby", 0,
+                 INPUT_STANDBY_TEXT, INPUT_STANDBY_LONGTEXT, true )
+        change_integer_range( 0, 10000 )
     add_integer( "audio-track", -1,
                  INPUT_AUDIOTRACK_TEXT, INPUT_AUDIOTRACK_LONGTEXT, true )
         change_safe ()
@@ -1724,6 +1810,9 @@ vlc_module_begin ()
     add_bool( "input-fast-seek", false,
               INPUT_FAST_SEEK_TEXT, INPUT_FAST_SEEK_LONGTEXT, false )
         change_safe ()
+    add_bool( "input-offline", false,
+              INPUT_OFFLINE_TEXT, INPUT_OFFLINE_LONGTEXT, true )
+        change_safe ()
     add_float( "rate", 1.,
                INPUT_RATE_TEXT, INPUT_RATE_LONGTEXT, false )
 
@@ -1849,9 +1938,14 @@ vlc_module_begin ()
     add_obsolete_integer( "smb-caching" ) /* 2.0.0 */
     add_obsolete_integer( "tcp-caching" ) /* 2.0.0 */
     add_obsolete_integer( "udp-caching" ) /* 2.0.0 */
+    add_integer( "mem-budget", 0, MEM_BUDGET_TEXT, MEM_BUDGET_LONGTEXT, true )
+        change_integer_range( 0, 1 << 20 )
 
     add_integer( "cr-average", 40, CR_AVERAGE_TEXT,
                  CR_AVERAGE_LONGTEXT, true )
+    add_float( "clock-bandwidth", 0., CLOCK_BANDWIDTH_TEXT,
+               CLOCK_BANDWIDTH_LONGTEXT, true )
+        change_float_range( 0., 10. )
     add_integer( "clock-synchro", -1, CLOCK_SYNCHRO_TEXT,
                  CLOCK_SYNCHRO_LONGTEXT, true )
         change_integer_list( pi_clock_values, ppsz_clock_descriptions )
@@ -1871,6 +1965,12 @@ vlc_module_begin ()
                 INPUT_TIMESHIFT_PATH_LONGTEXT, true )
     add_integer( "input-timeshift-granularity", -1, INPUT_TIMESHIFT_GRANULARITY_TEXT,
                  INPUT_TIMESHIFT_GRANULARITY_LONGTEXT, true )
+    add_integer( "input-timeshift-history", 60, INPUT_TIMESHIFT_HISTORY_TEXT,
+                 INPUT_TIMESHIFT_HISTORY_LONGTEXT, true )
+        change_integer_range( 0, 86400 )
+
+    add_savefile( "input-trace", NULL, INPUT_TRACE_TEXT,
+                  INPUT_TRACE_LONGTEXT, true )
 
     add_string( "input-title-format", "$Z", INPUT_TITLE_FORMAT_TEXT, INPUT_TITLE_FORMAT_LONGTEXT, false );
 
@@ -1879,6 +1979,8 @@ vlc_module_begin ()
     add_category_hint( N_("Decoders"), CODEC_CAT_LONGTEXT , true )
     add_string( "codec", NULL, CODEC_TEXT,
                 CODEC_LONGTEXT, true )
+    add_bool( "packetizer-thread", false, PACKETIZER_THREAD_TEXT,
+              PACKETIZER_THREAD_LONGTEXT, true )
     add_string( "encoder",  NULL, ENCODER_TEXT,
                 ENCODER_LONGTEXT, true )
 
@@ -1888,6 +1990,9 @@ vlc_module_begin ()
 
     set_subcategory( SUBCAT_INPUT_DEMUX )
     add_module( "demux", "demux", "any", DEMUX_TEXT, DEMUX_LONGTEXT, true )
+    add_integer( "demux-probe-size", 65536, DEMUX_PROBE_SIZE_TEXT,
+                 DEMUX_PROBE_SIZE_LONGTEXT, true )
+        change_integer_range( 0, 16 * 1024 * 1024 )
     set_subcategory( SUBCAT_INPUT_ACODEC )
     set_subcategory( SUBCAT_INPUT_SCODEC )
     add_obsolete_bool( "prefer-system-codecs" )
@@ -1918,6 +2023,9 @@ vlc_module_begin ()
                                 SOUT_SPU_LONGTEXT, true )
     add_integer( "sout-mux-caching", 1500, SOUT_MUX_CACHING_TEXT,
                                 SOUT_MUX_CACHING_LONGTEXT, true )
+    add_integer( "sout-mux-quantum", 0, SOUT_MUX_QUANTUM_TEXT,
+                                SOUT_MUX_QUANTUM_LONGTEXT, true )
+        change_integer_range( 0, 1000 )
 
     set_section( N_("VLM"), NULL )
     add_loadfile( "vlm-conf", NULL, VLM_CONF_TEXT,
@@ -1958,6 +2066,8 @@ vlc_module_begin ()
     add_obsolete_bool( "ssse3" ) /* since 2.0.0 */
     add_obsolete_bool( "sse41" ) /* since 2.0.0 */
     add_obsolete_bool( "sse42" ) /* since 2.0.0 */
+    add_bool( "avx", true, AVX_TEXT, AVX_LONGTEXT, true )
+    add_bool( "avx2", true, AVX2_TEXT, AVX2_LONGTEXT, true )
 #endif
 #if defined( __powerpc__ ) || defined( __ppc__ ) || defined( __ppc64__ )
     add_obsolete_bool( "altivec" ) /* since 2.0.0 */
@@ -2051,6 +2161,11 @@ vlc_module_begin ()
 
     add_integer( "preparse-timeout", 5000, PREPARSE_TIMEOUT_TEXT,
                  PREPARSE_TIMEOUT_LONGTEXT, false )
+    add_integer_with_range( "preparse-threads", 1, 1, 16,
+                            PREPARSE_THREADS_TEXT,
+                            PREPARSE_THREADS_LONGTEXT, true )
+    add_bool( "preparse-cache", false, PREPARSE_CACHE_TEXT,
+              PREPARSE_CACHE_LONGTEXT, true )
 
     add_obsolete_integer( "album-art" )
     add_bool( "metadata-network-access", false, METADATA_NETWORK_TEXT,
@@ -2068,6 +2183,7 @@ vlc_module_begin ()
         change_short('v')
         change_volatile ()
     add_obsolete_string( "verbose-objects" ) /* since 2.1.0 */
+    add_bool( "log-async", false, LOG_ASYNC_TEXT, LOG_ASYNC_LONGTEXT, true )
 #if !defined(_WIN32) && !defined(__OS2__)
     add_bool( "daemon", 0, DAEMON_TEXT, DAEMON_LONGTEXT, true )
         change_short('d')
@@ -351,6 +351,13 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
 dbus_out:
 #endif // HAVE_DBUS
 
+#if defined( __i386__ ) || defined( __x86_64__ )
+    if( !var_InheritBool( p_libvlc, "avx" ) )
+        vlc_CPU_disable( VLC_CPU_AVX | VLC_CPU_AVX2 | VLC_CPU_XOP
+                       | VLC_CPU_FMA4 );
+    else if( !var_InheritBool( p_libvlc, "avx2" ) )
+        vlc_CPU_disable( VLC_CPU_AVX2 );
+#endif
     vlc_CPU_dump( VLC_OBJECT(p_libvlc) );
 
     priv->b_stats = var_InheritBool( p_libvlc, "stats" );
@@ -47,6 +47,7 @@ size_t EnumClockSource( vlc_object_t *, const char *, char ***, char *** );
 #endif
 void vlc_CPU_init(void);
 void vlc_CPU_dump(vlc_object_t *);
+void vlc_CPU_disable(unsigned);
 
 /*
  * Threads subsystem
@@ -57,6 +58,12 @@ int vlc_clone_detach (vlc_thread_t *, void *(*)(void *), void *, int);
 
 int vlc_set_priority( vlc_thread_t, int );
 
+/**
+ * Returns the CPU time used by the calling thread so far, or 0 if the
+ * platform cannot measure it.
+ */
+mtime_t vlc_thread_cputime( void );
+
 void vlc_threads_setup (libvlc_int_t *);
 
 void vlc_trace (const char *fn, const char *file, unsigned line);
@@ -126,9 +126,20 @@ unsigned vlc_CPU (void)
     pthread_once (&once, vlc_CPU_init);
     return cpu_flags;
 }
+
+void vlc_CPU_disable (unsigned flags)
+{
+    vlc_CPU ();
+    cpu_flags &= ~flags;
+}
 #else /* CPU_FLAGS */
 unsigned vlc_CPU (void)
 {
     return 0;
 }
+
+void vlc_CPU_disable (unsigned flags)
+{
+    (void) flags;
+}
 #endif
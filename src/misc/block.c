@@ -33,6 +33,8 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_atomic.h>
+#include <vlc_membudget.h>
 #include <vlc_fs.h>
 
 #ifndef NDEBUG
@@ -117,8 +119,269 @@ static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 /** Initial reserved header and footer size. */
 #define BLOCK_PADDING      32
 
+/*****************************************************************************
+ * Per-thread size-class block pools
+ *****************************************************************************
+ * Each thread allocating blocks owns a pool with one free list per size class.
+ * Blocks are returned to the pool of the thread that allocated them:
+ * directly to the free lists if released by the owner thread, or through a
+ * lock-free LIFO otherwise, which the owner drains when it runs dry.
+ * Each pool is reference counted by its owner thread and outstanding blocks,
+ * so that it outlives its owner thread as long as any of its blocks is alive.
+ * Under memory pressure (see vlc_membudget.h), released blocks are freed
+ * instead of being cached.
+ *****************************************************************************/
+static const size_t block_pool_sizes[] = { 188, 1316, 4096, 65536, 1048576 };
+/** Maximum count of cached blocks per thread for each size class */
+static const unsigned block_pool_caps[] = { 256, 128, 64, 16, 4 };
+#define BLOCK_POOL_CLASSES ARRAY_SIZE(block_pool_sizes)
+
+/** Interval (in allocations) of the statistics flush to the global totals */
+#define BLOCK_POOL_STATS_PERIOD 256
+
+typedef struct block_pool_t block_pool_t;
+
+typedef struct
+{
+    block_t       self;
+    block_pool_t *pool;
+    unsigned      class;
+} block_pooled_t;
+
+struct block_pool_t
+{
+    struct
+    {
+        block_t  *head;
+        unsigned  count;
+    } classes[BLOCK_POOL_CLASSES]; /**< Free lists, owner thread only */
+    atomic_uintptr_t remote; /**< Blocks released by other threads */
+    atomic_uint refs;
+    unsigned hits;
+    unsigned misses;
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    atomic_int state; /**< 0: uninitialized, 1: ready, -1: unavailable */
+    vlc_threadvar_t var;
+    atomic_ullong hits;
+    atomic_ullong misses;
+} block_pools = { VLC_STATIC_MUTEX, ATOMIC_VAR_INIT(0), };
+
+static size_t block_pool_AllocSize(unsigned class)
+{
+    return sizeof (block_pooled_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
+           + block_pool_sizes[class];
+}
+
+static void block_pool_FlushStats(block_pool_t *pool)
+{
+    atomic_fetch_add_explicit(&block_pools.hits, pool->hits,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&block_pools.misses, pool->misses,
+                              memory_order_relaxed);
+    pool->hits = pool->misses = 0;
+}
+
+static void block_pool_FreeChain(block_t *block)
+{
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+        free(block);
+        block = next;
+    }
+}
+
+static void block_pool_Destroy(block_pool_t *pool)
+{
+    block_t *remote = (block_t *)atomic_exchange(&pool->remote, 0);
+
+    block_pool_FreeChain(remote);
+    free(pool);
+}
+
+static void block_pool_Unref(block_pool_t *pool)
+{
+    if (atomic_fetch_sub_explicit(&pool->refs, 1, memory_order_acq_rel) == 1)
+        block_pool_Destroy(pool);
+}
+
+/** Thread-local variable destructor: drops the owner thread reference. */
+static void block_pool_Exit(void *data)
+{
+    block_pool_t *pool = data;
+
+    for (unsigned i = 0; i < BLOCK_POOL_CLASSES; i++)
+        block_pool_FreeChain(pool->classes[i].head);
+    block_pool_FreeChain((block_t *)atomic_exchange(&pool->remote, 0));
+    block_pool_FlushStats(pool);
+    block_pool_Unref(pool);
+}
+
+static block_pool_t *block_pool_Get(void)
+{
+    int state = atomic_load_explicit(&block_pools.state, memory_order_acquire);
+
+    if (unlikely(state == 0))
+    {
+        vlc_mutex_lock(&block_pools.lock);
+        state = atomic_load_explicit(&block_pools.state, memory_order_relaxed);
+        if (state == 0)
+        {
+            state = vlc_threadvar_create(&block_pools.var, block_pool_Exit)
+                    ? -1 : 1;
+            atomic_store_explicit(&block_pools.state, state,
+                                  memory_order_release);
+        }
+        vlc_mutex_unlock(&block_pools.lock);
+    }
+
+    if (state < 0)
+        return NULL;
+
+    block_pool_t *pool = vlc_threadvar_get(block_pools.var);
+    if (likely(pool != NULL))
+        return pool;
+
+    pool = calloc(1, sizeof (*pool));
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    atomic_init(&pool->remote, 0);
+    atomic_init(&pool->refs, 1);
+    if (vlc_threadvar_set(block_pools.var, pool))
+    {
+        free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/** Moves blocks released by other threads back to the free lists. */
+static void block_pool_Reclaim(block_pool_t *pool)
+{
+    block_t *block = (block_t *)atomic_exchange_explicit(&pool->remote, 0,
+                                                         memory_order_acquire);
+    const bool under_pressure = vlc_mem_UnderPressure();
+
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+        unsigned class = ((block_pooled_t *)block)->class;
+
+        if (pool->classes[class].count < block_pool_caps[class]
+         && !under_pressure)
+        {
+            block->p_next = pool->classes[class].head;
+            pool->classes[class].head = block;
+            pool->classes[class].count++;
+        }
+        else
+            free(block);
+        block = next;
+    }
+}
+
+static void block_pool_Release(block_t *block)
+{
+    block_pooled_t *pb = (block_pooled_t *)block;
+    block_pool_t *pool = pb->pool;
+
+    assert(block->p_start == (unsigned char *)(pb + 1));
+    block_Invalidate(block);
+
+    if (pool == vlc_threadvar_get(block_pools.var))
+    {   /* Released by the owner thread: no synchronization needed */
+        unsigned class = pb->class;
+
+        /* Do not retain memory that the budget needs elsewhere */
+        if (pool->classes[class].count < block_pool_caps[class]
+         && !vlc_mem_UnderPressure())
+        {
+            block->p_next = pool->classes[class].head;
+            pool->classes[class].head = block;
+            pool->classes[class].count++;
+        }
+        else
+            free(block);
+    }
+    else
+    {   /* Released by another thread: push to the remote LIFO */
+        uintptr_t head = atomic_load_explicit(&pool->remote,
+                                              memory_order_relaxed);
+        do
+            block->p_next = (block_t *)head;
+        while (!atomic_compare_exchange_weak_explicit(&pool->remote, &head,
+                                                      (uintptr_t)block,
+                                                      memory_order_release,
+                                                      memory_order_relaxed));
+    }
+
+    block_pool_Unref(pool);
+}
+
+static block_t *block_pool_Alloc(block_pool_t *pool, unsigned class,
+                                 size_t size)
+{
+    block_t *b = pool->classes[class].head;
+
+    if (b == NULL)
+    {
+        block_pool_Reclaim(pool);
+        b = pool->classes[class].head;
+    }
+
+    if (b != NULL)
+    {
+        pool->classes[class].head = b->p_next;
+        pool->classes[class].count--;
+        pool->hits++;
+    }
+    else
+    {
+        b = malloc(block_pool_AllocSize(class));
+        if (unlikely(b == NULL))
+            return NULL;
+        pool->misses++;
+    }
+
+    if ((pool->hits + pool->misses) >= BLOCK_POOL_STATS_PERIOD)
+        block_pool_FlushStats(pool);
+
+    block_pooled_t *pb = (block_pooled_t *)b;
+    pb->pool = pool;
+    pb->class = class;
+    atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+
+    block_Init(b, pb + 1, block_pool_AllocSize(class) - sizeof (*pb));
+    b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
+    b->p_buffer = (void *)(((uintptr_t)b->p_buffer) & ~(BLOCK_ALIGN - 1));
+    b->i_buffer = size;
+    b->pf_release = block_pool_Release;
+    return b;
+}
+
+void block_PoolStats(uint64_t *restrict hits, uint64_t *restrict misses)
+{
+    *hits = atomic_load_explicit(&block_pools.hits, memory_order_relaxed);
+    *misses = atomic_load_explicit(&block_pools.misses, memory_order_relaxed);
+}
+
 block_t *block_Alloc (size_t size)
 {
+    for (unsigned i = 0; i < BLOCK_POOL_CLASSES; i++)
+        if (size <= block_pool_sizes[i])
+        {
+            block_pool_t *pool = block_pool_Get();
+            if (likely(pool != NULL))
+                return block_pool_Alloc(pool, i, size);
+            break;
+        }
+
+    /* Odd size or no thread pool: plain heap allocation */
     /* 2 * BLOCK_PADDING: pre + post padding */
     const size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
                        + size;
@@ -337,6 +600,149 @@ block_t *block_shm_Alloc (void *addr, size_t length)
 }
 #endif
 
+typedef struct
+{
+    block_t *parent;
+    atomic_uint refs;
+} block_shared_t;
+
+typedef struct
+{
+    block_t self;
+    block_shared_t *shared;
+} block_slice_t;
+
+static void block_slice_Release (block_t *block)
+{
+    block_shared_t *shared = ((block_slice_t *)block)->shared;
+
+    block_Invalidate (block);
+    free (block);
+
+    if (atomic_fetch_sub_explicit (&shared->refs, 1,
+                                   memory_order_acq_rel) == 1)
+    {
+        block_Release (shared->parent);
+        free (shared);
+    }
+}
+
+static block_slice_t *block_slice_New (block_shared_t *shared,
+                                       uint8_t *start, uint8_t *end)
+{
+    block_slice_t *slice = malloc (sizeof (*slice));
+    if (unlikely(slice == NULL))
+        return NULL;
+
+    block_Init (&slice->self, start, end - start);
+    slice->self.pf_release = block_slice_Release;
+    slice->shared = shared;
+    atomic_fetch_add_explicit (&shared->refs, 1, memory_order_relaxed);
+    return slice;
+}
+
+/** Turns a block into a slice covering its whole buffer */
+static block_t *block_slice_Wrap (block_t *block)
+{
+    block_shared_t *shared = malloc (sizeof (*shared));
+    if (unlikely(shared == NULL))
+        return NULL;
+
+    shared->parent = block;
+    atomic_init (&shared->refs, 0);
+
+    block_slice_t *whole = block_slice_New (shared, block->p_start,
+                                            block->p_start + block->i_size);
+    if (unlikely(whole == NULL))
+    {
+        free (shared);
+        return NULL;
+    }
+
+    whole->self.p_buffer = block->p_buffer;
+    whole->self.i_buffer = block->i_buffer;
+    BlockMetaCopy (&whole->self, block);
+    block->p_next = NULL;
+    return &whole->self;
+}
+
+block_t *block_Split (block_t **pp_block, size_t size)
+{
+    block_t *block = *pp_block;
+
+    block_Check (block);
+    if (size >= block->i_buffer)
+    {
+        *pp_block = NULL;
+        return block;
+    }
+
+    if (block->pf_release != block_slice_Release)
+    {   /* Share the buffer of the original block */
+        block = block_slice_Wrap (block);
+        if (unlikely(block == NULL))
+            return NULL;
+    }
+
+    /* The slices do not overlap, so that they can both be reallocated */
+    block_shared_t *shared = ((block_slice_t *)block)->shared;
+    uint8_t *cut = block->p_buffer + size;
+    block_slice_t *head = block_slice_New (shared, block->p_start, cut);
+    if (unlikely(head == NULL))
+    {
+        *pp_block = block;
+        return NULL;
+    }
+
+    head->self.p_buffer = block->p_buffer;
+    head->self.i_buffer = size;
+    BlockMetaCopy (&head->self, block);
+    head->self.p_next = NULL;
+
+    block->i_size -= cut - block->p_start;
+    block->p_start = cut;
+    block->p_buffer = cut;
+    block->i_buffer -= size;
+    block->i_flags = 0;
+    block->i_nb_samples = 0;
+    block->i_pts = block->i_dts = VLC_TS_INVALID;
+    block->i_length = 0;
+
+    *pp_block = block;
+    return &head->self;
+}
+
+block_t *block_Share (block_t *block)
+{
+    block_Check (block);
+
+    if (block->pf_release == block_slice_Release)
+        return block;
+
+    block_t *whole = block_slice_Wrap (block);
+    return likely(whole != NULL) ? whole : block;
+}
+
+block_t *block_Clone (block_t *block)
+{
+    block_Check (block);
+
+    if (block->pf_release != block_slice_Release)
+        return block_Duplicate (block);
+
+    /* The clone has neither headroom nor tailroom, so that it is copied
+     * by block_Realloc() as soon as it grows */
+    block_shared_t *shared = ((block_slice_t *)block)->shared;
+    block_slice_t *clone = block_slice_New (shared, block->p_buffer,
+                                            block->p_buffer + block->i_buffer);
+    if (unlikely(clone == NULL))
+        return NULL;
+
+    BlockMetaCopy (&clone->self, block);
+    clone->self.p_next = NULL;
+    return &clone->self;
+}
+
 
 #ifdef _WIN32
 # include <io.h>
@@ -135,15 +135,20 @@ void vlc_CPU_init (void)
                    "cpuid\n\t" \
                    "xchgl %%ebx,%1\n\t" \
                    : "=a" (i_eax), "=r" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
-                   : "a" (reg) \
+                   : "a" (reg), "c" (0) \
                    : "cc");
 # else
 #  define cpuid(reg) \
      asm volatile ("cpuid\n\t" \
                    : "=a" (i_eax), "=b" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
-                   : "a" (reg) \
+                   : "a" (reg), "c" (0) \
                    : "cc");
 # endif
+    /* The OS must save the YMM registers for AVX to be usable */
+# define xgetbv(lo) \
+     asm volatile (".byte 0x0f, 0x01, 0xd0\n\t" /* xgetbv */ \
+                   : "=a" (lo), "=d" (i_edx) \
+                   : "c" (0));
      /* Check if the OS really supports the requested instructions */
 # if defined (__i386__) && !defined (__i486__) && !defined (__i586__) \
   && !defined (__i686__) && !defined (__pentium4__) \
@@ -171,6 +176,7 @@ void vlc_CPU_init (void)
 
     /* the CPU supports the CPUID instruction - get its level */
     cpuid( 0x00000000 );
+    const unsigned i_max_level = i_eax;
 
 # if defined (__i386__) && !defined (__i586__) \
   && !defined (__i686__) && !defined (__pentium4__) \
@@ -209,6 +215,23 @@ void vlc_CPU_init (void)
             i_capabilities |= VLC_CPU_SSE4_1;
         if (i_ecx & 0x00100000)
             i_capabilities |= VLC_CPU_SSE4_2;
+
+        /* AVX and OSXSAVE, then XMM and YMM states enabled in XCR0 */
+        if ((i_ecx & 0x18000000) == 0x18000000)
+        {
+            unsigned i_xcr0;
+            xgetbv (i_xcr0);
+            if ((i_xcr0 & 0x6) == 0x6)
+            {
+                i_capabilities |= VLC_CPU_AVX;
+                if (i_max_level >= 7)
+                {
+                    cpuid( 0x00000007 );
+                    if (i_ebx & 0x00000020)
+                        i_capabilities |= VLC_CPU_AVX2;
+                }
+            }
+        }
     }
 
     /* test for additional capabilities */
@@ -227,6 +250,15 @@ void vlc_CPU_init (void)
 
     if( b_amd && ( i_edx & 0x00400000 ) )
         i_capabilities |= VLC_CPU_MMXEXT;
+
+    /* XOP and FMA4 use the AVX register state */
+    if (i_capabilities & VLC_CPU_AVX)
+    {
+        if (i_ecx & 0x00000800)
+            i_capabilities |= VLC_CPU_XOP;
+        if (i_ecx & 0x00010000)
+            i_capabilities |= VLC_CPU_FMA4;
+    }
 out:
 
 #elif defined( __powerpc__ ) || defined( __ppc__ ) || defined( __powerpc64__ ) \
@@ -275,6 +307,16 @@ unsigned vlc_CPU (void)
 #endif
     return cpu_flags;
 }
+
+/**
+ * Turns capabilities off, e.g. to benchmark the fallback code paths.
+ * This applies to the whole process.
+ */
+void vlc_CPU_disable (unsigned flags)
+{
+    vlc_CPU ();
+    cpu_flags &= ~flags;
+}
 #endif
 
 void vlc_CPU_dump (vlc_object_t *obj)
@@ -99,59 +99,49 @@ static void vlc_epg_Clean( vlc_epg_t *p_epg )
     free( p_epg->psz_name );
 }
 
-bool vlc_epg_AddEvent( vlc_epg_t *p_epg, vlc_epg_event_t *p_evt )
+/**
+ * Returns the index of the first event starting at or after \p i_start.
+ * Events are kept sorted by start time.
+ */
+static size_t vlc_epg_Bisect( const vlc_epg_t *p_epg, int64_t i_start )
 {
-    ssize_t i_pos = -1;
+    size_t i_lower = 0;
+    size_t i_upper = p_epg->i_event;
 
-    /* Insertions are supposed in sequential order first */
-    if( p_epg->i_event )
+    while( i_lower < i_upper )
     {
-        if( p_epg->pp_event[0]->i_start > p_evt->i_start )
-        {
-            i_pos = 0;
-        }
-        else if ( p_epg->pp_event[p_epg->i_event - 1]->i_start >= p_evt->i_start )
-        {
-            /* Do bisect search lower start time entry */
-            size_t i_lower = 0;
-            size_t i_upper = p_epg->i_event - 1;
+        size_t i_split = ( i_lower + i_upper ) / 2;
 
-            while( i_lower < i_upper )
-            {
-                size_t i_split = ( i_lower + i_upper ) / 2;
-                vlc_epg_event_t *p_cur = p_epg->pp_event[i_split];
+        if( p_epg->pp_event[i_split]->i_start < i_start )
+            i_lower = i_split + 1;
+        else
+            i_upper = i_split;
+    }
+    return i_lower;
+}
 
-                if( p_cur->i_start < p_evt->i_start )
-                {
-                    i_lower = i_split + 1;
-                }
-                else if ( p_cur->i_start >= p_evt->i_start )
-                {
-                    i_upper = i_split;
-                }
-            }
-            i_pos = i_lower;
-        }
+bool vlc_epg_AddEvent( vlc_epg_t *p_epg, vlc_epg_event_t *p_evt )
+{
+    /* Insertions are supposed in sequential order first */
+    if( p_epg->i_event == 0 ||
+        p_epg->pp_event[p_epg->i_event - 1]->i_start < p_evt->i_start )
+    {
+        TAB_APPEND( p_epg->i_event, p_epg->pp_event, p_evt );
+        return true;
     }
 
-    if( i_pos != -1 )
+    size_t i_pos = vlc_epg_Bisect( p_epg, p_evt->i_start );
+
+    /* There can be only one event at same time */
+    if( p_epg->pp_event[i_pos]->i_start == p_evt->i_start )
     {
-        /* There can be only one event at same time */
-        if( p_epg->pp_event[i_pos]->i_start == p_evt->i_start )
-        {
-            vlc_epg_event_Delete( p_epg->pp_event[i_pos] );
-            if( p_epg->p_current == p_epg->pp_event[i_pos] )
-                p_epg->p_current = p_evt;
-            p_epg->pp_event[i_pos] = p_evt;
-            return true;
-        }
-        else
-        {
-            TAB_INSERT( p_epg->i_event, p_epg->pp_event, p_evt, i_pos );
-        }
+        vlc_epg_event_Delete( p_epg->pp_event[i_pos] );
+        if( p_epg->p_current == p_epg->pp_event[i_pos] )
+            p_epg->p_current = p_evt;
+        p_epg->pp_event[i_pos] = p_evt;
     }
     else
-        TAB_APPEND( p_epg->i_event, p_epg->pp_event, p_evt );
+        TAB_INSERT( p_epg->i_event, p_epg->pp_event, p_evt, i_pos );
 
     return true;
 }
@@ -172,32 +162,24 @@ void vlc_epg_Delete( vlc_epg_t *p_epg )
 
 void vlc_epg_SetCurrent( vlc_epg_t *p_epg, int64_t i_start )
 {
-    size_t i;
     p_epg->p_current = NULL;
     if( i_start < 0 )
         return;
 
-    for( i = 0; i < p_epg->i_event; i++ )
-    {
-        if( p_epg->pp_event[i]->i_start == i_start )
-        {
-            p_epg->p_current = p_epg->pp_event[i];
-            break;
-        }
-    }
+    size_t i = vlc_epg_Bisect( p_epg, i_start );
+    if( i < p_epg->i_event && p_epg->pp_event[i]->i_start == i_start )
+        p_epg->p_current = p_epg->pp_event[i];
 }
 
-static void vlc_epg_Prune( vlc_epg_t *p_dst )
+static bool vlc_epg_event_Overlaps( const vlc_epg_event_t *p_evt,
+                                    int64_t i_start, int64_t i_end )
 {
-    /* Keep only 1 old event  */
-    if( p_dst->p_current )
-    {
-        while( p_dst->i_event > 1 && p_dst->pp_event[0] != p_dst->p_current && p_dst->pp_event[1] != p_dst->p_current )
-        {
-            vlc_epg_event_Delete( p_dst->pp_event[0] );
-            TAB_ERASE( p_dst->i_event, p_dst->pp_event, 0 );
-        }
-    }
+    const int64_t i_evt_end = p_evt->i_start + p_evt->i_duration;
+
+    /* the event starts within [i_start, i_end) (or both are identical) */
+    return ( p_evt->i_start >= i_start && p_evt->i_start < i_end ) ||
+    /* the event ends within (i_start, i_end] */
+           ( i_evt_end > i_start && i_evt_end <= i_end );
 }
 
 void vlc_epg_Merge( vlc_epg_t *p_dst_epg, const vlc_epg_t *p_src_epg )
@@ -205,63 +187,85 @@ void vlc_epg_Merge( vlc_epg_t *p_dst_epg, const vlc_epg_t *p_src_epg )
     if( p_src_epg->i_event == 0 )
         return;
 
-    size_t i_dst=0;
-    size_t i_src=0;
-    for( ; i_src < p_src_epg->i_event; i_src++ )
+    /* Both tables are sorted: merge them in a single pass into a new table,
+     * rather than inserting and erasing entries in place. */
+    vlc_epg_event_t **pp_out = malloc( ( p_dst_epg->i_event +
+                                         p_src_epg->i_event ) *
+                                       sizeof(*pp_out) );
+    if( unlikely(!pp_out) )
+        return;
+
+    vlc_epg_event_t *p_current = p_dst_epg->p_current;
+    size_t i_out = 0;
+    size_t i_dst = 0;
+
+    for( size_t i_src = 0; i_src < p_src_epg->i_event; i_src++ )
     {
         bool b_current = ( p_src_epg->pp_event[i_src] == p_src_epg->p_current );
 
         vlc_epg_event_t *p_src = vlc_epg_event_Duplicate( p_src_epg->pp_event[i_src] );
         if( unlikely(!p_src) )
-            return;
+            break;
         const int64_t i_src_end = p_src->i_start + p_src->i_duration;
 
+        /* The previous appended event is replaced if they overlap */
+        if( i_src > 0 &&
+            vlc_epg_event_Overlaps( pp_out[i_out - 1], p_src->i_start, i_src_end ) )
+        {
+            vlc_epg_event_t *p_prev = pp_out[--i_out];
+            if( p_current == p_prev )
+            {
+                b_current = true;
+                p_current = NULL;
+            }
+            vlc_epg_event_Delete( p_prev );
+        }
+
         while( i_dst < p_dst_epg->i_event )
         {
             vlc_epg_event_t *p_dst = p_dst_epg->pp_event[i_dst];
-            const int64_t i_dst_end = p_dst->i_start + p_dst->i_duration;
 
             /* appended is before current, no overlap */
             if( p_dst->i_start >= i_src_end )
-            {
                 break;
-            }
-            /* overlap case: appended would contain current's start (or are identical) */
-            else if( ( p_dst->i_start >= p_src->i_start && p_dst->i_start < i_src_end ) ||
-            /* overlap case: appended would contain current's end */
-                    ( i_dst_end > p_src->i_start && i_dst_end <= i_src_end ) )
+
+            i_dst++;
+            if( vlc_epg_event_Overlaps( p_dst, p_src->i_start, i_src_end ) )
             {
-                vlc_epg_event_Delete( p_dst );
-                if( p_dst_epg->p_current == p_dst )
+                if( p_current == p_dst )
                 {
-                    b_current |= true;
-                    p_dst_epg->p_current = NULL;
+                    b_current = true;
+                    p_current = NULL;
                 }
-                TAB_ERASE( p_dst_epg->i_event, p_dst_epg->pp_event, i_dst );
+                vlc_epg_event_Delete( p_dst );
             }
             else
-            {
-                i_dst++;
-            }
+                pp_out[i_out++] = p_dst;
         }
 
-        TAB_INSERT( p_dst_epg->i_event, p_dst_epg->pp_event, p_src, i_dst );
+        pp_out[i_out++] = p_src;
         if( b_current )
-            p_dst_epg->p_current = p_src;
+            p_current = p_src;
     }
 
     /* Remaining/trailing ones */
-    for( ; i_src < p_src_epg->i_event; i_src++ )
+    while( i_dst < p_dst_epg->i_event )
+        pp_out[i_out++] = p_dst_epg->pp_event[i_dst++];
+
+    /* Keep only 1 old event */
+    size_t i_first = 0;
+    if( p_current )
     {
-        vlc_epg_event_t *p_src = vlc_epg_event_Duplicate( p_src_epg->pp_event[i_src] );
-        if( unlikely(!p_src) )
-            return;
-        TAB_APPEND( p_dst_epg->i_event, p_dst_epg->pp_event, p_src );
-        if( p_src_epg->pp_event[i_src] == p_src_epg->p_current )
-            p_dst_epg->p_current = p_src;
+        while( i_first + 1 < i_out && pp_out[i_first] != p_current &&
+               pp_out[i_first + 1] != p_current )
+            vlc_epg_event_Delete( pp_out[i_first++] );
+        memmove( pp_out, &pp_out[i_first], ( i_out - i_first ) * sizeof(*pp_out) );
     }
 
-    vlc_epg_Prune( p_dst_epg );
+    free( p_dst_epg->pp_event );
+    p_dst_epg->pp_event = pp_out;
+    p_dst_epg->i_event = i_out - i_first;
+    p_dst_epg->p_current = p_current;
 }
 
 vlc_epg_t * vlc_epg_Duplicate( const vlc_epg_t *p_src )
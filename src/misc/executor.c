@@ -0,0 +1,211 @@
+/*****************************************************************************
+ * executor.c: thread pool
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_executor.h>
+#include <vlc_interrupt.h>
+#include "libvlc.h"
+
+/* Time after which an idle thread exits */
+#define IDLE_TIMEOUT (5 * CLOCK_FREQ)
+
+struct vlc_executor
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /**< signaled when a task is submitted */
+    vlc_cond_t idle_wait; /**< signaled when a task or a thread ends */
+
+    struct vlc_runnable *first;
+    struct vlc_runnable **lastp;
+    unsigned pending; /**< number of tasks waiting */
+    unsigned running; /**< number of tasks running */
+
+    unsigned max_threads;
+    unsigned threads; /**< number of live threads */
+    unsigned idle; /**< number of threads waiting for a task */
+    int priority;
+    bool closing;
+};
+
+static void *Thread(void *data)
+{
+    vlc_executor_t *executor = data;
+
+    vlc_mutex_lock(&executor->lock);
+    for (;;)
+    {
+        mtime_t deadline = mdate() + IDLE_TIMEOUT;
+
+        while (executor->first == NULL && !executor->closing)
+        {
+            int timeout;
+
+            executor->idle++;
+            timeout = vlc_cond_timedwait(&executor->wait, &executor->lock,
+                                         deadline);
+            executor->idle--;
+            if (timeout)
+                break;
+        }
+
+        struct vlc_runnable *runnable = executor->first;
+        if (runnable == NULL || executor->closing)
+            break;
+
+        executor->first = runnable->next;
+        if (executor->first == NULL)
+            executor->lastp = &executor->first;
+        executor->pending--;
+        executor->running++;
+        vlc_mutex_unlock(&executor->lock);
+
+        /* The runnable may be destroyed as soon as it returns */
+        runnable->run(runnable->userdata);
+        vlc_interrupt_set(NULL);
+
+        vlc_mutex_lock(&executor->lock);
+        executor->running--;
+        if (executor->first == NULL && executor->running == 0)
+            vlc_cond_broadcast(&executor->idle_wait);
+    }
+
+    executor->threads--;
+    vlc_cond_broadcast(&executor->idle_wait);
+    vlc_mutex_unlock(&executor->lock);
+    return NULL;
+}
+
+vlc_executor_t *vlc_executor_New(unsigned max_threads, int priority)
+{
+    assert(max_threads > 0);
+
+    vlc_executor_t *executor = malloc(sizeof (*executor));
+    if (unlikely(executor == NULL))
+        return NULL;
+
+    vlc_mutex_init(&executor->lock);
+    vlc_cond_init(&executor->wait);
+    vlc_cond_init(&executor->idle_wait);
+    executor->first = NULL;
+    executor->lastp = &executor->first;
+    executor->pending = 0;
+    executor->running = 0;
+    executor->max_threads = max_threads;
+    executor->threads = 0;
+    executor->idle = 0;
+    executor->priority = priority;
+    executor->closing = false;
+    return executor;
+}
+
+void vlc_executor_Delete(vlc_executor_t *executor)
+{
+    vlc_mutex_lock(&executor->lock);
+    executor->closing = true;
+    executor->first = NULL;
+    executor->lastp = &executor->first;
+    executor->pending = 0;
+    vlc_cond_broadcast(&executor->wait);
+
+    while (executor->threads > 0)
+        vlc_cond_wait(&executor->idle_wait, &executor->lock);
+    vlc_mutex_unlock(&executor->lock);
+
+    vlc_cond_destroy(&executor->idle_wait);
+    vlc_cond_destroy(&executor->wait);
+    vlc_mutex_destroy(&executor->lock);
+    free(executor);
+}
+
+int vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+{
+    int ret = VLC_SUCCESS;
+
+    vlc_mutex_lock(&executor->lock);
+    assert(!executor->closing);
+
+    runnable->next = NULL;
+    *executor->lastp = runnable;
+    executor->lastp = &runnable->next;
+    executor->pending++;
+
+    /* Spawn a thread unless enough idle threads will pick the tasks up */
+    if (executor->pending > executor->idle
+     && executor->threads < executor->max_threads)
+    {
+        if (vlc_clone_detach(NULL, Thread, executor, executor->priority) == 0)
+            executor->threads++;
+        else if (executor->threads == 0)
+        {
+            /* Nobody would ever run it */
+            struct vlc_runnable **pp = &executor->first;
+            while (*pp != runnable)
+                pp = &(*pp)->next;
+            *pp = NULL;
+            executor->lastp = pp;
+            executor->pending--;
+            ret = VLC_EGENERIC;
+        }
+    }
+    vlc_cond_signal(&executor->wait);
+    vlc_mutex_unlock(&executor->lock);
+    return ret;
+}
+
+bool vlc_executor_Cancel(vlc_executor_t *executor,
+                         struct vlc_runnable *runnable)
+{
+    bool canceled = false;
+
+    vlc_mutex_lock(&executor->lock);
+    for (struct vlc_runnable **pp = &executor->first; *pp != NULL;
+         pp = &(*pp)->next)
+    {
+        if (*pp != runnable)
+            continue;
+
+        *pp = runnable->next;
+        if (runnable->next == NULL)
+            executor->lastp = pp;
+        executor->pending--;
+        canceled = true;
+        break;
+    }
+
+    if (executor->first == NULL && executor->running == 0)
+        vlc_cond_broadcast(&executor->idle_wait);
+    vlc_mutex_unlock(&executor->lock);
+    return canceled;
+}
+
+void vlc_executor_WaitIdle(vlc_executor_t *executor)
+{
+    vlc_mutex_lock(&executor->lock);
+    while (executor->first != NULL || executor->running > 0)
+        vlc_cond_wait(&executor->idle_wait, &executor->lock);
+    vlc_mutex_unlock(&executor->lock);
+}
@@ -30,8 +30,12 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_atomic.h>
 #include "libvlc.h"
 
+/** Slots count of the single-producer single-consumer ring (power of two) */
+#define FIFO_RING_SIZE 4096
+
 /**
  * Internal state for block queues
  */
@@ -44,8 +48,158 @@ struct block_fifo_t
     block_t             **pp_last;
     size_t              i_depth;
     size_t              i_size;
+
+    /* Single-producer single-consumer mode. Blocks go through a lock-free
+     * ring. If the ring is full, they are appended to the p_first list (under
+     * the lock) until the consumer has drained both the ring and the list. */
+    bool                spsc;
+    block_t             **ring;
+    atomic_bool         overflow; /**< Whether the p_first list is used */
+    atomic_bool         waiting; /**< Whether the consumer may be sleeping */
+
+    /* Producer side */
+    atomic_size_t       head; /**< Ring write index */
+    atomic_size_t       in_count;
+    atomic_size_t       in_bytes;
+
+    /* Consumer side */
+    atomic_size_t       tail; /**< Ring read index */
+    atomic_size_t       out_count;
+    atomic_size_t       out_bytes;
 };
 
+static void vlc_fifo_RingPush(vlc_fifo_t *fifo, block_t *block, bool locked)
+{
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+        size_t head = atomic_load_explicit(&fifo->head, memory_order_relaxed);
+        size_t tail = atomic_load_explicit(&fifo->tail, memory_order_acquire);
+
+        block->p_next = NULL;
+
+        if (!atomic_load_explicit(&fifo->overflow, memory_order_acquire)
+         && head - tail < FIFO_RING_SIZE)
+        {
+            fifo->ring[head & (FIFO_RING_SIZE - 1)] = block;
+            atomic_store_explicit(&fifo->head, head + 1, memory_order_release);
+        }
+        else
+        {   /* Ring full, or not drained yet since it was last full */
+            if (!locked)
+                vlc_mutex_lock(&fifo->lock);
+            *(fifo->pp_last) = block;
+            fifo->pp_last = &block->p_next;
+            atomic_store_explicit(&fifo->overflow, true, memory_order_release);
+            if (!locked)
+                vlc_mutex_unlock(&fifo->lock);
+        }
+
+        /* Accounting is updated after the block is visible to the consumer,
+         * so that a non-zero count guarantees a successful dequeue. */
+        atomic_fetch_add_explicit(&fifo->in_bytes, block->i_buffer,
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&fifo->in_count, 1, memory_order_release);
+        block = next;
+    }
+}
+
+static block_t *vlc_fifo_RingPeek(vlc_fifo_t *fifo, bool locked)
+{
+    size_t tail = atomic_load_explicit(&fifo->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&fifo->head, memory_order_acquire);
+
+    if (tail != head)
+        return fifo->ring[tail & (FIFO_RING_SIZE - 1)];
+
+    if (!atomic_load_explicit(&fifo->overflow, memory_order_acquire))
+        return NULL;
+
+    block_t *block;
+
+    if (!locked)
+        vlc_mutex_lock(&fifo->lock);
+    block = fifo->p_first;
+    if (!locked)
+        vlc_mutex_unlock(&fifo->lock);
+    return block;
+}
+
+static block_t *vlc_fifo_RingPop(vlc_fifo_t *fifo, bool locked)
+{
+    size_t tail = atomic_load_explicit(&fifo->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&fifo->head, memory_order_acquire);
+    block_t *block;
+
+    if (tail != head)
+    {
+        block = fifo->ring[tail & (FIFO_RING_SIZE - 1)];
+        atomic_store_explicit(&fifo->tail, tail + 1, memory_order_release);
+    }
+    else
+    {   /* The producer cannot use the ring while the overflow flag is set,
+         * so the ring is known empty until the list is drained. */
+        if (!atomic_load_explicit(&fifo->overflow, memory_order_acquire))
+            return NULL;
+
+        if (!locked)
+            vlc_mutex_lock(&fifo->lock);
+        block = fifo->p_first;
+        if (block != NULL)
+        {
+            fifo->p_first = block->p_next;
+            if (fifo->p_first == NULL)
+            {
+                fifo->pp_last = &fifo->p_first;
+                atomic_store_explicit(&fifo->overflow, false,
+                                      memory_order_release);
+            }
+        }
+        if (!locked)
+            vlc_mutex_unlock(&fifo->lock);
+
+        if (block == NULL)
+            return NULL;
+    }
+
+    block->p_next = NULL;
+    atomic_fetch_add_explicit(&fifo->out_bytes, block->i_buffer,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&fifo->out_count, 1, memory_order_release);
+    return block;
+}
+
+static size_t vlc_fifo_RingDiff(const atomic_size_t *in,
+                                const atomic_size_t *out)
+{
+    size_t o = atomic_load_explicit(out, memory_order_acquire);
+    size_t i = atomic_load_explicit(in, memory_order_acquire);
+
+    /* Both counters are updated independently: never report a negative. */
+    return (i - o <= SIZE_MAX / 2) ? i - o : 0;
+}
+
+/** Wakes the consumer up if it is (or might be about to go) sleeping. */
+static void vlc_fifo_RingWake(vlc_fifo_t *fifo)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&fifo->waiting, memory_order_relaxed))
+    {
+        vlc_mutex_lock(&fifo->lock);
+        vlc_cond_signal(&fifo->wait);
+        vlc_mutex_unlock(&fifo->lock);
+    }
+}
+
+/** Announces that the consumer is about to sleep.
+ *  @return true if the FIFO is still empty, false if data has arrived */
+static bool vlc_fifo_RingPrepareWait(vlc_fifo_t *fifo)
+{
+    atomic_store_explicit(&fifo->waiting, true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    return vlc_fifo_RingDiff(&fifo->in_count, &fifo->out_count) == 0;
+}
+
 void vlc_fifo_Lock(vlc_fifo_t *fifo)
 {
     vlc_mutex_lock(&fifo->lock);
@@ -68,27 +222,55 @@ void vlc_fifo_Wait(vlc_fifo_t *fifo)
 
 void vlc_fifo_WaitCond(vlc_fifo_t *fifo, vlc_cond_t *condvar)
 {
+    if (fifo->spsc)
+    {
+        if (vlc_fifo_RingPrepareWait(fifo))
+            vlc_cond_wait(condvar, &fifo->lock);
+        atomic_store_explicit(&fifo->waiting, false, memory_order_relaxed);
+        return;
+    }
     vlc_cond_wait(condvar, &fifo->lock);
 }
 
 int vlc_fifo_TimedWaitCond(vlc_fifo_t *fifo, vlc_cond_t *condvar, mtime_t deadline)
 {
+    if (fifo->spsc)
+    {
+        int ret = 0;
+
+        if (vlc_fifo_RingPrepareWait(fifo))
+            ret = vlc_cond_timedwait(condvar, &fifo->lock, deadline);
+        atomic_store_explicit(&fifo->waiting, false, memory_order_relaxed);
+        return ret;
+    }
     return vlc_cond_timedwait(condvar, &fifo->lock, deadline);
 }
 
 size_t vlc_fifo_GetCount(const vlc_fifo_t *fifo)
 {
+    if (fifo->spsc)
+        return vlc_fifo_RingDiff(&fifo->in_count, &fifo->out_count);
     return fifo->i_depth;
 }
 
 size_t vlc_fifo_GetBytes(const vlc_fifo_t *fifo)
 {
+    if (fifo->spsc)
+        return vlc_fifo_RingDiff(&fifo->in_bytes, &fifo->out_bytes);
     return fifo->i_size;
 }
 
 void vlc_fifo_QueueUnlocked(block_fifo_t *fifo, block_t *block)
 {
     vlc_assert_locked(&fifo->lock);
+
+    if (fifo->spsc)
+    {
+        vlc_fifo_RingPush(fifo, block, true);
+        vlc_fifo_Signal(fifo);
+        return;
+    }
+
     assert(*(fifo->pp_last) == NULL);
 
     *(fifo->pp_last) = block;
@@ -109,6 +291,9 @@ block_t *vlc_fifo_DequeueUnlocked(block_fifo_t *fifo)
 {
     vlc_assert_locked(&fifo->lock);
 
+    if (fifo->spsc)
+        return vlc_fifo_RingPop(fifo, true);
+
     block_t *block = fifo->p_first;
 
     if (block == NULL)
@@ -131,6 +316,15 @@ block_t *vlc_fifo_DequeueAllUnlocked(block_fifo_t *fifo)
 {
     vlc_assert_locked(&fifo->lock);
 
+    if (fifo->spsc)
+    {
+        block_t *head = NULL, **pp = &head, *block;
+
+        while ((block = vlc_fifo_RingPop(fifo, true)) != NULL)
+            block_ChainLastAppend(&pp, block);
+        return head;
+    }
+
     block_t *block = fifo->p_first;
 
     fifo->p_first = NULL;
@@ -141,24 +335,65 @@ block_t *vlc_fifo_DequeueAllUnlocked(block_fifo_t *fifo)
     return block;
 }
 
-block_fifo_t *block_FifoNew( void )
+static block_fifo_t *block_FifoCreate(bool spsc)
 {
     block_fifo_t *p_fifo = malloc( sizeof( block_fifo_t ) );
     if( !p_fifo )
         return NULL;
 
+    p_fifo->spsc = spsc;
+    if( spsc )
+    {
+        p_fifo->ring = malloc( FIFO_RING_SIZE * sizeof( *p_fifo->ring ) );
+        if( unlikely(p_fifo->ring == NULL) )
+        {
+            free( p_fifo );
+            return NULL;
+        }
+    }
+    else
+        p_fifo->ring = NULL;
+
     vlc_mutex_init( &p_fifo->lock );
     vlc_cond_init( &p_fifo->wait );
     p_fifo->p_first = NULL;
     p_fifo->pp_last = &p_fifo->p_first;
     p_fifo->i_depth = p_fifo->i_size = 0;
 
+    atomic_init( &p_fifo->overflow, false );
+    atomic_init( &p_fifo->waiting, false );
+    atomic_init( &p_fifo->head, 0 );
+    atomic_init( &p_fifo->in_count, 0 );
+    atomic_init( &p_fifo->in_bytes, 0 );
+    atomic_init( &p_fifo->tail, 0 );
+    atomic_init( &p_fifo->out_count, 0 );
+    atomic_init( &p_fifo->out_bytes, 0 );
+
     return p_fifo;
 }
 
+block_fifo_t *block_FifoNew( void )
+{
+    return block_FifoCreate( false );
+}
+
+block_fifo_t *block_FifoNewSPSC( void )
+{
+    return block_FifoCreate( true );
+}
+
 void block_FifoRelease( block_fifo_t *p_fifo )
 {
-    block_ChainRelease( p_fifo->p_first );
+    if( p_fifo->spsc )
+    {
+        block_t *p_block;
+
+        while( (p_block = vlc_fifo_RingPop( p_fifo, true )) != NULL )
+            block_Release( p_block );
+        free( p_fifo->ring );
+    }
+    else
+        block_ChainRelease( p_fifo->p_first );
     vlc_cond_destroy( &p_fifo->wait );
     vlc_mutex_destroy( &p_fifo->lock );
     free( p_fifo );
@@ -176,6 +411,13 @@ void block_FifoEmpty(block_fifo_t *fifo)
 
 void block_FifoPut(block_fifo_t *fifo, block_t *block)
 {
+    if (fifo->spsc)
+    {   /* Lock-free unless the ring overflows or the consumer sleeps */
+        vlc_fifo_RingPush(fifo, block, false);
+        vlc_fifo_RingWake(fifo);
+        return;
+    }
+
     vlc_fifo_Lock(fifo);
     vlc_fifo_QueueUnlocked(fifo, block);
     vlc_fifo_Unlock(fifo);
@@ -187,6 +429,13 @@ block_t *block_FifoGet(block_fifo_t *fifo)
 
     vlc_testcancel();
 
+    if (fifo->spsc)
+    {
+        block = vlc_fifo_RingPop(fifo, false);
+        if (likely(block != NULL))
+            return block;
+    }
+
     vlc_fifo_Lock(fifo);
     while (vlc_fifo_IsEmpty(fifo))
     {
@@ -204,6 +453,13 @@ block_t *block_FifoShow( block_fifo_t *p_fifo )
 {
     block_t *b;
 
+    if( p_fifo->spsc )
+    {
+        b = vlc_fifo_RingPeek( p_fifo, false );
+        assert(b != NULL);
+        return b;
+    }
+
     vlc_mutex_lock( &p_fifo->lock );
     assert(p_fifo->p_first != NULL);
     b = p_fifo->p_first;
@@ -217,6 +473,9 @@ size_t block_FifoSize (block_fifo_t *fifo)
 {
     size_t size;
 
+    if (fifo->spsc)
+        return vlc_fifo_GetBytes(fifo);
+
     vlc_mutex_lock (&fifo->lock);
     size = fifo->i_size;
     vlc_mutex_unlock (&fifo->lock);
@@ -228,6 +487,9 @@ size_t block_FifoCount (block_fifo_t *fifo)
 {
     size_t depth;
 
+    if (fifo->spsc)
+        return vlc_fifo_GetCount(fifo);
+
     vlc_mutex_lock (&fifo->lock);
     depth = fifo->i_depth;
     vlc_mutex_unlock (&fifo->lock);
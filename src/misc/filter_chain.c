@@ -30,6 +30,7 @@
 #include <vlc_spu.h>
 #include <libvlc.h>
 #include <assert.h>
+#include "slices.h"
 
 typedef struct chained_filter_t
 {
@@ -59,6 +60,8 @@ struct filter_chain_t
     es_format_t fmt_out; /**< Chain current output format */
     unsigned length; /**< Number of filters */
     bool b_allow_fmt_out_change; /**< Can the output format be changed? */
+    bool b_slices_failed; /**< Threads could not be created */
+    vlc_slices_t *slices; /**< Threads for sliced filters (created on use) */
     char psz_capability[]; /**< Module capability for all chained filters */
 };
 
@@ -86,6 +89,8 @@ static filter_chain_t *filter_chain_NewInner( const filter_owner_t *callbacks,
     es_format_Init( &chain->fmt_out, UNKNOWN_ES, 0 );
     chain->length = 0;
     chain->b_allow_fmt_out_change = fmt_out_change;
+    chain->b_slices_failed = false;
+    chain->slices = NULL;
     strcpy( chain->psz_capability, cap );
 
     return chain;
@@ -105,12 +110,139 @@ filter_chain_t *filter_chain_New( vlc_object_t *obj, const char *cap,
     return filter_chain_NewInner( &callbacks, cap, fmt_out_change, NULL );
 }
 
+/*
+ * Pixel buffers of the intermediate pictures are recycled: once a picture is
+ * released, its buffer is kept for the next picture of the same size, from
+ * any video filter chain. The buffers are freed with the last chain.
+ */
+#define RECYCLED_MAX 8
+#define RECYCLED_ALIGN 64
+
+static vlc_mutex_t recycled_lock = VLC_STATIC_MUTEX;
+static struct
+{
+    uint8_t *pixels;
+    size_t size;
+} recycled[RECYCLED_MAX];
+static unsigned recycled_count = 0;
+static unsigned recycled_users = 0; /**< number of video filter chains */
+
+static size_t RecycledSize( const picture_t *pic )
+{
+    size_t size = 0;
+
+    for( int i = 0; i < pic->i_planes; i++ )
+    {
+        const plane_t *p = &pic->p[i];
+
+        if( p->i_pitch < 0 || p->i_lines <= 0 ||
+            (size_t)p->i_pitch > (SIZE_MAX - size) / p->i_lines )
+            return 0;
+        size += p->i_pitch * p->i_lines;
+    }
+    return size;
+}
+
+static void RecycledPictureDestroy( picture_t *pic )
+{
+    uint8_t *pixels = pic->p[0].p_pixels;
+    size_t size = RecycledSize( pic );
+
+    free( pic );
+
+    vlc_mutex_lock( &recycled_lock );
+    if( recycled_users > 0 )
+    {
+        /* Evict the least recently recycled buffer if needed */
+        if( recycled_count == RECYCLED_MAX )
+        {
+            vlc_free( recycled[0].pixels );
+            memmove( recycled, recycled + 1,
+                     --recycled_count * sizeof (recycled[0]) );
+        }
+        recycled[recycled_count].pixels = pixels;
+        recycled[recycled_count].size = size;
+        recycled_count++;
+        pixels = NULL;
+    }
+    vlc_mutex_unlock( &recycled_lock );
+    vlc_free( pixels );
+}
+
+static picture_t *RecycledPictureNew( const video_format_t *fmt )
+{
+    picture_t layout;
+    picture_resource_t res = {
+        .pf_destroy = RecycledPictureDestroy,
+    };
+
+    memset( &layout, 0, sizeof (layout) );
+    if( picture_Setup( &layout, fmt ) )
+        return NULL;
+
+    size_t size = RecycledSize( &layout );
+    if( size == 0 )
+        return NULL;
+
+    uint8_t *pixels = NULL;
+
+    vlc_mutex_lock( &recycled_lock );
+    for( unsigned i = recycled_count; i-- > 0; )
+        if( recycled[i].size == size )
+        {
+            pixels = recycled[i].pixels;
+            memmove( recycled + i, recycled + i + 1,
+                     (--recycled_count - i) * sizeof (recycled[0]) );
+            break;
+        }
+    vlc_mutex_unlock( &recycled_lock );
+
+    if( pixels == NULL )
+    {
+        pixels = vlc_memalign( RECYCLED_ALIGN, size );
+        if( unlikely(pixels == NULL) )
+            return NULL;
+    }
+
+    for( int i = 0; i < layout.i_planes; i++ )
+    {
+        res.p[i].p_pixels = pixels;
+        res.p[i].i_lines = layout.p[i].i_lines;
+        res.p[i].i_pitch = layout.p[i].i_pitch;
+        pixels += layout.p[i].i_pitch * layout.p[i].i_lines;
+    }
+
+    picture_t *pic = picture_NewFromResource( fmt, &res );
+    if( unlikely(pic == NULL) )
+        vlc_free( res.p[0].p_pixels );
+    return pic;
+}
+
+static void RecycledHold( void )
+{
+    vlc_mutex_lock( &recycled_lock );
+    recycled_users++;
+    vlc_mutex_unlock( &recycled_lock );
+}
+
+static void RecycledRelease( void )
+{
+    vlc_mutex_lock( &recycled_lock );
+    assert( recycled_users > 0 );
+    if( --recycled_users == 0 )
+    {
+        while( recycled_count > 0 )
+            vlc_free( recycled[--recycled_count].pixels );
+    }
+    vlc_mutex_unlock( &recycled_lock );
+}
+
 /** Chained filter picture allocator function */
 static picture_t *filter_chain_VideoBufferNew( filter_t *filter )
 {
     if( chained(filter)->next != NULL )
     {
-        picture_t *pic = picture_NewFromFormat( &filter->fmt_out.video );
+        picture_t *pic = RecycledPictureNew( &filter->fmt_out.video );
         if( pic == NULL )
             msg_Err( filter, "Failed to allocate picture" );
         return pic;
@@ -127,6 +259,55 @@ static picture_t *filter_chain_VideoBufferNew( filter_t *filter )
     }
 }
 
+struct filter_chain_slice
+{
+    filter_t *filter;
+    void (*cb)( filter_t *, void *, unsigned, unsigned );
+    void *opaque;
+};
+
+static void filter_chain_VideoSlice( void *data, unsigned index,
+                                     unsigned count )
+{
+    struct filter_chain_slice *slice = data;
+
+    slice->cb( slice->filter, slice->opaque, index, count );
+}
+
+/** Chained filter bands processing function */
+static void filter_chain_VideoRunSlices( filter_t *filter,
+    void (*cb)( filter_t *, void *, unsigned, unsigned ), void *opaque )
+{
+    filter_chain_t *chain = filter->owner.sys;
+
+    if( chain->slices == NULL && !chain->b_slices_failed )
+    {
+        unsigned cpus = vlc_GetCPUCount();
+
+        /* The threads are only spawned once a filter needs them */
+        if( cpus > 1 )
+            chain->slices = vlc_slices_New( __MIN(cpus, 16) - 1 );
+        if( chain->slices != NULL )
+            msg_Dbg( filter, "processing bands with %u threads",
+                     vlc_slices_Count( chain->slices ) );
+        else
+            chain->b_slices_failed = true;
+    }
+
+    if( chain->slices == NULL )
+    {
+        cb( filter, opaque, 0, 1 );
+        return;
+    }
+
+    struct filter_chain_slice slice = {
+        .filter = filter,
+        .cb = cb,
+        .opaque = opaque,
+    };
+    vlc_slices_Run( chain->slices, filter_chain_VideoSlice, &slice );
+}
+
 #undef filter_chain_NewVideo
 filter_chain_t *filter_chain_NewVideo( vlc_object_t *obj, bool allow_change,
                                        const filter_owner_t *restrict owner )
@@ -135,11 +316,15 @@ filter_chain_t *filter_chain_NewVideo( vlc_object_t *obj, bool allow_change,
         .sys = obj,
         .video = {
             .buffer_new = filter_chain_VideoBufferNew,
+            .run_slices = filter_chain_VideoRunSlices,
         },
     };
 
-    return filter_chain_NewInner( &callbacks, "video filter", allow_change,
-                                  owner );
+    filter_chain_t *chain = filter_chain_NewInner( &callbacks, "video filter",
+                                                   allow_change, owner );
+    if( chain != NULL )
+        RecycledHold();
+    return chain;
 }
 
 /**
@@ -153,6 +338,10 @@ void filter_chain_Delete( filter_chain_t *p_chain )
     es_format_Clean( &p_chain->fmt_in );
     es_format_Clean( &p_chain->fmt_out );
 
+    if( p_chain->slices != NULL )
+        vlc_slices_Delete( p_chain->slices );
+    if( p_chain->callbacks.video.buffer_new == filter_chain_VideoBufferNew )
+        RecycledRelease();
     free( p_chain );
 }
 /**
@@ -176,6 +365,97 @@ void filter_chain_Reset( filter_chain_t *p_chain, const es_format_t *p_fmt_in,
     }
 }
 
+/*
+ * Modules found by probing for a conversion are remembered process-wide, so
+ * that a chain rebuilt for the same conversion (e.g. after a resolution
+ * change) loads the known module first instead of trying every candidate.
+ */
+#define CONVERTERS_MAX 16
+
+static vlc_mutex_t converters_lock = VLC_STATIC_MUTEX;
+static struct converter_entry
+{
+    char capability[16];
+    vlc_fourcc_t in, out;
+    bool scaled; /**< whether the picture size or orientation changes */
+    bool fmt_out_change;
+    char module[32]; /**< module object name */
+} converters[CONVERTERS_MAX];
+static unsigned converters_count = 0;
+
+static void ConverterKey( struct converter_entry *key, const filter_t *filter,
+                          const char *cap )
+{
+    const video_format_t *in = &filter->fmt_in.video;
+    const video_format_t *out = &filter->fmt_out.video;
+
+    memset( key, 0, sizeof (*key) );
+    strncpy( key->capability, cap, sizeof (key->capability) - 1 );
+    key->in = filter->fmt_in.i_codec;
+    key->out = filter->fmt_out.i_codec;
+    key->scaled = in->i_width != out->i_width
+               || in->i_height != out->i_height
+               || in->i_visible_width != out->i_visible_width
+               || in->i_visible_height != out->i_visible_height
+               || in->orientation != out->orientation;
+    key->fmt_out_change = filter->b_allow_fmt_out_change;
+}
+
+static bool ConverterMatch( const struct converter_entry *a,
+                            const struct converter_entry *b )
+{
+    return a->in == b->in && a->out == b->out && a->scaled == b->scaled
+        && a->fmt_out_change == b->fmt_out_change
+        && !strcmp( a->capability, b->capability );
+}
+
+/** Looks up the module previously used for a conversion */
+static bool ConverterLookup( const struct converter_entry *key,
+                             char *module )
+{
+    bool found = false;
+
+    vlc_mutex_lock( &converters_lock );
+    for( unsigned i = 0; i < converters_count; i++ )
+        if( ConverterMatch( &converters[i], key ) )
+        {
+            strcpy( module, converters[i].module );
+            found = true;
+            break;
+        }
+    vlc_mutex_unlock( &converters_lock );
+    return found;
+}
+
+/** Remembers (or forgets, if module is NULL) the module for a conversion */
+static void ConverterStore( const struct converter_entry *key,
+                            const char *module )
+{
+    if( module != NULL && strlen( module ) >= sizeof (key->module) )
+        return;
+
+    vlc_mutex_lock( &converters_lock );
+    for( unsigned i = 0; i < converters_count; i++ )
+        if( ConverterMatch( &converters[i], key ) )
+        {
+            memmove( converters + i, converters + i + 1,
+                     (--converters_count - i) * sizeof (converters[0]) );
+            break;
+        }
+
+    if( module != NULL )
+    {
+        /* Evict the oldest entry if needed */
+        if( converters_count == CONVERTERS_MAX )
+            memmove( converters, converters + 1,
+                     --converters_count * sizeof (converters[0]) );
+        converters[converters_count] = *key;
+        strcpy( converters[converters_count].module, module );
+        converters_count++;
+    }
+    vlc_mutex_unlock( &converters_lock );
+}
+
 filter_t *filter_chain_AppendFilter( filter_chain_t *chain, const char *name,
                                      config_chain_t *cfg,
                                      const es_format_t *fmt_in,
@@ -208,8 +488,33 @@ filter_t *filter_chain_AppendFilter( filter_chain_t *chain, const char *name,
     filter->owner = chain->callbacks;
     filter->owner.sys = chain;
 
-    filter->p_module = module_need( filter, chain->psz_capability, name,
-                                    name != NULL );
+    if( name != NULL )
+        filter->p_module = module_need( filter, chain->psz_capability, name,
+                                        true );
+    else
+    {   /* Conversion: try the module that did it last time first */
+        struct converter_entry key;
+        char module[sizeof (key.module)];
+
+        ConverterKey( &key, filter, chain->psz_capability );
+        filter->p_module = NULL;
+        if( ConverterLookup( &key, module ) )
+        {
+            filter->p_module = module_need( filter, chain->psz_capability,
+                                            module, true );
+            if( filter->p_module == NULL )
+                ConverterStore( &key, NULL );
+        }
+
+        if( filter->p_module == NULL )
+        {
+            filter->p_module = module_need( filter, chain->psz_capability,
+                                            NULL, false );
+            if( filter->p_module != NULL )
+                ConverterStore( &key,
+                                module_get_object( filter->p_module ) );
+        }
+    }
     if( filter->p_module == NULL )
         goto error;
 
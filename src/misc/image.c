@@ -142,6 +142,10 @@ static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
         }
     }
 
+    /* Some decoders can directly decode at a lower resolution */
+    var_SetInteger( p_image->p_dec, "image-output-width", p_fmt_out->i_width );
+    var_SetInteger( p_image->p_dec, "image-output-height", p_fmt_out->i_height );
+
     p_block->i_pts = p_block->i_dts = mdate();
     while( (p_tmp = p_image->p_dec->pf_decode_video( p_image->p_dec, &p_block ))
              != NULL )
@@ -616,6 +620,10 @@ static decoder_t *CreateDecoder( vlc_object_t *p_this, video_format_t *fmt )
     p_dec->pf_vout_format_update = video_update_format;
     p_dec->pf_vout_buffer_new = video_new_buffer;
 
+    /* Wanted size of the decoded image, 0 if unknown */
+    var_Create( p_dec, "image-output-width", VLC_VAR_INTEGER );
+    var_Create( p_dec, "image-output-height", VLC_VAR_INTEGER );
+
     /* Find a suitable decoder module */
     p_dec->p_module = module_need( p_dec, "decoder", "$codec", false );
     if( !p_dec->p_module )
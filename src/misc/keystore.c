@@ -285,21 +285,30 @@ smb_split_domain(vlc_credential *p_credential)
     }
 }
 
+/* Fill the values used to look up a credential (the path is not matched) */
 static void
-credential_find_keystore(vlc_credential *p_credential, vlc_keystore *p_keystore)
+credential_lookup_values(vlc_credential *p_credential,
+                         const char *ppsz_values[KEY_MAX], char psz_port[21])
 {
     const vlc_url_t *p_url = p_credential->p_url;
 
-    const char *ppsz_values[KEY_MAX] = { 0 };
     ppsz_values[KEY_PROTOCOL] = p_url->psz_protocol;
     ppsz_values[KEY_USER] = p_credential->psz_username;
     ppsz_values[KEY_SERVER] = p_url->psz_host;
-    /* don't try to match with the path */
     ppsz_values[KEY_REALM] = p_credential->psz_realm;
     ppsz_values[KEY_AUTHTYPE] = p_credential->psz_authtype;
-    char psz_port[21];
     if (protocol_set_port(p_url, psz_port))
         ppsz_values[KEY_PORT] = psz_port;
+}
+
+static void
+credential_find_keystore(vlc_credential *p_credential, vlc_keystore *p_keystore)
+{
+    const vlc_url_t *p_url = p_credential->p_url;
+
+    const char *ppsz_values[KEY_MAX] = { 0 };
+    char psz_port[21];
+    credential_lookup_values(p_credential, ppsz_values, psz_port);
 
     vlc_keystore_entry *p_entries;
     unsigned int i_entries_count;
@@ -386,6 +395,21 @@ vlc_credential_get(vlc_credential *p_credential, vlc_object_t *p_parent,
         return false;
     }
 
+    if (p_credential->b_from_keystore
+     && p_credential->i_get_order == GET_FROM_KEYSTORE)
+    {
+        /* The credential found in the memory keystore was rejected: forget
+         * it, so that other connections do not try it again */
+        vlc_keystore *p_keystore = get_memory_keystore(p_parent);
+        if (p_keystore != NULL)
+        {
+            const char *ppsz_values[KEY_MAX] = { 0 };
+            char psz_port[21];
+            credential_lookup_values(p_credential, ppsz_values, psz_port);
+            vlc_keystore_remove(p_keystore, ppsz_values);
+        }
+    }
+
     p_credential->b_from_keystore = false;
     /* Don't set username to NULL, we may want to use the last one set */
     p_credential->psz_password = NULL;
@@ -508,12 +532,22 @@ vlc_credential_store(vlc_credential *p_credential, vlc_object_t *p_parent)
 {
     if (!is_credential_valid(p_credential))
         return false;
-    /* Don't need to store again */
-    if (p_credential->b_from_keystore)
-        return p_credential->b_from_keystore;
 
     vlc_keystore *p_keystore;
-    if (p_credential->b_store)
+    if (p_credential->b_from_keystore)
+    {
+        /* Don't need to store again */
+        if (p_credential->i_get_order == GET_FROM_KEYSTORE)
+            return true;
+
+        /* Cache the credential of the permanent keystore in the memory one,
+         * so that next connections do not query the (possibly slow, e.g.
+         * D-Bus) permanent keystore again */
+        p_keystore = get_memory_keystore(p_parent);
+        if (p_keystore == NULL)
+            return true;
+    }
+    else if (p_credential->b_store)
     {
         /* Store in permanent keystore */
         assert(p_credential->p_keystore != NULL);
@@ -578,5 +612,5 @@ vlc_credential_store(vlc_credential *p_credential, vlc_object_t *p_parent)
                                     -1, psz_label) == VLC_SUCCESS;
     free(psz_label);
     free(psz_path);
-    return b_ret;
+    return b_ret || p_credential->b_from_keystore;
 }
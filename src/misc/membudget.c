@@ -0,0 +1,174 @@
+/*****************************************************************************
+ * membudget.c: process-wide memory budget
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_membudget.h>
+
+struct vlc_mem_consumer
+{
+    vlc_object_t *obj;
+    const char *name;
+    size_t used;
+    size_t peak;
+    unsigned refused;
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    size_t budget; /**< in bytes, 0 if unlimited */
+    size_t used; /**< total of all consumers */
+    unsigned consumers;
+    atomic_bool pressure;
+} mem = { VLC_STATIC_MUTEX, 0, 0, 0, ATOMIC_VAR_INIT(false) };
+
+/**
+ * Updates the pressure state. Pressure starts once a request is refused or
+ * the usage reaches 7/8 of the budget, and ends below 3/4 of the budget, so
+ * that consumers hovering around the limit do not flip it back and forth.
+ */
+static void UpdatePressure(bool refused)
+{
+    bool pressure;
+
+    if (mem.budget == 0)
+        pressure = false;
+    else if (refused || mem.used >= mem.budget - mem.budget / 8)
+        pressure = true;
+    else if (mem.used < mem.budget - mem.budget / 4)
+        pressure = false;
+    else
+        return;
+
+    atomic_store_explicit(&mem.pressure, pressure, memory_order_relaxed);
+}
+
+#undef vlc_mem_consumer_New
+vlc_mem_consumer_t *vlc_mem_consumer_New(vlc_object_t *obj, const char *name)
+{
+    vlc_mem_consumer_t *c = malloc(sizeof (*c));
+    if (unlikely(c == NULL))
+        return NULL;
+
+    c->obj = obj;
+    c->name = name;
+    c->used = 0;
+    c->peak = 0;
+    c->refused = 0;
+
+    int64_t budget = var_InheritInteger(obj, "mem-budget");
+    if (budget < 0)
+        budget = 0;
+
+    vlc_mutex_lock(&mem.lock);
+    /* The budget is a process-wide setting: the last one wins */
+    mem.budget = (size_t)budget << 20;
+    mem.consumers++;
+    UpdatePressure(false);
+    vlc_mutex_unlock(&mem.lock);
+    return c;
+}
+
+void vlc_mem_consumer_Delete(vlc_mem_consumer_t *c)
+{
+    if (c->used > 0)
+        msg_Warn(c->obj, "%s still holds %zu bytes", c->name, c->used);
+
+    vlc_mutex_lock(&mem.lock);
+    assert(mem.used >= c->used);
+    mem.used -= c->used;
+    assert(mem.consumers > 0);
+    mem.consumers--;
+    UpdatePressure(false);
+    vlc_mutex_unlock(&mem.lock);
+
+    msg_Dbg(c->obj, "%s peak memory usage: %zu KiB, %u request(s) refused",
+            c->name, c->peak >> 10, c->refused);
+    free(c);
+}
+
+bool vlc_mem_Take(vlc_mem_consumer_t *c, size_t size)
+{
+    bool ok;
+
+    vlc_mutex_lock(&mem.lock);
+    ok = mem.budget == 0
+      || (mem.used + size >= mem.used && mem.used + size <= mem.budget);
+    if (ok)
+    {
+        mem.used += size;
+        c->used += size;
+        if (c->used > c->peak)
+            c->peak = c->used;
+    }
+    else
+        c->refused++;
+    UpdatePressure(!ok);
+    vlc_mutex_unlock(&mem.lock);
+    return ok;
+}
+
+void vlc_mem_Charge(vlc_mem_consumer_t *c, size_t size)
+{
+    vlc_mutex_lock(&mem.lock);
+    mem.used += size;
+    c->used += size;
+    if (c->used > c->peak)
+        c->peak = c->used;
+    UpdatePressure(false);
+    vlc_mutex_unlock(&mem.lock);
+}
+
+void vlc_mem_Give(vlc_mem_consumer_t *c, size_t size)
+{
+    vlc_mutex_lock(&mem.lock);
+    assert(c->used >= size && mem.used >= size);
+    c->used -= size;
+    mem.used -= size;
+    UpdatePressure(false);
+    vlc_mutex_unlock(&mem.lock);
+}
+
+bool vlc_mem_ShouldShrink(vlc_mem_consumer_t *c)
+{
+    bool shrink;
+
+    if (!vlc_mem_UnderPressure())
+        return false;
+
+    vlc_mutex_lock(&mem.lock);
+    assert(mem.consumers > 0);
+    shrink = c->used > mem.budget / mem.consumers;
+    vlc_mutex_unlock(&mem.lock);
+    return shrink;
+}
+
+bool vlc_mem_UnderPressure(void)
+{
+    return atomic_load_explicit(&mem.pressure, memory_order_relaxed);
+}
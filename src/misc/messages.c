@@ -286,6 +286,174 @@ static void vlc_LogEarlyClose(vlc_logger_t *logger, void *d)
     free(sys);
 }
 
+/* Asynchronous logging: messages are formatted by the emitting thread, then
+ * passed to the logger by a dedicated thread, so that slow loggers do not
+ * stall the decoder or output threads. */
+#define VLC_LOG_ASYNC_MAX 4096 /* queued messages before dropping */
+
+typedef struct
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    vlc_thread_t thread;
+    vlc_log_early_t *head;
+    vlc_log_early_t **tailp;
+    unsigned count;
+    unsigned dropped;
+    bool quit;
+
+    vlc_log_cb cb;
+    void *opaque;
+} vlc_logger_async_t;
+
+static void vlc_vaLogAsync(void *d, int type, const vlc_log_t *item,
+                           const char *format, va_list ap)
+{
+    vlc_logger_async_t *sys = d;
+
+    vlc_mutex_lock(&sys->lock);
+    if (sys->count >= VLC_LOG_ASYNC_MAX)
+    {
+        /* Do not even format the message */
+        sys->dropped++;
+        vlc_mutex_unlock(&sys->lock);
+        return;
+    }
+    vlc_mutex_unlock(&sys->lock);
+
+    vlc_log_early_t *log = malloc(sizeof (*log));
+    if (unlikely(log == NULL))
+        return;
+
+    log->next = NULL;
+    log->type = type;
+    log->meta = *item;
+    /* The module name may be on the stack of the caller */
+    log->meta.psz_module = strdup(item->psz_module);
+    log->meta.psz_header = item->psz_header ? strdup(item->psz_header) : NULL;
+
+    if (vasprintf(&log->msg, format, ap) == -1)
+        log->msg = NULL;
+
+    vlc_mutex_lock(&sys->lock);
+    *(sys->tailp) = log;
+    sys->tailp = &log->next;
+    sys->count++;
+    vlc_cond_signal(&sys->wait);
+    vlc_mutex_unlock(&sys->lock);
+}
+
+static void vlc_LogAsyncEmit(vlc_logger_async_t *sys, int type,
+                             const vlc_log_t *item, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    sys->cb(sys->opaque, type, item, format, ap);
+    va_end(ap);
+}
+
+static void *vlc_LogAsyncThread(void *d)
+{
+    vlc_logger_async_t *sys = d;
+
+    vlc_mutex_lock(&sys->lock);
+    for (;;)
+    {
+        while (sys->head == NULL && sys->dropped == 0 && !sys->quit)
+            vlc_cond_wait(&sys->wait, &sys->lock);
+
+        if (sys->head == NULL && sys->dropped == 0)
+            break; /* quitting and all messages were passed */
+
+        vlc_log_early_t *log = sys->head;
+        unsigned dropped = sys->dropped;
+
+        sys->head = NULL;
+        sys->tailp = &sys->head;
+        sys->count = 0;
+        sys->dropped = 0;
+        vlc_mutex_unlock(&sys->lock);
+
+        for (vlc_log_early_t *next; log != NULL; log = next)
+        {
+            vlc_LogAsyncEmit(sys, log->type, &log->meta, "%s",
+                             (log->msg != NULL) ? log->msg : "message lost");
+            free(log->msg);
+            free((char *)log->meta.psz_module);
+            free((char *)log->meta.psz_header);
+            next = log->next;
+            free(log);
+        }
+
+        if (dropped > 0)
+        {
+            const vlc_log_t meta = {
+                .psz_object_type = "logger",
+                .psz_module = "core",
+                .file = __FILE__,
+                .line = __LINE__,
+                .func = __func__,
+                .tid = vlc_thread_id(),
+            };
+            vlc_LogAsyncEmit(sys, VLC_MSG_WARN, &meta,
+                             "%u log message(s) dropped", dropped);
+        }
+
+        vlc_mutex_lock(&sys->lock);
+    }
+    vlc_mutex_unlock(&sys->lock);
+    return NULL;
+}
+
+static vlc_logger_async_t *vlc_LogAsyncOpen(vlc_log_cb cb, void *opaque)
+{
+    vlc_logger_async_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    vlc_mutex_init(&sys->lock);
+    vlc_cond_init(&sys->wait);
+    sys->head = NULL;
+    sys->tailp = &sys->head;
+    sys->count = 0;
+    sys->dropped = 0;
+    sys->quit = false;
+    sys->cb = cb;
+    sys->opaque = opaque;
+
+    if (vlc_clone(&sys->thread, vlc_LogAsyncThread, sys,
+                  VLC_THREAD_PRIORITY_LOW))
+    {
+        vlc_cond_destroy(&sys->wait);
+        vlc_mutex_destroy(&sys->lock);
+        free(sys);
+        return NULL;
+    }
+    return sys;
+}
+
+/**
+ * Passes the pending messages and stops the logging thread.
+ * \return the data pointer of the underlying logger
+ */
+static void *vlc_LogAsyncClose(void *d)
+{
+    vlc_logger_async_t *sys = d;
+    void *opaque = sys->opaque;
+
+    vlc_mutex_lock(&sys->lock);
+    sys->quit = true;
+    vlc_cond_signal(&sys->wait);
+    vlc_mutex_unlock(&sys->lock);
+    vlc_join(sys->thread, NULL);
+
+    vlc_cond_destroy(&sys->wait);
+    vlc_mutex_destroy(&sys->lock);
+    free(sys);
+    return opaque;
+}
+
 static void vlc_vaLogDiscard(void *d, int type, const vlc_log_t *item,
                              const char *format, va_list ap)
 {
@@ -365,6 +533,15 @@ int vlc_LogInit(libvlc_int_t *vlc)
                                        vlc_logger_load, logger, &cb, &sys);
     if (module == NULL)
         cb = vlc_vaLogDiscard;
+    else if (var_InheritBool(vlc, "log-async"))
+    {
+        vlc_logger_async_t *async = vlc_LogAsyncOpen(cb, sys);
+        if (async != NULL)
+        {
+            cb = vlc_vaLogAsync;
+            sys = async;
+        }
+    }
 
     vlc_rwlock_wrlock(&logger->lock);
     if (logger->log == vlc_vaLogEarly)
@@ -395,12 +572,14 @@ void vlc_LogSet(libvlc_int_t *vlc, vlc_log_cb cb, void *opaque)
         return;
 
     module_t *module;
+    vlc_log_cb oldcb;
     void *sys;
 
     if (cb == NULL)
         cb = vlc_vaLogDiscard;
 
     vlc_rwlock_wrlock(&logger->lock);
+    oldcb = logger->log;
     sys = logger->sys;
     module = logger->module;
 
@@ -409,6 +588,9 @@ void vlc_LogSet(libvlc_int_t *vlc, vlc_log_cb cb, void *opaque)
     logger->module = NULL;
     vlc_rwlock_unlock(&logger->lock);
 
+    if (oldcb == vlc_vaLogAsync)
+        sys = vlc_LogAsyncClose(sys);
+
     if (module != NULL)
         vlc_module_unload(module, vlc_logger_unload, sys);
 
@@ -426,6 +608,12 @@ void vlc_LogDeinit(libvlc_int_t *vlc)
     if (unlikely(logger == NULL))
         return;
 
+    if (logger->log == vlc_vaLogAsync)
+    {
+        logger->sys = vlc_LogAsyncClose(logger->sys);
+        logger->log = vlc_vaLogDiscard;
+    }
+
     if (logger->module != NULL)
         vlc_module_unload(logger->module, vlc_logger_unload, logger->sys);
     else
@@ -38,6 +38,11 @@
 #include <vlc_image.h>
 #include <vlc_block.h>
 
+/* Alignment of the lines and planes of the pictures allocated in memory.
+ * This matches the widest SIMD registers (AVX-512), which is what decoders
+ * require to render directly into the pictures, e.g. libavcodec. */
+#define PICTURE_ALIGN 64
+
 /**
  * Allocate a new picture in the heap.
  *
@@ -62,7 +67,7 @@ static int AllocatePicture( picture_t *p_pic )
         i_bytes += p->i_pitch * p->i_lines;
     }
 
-    uint8_t *p_data = vlc_memalign( 16, i_bytes );
+    uint8_t *p_data = vlc_memalign( PICTURE_ALIGN, i_bytes );
     if( i_bytes > 0 && p_data == NULL )
     {
         p_pic->i_planes = 0;
@@ -161,16 +166,17 @@ int picture_Setup( picture_t *p_picture, const video_format_t *restrict fmt )
 
     /* We want V (width/height) to respect:
         (V * p_dsc->p[i].w.i_num) % p_dsc->p[i].w.i_den == 0
-        (V * p_dsc->p[i].w.i_num/p_dsc->p[i].w.i_den * p_dsc->i_pixel_size) % 16 == 0
+        (V * p_dsc->p[i].w.i_num/p_dsc->p[i].w.i_den * p_dsc->i_pixel_size) % PICTURE_ALIGN == 0
        Which is respected if you have
-       V % lcm( p_dsc->p[0..planes].w.i_den * 16) == 0
+       V % lcm( p_dsc->p[0..planes].w.i_den * PICTURE_ALIGN) == 0
+       Then all the planes start on PICTURE_ALIGN boundaries too.
     */
     int i_modulo_w = 1;
     int i_modulo_h = 1;
     unsigned int i_ratio_h  = 1;
     for( unsigned i = 0; i < p_dsc->plane_count; i++ )
     {
-        i_modulo_w = LCM( i_modulo_w, 16 * p_dsc->p[i].w.den );
+        i_modulo_w = LCM( i_modulo_w, PICTURE_ALIGN * p_dsc->p[i].w.den );
         i_modulo_h = LCM( i_modulo_h, 16 * p_dsc->p[i].h.den );
         if( i_ratio_h < p_dsc->p[i].h.den )
             i_ratio_h = p_dsc->p[i].h.den;
@@ -190,7 +196,7 @@ int picture_Setup( picture_t *p_picture, const video_format_t *restrict fmt )
         p->i_visible_pitch = fmt->i_visible_width * p_dsc->p[i].w.num / p_dsc->p[i].w.den * p_dsc->pixel_size;
         p->i_pixel_pitch   = p_dsc->pixel_size;
 
-        assert( (p->i_pitch % 16) == 0 );
+        assert( (p->i_pitch % PICTURE_ALIGN) == 0 );
     }
     p_picture->i_planes  = p_dsc->plane_count;
 
@@ -280,6 +286,62 @@ picture_t *picture_New( vlc_fourcc_t i_chroma, int i_width, int i_height, int i_
     return picture_NewFromFormat( &fmt );
 }
 
+/**
+ * Destroys a picture allocated by picture_NewSubRect().
+ */
+static void picture_DestroySubRect( picture_t *p_picture )
+{
+    picture_priv_t *priv = (picture_priv_t *)p_picture;
+
+    picture_Release( priv->gc.opaque );
+    free( p_picture );
+}
+
+picture_t *picture_NewSubRect( picture_t *p_src, const video_format_t *p_fmt,
+                               unsigned i_x, unsigned i_y )
+{
+    const vlc_chroma_description_t *p_dsc =
+        vlc_fourcc_GetChromaDescription( p_src->format.i_chroma );
+
+    if( p_fmt->i_chroma != p_src->format.i_chroma
+     || p_dsc == NULL || p_dsc->plane_count == 0
+     || (int)p_dsc->plane_count != p_src->i_planes )
+        return NULL;
+
+    picture_resource_t res = {
+        .p_sys = NULL,
+        .pf_destroy = picture_DestroySubRect,
+    };
+
+    for( unsigned i = 0; i < p_dsc->plane_count; i++ )
+    {
+        const plane_t *p_plane = &p_src->p[i];
+        const unsigned i_pixel = i_x * p_dsc->p[i].w.num / p_dsc->p[i].w.den;
+        const unsigned i_line = i_y * p_dsc->p[i].h.num / p_dsc->p[i].h.den;
+        const unsigned i_width = p_fmt->i_width * p_dsc->p[i].w.num
+                               / p_dsc->p[i].w.den;
+        const unsigned i_height = p_fmt->i_height * p_dsc->p[i].h.num
+                                / p_dsc->p[i].h.den;
+
+        if( ( i_pixel + i_width ) * p_dsc->pixel_size > (unsigned)p_plane->i_pitch
+         || i_line + i_height > (unsigned)p_plane->i_lines )
+            return NULL;
+
+        res.p[i].p_pixels = p_plane->p_pixels + i_line * p_plane->i_pitch
+                          + i_pixel * p_dsc->pixel_size;
+        res.p[i].i_lines = p_plane->i_lines - i_line;
+        res.p[i].i_pitch = p_plane->i_pitch;
+    }
+
+    picture_t *p_picture = picture_NewFromResource( p_fmt, &res );
+    if( unlikely(p_picture == NULL) )
+        return NULL;
+
+    ((picture_priv_t *)p_picture)->gc.opaque = picture_Hold( p_src );
+    picture_CopyProperties( p_picture, p_src );
+    return p_picture;
+}
+
 /*****************************************************************************
  *
  *****************************************************************************/
@@ -0,0 +1,155 @@
+/*****************************************************************************
+ * slices.c: parallel execution of picture bands
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include "slices.h"
+
+struct vlc_slices
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait_work;
+    vlc_cond_t wait_done;
+
+    /* Current job */
+    void (*func)(void *, unsigned, unsigned);
+    void *opaque;
+    unsigned next; /**< Next slice to process */
+    unsigned done; /**< Number of processed slices */
+    bool busy;
+    bool quit;
+
+    unsigned count; /**< Number of slices (and threads) */
+    vlc_thread_t threads[];
+};
+
+/* Processes slices of the current job until none are left. Locked. */
+static void vlc_slices_Process(vlc_slices_t *pool)
+{
+    while (pool->next < pool->count)
+    {
+        unsigned index = pool->next++;
+
+        vlc_mutex_unlock(&pool->lock);
+        pool->func(pool->opaque, index, pool->count);
+        vlc_mutex_lock(&pool->lock);
+
+        if (++pool->done == pool->count)
+            vlc_cond_signal(&pool->wait_done);
+    }
+}
+
+static void *vlc_slices_Thread(void *data)
+{
+    vlc_slices_t *pool = data;
+
+    vlc_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        while (!pool->quit && (!pool->busy || pool->next >= pool->count))
+            vlc_cond_wait(&pool->wait_work, &pool->lock);
+        if (pool->quit)
+            break;
+
+        vlc_slices_Process(pool);
+    }
+    vlc_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+vlc_slices_t *vlc_slices_New(unsigned threads)
+{
+    vlc_slices_t *pool = malloc(sizeof (*pool)
+                                + threads * sizeof (pool->threads[0]));
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    vlc_mutex_init(&pool->lock);
+    vlc_cond_init(&pool->wait_work);
+    vlc_cond_init(&pool->wait_done);
+    pool->next = pool->done = 0;
+    pool->busy = false;
+    pool->quit = false;
+    pool->count = 1;
+
+    for (unsigned i = 0; i < threads; i++)
+    {
+        if (vlc_clone(pool->threads + i, vlc_slices_Thread, pool,
+                      VLC_THREAD_PRIORITY_VIDEO))
+            break;
+        pool->count++;
+    }
+    return pool;
+}
+
+void vlc_slices_Delete(vlc_slices_t *pool)
+{
+    vlc_mutex_lock(&pool->lock);
+    assert(!pool->busy);
+    pool->quit = true;
+    vlc_cond_broadcast(&pool->wait_work);
+    vlc_mutex_unlock(&pool->lock);
+
+    for (unsigned i = 0; i < pool->count - 1; i++)
+        vlc_join(pool->threads[i], NULL);
+
+    vlc_cond_destroy(&pool->wait_done);
+    vlc_cond_destroy(&pool->wait_work);
+    vlc_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+unsigned vlc_slices_Count(const vlc_slices_t *pool)
+{
+    return pool->count;
+}
+
+void vlc_slices_Run(vlc_slices_t *pool, void (*func)(void *, unsigned, unsigned),
+                    void *opaque)
+{
+    if (pool->count == 1)
+    {
+        func(opaque, 0, 1);
+        return;
+    }
+
+    int canc = vlc_savecancel();
+
+    vlc_mutex_lock(&pool->lock);
+    assert(!pool->busy);
+    pool->func = func;
+    pool->opaque = opaque;
+    pool->next = pool->done = 0;
+    pool->busy = true;
+    vlc_cond_broadcast(&pool->wait_work);
+
+    vlc_slices_Process(pool);
+    while (pool->done < pool->count)
+        vlc_cond_wait(&pool->wait_done, &pool->lock);
+    pool->busy = false;
+    vlc_mutex_unlock(&pool->lock);
+    vlc_restorecancel(canc);
+}
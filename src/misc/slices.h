@@ -0,0 +1,60 @@
+/*****************************************************************************
+ * slices.h: parallel execution of picture bands
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_SLICES_H
+# define LIBVLC_SLICES_H 1
+
+/**
+ * Pool of worker threads processing the slices of one job at a time.
+ *
+ * The thread submitting a job processes slices too, and returns once all
+ * slices are processed. A pool must not run several jobs concurrently.
+ */
+typedef struct vlc_slices vlc_slices_t;
+
+/**
+ * Creates a pool.
+ *
+ * \param threads number of worker threads (besides the submitting thread)
+ * \return the pool, or NULL on error
+ */
+vlc_slices_t *vlc_slices_New(unsigned threads);
+
+/**
+ * Destroys a pool.
+ */
+void vlc_slices_Delete(vlc_slices_t *);
+
+/**
+ * Returns the number of slices a job is split into, i.e. the number of
+ * threads processing it.
+ */
+unsigned vlc_slices_Count(const vlc_slices_t *);
+
+/**
+ * Processes a job.
+ *
+ * \param func callback invoked once per slice, with the slice index and the
+ *             total number of slices
+ */
+void vlc_slices_Run(vlc_slices_t *, void (*func)(void *, unsigned, unsigned),
+                    void *opaque);
+
+#endif
@@ -24,8 +24,13 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <time.h>
+#ifdef _WIN32
+# include <windows.h>
+#endif
 
 #include <vlc_common.h>
+#include "libvlc.h"
 
 /*** Global locks ***/
 
@@ -49,6 +54,30 @@ void vlc_global_mutex (unsigned n, bool acquire)
         vlc_mutex_unlock (lock);
 }
 
+/*** CPU time ***/
+
+mtime_t vlc_thread_cputime (void)
+{
+#if defined (_WIN32)
+    FILETIME creation, exit, kernel, user;
+
+    if (GetThreadTimes (GetCurrentThread (), &creation, &exit, &kernel, &user))
+    {
+        uint64_t t = ((uint64_t)kernel.dwHighDateTime << 32)
+                   + kernel.dwLowDateTime
+                   + ((uint64_t)user.dwHighDateTime << 32)
+                   + user.dwLowDateTime;
+        return t / 10; /* 100 ns units */
+    }
+#elif defined (CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+
+    if (clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return (INT64_C(1000000) * ts.tv_sec) + (ts.tv_nsec / 1000);
+#endif
+    return 0;
+}
+
 #if defined (_WIN32) && (_WIN32_WINNT < _WIN32_WINNT_WIN8)
 /* Cannot define OS version-dependent stuff in public headers */
 # undef LIBVLC_NEED_SLEEP
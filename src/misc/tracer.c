@@ -0,0 +1,224 @@
+/*****************************************************************************
+ * tracer.c: playback pipeline latency tracing
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include "tracer.h"
+
+/**
+ * \file
+ * Every thread records its events into its own ring buffer, so that the
+ * hot paths do not need any lock. The ring buffers are only read when
+ * dumping; events overwritten while being read are detected and skipped.
+ */
+
+#define TRACE_RING_SIZE 4096 /* events per thread, power of two */
+
+typedef struct
+{
+    mtime_t date;
+    mtime_t ts;
+    const void *input;
+    const void *id;
+    size_t size;
+    enum vlc_tracer_point point;
+} trace_event_t;
+
+typedef struct trace_ring
+{
+    struct trace_ring *next;
+    unsigned long tid;
+    atomic_bool owned; /**< false once the thread has exited */
+    atomic_uint count; /**< Events written so far, owner thread only */
+    trace_event_t events[TRACE_RING_SIZE];
+} trace_ring_t;
+
+static struct
+{
+    vlc_mutex_t lock;
+    bool initialized;
+    vlc_threadvar_t var;
+    trace_ring_t *rings;
+} tracer = { VLC_STATIC_MUTEX, false, };
+
+atomic_uint vlc_tracer_users = ATOMIC_VAR_INIT(0);
+
+static const char *const trace_point_names[] =
+{
+    [VLC_TRACE_ACCESS_READ]  = "access-read",
+    [VLC_TRACE_DEMUX_SEND]   = "demux-send",
+    [VLC_TRACE_DECODER_IN]   = "decoder-in",
+    [VLC_TRACE_DECODER_OUT]  = "decoder-out",
+    [VLC_TRACE_VOUT_DISPLAY] = "vout-display",
+};
+
+/** Thread-local variable destructor: keeps the events until dumped. */
+static void trace_ring_Exit(void *data)
+{
+    trace_ring_t *ring = data;
+
+    atomic_store_explicit(&ring->owned, false, memory_order_release);
+}
+
+static trace_ring_t *trace_ring_Get(void)
+{
+    trace_ring_t *ring = vlc_threadvar_get(tracer.var);
+    if (likely(ring != NULL))
+        return ring;
+
+    ring = malloc(sizeof (*ring));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    ring->tid = vlc_thread_id();
+    atomic_init(&ring->owned, true);
+    atomic_init(&ring->count, 0);
+    if (vlc_threadvar_set(tracer.var, ring))
+    {
+        free(ring);
+        return NULL;
+    }
+
+    vlc_mutex_lock(&tracer.lock);
+    ring->next = tracer.rings;
+    tracer.rings = ring;
+    vlc_mutex_unlock(&tracer.lock);
+    return ring;
+}
+
+void vlc_tracer_Record(enum vlc_tracer_point point, const void *input,
+                       const void *id, mtime_t ts, size_t size)
+{
+    /* Pairs with the release in vlc_tracer_Start() (thread variable) */
+    if (atomic_load_explicit(&vlc_tracer_users, memory_order_acquire) == 0)
+        return;
+
+    trace_ring_t *ring = trace_ring_Get();
+    if (unlikely(ring == NULL))
+        return;
+
+    unsigned count = atomic_load_explicit(&ring->count, memory_order_relaxed);
+    trace_event_t *ev = &ring->events[count & (TRACE_RING_SIZE - 1)];
+
+    ev->date = mdate();
+    ev->ts = ts;
+    ev->input = input;
+    ev->id = id;
+    ev->size = size;
+    ev->point = point;
+    atomic_store_explicit(&ring->count, count + 1, memory_order_release);
+}
+
+int vlc_tracer_Start(void)
+{
+    int ret = 0;
+
+    vlc_mutex_lock(&tracer.lock);
+    if (!tracer.initialized)
+    {
+        if (vlc_threadvar_create(&tracer.var, trace_ring_Exit))
+            ret = -1;
+        else
+            tracer.initialized = true;
+    }
+    if (ret == 0)
+        atomic_fetch_add_explicit(&vlc_tracer_users, 1, memory_order_release);
+    vlc_mutex_unlock(&tracer.lock);
+    return ret;
+}
+
+void vlc_tracer_Stop(void)
+{
+    vlc_mutex_lock(&tracer.lock);
+    assert(atomic_load(&vlc_tracer_users) > 0);
+    if (atomic_fetch_sub(&vlc_tracer_users, 1) == 1)
+    {   /* Release the events of the threads that are gone */
+        for (trace_ring_t **pp = &tracer.rings; *pp != NULL;)
+        {
+            trace_ring_t *ring = *pp;
+
+            if (!atomic_load_explicit(&ring->owned, memory_order_acquire))
+            {
+                *pp = ring->next;
+                free(ring);
+            }
+            else
+                pp = &ring->next;
+        }
+    }
+    vlc_mutex_unlock(&tracer.lock);
+}
+
+int vlc_tracer_Dump(const void *input, mtime_t since, FILE *stream)
+{
+    trace_event_t *events = malloc(sizeof (*events) * TRACE_RING_SIZE);
+    if (unlikely(events == NULL))
+        return -1;
+
+    bool first = true;
+
+    fputs("{\"traceEvents\":[", stream);
+
+    vlc_mutex_lock(&tracer.lock);
+    for (trace_ring_t *ring = tracer.rings; ring != NULL; ring = ring->next)
+    {
+        unsigned end = atomic_load_explicit(&ring->count,
+                                            memory_order_acquire);
+        unsigned n = (end < TRACE_RING_SIZE) ? end : TRACE_RING_SIZE;
+
+        for (unsigned i = 0; i < n; i++)
+            events[i] = ring->events[(end - n + i) & (TRACE_RING_SIZE - 1)];
+
+        /* Discard the events the owner thread overwrote meanwhile */
+        unsigned now = atomic_load_explicit(&ring->count,
+                                            memory_order_acquire);
+        unsigned skip = now - end;
+        if (skip > n)
+            skip = n;
+
+        for (unsigned i = skip; i < n; i++)
+        {
+            const trace_event_t *ev = &events[i];
+
+            if (ev->input != input || ev->date < since)
+                continue;
+
+            fprintf(stream, "%s\n{\"name\":\"%s\",\"cat\":\"input\","
+                    "\"ph\":\"i\",\"s\":\"t\",\"ts\":%"PRId64","
+                    "\"pid\":1,\"tid\":%lu,\"args\":{\"id\":\"%p\","
+                    "\"ts\":%"PRId64",\"size\":%zu}}", first ? "" : ",",
+                    trace_point_names[ev->point], ev->date, ring->tid,
+                    ev->id, ev->ts, ev->size);
+            first = false;
+        }
+    }
+    vlc_mutex_unlock(&tracer.lock);
+
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", stream);
+    free(events);
+    return ferror(stream) ? -1 : 0;
+}
@@ -0,0 +1,89 @@
+/*****************************************************************************
+ * tracer.h: playback pipeline latency tracing
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_TRACER_H
+# define LIBVLC_TRACER_H 1
+
+# include <stdio.h>
+# include <vlc_atomic.h>
+
+/**
+ * Points of the playback pipeline that can be traced.
+ */
+enum vlc_tracer_point
+{
+    VLC_TRACE_ACCESS_READ,   /**< Data read from the access */
+    VLC_TRACE_DEMUX_SEND,    /**< Block sent by the demuxer (es_out_Send) */
+    VLC_TRACE_DECODER_IN,    /**< Block entering the decoder */
+    VLC_TRACE_DECODER_OUT,   /**< Frame leaving the decoder */
+    VLC_TRACE_VOUT_DISPLAY,  /**< Picture displayed by the video output */
+};
+
+/** Number of active tracing sessions, records are only taken if non zero */
+extern atomic_uint vlc_tracer_users;
+
+void vlc_tracer_Record(enum vlc_tracer_point, const void *input,
+                       const void *id, mtime_t ts, size_t size);
+
+/**
+ * Records a trace event in the ring buffer of the calling thread.
+ *
+ * This is a single relaxed atomic load when tracing is disabled.
+ *
+ * \param input input thread the event belongs to (can be NULL)
+ * \param id object the event relates to (ES, decoder, video output...)
+ * \param ts timestamp of the data, or VLC_TS_INVALID
+ * \param size size of the data in bytes, or 0
+ */
+static inline void vlc_tracer_Event(enum vlc_tracer_point point,
+                                    const void *input, const void *id,
+                                    mtime_t ts, size_t size)
+{
+    if (unlikely(atomic_load_explicit(&vlc_tracer_users,
+                                      memory_order_relaxed) != 0))
+        vlc_tracer_Record(point, input, id, ts, size);
+}
+
+/**
+ * Starts a tracing session.
+ *
+ * \return 0 on success, or -1 if tracing is not available
+ */
+int vlc_tracer_Start(void);
+
+/**
+ * Ends a tracing session.
+ *
+ * The ring buffers of terminated threads are released once the last
+ * session ends.
+ */
+void vlc_tracer_Stop(void);
+
+/**
+ * Writes the recorded events of one input in Chrome trace event JSON
+ * format, as read by chrome://tracing and Perfetto.
+ *
+ * \param input input thread to dump the events of
+ * \param since ignore events recorded before this date
+ * \return 0 on success, or -1 on error
+ */
+int vlc_tracer_Dump(const void *input, mtime_t since, FILE *stream);
+
+#endif
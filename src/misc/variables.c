@@ -72,7 +72,8 @@ typedef struct callback_table_t
  */
 struct variable_t
 {
-    char *       psz_name; /**< The variable unique name (must be first) */
+    char *       psz_name; /**< The variable unique name */
+    uint32_t     i_hash;   /**< Hash of the name, see VarHash() */
 
     /** The variable's exported value */
     vlc_value_t  val;
@@ -140,22 +141,41 @@ int_ops    = { CmpInt,     DupDummy,  FreeDummy,  },
 string_ops = { CmpString,  DupString, FreeString, },
 coords_ops = { NULL,       DupDummy,  FreeDummy,  };
 
+/**
+ * Hashes a variable name (FNV-1a).
+ *
+ * Many variables share long prefixes, e.g. the sout module options. The
+ * variables are sorted by hash first, so that finding one mostly compares
+ * integers and the names are only compared once.
+ */
+static uint32_t VarHash( const char *psz_name )
+{
+    uint32_t i_hash = 2166136261u;
+
+    while( *psz_name )
+        i_hash = ( i_hash ^ (uint8_t)*psz_name++ ) * 16777619u;
+    return i_hash;
+}
+
 static int varcmp( const void *a, const void *b )
 {
     const variable_t *va = a, *vb = b;
 
-    /* psz_name must be first */
-    assert( va == (const void *)&va->psz_name );
+    if( va->i_hash != vb->i_hash )
+        return va->i_hash < vb->i_hash ? -1 : 1;
     return strcmp( va->psz_name, vb->psz_name );
 }
 
 static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
-    variable_t **pp_var;
+    variable_t key, **pp_var;
+
+    key.psz_name = (char *)psz_name;
+    key.i_hash = VarHash( psz_name );
 
     vlc_mutex_lock(&priv->var_lock);
-    pp_var = tfind( &psz_name, &priv->var_root, varcmp );
+    pp_var = tfind( &key, &priv->var_root, varcmp );
     return (pp_var != NULL) ? *pp_var : NULL;
 }
 
@@ -303,6 +323,7 @@ int var_Create( vlc_object_t *p_this, const char *psz_name, int i_type )
         return VLC_ENOMEM;
 
     p_var->psz_name = strdup( psz_name );
+    p_var->i_hash = VarHash( psz_name );
     p_var->psz_text = NULL;
 
     p_var->i_type = i_type & ~VLC_VAR_DOINHERIT;
@@ -57,7 +57,7 @@
 #ifdef HAVE_DYNAMIC_PLUGINS
 /* Sub-version number
  * (only used to avoid breakage in dev version when cache structure changes) */
-#define CACHE_SUBVERSION_NUM 34
+#define CACHE_SUBVERSION_NUM 35
 
 /* Cache filename */
 #define CACHE_NAME "plugins.dat"
@@ -200,11 +200,29 @@ static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
         LOAD_STRING(psz);
         cfg->orig.psz = (char *)psz;
         cfg->value.psz = (psz != NULL) ? strdup (cfg->orig.psz) : NULL;
+    }
+    else
+    {
+        LOAD_IMMEDIATE (cfg->orig);
+        LOAD_IMMEDIATE (cfg->min);
+        LOAD_IMMEDIATE (cfg->max);
+        cfg->value = cfg->orig;
+    }
+
+    /* Choices are in a separate section, see vlc_cache_load_choices() */
+    if (cfg->list_count == 0)
+        LOAD_STRING(cfg->list_cb_name);
 
-        if (cfg->list_count)
-            cfg->list.psz = xmalloc (cfg->list_count * sizeof (char *));
-        else
-            LOAD_STRING(cfg->list_cb_name);
+    return 0;
+error:
+    return -1;
+}
+
+static int vlc_cache_load_choice(module_config_t *cfg, block_t *file)
+{
+    if (IsConfigStringType (cfg->i_type))
+    {
+        cfg->list.psz = xmalloc (cfg->list_count * sizeof (char *));
         for (unsigned i = 0; i < cfg->list_count; i++)
         {
             LOAD_STRING (cfg->list.psz[i]);
@@ -215,18 +233,7 @@ static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
     }
     else
     {
-        LOAD_IMMEDIATE (cfg->orig);
-        LOAD_IMMEDIATE (cfg->min);
-        LOAD_IMMEDIATE (cfg->max);
-        cfg->value = cfg->orig;
-
-        if (cfg->list_count)
-        {
-            LOAD_ALIGNOF(*cfg->list.i);
-        }
-        else
-            LOAD_STRING(cfg->list_cb_name);
-
+        LOAD_ALIGNOF(*cfg->list.i);
         LOAD_ARRAY(cfg->list.i, cfg->list_count);
     }
 
@@ -244,6 +251,59 @@ error:
     return -1; /* FIXME: leaks */
 }
 
+static vlc_mutex_t choices_lock = VLC_STATIC_MUTEX;
+
+/**
+ * Parses the choices lists of a plug-in loaded from the cache.
+ *
+ * Those lists are only needed by user interfaces and a few option lookups,
+ * so they are left in the cache file mapping until first used.
+ */
+void vlc_cache_load_choices(vlc_plugin_t *plugin)
+{
+    if (!atomic_load_explicit(&plugin->choices_pending, memory_order_acquire))
+        return;
+
+    vlc_mutex_lock(&choices_lock);
+    if (atomic_load_explicit(&plugin->choices_pending, memory_order_relaxed))
+    {
+        block_t section;
+
+        section.p_buffer = (uint8_t *)plugin->choices;
+        section.i_buffer = plugin->choices_size;
+
+        for (size_t i = 0; i < plugin->conf.size; i++)
+        {
+            module_config_t *item = plugin->conf.items + i;
+
+            if (item->list_count == 0)
+                continue;
+            if (vlc_cache_load_choice(item, &section))
+            {   /* Corrupted: drop the remaining choices */
+                if (IsConfigStringType (item->i_type))
+                    free (item->list.psz);
+                free (item->list_text);
+
+                for (; i < plugin->conf.size; i++)
+                {
+                    item = plugin->conf.items + i;
+                    if (item->list_count == 0)
+                        continue;
+                    item->list.psz = NULL;
+                    item->list_text = NULL;
+                    item->list_count = 0;
+                }
+                break;
+            }
+        }
+
+        plugin->choices = NULL;
+        atomic_store_explicit(&plugin->choices_pending, false,
+                              memory_order_release);
+    }
+    vlc_mutex_unlock(&choices_lock);
+}
+
 static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin, block_t *file)
 {
     uint16_t lines;
@@ -283,6 +343,19 @@ static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin, block_t *file)
         item->owner = plugin;
     }
 
+    /* Choices lists */
+    uint32_t size;
+
+    LOAD_IMMEDIATE (size);
+    if (file->i_buffer < size)
+        goto error;
+
+    plugin->choices = file->p_buffer;
+    plugin->choices_size = size;
+    atomic_store_explicit(&plugin->choices_pending, size > 0,
+                          memory_order_relaxed);
+    file->p_buffer += size;
+    file->i_buffer -= size;
     return 0;
 error:
     return -1; /* FIXME: leaks */
@@ -530,25 +603,32 @@ static int CacheSaveConfig (FILE *file, const module_config_t *cfg)
     if (IsConfigStringType (cfg->i_type))
     {
         SAVE_STRING (cfg->orig.psz);
-        if (cfg->list_count == 0)
-            SAVE_STRING(cfg->list_cb_name);
-
-        for (unsigned i = 0; i < cfg->list_count; i++)
-            SAVE_STRING (cfg->list.psz[i]);
     }
     else
     {
         SAVE_IMMEDIATE (cfg->orig);
         SAVE_IMMEDIATE (cfg->min);
         SAVE_IMMEDIATE (cfg->max);
+    }
 
-        if (cfg->list_count > 0)
-        {
-            SAVE_ALIGNOF(*cfg->list.i);
-        }
-        else
-            SAVE_STRING(cfg->list_cb_name);
+    if (cfg->list_count == 0)
+        SAVE_STRING(cfg->list_cb_name);
+
+    return 0;
+error:
+    return -1;
+}
 
+static int CacheSaveChoice (FILE *file, const module_config_t *cfg)
+{
+    if (IsConfigStringType (cfg->i_type))
+    {
+        for (unsigned i = 0; i < cfg->list_count; i++)
+            SAVE_STRING (cfg->list.psz[i]);
+    }
+    else
+    {
+        SAVE_ALIGNOF(*cfg->list.i);
         for (unsigned i = 0; i < cfg->list_count; i++)
              SAVE_IMMEDIATE (cfg->list.i[i]);
     }
@@ -560,7 +640,7 @@ error:
     return -1;
 }
 
-static int CacheSaveModuleConfig(FILE *file, const vlc_plugin_t *plugin)
+static int CacheSaveModuleConfig(FILE *file, vlc_plugin_t *plugin)
 {
     uint16_t lines = plugin->conf.size;
 
@@ -570,6 +650,33 @@ static int CacheSaveModuleConfig(FILE *file, const vlc_plugin_t *plugin)
         if (CacheSaveConfig(file, plugin->conf.items + i))
            goto error;
 
+    /* Choices lists, prefixed by their size so loading can skip them */
+    vlc_cache_load_choices(plugin);
+
+    uint32_t size = 0;
+    long offset = ftell(file);
+
+    SAVE_IMMEDIATE (size);
+
+    for (size_t i = 0; i < lines; i++)
+    {
+        const module_config_t *item = plugin->conf.items + i;
+
+        if (item->list_count > 0 && CacheSaveChoice(file, item))
+           goto error;
+    }
+
+    long end = ftell(file);
+    if (offset == -1 || end == -1)
+        goto error;
+
+    size = end - offset - sizeof (size);
+    if (fseek(file, offset, SEEK_SET))
+        goto error;
+    SAVE_IMMEDIATE (size);
+    if (fseek(file, end, SEEK_SET))
+        goto error;
+
     return 0;
 error:
     return -1;
@@ -619,7 +726,7 @@ static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
 
     for (size_t i = 0; i < n; i++)
     {
-        const vlc_plugin_t *plugin = cache[i];
+        vlc_plugin_t *plugin = cache[i];
         uint32_t count = plugin->modules_count;
 
         SAVE_IMMEDIATE(count);
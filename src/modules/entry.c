@@ -111,6 +111,9 @@ vlc_plugin_t *vlc_plugin_create(void)
     plugin->handle = NULL;
     plugin->abspath = NULL;
     plugin->path = NULL;
+    plugin->choices = NULL;
+    plugin->choices_size = 0;
+    atomic_init(&plugin->choices_pending, false);
 #endif
     plugin->module = NULL;
 
@@ -420,7 +420,7 @@ bool module_exists (const char * psz_name)
  */
 module_config_t *module_config_get( const module_t *module, unsigned *restrict psize )
 {
-    const vlc_plugin_t *plugin = module->plugin;
+    vlc_plugin_t *plugin = module->plugin;
 
     if (plugin->module != module)
     {   /* For backward compatibility, pretend non-first modules have no
@@ -429,6 +429,8 @@ module_config_t *module_config_get( const module_t *module, unsigned *restrict p
         return NULL;
     }
 
+    vlc_cache_load_choices(plugin);
+
     unsigned i,j;
     size_t size = plugin->conf.size;
     module_config_t *config = malloc( size * sizeof( *config ) );
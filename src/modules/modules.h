@@ -58,6 +58,10 @@ typedef struct vlc_plugin_t
     char *path; /**< Relative path (within plug-in directory) */
     int64_t mtime; /**< Last modification time */
     uint64_t size; /**< File size */
+
+    const void *choices; /**< Unparsed choices lists from the cache */
+    size_t choices_size; /**< Size of the unparsed choices lists */
+    atomic_bool choices_pending; /**< Whether choices lists are unparsed */
 #endif
 } vlc_plugin_t;
 
@@ -129,6 +133,11 @@ void module_Unload (module_handle_t);
 /* Plugins cache */
 vlc_plugin_t *vlc_cache_load(vlc_object_t *, const char *, block_t **);
 vlc_plugin_t *vlc_cache_lookup(vlc_plugin_t **, const char *relpath);
+#ifdef HAVE_DYNAMIC_PLUGINS
+void vlc_cache_load_choices(vlc_plugin_t *);
+#else
+# define vlc_cache_load_choices(plugin) ((void)(plugin))
+#endif
 
 void CacheSave(vlc_object_t *, const char *, vlc_plugin_t *const *, size_t);
 
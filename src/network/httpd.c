@@ -40,6 +40,8 @@
 #include <vlc_url.h>
 #include <vlc_mime.h>
 #include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_atomic.h>
 #include "../libvlc.h"
 
 #include <string.h>
@@ -64,7 +66,7 @@
 #endif
 
 static void httpd_ClientDestroy(httpd_client_t *cl);
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data);
+static void httpd_HostWake(httpd_host_t *host);
 
 /* each host run in his own thread */
 struct httpd_host_t
@@ -83,6 +85,10 @@ struct httpd_host_t
     vlc_mutex_t lock;
     vlc_cond_t  wait;
 
+    /* wakes the thread up when stream data is available */
+    int          wake[2];
+    atomic_bool  wake_pending;
+
     /* all registered url (becarefull that 2 httpd_url_t could point at the same url)
      * This will slow down the url research but make my live easier
      * All url will have their cb trigger, but only the first one can answer
@@ -157,6 +163,8 @@ struct httpd_client_t
     int     i_buffer_size;
     int     i_buffer;
     uint8_t *p_buffer;
+    block_t *p_buffer_block; /* owner of p_buffer if not NULL */
+    block_t *p_body_block; /* owner of answer.p_body if not NULL */
 
     /*
      * If waiting for a keyframe, this is the position (in bytes) of the
@@ -592,6 +600,12 @@ void httpd_RedirectDelete(httpd_redirect_t *rdir)
 /*****************************************************************************
  * High Level Funtions: httpd_stream_t
  *****************************************************************************/
+typedef struct
+{
+    int64_t  i_pos;     /* absolute position of the block data */
+    block_t *p_block;   /* shared block */
+} httpd_chunk_t;
+
 struct httpd_stream_t
 {
     vlc_mutex_t lock;
@@ -611,9 +625,14 @@ struct httpd_stream_t
     bool        b_has_keyframes;
     int64_t     i_last_keyframe_seen_pos;
 
-    /* circular buffer */
-    int         i_buffer_size;      /* buffer size, can't be reallocated smaller */
-    uint8_t     *p_buffer;          /* buffer */
+    /* Buffered data, as shared blocks that clients send without copying.
+     * The oldest blocks are dropped once i_buffer_size bytes are buffered */
+    int         i_buffer_size;      /* buffered bytes limit */
+    int64_t     i_buffered;         /* buffered bytes */
+    httpd_chunk_t *p_chunks;        /* circular array of blocks */
+    size_t      i_chunks_max;
+    size_t      i_chunk_first;
+    size_t      i_chunks;
     int64_t     i_buffer_pos;       /* absolute position from beginning */
     int64_t     i_buffer_last_pos;  /* a new connection will start with that */
 
@@ -622,6 +641,29 @@ struct httpd_stream_t
     httpd_header * p_http_headers;
 };
 
+static httpd_chunk_t *httpd_StreamChunk(httpd_stream_t *stream, size_t i)
+{
+    return &stream->p_chunks[(stream->i_chunk_first + i) % stream->i_chunks_max];
+}
+
+/* Finds the buffered block holding the data at the given position */
+static const httpd_chunk_t *httpd_StreamFind(httpd_stream_t *stream,
+                                              int64_t i_pos)
+{
+    size_t lo = 0, hi = stream->i_chunks;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+
+        if (httpd_StreamChunk(stream, mid)->i_pos <= i_pos)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    assert(lo > 0);
+    return httpd_StreamChunk(stream, lo - 1);
+}
+
 static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
                                  httpd_client_t *cl, httpd_message_t *answer,
                                  const httpd_message_t *query)
@@ -632,47 +674,61 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
         return VLC_SUCCESS;
 
     if (answer->i_body_offset > 0) {
-        int     i_pos;
-
+        vlc_mutex_lock(&stream->lock);
         if (answer->i_body_offset >= stream->i_buffer_pos)
-            return VLC_EGENERIC;    /* wait, no data available */
+            goto wait; /* no data available */
 
         if (cl->i_keyframe_wait_to_pass >= 0) {
             if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
                 /* still waiting for the next keyframe */
-                return VLC_EGENERIC;
+                goto wait;
 
             /* seek to the new keyframe */
             answer->i_body_offset = stream->i_last_keyframe_seen_pos;
             cl->i_keyframe_wait_to_pass = -1;
         }
 
-        if (answer->i_body_offset + stream->i_buffer_size < stream->i_buffer_pos)
-            answer->i_body_offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
-
-        i_pos   = answer->i_body_offset % stream->i_buffer_size;
-        int64_t i_write = stream->i_buffer_pos - answer->i_body_offset;
+        /* This client isn't fast enough and its data was dropped: it resumes
+         * from the last keyframe if it is still buffered, or else from the
+         * last block */
+        int64_t i_first = httpd_StreamChunk(stream, 0)->i_pos;
+        if (answer->i_body_offset < i_first) {
+            if (stream->b_has_keyframes
+             && stream->i_last_keyframe_seen_pos >= i_first)
+                answer->i_body_offset = stream->i_last_keyframe_seen_pos;
+            else
+                answer->i_body_offset = stream->i_buffer_last_pos;
+        }
 
-        if (i_write > HTTPD_CL_BUFSIZE)
-            i_write = HTTPD_CL_BUFSIZE;
-        else if (i_write <= 0)
-            return VLC_EGENERIC;    /* wait, no data available */
+        const httpd_chunk_t *chunk = httpd_StreamFind(stream,
+                                                      answer->i_body_offset);
+        block_t *p_body = block_Clone(chunk->p_block);
+        if (unlikely(p_body == NULL))
+            goto wait;
+        vlc_mutex_unlock(&stream->lock);
 
-        /* Don't go past the end of the circular buffer */
-        i_write = __MIN(i_write, stream->i_buffer_size - i_pos);
+        size_t i_skip = answer->i_body_offset - chunk->i_pos;
+        p_body->p_buffer += i_skip;
+        p_body->i_buffer -= i_skip;
+        if (p_body->i_buffer > HTTPD_CL_BUFSIZE)
+            p_body->i_buffer = HTTPD_CL_BUFSIZE;
 
         /* using HTTPD_MSG_ANSWER -> data available */
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
         answer->i_type   = HTTPD_MSG_ANSWER;
 
-        answer->i_body = i_write;
-        answer->p_body = xmalloc(i_write);
-        memcpy(answer->p_body, &stream->p_buffer[i_pos], i_write);
+        answer->i_body = p_body->i_buffer;
+        answer->p_body = p_body->p_buffer;
+        assert(cl->p_body_block == NULL);
+        cl->p_body_block = p_body;
 
-        answer->i_body_offset += i_write;
+        answer->i_body_offset += answer->i_body;
 
         return VLC_SUCCESS;
+wait:
+        vlc_mutex_unlock(&stream->lock);
+        return VLC_EGENERIC;
     } else {
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
@@ -766,7 +822,11 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
     stream->i_header = 0;
     stream->p_header = NULL;
     stream->i_buffer_size = 5000000;    /* 5 Mo per stream */
-    stream->p_buffer = xmalloc(stream->i_buffer_size);
+    stream->i_buffered = 0;
+    stream->p_chunks = NULL;
+    stream->i_chunks_max = 0;
+    stream->i_chunk_first = 0;
+    stream->i_chunks = 0;
     /* We set to 1 to make life simpler
      * (this way i_body_offset can never be 0) */
     stream->i_buffer_pos = 1;
@@ -802,29 +862,51 @@ int httpd_StreamHeader(httpd_stream_t *stream, uint8_t *p_data, int i_data)
     return VLC_SUCCESS;
 }
 
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data)
+static int httpd_AppendBlock(httpd_stream_t *stream, block_t *p_block)
 {
-    int i_pos = stream->i_buffer_pos % stream->i_buffer_size;
-    int i_count = i_data;
-    while (i_count > 0) {
-        int i_copy = __MIN(i_count, stream->i_buffer_size - i_pos);
-
-        /* Ok, we can't go past the end of our buffer */
-        memcpy(&stream->p_buffer[i_pos], p_data, i_copy);
-
-        i_pos = (i_pos + i_copy) % stream->i_buffer_size;
-        i_count -= i_copy;
-        p_data  += i_copy;
+    if (stream->i_chunks == stream->i_chunks_max) {
+        size_t i_max = stream->i_chunks_max ? 2 * stream->i_chunks_max : 64;
+        httpd_chunk_t *p_chunks = malloc(i_max * sizeof (*p_chunks));
+        if (unlikely(p_chunks == NULL))
+            return VLC_ENOMEM;
+
+        for (size_t i = 0; i < stream->i_chunks; i++)
+            p_chunks[i] = *httpd_StreamChunk(stream, i);
+        free(stream->p_chunks);
+        stream->p_chunks = p_chunks;
+        stream->i_chunks_max = i_max;
+        stream->i_chunk_first = 0;
     }
 
-    stream->i_buffer_pos += i_data;
+    httpd_chunk_t *chunk = httpd_StreamChunk(stream, stream->i_chunks++);
+    chunk->i_pos = stream->i_buffer_pos;
+    chunk->p_block = p_block;
+    stream->i_buffer_pos += p_block->i_buffer;
+    stream->i_buffered += p_block->i_buffer;
+
+    /* drop the oldest data, but always keep the newest block */
+    while (stream->i_buffered > stream->i_buffer_size && stream->i_chunks > 1) {
+        chunk = httpd_StreamChunk(stream, 0);
+        stream->i_buffered -= chunk->p_block->i_buffer;
+        block_Release(chunk->p_block);
+        stream->i_chunk_first = (stream->i_chunk_first + 1) % stream->i_chunks_max;
+        stream->i_chunks--;
+    }
+    return VLC_SUCCESS;
 }
 
 int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
 {
-    if (!p_block || !p_block->p_buffer)
+    if (!p_block || !p_block->p_buffer || p_block->i_buffer == 0)
         return VLC_SUCCESS;
 
+    /* Copy once here, so that all clients can then share the data */
+    block_t *p_data = block_Alloc(p_block->i_buffer);
+    if (unlikely(p_data == NULL))
+        return VLC_ENOMEM;
+    memcpy(p_data->p_buffer, p_block->p_buffer, p_block->i_buffer);
+    p_data = block_Share(p_data);
+
     vlc_mutex_lock(&stream->lock);
 
     /* save this pointer (to be used by new connection) */
@@ -835,9 +917,16 @@ int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
         stream->i_last_keyframe_seen_pos = stream->i_buffer_pos;
     }
 
-    httpd_AppendData(stream, p_block->p_buffer, p_block->i_buffer);
+    if (httpd_AppendBlock(stream, p_data)) {
+        vlc_mutex_unlock(&stream->lock);
+        block_Release(p_data);
+        return VLC_ENOMEM;
+    }
 
     vlc_mutex_unlock(&stream->lock);
+
+    /* clients waiting for data are not polled anymore */
+    httpd_HostWake(stream->url->host);
     return VLC_SUCCESS;
 }
 
@@ -852,7 +941,9 @@ void httpd_StreamDelete(httpd_stream_t *stream)
     vlc_mutex_destroy(&stream->lock);
     free(stream->psz_mime);
     free(stream->p_header);
-    free(stream->p_buffer);
+    for (size_t i = 0; i < stream->i_chunks; i++)
+        block_Release(httpd_StreamChunk(stream, i)->p_block);
+    free(stream->p_chunks);
     free(stream);
 }
 
@@ -960,6 +1051,13 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
     vlc_cond_init(&host->wait);
     host->i_ref = 1;
 
+    /* Windows pipes cannot be polled: fall back to polling clients there */
+#ifndef _WIN32
+    if (vlc_pipe(host->wake))
+#endif
+        host->wake[0] = host->wake[1] = -1;
+    atomic_init(&host->wake_pending, false);
+
     host->fds = net_ListenTCP(p_this, url.psz_host, port);
     if (!host->fds) {
         msg_Err(p_this, "cannot create socket(s) for HTTP host");
@@ -994,6 +1092,10 @@ error:
 
     if (host) {
         net_ListenClose(host->fds);
+        if (host->wake[0] != -1) {
+            vlc_close(host->wake[1]);
+            vlc_close(host->wake[0]);
+        }
         vlc_cond_destroy(&host->wait);
         vlc_mutex_destroy(&host->lock);
         vlc_object_release(host);
@@ -1040,6 +1142,10 @@ void httpd_HostDelete(httpd_host_t *host)
 
     vlc_tls_Delete(host->p_tls);
     net_ListenClose(host->fds);
+    if (host->wake[0] != -1) {
+        vlc_close(host->wake[1]);
+        vlc_close(host->wake[0]);
+    }
     vlc_cond_destroy(&host->wait);
     vlc_mutex_destroy(&host->lock);
     vlc_object_release(host);
@@ -1199,6 +1305,8 @@ static void httpd_ClientInit(httpd_client_t *cl, mtime_t now)
     cl->i_buffer_size = HTTPD_CL_BUFSIZE;
     cl->i_buffer = 0;
     cl->p_buffer = xmalloc(cl->i_buffer_size);
+    cl->p_buffer_block = NULL;
+    cl->p_body_block = NULL;
     cl->i_keyframe_wait_to_pass = -1;
     cl->b_stream_mode = false;
 
@@ -1216,6 +1324,30 @@ char* httpd_ServerIP(const httpd_client_t *cl, char *ip, int *port)
     return net_GetSockAddress(cl->fd, ip, port) ? NULL : ip;
 }
 
+static void httpd_ClientBufferRelease(httpd_client_t *cl)
+{
+    if (cl->p_buffer_block != NULL) {
+        block_Release(cl->p_buffer_block);
+        cl->p_buffer_block = NULL;
+    } else
+        free(cl->p_buffer);
+    cl->p_buffer = NULL;
+}
+
+/* Makes the answer body the buffer to send */
+static void httpd_ClientTakeBody(httpd_client_t *cl)
+{
+    httpd_ClientBufferRelease(cl);
+    cl->p_buffer = cl->answer.p_body;
+    cl->p_buffer_block = cl->p_body_block;
+    cl->i_buffer_size = cl->answer.i_body;
+    cl->i_buffer = 0;
+
+    cl->answer.p_body = NULL;
+    cl->answer.i_body = 0;
+    cl->p_body_block = NULL;
+}
+
 static void httpd_ClientDestroy(httpd_client_t *cl)
 {
     if (cl->p_tls != NULL)
@@ -1223,10 +1355,14 @@ static void httpd_ClientDestroy(httpd_client_t *cl)
     else
         net_Close(cl->fd);
 
+    if (cl->p_body_block != NULL) {
+        cl->answer.p_body = NULL;
+        block_Release(cl->p_body_block);
+    }
     httpd_MsgClean(&cl->answer);
     httpd_MsgClean(&cl->query);
 
-    free(cl->p_buffer);
+    httpd_ClientBufferRelease(cl);
     free(cl);
 }
 
@@ -1595,9 +1731,9 @@ static void httpd_ClientSend(httpd_client_t *cl)
             i_size += strlen(cl->answer.p_headers[i].name) + 2 +
                       strlen(cl->answer.p_headers[i].value) + 2;
 
-        if (cl->i_buffer_size < i_size) {
+        if (cl->i_buffer_size < i_size || cl->p_buffer_block != NULL) {
             cl->i_buffer_size = i_size;
-            free(cl->p_buffer);
+            httpd_ClientBufferRelease(cl);
             cl->p_buffer = xmalloc(i_size);
         }
         p = (char *)cl->p_buffer;
@@ -1635,13 +1771,7 @@ static void httpd_ClientSend(httpd_client_t *cl)
 
             if (cl->answer.i_body > 0) {
                 /* send the body data */
-                free(cl->p_buffer);
-                cl->p_buffer = cl->answer.p_body;
-                cl->i_buffer_size = cl->answer.i_body;
-                cl->i_buffer = 0;
-
-                cl->answer.i_body = 0;
-                cl->answer.p_body = NULL;
+                httpd_ClientTakeBody(cl);
             } else /* send finished */
                 cl->i_state = HTTPD_CLIENT_SEND_DONE;
         }
@@ -1709,9 +1839,18 @@ auth_failed:
     return false;
 }
 
+static void httpd_HostWake(httpd_host_t *host)
+{
+    if (host->wake[1] == -1
+     || atomic_exchange(&host->wake_pending, true))
+        return; /* the thread will see this data anyway */
+
+    while (vlc_write(host->wake[1], &(char){ 0 }, 1) < 0 && errno == EINTR);
+}
+
 static void httpdLoop(httpd_host_t *host)
 {
-    struct pollfd ufd[host->nfd + host->i_client];
+    struct pollfd ufd[host->nfd + host->i_client + 1];
     unsigned nfd;
     for (nfd = 0; nfd < host->nfd; nfd++) {
         ufd[nfd].fd = host->fds[nfd];
@@ -1926,7 +2065,7 @@ static void httpdLoop(httpd_host_t *host)
 
                         cl->i_buffer = 0;
                         cl->i_buffer_size = 1000;
-                        free(cl->p_buffer);
+                        httpd_ClientBufferRelease(cl);
                         cl->p_buffer = xmalloc(cl->i_buffer_size);
                         cl->i_state = HTTPD_CLIENT_RECEIVING;
                     } else
@@ -1937,8 +2076,7 @@ static void httpdLoop(httpd_host_t *host)
                     httpd_MsgClean(&cl->answer);
 
                     cl->answer.i_body_offset = i_offset;
-                    free(cl->p_buffer);
-                    cl->p_buffer = NULL;
+                    httpd_ClientBufferRelease(cl);
                     cl->i_buffer = 0;
                     cl->i_buffer_size = 0;
 
@@ -1957,20 +2095,33 @@ static void httpdLoop(httpd_host_t *host)
                         &cl->answer, &cl->query);
                 if (cl->answer.i_type != HTTPD_MSG_NONE) {
                     /* we have new data, so re-enter send mode */
-                    cl->i_buffer      = 0;
-                    cl->p_buffer      = cl->answer.p_body;
-                    cl->i_buffer_size = cl->answer.i_body;
-                    cl->answer.p_body = NULL;
-                    cl->answer.i_body = 0;
+                    httpd_ClientTakeBody(cl);
                     cl->i_state = HTTPD_CLIENT_SENDING;
                 }
         }
 
+        /* poll right away the clients whose state just changed */
+        if (pufd->events == 0) {
+            if (cl->i_state == HTTPD_CLIENT_RECEIVING)
+                pufd->events = POLLIN;
+            else if (cl->i_state == HTTPD_CLIENT_SENDING)
+                pufd->events = POLLOUT;
+        }
+
         if (pufd->events != 0)
             nfd++;
-        else
+        /* waiting clients only ever wait for stream data, which wakes us up */
+        else if (cl->i_state != HTTPD_CLIENT_WAITING || host->wake[0] == -1)
             b_low_delay = true;
     }
+
+    struct pollfd *wakefd = NULL;
+    if (host->wake[0] != -1) {
+        wakefd = &ufd[nfd++];
+        wakefd->fd = host->wake[0];
+        wakefd->events = POLLIN;
+        wakefd->revents = 0;
+    }
     vlc_mutex_unlock(&host->lock);
     vlc_restorecancel(canc);
 
@@ -1991,6 +2142,14 @@ static void httpdLoop(httpd_host_t *host)
             return;
     }
 
+    if (wakefd != NULL && wakefd->revents != 0) {
+        char buf[16];
+
+        /* Clear before the clients are served, so that no data is missed */
+        atomic_store(&host->wake_pending, false);
+        while (read(host->wake[0], buf, sizeof (buf)) < 0 && errno == EINTR);
+    }
+
     /* Handle client sockets */
     now = mdate();
     nfd = host->nfd;
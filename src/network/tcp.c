@@ -59,6 +59,198 @@ static int SocksHandshakeTCP( vlc_object_t *,
 extern int net_Socket( vlc_object_t *p_this, int i_family, int i_socktype,
                        int i_protocol );
 
+/* Delay before racing the next address (RFC 8305 section 5) */
+#define CONNECTION_ATTEMPT_DELAY 250
+
+/**
+ * Sorts resolved addresses so that address families alternate, starting
+ * with the first (preferred) family (RFC 8305 section 4).
+ */
+static size_t SortAddresses( const struct addrinfo *res,
+                             const struct addrinfo **tab )
+{
+    size_t n = 0, first = 0, other = 0;
+
+    for( const struct addrinfo *p = res; p != NULL; p = p->ai_next )
+        n++;
+
+    const struct addrinfo *others[n];
+    const struct addrinfo *firsts[n];
+
+    for( const struct addrinfo *p = res; p != NULL; p = p->ai_next )
+    {
+        if( p->ai_family == res->ai_family )
+            firsts[first++] = p;
+        else
+            others[other++] = p;
+    }
+
+    for( size_t i = 0, f = 0, o = 0; i < n; i++ )
+    {
+        if( (i & 1) ? (o < other) : (f >= first) )
+            tab[i] = others[o++];
+        else
+            tab[i] = firsts[f++];
+    }
+    return n;
+}
+
+/**
+ * Connects to the first responding address (Happy Eyeballs).
+ *
+ * A new connection attempt is started every CONNECTION_ATTEMPT_DELAY
+ * milliseconds, or as soon as the previous attempt fails, without aborting
+ * the pending attempts. The first established connection wins. Each attempt
+ * times out on its own after \p timeout milliseconds.
+ *
+ * @return the connected socket, or -1 on error.
+ */
+static int ConnectRace( vlc_object_t *p_this, const struct addrinfo *res,
+                        int timeout )
+{
+    size_t n = 0;
+
+    for( const struct addrinfo *p = res; p != NULL; p = p->ai_next )
+        n++;
+    if( n == 0 )
+        return -1;
+
+    const struct addrinfo *tab[n];
+    struct pollfd ufd[n];
+    mtime_t started[n];
+    unsigned active = 0;
+    size_t next = 0;
+    mtime_t next_start = 0; /* time of the next attempt (0: immediately) */
+    int i_handle = -1;
+
+    SortAddresses( res, tab );
+
+    while( i_handle == -1 )
+    {
+        mtime_t now = mdate();
+
+        /* Start the next attempt if it is time */
+        if( next < n && (active == 0 || now >= next_start) )
+        {
+            const struct addrinfo *ptr = tab[next++];
+            int fd = net_Socket( p_this, ptr->ai_family,
+                                 ptr->ai_socktype, ptr->ai_protocol );
+            if( fd == -1 )
+            {
+                msg_Dbg( p_this, "socket error: %s",
+                         vlc_strerror_c(net_errno) );
+                continue;
+            }
+
+            if( connect( fd, ptr->ai_addr, ptr->ai_addrlen ) == 0 )
+            {
+                i_handle = fd; /* success! */
+                break;
+            }
+
+            if( net_errno != EINPROGRESS && errno != EINTR )
+            {
+                msg_Err( p_this, "connection failed: %s",
+                         vlc_strerror_c(net_errno) );
+                net_Close( fd );
+                continue;
+            }
+
+            ufd[active].fd = fd;
+            ufd[active].events = POLLOUT;
+            started[active] = now;
+            active++;
+            next_start = now + CONNECTION_ATTEMPT_DELAY * INT64_C(1000);
+        }
+
+        if( active == 0 )
+        {
+            if( next < n )
+                continue;
+            break; /* all attempts failed */
+        }
+
+        /* Wait until the next attempt or the oldest attempt time-out */
+        mtime_t deadline = INT64_MAX;
+        if( next < n )
+            deadline = next_start;
+        if( timeout >= 0 )
+            deadline = __MIN( deadline,
+                              started[0] + timeout * INT64_C(1000) );
+
+        int delay = -1;
+        if( deadline != INT64_MAX )
+            delay = (deadline > now) ? (deadline - now + 999) / 1000 : 0;
+
+        if (vlc_killed())
+            break;
+
+        int val = vlc_poll_i11e( ufd, active, delay );
+        if( val == -1 )
+        {
+            if( errno == EINTR )
+                continue; /* NOTE: interrupted or killed: checked above */
+            msg_Err( p_this, "polling error: %s", vlc_strerror_c(net_errno) );
+            break;
+        }
+
+        now = mdate();
+        for( unsigned i = 0; i < active; )
+        {
+            bool failed;
+
+            if( ufd[i].revents )
+            {
+                /* There is NO WAY around checking SO_ERROR.
+                 * Don't ifdef it out!!! */
+                if( getsockopt( ufd[i].fd, SOL_SOCKET, SO_ERROR, &val,
+                                &(socklen_t){ sizeof (val) } ) || val )
+                {
+                    msg_Err( p_this, "connection failed: %s",
+                             vlc_strerror_c(val) );
+                    failed = true;
+                }
+                else
+                {
+                    i_handle = ufd[i].fd; /* success! */
+                    failed = false;
+                }
+            }
+            else
+            if( timeout >= 0 && now >= started[i] + timeout * INT64_C(1000) )
+            {
+                msg_Warn( p_this, "connection timed out" );
+                failed = true;
+            }
+            else
+            {
+                i++;
+                continue;
+            }
+
+            if( failed )
+                net_Close( ufd[i].fd );
+            /* Remove the attempt, keeping the oldest first */
+            active--;
+            memmove( ufd + i, ufd + i + 1, (active - i) * sizeof (*ufd) );
+            memmove( started + i, started + i + 1,
+                     (active - i) * sizeof (*started) );
+            if( failed )
+                next_start = 0; /* start the next attempt right away */
+            if( i_handle != -1 )
+                break;
+        }
+    }
+
+    /* Abort the slower attempts */
+    for( unsigned i = 0; i < active; i++ )
+        net_Close( ufd[i].fd );
+
+    if( i_handle != -1 )
+        msg_Dbg( p_this, "connection succeeded (socket = %d)", i_handle );
+    return i_handle;
+}
+
 #undef net_Connect
 /*****************************************************************************
  * net_Connect:
@@ -141,69 +333,7 @@ int net_Connect( vlc_object_t *p_this, const char *psz_host, int i_port,
     if (timeout < 0)
         timeout = -1;
 
-    for (struct addrinfo *ptr = res; ptr != NULL; ptr = ptr->ai_next)
-    {
-        int fd = net_Socket( p_this, ptr->ai_family,
-                             ptr->ai_socktype, ptr->ai_protocol );
-        if( fd == -1 )
-        {
-            msg_Dbg( p_this, "socket error: %s", vlc_strerror_c(net_errno) );
-            continue;
-        }
-
-        if( connect( fd, ptr->ai_addr, ptr->ai_addrlen ) )
-        {
-            if( net_errno != EINPROGRESS && errno != EINTR )
-            {
-                msg_Err( p_this, "connection failed: %s",
-                         vlc_strerror_c(net_errno) );
-                goto next_ai;
-            }
-
-            struct pollfd ufd;
-
-            ufd.fd = fd;
-            ufd.events = POLLOUT;
-
-            do  /* NOTE: timeout screwed up if we catch a signal (EINTR) */
-            {
-                if (vlc_killed())
-                    goto next_ai;
-
-                val = vlc_poll_i11e(&ufd, 1, timeout);
-            }
-            while (val == -1 && errno == EINTR);
-
-            switch (val)
-            {
-                 case -1: /* error */
-                     msg_Err (p_this, "polling error: %s",
-                              vlc_strerror_c(net_errno));
-                     goto next_ai;
-
-                 case 0: /* timeout */
-                     msg_Warn (p_this, "connection timed out");
-                     goto next_ai;
-            }
-
-            /* There is NO WAY around checking SO_ERROR.
-             * Don't ifdef it out!!! */
-            if (getsockopt (fd, SOL_SOCKET, SO_ERROR, &val,
-                            &(socklen_t){ sizeof (val) }) || val)
-            {
-                msg_Err (p_this, "connection failed: %s",
-                         vlc_strerror_c(val));
-                goto next_ai;
-            }
-        }
-
-        msg_Dbg( p_this, "connection succeeded (socket = %d)", fd );
-        i_handle = fd; /* success! */
-        break;
-
-next_ai: /* failure */
-        net_Close( fd );
-    }
+    i_handle = ConnectRace( p_this, res, timeout );
 
     freeaddrinfo( res );
 
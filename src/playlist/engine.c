@@ -230,6 +230,8 @@ playlist_t *playlist_Create( vlc_object_t *p_parent )
 
     pl_priv(p_playlist)->b_tree = var_InheritBool( p_parent, "playlist-tree" );
     pl_priv(p_playlist)->b_preparse = var_InheritBool( p_parent, "auto-preparse" );
+    pl_priv(p_playlist)->search.psz_string = NULL;
+    pl_priv(p_playlist)->search.p_root = NULL;
 
     /* Create the root, playing items and meida library nodes */
     playlist_item_t *root, *playing, *ml;
@@ -353,6 +355,7 @@ void playlist_Destroy( playlist_t *p_playlist )
 
     ARRAY_RESET( p_playlist->items );
     ARRAY_RESET( p_playlist->current );
+    free( p_sys->search.psz_string );
 
     vlc_http_cookie_jar_t *cookies = var_GetAddress( p_playlist, "http-cookies" );
     if ( cookies )
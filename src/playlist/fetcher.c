@@ -51,6 +51,9 @@ typedef enum
 } fetcher_pass_t;
 #define PASS_COUNT 2
 
+/* Maximum number of art downloads at the same time */
+#define DOWNLOAD_COUNT (PLAYLIST_FETCHER_THREADS - 1)
+
 typedef struct
 {
     char *psz_artist;
@@ -67,31 +70,61 @@ struct fetcher_entry_t
 {
     input_item_t    *p_item;
     input_item_meta_request_option_t i_options;
+    fetcher_pass_t   e_pass;
     fetcher_entry_t *p_next;
 };
 
+typedef struct fetcher_download_t fetcher_download_t;
+
+/* The entries waiting for the same art URL are downloaded only once */
+struct fetcher_download_t
+{
+    char               *psz_arturl;
+    fetcher_entry_t    *p_entries;
+    bool                b_started;
+    fetcher_download_t *p_next;
+};
+
+typedef struct
+{
+    playlist_fetcher_t *owner;
+    struct vlc_runnable runnable;
+    bool                b_live;
+    vlc_interrupt_t    *interrupt;
+} fetcher_downloader_t;
+
 struct playlist_fetcher_t
 {
     vlc_object_t   *object;
+    vlc_executor_t *executor;
+    struct vlc_runnable runnable;
     vlc_mutex_t     lock;
     vlc_cond_t      wait;
     bool            b_live;
     vlc_interrupt_t *interrupt;
 
+    bool            b_killed;
+
     fetcher_entry_t *p_waiting_head[PASS_COUNT];
     fetcher_entry_t *p_waiting_tail[PASS_COUNT];
 
+    fetcher_download_t  *p_downloads;
+    unsigned             i_downloaders;
+    fetcher_downloader_t downloaders[DOWNLOAD_COUNT];
+
     DECL_ARRAY(playlist_album_t) albums;
     meta_fetcher_scope_t e_scope;
 };
 
-static void *Thread( void * );
+static void Thread( void * );
+static void DownloadThread( void * );
 
 
 /*****************************************************************************
  * Public functions
  *****************************************************************************/
-playlist_fetcher_t *playlist_fetcher_New( vlc_object_t *parent )
+playlist_fetcher_t *playlist_fetcher_New( vlc_object_t *parent,
+                                          vlc_executor_t *executor )
 {
     playlist_fetcher_t *p_fetcher = malloc( sizeof(*p_fetcher) );
     if( !p_fetcher )
@@ -103,10 +136,34 @@ playlist_fetcher_t *playlist_fetcher_New( vlc_object_t *parent )
         free( p_fetcher );
         return NULL;
     }
+    for( unsigned i = 0; i < DOWNLOAD_COUNT; i++ )
+    {
+        fetcher_downloader_t *p_dl = &p_fetcher->downloaders[i];
+
+        p_dl->owner = p_fetcher;
+        p_dl->runnable.run = DownloadThread;
+        p_dl->runnable.userdata = p_dl;
+        p_dl->b_live = false;
+        p_dl->interrupt = vlc_interrupt_create();
+        if( unlikely(p_dl->interrupt == NULL) )
+        {
+            while( i-- > 0 )
+                vlc_interrupt_destroy( p_fetcher->downloaders[i].interrupt );
+            vlc_interrupt_destroy( p_fetcher->interrupt );
+            free( p_fetcher );
+            return NULL;
+        }
+    }
     p_fetcher->object = parent;
+    p_fetcher->executor = executor;
+    p_fetcher->runnable.run = Thread;
+    p_fetcher->runnable.userdata = p_fetcher;
     vlc_mutex_init( &p_fetcher->lock );
     vlc_cond_init( &p_fetcher->wait );
     p_fetcher->b_live = false;
+    p_fetcher->b_killed = false;
+    p_fetcher->p_downloads = NULL;
+    p_fetcher->i_downloaders = 0;
 
     if( var_InheritBool( parent, "metadata-network-access" ) )
         p_fetcher->e_scope = FETCHER_SCOPE_ANY;
@@ -121,34 +178,50 @@ playlist_fetcher_t *playlist_fetcher_New( vlc_object_t *parent )
     return p_fetcher;
 }
 
-void playlist_fetcher_Push( playlist_fetcher_t *p_fetcher, input_item_t *p_item,
-                            input_item_meta_request_option_t i_options )
+/**
+ * Appends an entry to the queue of a pass, and starts the fetcher thread if
+ * needed. The fetcher lock must be held.
+ */
+static void Enqueue( playlist_fetcher_t *p_fetcher, fetcher_entry_t *p_entry,
+                     fetcher_pass_t e_pass )
 {
-    fetcher_entry_t *p_entry = malloc( sizeof(fetcher_entry_t) );
-    if ( !p_entry ) return;
+    if( p_fetcher->b_killed )
+    {
+        vlc_gc_decref( p_entry->p_item );
+        free( p_entry );
+        return;
+    }
 
-    vlc_gc_incref( p_item );
-    p_entry->p_item = p_item;
+    p_entry->e_pass = e_pass;
     p_entry->p_next = NULL;
-    p_entry->i_options = i_options;
-    vlc_mutex_lock( &p_fetcher->lock );
     /* Append last */
-    if ( p_fetcher->p_waiting_head[PASS1_LOCAL] )
-        p_fetcher->p_waiting_tail[PASS1_LOCAL]->p_next = p_entry;
+    if ( p_fetcher->p_waiting_head[e_pass] )
+        p_fetcher->p_waiting_tail[e_pass]->p_next = p_entry;
     else
-        p_fetcher->p_waiting_head[PASS1_LOCAL] = p_entry;
-    p_fetcher->p_waiting_tail[PASS1_LOCAL] = p_entry;
+        p_fetcher->p_waiting_head[e_pass] = p_entry;
+    p_fetcher->p_waiting_tail[e_pass] = p_entry;
 
     if( !p_fetcher->b_live )
     {
-        assert( p_fetcher->p_waiting_head[PASS1_LOCAL] );
-        if( vlc_clone_detach( NULL, Thread, p_fetcher,
-                              VLC_THREAD_PRIORITY_LOW ) )
+        if( vlc_executor_Submit( p_fetcher->executor, &p_fetcher->runnable ) )
             msg_Err( p_fetcher->object,
                      "cannot spawn secondary preparse thread" );
         else
             p_fetcher->b_live = true;
     }
+}
+
+void playlist_fetcher_Push( playlist_fetcher_t *p_fetcher, input_item_t *p_item,
+                            input_item_meta_request_option_t i_options )
+{
+    fetcher_entry_t *p_entry = malloc( sizeof(fetcher_entry_t) );
+    if ( !p_entry ) return;
+
+    vlc_gc_incref( p_item );
+    p_entry->p_item = p_item;
+    p_entry->i_options = i_options;
+    vlc_mutex_lock( &p_fetcher->lock );
+    Enqueue( p_fetcher, p_entry, PASS1_LOCAL );
     vlc_mutex_unlock( &p_fetcher->lock );
 }
 
@@ -159,6 +232,45 @@ void playlist_fetcher_Delete( playlist_fetcher_t *p_fetcher )
     vlc_interrupt_kill(p_fetcher->interrupt);
 
     vlc_mutex_lock( &p_fetcher->lock );
+    p_fetcher->b_killed = true;
+    if( p_fetcher->b_live
+     && vlc_executor_Cancel( p_fetcher->executor, &p_fetcher->runnable ) )
+        p_fetcher->b_live = false;
+    for( unsigned i = 0; i < DOWNLOAD_COUNT; i++ )
+    {
+        fetcher_downloader_t *p_downloader = &p_fetcher->downloaders[i];
+
+        vlc_interrupt_kill( p_downloader->interrupt );
+        if( p_downloader->b_live
+         && vlc_executor_Cancel( p_fetcher->executor,
+                                 &p_downloader->runnable ) )
+        {
+            p_downloader->b_live = false;
+            p_fetcher->i_downloaders--;
+        }
+    }
+
+    /* Remove the downloads not started yet */
+    for( fetcher_download_t **pp = &p_fetcher->p_downloads; *pp != NULL; )
+    {
+        fetcher_download_t *p_dl = *pp;
+        if( p_dl->b_started )
+        {
+            pp = &p_dl->p_next;
+            continue;
+        }
+        *pp = p_dl->p_next;
+        while( p_dl->p_entries )
+        {
+            p_next = p_dl->p_entries->p_next;
+            vlc_gc_decref( p_dl->p_entries->p_item );
+            free( p_dl->p_entries );
+            p_dl->p_entries = p_next;
+        }
+        free( p_dl->psz_arturl );
+        free( p_dl );
+    }
+
     /* Remove any left-over item, the fetcher will exit */
     for ( int i_queue=0; i_queue<PASS_COUNT; i_queue++ )
     {
@@ -172,13 +284,16 @@ void playlist_fetcher_Delete( playlist_fetcher_t *p_fetcher )
         p_fetcher->p_waiting_head[i_queue] = NULL;
     }
 
-    while( p_fetcher->b_live )
+    while( p_fetcher->b_live || p_fetcher->i_downloaders > 0 )
         vlc_cond_wait( &p_fetcher->wait, &p_fetcher->lock );
+    assert( p_fetcher->p_downloads == NULL );
     vlc_mutex_unlock( &p_fetcher->lock );
 
     vlc_cond_destroy( &p_fetcher->wait );
     vlc_mutex_destroy( &p_fetcher->lock );
 
+    for( unsigned i = 0; i < DOWNLOAD_COUNT; i++ )
+        vlc_interrupt_destroy( p_fetcher->downloaders[i].interrupt );
     vlc_interrupt_destroy( p_fetcher->interrupt );
 
     playlist_album_t album;
@@ -355,31 +470,51 @@ static int FindArt( playlist_fetcher_t *p_fetcher, input_item_t *p_item )
 }
 
 /**
- * Download the art using the URL or an art downloaded
- * This function should be called only if data is not already in cache
+ * Marks the art of an entry as fetched or not found, or moves the entry to
+ * the next pass, and releases it.
  */
-static int DownloadArt( playlist_fetcher_t *p_fetcher, input_item_t *p_item )
+static void Finish( playlist_fetcher_t *p_fetcher, fetcher_entry_t *p_entry,
+                    int i_ret )
 {
-    char *psz_arturl = input_item_GetArtURL( p_item );
-    assert( *psz_arturl );
+    vlc_object_t *obj = p_fetcher->object;
 
-    if( !strncmp( psz_arturl , "file://", 7 ) )
+    if ( i_ret != VLC_SUCCESS && (p_entry->e_pass != PASS2_NETWORK) )
     {
-        msg_Dbg( p_fetcher->object,
-                 "Album art is local file, no need to cache" );
-        free( psz_arturl );
-        return VLC_SUCCESS;
+        /* Move our entry to next pass queue */
+        vlc_mutex_lock( &p_fetcher->lock );
+        Enqueue( p_fetcher, p_entry, p_entry->e_pass + 1 );
+        vlc_mutex_unlock( &p_fetcher->lock );
     }
-
-    if( !strncmp( psz_arturl , "APIC", 4 ) )
+    else
     {
-        msg_Warn( p_fetcher->object, "APIC fetch not supported yet" );
-        goto error;
+        /* */
+        char *psz_name = input_item_GetName( p_entry->p_item );
+        if( i_ret == VLC_SUCCESS ) /* Art is now in cache */
+        {
+            msg_Dbg( obj, "found art for %s in cache", psz_name );
+            input_item_SetArtFetched( p_entry->p_item, true );
+            var_SetAddress( obj, "item-change", p_entry->p_item );
+        }
+        else
+        {
+            msg_Dbg( obj, "art not found for %s", psz_name );
+            input_item_SetArtNotFound( p_entry->p_item, true );
+        }
+        free( psz_name );
+        vlc_gc_decref( p_entry->p_item );
+        free( p_entry );
     }
+}
 
-    stream_t *p_stream = vlc_stream_NewMRL( p_fetcher->object, psz_arturl );
+/**
+ * Reads the whole art data from an URL
+ */
+static int ReadArt( vlc_object_t *obj, const char *psz_arturl,
+                    uint8_t **pp_data, int *pi_data )
+{
+    stream_t *p_stream = vlc_stream_NewMRL( obj, psz_arturl );
     if( !p_stream )
-        goto error;
+        return VLC_EGENERIC;
 
     uint8_t *p_data = NULL;
     int i_data = 0;
@@ -402,20 +537,167 @@ static int DownloadArt( playlist_fetcher_t *p_fetcher, input_item_t *p_item )
     }
     vlc_stream_Delete( p_stream );
 
-    if( p_data && i_data > 0 )
+    *pp_data = p_data;
+    *pi_data = p_data ? i_data : 0;
+    return VLC_SUCCESS;
+}
+
+static void DownloadThread( void *data )
+{
+    fetcher_downloader_t *p_downloader = data;
+    playlist_fetcher_t *p_fetcher = p_downloader->owner;
+    vlc_object_t *obj = p_fetcher->object;
+
+    vlc_interrupt_set( p_downloader->interrupt );
+
+    for( ;; )
     {
-        char *psz_type = strrchr( psz_arturl, '.' );
+        fetcher_download_t *p_dl;
+
+        vlc_mutex_lock( &p_fetcher->lock );
+        for( p_dl = p_fetcher->p_downloads; p_dl != NULL; p_dl = p_dl->p_next )
+            if( !p_dl->b_started )
+                break;
+
+        if( p_dl == NULL )
+        {
+            vlc_interrupt_set( NULL );
+            p_downloader->b_live = false;
+            p_fetcher->i_downloaders--;
+            vlc_cond_signal( &p_fetcher->wait );
+            vlc_mutex_unlock( &p_fetcher->lock );
+            break;
+        }
+        p_dl->b_started = true;
+        vlc_mutex_unlock( &p_fetcher->lock );
+
+        uint8_t *p_data = NULL;
+        int i_data = 0;
+        int i_ret = ReadArt( obj, p_dl->psz_arturl, &p_data, &i_data );
+
+        /* No entry can be added to this download anymore */
+        vlc_mutex_lock( &p_fetcher->lock );
+        fetcher_download_t **pp = &p_fetcher->p_downloads;
+        while( *pp != p_dl )
+            pp = &(*pp)->p_next;
+        *pp = p_dl->p_next;
+        vlc_mutex_unlock( &p_fetcher->lock );
+
+        char *psz_type = strrchr( p_dl->psz_arturl, '.' );
         if( psz_type && strlen( psz_type ) > 5 )
             psz_type = NULL; /* remove extension if it's > to 4 characters */
 
-        playlist_SaveArt( p_fetcher->object, p_item,
-                          p_data, i_data, psz_type );
+        while( p_dl->p_entries != NULL )
+        {
+            fetcher_entry_t *p_entry = p_dl->p_entries;
+
+            p_dl->p_entries = p_entry->p_next;
+            if( p_data && i_data > 0 )
+                playlist_SaveArt( obj, p_entry->p_item,
+                                  p_data, i_data, psz_type );
+            Finish( p_fetcher, p_entry, i_ret );
+        }
+
+        free( p_data );
+        free( p_dl->psz_arturl );
+        free( p_dl );
     }
+}
 
-    free( p_data );
+/* DownloadArt() return value when a download thread will finish the entry */
+#define DOWNLOAD_QUEUED 1
 
-    free( psz_arturl );
-    return VLC_SUCCESS;
+/**
+ * Download the art using the URL or an art downloaded
+ * This function should be called only if data is not already in cache
+ *
+ * The art is downloaded asynchronously, and only once for all the entries
+ * sharing the same art URL.
+ */
+static int DownloadArt( playlist_fetcher_t *p_fetcher,
+                        fetcher_entry_t *p_entry )
+{
+    char *psz_arturl = input_item_GetArtURL( p_entry->p_item );
+    assert( *psz_arturl );
+
+    if( !strncmp( psz_arturl , "file://", 7 ) )
+    {
+        msg_Dbg( p_fetcher->object,
+                 "Album art is local file, no need to cache" );
+        free( psz_arturl );
+        return VLC_SUCCESS;
+    }
+
+    if( !strncmp( psz_arturl , "APIC", 4 ) )
+    {
+        msg_Warn( p_fetcher->object, "APIC fetch not supported yet" );
+        goto error;
+    }
+
+    vlc_mutex_lock( &p_fetcher->lock );
+    if( p_fetcher->b_killed )
+    {
+        vlc_mutex_unlock( &p_fetcher->lock );
+        goto error;
+    }
+
+    /* The same art is already being downloaded */
+    fetcher_download_t **pp = &p_fetcher->p_downloads;
+    for( ; *pp != NULL; pp = &(*pp)->p_next )
+    {
+        fetcher_download_t *p_dl = *pp;
+        if( !strcmp( p_dl->psz_arturl, psz_arturl ) )
+        {
+            msg_Dbg( p_fetcher->object, "%s is already being downloaded",
+                     psz_arturl );
+            p_entry->p_next = p_dl->p_entries;
+            p_dl->p_entries = p_entry;
+            vlc_mutex_unlock( &p_fetcher->lock );
+            free( psz_arturl );
+            return DOWNLOAD_QUEUED;
+        }
+    }
+
+    fetcher_download_t *p_dl = malloc( sizeof( *p_dl ) );
+    if( unlikely(p_dl == NULL) )
+    {
+        vlc_mutex_unlock( &p_fetcher->lock );
+        goto error;
+    }
+    p_dl->psz_arturl = psz_arturl;
+    p_entry->p_next = NULL;
+    p_dl->p_entries = p_entry;
+    p_dl->b_started = false;
+    p_dl->p_next = NULL;
+    *pp = p_dl;
+
+    for( unsigned i = 0; i < DOWNLOAD_COUNT; i++ )
+    {
+        fetcher_downloader_t *p_downloader = &p_fetcher->downloaders[i];
+        if( p_downloader->b_live )
+            continue;
+
+        if( vlc_executor_Submit( p_fetcher->executor,
+                                 &p_downloader->runnable ) )
+            msg_Err( p_fetcher->object, "cannot spawn art download thread" );
+        else
+        {
+            p_downloader->b_live = true;
+            p_fetcher->i_downloaders++;
+        }
+        break;
+    }
+
+    if( p_fetcher->i_downloaders == 0 )
+    {
+        /* Nobody will download it */
+        *pp = NULL;
+        vlc_mutex_unlock( &p_fetcher->lock );
+        free( p_dl );
+        goto error;
+    }
+    vlc_mutex_unlock( &p_fetcher->lock );
+    return DOWNLOAD_QUEUED;
 
 error:
     free( psz_arturl );
@@ -444,10 +726,9 @@ static void FetchMeta( playlist_fetcher_t *p_fetcher, input_item_t *p_item )
     vlc_object_release( p_finder );
 }
 
-static void *Thread( void *p_data )
+static void Thread( void *p_data )
 {
     playlist_fetcher_t *p_fetcher = p_data;
-    vlc_object_t *obj = p_fetcher->object;
     fetcher_pass_t e_pass = PASS1_LOCAL;
 
     vlc_interrupt_set(p_fetcher->interrupt);
@@ -528,7 +809,7 @@ static void *Thread( void *p_data )
             switch( i_ret )
             {
             case 1: /* Found, need to dl */
-                i_ret = DownloadArt( p_fetcher, p_entry->p_item );
+                i_ret = DownloadArt( p_fetcher, p_entry );
                 break;
             case 0: /* Is in cache */
                 i_ret = VLC_SUCCESS;
@@ -539,37 +820,10 @@ static void *Thread( void *p_data )
         }
 
         p_fetcher->e_scope = e_prev_scope;
-        /* */
-        if ( i_ret != VLC_SUCCESS && (e_pass != PASS2_NETWORK) )
-        {
-            /* Move our entry to next pass queue */
-            vlc_mutex_lock( &p_fetcher->lock );
-            if ( p_fetcher->p_waiting_head[e_pass + 1] )
-                p_fetcher->p_waiting_tail[e_pass + 1]->p_next = p_entry;
-            else
-                p_fetcher->p_waiting_head[e_pass + 1] = p_entry;
-            p_fetcher->p_waiting_tail[e_pass + 1] = p_entry;
-            vlc_mutex_unlock( &p_fetcher->lock );
-        }
-        else
-        {
-            /* */
-            char *psz_name = input_item_GetName( p_entry->p_item );
-            if( i_ret == VLC_SUCCESS ) /* Art is now in cache */
-            {
-                msg_Dbg( obj, "found art for %s in cache", psz_name );
-                input_item_SetArtFetched( p_entry->p_item, true );
-                var_SetAddress( obj, "item-change", p_entry->p_item );
-            }
-            else
-            {
-                msg_Dbg( obj, "art not found for %s", psz_name );
-                input_item_SetArtNotFound( p_entry->p_item, true );
-            }
-            free( psz_name );
-            vlc_gc_decref( p_entry->p_item );
-            free( p_entry );
-        }
+
+        /* The download thread will finish the entry */
+        if( i_ret == DOWNLOAD_QUEUED )
+            continue;
+        Finish( p_fetcher, p_entry, i_ret );
     }
-    return NULL;
 }
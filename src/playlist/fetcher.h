@@ -26,6 +26,7 @@
 #define _PLAYLIST_FETCHER_H 1
 
 #include <vlc_input_item.h>
+#include <vlc_executor.h>
 
 /**
  * Fetcher opaque structure.
@@ -36,9 +37,17 @@
 typedef struct playlist_fetcher_t playlist_fetcher_t;
 
 /**
- * This function creates the fetcher object and thread.
+ * Maximum number of threads used by a fetcher at the same time.
  */
-playlist_fetcher_t *playlist_fetcher_New( vlc_object_t * );
+#define PLAYLIST_FETCHER_THREADS 5
+
+/**
+ * This function creates the fetcher object.
+ *
+ * The fetcher runs on threads of the given executor, which should allow
+ * for PLAYLIST_FETCHER_THREADS threads for the fetcher alone.
+ */
+playlist_fetcher_t *playlist_fetcher_New( vlc_object_t *, vlc_executor_t * );
 
 /**
  * This function enqueues the provided item to be art fetched.
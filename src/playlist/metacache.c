@@ -0,0 +1,383 @@
+/*****************************************************************************
+ * metacache.c: persistent cache of the preparsed metadata
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <vlc_common.h>
+#include <vlc_input_item.h>
+#include <vlc_meta.h>
+#include <vlc_es.h>
+#include <vlc_fs.h>
+#include <vlc_url.h>
+#include <vlc_md5.h>
+
+#include "metacache.h"
+#include "input/item.h"
+
+/* Each cached item is stored in its own text file, named after the MD5 hash
+ * of its URI. The file starts with the URI, size and modification time of
+ * the media file, which must all match for the entry to be used:
+ *
+ *   vlc-meta-cache 1
+ *   uri <uri>
+ *   size <bytes>
+ *   mtime <seconds>
+ *   name <name>
+ *   duration <microseconds>
+ *   meta <type> <value>
+ *   es <category> <codec> <id> <rate/width> <channels/height> <language>
+ *
+ * Line feeds and backslashes within the strings are escaped. Entries are
+ * written to a temporary file first, then renamed, so that concurrent
+ * preparser threads and processes never read a partial entry. */
+#define METACACHE_HEADER "vlc-meta-cache 1"
+
+typedef struct
+{
+    char     *psz_uri;
+    uint64_t  i_size;
+    int64_t   i_mtime;
+} metacache_id_t;
+
+static int MetaCacheGetId( input_item_t *p_item, metacache_id_t *p_id )
+{
+    vlc_mutex_lock( &p_item->lock );
+    char *psz_uri = p_item->psz_uri ? strdup( p_item->psz_uri ) : NULL;
+    vlc_mutex_unlock( &p_item->lock );
+
+    if( psz_uri == NULL || strncmp( psz_uri, "file://", 7 ) )
+        goto error;
+
+    char *psz_path = vlc_uri2path( psz_uri );
+    if( psz_path == NULL )
+        goto error;
+
+    struct stat st;
+    int i_ret = vlc_stat( psz_path, &st );
+    free( psz_path );
+    if( i_ret || !S_ISREG( st.st_mode ) )
+        goto error;
+
+    p_id->psz_uri = psz_uri;
+    p_id->i_size = st.st_size;
+    p_id->i_mtime = st.st_mtime;
+    return VLC_SUCCESS;
+
+error:
+    free( psz_uri );
+    return VLC_EGENERIC;
+}
+
+static char *MetaCacheGetDir( void )
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    char *psz_dir;
+
+    if( psz_cachedir == NULL
+     || asprintf( &psz_dir, "%s" DIR_SEP "meta", psz_cachedir ) == -1 )
+        psz_dir = NULL;
+    free( psz_cachedir );
+    return psz_dir;
+}
+
+static char *MetaCacheGetPath( const char *psz_dir, const char *psz_uri )
+{
+    struct md5_s md5;
+    InitMD5( &md5 );
+    AddMD5( &md5, psz_uri, strlen( psz_uri ) );
+    EndMD5( &md5 );
+
+    char *psz_hash = psz_md5_hash( &md5 );
+    char *psz_path;
+
+    if( psz_hash == NULL
+     || asprintf( &psz_path, "%s" DIR_SEP "%s", psz_dir, psz_hash ) == -1 )
+        psz_path = NULL;
+    free( psz_hash );
+    return psz_path;
+}
+
+static void WriteString( FILE *file, const char *psz )
+{
+    for( ; *psz; psz++ )
+    {
+        if( *psz == '\\' )
+            fputs( "\\\\", file );
+        else if( *psz == '\n' )
+            fputs( "\\n", file );
+        else
+            fputc( *psz, file );
+    }
+}
+
+/* Unescapes a string in place */
+static char *ReadString( char *psz )
+{
+    char *in = psz, *out = psz;
+
+    while( *in )
+    {
+        if( *in == '\\' && in[1] != '\0' )
+        {
+            in++;
+            *out++ = *in == 'n' ? '\n' : *in;
+            in++;
+        }
+        else
+            *out++ = *in++;
+    }
+    *out = '\0';
+    return psz;
+}
+
+static void ReadTrack( input_item_t *p_item, char *psz )
+{
+    int i_cat, i_id, i_offset;
+    uint32_t i_codec;
+    unsigned i_param1, i_param2;
+
+    if( sscanf( psz, "%d %"SCNx32" %d %u %u%n", &i_cat, &i_codec, &i_id,
+                &i_param1, &i_param2, &i_offset ) != 5 )
+        return;
+
+    es_format_t fmt;
+    es_format_Init( &fmt, i_cat, i_codec );
+    fmt.i_id = i_id;
+    switch( i_cat )
+    {
+        case AUDIO_ES:
+            fmt.audio.i_rate = i_param1;
+            fmt.audio.i_channels = i_param2;
+            break;
+        case VIDEO_ES:
+            fmt.video.i_width = fmt.video.i_visible_width = i_param1;
+            fmt.video.i_height = fmt.video.i_visible_height = i_param2;
+            break;
+        default:
+            break;
+    }
+
+    psz += i_offset;
+    if( *psz == ' ' && psz[1] != '\0' )
+        fmt.psz_language = strdup( ReadString( psz + 1 ) );
+
+    input_item_UpdateTracksInfo( p_item, &fmt );
+    es_format_Clean( &fmt );
+}
+
+int playlist_LoadMetaFromCache( vlc_object_t *obj, input_item_t *p_item )
+{
+    metacache_id_t id;
+    if( MetaCacheGetId( p_item, &id ) )
+        return VLC_EGENERIC;
+
+    char *psz_dir = MetaCacheGetDir();
+    char *psz_path = psz_dir ? MetaCacheGetPath( psz_dir, id.psz_uri ) : NULL;
+    FILE *file = psz_path ? vlc_fopen( psz_path, "rt" ) : NULL;
+    free( psz_dir );
+
+    int i_ret = VLC_EGENERIC;
+    if( file == NULL )
+        goto end;
+
+    char *line = NULL;
+    size_t i_linesize = 0;
+    ssize_t i_len;
+    unsigned i_header = 0;
+    bool b_valid = true;
+
+    while( ( i_len = getline( &line, &i_linesize, file ) ) != -1 )
+    {
+        if( i_len > 0 && line[i_len - 1] == '\n' )
+            line[i_len - 1] = '\0';
+
+        /* The entry must be for the same, unmodified file */
+        if( i_header < 4 )
+        {
+            switch( i_header++ )
+            {
+                case 0:
+                    b_valid = !strcmp( line, METACACHE_HEADER );
+                    break;
+                case 1:
+                    b_valid = !strncmp( line, "uri ", 4 )
+                           && !strcmp( ReadString( line + 4 ), id.psz_uri );
+                    break;
+                case 2:
+                    b_valid = !strncmp( line, "size ", 5 )
+                           && strtoull( line + 5, NULL, 10 ) == id.i_size;
+                    break;
+                default:
+                    b_valid = !strncmp( line, "mtime ", 6 )
+                           && strtoll( line + 6, NULL, 10 ) == id.i_mtime;
+                    break;
+            }
+            if( !b_valid )
+                break;
+            continue;
+        }
+
+        if( !strncmp( line, "name ", 5 ) )
+            input_item_SetName( p_item, ReadString( line + 5 ) );
+        else if( !strncmp( line, "duration ", 9 ) )
+            input_item_SetDuration( p_item, strtoll( line + 9, NULL, 10 ) );
+        else if( !strncmp( line, "meta ", 5 ) )
+        {
+            char *psz_value;
+            unsigned long i_type = strtoul( line + 5, &psz_value, 10 );
+
+            if( i_type < VLC_META_TYPE_COUNT && *psz_value == ' ' )
+                input_item_SetMeta( p_item, i_type,
+                                    ReadString( psz_value + 1 ) );
+        }
+        else if( !strncmp( line, "es ", 3 ) )
+            ReadTrack( p_item, line + 3 );
+    }
+    free( line );
+    fclose( file );
+
+    if( b_valid && i_header == 4 )
+    {
+        msg_Dbg( obj, "using cached meta data for %s", id.psz_uri );
+        i_ret = VLC_SUCCESS;
+    }
+end:
+    free( psz_path );
+    free( id.psz_uri );
+    return i_ret;
+}
+
+static void WriteItem( FILE *file, input_item_t *p_item,
+                       const metacache_id_t *p_id )
+{
+    fputs( METACACHE_HEADER "\nuri ", file );
+    WriteString( file, p_id->psz_uri );
+    fprintf( file, "\nsize %"PRIu64"\nmtime %"PRId64"\n",
+             p_id->i_size, p_id->i_mtime );
+
+    vlc_mutex_lock( &p_item->lock );
+    if( p_item->psz_name != NULL )
+    {
+        fputs( "name ", file );
+        WriteString( file, p_item->psz_name );
+        fputc( '\n', file );
+    }
+    fprintf( file, "duration %"PRId64"\n", p_item->i_duration );
+
+    for( int i = 0; p_item->p_meta != NULL && i < VLC_META_TYPE_COUNT; i++ )
+    {
+        const char *psz_value = vlc_meta_Get( p_item->p_meta, i );
+        if( psz_value == NULL )
+            continue;
+        fprintf( file, "meta %d ", i );
+        WriteString( file, psz_value );
+        fputc( '\n', file );
+    }
+
+    for( int i = 0; i < p_item->i_es; i++ )
+    {
+        const es_format_t *p_fmt = p_item->es[i];
+        unsigned i_param1 = 0, i_param2 = 0;
+
+        if( p_fmt->i_cat == AUDIO_ES )
+        {
+            i_param1 = p_fmt->audio.i_rate;
+            i_param2 = p_fmt->audio.i_channels;
+        }
+        else if( p_fmt->i_cat == VIDEO_ES )
+        {
+            i_param1 = p_fmt->video.i_visible_width;
+            i_param2 = p_fmt->video.i_visible_height;
+        }
+        fprintf( file, "es %d %08"PRIx32" %d %u %u", p_fmt->i_cat,
+                 p_fmt->i_codec, p_fmt->i_id, i_param1, i_param2 );
+        if( p_fmt->psz_language != NULL )
+        {
+            fputc( ' ', file );
+            WriteString( file, p_fmt->psz_language );
+        }
+        fputc( '\n', file );
+    }
+    vlc_mutex_unlock( &p_item->lock );
+}
+
+void playlist_SaveMetaToCache( vlc_object_t *obj, input_item_t *p_item )
+{
+    vlc_mutex_lock( &p_item->lock );
+    /* Playlists, whose sub-items are not stored, have no tracks. Embedded
+     * art can only be extracted by the input. */
+    const char *psz_arturl = p_item->p_meta != NULL ?
+        vlc_meta_Get( p_item->p_meta, vlc_meta_ArtworkURL ) : NULL;
+    bool b_cache = p_item->i_es > 0
+        && ( psz_arturl == NULL || strncmp( psz_arturl, "attachment://", 13 ) );
+    vlc_mutex_unlock( &p_item->lock );
+
+    metacache_id_t id;
+    if( !b_cache || MetaCacheGetId( p_item, &id ) )
+        return;
+
+    char *psz_dir = MetaCacheGetDir();
+    char *psz_path = psz_dir ? MetaCacheGetPath( psz_dir, id.psz_uri ) : NULL;
+    char *psz_tmp;
+
+    if( psz_path == NULL
+     || asprintf( &psz_tmp, "%s.%lu", psz_path, vlc_thread_id() ) == -1 )
+        goto end;
+
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( psz_cachedir != NULL )
+    {
+        vlc_mkdir( psz_cachedir, 0700 );
+        free( psz_cachedir );
+    }
+    vlc_mkdir( psz_dir, 0700 );
+
+    FILE *file = vlc_fopen( psz_tmp, "wt" );
+    if( file == NULL )
+    {
+        msg_Warn( obj, "cannot create %s: %s", psz_tmp,
+                  vlc_strerror_c(errno) );
+        free( psz_tmp );
+        goto end;
+    }
+
+    WriteItem( file, p_item, &id );
+
+    bool b_error = ferror( file ) != 0;
+    if( fclose( file ) )
+        b_error = true;
+    if( b_error || vlc_rename( psz_tmp, psz_path ) )
+    {
+        msg_Warn( obj, "cannot write %s: %s", psz_path,
+                  vlc_strerror_c(errno) );
+        vlc_unlink( psz_tmp );
+    }
+    free( psz_tmp );
+end:
+    free( psz_path );
+    free( psz_dir );
+    free( id.psz_uri );
+}
@@ -0,0 +1,38 @@
+/*****************************************************************************
+ * metacache.h: persistent cache of the preparsed metadata
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _PLAYLIST_METACACHE_H
+#define _PLAYLIST_METACACHE_H 1
+
+/**
+ * Restores the name, duration, meta data and tracks of a local file item
+ * from the cache, if the file was not modified since they were stored.
+ *
+ * \return VLC_SUCCESS if the item was found in the cache
+ */
+int playlist_LoadMetaFromCache( vlc_object_t *, input_item_t * );
+
+/**
+ * Stores the name, duration, meta data and tracks of a preparsed local file
+ * item in the cache.
+ */
+void playlist_SaveMetaToCache( vlc_object_t *, input_item_t * );
+
+#endif
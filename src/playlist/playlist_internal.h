@@ -87,6 +87,13 @@ typedef struct playlist_private_t
 
     bool     b_tree; /**< Display as a tree */
     bool     b_preparse; /**< Preparse items */
+
+    struct {
+        /* Last live search, to only refine it when it is extended */
+        char            *psz_string;
+        playlist_item_t *p_root;
+        bool             b_recursive;
+    } search;
 } playlist_private_t;
 
 #define pl_priv( pl ) ((playlist_private_t *)(pl))
@@ -28,9 +28,13 @@
 #include <assert.h>
 
 #include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_executor.h>
+#include <vlc_modules.h>
 
 #include "fetcher.h"
 #include "preparser.h"
+#include "metacache.h"
 #include "input/input_interface.h"
 
 /*****************************************************************************
@@ -46,28 +50,41 @@ struct preparser_entry_t
     mtime_t          timeout;
 };
 
-struct playlist_preparser_t
+typedef struct preparser_worker_t
 {
-    vlc_object_t        *object;
-    playlist_fetcher_t  *p_fetcher;
-    mtime_t              default_timeout;
+    playlist_preparser_t *owner;
+    struct vlc_runnable  runnable;
+    bool                 b_live;
 
+    input_item_t        *p_item; /* item being preparsed, if any */
     void                *input_id;
     enum {
         INPUT_RUNNING,
         INPUT_STOPPED,
         INPUT_CANCELED,
     } input_state;
+    vlc_cond_t           thread_wait;
+} preparser_worker_t;
+
+struct playlist_preparser_t
+{
+    vlc_object_t        *object;
+    playlist_fetcher_t  *p_fetcher;
+    vlc_executor_t      *executor;
+    mtime_t              default_timeout;
+    bool                 b_cache;
 
     vlc_mutex_t     lock;
     vlc_cond_t      wait;
-    vlc_cond_t      thread_wait;
-    bool            b_live;
+    unsigned        i_live;
     preparser_entry_t  **pp_waiting;
     size_t          i_waiting;
+
+    unsigned            i_workers;
+    preparser_worker_t *p_workers;
 };
 
-static void *Thread( void * );
+static void Thread( void * );
 
 /*****************************************************************************
  * Public functions
@@ -78,18 +95,52 @@ playlist_preparser_t *playlist_preparser_New( vlc_object_t *parent )
     if( !p_preparser )
         return NULL;
 
-    p_preparser->input_id = NULL;
-    p_preparser->input_state = INPUT_RUNNING;
+    int64_t i_workers = var_InheritInteger( parent, "preparse-threads" );
+    p_preparser->i_workers = VLC_CLIP( i_workers, 1, 16 );
+    p_preparser->p_workers = calloc( p_preparser->i_workers,
+                                     sizeof(*p_preparser->p_workers) );
+    if( unlikely(p_preparser->p_workers == NULL) )
+    {
+        free( p_preparser );
+        return NULL;
+    }
+
+    /* The preparser and fetcher threads are only spawned when needed */
+    p_preparser->executor =
+        vlc_executor_New( p_preparser->i_workers + PLAYLIST_FETCHER_THREADS,
+                          VLC_THREAD_PRIORITY_LOW );
+    if( unlikely(p_preparser->executor == NULL) )
+    {
+        free( p_preparser->p_workers );
+        free( p_preparser );
+        return NULL;
+    }
+
+    for( unsigned i = 0; i < p_preparser->i_workers; i++ )
+    {
+        preparser_worker_t *worker = &p_preparser->p_workers[i];
+
+        worker->owner = p_preparser;
+        worker->runnable.run = Thread;
+        worker->runnable.userdata = worker;
+        worker->b_live = false;
+        worker->p_item = NULL;
+        worker->input_id = NULL;
+        worker->input_state = INPUT_RUNNING;
+        vlc_cond_init( &worker->thread_wait );
+    }
+
     p_preparser->object = parent;
     p_preparser->default_timeout = var_InheritInteger( parent, "preparse-timeout" );
-    p_preparser->p_fetcher = playlist_fetcher_New( parent );
+    p_preparser->b_cache = var_InheritBool( parent, "preparse-cache" );
+    p_preparser->p_fetcher = playlist_fetcher_New( parent,
+                                                   p_preparser->executor );
     if( unlikely(p_preparser->p_fetcher == NULL) )
         msg_Err( parent, "cannot create fetcher" );
 
     vlc_mutex_init( &p_preparser->lock );
     vlc_cond_init( &p_preparser->wait );
-    vlc_cond_init( &p_preparser->thread_wait );
-    p_preparser->b_live = false;
+    p_preparser->i_live = 0;
     p_preparser->i_waiting = 0;
     p_preparser->pp_waiting = NULL;
 
@@ -100,26 +151,61 @@ void playlist_preparser_Push( playlist_preparser_t *p_preparser, input_item_t *p
                               input_item_meta_request_option_t i_options,
                               int timeout, void *id )
 {
-    preparser_entry_t *p_entry = malloc( sizeof(preparser_entry_t) );
+    mtime_t i_timeout =
+        (timeout < 0 ? p_preparser->default_timeout : timeout) * 1000;
+
+    vlc_mutex_lock( &p_preparser->lock );
+
+    /* The same request is already waiting: merge them */
+    for( size_t i = 0; i < p_preparser->i_waiting; i++ )
+    {
+        preparser_entry_t *p_entry = p_preparser->pp_waiting[i];
+        if( p_entry->p_item == p_item && p_entry->id == id )
+        {
+            p_entry->i_options |= i_options;
+            if( p_entry->timeout > 0
+             && ( i_timeout <= 0 || i_timeout > p_entry->timeout ) )
+                p_entry->timeout = i_timeout;
+            vlc_mutex_unlock( &p_preparser->lock );
+            return;
+        }
+    }
 
+    preparser_entry_t *p_entry = malloc( sizeof(preparser_entry_t) );
     if ( !p_entry )
+    {
+        vlc_mutex_unlock( &p_preparser->lock );
         return;
+    }
     p_entry->p_item = p_item;
     p_entry->i_options = i_options;
     p_entry->id = id;
-    p_entry->timeout = (timeout < 0 ? p_preparser->default_timeout : timeout) * 1000;
+    p_entry->timeout = i_timeout;
     vlc_gc_incref( p_entry->p_item );
 
-    vlc_mutex_lock( &p_preparser->lock );
     INSERT_ELEM( p_preparser->pp_waiting, p_preparser->i_waiting,
                  p_preparser->i_waiting, p_entry );
-    if( !p_preparser->b_live )
+
+    /* Running workers are always busy: start another one if possible */
+    if( p_preparser->i_live < p_preparser->i_workers )
     {
-        if( vlc_clone_detach( NULL, Thread, p_preparser,
-                              VLC_THREAD_PRIORITY_LOW ) )
-            msg_Warn( p_preparser->object, "cannot spawn pre-parser thread" );
-        else
-            p_preparser->b_live = true;
+        for( unsigned i = 0; i < p_preparser->i_workers; i++ )
+        {
+            preparser_worker_t *worker = &p_preparser->p_workers[i];
+            if( worker->b_live )
+                continue;
+
+            if( vlc_executor_Submit( p_preparser->executor,
+                                     &worker->runnable ) )
+                msg_Warn( p_preparser->object,
+                          "cannot spawn pre-parser thread" );
+            else
+            {
+                worker->b_live = true;
+                p_preparser->i_live++;
+            }
+            break;
+        }
     }
     vlc_mutex_unlock( &p_preparser->lock );
 }
@@ -148,11 +234,15 @@ void playlist_preparser_Cancel( playlist_preparser_t *p_preparser, void *id )
         }
     }
 
-    /* Stop the input_thread reading the item (if any) */
-    if( p_preparser->input_id == id )
+    /* Stop the input_threads reading the items (if any) */
+    for( unsigned i = 0; i < p_preparser->i_workers; i++ )
     {
-        p_preparser->input_state = INPUT_CANCELED;
-        vlc_cond_signal( &p_preparser->thread_wait );
+        preparser_worker_t *worker = &p_preparser->p_workers[i];
+        if( worker->input_id == id )
+        {
+            worker->input_state = INPUT_CANCELED;
+            vlc_cond_signal( &worker->thread_wait );
+        }
     }
     vlc_mutex_unlock( &p_preparser->lock );
 }
@@ -169,20 +259,35 @@ void playlist_preparser_Delete( playlist_preparser_t *p_preparser )
         REMOVE_ELEM( p_preparser->pp_waiting, p_preparser->i_waiting, 0 );
     }
 
-    p_preparser->input_state = INPUT_CANCELED;
-    vlc_cond_signal( &p_preparser->thread_wait );
+    for( unsigned i = 0; i < p_preparser->i_workers; i++ )
+    {
+        preparser_worker_t *worker = &p_preparser->p_workers[i];
+        worker->input_state = INPUT_CANCELED;
+        vlc_cond_signal( &worker->thread_wait );
 
-    while( p_preparser->b_live )
+        /* Workers that have not started yet never will */
+        if( worker->b_live
+         && vlc_executor_Cancel( p_preparser->executor, &worker->runnable ) )
+        {
+            worker->b_live = false;
+            p_preparser->i_live--;
+        }
+    }
+
+    while( p_preparser->i_live > 0 )
         vlc_cond_wait( &p_preparser->wait, &p_preparser->lock );
     vlc_mutex_unlock( &p_preparser->lock );
 
     /* Destroy the item preparser */
-    vlc_cond_destroy( &p_preparser->thread_wait );
+    for( unsigned i = 0; i < p_preparser->i_workers; i++ )
+        vlc_cond_destroy( &p_preparser->p_workers[i].thread_wait );
+    free( p_preparser->p_workers );
     vlc_cond_destroy( &p_preparser->wait );
     vlc_mutex_destroy( &p_preparser->lock );
 
     if( p_preparser->p_fetcher != NULL )
         playlist_fetcher_Delete( p_preparser->p_fetcher );
+    vlc_executor_Delete( p_preparser->executor );
     free( p_preparser );
 }
 
@@ -193,15 +298,16 @@ void playlist_preparser_Delete( playlist_preparser_t *p_preparser )
 static int InputEvent( vlc_object_t *obj, const char *varname,
                        vlc_value_t old, vlc_value_t cur, void *data )
 {
-    playlist_preparser_t *preparser = data;
+    preparser_worker_t *worker = data;
+    playlist_preparser_t *preparser = worker->owner;
     int event = cur.i_int;
 
     if( event == INPUT_EVENT_DEAD )
     {
         vlc_mutex_lock( &preparser->lock );
 
-        preparser->input_state = INPUT_STOPPED;
-        vlc_cond_signal( &preparser->thread_wait );
+        worker->input_state = INPUT_STOPPED;
+        vlc_cond_signal( &worker->thread_wait );
 
         vlc_mutex_unlock( &preparser->lock );
     }
@@ -210,12 +316,67 @@ static int InputEvent( vlc_object_t *obj, const char *varname,
     return VLC_SUCCESS;
 }
 
+/**
+ * Reads the tags of an item with the meta readers only, without opening an
+ * input. This only reads the few parts of the file holding the tags.
+ *
+ * \return true if the item meta data were found
+ */
+static bool PreparseFast( playlist_preparser_t *preparser,
+                          input_item_t *p_item )
+{
+    demux_meta_t *p_demux_meta =
+        vlc_custom_create( preparser->object, sizeof( *p_demux_meta ),
+                           "demux meta" );
+    if( unlikely(p_demux_meta == NULL) )
+        return false;
+    p_demux_meta->p_item = p_item;
+    p_demux_meta->p_meta = NULL;
+    p_demux_meta->i_attachments = 0;
+    p_demux_meta->attachments = NULL;
+
+    bool b_done = false;
+    module_t *p_reader = module_need( p_demux_meta, "meta reader", NULL, false );
+    if( p_reader != NULL )
+    {
+        vlc_meta_t *p_meta = p_demux_meta->p_meta;
+
+        /* Embedded art can only be extracted by the input */
+        if( p_meta != NULL && p_demux_meta->i_attachments == 0 )
+        {
+            const char *psz_title = vlc_meta_Get( p_meta, vlc_meta_Title );
+            if( psz_title != NULL )
+                input_item_SetName( p_item, psz_title );
+
+            vlc_mutex_lock( &p_item->lock );
+            if( p_item->p_meta == NULL )
+                p_item->p_meta = vlc_meta_New();
+            if( p_item->p_meta != NULL )
+            {
+                vlc_meta_Merge( p_item->p_meta, p_meta );
+                b_done = true;
+            }
+            vlc_mutex_unlock( &p_item->lock );
+        }
+
+        if( p_meta != NULL )
+            vlc_meta_Delete( p_meta );
+        for( int i = 0; i < p_demux_meta->i_attachments; i++ )
+            vlc_input_attachment_Delete( p_demux_meta->attachments[i] );
+        TAB_CLEAN( p_demux_meta->i_attachments, p_demux_meta->attachments );
+        module_unneed( p_demux_meta, p_reader );
+    }
+    vlc_object_release( p_demux_meta );
+    return b_done;
+}
+
 /**
  * This function preparses an item when needed.
  */
-static void Preparse( playlist_preparser_t *preparser,
+static void Preparse( preparser_worker_t *worker,
                       preparser_entry_t *p_entry )
 {
+    playlist_preparser_t *preparser = worker->owner;
     input_item_t *p_item = p_entry->p_item;
 
     vlc_mutex_lock( &p_item->lock );
@@ -235,7 +396,24 @@ static void Preparse( playlist_preparser_t *preparser,
     }
 
     /* Do not preparse if it is already done (like by playing it) */
-    if( b_preparse && !input_item_IsPreparsed( p_item ) )
+    if( b_preparse && !input_item_IsPreparsed( p_item )
+     && preparser->b_cache && i_type == ITEM_TYPE_FILE && !b_net
+     && playlist_LoadMetaFromCache( preparser->object, p_item ) == VLC_SUCCESS )
+    {
+        var_SetAddress( preparser->object, "item-change", p_item );
+        input_item_SetPreparsed( p_item, true );
+        input_item_SignalPreparseEnded( p_item, ITEM_PREPARSE_DONE );
+    }
+    else if( b_preparse && !input_item_IsPreparsed( p_item )
+     && ( p_entry->i_options & META_REQUEST_OPTION_FAST )
+     && i_type == ITEM_TYPE_FILE && !b_net
+     && PreparseFast( preparser, p_item ) )
+    {
+        var_SetAddress( preparser->object, "item-change", p_item );
+        input_item_SetPreparsed( p_item, true );
+        input_item_SignalPreparseEnded( p_item, ITEM_PREPARSE_DONE );
+    }
+    else if( b_preparse && !input_item_IsPreparsed( p_item ) )
     {
         int status;
         input_thread_t *input = input_CreatePreparser( preparser->object, p_item );
@@ -245,7 +423,7 @@ static void Preparse( playlist_preparser_t *preparser,
             return;
         }
 
-        var_AddCallback( input, "intf-event", InputEvent, preparser );
+        var_AddCallback( input, "intf-event", InputEvent, worker );
         if( input_Start( input ) == VLC_SUCCESS )
         {
             vlc_mutex_lock( &preparser->lock );
@@ -253,21 +431,21 @@ static void Preparse( playlist_preparser_t *preparser,
             if( p_entry->timeout > 0 )
             {
                 mtime_t deadline = mdate() + p_entry->timeout;
-                while( preparser->input_state == INPUT_RUNNING )
+                while( worker->input_state == INPUT_RUNNING )
                 {
-                    if( vlc_cond_timedwait( &preparser->thread_wait,
+                    if( vlc_cond_timedwait( &worker->thread_wait,
                                             &preparser->lock, deadline ) )
-                        preparser->input_state = INPUT_CANCELED; /* timeout */
+                        worker->input_state = INPUT_CANCELED; /* timeout */
                 }
             }
             else
             {
-                while( preparser->input_state == INPUT_RUNNING )
-                    vlc_cond_wait( &preparser->thread_wait, &preparser->lock );
+                while( worker->input_state == INPUT_RUNNING )
+                    vlc_cond_wait( &worker->thread_wait, &preparser->lock );
             }
-            assert( preparser->input_state == INPUT_STOPPED
-                 || preparser->input_state == INPUT_CANCELED );
-            status = preparser->input_state == INPUT_STOPPED ?
+            assert( worker->input_state == INPUT_STOPPED
+                 || worker->input_state == INPUT_CANCELED );
+            status = worker->input_state == INPUT_STOPPED ?
                      ITEM_PREPARSE_DONE : ITEM_PREPARSE_TIMEOUT;
 
             vlc_mutex_unlock( &preparser->lock );
@@ -275,11 +453,15 @@ static void Preparse( playlist_preparser_t *preparser,
         else
             status = ITEM_PREPARSE_FAILED;
 
-        var_DelCallback( input, "intf-event", InputEvent, preparser );
+        var_DelCallback( input, "intf-event", InputEvent, worker );
         if( status == ITEM_PREPARSE_TIMEOUT )
             input_Stop( input );
         input_Close( input );
 
+        if( status == ITEM_PREPARSE_DONE && preparser->b_cache
+         && i_type == ITEM_TYPE_FILE && !b_net )
+            playlist_SaveMetaToCache( preparser->object, p_item );
+
         var_SetAddress( preparser->object, "item-change", p_item );
         input_item_SetPreparsed( p_item, true );
         input_item_SignalPreparseEnded( p_item, status );
@@ -329,12 +511,33 @@ static void Art( playlist_preparser_t *p_preparser, input_item_t *p_item )
         playlist_fetcher_Push( p_fetcher, p_item, 0 );
 }
 
+/**
+ * Returns the index of the first waiting entry whose item is not being
+ * preparsed by another worker, or -1 if there is none
+ */
+static int NextEntry( playlist_preparser_t *p_preparser )
+{
+    for( size_t i = 0; i < p_preparser->i_waiting; i++ )
+    {
+        input_item_t *p_item = p_preparser->pp_waiting[i]->p_item;
+        unsigned j;
+
+        for( j = 0; j < p_preparser->i_workers; j++ )
+            if( p_preparser->p_workers[j].p_item == p_item )
+                break;
+        if( j == p_preparser->i_workers )
+            return i;
+    }
+    return -1;
+}
+
 /**
  * This function does the preparsing and issues the art fetching requests
  */
-static void *Thread( void *data )
+static void Thread( void *data )
 {
-    playlist_preparser_t *p_preparser = data;
+    preparser_worker_t *worker = data;
+    playlist_preparser_t *p_preparser = worker->owner;
 
     for( ;; )
     {
@@ -342,17 +545,25 @@ static void *Thread( void *data )
 
         vlc_mutex_lock( &p_preparser->lock );
         /* */
-        p_preparser->input_state = INPUT_RUNNING;
-        if( p_preparser->i_waiting > 0 )
+        worker->input_state = INPUT_RUNNING;
+        worker->p_item = NULL;
+
+        int i_entry = NextEntry( p_preparser );
+        if( i_entry >= 0 )
         {
-            p_entry = p_preparser->pp_waiting[0];
-            p_preparser->input_id = p_entry->id;
-            REMOVE_ELEM( p_preparser->pp_waiting, p_preparser->i_waiting, 0 );
+            p_entry = p_preparser->pp_waiting[i_entry];
+            worker->p_item = p_entry->p_item;
+            worker->input_id = p_entry->id;
+            REMOVE_ELEM( p_preparser->pp_waiting, p_preparser->i_waiting,
+                         i_entry );
         }
         else
         {
-            p_preparser->b_live = false;
-            p_preparser->input_id = NULL;
+            /* The remaining entries, if any, will be handled by the workers
+             * preparsing their items */
+            worker->b_live = false;
+            worker->input_id = NULL;
+            p_preparser->i_live--;
             vlc_cond_signal( &p_preparser->wait );
             vlc_mutex_unlock( &p_preparser->lock );
             break;
@@ -360,12 +571,10 @@ static void *Thread( void *data )
         vlc_mutex_unlock( &p_preparser->lock );
         assert( p_entry );
 
-        Preparse( p_preparser, p_entry );
+        Preparse( worker, p_entry );
 
         Art( p_preparser, p_entry->p_item );
         vlc_gc_decref( p_entry->p_item );
         free( p_entry );
     }
-    return NULL;
 }
-
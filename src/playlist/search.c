@@ -105,10 +105,13 @@ static void playlist_LiveSearchClean( playlist_item_t *p_root )
  * Enable/Disable items in the playlist according to the search argument
  * @param p_root: the current root item
  * @param psz_string: the string to search
+ * @param b_refine: true to only match the items enabled by a previous search
+ *                  for a substring of psz_string
  * @return true if an item match
  */
 static bool playlist_LiveSearchUpdateInternal( playlist_item_t *p_root,
-                                               const char *psz_string, bool b_recursive )
+                                               const char *psz_string, bool b_recursive,
+                                               bool b_refine )
 {
     int i;
     bool b_match = false;
@@ -118,11 +121,18 @@ static bool playlist_LiveSearchUpdateInternal( playlist_item_t *p_root,
         playlist_item_t *p_item = p_root->pp_children[i];
         // Go recurssively if their is some children
         if( b_recursive && p_item->i_children >= 0 &&
-            playlist_LiveSearchUpdateInternal( p_item, psz_string, true ) )
+            playlist_LiveSearchUpdateInternal( p_item, psz_string, true,
+                                               b_refine ) )
         {
             b_enable = true;
         }
 
+        /* An item that did not match a substring cannot match the string.
+         * Nodes are always walked, in case items were added to them. */
+        if( !b_enable && b_refine && p_item->i_children == -1
+         && ( p_item->i_flags & PLAYLIST_DBL_FLAG ) )
+            continue;
+
         if( !b_enable )
         {
             vlc_mutex_lock( &p_item->p_input->lock );
@@ -166,10 +176,27 @@ static bool playlist_LiveSearchUpdateInternal( playlist_item_t *p_root,
 int playlist_LiveSearchUpdate( playlist_t *p_playlist, playlist_item_t *p_root,
                                const char *psz_string, bool b_recursive )
 {
+    playlist_private_t *p_sys = pl_priv(p_playlist);
+
     PL_ASSERT_LOCKED;
-    pl_priv(p_playlist)->b_reset_currently_playing = true;
+    p_sys->b_reset_currently_playing = true;
+
+    /* Typing more characters only narrows the previous search down */
+    bool b_refine = p_sys->search.psz_string != NULL
+                 && p_sys->search.p_root == p_root
+                 && p_sys->search.b_recursive == b_recursive
+                 && strstr( psz_string, p_sys->search.psz_string ) != NULL;
+
+    free( p_sys->search.psz_string );
+    p_sys->search.psz_string = NULL;
     if( *psz_string )
-        playlist_LiveSearchUpdateInternal( p_root, psz_string, b_recursive );
+    {
+        playlist_LiveSearchUpdateInternal( p_root, psz_string, b_recursive,
+                                           b_refine );
+        p_sys->search.psz_string = strdup( psz_string );
+        p_sys->search.p_root = p_root;
+        p_sys->search.b_recursive = b_recursive;
+    }
     else
         playlist_LiveSearchClean( p_root );
     vlc_cond_signal( &pl_priv(p_playlist)->signal );
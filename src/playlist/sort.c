@@ -33,6 +33,76 @@
 #include "playlist_internal.h"
 
 
+/* Sort keys */
+enum
+{
+    KEY_ALBUM,
+    KEY_ARTIST,
+    KEY_DESCRIPTION,
+    KEY_DISC_NUMBER,
+    KEY_GENRE,
+    KEY_RATING,
+    KEY_TRACK_NUMBER,
+    KEY_COUNT
+};
+
+static const vlc_meta_type_t key_metas[KEY_COUNT] =
+{
+    [KEY_ALBUM]        = vlc_meta_Album,
+    [KEY_ARTIST]       = vlc_meta_Artist,
+    [KEY_DESCRIPTION]  = vlc_meta_Description,
+    [KEY_DISC_NUMBER]  = vlc_meta_DiscNumber,
+    [KEY_GENRE]        = vlc_meta_Genre,
+    [KEY_RATING]       = vlc_meta_Rating,
+    [KEY_TRACK_NUMBER] = vlc_meta_TrackNumber,
+};
+
+/**
+ * The values an item is sorted on, read once before sorting rather than
+ * for every comparison, each of which would lock the items
+ */
+typedef struct
+{
+    playlist_item_t *p_item;
+    char            *psz_title; /**< title, or name as a fallback */
+    char            *psz_uri;
+    char            *ppsz_meta[KEY_COUNT];
+    mtime_t          i_duration;
+} sort_key_t;
+
+static void sort_key_Init( sort_key_t *p_key, playlist_item_t *p_item )
+{
+    input_item_t *p_input = p_item->p_input;
+    const char *psz_title = NULL;
+
+    p_key->p_item = p_item;
+
+    vlc_mutex_lock( &p_input->lock );
+    if( p_input->p_meta )
+        psz_title = vlc_meta_Get( p_input->p_meta, vlc_meta_Title );
+    if( EMPTY_STR( psz_title ) )
+        psz_title = p_input->psz_name;
+    p_key->psz_title = psz_title ? strdup( psz_title ) : NULL;
+    p_key->psz_uri = p_input->psz_uri ? strdup( p_input->psz_uri ) : NULL;
+
+    for( unsigned i = 0; i < KEY_COUNT; i++ )
+    {
+        const char *psz_meta = p_input->p_meta ?
+            vlc_meta_Get( p_input->p_meta, key_metas[i] ) : NULL;
+        p_key->ppsz_meta[i] = psz_meta ? strdup( psz_meta ) : NULL;
+    }
+    p_key->i_duration = p_input->i_duration;
+    vlc_mutex_unlock( &p_input->lock );
+}
+
+static void sort_key_Clean( sort_key_t *p_key )
+{
+    free( p_key->psz_title );
+    free( p_key->psz_uri );
+    for( unsigned i = 0; i < KEY_COUNT; i++ )
+        free( p_key->ppsz_meta[i] );
+}
+
 /* General comparison functions */
 /**
  * Compare two items using their title or name
@@ -40,50 +110,47 @@
  * @param second: the second item
  * @return -1, 0 or 1 like strcmp
  */
-static inline int meta_strcasecmp_title( const playlist_item_t *first,
-                              const playlist_item_t *second )
+static inline int meta_strcasecmp_title( const sort_key_t *first,
+                              const sort_key_t *second )
 {
-    int i_ret;
-    char *psz_first = input_item_GetTitleFbName( first->p_input );
-    char *psz_second = input_item_GetTitleFbName( second->p_input );
+    const char *psz_first = first->psz_title;
+    const char *psz_second = second->psz_title;
 
     if( psz_first && psz_second )
-        i_ret = strcasecmp( psz_first, psz_second );
+        return strcasecmp( psz_first, psz_second );
     else if( !psz_first && psz_second )
-        i_ret = 1;
+        return 1;
     else if( psz_first && !psz_second )
-        i_ret = -1;
+        return -1;
     else
-        i_ret = 0;
-    free( psz_first );
-    free( psz_second );
-
-    return i_ret;
+        return 0;
 }
 
 /**
  * Compare two intems according to the given meta type
  * @param first: the first item
  * @param second: the second item
- * @param meta: the meta type to use to sort the items
+ * @param key: the KEY_* meta to use to sort the items
  * @param b_integer: true if the meta are integers
  * @return -1, 0 or 1 like strcmp
  */
-static inline int meta_sort( const playlist_item_t *first,
-                             const playlist_item_t *second,
-                             vlc_meta_type_t meta, bool b_integer )
+static inline int meta_sort( const sort_key_t *first,
+                             const sort_key_t *second,
+                             unsigned key, bool b_integer )
 {
     int i_ret;
-    char *psz_first = input_item_GetMeta( first->p_input, meta );
-    char *psz_second = input_item_GetMeta( second->p_input, meta );
+    const char *psz_first = first->ppsz_meta[key];
+    const char *psz_second = second->ppsz_meta[key];
+    const playlist_item_t *p_first = first->p_item;
+    const playlist_item_t *p_second = second->p_item;
 
     /* Nodes go first */
-    if( first->i_children == -1 && second->i_children >= 0 )
+    if( p_first->i_children == -1 && p_second->i_children >= 0 )
         i_ret = 1;
-    else if( first->i_children >= 0 && second->i_children == -1 )
+    else if( p_first->i_children >= 0 && p_second->i_children == -1 )
        i_ret = -1;
     /* Both are nodes, sort by name */
-    else if( first->i_children >= 0 && second->i_children >= 0 )
+    else if( p_first->i_children >= 0 && p_second->i_children >= 0 )
         i_ret = meta_strcasecmp_title( first, second );
     /* Both are items */
     else if( !psz_first && psz_second )
@@ -101,8 +168,6 @@ static inline int meta_sort( const playlist_item_t *first,
             i_ret = strcasecmp( psz_first, psz_second );
     }
 
-    free( psz_first );
-    free( psz_second );
     return i_ret;
 }
 
@@ -137,7 +202,21 @@ void playlist_ItemArraySort( unsigned i_items, playlist_item_t **pp_items,
 {
     if( p_sortfn )
     {
-        qsort( pp_items, i_items, sizeof( pp_items[0] ), p_sortfn );
+        sort_key_t *p_keys = malloc( i_items * sizeof( *p_keys ) );
+        if( unlikely(p_keys == NULL) )
+            return;
+
+        for( unsigned i = 0; i < i_items; i++ )
+            sort_key_Init( &p_keys[i], pp_items[i] );
+
+        qsort( p_keys, i_items, sizeof( *p_keys ), p_sortfn );
+
+        for( unsigned i = 0; i < i_items; i++ )
+        {
+            pp_items[i] = p_keys[i].p_item;
+            sort_key_Clean( &p_keys[i] );
+        }
+        free( p_keys );
     }
     else /* Randomise */
     {
@@ -203,7 +282,7 @@ int playlist_RecursiveNodeSort( playlist_t *p_playlist, playlist_item_t *p_node,
 
 /* This is the stuff the sorting functions are made of. The proto_##
  * functions are wrapped in cmp_a_## and cmp_d_## functions that do
- * void * to const playlist_item_t * casting and dereferencing and
+ * void * to const sort_key_t * casting and
  * cmp_d_## inverts the result, too. proto_## are static inline,
  * cmp_[ad]_## are merely static as they're the target of pointers.
  *
@@ -212,21 +291,21 @@ int playlist_RecursiveNodeSort( playlist_t *p_playlist, playlist_item_t *p_node,
  */
 
 #define SORTFN( SORT, first, second ) static inline int proto_##SORT \
-	( const playlist_item_t *first, const playlist_item_t *second )
+	( const sort_key_t *first, const sort_key_t *second )
 
 SORTFN( SORT_ALBUM, first, second )
 {
-    int i_ret = meta_sort( first, second, vlc_meta_Album, false );
+    int i_ret = meta_sort( first, second, KEY_ALBUM, false );
     /* Items came from the same album: compare the track numbers */
     if( i_ret == 0 )
-        i_ret = meta_sort( first, second, vlc_meta_TrackNumber, true );
+        i_ret = meta_sort( first, second, KEY_TRACK_NUMBER, true );
 
     return i_ret;
 }
 
 SORTFN( SORT_ARTIST, first, second )
 {
-    int i_ret = meta_sort( first, second, vlc_meta_Artist, false );
+    int i_ret = meta_sort( first, second, KEY_ARTIST, false );
     /* Items came from the same artist: compare the albums */
     if( i_ret == 0 )
         i_ret = proto_SORT_ALBUM( first, second );
@@ -236,13 +315,13 @@ SORTFN( SORT_ARTIST, first, second )
 
 SORTFN( SORT_DESCRIPTION, first, second )
 {
-    return meta_sort( first, second, vlc_meta_Description, false );
+    return meta_sort( first, second, KEY_DESCRIPTION, false );
 }
 
 SORTFN( SORT_DURATION, first, second )
 {
-    mtime_t time1 = input_item_GetDuration( first->p_input );
-    mtime_t time2 = input_item_GetDuration( second->p_input );
+    mtime_t time1 = first->i_duration;
+    mtime_t time2 = second->i_duration;
     int i_ret = time1 > time2 ? 1 :
                     ( time1 == time2 ? 0 : -1 );
     return i_ret;
@@ -250,17 +329,17 @@ SORTFN( SORT_DURATION, first, second )
 
 SORTFN( SORT_GENRE, first, second )
 {
-    return meta_sort( first, second, vlc_meta_Genre, false );
+    return meta_sort( first, second, KEY_GENRE, false );
 }
 
 SORTFN( SORT_ID, first, second )
 {
-    return first->i_id - second->i_id;
+    return first->p_item->i_id - second->p_item->i_id;
 }
 
 SORTFN( SORT_RATING, first, second )
 {
-    return meta_sort( first, second, vlc_meta_Rating, true );
+    return meta_sort( first, second, KEY_RATING, true );
 }
 
 SORTFN( SORT_TITLE, first, second )
@@ -271,10 +350,10 @@ SORTFN( SORT_TITLE, first, second )
 SORTFN( SORT_TITLE_NODES_FIRST, first, second )
 {
     /* If first is a node but not second */
-    if( first->i_children == -1 && second->i_children >= 0 )
+    if( first->p_item->i_children == -1 && second->p_item->i_children >= 0 )
         return -1;
     /* If second is a node but not first */
-    else if( first->i_children >= 0 && second->i_children == -1 )
+    else if( first->p_item->i_children >= 0 && second->p_item->i_children == -1 )
         return 1;
     /* Both are nodes or both are not nodes */
     else
@@ -284,8 +363,8 @@ SORTFN( SORT_TITLE_NODES_FIRST, first, second )
 SORTFN( SORT_TITLE_NUMERIC, first, second )
 {
     int i_ret;
-    char *psz_first = input_item_GetTitleFbName( first->p_input );
-    char *psz_second = input_item_GetTitleFbName( second->p_input );
+    const char *psz_first = first->psz_title;
+    const char *psz_second = second->psz_title;
 
     if( psz_first && psz_second )
         i_ret = atoi( psz_first ) - atoi( psz_second );
@@ -296,26 +375,24 @@ SORTFN( SORT_TITLE_NUMERIC, first, second )
     else
         i_ret = 0;
 
-    free( psz_first );
-    free( psz_second );
     return i_ret;
 }
 
 SORTFN( SORT_TRACK_NUMBER, first, second )
 {
-    return meta_sort( first, second, vlc_meta_TrackNumber, true );
+    return meta_sort( first, second, KEY_TRACK_NUMBER, true );
 }
 
 SORTFN( SORT_DISC_NUMBER, first, second )
 {
-  return meta_sort( first, second, vlc_meta_DiscNumber, true );
+  return meta_sort( first, second, KEY_DISC_NUMBER, true );
 }
 
 SORTFN( SORT_URI, first, second )
 {
     int i_ret;
-    char *psz_first = input_item_GetURI( first->p_input );
-    char *psz_second = input_item_GetURI( second->p_input );
+    const char *psz_first = first->psz_uri;
+    const char *psz_second = second->psz_uri;
 
     if( psz_first && psz_second )
         i_ret = strcasecmp( psz_first, psz_second );
@@ -326,8 +403,6 @@ SORTFN( SORT_URI, first, second )
     else
         i_ret = 0;
 
-    free( psz_first );
-    free( psz_second );
     return i_ret;
 }
 
@@ -343,11 +418,11 @@ SORTFN( SORT_URI, first, second )
 
 #define DEF( s ) \
 	static int cmp_a_##s(const void *l,const void *r) \
-	{ return proto_##s(*(const playlist_item_t *const *)l, \
-                           *(const playlist_item_t *const *)r); } \
+	{ return proto_##s((const sort_key_t *)l, \
+                           (const sort_key_t *)r); } \
 	static int cmp_d_##s(const void *l,const void *r) \
-	{ return -1*proto_##s(*(const playlist_item_t * const *)l, \
-                              *(const playlist_item_t * const *)r); }
+	{ return -1*proto_##s((const sort_key_t *)l, \
+                              (const sort_key_t *)r); }
 
 	VLC_DEFINE_SORT_FUNCTIONS
 
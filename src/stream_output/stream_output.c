@@ -384,6 +384,9 @@ sout_mux_t * sout_MuxNew( sout_instance_t *p_sout, const char *psz_mux,
     p_mux->b_add_stream_any_time = false;
     p_mux->b_waiting_stream = true;
     p_mux->i_add_stream_start = -1;
+    p_mux->i_mux_quantum = var_InheritInteger( p_mux, "sout-mux-quantum" )
+                         * INT64_C(1000);
+    p_mux->i_mux_next_dts = VLC_TS_INVALID;
 
     p_mux->p_module =
         module_need( p_mux, "sout mux", p_mux->psz_mux, true );
@@ -510,6 +513,12 @@ void sout_MuxDeleteStream( sout_mux_t *p_mux, sout_input_t *p_input )
         p_mux->b_waiting_stream = false;
         p_mux->pf_mux( p_mux );
     }
+    else if( p_mux->i_mux_quantum > 0
+          && block_FifoCount( p_input->p_fifo ) > 0 )
+    {
+        /* Mux what the current quantum has gathered so far */
+        p_mux->pf_mux( p_mux );
+    }
 
     TAB_FIND( p_mux->i_nb_inputs, p_mux->pp_inputs, p_input, i_index );
     if( i_index >= 0 )
@@ -560,6 +569,16 @@ int sout_MuxSendBuffer( sout_mux_t *p_mux, sout_input_t *p_input,
             return VLC_SUCCESS;
         p_mux->b_waiting_stream = false;
     }
+
+    /* Batch the blocks of a whole quantum into one muxer run */
+    if( p_mux->i_mux_quantum > 0 && i_dts > VLC_TS_INVALID )
+    {
+        if( p_mux->i_mux_next_dts > VLC_TS_INVALID &&
+            i_dts < p_mux->i_mux_next_dts &&
+            i_dts > p_mux->i_mux_next_dts - 2 * p_mux->i_mux_quantum )
+            return VLC_SUCCESS;
+        p_mux->i_mux_next_dts = i_dts + p_mux->i_mux_quantum;
+    }
     return p_mux->pf_mux( p_mux );
 }
 
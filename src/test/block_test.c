@@ -29,6 +29,7 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_threads.h>
 
 static const char text[] =
     "This is a test!\n"
@@ -86,11 +87,198 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_Split (void)
+{
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block->i_pts = 42;
+
+    block_t *head = block_Split (&block, 16);
+    assert (head != NULL && block != NULL);
+    assert (head->i_buffer == 16 && head->i_pts == 42);
+    assert (!memcmp (head->p_buffer, text, 16));
+    assert (block->i_buffer == sizeof (text) - 16);
+    assert (block->i_pts == VLC_TS_INVALID);
+    assert (!memcmp (block->p_buffer, text + 16, block->i_buffer));
+
+    /* Growing a slice must not overwrite the other one */
+    head = block_Realloc (head, 0, 32);
+    assert (head != NULL);
+    assert (!memcmp (head->p_buffer, text, 16));
+    assert (!memcmp (block->p_buffer, text + 16, block->i_buffer));
+    block_Release (head);
+
+    block_t *mid = block_Split (&block, 8);
+    assert (mid != NULL && block != NULL);
+    assert (!memcmp (mid->p_buffer, text + 16, 8));
+    block_Release (block);
+    assert (!memcmp (mid->p_buffer, text + 16, 8));
+
+    block_t *whole = block_Split (&mid, 8);
+    assert (whole != NULL && mid == NULL);
+    block_Release (whole);
+}
+
+static void test_block_Clone (void)
+{
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block->i_pts = 42;
+
+    block = block_Share (block);
+    assert (block != NULL);
+    assert (block_Share (block) == block);
+
+    block_t *clone = block_Clone (block);
+    assert (clone != NULL && clone != block);
+    assert (clone->p_buffer == block->p_buffer);
+    assert (clone->i_buffer == sizeof (text) && clone->i_pts == 42);
+
+    /* Each clone has its own view of the payload */
+    clone->p_buffer += 16;
+    clone->i_buffer -= 16;
+    assert (block->i_buffer == sizeof (text));
+
+    /* Growing a clone must copy the payload */
+    clone = block_Realloc (clone, 16, sizeof (text));
+    assert (clone != NULL);
+    assert (clone->p_buffer != block->p_buffer);
+    assert (!memcmp (clone->p_buffer + 16, text + 16, sizeof (text) - 16));
+
+    /* The payload outlives the original block */
+    block_t *clone2 = block_Clone (block);
+    assert (clone2 != NULL);
+    block_Release (block);
+    assert (!memcmp (clone2->p_buffer, text, sizeof (text)));
+    block_Release (clone2);
+    block_Release (clone);
+
+    /* Blocks that were not shared are copied */
+    block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    clone = block_Clone (block);
+    assert (clone != NULL && clone->p_buffer != block->p_buffer);
+    assert (!memcmp (clone->p_buffer, text, sizeof (text)));
+    block_Release (clone);
+    block_Release (block);
+}
+
+static void *test_block_pool_Thread (void *data)
+{
+    block_t *chain = data;
+
+    block_ChainRelease (chain);
+    return NULL;
+}
+
+static void test_block_pool (void)
+{
+    uint64_t hits, misses, hits2, misses2;
+    block_t *chain = NULL;
+    block_t **pp = &chain;
+    vlc_thread_t th;
+
+    block_PoolStats (&hits, &misses);
+
+    /* Same-thread recycling */
+    for (unsigned i = 0; i < 1024; i++)
+    {
+        block_t *block = block_Alloc (1316);
+        assert (block != NULL);
+        assert (block->i_buffer == 1316);
+        assert (((uintptr_t)block->p_buffer % 32) == 0);
+        memset (block->p_buffer, i, block->i_buffer);
+        block_Release (block);
+    }
+
+    /* Cross-thread release */
+    for (unsigned i = 0; i < 64; i++)
+    {
+        block_t *block = block_Alloc (188);
+        assert (block != NULL);
+        block_ChainLastAppend (&pp, block);
+    }
+    assert (vlc_clone (&th, test_block_pool_Thread, chain,
+                       VLC_THREAD_PRIORITY_LOW) == 0);
+    vlc_join (th, NULL);
+
+    for (unsigned i = 0; i < 512; i++)
+        block_Release (block_Alloc (100));
+
+    /* Odd sizes bypass the pools */
+    block_t *block = block_Alloc (4 << 20);
+    assert (block != NULL);
+    assert (block->i_buffer == (4 << 20));
+    block_Release (block);
+
+    block_PoolStats (&hits2, &misses2);
+    assert (hits2 >= hits + 1024);
+    assert (misses2 - misses < 128);
+}
+
+static void *test_block_fifo_Producer (void *data)
+{
+    block_fifo_t *fifo = data;
+
+    for (unsigned i = 0; i < 100000; i++)
+    {
+        block_t *block = block_Alloc (sizeof (i));
+        assert (block != NULL);
+        memcpy (block->p_buffer, &i, sizeof (i));
+        block_FifoPut (fifo, block);
+    }
+    return NULL;
+}
+
+static void test_block_fifo_spsc (void)
+{
+    block_fifo_t *fifo = block_FifoNewSPSC ();
+    vlc_thread_t th;
+
+    assert (fifo != NULL);
+    assert (block_FifoCount (fifo) == 0);
+
+    /* Overflow the ring from the calling thread */
+    test_block_fifo_Producer (fifo);
+    assert (block_FifoCount (fifo) == 100000);
+    assert (block_FifoSize (fifo) == 100000 * sizeof (unsigned));
+
+    for (unsigned i = 0; i < 100000; i++)
+    {
+        block_t *block = block_FifoGet (fifo);
+        assert (!memcmp (block->p_buffer, &i, sizeof (i)));
+        block_Release (block);
+    }
+    assert (block_FifoCount (fifo) == 0);
+
+    /* Concurrent producer and consumer */
+    assert (vlc_clone (&th, test_block_fifo_Producer, fifo,
+                       VLC_THREAD_PRIORITY_LOW) == 0);
+    for (unsigned i = 0; i < 100000; i++)
+    {
+        block_t *block = block_FifoGet (fifo);
+        assert (!memcmp (block->p_buffer, &i, sizeof (i)));
+        block_Release (block);
+    }
+    vlc_join (th, NULL);
+    assert (block_FifoCount (fifo) == 0);
+
+    block_FifoPut (fifo, block_Alloc (16));
+    block_FifoRelease (fifo);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_Split ();
+    test_block_Clone ();
+    test_block_pool ();
+    test_block_fifo_spsc ();
     return 0;
 }
 
@@ -123,5 +123,24 @@ int main(void)
     test(false);
     test(true);
 
+    /* More pictures than fit in one word of the bitmap */
+    pool = picture_pool_NewFromFormat(&fmt, 100);
+    assert(pool != NULL);
+
+    picture_t *pics[100];
+    for (unsigned i = 0; i < 100; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+
+    picture_Release(pics[70]);
+    pics[70] = picture_pool_Wait(pool);
+    assert(pics[70] != NULL);
+
+    for (unsigned i = 0; i < 100; i++)
+        picture_Release(pics[i]);
+    picture_pool_Release(pool);
+
     return 0;
 }
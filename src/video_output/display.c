@@ -397,6 +397,12 @@ struct vout_display_owner_sys_t {
 
     bool reset_pictures;
 
+    /* Display refreshes (protected by lock) */
+    struct {
+        mtime_t date;
+        mtime_t period;
+    } vsync;
+
     bool ch_fullscreen;
     bool is_fullscreen;
 
@@ -702,6 +708,17 @@ static void VoutDisplayEvent(vout_display_t *vd, int event, va_list args)
         break;
     }
 
+    case VOUT_DISPLAY_EVENT_VSYNC: {
+        const mtime_t date   = va_arg(args, mtime_t);
+        const mtime_t period = va_arg(args, mtime_t);
+
+        vlc_mutex_lock(&osys->lock);
+        osys->vsync.date   = date;
+        osys->vsync.period = period;
+        vlc_mutex_unlock(&osys->lock);
+        break;
+    }
+
     case VOUT_DISPLAY_EVENT_PICTURES_INVALID: {
         msg_Warn(vd, "VoutDisplayEvent 'pictures invalid'");
 
@@ -1061,6 +1078,18 @@ bool vout_AreDisplayPicturesInvalid(vout_display_t *vd)
     return reset_pictures;
 }
 
+bool vout_GetDisplayVsync(vout_display_t *vd, mtime_t *date, mtime_t *period)
+{
+    vout_display_owner_sys_t *osys = vd->owner.sys;
+
+    vlc_mutex_lock(&osys->lock);
+    *date = osys->vsync.date;
+    *period = osys->vsync.period;
+    vlc_mutex_unlock(&osys->lock);
+
+    return *date > VLC_TS_INVALID && *period > 0;
+}
+
 bool vout_IsDisplayFiltered(vout_display_t *vd)
 {
     vout_display_owner_sys_t *osys = vd->owner.sys;
@@ -1217,6 +1246,8 @@ static vout_display_t *DisplayNew(vout_thread_t *vout,
     osys->wrapper = wrapper;
 
     vlc_mutex_init(&osys->lock);
+    osys->vsync.date = VLC_TS_INVALID;
+    osys->vsync.period = 0;
 
     vlc_mouse_Init(&osys->mouse.state);
     osys->mouse.last_moved = mdate();
@@ -1395,6 +1426,7 @@ static void SplitterEvent(vout_display_t *vd, int event, va_list args)
     case VOUT_DISPLAY_EVENT_CLOSE:
     case VOUT_DISPLAY_EVENT_FULLSCREEN:
     case VOUT_DISPLAY_EVENT_DISPLAY_SIZE:
+    case VOUT_DISPLAY_EVENT_VSYNC:
     case VOUT_DISPLAY_EVENT_PICTURES_INVALID:
         VoutDisplayEvent(vd, event, args);
         break;
@@ -1412,6 +1444,19 @@ static picture_pool_t *SplitterPool(vout_display_t *vd, unsigned count)
         sys->pool = picture_pool_NewFromFormat(&vd->fmt, count);
     return sys->pool;
 }
+/* Copies a picture referencing the splitter input into the display pool.
+ * Displays behind a filter chain do not need it: the chain reads the
+ * referenced pixels directly. */
+static picture_t *SplitterPictureImport(vout_display_t *vd, picture_t *picture)
+{
+    picture_pool_t *pool = vout_display_Pool(vd, 1);
+    picture_t *direct = pool ? picture_pool_Get(pool) : NULL;
+
+    if (direct != NULL)
+        picture_Copy(direct, picture);
+    picture_Release(picture);
+    return direct;
+}
 static void SplitterPrepare(vout_display_t *vd,
                             picture_t *picture,
                             subpicture_t *subpicture)
@@ -1431,6 +1476,9 @@ static void SplitterPrepare(vout_display_t *vd,
     for (int i = 0; i < sys->count; i++) {
         if (vout_IsDisplayFiltered(sys->display[i]))
             sys->picture[i] = vout_FilterDisplay(sys->display[i], sys->picture[i]);
+        else if (sys->splitter->b_reference)
+            sys->picture[i] = SplitterPictureImport(sys->display[i],
+                                                    sys->picture[i]);
         if (sys->picture[i])
             vout_display_Prepare(sys->display[i], sys->picture[i], NULL);
     }
@@ -143,7 +143,17 @@ static subpicture_region_t * vout_OSDEpgText(const char *text,
 }
 
 
-static subpicture_region_t * vout_BuildOSDEpg(vlc_epg_t *epg,
+struct subpicture_updater_sys_t
+{
+    char    *channel;    /* channel name */
+    char    *program;    /* current program name */
+    int64_t  start;      /* current program start time */
+    uint32_t duration;   /* current program duration */
+    char     text_start[16];
+    char     text_end[16];
+};
+
+static subpicture_region_t * vout_BuildOSDEpg(subpicture_updater_sys_t *sys,
                                               int x, int y,
                                               int visible_width,
                                               int visible_height)
@@ -154,7 +164,7 @@ static subpicture_region_t * vout_BuildOSDEpg(vlc_epg_t *epg,
     time_t current_time = time(NULL);
 
     /* Display the name of the channel. */
-    *last_ptr = vout_OSDEpgText(epg->psz_name,
+    *last_ptr = vout_OSDEpgText(sys->channel,
                                 x + visible_width  * EPG_LEFT,
                                 y + visible_height * EPG_TOP,
                                 visible_height * EPG_NAME_SIZE,
@@ -165,7 +175,7 @@ static subpicture_region_t * vout_BuildOSDEpg(vlc_epg_t *epg,
 
     /* Display the name of the current program. */
     last_ptr = &(*last_ptr)->p_next;
-    *last_ptr = vout_OSDEpgText(epg->p_current->psz_name,
+    *last_ptr = vout_OSDEpgText(sys->program,
                                 x + visible_width  * (EPG_LEFT + 0.025),
                                 y + visible_height * (EPG_TOP + 0.05),
                                 visible_height * EPG_PROGRAM_SIZE,
@@ -180,28 +190,16 @@ static subpicture_region_t * vout_BuildOSDEpg(vlc_epg_t *epg,
                                   y + visible_height * (EPG_TOP + 0.1),
                                   visible_width  * (1 - 2 * EPG_LEFT),
                                   visible_height * 0.05,
-                                  (current_time - epg->p_current->i_start)
-                                  / (float)epg->p_current->i_duration);
+                                  (current_time - sys->start)
+                                  / (float)sys->duration);
 
     if (!*last_ptr)
         return head;
 
-    /* Format the hours of the beginning and the end of the current program. */
-    struct tm tm_start, tm_end;
-    time_t t_start = epg->p_current->i_start;
-    time_t t_end = epg->p_current->i_start + epg->p_current->i_duration;
-    localtime_r(&t_start, &tm_start);
-    localtime_r(&t_end, &tm_end);
-    char text_start[128];
-    char text_end[128];
-    snprintf(text_start, sizeof(text_start), "%2.2d:%2.2d",
-             tm_start.tm_hour, tm_start.tm_min);
-    snprintf(text_end, sizeof(text_end), "%2.2d:%2.2d",
-             tm_end.tm_hour, tm_end.tm_min);
-
-    /* Display those hours. */
+    /* Display the hours of the beginning and the end of the current
+     * program. */
     last_ptr = &(*last_ptr)->p_next;
-    *last_ptr = vout_OSDEpgText(text_start,
+    *last_ptr = vout_OSDEpgText(sys->text_start,
                                 x + visible_width  * (EPG_LEFT + 0.02),
                                 y + visible_height * (EPG_TOP + 0.15),
                                 visible_height * EPG_PROGRAM_SIZE,
@@ -211,7 +209,7 @@ static subpicture_region_t * vout_BuildOSDEpg(vlc_epg_t *epg,
         return head;
 
     last_ptr = &(*last_ptr)->p_next;
-    *last_ptr = vout_OSDEpgText(text_end,
+    *last_ptr = vout_OSDEpgText(sys->text_end,
                                 x + visible_width  * (1 - EPG_LEFT - 0.085),
                                 y + visible_height * (EPG_TOP + 0.15),
                                 visible_height * EPG_PROGRAM_SIZE,
@@ -220,11 +218,6 @@ static subpicture_region_t * vout_BuildOSDEpg(vlc_epg_t *epg,
     return head;
 }
 
-struct subpicture_updater_sys_t
-{
-    vlc_epg_t *epg;
-};
-
 static int OSDEpgValidate(subpicture_t *subpic,
                           bool has_src_changed, const video_format_t *fmt_src,
                           bool has_dst_changed, const video_format_t *fmt_dst,
@@ -254,7 +247,7 @@ static void OSDEpgUpdate(subpicture_t *subpic,
 
     subpic->i_original_picture_width  = fmt.i_width;
     subpic->i_original_picture_height = fmt.i_height;
-    subpic->p_region = vout_BuildOSDEpg(sys->epg,
+    subpic->p_region = vout_BuildOSDEpg(sys,
                                         fmt.i_x_offset,
                                         fmt.i_y_offset,
                                         fmt.i_visible_width,
@@ -265,7 +258,8 @@ static void OSDEpgDestroy(subpicture_t *subpic)
 {
     subpicture_updater_sys_t *sys = subpic->updater.p_sys;
 
-    vlc_epg_Delete(sys->epg);
+    free(sys->channel);
+    free(sys->program);
     free(sys);
 }
 
@@ -277,9 +271,10 @@ static void OSDEpgDestroy(subpicture_t *subpic)
 int vout_OSDEpg(vout_thread_t *vout, input_item_t *input)
 {
     char *now_playing = input_item_GetNowPlayingFb(input);
-    vlc_epg_t *epg = NULL;
+    subpicture_updater_sys_t *sys = NULL;
 
-    /* Look for the current program EPG event */
+    /* Look for the current program EPG event. Only the displayed texts are
+     * copied, not the whole EPG table. */
     if(now_playing){
         vlc_mutex_lock(&input->lock);
 
@@ -289,11 +284,13 @@ int vout_OSDEpg(vout_thread_t *vout, input_item_t *input)
             if (tmp->p_current &&
                 tmp->p_current->psz_name &&
                 !strcmp(tmp->p_current->psz_name, now_playing)) {
-                 epg = vlc_epg_New(tmp->i_id, tmp->i_source_id);
-                if(epg){
-                    if(tmp->psz_name)
-                        epg->psz_name = strdup(tmp->psz_name);
-                    vlc_epg_Merge(epg, tmp);
+                sys = malloc(sizeof(*sys));
+                if (sys) {
+                    sys->channel = tmp->psz_name ? strdup(tmp->psz_name)
+                                                 : NULL;
+                    sys->program = strdup(tmp->p_current->psz_name);
+                    sys->start = tmp->p_current->i_start;
+                    sys->duration = tmp->p_current->i_duration;
                 }
                 break;
             }
@@ -304,15 +301,20 @@ int vout_OSDEpg(vout_thread_t *vout, input_item_t *input)
     }
 
     /* If no EPG event has been found. */
-    if (epg == NULL)
+    if (sys == NULL)
         return VLC_EGENERIC;
 
-    subpicture_updater_sys_t *sys = malloc(sizeof(*sys));
-    if (!sys) {
-        vlc_epg_Delete(epg);
-        return VLC_EGENERIC;
-    }
-    sys->epg = epg;
+    /* Format the hours once, they do not change while the OSD is shown. */
+    struct tm tm_start, tm_end;
+    time_t t_start = sys->start;
+    time_t t_end = sys->start + sys->duration;
+    localtime_r(&t_start, &tm_start);
+    localtime_r(&t_end, &tm_end);
+    snprintf(sys->text_start, sizeof(sys->text_start), "%2.2d:%2.2d",
+             tm_start.tm_hour, tm_start.tm_min);
+    snprintf(sys->text_end, sizeof(sys->text_end), "%2.2d:%2.2d",
+             tm_end.tm_hour, tm_end.tm_min);
+
     subpicture_updater_t updater = {
         .pf_validate = OSDEpgValidate,
         .pf_update   = OSDEpgUpdate,
@@ -323,7 +325,8 @@ int vout_OSDEpg(vout_thread_t *vout, input_item_t *input)
     const mtime_t now = mdate();
     subpicture_t *subpic = subpicture_New(&updater);
     if (!subpic) {
-        vlc_epg_Delete(sys->epg);
+        free(sys->channel);
+        free(sys->program);
         free(sys);
         return VLC_EGENERIC;
     }
@@ -52,6 +52,7 @@
 #include "interlacing.h"
 #include "display.h"
 #include "window.h"
+#include "../misc/tracer.h"
 
 /*****************************************************************************
  * Local prototypes
@@ -817,6 +818,36 @@ static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse, bool fra
     return VLC_SUCCESS;
 }
 
+/**
+ * Returns the date of the display refresh closest to a given date, on the
+ * grid of the vertical synchronizations reported by the display.
+ */
+static mtime_t VsyncSlot(mtime_t date, mtime_t vsync, mtime_t period)
+{
+    const mtime_t delta = date - vsync + period / 2;
+    const mtime_t n = delta >= 0 ? delta / period
+                                 : -((period - 1 - delta) / period);
+
+    return vsync + n * period;
+}
+
+/**
+ * Returns the date a picture should be handed to the display.
+ *
+ * If the display reports its refreshes, the picture is assigned to the
+ * refresh closest to its date, and handed half a period before. This keeps
+ * a steady cadence (e.g. 3:2 for 24 fps on a 60 Hz display) instead of
+ * depending on the wake-up jitter around the refresh dates.
+ */
+static mtime_t ThreadDisplayDate(vout_thread_t *vout, mtime_t date)
+{
+    mtime_t vsync, period;
+
+    if (!vout_GetDisplayVsync(vout->p->display.vd, &vsync, &period))
+        return date;
+    return VsyncSlot(date, vsync, period) - period / 2;
+}
+
 static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
 {
     vout_thread_sys_t *sys = vout->p;
@@ -1007,12 +1038,28 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     if (delay < 1000)
         msg_Warn(vout, "picture is late (%lld ms)", delay / 1000);
 #endif
+    const mtime_t display_date = ThreadDisplayDate(vout, todisplay->date);
     if (!is_forced)
-        mwait(todisplay->date);
+        mwait(display_date);
 
     /* Display the direct buffer returned by vout_RenderPicture */
+    const mtime_t date = todisplay->date;
     vout->p->displayed.date = mdate();
     vout_display_Display(vd, todisplay, subpic);
+    vlc_tracer_Event(VLC_TRACE_VOUT_DISPLAY, sys->input, vout, date, 0);
+
+    /* The picture shows up on the first refresh after it was handed to the
+     * display: check it got the one it was scheduled for */
+    mtime_t vsync, period;
+    if (!is_forced && vout_GetDisplayVsync(vd, &vsync, &period)) {
+        const mtime_t presented = VsyncSlot(vout->p->displayed.date + period / 2,
+                                            vsync, period);
+        const mtime_t late = presented - (display_date + period / 2);
+
+        if (late >= period)
+            msg_Dbg(vout, "picture presented %"PRId64" ms late (%"PRId64
+                    " refreshes)", late / 1000, late / period);
+    }
 
     vout_statistic_AddDisplayed(&vout->p->statistic, 1);
 
@@ -1039,7 +1086,8 @@ static int ThreadDisplayPicture(vout_thread_t *vout, mtime_t *deadline)
     bool drop_next_frame = frame_by_frame;
     mtime_t date_next = VLC_TS_INVALID;
     if (!paused && vout->p->displayed.next) {
-        date_next = vout->p->displayed.next->date - render_delay;
+        date_next = ThreadDisplayDate(vout, vout->p->displayed.next->date)
+                  - render_delay;
         if (date_next /* + 0 FIXME */ <= date)
             drop_next_frame = true;
     }
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * csa.c: CSA scrambler/descrambler test
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+#include <assert.h>
+#include <vlc_common.h>
+
+#define TS_NO_CSA_CK_MSG
+#include "../modules/mux/mpeg/csa.h"
+#include "../modules/mux/mpeg/csa.c"
+
+#define PKT_COUNT (3 * CSA_BATCH + 5)
+
+static void fill_packet( uint8_t *pkt, unsigned i )
+{
+    pkt[0] = 0x47;
+    pkt[1] = 0x01;
+    pkt[2] = i & 0xff;
+    pkt[3] = 0x10 | (i & 0x0f);
+    for( unsigned j = 4; j < 188; j++ )
+        pkt[j] = (i * 31 + j * 7) & 0xff;
+
+    /* adaptation fields of various lengths, up to an empty payload */
+    if( i % 3 == 0 )
+    {
+        pkt[3] |= 0x20;
+        pkt[4] = (i * 13) % 184;
+    }
+}
+
+static void test_csa( int i_pkt_size )
+{
+    static uint8_t ref[PKT_COUNT][188], bat[PKT_COUNT][188], orig[PKT_COUNT][188];
+    uint8_t *pp_pkt[PKT_COUNT];
+
+    csa_t *c = csa_New();
+    assert( c != NULL );
+    assert( csa_SetCW( NULL, c, (char *)"0x0123456789abcdef", true ) == VLC_SUCCESS );
+    assert( csa_SetCW( NULL, c, (char *)"fedcba9876543210", false ) == VLC_SUCCESS );
+
+    for( unsigned i = 0; i < PKT_COUNT; i++ )
+    {
+        fill_packet( orig[i], i );
+        pp_pkt[i] = bat[i];
+    }
+    memcpy( ref, orig, sizeof(ref) );
+    memcpy( bat, orig, sizeof(bat) );
+
+    /* scrambling, switching keys in the middle */
+    const unsigned i_half = PKT_COUNT / 2;
+    csa_UseKey( NULL, c, true );
+    for( unsigned i = 0; i < i_half; i++ )
+        csa_Encrypt( c, ref[i], i_pkt_size );
+    csa_EncryptBatch( c, pp_pkt, i_half, i_pkt_size );
+
+    csa_UseKey( NULL, c, false );
+    for( unsigned i = i_half; i < PKT_COUNT; i++ )
+        csa_Encrypt( c, ref[i], i_pkt_size );
+    csa_EncryptBatch( c, &pp_pkt[i_half], PKT_COUNT - i_half, i_pkt_size );
+
+    assert( memcmp( orig, bat, sizeof(bat) ) != 0 );
+    assert( memcmp( ref, bat, sizeof(ref) ) == 0 );
+
+    /* descrambling, with both keys mixed in one batch */
+    for( unsigned i = 0; i < PKT_COUNT; i++ )
+        csa_Decrypt( c, ref[i], i_pkt_size );
+    csa_DecryptBatch( c, pp_pkt, PKT_COUNT, i_pkt_size );
+
+    assert( memcmp( ref, bat, sizeof(ref) ) == 0 );
+    assert( memcmp( orig, bat, sizeof(bat) ) == 0 );
+
+    csa_Delete( c );
+}
+
+int main( void )
+{
+    test_csa( 188 );
+    test_csa( 184 );
+    test_csa( 100 );
+    test_csa( 12 );
+    return 0;
+}
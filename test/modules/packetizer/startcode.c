@@ -0,0 +1,174 @@
+/*****************************************************************************
+ * startcode.c: AnnexB startcode lookup tests and benchmark
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vlc_common.h>
+#include "../modules/packetizer/startcode_helper.h"
+
+#define BUFFER_SIZE   (1 << 20)
+#define BENCH_PASSES  64
+
+typedef const uint8_t * (*find_cb)( const uint8_t *, const uint8_t * );
+
+static const uint8_t * find_reference( const uint8_t *p, const uint8_t *end )
+{
+    for( ; end - p >= 3; p++ )
+        if( p[0] == 0 && p[1] == 0 && p[2] == 1 )
+            return p;
+    return NULL;
+}
+
+static bool cpu_supports( unsigned flag )
+{
+    return flag == 0 || (vlc_CPU() & flag) != 0;
+}
+
+static const struct
+{
+    const char *psz_name;
+    find_cb pf_find;
+    unsigned i_cpu;
+} variants[] = {
+    { "bits", startcode_FindAnnexB_Bits, 0 },
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+    { "sse2", startcode_FindAnnexB_SSE2, VLC_CPU_SSE2 },
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    { "avx2", startcode_FindAnnexB_AVX2, VLC_CPU_AVX2 },
+#endif
+#ifdef STARTCODE_HAVE_NEON
+    { "neon", startcode_FindAnnexB_NEON, 0 },
+#endif
+    { "dispatch", startcode_FindAnnexB, 0 },
+};
+
+/* Fills with mostly non zero data, runs of zeroes and sparse startcodes */
+static void fill( uint8_t *p, size_t i_size )
+{
+    srand( 42 );
+    for( size_t i = 0; i < i_size; i++ )
+        p[i] = 1 + rand() % 255;
+    for( size_t i = 0; i + 4 < i_size; i += 1 + rand() % 2000 )
+    {
+        switch( rand() % 4 )
+        {
+            case 0: /* startcode */
+                p[i] = 0; p[i+1] = 0; p[i+2] = 1;
+                break;
+            case 1: /* emulation prevention */
+                p[i] = 0; p[i+1] = 0; p[i+2] = 3;
+                break;
+            case 2: /* long startcode */
+                p[i] = 0; p[i+1] = 0; p[i+2] = 0; p[i+3] = 1;
+                break;
+            default: /* lone zeroes */
+                p[i] = 0; p[i+2] = 0;
+                break;
+        }
+    }
+}
+
+static void check( find_cb pf_find, const char *psz_name,
+                   const uint8_t *p_buf, size_t i_buf )
+{
+    /* every alignment and end, first on small windows around startcodes */
+    for( size_t i_start = 0; i_start < 64; i_start++ )
+    {
+        for( size_t i_end = i_start; i_end < 256; i_end++ )
+        {
+            const uint8_t *p_ref = find_reference( &p_buf[i_start], &p_buf[i_end] );
+            const uint8_t *p_got = pf_find( &p_buf[i_start], &p_buf[i_end] );
+            if( p_ref != p_got )
+            {
+                fprintf( stderr, "%s: mismatch on [%zu,%zu)\n",
+                         psz_name, i_start, i_end );
+                abort();
+            }
+        }
+    }
+
+    /* then iterate over the whole buffer */
+    const uint8_t *p = p_buf, *end = &p_buf[i_buf];
+    for( ;; )
+    {
+        const uint8_t *p_ref = find_reference( p, end );
+        const uint8_t *p_got = pf_find( p, end );
+        if( p_ref != p_got )
+        {
+            fprintf( stderr, "%s: mismatch at offset %td\n", psz_name, p - p_buf );
+            abort();
+        }
+        if( !p_ref )
+            break;
+        p = p_ref + 3;
+    }
+}
+
+static void bench( find_cb pf_find, const char *psz_name,
+                   const uint8_t *p_buf, size_t i_buf )
+{
+    unsigned i_count = 0;
+    mtime_t i_start = mdate();
+    for( unsigned i = 0; i < BENCH_PASSES; i++ )
+    {
+        const uint8_t *p = p_buf, *end = &p_buf[i_buf];
+        while( (p = pf_find( p, end )) )
+        {
+            p += 3;
+            i_count++;
+        }
+    }
+    mtime_t i_duration = mdate() - i_start;
+    if( i_duration <= 0 )
+        i_duration = 1;
+
+    printf( "%-9s %8.1f MB/s (%u startcodes)\n", psz_name,
+            (double) i_buf * BENCH_PASSES / i_duration, i_count / BENCH_PASSES );
+}
+
+int main( void )
+{
+    uint8_t *p_buf = malloc( BUFFER_SIZE );
+    assert( p_buf );
+    fill( p_buf, BUFFER_SIZE );
+
+    for( size_t i = 0; i < ARRAY_SIZE(variants); i++ )
+    {
+        if( !cpu_supports( variants[i].i_cpu ) )
+        {
+            printf( "%-9s unsupported by this CPU\n", variants[i].psz_name );
+            continue;
+        }
+        check( variants[i].pf_find, variants[i].psz_name, p_buf, BUFFER_SIZE );
+        bench( variants[i].pf_find, variants[i].psz_name, p_buf, BUFFER_SIZE );
+    }
+
+    free( p_buf );
+    return 0;
+}
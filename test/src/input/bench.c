@@ -0,0 +1,196 @@
+/*****************************************************************************
+ * bench.c: pipeline benchmarks
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Runs each pipeline over a sample as fast as possible, through the stream
+ * output so that no clock paces it, and prints one JSON object per line.
+ *
+ * The samples are read from the directory set by the VLC_BENCH_SAMPLES
+ * environment variable, or from samples/bench. Pipelines without their
+ * sample are skipped.
+ */
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_input.h>
+#include <vlc_url.h>
+
+#include <inttypes.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+static const struct
+{
+    const char *name;
+    const char *sample;
+    const char *sout;
+    const char *option; /* extra input option, or NULL */
+} pipelines[] = {
+    { "ts-demux", "bench.ts", "#dummy", NULL },
+    { "mp4-demux", "bench.mp4", "#dummy", NULL },
+    { "h264-packetize", "bench.h264", "#dummy", ":demux=h264" },
+    { "avcodec-decode", "bench.mp4",
+      "#transcode{vcodec=I420,venc=dummy,acodec=s16l,aenc=dummy}:dummy",
+      ":codec=avcodec" },
+    { "yadif", "bench.ts",
+      "#transcode{vcodec=I420,venc=dummy,vfilter=deinterlace{mode=yadif}}"
+      ":dummy", NULL },
+    { "blend", "bench.mp4",
+      "#transcode{vcodec=I420,venc=dummy,sfilter=marq{marquee=VLC}}:dummy",
+      NULL },
+    { "resample", "bench.mp4",
+      "#transcode{acodec=s16l,aenc=dummy,samplerate=44100}:dummy", NULL },
+    { "yuv-rgb", "bench.mp4",
+      "#transcode{vcodec=RV32,venc=dummy}:dummy", NULL },
+    { "ts-mux", "bench.mp4", "#std{access=file,mux=ts,dst=/dev/null}", NULL },
+};
+
+static double seconds(mtime_t t)
+{
+    return (double)t / CLOCK_FREQ;
+}
+
+static mtime_t process_cputime(struct rusage *ru)
+{
+    return (mtime_t)(ru->ru_utime.tv_sec + ru->ru_stime.tv_sec) * CLOCK_FREQ
+         + ru->ru_utime.tv_usec + ru->ru_stime.tv_usec;
+}
+
+static int bench(libvlc_int_t *vlc, const char *name, const char *path,
+                 const char *sout, const char *option)
+{
+    char *mrl = vlc_path2uri(path, NULL);
+    if (mrl == NULL)
+        return -1;
+
+    input_item_t *item = input_item_New(mrl, name);
+    free(mrl);
+    if (item == NULL)
+        return -1;
+
+    char *sout_option;
+    if (asprintf(&sout_option, ":sout=%s", sout) < 0)
+    {
+        input_item_Release(item);
+        return -1;
+    }
+    input_item_AddOption(item, sout_option, VLC_INPUT_OPTION_TRUSTED);
+    free(sout_option);
+    if (option != NULL)
+        input_item_AddOption(item, option, VLC_INPUT_OPTION_TRUSTED);
+
+    struct rusage before, after;
+    getrusage(RUSAGE_SELF, &before);
+    mtime_t start = mdate();
+
+    /* The input runs in this thread, until the end of the sample */
+    input_Read(vlc, item);
+
+    mtime_t wall = mdate() - start;
+    getrusage(RUSAGE_SELF, &after);
+
+    /* The statistics are not freed before the item */
+    vlc_mutex_lock(&item->lock);
+    input_stats_t *st = item->p_stats;
+    vlc_mutex_unlock(&item->lock);
+    if (st == NULL)
+    {
+        input_item_Release(item);
+        return -1;
+    }
+    vlc_mutex_lock(&st->lock);
+
+    printf("{\"pipeline\":\"%s\",\"status\":\"%s\","
+           "\"wall_seconds\":%f,\"cpu_seconds\":%f,"
+           "\"input_cpu_seconds\":%f,\"video_decoder_cpu_seconds\":%f,"
+           "\"audio_decoder_cpu_seconds\":%f,"
+           "\"demux_bytes\":%"PRId64",\"demux_bytes_per_second\":%f,"
+           "\"demux_packets\":%"PRId64",\"decoded_video\":%"PRId64","
+           "\"decoded_audio\":%"PRId64",\"sent_bytes\":%"PRId64","
+           "\"max_rss_kib\":%ld}\n",
+           name, (st->i_demux_read_bytes > 0) ? "ok" : "failed",
+           seconds(wall),
+           seconds(process_cputime(&after) - process_cputime(&before)),
+           seconds(st->i_input_cpu_time),
+           seconds(st->i_video_decoder_cpu_time),
+           seconds(st->i_audio_decoder_cpu_time),
+           st->i_demux_read_bytes,
+           (wall > 0) ? st->i_demux_read_bytes / seconds(wall) : 0.,
+           st->i_demux_read_packets, st->i_decoded_video, st->i_decoded_audio,
+           st->i_sent_bytes, (long)after.ru_maxrss);
+    fflush(stdout);
+
+    int ret = (st->i_demux_read_bytes > 0) ? 0 : -1;
+    vlc_mutex_unlock(&st->lock);
+    input_item_Release(item);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *dir = getenv("VLC_BENCH_SAMPLES");
+    if (dir == NULL)
+        dir = SRCDIR"/samples/bench";
+
+    test_init();
+    alarm(0); /* benchmarks take their time */
+
+    static const char *args[] = {
+        "--quiet", "--stats", "--vout=vdummy",
+        "--aout=adummy", "--no-video-title-show",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    int ret = 77; /* skipped, unless a sample is found */
+
+    for (size_t i = 0; i < ARRAY_SIZE(pipelines); i++)
+    {
+        /* Only run the pipelines given on the command line, if any */
+        if (argc > 1)
+        {
+            bool found = false;
+            for (int j = 1; j < argc && !found; j++)
+                found = !strcmp(argv[j], pipelines[i].name);
+            if (!found)
+                continue;
+        }
+
+        char *path;
+        struct stat sb;
+
+        if (asprintf(&path, "%s/%s", dir, pipelines[i].sample) < 0)
+            abort();
+        if (stat(path, &sb) == 0)
+        {
+            if (ret == 77)
+                ret = 0;
+            if (bench(vlc->p_libvlc_int, pipelines[i].name, path,
+                      pipelines[i].sout, pipelines[i].option))
+                ret = 1;
+        }
+        free(path);
+    }
+
+    libvlc_release(vlc);
+    return ret;
+}
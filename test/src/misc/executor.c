@@ -0,0 +1,99 @@
+/*****************************************************************************
+ * executor.c test thread pool
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+#include <vlc_common.h>
+#include <vlc_executor.h>
+#include <assert.h>
+
+#define TASKS 64
+
+struct task
+{
+    struct vlc_runnable runnable;
+    vlc_mutex_t *lock;
+    vlc_cond_t *wait;
+    bool *blocked;
+    unsigned *count;
+};
+
+static void Run( void *data )
+{
+    struct task *task = data;
+
+    vlc_mutex_lock( task->lock );
+    while( *task->blocked )
+        vlc_cond_wait( task->wait, task->lock );
+    ++*task->count;
+    vlc_mutex_unlock( task->lock );
+}
+
+int main( void )
+{
+    test_init();
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    bool blocked = true;
+    unsigned count = 0;
+    struct task tasks[TASKS];
+
+    vlc_mutex_init( &lock );
+    vlc_cond_init( &wait );
+
+    vlc_executor_t *executor = vlc_executor_New( 4, VLC_THREAD_PRIORITY_LOW );
+    assert( executor != NULL );
+
+    for( unsigned i = 0; i < TASKS; i++ )
+    {
+        tasks[i].runnable.run = Run;
+        tasks[i].runnable.userdata = &tasks[i];
+        tasks[i].lock = &lock;
+        tasks[i].wait = &wait;
+        tasks[i].blocked = &blocked;
+        tasks[i].count = &count;
+        assert( vlc_executor_Submit( executor, &tasks[i].runnable ) == 0 );
+    }
+
+    /* At most four tasks are running: the last one is still waiting */
+    assert( vlc_executor_Cancel( executor, &tasks[TASKS - 1].runnable ) );
+    assert( !vlc_executor_Cancel( executor, &tasks[TASKS - 1].runnable ) );
+
+    vlc_mutex_lock( &lock );
+    blocked = false;
+    vlc_cond_broadcast( &wait );
+    vlc_mutex_unlock( &lock );
+
+    vlc_executor_WaitIdle( executor );
+    assert( count == TASKS - 1 );
+
+    /* Submit again once the threads have been used */
+    assert( vlc_executor_Submit( executor, &tasks[0].runnable ) == 0 );
+    vlc_executor_WaitIdle( executor );
+    assert( count == TASKS );
+
+    vlc_executor_Delete( executor );
+    vlc_cond_destroy( &wait );
+    vlc_mutex_destroy( &lock );
+    return 0;
+}
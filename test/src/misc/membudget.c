@@ -0,0 +1,88 @@
+/*****************************************************************************
+ * membudget.c test process-wide memory budget
+ *****************************************************************************
+ * Copyright (C) 2017 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+#include <vlc_common.h>
+#include <vlc_membudget.h>
+#include <assert.h>
+
+#define MiB (1 << 20)
+
+int main( void )
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new( test_defaults_nargs,
+                                         test_defaults_args );
+    assert( vlc != NULL );
+    libvlc_int_t *obj = vlc->p_libvlc_int;
+
+    /* Unlimited by default */
+    vlc_mem_consumer_t *a = vlc_mem_consumer_New( obj, "a" );
+    assert( a != NULL );
+    assert( vlc_mem_Take( a, 64 * MiB ) );
+    assert( !vlc_mem_UnderPressure() );
+    assert( !vlc_mem_ShouldShrink( a ) );
+    vlc_mem_Give( a, 64 * MiB );
+    vlc_mem_consumer_Delete( a );
+
+    /* 8 MiB shared by two consumers */
+    var_Create( obj, "mem-budget", VLC_VAR_INTEGER );
+    var_SetInteger( obj, "mem-budget", 8 );
+
+    a = vlc_mem_consumer_New( obj, "a" );
+    vlc_mem_consumer_t *b = vlc_mem_consumer_New( obj, "b" );
+    assert( a != NULL && b != NULL );
+
+    assert( vlc_mem_Take( a, 6 * MiB ) );
+    assert( !vlc_mem_UnderPressure() );
+    vlc_mem_Charge( b, MiB / 2 );
+    assert( !vlc_mem_UnderPressure() );
+
+    /* b is refused: a holds more than its half and must shrink */
+    assert( !vlc_mem_Take( b, 2 * MiB ) );
+    assert( vlc_mem_UnderPressure() );
+    assert( vlc_mem_ShouldShrink( a ) );
+    assert( !vlc_mem_ShouldShrink( b ) );
+
+    /* Still under pressure until usage goes below 3/4 of the budget */
+    vlc_mem_Give( a, MiB / 4 );
+    assert( vlc_mem_UnderPressure() );
+    vlc_mem_Give( a, 1 * MiB );
+    assert( !vlc_mem_UnderPressure() );
+    assert( !vlc_mem_ShouldShrink( a ) );
+
+    /* 7.25 MiB out of 8: pressure again */
+    assert( vlc_mem_Take( b, 2 * MiB ) );
+    assert( vlc_mem_UnderPressure() );
+
+    vlc_mem_Give( b, 2 * MiB + MiB / 2 );
+    vlc_mem_Give( a, 4 * MiB + 3 * MiB / 4 );
+    assert( !vlc_mem_UnderPressure() );
+    vlc_mem_consumer_Delete( b );
+    vlc_mem_consumer_Delete( a );
+
+    libvlc_release( vlc );
+    return 0;
+}